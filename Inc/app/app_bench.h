@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file           : app_bench.h
+  * @brief          : Header file for the decode, solver and queue suites
+  * timed on the host and on the target
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _APP_BENCH_
+#define _APP_BENCH_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef uint32_t (*pfAPP_Bench_GetCycles_t)(void);
+
+/**
+ * @brief Enumeration defining the suites
+ * 
+ */
+typedef enum {
+  ceAPP_BENCH_DECODE = 0, //Data registers to a sample, once per sample
+  ceAPP_BENCH_SOLVER,     //Configuration solver over the timing tables
+  ceAPP_BENCH_QUEUE,      //Sample ring, single pushes then bulk pops
+  ceAPP_BENCH_NB,
+} eAPPBenchSuite_t;
+
+/**
+ * @brief Struct holding the outcome of a suite
+ * 
+ * The checksum depends on the inputs only, it must be equal for every
+ * optimisation level.
+ */
+typedef struct {
+  uint32_t u32_iterations;
+  uint64_t u64_cycles;
+  uint32_t u32_checksum;
+} sAPPBenchResult_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vAPP_Bench_runSuite(eAPPBenchSuite_t p_eSuite, uint32_t p_u32Iterations, pfAPP_Bench_GetCycles_t p_pfGetCycles, sAPPBenchResult_t* p_psResult);
+void vAPP_Bench_runAll(uint32_t p_u32Iterations, pfAPP_Bench_GetCycles_t p_pfGetCycles);
+const sAPPBenchResult_t* psAPP_Bench_getResult(eAPPBenchSuite_t p_eSuite);
+const char* pcAPP_Bench_getName(eAPPBenchSuite_t p_eSuite);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _APP_BENCH_ */
@@ -19,11 +19,99 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
 #include <stdbool.h>
+#include "app/app_sensor_module.h"
+#include "hal/hal_timer.h"
+#include "app/app_bmp581_fields.h"
 
 /* Private includes ----------------------------------------------------------*/
 
+/* Exported constants --------------------------------------------------------*/
+#define BMP581_I2C_ADDR_PRIM        (uint8_t)0x46
+#define BMP581_I2C_ADDR_SEC         (uint8_t)0x47
+#define BMP581_I2C_CHIP_ID          (uint8_t)0x50
+#define BMP581_I2C_REV_ID           (uint8_t)0x32
+#define BMP581_I2C_INT_STATUS_READY (uint8_t)0x10
+#define BMP581_I2C_STATUS_READY     (uint8_t)0x06
+#define BMP581_STATUS_NVM_RDY       (uint8_t)0x02
+#define BMP581_STATUS_NVM_ERR       (uint8_t)0x04
+#define BMP581_INT_STATUS_POR       (uint8_t)0x10
+#define BMP581_CMD_SOFT_RESET       (uint8_t)0xB6
+
+#define cAPP_BMP581_REG_CHIP_ID         (uint8_t)0x01
+#define cAPP_BMP581_REG_REV_ID          (uint8_t)0x02
+#define cAPP_BMP581_REG_CHIP_STATUS     (uint8_t)0x11
+#define cAPP_BMP581_REG_DRIVE_CONFIG    (uint8_t)0x13
+#define cAPP_BMP581_REG_INT_CONFIG      (uint8_t)0x14
+#define cAPP_BMP581_REG_INT_SOURCE      (uint8_t)0x15
+#define cAPP_BMP581_REG_FIFO_CONFIG     (uint8_t)0x16
+#define cAPP_BMP581_REG_FIFO_COUNT      (uint8_t)0x17
+#define cAPP_BMP581_REG_FIFO_SEL        (uint8_t)0x18
+#define cAPP_BMP581_REG_TEMP_DATA_XLSB  (uint8_t)0x1D
+#define cAPP_BMP581_REG_TEMP_DATA_LSB   (uint8_t)0x1E
+#define cAPP_BMP581_REG_TEMP_DATA_MSB   (uint8_t)0x1F
+#define cAPP_BMP581_REG_PRESS_DATA_XLSB (uint8_t)0x20
+#define cAPP_BMP581_REG_PRESS_DATA_LSB  (uint8_t)0x21
+#define cAPP_BMP581_REG_PRESS_DATA_MSB  (uint8_t)0x22
+#define cAPP_BMP581_REG_INT_STATUS      (uint8_t)0x27
+#define cAPP_BMP581_REG_STATUS          (uint8_t)0x28
+#define cAPP_BMP581_REG_FIFO_DATA       (uint8_t)0x29
+#define cAPP_BMP581_REG_NVM_ADDR        (uint8_t)0x2B
+#define cAPP_BMP581_REG_NVM_DATA_LSB    (uint8_t)0x2C
+#define cAPP_BMP581_REG_NVM_DATA_MSB    (uint8_t)0x2D
+#define cAPP_BMP581_REG_DSP_CONFIG      (uint8_t)0x30
+#define cAPP_BMP581_REG_DSP_IIR         (uint8_t)0x31
+#define cAPP_BMP581_REG_OOR_THR_P_LSB   (uint8_t)0x32
+#define cAPP_BMP581_REG_OOR_THR_P_MSB   (uint8_t)0x33
+#define cAPP_BMP581_REG_OOR_RANGE       (uint8_t)0x34
+#define cAPP_BMP581_REG_OOR_CONFIG      (uint8_t)0x35
+#define cAPP_BMP581_REG_OSR_CONFIG      (uint8_t)0x36
+#define cAPP_BMP581_REG_ODR_CONFIG      (uint8_t)0x37
+#define cAPP_BMP581_REG_OSR_EFF         (uint8_t)0x38
+#define cAPP_BMP581_REG_CMD             (uint8_t)0x7E
+
+#define BMP581_REGISTER_SIZE (uint8_t)1
+#define BMP581_DATA_SIZE     (uint8_t)6 //TEMP_DATA_XLSB to PRESS_DATA_MSB
+#define BMP581_FIFO_SIZE     (uint8_t)96   //32 frames of one value, 16 frames of both
+#define BMP581_FIFO_EMPTY    (uint8_t)0x7F //Every byte of a frame read past the last one
+
+#define cAPP_BMP581_FORCED_CMD_US  (uint32_t)300  //ODR_CONFIG write at 100 kHz
+#define cAPP_BMP581_FORCED_READ_US (uint32_t)1000 //Data registers read at 100 kHz
+#define cAPP_BMP581_POR_US         (uint32_t)2000 //Soft reset to POR flag
+#define cAPP_BMP581_POR_POLL_NB    (uint8_t)5     //INT_STATUS reads before giving up
+
 /* Exported types ------------------------------------------------------------*/
 
+/**
+ * @brief Enumeration defining the error codes returned by the BMP581 app layer
+ * 
+ */
+typedef enum {
+  ceAPP_BMP581_OK = 0,
+  ceAPP_BMP581_ERR_PARAM,
+  ceAPP_BMP581_ERR_BUS,
+  ceAPP_BMP581_ERR_NOT_READY,
+  ceAPP_BMP581_ERR_DEVICE,
+} eBMP581Err_t;
+
+/**
+ * @brief Enumeration defining the steps of the BMP581 initialisation
+ * 
+ * Each step is one bus transfer or one wait, the state machine moves on
+ * when it completes.
+ */
+typedef enum {
+  ceAPP_BMP581_INIT_IDLE = 0,
+  ceAPP_BMP581_INIT_READ_IDS,     //CHIP_ID and REV_ID read
+  ceAPP_BMP581_INIT_CHECK_STATUS, //STATUS read, NVM must be ready without error
+  ceAPP_BMP581_INIT_SOFT_RESET,   //Soft reset command written in CMD
+  ceAPP_BMP581_INIT_WAIT_POR,     //INT_STATUS polled until the POR flag is set
+  ceAPP_BMP581_INIT_CHIP_STATUS,  //CHIP_STATUS read into the register image
+  ceAPP_BMP581_INIT_CONFIGURE,    //Configuration registers written
+  ceAPP_BMP581_INIT_READY,
+  ceAPP_BMP581_INIT_FAILED,
+} eBMP581InitState_t;
+
+
 /**
  * @brief Enumeration defining power modes of BMP581
  * 
@@ -356,83 +444,120 @@ typedef struct {
   bool b_i3c_err_3;
 } sChipStatus_t;
 
-/* Exported constants --------------------------------------------------------*/
-#define BMP581_I2C_ADDR_PRIM        (uint8_t)0x46
-#define BMP581_I2C_ADDR_SEC         (uint8_t)0x47
-#define BMP581_I2C_CHIP_ID          (uint8_t)0x50
-#define BMP581_I2C_REV_ID           (uint8_t)0x32
-#define BMP581_I2C_INT_STATUS_READY (uint8_t)0x10
-#define BMP581_I2C_STATUS_READY     (uint8_t)0x06
+/**
+ * @brief Struct holding one decoded pressure and temperature measurement
+ * 
+ * Pressure is in 1/64 Pa and temperature in 1/65536 degree Celsius, as
+ * given by the PRESS_DATA and TEMP_DATA registers.
+ */
+typedef struct {
+  uint32_t u32_press_raw;
+  int32_t s32_temp_raw;
+  uint32_t u32_timestamp_ms;
+} sBMP581Sample_t;
 
-#define cAPP_BMP581_REG_CHIP_ID         (uint8_t)0x01
-#define cAPP_BMP581_REG_REV_ID          (uint8_t)0x02
-#define cAPP_BMP581_REG_CHIP_STATUS     (uint8_t)0x11
-#define cAPP_BMP581_REG_DRIVE_CONFIG    (uint8_t)0x13
-#define cAPP_BMP581_REG_INT_CONFIG      (uint8_t)0x14
-#define cAPP_BMP581_REG_INT_SOURCE      (uint8_t)0x15
-#define cAPP_BMP581_REG_FIFO_CONFIG     (uint8_t)0x16
-#define cAPP_BMP581_REG_FIFO_COUNT      (uint8_t)0x17
-#define cAPP_BMP581_REG_FIFO_SEL        (uint8_t)0x18
-#define cAPP_BMP581_REG_TEMP_DATA_XLSB  (uint8_t)0x1D
-#define cAPP_BMP581_REG_TEMP_DATA_LSB   (uint8_t)0x1E
-#define cAPP_BMP581_REG_TEMP_DATA_MSB   (uint8_t)0x1F
-#define cAPP_BMP581_REG_PRESS_DATA_XLSB (uint8_t)0x20
-#define cAPP_BMP581_REG_PRESS_DATA_LSB  (uint8_t)0x21
-#define cAPP_BMP581_REG_PRESS_DATA_MSB  (uint8_t)0x22
-#define cAPP_BMP581_REG_INT_STATUS      (uint8_t)0x27
-#define cAPP_BMP581_REG_STATUS          (uint8_t)0x28
-#define cAPP_BMP581_REG_FIFO_DATA       (uint8_t)0x29
-#define cAPP_BMP581_REG_NVM_ADDR        (uint8_t)0x2B
-#define cAPP_BMP581_REG_NVM_DATA_LSB    (uint8_t)0x2C
-#define cAPP_BMP581_REG_NVM_DATA_MSB    (uint8_t)0x2D
-#define cAPP_BMP581_REG_DSP_CONFIG      (uint8_t)0x30
-#define cAPP_BMP581_REG_DSP_IIR         (uint8_t)0x31
-#define cAPP_BMP581_REG_OOR_THR_P_LSB   (uint8_t)0x32
-#define cAPP_BMP581_REG_OOR_THR_P_MSB   (uint8_t)0x33
-#define cAPP_BMP581_REG_OOR_RANGE       (uint8_t)0x34
-#define cAPP_BMP581_REG_OOR_CONFIG      (uint8_t)0x35
-#define cAPP_BMP581_REG_OSR_CONFIG      (uint8_t)0x36
-#define cAPP_BMP581_REG_ODR_CONFIG      (uint8_t)0x37
-#define cAPP_BMP581_REG_OSR_EFF         (uint8_t)0x38
-#define cAPP_BMP581_REG_CMD             (uint8_t)0x7E
+struct sBMP581Device;
+typedef void (*pfAPP_BMP581_InitDone_t)(struct sBMP581Device* p_psDevice);
 
-#define BMP581_REGISTER_SIZE (uint8_t)1
+/**
+ * @brief Struct holding one BMP581 and the state of its initialisation
+ * 
+ * Owned by the caller and must stay valid during the initialisation.
+ * Several devices initialise concurrently, their transfers interleave in
+ * the I2C queue. Fields are private to the app layer.
+ * 
+ */
+typedef struct sBMP581Device {
+  sI2CSensor_t s_i2c;
+  volatile eBMP581InitState_t e_state;
+  eBMP581Err_t e_error;
+  uBMP581Registers_t u_registers; //Registers as last written or read
+  uint8_t u8_tx;                //Last command written in CMD
+  uint8_t u8_step;              //Configuration write or POR poll index
+  sHAL_Timer_t s_timer;         //Soft reset wait
+  volatile bool b_por_poll;     //Wait elapsed, INT_STATUS read pending in the POR poll task
+  struct sBMP581Device* ps_next; //Next device started, scanned by the POR poll task
+  uint32_t u32_start_us;
+  uint32_t u32_ready_us;        //End of the initialisation, ready or failed
+  pfAPP_BMP581_InitDone_t pf_done;
+} sBMP581Device_t;
 
 /* Exported macro ------------------------------------------------------------*/
 
 /* Exported functions prototypes ---------------------------------------------*/
 void vAPP_BMP581_init(void);
+bool bAPP_BMP581_isReady(void);
+void vAPP_BMP581_calibrateBus(void);
+uint32_t u32APP_BMP581_getBootToSampleUs(void);
+
+/* Non-blocking initialisation of any BMP581 */
+eBMP581Err_t errAPP_BMP581_startInit(sBMP581Device_t* p_psDevice, uint8_t p_u8Address, pfAPP_BMP581_InitDone_t p_pfDone);
+eBMP581InitState_t eAPP_BMP581_getInitState(const sBMP581Device_t* p_psDevice);
 
 /* Write functions for read / write registers */
-void errAPP_BMP581_writeCommand(uint8_t p_u8Command);
-void errAPP_BMP581_configureODR(sODRConfig_t p_sODRConfig);
-void errAPP_BMP581_configureOSR(sOSRConfig_t p_sOSRConfig);
-void errAPP_BMP581_configureOOR(sOORConfig_t p_sOORConfig);
-void errAPP_BMP581_configureDSP(sDSPConfig_t p_sDSPConfig);
+eBMP581Err_t errAPP_BMP581_writeCommand(uint8_t p_u8Command);
+eBMP581Err_t errAPP_BMP581_configureODR(sODRConfig_t p_sODRConfig);
+eBMP581Err_t errAPP_BMP581_configureOSR(sOSRConfig_t p_sOSRConfig);
+#ifndef BMP581_NO_OOR
+eBMP581Err_t errAPP_BMP581_configureOOR(sOORConfig_t p_sOORConfig);
+#endif
+eBMP581Err_t errAPP_BMP581_configureDSP(sDSPConfig_t p_sDSPConfig);
+#ifndef BMP581_NO_NVM
 void errAPP_BMP581_writeNVM(uint8_t p_u8NVMAddress, uint8_t p_u8NVMData);
 void errAPP_BMP581_readNVM(uint8_t p_u8NVMAddress, uint8_t p_u8NVMData);
-void errAPP_BMP581_configureFIFO(sFIFOConfig_t p_sFIFOConfig);
-void errAPP_BMP581_configureInterrupt(sIntConfig_t p_sIntConfig);
-void errAPP_BMP581_configureDrive(sDriveConfig_t p_sDriveConfig);
+#endif
+#ifndef BMP581_NO_FIFO
+eBMP581Err_t errAPP_BMP581_configureFIFO(sFIFOConfig_t p_sFIFOConfig);
+#endif
+eBMP581Err_t errAPP_BMP581_configureInterrupt(sIntConfig_t p_sIntConfig);
+eBMP581Err_t errAPP_BMP581_configureDrive(sDriveConfig_t p_sDriveConfig);
+
+/* Write functions taking the register images, no packing */
+eBMP581Err_t errAPP_BMP581_writeODRRegister(uBMP581_ODR_CONFIG_t p_uODRConfig);
+eBMP581Err_t errAPP_BMP581_writeOSRRegister(uBMP581_OSR_CONFIG_t p_uOSRConfig);
+#ifndef BMP581_NO_OOR
+eBMP581Err_t errAPP_BMP581_writeOORRegisters(sBMP581OORRegs_t p_sOORRegisters);
+#endif
+eBMP581Err_t errAPP_BMP581_writeDSPRegisters(sBMP581DSPRegs_t p_sDSPRegisters);
+#ifndef BMP581_NO_FIFO
+eBMP581Err_t errAPP_BMP581_writeFIFORegisters(sBMP581FIFORegs_t p_sFIFORegisters);
+#endif
+eBMP581Err_t errAPP_BMP581_writeIntRegisters(sBMP581IntRegs_t p_sIntRegisters);
+eBMP581Err_t errAPP_BMP581_writeDriveRegister(uBMP581_DRIVE_CONFIG_t p_uDriveConfig);
 
 /* Read functions for read / write registers */
 void errAPP_BMP581_getCommand(uint8_t* p_u8Command);
 void errAPP_BMP581_getODRConfig(sODRConfig_t* p_sODRConfig);
 void errAPP_BMP581_getOSRConfig(sOSRConfig_t* p_sOSRConfig);
+#ifndef BMP581_NO_OOR
 void errAPP_BMP581_getOORConfig(sOORConfig_t* p_sOORConfig);
+#endif
 void errAPP_BMP581_getDSPConfig(sDSPConfig_t* p_sDSPConfig);
+#ifndef BMP581_NO_FIFO
 void errAPP_BMP581_getFIFOConfig(sFIFOConfig_t* p_sFIFOConfig);
+#endif
 void errAPP_BMP581_getInterruptConfig(sIntConfig_t* p_sIntConfig);
 void errAPP_BMP581_getDriveConfig(sDriveConfig_t* p_sDriveConfig);
 
+/* Forced mode acquisition */
+eBMP581Err_t errAPP_BMP581_startForced(uint32_t p_u32PeriodUs, sOSRConfig_t p_sOSRConfig);
+void vAPP_BMP581_stopForced(void);
+eBMP581Err_t errAPP_BMP581_getLastSample(sBMP581Sample_t* p_sSample);
+uint32_t u32APP_BMP581_readSamples(sBMP581Sample_t* p_psSamples, uint32_t p_u32Max);
+uint32_t u32APP_BMP581_getDroppedSamples(void);
+
 /* Read functions for read only registers */
 void errAPP_BMP581_getEffectiveOSR(sOSREff_t* p_sOSREff);
-void errAPP_BMP581_getFIFOData(uint8_t* p_u8FIFOData);
+#ifndef BMP581_NO_FIFO
+eBMP581Err_t errAPP_BMP581_getFIFOData(uint8_t* p_u8FIFOData);
+#endif
 void errAPP_BMP581_getStatus(sStatus_t* p_sStatus);
 void errAPP_BMP581_getIntStatus(sIntStatus_t* p_sIntStatus);
 void errAPP_BMP581_getPressData(sPressData_t* p_sPressData);
 void errAPP_BMP581_getTempData(sTempData_t* p_sTempData);
-void errAPP_BMP581_getFIFOCount(uint8_t* p_u8FIFOCount);
+#ifndef BMP581_NO_FIFO
+eBMP581Err_t errAPP_BMP581_getFIFOCount(uint8_t* p_u8FIFOCount);
+#endif
 void errAPP_BMP581_getChipStatus(sChipStatus_t* p_sChipStatus);
 void errAPP_BMP581_getChipID(uint8_t* p_u8ChipID);
 void errAPP_BMP581_getRevID(uint8_t* p_u8RevID);
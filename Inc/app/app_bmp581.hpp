@@ -0,0 +1,240 @@
+/**
+  ******************************************************************************
+  * @file           : app_bmp581.hpp
+  * @brief          : Header-only C++ driver of the BMP581 over a bus chosen
+  * at compile time
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _APP_BMP581_HPP_
+#define _APP_BMP581_HPP_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Private includes ----------------------------------------------------------*/
+#include "app/app_bmp581.h"
+#include "app/app_bmp581_regmap.h"
+#include "app/app_bmp581_timing.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Blocking BMP581 driver over a static bus policy
+ * 
+ * The bus is a template parameter, so each register access is a direct
+ * call into the bus code that the compiler can inline, with no function
+ * pointer in between. BusPolicy provides, as static members:
+ * 
+ *   bool bRead(uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size);
+ *   bool bWrite(uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size);
+ *   void vDelayUs(uint32_t p_u32Us);
+ *   uint32_t u32NowMs(void);
+ * 
+ * The registers are kept in a uBMP581Registers_t image like the C driver:
+ * writes go out of the image, reads land in it. The C API of
+ * app_bmp581.h is unchanged, this class is an alternative for C++
+ * callers that own their bus.
+ * 
+ * @tparam BusPolicy the bus the BMP581 is attached to
+ */
+template <typename BusPolicy>
+class Bmp581 {
+public:
+  Bmp581() : m_uRegisters() {}
+
+  /**
+   * @brief Checks the chip, soft resets it and waits for the POR flag
+   * 
+   * Same sequence as errAPP_BMP581_startInit, blocking.
+   * 
+   * @return ceAPP_BMP581_ERR_BUS if a transfer failed,
+   * ceAPP_BMP581_ERR_DEVICE if the chip is not a ready BMP581
+   */
+  eBMP581Err_t errInit() {
+    eBMP581Err_t l_eError;
+    uint32_t l_u32WaitedUs = 0;
+
+    /* CHIP_ID and REV_ID are contiguous, one read */
+    l_eError = errReadRegisters(cAPP_BMP581_REG_CHIP_ID, 2);
+    if (l_eError != ceAPP_BMP581_OK) {
+      return l_eError;
+    }
+    if (
+      m_uRegisters.s_regs.u8_chip_id != BMP581_I2C_CHIP_ID ||
+      m_uRegisters.s_regs.u8_rev_id != BMP581_I2C_REV_ID
+    ) {
+      return ceAPP_BMP581_ERR_DEVICE;
+    }
+
+    l_eError = errReadRegisters(cAPP_BMP581_REG_STATUS, sizeof(m_uRegisters.s_regs.u_status));
+    if (l_eError != ceAPP_BMP581_OK) {
+      return l_eError;
+    }
+    if (!m_uRegisters.s_regs.u_status.s_bits.NVM_RDY || m_uRegisters.s_regs.u_status.s_bits.NVM_ERR) {
+      return ceAPP_BMP581_ERR_DEVICE;
+    }
+
+    l_eError = errWriteCommand(BMP581_CMD_SOFT_RESET);
+    if (l_eError != ceAPP_BMP581_OK) {
+      return l_eError;
+    }
+
+    /* The device does not answer during the reset, wait before polling */
+    do {
+      BusPolicy::vDelayUs(cAPP_BMP581_POR_US / 2);
+      l_u32WaitedUs += cAPP_BMP581_POR_US / 2;
+      l_eError = errReadRegisters(cAPP_BMP581_REG_INT_STATUS, sizeof(m_uRegisters.s_regs.u_int_status));
+    } while (
+      (l_eError != ceAPP_BMP581_OK || !m_uRegisters.s_regs.u_int_status.s_bits.POR) &&
+      l_u32WaitedUs < 4 * cAPP_BMP581_POR_US
+    );
+
+    if (l_eError != ceAPP_BMP581_OK) {
+      return l_eError;
+    }
+    return m_uRegisters.s_regs.u_int_status.s_bits.POR ? ceAPP_BMP581_OK : ceAPP_BMP581_ERR_DEVICE;
+  }
+
+  /**
+   * @brief Writes a command in the CMD register
+   * 
+   * @param p_u8Command the command
+   * @return ceAPP_BMP581_ERR_BUS if the transfer failed
+   */
+  eBMP581Err_t errWriteCommand(uint8_t p_u8Command) {
+    return BusPolicy::bWrite(cAPP_BMP581_REG_CMD, &p_u8Command, 1) ? ceAPP_BMP581_OK : ceAPP_BMP581_ERR_BUS;
+  }
+
+  /* Struct views, packed then written like the register writers below */
+  eBMP581Err_t errConfigureODR(const sODRConfig_t& p_sConfig) {
+    return errWriteODRRegister(uAPP_BMP581_packODRConfig(&p_sConfig));
+  }
+
+  eBMP581Err_t errConfigureOSR(const sOSRConfig_t& p_sConfig) {
+    return errWriteOSRRegister(uAPP_BMP581_packOSRConfig(&p_sConfig));
+  }
+
+#ifndef BMP581_NO_OOR
+  eBMP581Err_t errConfigureOOR(const sOORConfig_t& p_sConfig) {
+    m_uRegisters.s_regs.s_oor = sAPP_BMP581_packOORConfig(&p_sConfig);
+    return errWriteRegisters(cAPP_BMP581_REG_OOR_THR_P_LSB, sizeof(m_uRegisters.s_regs.s_oor));
+  }
+#endif
+
+  eBMP581Err_t errConfigureDSP(const sDSPConfig_t& p_sConfig) {
+    m_uRegisters.s_regs.s_dsp = sAPP_BMP581_packDSPConfig(&p_sConfig);
+    return errWriteRegisters(cAPP_BMP581_REG_DSP_CONFIG, sizeof(m_uRegisters.s_regs.s_dsp));
+  }
+
+#ifndef BMP581_NO_FIFO
+  eBMP581Err_t errConfigureFIFO(const sFIFOConfig_t& p_sConfig) {
+    const sBMP581FIFORegs_t l_sRegisters = sAPP_BMP581_packFIFOConfig(&p_sConfig);
+    eBMP581Err_t l_eError;
+
+    /* FIFO_COUNT sits between FIFO_CONFIG and FIFO_SEL, two writes */
+    m_uRegisters.s_regs.u_fifo_config = l_sRegisters.u_fifo_config;
+    m_uRegisters.s_regs.u_fifo_sel = l_sRegisters.u_fifo_sel;
+    l_eError = errWriteRegisters(cAPP_BMP581_REG_FIFO_CONFIG, sizeof(l_sRegisters.u_fifo_config));
+    if (l_eError != ceAPP_BMP581_OK) {
+      return l_eError;
+    }
+    return errWriteRegisters(cAPP_BMP581_REG_FIFO_SEL, sizeof(l_sRegisters.u_fifo_sel));
+  }
+#endif
+
+  eBMP581Err_t errConfigureInterrupt(const sIntConfig_t& p_sConfig) {
+    m_uRegisters.s_regs.s_int = sAPP_BMP581_packIntConfig(&p_sConfig);
+    return errWriteRegisters(cAPP_BMP581_REG_INT_CONFIG, sizeof(m_uRegisters.s_regs.s_int));
+  }
+
+  eBMP581Err_t errConfigureDrive(const sDriveConfig_t& p_sConfig) {
+    m_uRegisters.s_regs.u_drive_config = uAPP_BMP581_packDriveConfig(&p_sConfig);
+    return errWriteRegisters(cAPP_BMP581_REG_DRIVE_CONFIG, sizeof(m_uRegisters.s_regs.u_drive_config));
+  }
+
+  eBMP581Err_t errWriteODRRegister(uBMP581_ODR_CONFIG_t p_uRegister) {
+    m_uRegisters.s_regs.u_odr_config = p_uRegister;
+    return errWriteRegisters(cAPP_BMP581_REG_ODR_CONFIG, sizeof(p_uRegister));
+  }
+
+  eBMP581Err_t errWriteOSRRegister(uBMP581_OSR_CONFIG_t p_uRegister) {
+    m_uRegisters.s_regs.u_osr_config = p_uRegister;
+    return errWriteRegisters(cAPP_BMP581_REG_OSR_CONFIG, sizeof(p_uRegister));
+  }
+
+  /**
+   * @brief Runs one forced mode conversion and reads its result
+   * 
+   * Writes ODR_CONFIG in forced mode, waits the conversion time of the
+   * OSR_CONFIG image, then reads the data registers.
+   * 
+   * @param p_sSample the sample to fill
+   * @return ceAPP_BMP581_ERR_BUS if a transfer failed
+   */
+  eBMP581Err_t errMeasureForced(sBMP581Sample_t& p_sSample) {
+    uBMP581_ODR_CONFIG_t l_uODRConfig = m_uRegisters.s_regs.u_odr_config;
+    const uBMP581_OSR_CONFIG_t l_uOSRConfig = m_uRegisters.s_regs.u_osr_config;
+    eBMP581Err_t l_eError;
+
+    l_uODRConfig.s_bits.PWR_MODE = ceAPP_BMP581_FORCED;
+    l_eError = errWriteODRRegister(l_uODRConfig);
+    if (l_eError != ceAPP_BMP581_OK) {
+      return l_eError;
+    }
+
+    BusPolicy::vDelayUs(u32APP_BMP581_getConversionTimeUs(
+      (eBMP581OSR_t)l_uOSRConfig.s_bits.OSR_T,
+      (eBMP581OSR_t)l_uOSRConfig.s_bits.OSR_P,
+      l_uOSRConfig.s_bits.PRESS_EN
+    ));
+
+    return errReadSample(p_sSample);
+  }
+
+  /**
+   * @brief Reads and decodes the data registers
+   * 
+   * @param p_sSample the sample to fill, timestamped with the policy clock
+   * @return ceAPP_BMP581_ERR_BUS if the transfer failed
+   */
+  eBMP581Err_t errReadSample(sBMP581Sample_t& p_sSample) {
+    const uint8_t* l_pu8Data = m_uRegisters.s_regs.au8_data;
+    eBMP581Err_t l_eError = errReadRegisters(cAPP_BMP581_REG_TEMP_DATA_XLSB, BMP581_DATA_SIZE);
+
+    if (l_eError != ceAPP_BMP581_OK) {
+      return l_eError;
+    }
+
+    vAPP_BMP581_unpackData(l_pu8Data, &p_sSample);
+    p_sSample.u32_timestamp_ms = BusPolicy::u32NowMs();
+    return ceAPP_BMP581_OK;
+  }
+
+  /**
+   * @brief Gives the register image, as last written or read
+   * 
+   * @return the image, indexed by register address
+   */
+  const uBMP581Registers_t& uGetRegisters() const {
+    return m_uRegisters;
+  }
+
+private:
+  eBMP581Err_t errWriteRegisters(uint8_t p_u8Register, uint16_t p_u16Size) {
+    return BusPolicy::bWrite(p_u8Register, &m_uRegisters.au8_bytes[p_u8Register], p_u16Size) ?
+      ceAPP_BMP581_OK : ceAPP_BMP581_ERR_BUS;
+  }
+
+  eBMP581Err_t errReadRegisters(uint8_t p_u8Register, uint16_t p_u16Size) {
+    return BusPolicy::bRead(p_u8Register, &m_uRegisters.au8_bytes[p_u8Register], p_u16Size) ?
+      ceAPP_BMP581_OK : ceAPP_BMP581_ERR_BUS;
+  }
+
+  uBMP581Registers_t m_uRegisters;
+};
+
+#endif /* _APP_BMP581_HPP_ */
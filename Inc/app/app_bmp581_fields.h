@@ -0,0 +1,317 @@
+/**
+  ******************************************************************************
+  * @file           : app_bmp581_fields.h
+  * @brief          : Header file for the BMP581 register fields and the
+  * register image types generated from them
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _APP_BMP581_FIELDS_
+#define _APP_BMP581_FIELDS_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Exported constants --------------------------------------------------------*/
+
+/*
+ * Fields of each register as X(register, field, position, width), listed
+ * from bit 0 and covering the whole byte, reserved bits included. This
+ * table is the only place bit positions are written, the masks, the
+ * checks and the register types below are generated from it.
+ */
+#define APP_BMP581_CHIP_STATUS_FIELDS(X) \
+  X(CHIP_STATUS, HIF_MODE, 0, 2) \
+  X(CHIP_STATUS, I3C_ERR_0, 2, 1) \
+  X(CHIP_STATUS, I3C_ERR_3, 3, 1) \
+  X(CHIP_STATUS, RESERVED_4, 4, 4)
+
+#define APP_BMP581_DRIVE_CONFIG_FIELDS(X) \
+  X(DRIVE_CONFIG, I2C_CSB_PULL_EN, 0, 1) \
+  X(DRIVE_CONFIG, SPI3_EN, 1, 1) \
+  X(DRIVE_CONFIG, RESERVED_2, 2, 2) \
+  X(DRIVE_CONFIG, PAD_IF_DRV, 4, 4)
+
+#define APP_BMP581_INT_CONFIG_FIELDS(X) \
+  X(INT_CONFIG, INT_MODE, 0, 1) \
+  X(INT_CONFIG, INT_POL, 1, 1) \
+  X(INT_CONFIG, INT_OD, 2, 1) \
+  X(INT_CONFIG, INT_EN, 3, 1) \
+  X(INT_CONFIG, PAD_INT_DRV, 4, 4)
+
+#define APP_BMP581_INT_SOURCE_FIELDS(X) \
+  X(INT_SOURCE, DRDY_DATA_REG_EN, 0, 1) \
+  X(INT_SOURCE, FIFO_FULL_EN, 1, 1) \
+  X(INT_SOURCE, FIFO_THS_EN, 2, 1) \
+  X(INT_SOURCE, OOR_P_EN, 3, 1) \
+  X(INT_SOURCE, RESERVED_4, 4, 4)
+
+#define APP_BMP581_FIFO_CONFIG_FIELDS(X) \
+  X(FIFO_CONFIG, FIFO_THRESHOLD, 0, 5) \
+  X(FIFO_CONFIG, FIFO_MODE, 5, 1) \
+  X(FIFO_CONFIG, RESERVED_6, 6, 2)
+
+#define APP_BMP581_FIFO_SEL_FIELDS(X) \
+  X(FIFO_SEL, FIFO_FRAME_SEL, 0, 2) \
+  X(FIFO_SEL, FIFO_DEC_SEL, 2, 3) \
+  X(FIFO_SEL, RESERVED_5, 5, 3)
+
+#define APP_BMP581_INT_STATUS_FIELDS(X) \
+  X(INT_STATUS, DRDY_DATA_REG, 0, 1) \
+  X(INT_STATUS, FIFO_FULL, 1, 1) \
+  X(INT_STATUS, FIFO_THS, 2, 1) \
+  X(INT_STATUS, OOR_P, 3, 1) \
+  X(INT_STATUS, POR, 4, 1) \
+  X(INT_STATUS, RESERVED_5, 5, 3)
+
+#define APP_BMP581_STATUS_FIELDS(X) \
+  X(STATUS, CORE_RDY, 0, 1) \
+  X(STATUS, NVM_RDY, 1, 1) \
+  X(STATUS, NVM_ERR, 2, 1) \
+  X(STATUS, NVM_CMD_ERR, 3, 1) \
+  X(STATUS, BOOT_ERR_CORRECTED, 4, 1) \
+  X(STATUS, RESERVED_5, 5, 2) \
+  X(STATUS, ST_CRACK_PASS, 7, 1)
+
+#define APP_BMP581_DSP_CONFIG_FIELDS(X) \
+  X(DSP_CONFIG, COMP_PT_EN, 0, 2) \
+  X(DSP_CONFIG, IIR_FLUSH_FORCED_EN, 2, 1) \
+  X(DSP_CONFIG, SHDW_SEL_IIR_T, 3, 1) \
+  X(DSP_CONFIG, FIFO_SEL_IIR_T, 4, 1) \
+  X(DSP_CONFIG, SHDW_SEL_IIR_P, 5, 1) \
+  X(DSP_CONFIG, FIFO_SEL_IIR_P, 6, 1) \
+  X(DSP_CONFIG, OOR_SEL_IIR_P, 7, 1)
+
+#define APP_BMP581_DSP_IIR_FIELDS(X) \
+  X(DSP_IIR, SET_IIR_T, 0, 3) \
+  X(DSP_IIR, SET_IIR_P, 3, 3) \
+  X(DSP_IIR, RESERVED_6, 6, 2)
+
+#define APP_BMP581_OOR_THR_P_LSB_FIELDS(X) \
+  X(OOR_THR_P_LSB, OOR_THR_P_7_0, 0, 8)
+
+#define APP_BMP581_OOR_THR_P_MSB_FIELDS(X) \
+  X(OOR_THR_P_MSB, OOR_THR_P_15_8, 0, 8)
+
+#define APP_BMP581_OOR_RANGE_FIELDS(X) \
+  X(OOR_RANGE, OOR_RANGE_P, 0, 8)
+
+#define APP_BMP581_OOR_CONFIG_FIELDS(X) \
+  X(OOR_CONFIG, OOR_THR_P_16, 0, 1) \
+  X(OOR_CONFIG, RESERVED_1, 1, 5) \
+  X(OOR_CONFIG, CNT_LIM, 6, 2)
+
+#define APP_BMP581_OSR_CONFIG_FIELDS(X) \
+  X(OSR_CONFIG, OSR_T, 0, 3) \
+  X(OSR_CONFIG, OSR_P, 3, 3) \
+  X(OSR_CONFIG, PRESS_EN, 6, 1) \
+  X(OSR_CONFIG, RESERVED_7, 7, 1)
+
+#define APP_BMP581_ODR_CONFIG_FIELDS(X) \
+  X(ODR_CONFIG, PWR_MODE, 0, 2) \
+  X(ODR_CONFIG, ODR, 2, 5) \
+  X(ODR_CONFIG, DEEP_DIS, 7, 1)
+
+#define APP_BMP581_OSR_EFF_FIELDS(X) \
+  X(OSR_EFF, OSR_T_EFF, 0, 3) \
+  X(OSR_EFF, OSR_P_EFF, 3, 3) \
+  X(OSR_EFF, RESERVED_6, 6, 1) \
+  X(OSR_EFF, ODR_IS_VALID, 7, 1)
+
+/* Registers holding fields, as R(register) */
+#define APP_BMP581_FIELD_REGISTERS(R) \
+  R(CHIP_STATUS) \
+  R(DRIVE_CONFIG) \
+  R(INT_CONFIG) \
+  R(INT_SOURCE) \
+  R(FIFO_CONFIG) \
+  R(FIFO_SEL) \
+  R(INT_STATUS) \
+  R(STATUS) \
+  R(DSP_CONFIG) \
+  R(DSP_IIR) \
+  R(OOR_THR_P_LSB) \
+  R(OOR_THR_P_MSB) \
+  R(OOR_RANGE) \
+  R(OOR_CONFIG) \
+  R(OSR_CONFIG) \
+  R(ODR_CONFIG) \
+  R(OSR_EFF)
+
+/* Every field of every register */
+#define APP_BMP581_FIELDS(X) \
+  APP_BMP581_CHIP_STATUS_FIELDS(X) \
+  APP_BMP581_DRIVE_CONFIG_FIELDS(X) \
+  APP_BMP581_INT_CONFIG_FIELDS(X) \
+  APP_BMP581_INT_SOURCE_FIELDS(X) \
+  APP_BMP581_FIFO_CONFIG_FIELDS(X) \
+  APP_BMP581_FIFO_SEL_FIELDS(X) \
+  APP_BMP581_INT_STATUS_FIELDS(X) \
+  APP_BMP581_STATUS_FIELDS(X) \
+  APP_BMP581_DSP_CONFIG_FIELDS(X) \
+  APP_BMP581_DSP_IIR_FIELDS(X) \
+  APP_BMP581_OOR_THR_P_LSB_FIELDS(X) \
+  APP_BMP581_OOR_THR_P_MSB_FIELDS(X) \
+  APP_BMP581_OOR_RANGE_FIELDS(X) \
+  APP_BMP581_OOR_CONFIG_FIELDS(X) \
+  APP_BMP581_OSR_CONFIG_FIELDS(X) \
+  APP_BMP581_ODR_CONFIG_FIELDS(X) \
+  APP_BMP581_OSR_EFF_FIELDS(X)
+
+/* cAPP_BMP581_<register>_<field>_POS and _MSK of every field */
+#define APP_BMP581_FIELD_CONSTANTS(REG, FIELD, POS, WIDTH) \
+  cAPP_BMP581_##REG##_##FIELD##_POS = (POS), \
+  cAPP_BMP581_##REG##_##FIELD##_MSK = (int)(((1U << (WIDTH)) - 1U) << (POS)),
+
+enum {
+  APP_BMP581_FIELDS(APP_BMP581_FIELD_CONSTANTS)
+};
+
+#define cAPP_BMP581_REG_NB (uint8_t)0x39 //CHIP_ID to OSR_EFF, the register image excludes CMD
+
+/* Exported types ------------------------------------------------------------*/
+
+/*
+ * uBMP581_<register>_t of every register holding fields: the register
+ * byte in u8_raw and its fields in s_bits. Bit-fields are allocated from
+ * bit 0 on this target, the checks of APP_BMP581_CHECK_REGISTER make the
+ * table order match the silicon layout.
+ */
+#define APP_BMP581_FIELD_BITFIELD(REG, FIELD, POS, WIDTH) uint8_t FIELD : WIDTH;
+#define APP_BMP581_REGISTER_TYPE(REG) \
+  typedef union { \
+    uint8_t u8_raw; \
+    struct { \
+      APP_BMP581_##REG##_FIELDS(APP_BMP581_FIELD_BITFIELD) \
+    } s_bits; \
+  } uBMP581_##REG##_t;
+
+APP_BMP581_FIELD_REGISTERS(APP_BMP581_REGISTER_TYPE)
+
+/**
+ * @brief Struct holding the INT_CONFIG and INT_SOURCE registers
+ * 
+ */
+typedef struct {
+  uBMP581_INT_CONFIG_t u_int_config;
+  uBMP581_INT_SOURCE_t u_int_source;
+} sBMP581IntRegs_t;
+
+/**
+ * @brief Struct holding the FIFO_CONFIG and FIFO_SEL registers
+ * 
+ * The registers are not contiguous, FIFO_COUNT sits between them.
+ */
+typedef struct {
+  uBMP581_FIFO_CONFIG_t u_fifo_config;
+  uBMP581_FIFO_SEL_t u_fifo_sel;
+} sBMP581FIFORegs_t;
+
+/**
+ * @brief Struct holding the DSP_CONFIG and DSP_IIR registers
+ * 
+ */
+typedef struct {
+  uBMP581_DSP_CONFIG_t u_dsp_config;
+  uBMP581_DSP_IIR_t u_dsp_iir;
+} sBMP581DSPRegs_t;
+
+/**
+ * @brief Struct holding the OOR_THR_P_LSB to OOR_CONFIG registers
+ * 
+ */
+typedef struct {
+  uBMP581_OOR_THR_P_LSB_t u_oor_thr_p_lsb;
+  uBMP581_OOR_THR_P_MSB_t u_oor_thr_p_msb;
+  uBMP581_OOR_RANGE_t u_oor_range;
+  uBMP581_OOR_CONFIG_t u_oor_config;
+} sBMP581OORRegs_t;
+
+/**
+ * @brief Union holding the register image of one BMP581
+ * 
+ * au8_bytes is indexed by register address, so contiguous registers are
+ * sent or received in one transfer straight from the image. s_regs
+ * names each register at its address.
+ */
+typedef union {
+  uint8_t au8_bytes[cAPP_BMP581_REG_NB];
+  struct {
+    uint8_t u8_reserved_00;
+    uint8_t u8_chip_id;
+    uint8_t u8_rev_id;
+    uint8_t au8_reserved_03[14];
+    uBMP581_CHIP_STATUS_t u_chip_status;
+    uint8_t u8_reserved_12;
+    uBMP581_DRIVE_CONFIG_t u_drive_config;
+    sBMP581IntRegs_t s_int;
+    uBMP581_FIFO_CONFIG_t u_fifo_config;
+    uint8_t u8_fifo_count;
+    uBMP581_FIFO_SEL_t u_fifo_sel;
+    uint8_t au8_reserved_19[4];
+    uint8_t au8_data[6];          //TEMP_DATA_XLSB to PRESS_DATA_MSB
+    uint8_t au8_reserved_23[4];
+    uBMP581_INT_STATUS_t u_int_status;
+    uBMP581_STATUS_t u_status;
+    uint8_t u8_fifo_data;
+    uint8_t u8_reserved_2a;
+    uint8_t u8_nvm_addr;
+    uint8_t au8_nvm_data[2];
+    uint8_t au8_reserved_2e[2];
+    sBMP581DSPRegs_t s_dsp;
+    sBMP581OORRegs_t s_oor;
+    uBMP581_OSR_CONFIG_t u_osr_config;
+    uBMP581_ODR_CONFIG_t u_odr_config;
+    uBMP581_OSR_EFF_t u_osr_eff;
+  } s_regs;
+} uBMP581Registers_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Places a value in a field, the bits outside the field are dropped */
+#define APP_BMP581_SET(REG, FIELD, VALUE) \
+  ((uint8_t)(((uint32_t)(VALUE) << cAPP_BMP581_##REG##_##FIELD##_POS) & (uint32_t)cAPP_BMP581_##REG##_##FIELD##_MSK))
+
+/* Extracts a field from a register byte */
+#define APP_BMP581_GET(REG, FIELD, BYTE) \
+  (((uint32_t)(BYTE) & (uint32_t)cAPP_BMP581_##REG##_##FIELD##_MSK) >> cAPP_BMP581_##REG##_##FIELD##_POS)
+
+/*
+ * Checks of one field and of one register, to expand in a source file.
+ * A register is checked for overlapping fields, for a full byte and for
+ * fields listed by increasing position, the ternary chain yields 8 as
+ * soon as a position does not grow.
+ */
+#define APP_BMP581_CHECK_FIELD(REG, FIELD, POS, WIDTH) \
+  _Static_assert((WIDTH) > 0 && (POS) + (WIDTH) <= 8, "BMP581 field " #REG "." #FIELD " does not fit in its register");
+#define APP_BMP581_FIELD_OR(REG, FIELD, POS, WIDTH)    | (uint32_t)cAPP_BMP581_##REG##_##FIELD##_MSK
+#define APP_BMP581_FIELD_SUM(REG, FIELD, POS, WIDTH)   + (uint32_t)cAPP_BMP581_##REG##_##FIELD##_MSK
+#define APP_BMP581_FIELD_OPEN(REG, FIELD, POS, WIDTH)  (
+#define APP_BMP581_FIELD_ORDER(REG, FIELD, POS, WIDTH) < (POS) ? (POS) : 8)
+#define APP_BMP581_CHECK_REGISTER(REG) \
+  _Static_assert((0U APP_BMP581_##REG##_FIELDS(APP_BMP581_FIELD_OR)) == (0U APP_BMP581_##REG##_FIELDS(APP_BMP581_FIELD_SUM)), \
+                 "BMP581 fields of " #REG " overlap"); \
+  _Static_assert((0U APP_BMP581_##REG##_FIELDS(APP_BMP581_FIELD_SUM)) == 0xFFU, \
+                 "BMP581 fields of " #REG " do not cover the register"); \
+  _Static_assert((APP_BMP581_##REG##_FIELDS(APP_BMP581_FIELD_OPEN) -1 APP_BMP581_##REG##_FIELDS(APP_BMP581_FIELD_ORDER)) < 8, \
+                 "BMP581 fields of " #REG " are not listed by position"); \
+  _Static_assert(sizeof(uBMP581_##REG##_t) == 1, "BMP581 register type " #REG " is not one byte");
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _APP_BMP581_FIELDS_ */
@@ -0,0 +1,426 @@
+/**
+  ******************************************************************************
+  * @file           : app_bmp581_regmap.h
+  * @brief          : Header file for the packing of the BMP581
+  * configuration structs into their register images
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _APP_BMP581_REGMAP_
+#define _APP_BMP581_REGMAP_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+#include "app/app_bmp581.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/*
+ * The register types of app_bmp581_fields.h are the storage, the structs
+ * of app_bmp581.h are a view of them. Packing builds the register bytes
+ * with shifts and masks only, so a constant struct folds into a constant
+ * byte.
+ */
+
+/**
+ * @brief Packs an ODR configuration into the ODR_CONFIG register
+ * 
+ * b_deep_stdy allows the deep standby, the register holds its disable bit.
+ * 
+ * @param p_psConfig the configuration
+ * @return the ODR_CONFIG register
+ */
+static inline uBMP581_ODR_CONFIG_t uAPP_BMP581_packODRConfig(const sODRConfig_t* p_psConfig) {
+  uBMP581_ODR_CONFIG_t l_uRegister;
+
+  l_uRegister.u8_raw =
+    APP_BMP581_SET(ODR_CONFIG, PWR_MODE, p_psConfig->e_pwr_mode) |
+    APP_BMP581_SET(ODR_CONFIG, ODR, p_psConfig->e_odr) |
+    APP_BMP581_SET(ODR_CONFIG, DEEP_DIS, !p_psConfig->b_deep_stdy);
+  return l_uRegister;
+}
+
+/**
+ * @brief Unpacks the ODR_CONFIG register
+ * 
+ * @param p_uRegister the ODR_CONFIG register
+ * @param p_psConfig the configuration to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackODRConfig(uBMP581_ODR_CONFIG_t p_uRegister, sODRConfig_t* p_psConfig) {
+  p_psConfig->e_pwr_mode = (eBMP581PwrMode_t)p_uRegister.s_bits.PWR_MODE;
+  p_psConfig->e_odr = (eBMP581ODR_t)p_uRegister.s_bits.ODR;
+  p_psConfig->b_deep_stdy = p_uRegister.s_bits.DEEP_DIS == 0;
+}
+
+/**
+ * @brief Packs an OSR configuration into the OSR_CONFIG register
+ * 
+ * @param p_psConfig the configuration
+ * @return the OSR_CONFIG register
+ */
+static inline uBMP581_OSR_CONFIG_t uAPP_BMP581_packOSRConfig(const sOSRConfig_t* p_psConfig) {
+  uBMP581_OSR_CONFIG_t l_uRegister;
+
+  l_uRegister.u8_raw =
+    APP_BMP581_SET(OSR_CONFIG, OSR_T, p_psConfig->e_osr_t) |
+    APP_BMP581_SET(OSR_CONFIG, OSR_P, p_psConfig->e_osr_p) |
+    APP_BMP581_SET(OSR_CONFIG, PRESS_EN, p_psConfig->b_press_en);
+  return l_uRegister;
+}
+
+/**
+ * @brief Unpacks the OSR_CONFIG register
+ * 
+ * @param p_uRegister the OSR_CONFIG register
+ * @param p_psConfig the configuration to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackOSRConfig(uBMP581_OSR_CONFIG_t p_uRegister, sOSRConfig_t* p_psConfig) {
+  p_psConfig->e_osr_t = (eBMP581OSR_t)p_uRegister.s_bits.OSR_T;
+  p_psConfig->e_osr_p = (eBMP581OSR_t)p_uRegister.s_bits.OSR_P;
+  p_psConfig->b_press_en = p_uRegister.s_bits.PRESS_EN != 0;
+}
+
+/**
+ * @brief Packs an OOR configuration into OOR_THR_P_LSB to OOR_CONFIG
+ * 
+ * @param p_psConfig the configuration
+ * @return the registers
+ */
+static inline sBMP581OORRegs_t sAPP_BMP581_packOORConfig(const sOORConfig_t* p_psConfig) {
+  sBMP581OORRegs_t l_sRegisters;
+
+  l_sRegisters.u_oor_thr_p_lsb.u8_raw = APP_BMP581_SET(OOR_THR_P_LSB, OOR_THR_P_7_0, p_psConfig->u8_oor_thr_p_7_0);
+  l_sRegisters.u_oor_thr_p_msb.u8_raw = APP_BMP581_SET(OOR_THR_P_MSB, OOR_THR_P_15_8, p_psConfig->u8_oor_thr_p_15_8);
+  l_sRegisters.u_oor_range.u8_raw = APP_BMP581_SET(OOR_RANGE, OOR_RANGE_P, p_psConfig->u8_oor_range_p);
+  l_sRegisters.u_oor_config.u8_raw =
+    APP_BMP581_SET(OOR_CONFIG, OOR_THR_P_16, p_psConfig->b_oor_thr_p_16) |
+    APP_BMP581_SET(OOR_CONFIG, CNT_LIM, p_psConfig->e_cnt_lim);
+  return l_sRegisters;
+}
+
+/**
+ * @brief Unpacks OOR_THR_P_LSB to OOR_CONFIG
+ * 
+ * @param p_psRegisters the registers
+ * @param p_psConfig the configuration to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackOORConfig(const sBMP581OORRegs_t* p_psRegisters, sOORConfig_t* p_psConfig) {
+  p_psConfig->u8_oor_thr_p_7_0 = p_psRegisters->u_oor_thr_p_lsb.u8_raw;
+  p_psConfig->u8_oor_thr_p_15_8 = p_psRegisters->u_oor_thr_p_msb.u8_raw;
+  p_psConfig->u8_oor_range_p = p_psRegisters->u_oor_range.u8_raw;
+  p_psConfig->b_oor_thr_p_16 = p_psRegisters->u_oor_config.s_bits.OOR_THR_P_16 != 0;
+  p_psConfig->e_cnt_lim = (eBMP581OORCntLim_t)p_psRegisters->u_oor_config.s_bits.CNT_LIM;
+}
+
+/**
+ * @brief Packs a DSP configuration into DSP_CONFIG and DSP_IIR
+ * 
+ * @param p_psConfig the configuration
+ * @return the registers
+ */
+static inline sBMP581DSPRegs_t sAPP_BMP581_packDSPConfig(const sDSPConfig_t* p_psConfig) {
+  sBMP581DSPRegs_t l_sRegisters;
+
+  l_sRegisters.u_dsp_config.u8_raw =
+    APP_BMP581_SET(DSP_CONFIG, COMP_PT_EN, p_psConfig->e_comp_pt_en) |
+    APP_BMP581_SET(DSP_CONFIG, IIR_FLUSH_FORCED_EN, p_psConfig->b_iir_flush_forced) |
+    APP_BMP581_SET(DSP_CONFIG, SHDW_SEL_IIR_T, p_psConfig->b_shdw_sel_iir_t) |
+    APP_BMP581_SET(DSP_CONFIG, FIFO_SEL_IIR_T, p_psConfig->b_fifo_sel_iir_t) |
+    APP_BMP581_SET(DSP_CONFIG, SHDW_SEL_IIR_P, p_psConfig->b_shdw_sel_iir_p) |
+    APP_BMP581_SET(DSP_CONFIG, FIFO_SEL_IIR_P, p_psConfig->b_fifo_sel_iir_p) |
+    APP_BMP581_SET(DSP_CONFIG, OOR_SEL_IIR_P, p_psConfig->b_oor_sel_iir_p);
+  l_sRegisters.u_dsp_iir.u8_raw =
+    APP_BMP581_SET(DSP_IIR, SET_IIR_T, p_psConfig->e_set_iir_t) |
+    APP_BMP581_SET(DSP_IIR, SET_IIR_P, p_psConfig->e_set_iir_p);
+  return l_sRegisters;
+}
+
+/**
+ * @brief Unpacks DSP_CONFIG and DSP_IIR
+ * 
+ * @param p_psRegisters the registers
+ * @param p_psConfig the configuration to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackDSPConfig(const sBMP581DSPRegs_t* p_psRegisters, sDSPConfig_t* p_psConfig) {
+  p_psConfig->e_comp_pt_en = (eBMP581PTComp_t)p_psRegisters->u_dsp_config.s_bits.COMP_PT_EN;
+  p_psConfig->b_iir_flush_forced = p_psRegisters->u_dsp_config.s_bits.IIR_FLUSH_FORCED_EN != 0;
+  p_psConfig->b_shdw_sel_iir_t = p_psRegisters->u_dsp_config.s_bits.SHDW_SEL_IIR_T != 0;
+  p_psConfig->b_fifo_sel_iir_t = p_psRegisters->u_dsp_config.s_bits.FIFO_SEL_IIR_T != 0;
+  p_psConfig->b_shdw_sel_iir_p = p_psRegisters->u_dsp_config.s_bits.SHDW_SEL_IIR_P != 0;
+  p_psConfig->b_fifo_sel_iir_p = p_psRegisters->u_dsp_config.s_bits.FIFO_SEL_IIR_P != 0;
+  p_psConfig->b_oor_sel_iir_p = p_psRegisters->u_dsp_config.s_bits.OOR_SEL_IIR_P != 0;
+  p_psConfig->e_set_iir_t = (eBMP581IRRFilter_t)p_psRegisters->u_dsp_iir.s_bits.SET_IIR_T;
+  p_psConfig->e_set_iir_p = (eBMP581IRRFilter_t)p_psRegisters->u_dsp_iir.s_bits.SET_IIR_P;
+}
+
+/**
+ * @brief Packs a FIFO configuration into FIFO_CONFIG and FIFO_SEL
+ * 
+ * @param p_psConfig the configuration
+ * @return the registers
+ */
+static inline sBMP581FIFORegs_t sAPP_BMP581_packFIFOConfig(const sFIFOConfig_t* p_psConfig) {
+  sBMP581FIFORegs_t l_sRegisters;
+
+  l_sRegisters.u_fifo_config.u8_raw =
+    APP_BMP581_SET(FIFO_CONFIG, FIFO_THRESHOLD, p_psConfig->u8_fifo_threshold) |
+    APP_BMP581_SET(FIFO_CONFIG, FIFO_MODE, p_psConfig->b_fifo_mode);
+  l_sRegisters.u_fifo_sel.u8_raw =
+    APP_BMP581_SET(FIFO_SEL, FIFO_FRAME_SEL, p_psConfig->e_fifo_frame_sel) |
+    APP_BMP581_SET(FIFO_SEL, FIFO_DEC_SEL, p_psConfig->e_fifo_dec_sel);
+  return l_sRegisters;
+}
+
+/**
+ * @brief Unpacks FIFO_CONFIG and FIFO_SEL
+ * 
+ * @param p_psRegisters the registers
+ * @param p_psConfig the configuration to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackFIFOConfig(const sBMP581FIFORegs_t* p_psRegisters, sFIFOConfig_t* p_psConfig) {
+  p_psConfig->u8_fifo_threshold = p_psRegisters->u_fifo_config.s_bits.FIFO_THRESHOLD;
+  p_psConfig->b_fifo_mode = p_psRegisters->u_fifo_config.s_bits.FIFO_MODE != 0;
+  p_psConfig->e_fifo_frame_sel = (eBMP581FIFOSel_t)p_psRegisters->u_fifo_sel.s_bits.FIFO_FRAME_SEL;
+  p_psConfig->e_fifo_dec_sel = (eBMP581FIFODec_t)p_psRegisters->u_fifo_sel.s_bits.FIFO_DEC_SEL;
+}
+
+/**
+ * @brief Packs an interrupt configuration into INT_CONFIG and INT_SOURCE
+ * 
+ * @param p_psConfig the configuration
+ * @return the registers
+ */
+static inline sBMP581IntRegs_t sAPP_BMP581_packIntConfig(const sIntConfig_t* p_psConfig) {
+  sBMP581IntRegs_t l_sRegisters;
+
+  l_sRegisters.u_int_config.u8_raw =
+    APP_BMP581_SET(INT_CONFIG, INT_MODE, p_psConfig->b_int_mode) |
+    APP_BMP581_SET(INT_CONFIG, INT_POL, p_psConfig->b_int_pol) |
+    APP_BMP581_SET(INT_CONFIG, INT_OD, p_psConfig->b_int_od) |
+    APP_BMP581_SET(INT_CONFIG, INT_EN, p_psConfig->b_int_en) |
+    APP_BMP581_SET(INT_CONFIG, PAD_INT_DRV, p_psConfig->u8_pad_int_drv);
+  l_sRegisters.u_int_source.u8_raw =
+    APP_BMP581_SET(INT_SOURCE, DRDY_DATA_REG_EN, p_psConfig->b_drdy_data_reg_en) |
+    APP_BMP581_SET(INT_SOURCE, FIFO_FULL_EN, p_psConfig->b_fifo_full_en) |
+    APP_BMP581_SET(INT_SOURCE, FIFO_THS_EN, p_psConfig->b_fifo_ths_en) |
+    APP_BMP581_SET(INT_SOURCE, OOR_P_EN, p_psConfig->b_oor_p_en);
+  return l_sRegisters;
+}
+
+/**
+ * @brief Unpacks INT_CONFIG and INT_SOURCE
+ * 
+ * @param p_psRegisters the registers
+ * @param p_psConfig the configuration to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackIntConfig(const sBMP581IntRegs_t* p_psRegisters, sIntConfig_t* p_psConfig) {
+  p_psConfig->b_int_mode = p_psRegisters->u_int_config.s_bits.INT_MODE != 0;
+  p_psConfig->b_int_pol = p_psRegisters->u_int_config.s_bits.INT_POL != 0;
+  p_psConfig->b_int_od = p_psRegisters->u_int_config.s_bits.INT_OD != 0;
+  p_psConfig->b_int_en = p_psRegisters->u_int_config.s_bits.INT_EN != 0;
+  p_psConfig->u8_pad_int_drv = p_psRegisters->u_int_config.s_bits.PAD_INT_DRV;
+  p_psConfig->b_drdy_data_reg_en = p_psRegisters->u_int_source.s_bits.DRDY_DATA_REG_EN != 0;
+  p_psConfig->b_fifo_full_en = p_psRegisters->u_int_source.s_bits.FIFO_FULL_EN != 0;
+  p_psConfig->b_fifo_ths_en = p_psRegisters->u_int_source.s_bits.FIFO_THS_EN != 0;
+  p_psConfig->b_oor_p_en = p_psRegisters->u_int_source.s_bits.OOR_P_EN != 0;
+}
+
+/**
+ * @brief Packs a drive configuration into the DRIVE_CONFIG register
+ * 
+ * @param p_psConfig the configuration
+ * @return the DRIVE_CONFIG register
+ */
+static inline uBMP581_DRIVE_CONFIG_t uAPP_BMP581_packDriveConfig(const sDriveConfig_t* p_psConfig) {
+  uBMP581_DRIVE_CONFIG_t l_uRegister;
+
+  l_uRegister.u8_raw =
+    APP_BMP581_SET(DRIVE_CONFIG, I2C_CSB_PULL_EN, p_psConfig->b_i2c_csb_pull_en) |
+    APP_BMP581_SET(DRIVE_CONFIG, SPI3_EN, p_psConfig->b_spi3_en) |
+    APP_BMP581_SET(DRIVE_CONFIG, PAD_IF_DRV, p_psConfig->u8_pad_if_drv);
+  return l_uRegister;
+}
+
+/**
+ * @brief Unpacks the DRIVE_CONFIG register
+ * 
+ * @param p_uRegister the DRIVE_CONFIG register
+ * @param p_psConfig the configuration to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackDriveConfig(uBMP581_DRIVE_CONFIG_t p_uRegister, sDriveConfig_t* p_psConfig) {
+  p_psConfig->b_i2c_csb_pull_en = p_uRegister.s_bits.I2C_CSB_PULL_EN != 0;
+  p_psConfig->b_spi3_en = p_uRegister.s_bits.SPI3_EN != 0;
+  p_psConfig->u8_pad_if_drv = p_uRegister.s_bits.PAD_IF_DRV;
+}
+
+/**
+ * @brief Unpacks the OSR_EFF register
+ * 
+ * @param p_uRegister the OSR_EFF register
+ * @param p_psOSREff the effective OSR to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackOSREff(uBMP581_OSR_EFF_t p_uRegister, sOSREff_t* p_psOSREff) {
+  p_psOSREff->e_osr_t_eff = (eBMP581OSR_t)p_uRegister.s_bits.OSR_T_EFF;
+  p_psOSREff->e_osr_p_eff = (eBMP581OSR_t)p_uRegister.s_bits.OSR_P_EFF;
+  p_psOSREff->b_odr_is_valid = p_uRegister.s_bits.ODR_IS_VALID != 0;
+}
+
+/**
+ * @brief Unpacks the STATUS register
+ * 
+ * @param p_uRegister the STATUS register
+ * @param p_psStatus the status to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackStatus(uBMP581_STATUS_t p_uRegister, sStatus_t* p_psStatus) {
+  p_psStatus->b_status_core_rdy = p_uRegister.s_bits.CORE_RDY != 0;
+  p_psStatus->b_status_nvm_rdy = p_uRegister.s_bits.NVM_RDY != 0;
+  p_psStatus->b_status_nvm_err = p_uRegister.s_bits.NVM_ERR != 0;
+  p_psStatus->b_status_nvm_cmd_err = p_uRegister.s_bits.NVM_CMD_ERR != 0;
+  p_psStatus->b_status_boot_err_corrected = p_uRegister.s_bits.BOOT_ERR_CORRECTED != 0;
+  p_psStatus->b_st_crack_pass = p_uRegister.s_bits.ST_CRACK_PASS != 0;
+}
+
+/**
+ * @brief Unpacks the INT_STATUS register
+ * 
+ * @param p_uRegister the INT_STATUS register
+ * @param p_psIntStatus the interrupt status to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackIntStatus(uBMP581_INT_STATUS_t p_uRegister, sIntStatus_t* p_psIntStatus) {
+  p_psIntStatus->b_drdy_data_reg = p_uRegister.s_bits.DRDY_DATA_REG != 0;
+  p_psIntStatus->b_fifo_full = p_uRegister.s_bits.FIFO_FULL != 0;
+  p_psIntStatus->b_fifo_ths = p_uRegister.s_bits.FIFO_THS != 0;
+  p_psIntStatus->b_oor_p = p_uRegister.s_bits.OOR_P != 0;
+  p_psIntStatus->b_por = p_uRegister.s_bits.POR != 0;
+}
+
+/**
+ * @brief Unpacks the CHIP_STATUS register
+ * 
+ * @param p_uRegister the CHIP_STATUS register
+ * @param p_psChipStatus the chip status to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackChipStatus(uBMP581_CHIP_STATUS_t p_uRegister, sChipStatus_t* p_psChipStatus) {
+  p_psChipStatus->e_hif_mode = (eBMP581HIFMode_t)p_uRegister.s_bits.HIF_MODE;
+  p_psChipStatus->b_i3c_err_0 = p_uRegister.s_bits.I3C_ERR_0 != 0;
+  p_psChipStatus->b_i3c_err_3 = p_uRegister.s_bits.I3C_ERR_3 != 0;
+}
+
+/**
+ * @brief Unpacks the TEMP_DATA and PRESS_DATA registers into a sample
+ * 
+ * The timestamp is left to the caller.
+ * 
+ * @param p_pu8Data the 6 bytes read from TEMP_DATA_XLSB to PRESS_DATA_MSB
+ * @param p_psSample the sample to fill
+ * @return
+ */
+static inline void vAPP_BMP581_unpackData(const uint8_t* p_pu8Data, sBMP581Sample_t* p_psSample) {
+  /* Temperature is a signed 24-bit value, sign extended through the MSB */
+  p_psSample->s32_temp_raw = (int32_t)(
+    ((uint32_t)p_pu8Data[2] << 24) |
+    ((uint32_t)p_pu8Data[1] << 16) |
+    ((uint32_t)p_pu8Data[0] << 8)
+  ) / 256;
+  p_psSample->u32_press_raw =
+    ((uint32_t)p_pu8Data[5] << 16) |
+    ((uint32_t)p_pu8Data[4] << 8) |
+    (uint32_t)p_pu8Data[3];
+}
+
+#ifndef BMP581_NO_FIFO
+/**
+ * @brief Unpacks frames read from FIFO_DATA into samples
+ * 
+ * A frame holds the temperature then the pressure, 3 bytes each, or only
+ * the value selected by fifo_frame_sel; the other one is left at 0. The
+ * FIFO returns BMP581_FIFO_EMPTY bytes once drained, unpacking stops at
+ * such a frame. Timestamps are left to the caller.
+ * 
+ * @param p_pu8Data the bytes read from FIFO_DATA
+ * @param p_u32Size the number of bytes read
+ * @param p_eFrameSel the fifo_frame_sel the frames were stored with
+ * @param p_psSamples the samples to fill
+ * @param p_u32Max the size of p_psSamples
+ * @return the number of samples filled
+ */
+static inline uint32_t u32APP_BMP581_unpackFIFO(const uint8_t* p_pu8Data, uint32_t p_u32Size, eBMP581FIFOSel_t p_eFrameSel, sBMP581Sample_t* p_psSamples, uint32_t p_u32Max) {
+  const uint32_t l_u32FrameSize = (p_eFrameSel == ceAPP_BMP581_FIFO_PRESS_AND_TEMP) ? 6U : 3U;
+  uint32_t l_u32Count = 0;
+  uint32_t l_u32Offset;
+
+  if (p_eFrameSel == ceAPP_BMP581_FIFO_DISABLE) {
+    return 0;
+  }
+
+  for (
+    l_u32Offset = 0;
+    l_u32Offset + l_u32FrameSize <= p_u32Size && l_u32Count < p_u32Max;
+    l_u32Offset += l_u32FrameSize
+  ) {
+    const uint8_t* l_pu8Frame = &p_pu8Data[l_u32Offset];
+    sBMP581Sample_t* l_psSample = &p_psSamples[l_u32Count];
+
+    if (l_pu8Frame[0] == BMP581_FIFO_EMPTY && l_pu8Frame[1] == BMP581_FIFO_EMPTY && l_pu8Frame[2] == BMP581_FIFO_EMPTY) {
+      break;
+    }
+
+    if (p_eFrameSel == ceAPP_BMP581_FIFO_PRESS_AND_TEMP) {
+      vAPP_BMP581_unpackData(l_pu8Frame, l_psSample);
+    }
+    else if (p_eFrameSel == ceAPP_BMP581_FIFO_TEMP_ONLY) {
+      l_psSample->s32_temp_raw = (int32_t)(
+        ((uint32_t)l_pu8Frame[2] << 24) |
+        ((uint32_t)l_pu8Frame[1] << 16) |
+        ((uint32_t)l_pu8Frame[0] << 8)
+      ) / 256;
+      l_psSample->u32_press_raw = 0;
+    }
+    else {
+      l_psSample->s32_temp_raw = 0;
+      l_psSample->u32_press_raw =
+        ((uint32_t)l_pu8Frame[2] << 16) |
+        ((uint32_t)l_pu8Frame[1] << 8) |
+        (uint32_t)l_pu8Frame[0];
+    }
+    l_u32Count++;
+  }
+
+  return l_u32Count;
+}
+#endif
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _APP_BMP581_REGMAP_ */
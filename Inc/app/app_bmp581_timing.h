@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file           : app_bmp581_timing.h
+  * @brief          : Header file for BMP581 conversion timing tables
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/21
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _APP_BMP581_TIMING_
+#define _APP_BMP581_TIMING_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+#include "app/app_bmp581.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Struct holding the requirements given to the configuration solver
+ * 
+ * The sample rate is in mHz so the slowest ODR (0.125 Hz) stays an integer.
+ * The noise budget is the pressure RMS noise in mPa after IIR filtering and
+ * the current budget is the average supply current in nA.
+ */
+typedef struct {
+  uint32_t u32_rate_mhz;
+  uint32_t u32_noise_mpa;
+  uint32_t u32_current_na;
+} sBMP581Requirements_t;
+
+/**
+ * @brief Struct holding a configuration picked by the solver and its
+ * predicted performance
+ * 
+ */
+typedef struct {
+  eBMP581ODR_t e_odr;
+  eBMP581OSR_t e_osr_t;
+  eBMP581OSR_t e_osr_p;
+  eBMP581IRRFilter_t e_set_iir_p;
+  uint32_t u32_noise_mpa;
+  uint32_t u32_current_na;
+} sBMP581Solution_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define cAPP_BMP581_ACTIVE_CURRENT_UA  (uint32_t)720 //Supply current during a conversion
+#define cAPP_BMP581_STANDBY_CURRENT_NA (uint32_t)500 //Supply current between conversions
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+uint32_t u32APP_BMP581_getConversionTimeUs(eBMP581OSR_t p_eOSRTemp, eBMP581OSR_t p_eOSRPress, bool p_bPressEn);
+uint32_t u32APP_BMP581_getODRPeriodUs(eBMP581ODR_t p_eODR);
+uint32_t u32APP_BMP581_getODRFrequencyMHz(eBMP581ODR_t p_eODR);
+bool bAPP_BMP581_isODRValid(eBMP581ODR_t p_eODR, eBMP581OSR_t p_eOSRTemp, eBMP581OSR_t p_eOSRPress, bool p_bPressEn);
+uint32_t u32APP_BMP581_getPressNoiseMPa(eBMP581OSR_t p_eOSRPress, eBMP581IRRFilter_t p_eIIR);
+uint32_t u32APP_BMP581_getCurrentNA(eBMP581ODR_t p_eODR, eBMP581OSR_t p_eOSRTemp, eBMP581OSR_t p_eOSRPress);
+eBMP581Err_t errAPP_BMP581_solveConfig(const sBMP581Requirements_t* p_psRequirements, sBMP581Solution_t* p_psSolution);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _APP_BMP581_TIMING_ */
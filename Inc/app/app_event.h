@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file           : app_event.h
+  * @brief          : Header file for the application event flags and the
+  * event loop
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/30
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _APP_EVENT_
+#define _APP_EVENT_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdatomic.h>
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  ceAPP_EVENT_SAMPLE = 0,   //New samples in the BMP581 ring
+  ceAPP_EVENT_BUS_ERROR,    //I2C or SPI transfer failed
+  ceAPP_EVENT_HEARTBEAT,    //Periodic timer event
+  ceAPP_EVENT_SENSOR_READY, //BMP581 initialisation ended, successfully or not
+  ceAPP_EVENT_NB
+} eAppEvent_t;
+
+typedef void (*pfAPP_EventHandler_t)(void);
+
+/* Exported constants --------------------------------------------------------*/
+#define cAPP_EVENT_HEARTBEAT_MS (uint32_t)500
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vAPP_Event_init(void);
+void vAPP_Event_register(eAppEvent_t p_eEvent, pfAPP_EventHandler_t p_pfHandler);
+void vAPP_Event_post(eAppEvent_t p_eEvent);
+void vAPP_Event_run(void);
+uint32_t u32APP_Event_getWakeups(void);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _APP_EVENT_ */
@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file           : app_sample_ring.h
+  * @brief          : Header file for the single-producer single-consumer
+  * sample ring buffer
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/23
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _APP_SAMPLE_RING_
+#define _APP_SAMPLE_RING_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+#include "app/app_bmp581.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define cAPP_SAMPLE_RING_SIZE (uint32_t)64 //Must be a power of two
+#define cAPP_CACHE_LINE_SIZE  32           //Cortex-M7 D-cache line in bytes
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Struct holding a lock-free single-producer single-consumer ring
+ * 
+ * The producer (DMA complete interrupt) only writes u32_head and the
+ * overflow counters, the consumer (main loop) only writes u32_tail. Each
+ * side sits on its own cache line so they never share one. Indexes run
+ * freely and are masked on access, so the ring holds up to
+ * cAPP_SAMPLE_RING_SIZE samples.
+ */
+typedef struct {
+  volatile uint32_t u32_head __attribute__((aligned(cAPP_CACHE_LINE_SIZE)));
+  uint32_t u32_overflow_events;
+  uint32_t u32_dropped_samples;
+  volatile uint32_t u32_tail __attribute__((aligned(cAPP_CACHE_LINE_SIZE)));
+  sBMP581Sample_t as_samples[cAPP_SAMPLE_RING_SIZE] __attribute__((aligned(cAPP_CACHE_LINE_SIZE)));
+} sSampleRing_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vAPP_SampleRing_init(sSampleRing_t* p_psRing);
+
+/* Producer side */
+bool bAPP_SampleRing_push(sSampleRing_t* p_psRing, const sBMP581Sample_t* p_psSample);
+uint32_t u32APP_SampleRing_pushBulk(sSampleRing_t* p_psRing, const sBMP581Sample_t* p_psSamples, uint32_t p_u32Count);
+
+/* Consumer side */
+bool bAPP_SampleRing_pop(sSampleRing_t* p_psRing, sBMP581Sample_t* p_psSample);
+uint32_t u32APP_SampleRing_popBulk(sSampleRing_t* p_psRing, sBMP581Sample_t* p_psSamples, uint32_t p_u32Max);
+
+/* Either side */
+uint32_t u32APP_SampleRing_getCount(const sSampleRing_t* p_psRing);
+uint32_t u32APP_SampleRing_getOverflowEvents(const sSampleRing_t* p_psRing);
+uint32_t u32APP_SampleRing_getDroppedSamples(const sSampleRing_t* p_psRing);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _APP_SAMPLE_RING_ */
@@ -0,0 +1,59 @@
+/**
+  ******************************************************************************
+  * @file           : app_sample_snapshot.h
+  * @brief          : Header file for the triple-buffered latest sample
+  * snapshot
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/24
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _APP_SAMPLE_SNAPSHOT_
+#define _APP_SAMPLE_SNAPSHOT_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* Private includes ----------------------------------------------------------*/
+#include "app/app_bmp581.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Struct holding a wait-free triple buffer of the latest sample
+ * 
+ * The producer owns one slot, the consumer owns another, and the third is
+ * exchanged atomically between them together with a fresh flag. Neither
+ * side ever waits for the other or sees a half-written sample.
+ */
+typedef struct {
+  sBMP581Sample_t as_slots[3];
+  uint32_t u32_write_slot; //Producer side only
+  uint32_t u32_read_slot;  //Consumer side only
+  bool b_valid;            //Consumer side only
+  atomic_uint u32_middle;  //Slot index with the fresh flag
+} sSampleSnapshot_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vAPP_SampleSnapshot_init(sSampleSnapshot_t* p_psSnapshot);
+void vAPP_SampleSnapshot_publish(sSampleSnapshot_t* p_psSnapshot, const sBMP581Sample_t* p_psSample);
+bool bAPP_SampleSnapshot_read(sSampleSnapshot_t* p_psSnapshot, sBMP581Sample_t* p_psSample);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _APP_SAMPLE_SNAPSHOT_ */
@@ -0,0 +1,106 @@
+/**
+  ******************************************************************************
+  * @file           : hal_bus_policy.hpp
+  * @brief          : I2C and SPI bus policies of the C++ BMP581 driver
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HAL_BUS_POLICY_HPP_
+#define _HAL_BUS_POLICY_HPP_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "app/app_sensor_module.h"
+#include "hal/hal_i2c.h"
+#ifndef BMP581_NO_SPI
+#include "hal/hal_spi.h"
+#endif
+#include "hal/hal_dwt.h"
+#include "hal/hal_clock.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Busy waits on the DWT cycle counter and reads the HAL tick
+ * 
+ * Shared by the bus policies, vHAL_DWT_init must have been called.
+ */
+struct HALTimePolicy {
+  static void vDelayUs(uint32_t p_u32Us) {
+    const uint32_t l_u32Start = u32HAL_DWT_getCycles();
+
+    while (u32HAL_DWT_cyclesToUs(u32HAL_DWT_getCycles() - l_u32Start) < p_u32Us) {
+    }
+  }
+
+  static uint32_t u32NowMs() {
+    return u32HAL_Clock_getTick();
+  }
+};
+
+/**
+ * @brief Bus policy on I2C1 through the register-level engine
+ * 
+ * Blocking, it must not be used while the I2C queue owns the bus.
+ * 
+ * @tparam Address the 7-bit address of the BMP581
+ */
+template <uint8_t Address>
+struct I2CBusPolicy : HALTimePolicy {
+  static bool bRead(uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+    return bI2C_read_LL(&s_sSensor, p_u8Register, p_pu8Data, p_u16Size);
+  }
+
+  static bool bWrite(uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+    return bI2C_write_LL(&s_sSensor, p_u8Register, p_pu8Data, p_u16Size);
+  }
+
+  static sI2CSensor_t s_sSensor;
+};
+
+template <uint8_t Address>
+sI2CSensor_t I2CBusPolicy<Address>::s_sSensor = {
+  {"BMP581", ceApp_Sensor_PRESSURE, ceApp_Sensor_PASCAL},
+  Address,
+  1
+};
+
+#ifndef BMP581_NO_SPI
+/**
+ * @brief Bus policy on SPI1 with a GPIO chip select
+ * 
+ * Blocking, the chip select is driven low around each transfer.
+ * 
+ * @tparam CSPort the address of the GPIO port of the chip select
+ * @tparam CSPin the GPIO_PIN_x of the chip select
+ */
+template <uintptr_t CSPort, uint16_t CSPin>
+struct SPIBusPolicy : HALTimePolicy {
+  static bool bRead(uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+    bool l_bResult;
+
+    HAL_GPIO_WritePin(reinterpret_cast<GPIO_TypeDef*>(CSPort), CSPin, GPIO_PIN_RESET);
+    l_bResult = bSPI_memRead(p_u8Register, p_pu8Data, p_u16Size);
+    HAL_GPIO_WritePin(reinterpret_cast<GPIO_TypeDef*>(CSPort), CSPin, GPIO_PIN_SET);
+    return l_bResult;
+  }
+
+  static bool bWrite(uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+    bool l_bResult;
+
+    HAL_GPIO_WritePin(reinterpret_cast<GPIO_TypeDef*>(CSPort), CSPin, GPIO_PIN_RESET);
+    l_bResult = bSPI_memWrite(p_u8Register, p_pu8Data, p_u16Size);
+    HAL_GPIO_WritePin(reinterpret_cast<GPIO_TypeDef*>(CSPort), CSPin, GPIO_PIN_SET);
+    return l_bResult;
+  }
+};
+#endif
+
+#endif /* _HAL_BUS_POLICY_HPP_ */
@@ -17,6 +17,7 @@ extern "C" {
 #endif
 
 /* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
 
 /* Public includes -----------------------------------------------------------*/
 
@@ -29,6 +30,7 @@ extern "C" {
 /* Exported functions prototypes ---------------------------------------------*/
 void vHAL_Clock_init(void);
 void vHAL_Clock_delay(uint32_t pu32Delay);
+uint32_t u32HAL_Clock_getTick(void);
 
 /* Private defines -----------------------------------------------------------*/
 
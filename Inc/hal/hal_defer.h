@@ -0,0 +1,54 @@
+/**
+  ******************************************************************************
+  * @file           : hal_defer.h
+  * @brief          : Header file for the deferred-call queue run from PendSV
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/29
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HAL_DEFER_
+#define _HAL_DEFER_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public includes -----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*pfHAL_DeferCall_t)(void);
+
+typedef struct {
+  uint32_t u32_posted;
+  uint32_t u32_run;
+  uint32_t u32_dropped;             //Posts refused on a full queue
+  uint32_t u32_high_watermark;      //Deepest queue seen
+  uint32_t u32_max_latency_cycles;  //Worst post to run delay
+  uint32_t u32_last_latency_cycles;
+} sHAL_DeferStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define cHAL_DEFER_QUEUE_SIZE 16
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vHAL_Defer_init(void);
+bool bHAL_Defer_post(pfHAL_DeferCall_t p_pfCall);
+void vHAL_Defer_run(void);
+void vHAL_Defer_getStats(sHAL_DeferStats_t* p_psStats);
+void vHAL_Defer_resetStats(void);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_DEFER_ */
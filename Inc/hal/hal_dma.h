@@ -17,17 +17,40 @@ extern "C" {
 #endif
 
 /* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32h7xx_hal.h"
 
 /* Public includes -----------------------------------------------------------*/
 
 /* Exported types ------------------------------------------------------------*/
+typedef enum {
+  ceHAL_DMA_PROFILE_SINGLE = 0, //Direct mode, one bus transaction per byte
+  ceHAL_DMA_PROFILE_BURST,      //FIFO packing into words, 4 beat memory bursts
+  ceHAL_DMA_PROFILE_NB
+} eHAL_DMAProfile_t;
+
+typedef struct {
+  uint16_t u16_size;
+  uint32_t au32_transactions[ceHAL_DMA_PROFILE_NB]; //Memory side AHB transactions
+  uint32_t au32_drain_cycles[ceHAL_DMA_PROFILE_NB]; //Start to transfer complete, UINT32_MAX if one failed
+} sHAL_DMABenchmark_t;
 
 /* Exported constants --------------------------------------------------------*/
+/* Streams draining sensor data rank above the ones sending configuration */
+#define cHAL_DMA_PRIORITY_SPI_RX DMA_PRIORITY_VERY_HIGH
+#define cHAL_DMA_PRIORITY_I2C_RX DMA_PRIORITY_HIGH
+#define cHAL_DMA_PRIORITY_SPI_TX DMA_PRIORITY_MEDIUM
+#define cHAL_DMA_PRIORITY_I2C_TX DMA_PRIORITY_LOW
+
+#define cHAL_DMA_BURST_BYTES 16 //4 beats of one word
 
 /* Exported macro ------------------------------------------------------------*/
 
 /* Exported functions prototypes ---------------------------------------------*/
 void vHAL_DMA_init(void);
+eHAL_DMAProfile_t eHAL_DMA_selectProfile(const void* p_pvBuffer, uint32_t p_u32Size);
+void vHAL_DMA_applyProfile(DMA_HandleTypeDef* p_phDma, eHAL_DMAProfile_t p_eProfile, uint32_t p_u32Priority, uint32_t p_u32PeriphBurst);
+uint32_t u32HAL_DMA_getTransactions(eHAL_DMAProfile_t p_eProfile, uint32_t p_u32Size);
 
 /* Private defines -----------------------------------------------------------*/
 
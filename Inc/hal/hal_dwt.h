@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  * @file           : hal_dwt.h
+  * @brief          : Header file for the DWT cycle counter used for
+  * profiling
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/25
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HAL_DWT_
+#define _HAL_DWT_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Public includes -----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vHAL_DWT_init(void);
+uint32_t u32HAL_DWT_getCycles(void);
+uint32_t u32HAL_DWT_cyclesToUs(uint32_t p_u32Cycles);
+uint32_t u32HAL_DWT_usToCycles(uint32_t p_u32Us);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_DWT_ */
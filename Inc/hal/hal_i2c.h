@@ -17,13 +17,88 @@ extern "C" {
 #endif
 
 /* Includes ------------------------------------------------------------------*/
+#include <stdbool.h>
 #include "app/app_sensor_module.h"
+#include "hal/hal_transfer.h"
+#include "hal/hal_dma.h"
+#include "hal/hal_sched.h"
 
 /* Public includes -----------------------------------------------------------*/
 
 /* Exported types ------------------------------------------------------------*/
+typedef void (*pfI2C_TransferDone_t)(void* p_pvArg, bool p_bSuccess);
+
+/**
+ * @brief Struct describing one queued memory transfer
+ * 
+ * pu8_data is read or written by the bus after bI2C_submit returns and
+ * must stay valid until pf_done is called. pf_done is called in PendSV,
+ * NULL when no notification is needed.
+ */
+typedef struct {
+  sI2CSensor_t* ps_sensor;
+  uint8_t u8_register;
+  bool b_read;
+  uint8_t* pu8_data;
+  uint16_t u16_size;
+  pfI2C_TransferDone_t pf_done;
+  void* pv_arg;
+} sI2CTransfer_t;
+
+/**
+ * @brief Struct holding the error recovery counters of the transfer queue
+ * 
+ * Cycle counts are CPU cycles from the start of the bus clear to the end
+ * of the peripheral re-initialisation, soft resets are not timed.
+ */
+typedef struct {
+  uint32_t u32_errors;      //Queued transfers that failed or timed out
+  uint32_t u32_retries;     //Transfers replayed after a recovery
+  uint32_t u32_abandoned;   //Transfers notified as failed after the last retry
+  uint32_t u32_soft_resets; //Failures that left the bus idle, peripheral disabled and re-enabled only
+  uint32_t u32_recoveries;  //Bus clears and RCC resets, after an arbitration loss, a timeout or with SDA low
+  uint32_t u32_bus_clears;  //Recoveries that clocked a stuck SDA free
+  uint32_t u32_stuck;       //Recoveries that left SDA low
+  uint32_t u32_last_cycles;
+  uint32_t u32_max_cycles;
+} sI2CRecoveryStats_t;
+
+/**
+ * @brief Struct holding the cost of one memory read per transfer path
+ * 
+ * Cycle counts are CPU cycles from the call to the last byte received,
+ * averaged over cI2C_BENCH_REPS reads, UINT32_MAX if a read failed or
+ * timed out.
+ */
+typedef struct {
+  uint16_t u16_size;
+  uint32_t u32_hal_poll_cycles;
+  uint32_t u32_hal_dma_cycles;
+  uint32_t u32_ll_cycles;
+} sI2CBenchmark_t;
+
+#ifdef I2C_FAULT_INJECTION
+/**
+ * @brief Enumeration defining the faults forced on queued transfers
+ * 
+ */
+typedef enum {
+  ceI2C_FAULT_NONE = 0,
+  ceI2C_FAULT_NACK,         //Fails as if the device did not acknowledge
+  ceI2C_FAULT_ARB_LOST,     //Fails as if another master won the bus
+  ceI2C_FAULT_TIMEOUT,      //Never completes, as with SCL or SDA held low
+} eI2CFault_t;
+#endif
 
 /* Exported constants --------------------------------------------------------*/
+#define cI2C_LL_MAX_SIZE     (uint16_t)8 //Blocking transfers up to this size use the register-level path
+#define cI2C_QUEUE_SIZE      16 //Transfers queued at once, power of 2
+#define cI2C_RETRY_MAX       2  //Replays of a failed queued transfer
+#define cI2C_WATCHDOG_US     (uint32_t)1000 //Queued transfer timeout, plus cI2C_WATCHDOG_BYTE_US per byte
+#define cI2C_WATCHDOG_BYTE_US (uint32_t)100 //One byte at 100 kHz
+#define cI2C_BENCH_SIZE_NB   6
+#define cI2C_BENCH_REPS      16
+#define cI2C_DMA_BENCH_SIZE_NB 2
 
 /* Exported macro ------------------------------------------------------------*/
 
@@ -36,6 +111,21 @@ void vI2C_write_DMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8WriteAddress, ui
 void vI2C_write(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8WriteAddress, uint8_t p_pu8Data, uint16_t p_u16Size);
 void vI2C_read_DMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress, uint8_t* p_pu8Data, uint16_t p_u16Size);
 void vI2C_read(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress, uint8_t* p_pu8Data, uint16_t p_u16Size);
+bool bI2C_read_LL(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress, uint8_t* p_pu8Data, uint16_t p_u16Size);
+bool bI2C_write_LL(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8WriteAddress, const uint8_t* p_pu8Data, uint16_t p_u16Size);
+bool bI2C_submit(const sI2CTransfer_t* p_psTransfer);
+uint32_t u32I2C_getQueueDepth(void);
+void vI2C_getRecoveryStats(sI2CRecoveryStats_t* p_psStats);
+#ifdef I2C_FAULT_INJECTION
+void vI2C_injectFault(eI2CFault_t p_eFault, uint32_t p_u32Count);
+#endif
+void vI2C_calibrate(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress);
+const sHAL_TransferDispatch_t* psI2C_getDispatch(void);
+sHAL_SchedResource_t* psI2C_getResource(void);
+void vI2C_benchmark(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress);
+const sI2CBenchmark_t* psI2C_getBenchmark(void);
+void vI2C_benchmarkDMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress);
+const sHAL_DMABenchmark_t* psI2C_getDMABenchmark(void);
 
 /* Private defines -----------------------------------------------------------*/
 
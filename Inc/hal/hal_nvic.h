@@ -0,0 +1,91 @@
+/**
+  ******************************************************************************
+  * @file           : hal_nvic.h
+  * @brief          : Header file for the interrupt priority map and the
+  * ISR entry latency measurement
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/28
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HAL_NVIC_
+#define _HAL_NVIC_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "stm32h7xx_hal.h"
+
+/* Public includes -----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef struct {
+  IRQn_Type e_irq;
+  uint32_t u32_preempt;
+  uint32_t u32_max_cycles; //Worst pend to handler entry latency
+  uint32_t u32_samples;
+} sHAL_NVICLatency_t;
+
+/* Exported constants --------------------------------------------------------*/
+/* 4 bits of preemption priority, no sub-priority: nesting is by level only */
+#define cHAL_NVIC_GROUPING          NVIC_PRIORITYGROUP_4
+
+/* Preemption levels, lower is more urgent */
+#define cHAL_NVIC_PRIO_SENSOR       (uint32_t)1  //Sensor interrupt, acquisition trigger
+#define cHAL_NVIC_PRIO_DMA_RX       (uint32_t)2  //Data drain completion
+#define cHAL_NVIC_PRIO_DMA_TX       (uint32_t)3
+#define cHAL_NVIC_PRIO_BUS_EVENT    (uint32_t)4
+#define cHAL_NVIC_PRIO_BUS_ERROR    (uint32_t)5
+#define cHAL_NVIC_PRIO_TASK_FIRST   (uint32_t)6  //Scheduler tasks, see hal_sched
+#define cHAL_NVIC_PRIO_TASK_LAST    (uint32_t)14
+#define cHAL_NVIC_PRIO_TICK         TICK_INT_PRIORITY
+#define cHAL_NVIC_PRIO_DEFERRED     (uint32_t)15 //PendSV, deferred calls
+
+#ifdef BMP581_NO_SPI
+#define cHAL_NVIC_MAP_SIZE          6
+#else
+#define cHAL_NVIC_MAP_SIZE          9
+#endif
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vHAL_NVIC_init(void);
+void vHAL_NVIC_enable(IRQn_Type p_eIRQn);
+void vHAL_NVIC_disable(IRQn_Type p_eIRQn);
+uint32_t u32HAL_NVIC_getPriority(IRQn_Type p_eIRQn);
+#ifdef HAL_NVIC_LATENCY_MEASURE
+void vHAL_NVIC_recordEntry(IRQn_Type p_eIRQn);
+void vHAL_NVIC_probeNext(void);
+void vHAL_NVIC_resetLatency(void);
+#endif
+uint32_t u32HAL_NVIC_getLatency(sHAL_NVICLatency_t* p_psLatency, uint32_t p_u32Max);
+
+/**
+ * @brief Marks the entry of a mapped interrupt handler
+ * 
+ * Must be the first statement of the handler. Compiles to nothing unless
+ * HAL_NVIC_LATENCY_MEASURE is defined.
+ * 
+ * @param p_eIRQn the interrupt being handled
+ * @return
+ */
+static inline void vHAL_NVIC_latencyEntry(IRQn_Type p_eIRQn) {
+#ifdef HAL_NVIC_LATENCY_MEASURE
+  vHAL_NVIC_recordEntry(p_eIRQn);
+#else
+  (void)p_eIRQn;
+#endif
+}
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_NVIC_ */
@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file           : hal_sched.h
+  * @brief          : Header file for the run-to-completion task scheduler
+  * built on software-pended NVIC vectors
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/31
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HAL_SCHED_
+#define _HAL_SCHED_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public includes -----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  ceHAL_SCHED_TASK_0 = 0,
+  ceHAL_SCHED_TASK_1,
+  ceHAL_SCHED_TASK_2,
+  ceHAL_SCHED_TASK_3,
+  ceHAL_SCHED_TASK_NB
+} eHAL_SchedTask_t;
+
+typedef void (*pfHAL_SchedTask_t)(void);
+
+/**
+ * @brief Resource shared between tasks and interrupts
+ * 
+ * The ceiling is the most urgent priority of all its users. Locking raises
+ * BASEPRI to the ceiling so no other user can preempt the owner.
+ * 
+ */
+typedef struct {
+  uint32_t u32_ceiling;
+} sHAL_SchedResource_t;
+
+typedef struct {
+  uint32_t u32_priority;
+  uint32_t u32_activations;
+  uint32_t u32_runs;
+} sHAL_SchedTaskStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define cHAL_SCHED_NO_CEILING (uint32_t)0xFF
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vHAL_Sched_init(void);
+bool bHAL_Sched_setTask(eHAL_SchedTask_t p_eTask, pfHAL_SchedTask_t p_pfTask, uint32_t p_u32Priority);
+void vHAL_Sched_activate(eHAL_SchedTask_t p_eTask);
+void vHAL_Sched_initResource(sHAL_SchedResource_t* p_psResource);
+void vHAL_Sched_addUser(sHAL_SchedResource_t* p_psResource, uint32_t p_u32Priority);
+void vHAL_Sched_addTaskUser(sHAL_SchedResource_t* p_psResource, eHAL_SchedTask_t p_eTask);
+uint32_t u32HAL_Sched_lock(const sHAL_SchedResource_t* p_psResource);
+void vHAL_Sched_unlock(uint32_t p_u32Key);
+void vHAL_Sched_getStats(eHAL_SchedTask_t p_eTask, sHAL_SchedTaskStats_t* p_psStats);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_SCHED_ */
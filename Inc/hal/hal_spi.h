@@ -19,15 +19,30 @@ extern "C" {
 /* Includes ------------------------------------------------------------------*/
 
 /* Public includes -----------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal/hal_transfer.h"
+#include "hal/hal_dma.h"
 
 /* Exported types ------------------------------------------------------------*/
+typedef void (*pfSPI_Callback_t)(void);
 
 /* Exported constants --------------------------------------------------------*/
+#define cSPI_DMA_BENCH_SIZE_NB 4
+#define cSPI_READ_BIT          (uint8_t)0x80 //Set in the register address of a read
 
 /* Exported macro ------------------------------------------------------------*/
 
 /* Exported functions prototypes ---------------------------------------------*/
 void vSPI_init(void);
+void vSPI_setCallbacks(pfSPI_Callback_t p_pfTxRxCplt, pfSPI_Callback_t p_pfError);
+bool bSPI_transferAuto(const uint8_t* p_pu8TxData, uint8_t* p_pu8RxData, uint16_t p_u16Size);
+bool bSPI_memRead(uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size);
+bool bSPI_memWrite(uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size);
+void vSPI_calibrate(void);
+const sHAL_TransferDispatch_t* psSPI_getDispatch(void);
+void vSPI_benchmarkDMA(void);
+const sHAL_DMABenchmark_t* psSPI_getDMABenchmark(void);
 
 /* Private defines -----------------------------------------------------------*/
 
@@ -0,0 +1,44 @@
+/**
+  ******************************************************************************
+  * @file           : hal_tim.h
+  * @brief          : Header file for STM32 timers used to schedule sensor
+  * acquisitions
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/21
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HAL_TIM_
+#define _HAL_TIM_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public includes -----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*pfHAL_TIM_Callback_t)(void);
+
+/* Exported constants --------------------------------------------------------*/
+#define cHAL_TIM_TICK_HZ (uint32_t)1000000 //Timer tick of 1 us
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vHAL_TIM_init(void);
+bool bHAL_TIM_startTrigger(uint32_t p_u32PeriodUs, uint32_t p_u32DelayUs, pfHAL_TIM_Callback_t p_pfTrigger, pfHAL_TIM_Callback_t p_pfDelayed);
+void vHAL_TIM_stopTrigger(void);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_TIM_ */
@@ -0,0 +1,66 @@
+/**
+  ******************************************************************************
+  * @file           : hal_timer.h
+  * @brief          : Header file for the tickless microsecond timer service
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/04
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HAL_TIMER_
+#define _HAL_TIMER_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Public includes -----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*pfHAL_TimerCallback_t)(void* p_pvArg);
+
+/**
+ * @brief One-shot or periodic software timer
+ * 
+ * Owned by the caller and must stay valid while armed. Fields are private
+ * to the timer service.
+ * 
+ */
+typedef struct {
+  uint32_t u32_deadline;          //Expiry time in us
+  uint32_t u32_period_us;         //0 for a one-shot timer
+  pfHAL_TimerCallback_t pf_callback;
+  void* pv_arg;
+  uint32_t u32_heap_index;        //cHAL_TIMER_NOT_ARMED when stopped
+} sHAL_Timer_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define cHAL_TIMER_HEAP_SIZE  1024           //Timers armed at once
+#define cHAL_TIMER_NOT_ARMED  (uint32_t)0xFFFFFFFF
+#define cHAL_TIMER_MAX_US     (uint32_t)0x7FFFFFFF //Longest delay or period
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vHAL_Timer_init(void);
+uint32_t u32HAL_Timer_now(void);
+void vHAL_Timer_create(sHAL_Timer_t* p_psTimer, pfHAL_TimerCallback_t p_pfCallback, void* p_pvArg);
+bool bHAL_Timer_start(sHAL_Timer_t* p_psTimer, uint32_t p_u32DelayUs, uint32_t p_u32PeriodUs);
+void vHAL_Timer_stop(sHAL_Timer_t* p_psTimer);
+bool bHAL_Timer_isArmed(const sHAL_Timer_t* p_psTimer);
+uint32_t u32HAL_Timer_getArmedCount(void);
+void vHAL_Timer_sleepUs(uint32_t p_u32DelayUs);
+void vHAL_Timer_idle(void);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_TIMER_ */
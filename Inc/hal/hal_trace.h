@@ -0,0 +1,156 @@
+/**
+  ******************************************************************************
+  * @file           : hal_trace.h
+  * @brief          : Header file for the bus transaction tracer and the
+  * layout of its ring, shared with the host timeline converter
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HAL_TRACE_
+#define _HAL_TRACE_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal/hal_transfer.h"
+
+/* Public includes -----------------------------------------------------------*/
+
+/* Exported constants --------------------------------------------------------*/
+#ifndef cHAL_TRACE_RECORD_NB
+#define cHAL_TRACE_RECORD_NB 256 //Last transactions kept, power of 2
+#endif
+#define cHAL_TRACE_MAGIC     (uint32_t)0x45435254 //"TRCE" in memory
+#define cHAL_TRACE_VERSION   (uint16_t)1
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Enumeration defining the traced buses
+ *
+ */
+typedef enum {
+  ceHAL_TRACE_I2C1 = 0,
+  ceHAL_TRACE_SPI1,
+  ceHAL_TRACE_BUS_NB,
+} eHAL_TraceBus_t;
+
+/**
+ * @brief Enumeration defining the outcome of a traced transaction
+ *
+ */
+typedef enum {
+  ceHAL_TRACE_OK = 0,
+  ceHAL_TRACE_ERROR,        //NACK, arbitration lost, bus or DMA error
+  ceHAL_TRACE_TIMEOUT,      //Aborted by the queue watchdog
+  ceHAL_TRACE_RESULT_NB,
+} eHAL_TraceResult_t;
+
+/**
+ * @brief Struct holding one bus transaction, 16 bytes
+ *
+ * Times are DWT cycles, the end one is taken when the completion is seen:
+ * after the polled transfer or at the start of the completion interrupt.
+ * The SPI chip select is left to the caller, u8_address is 0 there and
+ * u8_register is the first byte sent without its read bit.
+ */
+typedef struct {
+  uint32_t u32_start_cycles;
+  uint32_t u32_end_cycles;
+  uint16_t u16_size;        //Data bytes, register address excluded
+  uint8_t u8_bus;           //eHAL_TraceBus_t
+  uint8_t u8_address;       //7-bit I2C address
+  uint8_t u8_register;
+  uint8_t u8_read;          //1 for a read
+  uint8_t u8_mode;          //eHAL_TransferMode_t
+  uint8_t u8_result;        //eHAL_TraceResult_t
+} sHAL_TraceRecord_t;
+
+/**
+ * @brief Struct holding the trace ring as dumped to a file
+ *
+ * The ring keeps the last cHAL_TRACE_RECORD_NB transactions in completion
+ * order, the oldest one at u32_written % u16_record_nb once it wrapped.
+ * Dumped as is, little-endian, e.g. from a debugger with
+ * "dump binary value trace.bin g_sHAL_Trace".
+ */
+typedef struct {
+  uint32_t u32_magic;
+  uint16_t u16_version;
+  uint16_t u16_record_nb;
+  uint32_t u32_cpu_hz;      //Rate of the cycle counts
+  uint32_t u32_written;     //Transactions recorded since the init
+  sHAL_TraceRecord_t as_records[cHAL_TRACE_RECORD_NB];
+} sHAL_TraceBuffer_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+#ifdef HAL_BUS_TRACE
+extern sHAL_TraceBuffer_t g_sHAL_Trace;
+
+void vHAL_Trace_init(void);
+void vHAL_Trace_begin(eHAL_TraceBus_t p_eBus, uint8_t p_u8Address, uint8_t p_u8Register, bool p_bRead, uint16_t p_u16Size, eHAL_TransferMode_t p_eMode);
+void vHAL_Trace_end(eHAL_TraceBus_t p_eBus, eHAL_TraceResult_t p_eResult);
+const sHAL_TraceBuffer_t* psHAL_Trace_get(void);
+#endif
+
+/**
+ * @brief Marks the start of a bus transaction
+ *
+ * Compiles to nothing unless HAL_BUS_TRACE is defined.
+ *
+ * @param p_eBus the bus
+ * @param p_u8Address the 7-bit device address
+ * @param p_u8Register the first register
+ * @param p_bRead true for a read
+ * @param p_u16Size the number of data bytes
+ * @param p_eMode how the transfer is driven
+ * @return
+ */
+static inline void vHAL_Trace_transferBegin(eHAL_TraceBus_t p_eBus, uint8_t p_u8Address, uint8_t p_u8Register, bool p_bRead, uint16_t p_u16Size, eHAL_TransferMode_t p_eMode) {
+#ifdef HAL_BUS_TRACE
+  vHAL_Trace_begin(p_eBus, p_u8Address, p_u8Register, p_bRead, p_u16Size, p_eMode);
+#else
+  (void)p_eBus;
+  (void)p_u8Address;
+  (void)p_u8Register;
+  (void)p_bRead;
+  (void)p_u16Size;
+  (void)p_eMode;
+#endif
+}
+
+/**
+ * @brief Marks the end of the bus transaction started last on a bus
+ *
+ * Ignored when no transaction is open on the bus. Compiles to nothing
+ * unless HAL_BUS_TRACE is defined.
+ *
+ * @param p_eBus the bus
+ * @param p_eResult the outcome
+ * @return
+ */
+static inline void vHAL_Trace_transferEnd(eHAL_TraceBus_t p_eBus, eHAL_TraceResult_t p_eResult) {
+#ifdef HAL_BUS_TRACE
+  vHAL_Trace_end(p_eBus, p_eResult);
+#else
+  (void)p_eBus;
+  (void)p_eResult;
+#endif
+}
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_TRACE_ */
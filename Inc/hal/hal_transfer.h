@@ -0,0 +1,71 @@
+/**
+  ******************************************************************************
+  * @file           : hal_transfer.h
+  * @brief          : Header file for the bus transfer mode selection
+  * shared by the I2C and SPI drivers
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/28
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HAL_TRANSFER_
+#define _HAL_TRANSFER_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Public includes -----------------------------------------------------------*/
+
+/* Exported constants --------------------------------------------------------*/
+#define cHAL_TRANSFER_CAL_SIZE_NB 8
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Enumeration defining how a bus transfer is driven
+ * 
+ */
+typedef enum {
+  ceHAL_TRANSFER_POLLING = 0,
+  ceHAL_TRANSFER_IT,
+  ceHAL_TRANSFER_DMA,
+  ceHAL_TRANSFER_MODE_NB,
+} eHAL_TransferMode_t;
+
+/**
+ * @brief Struct holding the crossover thresholds and usage counters of a
+ * bus dispatcher
+ * 
+ * Transfers shorter than u16_it_threshold are polled, transfers shorter
+ * than u16_dma_threshold use interrupts, longer ones use DMA.
+ */
+typedef struct {
+  uint16_t u16_it_threshold;
+  uint16_t u16_dma_threshold;
+  uint32_t au32_transfers[ceHAL_TRANSFER_MODE_NB];
+  uint32_t au32_bytes[ceHAL_TRANSFER_MODE_NB];
+  uint32_t au32_cal_cycles[cHAL_TRANSFER_CAL_SIZE_NB][ceHAL_TRANSFER_MODE_NB];
+} sHAL_TransferDispatch_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vHAL_Transfer_init(sHAL_TransferDispatch_t* p_psDispatch);
+eHAL_TransferMode_t eHAL_Transfer_select(sHAL_TransferDispatch_t* p_psDispatch, uint16_t p_u16Size);
+eHAL_TransferMode_t eHAL_Transfer_pick(const sHAL_TransferDispatch_t* p_psDispatch, uint16_t p_u16Size);
+void vHAL_Transfer_count(sHAL_TransferDispatch_t* p_psDispatch, eHAL_TransferMode_t p_eMode, uint16_t p_u16Size);
+uint16_t u16HAL_Transfer_getCalSize(uint32_t p_u32Index);
+void vHAL_Transfer_applyCalibration(sHAL_TransferDispatch_t* p_psDispatch);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HAL_TRANSFER_ */
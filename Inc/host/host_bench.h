@@ -0,0 +1,82 @@
+/**
+  ******************************************************************************
+  * @file           : host_bench.h
+  * @brief          : Header file for the two BMP581 driver paths compared by
+  * the host driver benchmark: a C bus ops table and the C++ bus policies
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HOST_BENCH_
+#define _HOST_BENCH_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+#include "app/app_bmp581.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef bool (*pfHostBench_Read_t)(void* p_pvBus, uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size);
+typedef bool (*pfHostBench_Write_t)(void* p_pvBus, uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size);
+typedef void (*pfHostBench_DelayUs_t)(void* p_pvBus, uint32_t p_u32Us);
+typedef uint32_t (*pfHostBench_NowMs_t)(void* p_pvBus);
+
+/**
+ * @brief Struct describing a bus as a table of operations
+ * 
+ * The runtime dispatch the C++ bus policies replace.
+ */
+typedef struct {
+  pfHostBench_Read_t pf_read;
+  pfHostBench_Write_t pf_write;
+  pfHostBench_DelayUs_t pf_delay_us;
+  pfHostBench_NowMs_t pf_now_ms;
+  void* pv_bus;
+} sHostBenchBusOps_t;
+
+/**
+ * @brief Enumeration defining the buses of the benchmark
+ * 
+ */
+typedef enum {
+  ceHOST_BENCH_BUS_RAM = 0, //Register file in RAM, isolates the driver cost
+  ceHOST_BENCH_BUS_SIM,     //Fault free simulated I2C bus and BMP581
+  ceHOST_BENCH_BUS_NB,
+} eHostBenchBus_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define cHOST_BENCH_ADDRESS BMP581_I2C_ADDR_PRIM
+#define cHOST_BENCH_RAM_NB  128 //Register file of the RAM bus
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/* Shared, host_bench_ops.c */
+extern uint8_t g_au8HostBenchRam[cHOST_BENCH_RAM_NB];
+void vHostBench_resetRam(void);
+
+/* C path, host_bench_ops.c */
+const sHostBenchBusOps_t* psHostBench_getOps(eHostBenchBus_t p_eBus);
+eBMP581Err_t errHostBench_opsInit(const sHostBenchBusOps_t* p_psOps, uBMP581Registers_t* p_puRegisters, sOSRConfig_t p_sOSRConfig);
+eBMP581Err_t errHostBench_opsMeasure(const sHostBenchBusOps_t* p_psOps, uBMP581Registers_t* p_puRegisters, sBMP581Sample_t* p_psSample);
+
+/* C++ path, host_bench_cpp.cpp */
+eBMP581Err_t errHostBench_cppInit(eHostBenchBus_t p_eBus, sOSRConfig_t p_sOSRConfig);
+eBMP581Err_t errHostBench_cppMeasure(eHostBenchBus_t p_eBus, sBMP581Sample_t* p_psSample);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HOST_BENCH_ */
@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file           : host_hal.h
+  * @brief          : Header file for the virtual-time models behind the host
+  * STM32 HAL shim: run control, stimuli and statistics
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HOST_HAL_
+#define _HOST_HAL_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+#include "stm32h7xx_hal.h"
+
+/* Exported types ------------------------------------------------------------*/
+typedef int (*pfHostHAL_Main_t)(void);
+
+/**
+ * @brief Struct holding the parameters of a run
+ *
+ */
+typedef struct {
+  uint64_t u64_duration_ns; //Virtual time the run stops at
+  uint32_t u32_access_ns;   //Virtual time taken by a register access or HAL call
+} sHostHALConfig_t;
+
+/**
+ * @brief Struct holding the statistics of a run
+ *
+ */
+typedef struct {
+  uint64_t u64_now_ns;
+  uint64_t u64_sleep_ns;    //Spent in WFI
+  uint64_t u64_accesses;    //Register accesses and HAL calls
+  uint64_t u64_irqs;        //Handlers run, exceptions included
+  uint32_t u32_pumps;       //Waits with no access broken by the CPU time pump
+  uint32_t u32_i2c_ll;      //Register-level transfers
+  uint32_t u32_i2c_it;
+  uint32_t u32_i2c_dma;
+  uint32_t u32_i2c_blocking;
+  uint32_t u32_i2c_errors;  //NACK, arbitration loss and DMA errors reported
+  uint32_t u32_i2c_resets;  //I2C1 kernel resets
+  uint32_t u32_spi;
+  uint32_t u32_exti;        //EXTI lines raised
+  bool b_idle_end;          //Stopped in WFI with nothing left to wake it
+} sHostHALStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define cHOST_HAL_ACCESS_NS_DEFAULT 50U
+#define cHOST_HAL_EXTI_QUEUE_SIZE   64U
+#define cHOST_HAL_I2C_BUFFER_SIZE   256U //Largest HAL transfer modelled
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vHostHAL_init(const sHostHALConfig_t* p_psConfig);
+uint64_t u64HostHAL_run(pfHostHAL_Main_t p_pfMain);
+uint64_t u64HostHAL_getNowNs(void);
+bool bHostHAL_scheduleEXTI(uint16_t p_u16Pin, uint64_t p_u64AtNs);
+uint32_t u32HostHAL_getToggles(const GPIO_TypeDef* p_psPort, uint16_t p_u16Pin);
+void vHostHAL_getStats(sHostHALStats_t* p_psStats);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HOST_HAL_ */
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file           : host_harness.h
+  * @brief          : Header file for the host benchmark harness: warmup,
+  * timed repetitions, median and p99, table or JSON report
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HOST_HARNESS_
+#define _HOST_HARNESS_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef void (*pfHostHarness_Setup_t)(void* p_pvContext);
+typedef uint32_t (*pfHostHarness_Run_t)(void* p_pvContext, uint32_t p_u32Iterations);
+
+/**
+ * @brief Struct describing a benchmark case
+ * 
+ * pf_run runs p_u32Iterations iterations and returns a checksum of what
+ * they computed, folded into g_u32HostHarnessSink so nothing is optimised
+ * away. An iteration handles u32_items items (samples, transfers...).
+ */
+typedef struct {
+  const char* pc_name;
+  pfHostHarness_Setup_t pf_setup; //NULL if none, run once before the warmup
+  pfHostHarness_Run_t pf_run;
+  void* pv_context;
+  uint32_t u32_iterations;        //Iterations timed together in a repetition
+  uint32_t u32_items;
+} sHostHarnessCase_t;
+
+/**
+ * @brief Struct holding the parameters of a harness run
+ * 
+ */
+typedef struct {
+  uint32_t u32_warmup;      //Untimed repetitions
+  uint32_t u32_repetitions; //Timed repetitions, at most cHOST_HARNESS_REPETITION_MAX
+} sHostHarnessConfig_t;
+
+/**
+ * @brief Struct holding the statistics of a case, per iteration
+ * 
+ */
+typedef struct {
+  double d_median_ns;
+  double d_p99_ns;
+  double d_min_ns;
+  double d_max_ns;
+  double d_items_per_s; //From the median
+  uint32_t u32_checksum;
+} sHostHarnessStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define cHOST_HARNESS_REPETITION_MAX 10000
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+extern volatile uint32_t g_u32HostHarnessSink;
+
+void vHostHarness_run(const sHostHarnessConfig_t* p_psConfig, const sHostHarnessCase_t* p_psCase, sHostHarnessStats_t* p_psStats);
+void vHostHarness_printTable(FILE* p_pFile, const sHostHarnessCase_t* p_psCases, const sHostHarnessStats_t* p_psStats, uint32_t p_u32Count);
+void vHostHarness_printJSON(FILE* p_pFile, const sHostHarnessConfig_t* p_psConfig, const sHostHarnessCase_t* p_psCases, const sHostHarnessStats_t* p_psStats, uint32_t p_u32Count);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HOST_HARNESS_ */
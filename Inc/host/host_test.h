@@ -0,0 +1,49 @@
+/**
+  ******************************************************************************
+  * @file           : host_test.h
+  * @brief          : Header file for the host unit test checks, counted and
+  * reported to ctest through the exit code
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HOST_TEST_
+#define _HOST_TEST_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+
+/* Exported constants --------------------------------------------------------*/
+#define cHOST_TEST_FAILURES_PRINTED 20 //Failures printed before they are only counted
+
+/* Exported macro ------------------------------------------------------------*/
+
+/**
+ * @brief Checks a condition, printing the printf style message on failure
+ * 
+ */
+#define HOST_TEST_CHECK(p_bPassed, ...) vHostTest_check((p_bPassed), __FILE__, __LINE__, __VA_ARGS__)
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vHostTest_check(bool p_bPassed, const char* p_pcFile, int p_iLine, const char* p_pcFormat, ...)
+  __attribute__((format(printf, 4, 5)));
+int iHostTest_report(const char* p_pcName);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HOST_TEST_ */
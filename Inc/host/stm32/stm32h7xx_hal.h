@@ -0,0 +1,806 @@
+/**
+  ******************************************************************************
+  * @file           : stm32h7xx_hal.h
+  * @brief          : Host stand-in of the STM32H7 HAL and CMSIS subset used
+  * by the firmware, backed by the virtual-time models of host_hal.c
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _HOST_STM32H7XX_HAL_
+#define _HOST_STM32H7XX_HAL_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Only found by the host targets, which put Inc/host/stm32 ahead of the
+ * include path. Names, types and constants follow the STM32Cube HAL so
+ * Src/hal, Src/app and Src/system build unmodified. Values are the
+ * register encodings of the H723 where the firmware tests them, arbitrary
+ * elsewhere.
+ *
+ * The peripherals polled at register level (TIM2, TIM5, I2C1, DWT, SCB)
+ * are accessor calls: each access lets the models catch up with the
+ * firmware writes, advances the virtual time by one access and delivers
+ * the interrupts that became due.
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  HAL_OK = 0x00U,
+  HAL_ERROR = 0x01U,
+  HAL_BUSY = 0x02U,
+  HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+  HAL_UNLOCKED = 0x00U,
+  HAL_LOCKED = 0x01U
+} HAL_LockTypeDef;
+
+typedef enum {
+  NonMaskableInt_IRQn = -14,
+  HardFault_IRQn = -13,
+  MemoryManagement_IRQn = -12,
+  BusFault_IRQn = -11,
+  UsageFault_IRQn = -10,
+  SVCall_IRQn = -5,
+  DebugMonitor_IRQn = -4,
+  PendSV_IRQn = -2,
+  SysTick_IRQn = -1,
+  EXTI0_IRQn = 6,
+  EXTI1_IRQn = 7,
+  EXTI2_IRQn = 8,
+  EXTI3_IRQn = 9,
+  EXTI4_IRQn = 10,
+  DMA1_Stream0_IRQn = 11,
+  DMA1_Stream1_IRQn = 12,
+  DMA1_Stream2_IRQn = 13,
+  DMA1_Stream3_IRQn = 14,
+  EXTI9_5_IRQn = 23,
+  TIM2_IRQn = 28,
+  I2C1_EV_IRQn = 31,
+  I2C1_ER_IRQn = 32,
+  SPI1_IRQn = 35,
+  EXTI15_10_IRQn = 40,
+  TIM5_IRQn = 50,
+  SAI4_IRQn = 146,
+  OCTOSPI2_IRQn = 150,
+  FMAC_IRQn = 153,
+  CORDIC_IRQn = 154
+} IRQn_Type;
+
+/* Core peripherals --------------------------------------------------------- */
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+  volatile uint32_t LAR;
+} DWT_Type;
+
+typedef struct {
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+  volatile uint32_t ICSR;
+} SCB_Type;
+
+/* Device peripherals ------------------------------------------------------- */
+typedef struct {
+  volatile uint32_t D2CFGR;
+} RCC_TypeDef;
+
+typedef struct {
+  volatile uint32_t CR1;
+  volatile uint32_t DIER;
+  volatile uint32_t SR;
+  volatile uint32_t EGR;
+  volatile uint32_t CCMR1;
+  volatile uint32_t CNT;
+  volatile uint32_t PSC;
+  volatile uint32_t ARR;
+  volatile uint32_t CCR1;
+} TIM_TypeDef;
+
+typedef struct {
+  volatile uint32_t CR1;
+  volatile uint32_t CR2;
+  volatile uint32_t TIMINGR;
+  volatile uint32_t ISR;
+  volatile uint32_t ICR;
+  volatile uint32_t RXDR;
+  volatile uint32_t TXDR;
+} I2C_TypeDef;
+
+typedef struct {
+  volatile uint32_t CR1;
+  volatile uint32_t CFG1;
+  volatile uint32_t CFG2;
+} SPI_TypeDef;
+
+typedef struct {
+  volatile uint32_t CR;
+  volatile uint32_t NDTR;
+} DMA_Stream_TypeDef;
+
+typedef struct {
+  volatile uint32_t IDR;
+  volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+/* GPIO --------------------------------------------------------------------- */
+typedef enum {
+  GPIO_PIN_RESET = 0U,
+  GPIO_PIN_SET
+} GPIO_PinState;
+
+typedef struct {
+  uint32_t Pin;
+  uint32_t Mode;
+  uint32_t Pull;
+  uint32_t Speed;
+  uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+/* RCC and PWR -------------------------------------------------------------- */
+typedef struct {
+  uint32_t PLLState;
+  uint32_t PLLSource;
+  uint32_t PLLM;
+  uint32_t PLLN;
+  uint32_t PLLP;
+  uint32_t PLLQ;
+  uint32_t PLLR;
+  uint32_t PLLRGE;
+  uint32_t PLLVCOSEL;
+  uint32_t PLLFRACN;
+} RCC_PLLInitTypeDef;
+
+typedef struct {
+  uint32_t OscillatorType;
+  uint32_t HSEState;
+  uint32_t LSEState;
+  uint32_t HSIState;
+  uint32_t HSICalibrationValue;
+  uint32_t LSIState;
+  uint32_t CSIState;
+  uint32_t CSICalibrationValue;
+  RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct {
+  uint32_t ClockType;
+  uint32_t SYSCLKSource;
+  uint32_t SYSCLKDivider;
+  uint32_t AHBCLKDivider;
+  uint32_t APB3CLKDivider;
+  uint32_t APB1CLKDivider;
+  uint32_t APB2CLKDivider;
+  uint32_t APB4CLKDivider;
+} RCC_ClkInitTypeDef;
+
+typedef struct {
+  uint64_t PeriphClockSelection;
+  uint32_t I2c123ClockSelection;
+  uint32_t I2c1235ClockSelection;
+  uint32_t Spi123ClockSelection;
+} RCC_PeriphCLKInitTypeDef;
+
+/* MPU ---------------------------------------------------------------------- */
+typedef struct {
+  uint8_t Enable;
+  uint8_t Number;
+  uint32_t BaseAddress;
+  uint8_t Size;
+  uint8_t SubRegionDisable;
+  uint8_t TypeExtField;
+  uint8_t AccessPermission;
+  uint8_t DisableExec;
+  uint8_t IsShareable;
+  uint8_t IsCacheable;
+  uint8_t IsBufferable;
+} MPU_Region_InitTypeDef;
+
+/* DMA ---------------------------------------------------------------------- */
+typedef enum {
+  HAL_DMA_STATE_RESET = 0x00U,
+  HAL_DMA_STATE_READY = 0x01U,
+  HAL_DMA_STATE_BUSY = 0x02U,
+  HAL_DMA_STATE_ERROR = 0x03U,
+  HAL_DMA_STATE_ABORT = 0x04U
+} HAL_DMA_StateTypeDef;
+
+typedef struct {
+  uint32_t Request;
+  uint32_t Direction;
+  uint32_t PeriphInc;
+  uint32_t MemInc;
+  uint32_t PeriphDataAlignment;
+  uint32_t MemDataAlignment;
+  uint32_t Mode;
+  uint32_t Priority;
+  uint32_t FIFOMode;
+  uint32_t FIFOThreshold;
+  uint32_t MemBurst;
+  uint32_t PeriphBurst;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+  void* Instance;
+  DMA_InitTypeDef Init;
+  HAL_LockTypeDef Lock;
+  volatile HAL_DMA_StateTypeDef State;
+  void* Parent;
+  void (*XferCpltCallback)(struct __DMA_HandleTypeDef* hdma);
+  void (*XferErrorCallback)(struct __DMA_HandleTypeDef* hdma);
+  void (*XferAbortCallback)(struct __DMA_HandleTypeDef* hdma);
+  volatile uint32_t ErrorCode;
+} DMA_HandleTypeDef;
+
+/* I2C ---------------------------------------------------------------------- */
+typedef enum {
+  HAL_I2C_STATE_RESET = 0x00U,
+  HAL_I2C_STATE_READY = 0x20U,
+  HAL_I2C_STATE_BUSY = 0x24U,
+  HAL_I2C_STATE_BUSY_TX = 0x21U,
+  HAL_I2C_STATE_BUSY_RX = 0x22U,
+  HAL_I2C_STATE_ABORT = 0x60U,
+  HAL_I2C_STATE_ERROR = 0xE0U
+} HAL_I2C_StateTypeDef;
+
+typedef enum {
+  HAL_I2C_MODE_NONE = 0x00U,
+  HAL_I2C_MODE_MASTER = 0x10U,
+  HAL_I2C_MODE_MEM = 0x40U
+} HAL_I2C_ModeTypeDef;
+
+typedef struct {
+  uint32_t Timing;
+  uint32_t OwnAddress1;
+  uint32_t AddressingMode;
+  uint32_t DualAddressMode;
+  uint32_t OwnAddress2;
+  uint32_t OwnAddress2Masks;
+  uint32_t GeneralCallMode;
+  uint32_t NoStretchMode;
+} I2C_InitTypeDef;
+
+typedef struct __I2C_HandleTypeDef {
+  I2C_TypeDef* Instance;
+  I2C_InitTypeDef Init;
+  uint8_t* pBuffPtr;
+  uint16_t XferSize;
+  volatile uint16_t XferCount;
+  volatile uint32_t XferOptions;
+  volatile uint32_t PreviousState;
+  HAL_StatusTypeDef (*XferISR)(struct __I2C_HandleTypeDef* hi2c, uint32_t ITFlags, uint32_t ITSources);
+  DMA_HandleTypeDef* hdmatx;
+  DMA_HandleTypeDef* hdmarx;
+  HAL_LockTypeDef Lock;
+  volatile HAL_I2C_StateTypeDef State;
+  volatile HAL_I2C_ModeTypeDef Mode;
+  volatile uint32_t ErrorCode;
+  volatile uint32_t Devaddress;
+  volatile uint32_t Memaddress;
+} I2C_HandleTypeDef;
+
+/* SPI ---------------------------------------------------------------------- */
+typedef enum {
+  HAL_SPI_STATE_RESET = 0x00U,
+  HAL_SPI_STATE_READY = 0x01U,
+  HAL_SPI_STATE_BUSY = 0x02U,
+  HAL_SPI_STATE_BUSY_TX = 0x03U,
+  HAL_SPI_STATE_BUSY_RX = 0x04U,
+  HAL_SPI_STATE_BUSY_TX_RX = 0x05U,
+  HAL_SPI_STATE_ERROR = 0x06U,
+  HAL_SPI_STATE_ABORT = 0x07U
+} HAL_SPI_StateTypeDef;
+
+typedef struct {
+  uint32_t Mode;
+  uint32_t Direction;
+  uint32_t DataSize;
+  uint32_t CLKPolarity;
+  uint32_t CLKPhase;
+  uint32_t NSS;
+  uint32_t BaudRatePrescaler;
+  uint32_t FirstBit;
+  uint32_t TIMode;
+  uint32_t CRCCalculation;
+  uint32_t CRCPolynomial;
+  uint32_t CRCLength;
+  uint32_t NSSPMode;
+  uint32_t NSSPolarity;
+  uint32_t FifoThreshold;
+  uint32_t TxCRCInitializationPattern;
+  uint32_t RxCRCInitializationPattern;
+  uint32_t MasterSSIdleness;
+  uint32_t MasterInterDataIdleness;
+  uint32_t MasterReceiverAutoSusp;
+  uint32_t MasterKeepIOState;
+  uint32_t IOSwap;
+} SPI_InitTypeDef;
+
+typedef struct __SPI_HandleTypeDef {
+  SPI_TypeDef* Instance;
+  SPI_InitTypeDef Init;
+  const uint8_t* pTxBuffPtr;
+  uint16_t TxXferSize;
+  volatile uint16_t TxXferCount;
+  uint8_t* pRxBuffPtr;
+  uint16_t RxXferSize;
+  volatile uint16_t RxXferCount;
+  DMA_HandleTypeDef* hdmatx;
+  DMA_HandleTypeDef* hdmarx;
+  HAL_LockTypeDef Lock;
+  volatile HAL_SPI_StateTypeDef State;
+  volatile uint32_t ErrorCode;
+} SPI_HandleTypeDef;
+
+/* TIM ---------------------------------------------------------------------- */
+typedef enum {
+  HAL_TIM_STATE_RESET = 0x00U,
+  HAL_TIM_STATE_READY = 0x01U,
+  HAL_TIM_STATE_BUSY = 0x02U
+} HAL_TIM_StateTypeDef;
+
+typedef enum {
+  HAL_TIM_ACTIVE_CHANNEL_1 = 0x01U,
+  HAL_TIM_ACTIVE_CHANNEL_2 = 0x02U,
+  HAL_TIM_ACTIVE_CHANNEL_3 = 0x04U,
+  HAL_TIM_ACTIVE_CHANNEL_4 = 0x08U,
+  HAL_TIM_ACTIVE_CHANNEL_CLEARED = 0x00U
+} HAL_TIM_ActiveChannel;
+
+typedef struct {
+  uint32_t Prescaler;
+  uint32_t CounterMode;
+  uint32_t Period;
+  uint32_t ClockDivision;
+  uint32_t RepetitionCounter;
+  uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+  uint32_t OCMode;
+  uint32_t Pulse;
+  uint32_t OCPolarity;
+  uint32_t OCNPolarity;
+  uint32_t OCFastMode;
+  uint32_t OCIdleState;
+  uint32_t OCNIdleState;
+} TIM_OC_InitTypeDef;
+
+typedef struct __TIM_HandleTypeDef {
+  TIM_TypeDef* Instance;
+  TIM_Base_InitTypeDef Init;
+  HAL_TIM_ActiveChannel Channel;
+  HAL_LockTypeDef Lock;
+  volatile HAL_TIM_StateTypeDef State;
+} TIM_HandleTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+#define __IO volatile
+#define __weak __attribute__((weak))
+
+#define __NVIC_PRIO_BITS 4U
+#define NVIC_PRIORITYGROUP_4 0x00000003U
+#define TICK_INT_PRIORITY (15UL) //As stm32h7xx_hal_conf.h
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+/* Core peripherals */
+#define CoreDebug_DEMCR_TRCENA_Msk (1U << 24)
+#define DWT_CTRL_CYCCNTENA_Msk     (1U << 0)
+#define SCB_ICSR_PENDSVSET_Msk     (1U << 28)
+#define SCB_ICSR_PENDSVCLR_Msk     (1U << 27)
+
+/* RCC */
+#define RCC_D2CFGR_D2PPRE1      0x00000070U
+#define RCC_APB1_DIV1           0x00000000U
+#define RCC_APB1_DIV2           0x00000040U
+#define RCC_APB1_DIV4           0x00000050U
+#define RCC_APB1_DIV8           0x00000060U
+#define RCC_APB1_DIV16          0x00000070U
+#define RCC_APB2_DIV1           0x00000000U
+#define RCC_APB3_DIV1           0x00000000U
+#define RCC_APB4_DIV1           0x00000000U
+#define RCC_SYSCLK_DIV1         0x00000000U
+#define RCC_HCLK_DIV1           0x00000000U
+#define RCC_OSCILLATORTYPE_HSI  0x00000002U
+#define RCC_HSI_DIV1            0x00000001U
+#define RCC_PLL_ON              0x00000002U
+#define RCC_PLLSOURCE_HSI       0x00000000U
+#define RCC_PLL1VCIRANGE_3      0x0000000CU
+#define RCC_PLL1VCOWIDE         0x00000000U
+#define RCC_CLOCKTYPE_SYSCLK    0x00000001U
+#define RCC_CLOCKTYPE_HCLK      0x00000002U
+#define RCC_CLOCKTYPE_D1PCLK1   0x00000004U
+#define RCC_CLOCKTYPE_PCLK1     0x00000008U
+#define RCC_CLOCKTYPE_PCLK2     0x00000010U
+#define RCC_CLOCKTYPE_D3PCLK1   0x00000020U
+#define RCC_SYSCLKSOURCE_HSI    0x00000000U
+#define RCC_SYSCLKSOURCE_PLLCLK 0x00000003U
+#define RCC_PERIPHCLK_I2C1      0x00000008U
+#define RCC_PERIPHCLK_SPI1      0x00001000U
+#define RCC_I2C1235CLKSOURCE_D2PCLK1 0x00000000U
+#define RCC_SPI123CLKSOURCE_PLL 0x00000000U
+#define FLASH_LATENCY_1         0x00000001U
+#define HSI_VALUE               64000000U
+
+/* PWR */
+#define PWR_LDO_SUPPLY                0x00000002U
+#define PWR_REGULATOR_VOLTAGE_SCALE3  0x00004000U
+#define PWR_FLAG_VOSRDY               0x00000001U
+
+/* MPU */
+#define MPU_REGION_ENABLE             0x01U
+#define MPU_REGION_NUMBER0            0x00U
+#define MPU_REGION_SIZE_4GB           0x1FU
+#define MPU_TEX_LEVEL0                0x00U
+#define MPU_REGION_NO_ACCESS          0x00U
+#define MPU_INSTRUCTION_ACCESS_DISABLE 0x01U
+#define MPU_ACCESS_SHAREABLE          0x01U
+#define MPU_ACCESS_NOT_CACHEABLE      0x00U
+#define MPU_ACCESS_NOT_BUFFERABLE     0x00U
+#define MPU_PRIVILEGED_DEFAULT        0x04U
+
+/* GPIO, the EXTI bit of the mode selects an interrupt line */
+#define GPIO_PIN_0   ((uint16_t)0x0001)
+#define GPIO_PIN_1   ((uint16_t)0x0002)
+#define GPIO_PIN_2   ((uint16_t)0x0004)
+#define GPIO_PIN_3   ((uint16_t)0x0008)
+#define GPIO_PIN_4   ((uint16_t)0x0010)
+#define GPIO_PIN_5   ((uint16_t)0x0020)
+#define GPIO_PIN_6   ((uint16_t)0x0040)
+#define GPIO_PIN_7   ((uint16_t)0x0080)
+#define GPIO_PIN_8   ((uint16_t)0x0100)
+#define GPIO_PIN_9   ((uint16_t)0x0200)
+#define GPIO_PIN_10  ((uint16_t)0x0400)
+#define GPIO_PIN_11  ((uint16_t)0x0800)
+#define GPIO_PIN_12  ((uint16_t)0x1000)
+#define GPIO_PIN_13  ((uint16_t)0x2000)
+#define GPIO_PIN_14  ((uint16_t)0x4000)
+#define GPIO_PIN_15  ((uint16_t)0x8000)
+#define GPIO_MODE_INPUT             0x00000000U
+#define GPIO_MODE_OUTPUT_PP         0x00000001U
+#define GPIO_MODE_OUTPUT_OD         0x00000011U
+#define GPIO_MODE_AF_PP             0x00000002U
+#define GPIO_MODE_AF_OD             0x00000012U
+#define GPIO_MODE_IT_RISING         0x10110000U
+#define GPIO_MODE_IT_FALLING        0x10210000U
+#define GPIO_MODE_IT_RISING_FALLING 0x10310000U
+#define GPIO_MODE_EXTI_IT           0x00010000U
+#define GPIO_NOPULL                 0x00000000U
+#define GPIO_PULLUP                 0x00000001U
+#define GPIO_PULLDOWN               0x00000002U
+#define GPIO_SPEED_FREQ_LOW         0x00000000U
+#define GPIO_SPEED_FREQ_VERY_HIGH   0x00000003U
+#define GPIO_AF4_I2C1               ((uint8_t)0x04)
+#define GPIO_AF5_SPI1               ((uint8_t)0x05)
+
+/* DMA */
+#define DMA_REQUEST_I2C1_RX       33U
+#define DMA_REQUEST_I2C1_TX       34U
+#define DMA_REQUEST_SPI1_RX       37U
+#define DMA_REQUEST_SPI1_TX       38U
+#define DMA_PERIPH_TO_MEMORY      0x00000000U
+#define DMA_MEMORY_TO_PERIPH      0x00000040U
+#define DMA_PINC_DISABLE          0x00000000U
+#define DMA_MINC_ENABLE           0x00000400U
+#define DMA_PDATAALIGN_BYTE       0x00000000U
+#define DMA_MDATAALIGN_BYTE       0x00000000U
+#define DMA_MDATAALIGN_WORD       0x00004000U
+#define DMA_NORMAL                0x00000000U
+#define DMA_PRIORITY_LOW          0x00000000U
+#define DMA_PRIORITY_MEDIUM       0x00010000U
+#define DMA_PRIORITY_HIGH         0x00020000U
+#define DMA_PRIORITY_VERY_HIGH    0x00030000U
+#define DMA_FIFOMODE_DISABLE      0x00000000U
+#define DMA_FIFOMODE_ENABLE       0x00000004U
+#define DMA_FIFO_THRESHOLD_FULL   0x00000003U
+#define DMA_MBURST_SINGLE         0x00000000U
+#define DMA_MBURST_INC4           0x00800000U
+#define DMA_PBURST_SINGLE         0x00000000U
+#define DMA_PBURST_INC4           0x00200000U
+#define HAL_DMA_ERROR_NONE        0x00000000U
+#define HAL_DMA_ERROR_TE          0x00000001U
+
+/* I2C, register bits as the H7 I2C */
+#define I2C_ADDRESSINGMODE_7BIT   0x00000001U
+#define I2C_DUALADDRESS_DISABLE   0x00000000U
+#define I2C_OA2_NOMASK            0x00U
+#define I2C_GENERALCALL_DISABLE   0x00000000U
+#define I2C_NOSTRETCH_DISABLE     0x00000000U
+#define I2C_ANALOGFILTER_ENABLE   0x00000000U
+#define I2C_MEMADD_SIZE_8BIT      0x00000001U
+#define I2C_MEMADD_SIZE_16BIT     0x00000002U
+#define HAL_I2C_ERROR_NONE        0x00000000U
+#define HAL_I2C_ERROR_BERR        0x00000001U
+#define HAL_I2C_ERROR_ARLO        0x00000002U
+#define HAL_I2C_ERROR_AF          0x00000004U
+#define HAL_I2C_ERROR_OVR         0x00000008U
+#define HAL_I2C_ERROR_DMA         0x00000010U
+#define HAL_I2C_ERROR_TIMEOUT     0x00000020U
+#define I2C_CR1_PE                (1U << 0)
+#define I2C_CR2_SADD              0x000003FFU
+#define I2C_CR2_RD_WRN            (1U << 10)
+#define I2C_CR2_HEAD10R           (1U << 12)
+#define I2C_CR2_START             (1U << 13)
+#define I2C_CR2_STOP              (1U << 14)
+#define I2C_CR2_NBYTES_Pos        16U
+#define I2C_CR2_NBYTES            (0xFFU << I2C_CR2_NBYTES_Pos)
+#define I2C_CR2_RELOAD            (1U << 24)
+#define I2C_CR2_AUTOEND           (1U << 25)
+#define I2C_ISR_TXE               (1U << 0)
+#define I2C_ISR_TXIS              (1U << 1)
+#define I2C_ISR_RXNE              (1U << 2)
+#define I2C_ISR_NACKF             (1U << 4)
+#define I2C_ISR_STOPF             (1U << 5)
+#define I2C_ISR_TC                (1U << 6)
+#define I2C_ISR_TCR               (1U << 7)
+#define I2C_ISR_BERR              (1U << 8)
+#define I2C_ISR_ARLO              (1U << 9)
+#define I2C_ISR_BUSY              (1U << 15)
+#define I2C_ICR_NACKCF            (1U << 4)
+#define I2C_ICR_STOPCF            (1U << 5)
+#define I2C_ICR_BERRCF            (1U << 8)
+#define I2C_ICR_ARLOCF            (1U << 9)
+
+/* SPI */
+#define HAL_SPI_ERROR_NONE        0x00000000U
+#define HAL_SPI_ERROR_DMA         0x00000010U
+#define SPI_MODE_MASTER           0x00400000U
+#define SPI_DIRECTION_2LINES      0x00000000U
+#define SPI_DATASIZE_8BIT         0x00000007U
+#define SPI_POLARITY_LOW          0x00000000U
+#define SPI_PHASE_1EDGE           0x00000000U
+#define SPI_NSS_SOFT              0x04000000U
+#define SPI_BAUDRATEPRESCALER_2   0x00000000U
+#define SPI_BAUDRATEPRESCALER_4   0x10000000U
+#define SPI_BAUDRATEPRESCALER_8   0x20000000U
+#define SPI_BAUDRATEPRESCALER_16  0x30000000U
+#define SPI_FIRSTBIT_MSB          0x00000000U
+#define SPI_TIMODE_DISABLE        0x00000000U
+#define SPI_CRCCALCULATION_DISABLE 0x00000000U
+#define SPI_NSS_PULSE_ENABLE      0x40000000U
+#define SPI_NSS_POLARITY_LOW      0x00000000U
+#define SPI_CFG1_FTHLV            0x000001E0U
+#define SPI_FIFO_THRESHOLD_01DATA 0x00000000U
+#define SPI_FIFO_THRESHOLD_04DATA 0x00000060U
+#define SPI_CRC_INITIALIZATION_ALL_ZERO_PATTERN 0x00000000U
+#define SPI_MASTER_SS_IDLENESS_00CYCLE 0x00000000U
+#define SPI_MASTER_INTERDATA_IDLENESS_00CYCLE 0x00000000U
+#define SPI_MASTER_RX_AUTOSUSP_DISABLE 0x00000000U
+#define SPI_MASTER_KEEP_IO_STATE_DISABLE 0x00000000U
+#define SPI_IO_SWAP_DISABLE       0x00000000U
+
+/* TIM, register bits as the H7 general purpose timers */
+#define TIM_CR1_CEN               (1U << 0)
+#define TIM_DIER_UIE              (1U << 0)
+#define TIM_DIER_CC1IE            (1U << 1)
+#define TIM_SR_UIF                (1U << 0)
+#define TIM_SR_CC1IF              (1U << 1)
+#define TIM_EGR_UG                (1U << 0)
+#define TIM_EGR_CC1G              (1U << 1)
+#define TIM_COUNTERMODE_UP        0x00000000U
+#define TIM_CLOCKDIVISION_DIV1    0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_ENABLE 0x00000080U
+#define TIM_OCMODE_TIMING         0x00000000U
+#define TIM_OCPOLARITY_HIGH       0x00000000U
+#define TIM_OCFAST_DISABLE        0x00000000U
+#define TIM_CHANNEL_1             0x00000000U
+#define TIM_FLAG_UPDATE           TIM_SR_UIF
+#define TIM_FLAG_CC1              TIM_SR_CC1IF
+#define TIM_IT_UPDATE             TIM_DIER_UIE
+#define TIM_IT_CC1                TIM_DIER_CC1IE
+#define TIM_EVENTSOURCE_UPDATE    TIM_EGR_UG
+
+/* Exported macro ------------------------------------------------------------*/
+#define SET_BIT(REG, BIT)     ((REG) |= (BIT))
+#define CLEAR_BIT(REG, BIT)   ((REG) &= ~(BIT))
+#define READ_BIT(REG, BIT)    ((REG) & (BIT))
+#define WRITE_REG(REG, VAL)   ((REG) = (VAL))
+#define READ_REG(REG)         ((REG))
+#define MODIFY_REG(REG, CLEARMASK, SETMASK) WRITE_REG((REG), (((READ_REG(REG)) & (~(CLEARMASK))) | (SETMASK)))
+#define UNUSED(X)             (void)X
+
+/* Peripherals, the accessor ones advance the models on each access */
+#define DWT          (psHostHAL_DWT())
+#define SCB          (psHostHAL_SCB())
+#define TIM2         (psHostHAL_TIM2())
+#define TIM5         (psHostHAL_TIM5())
+#define I2C1         (psHostHAL_I2C1())
+#define CoreDebug    (&g_sHostHAL_CoreDebug)
+#define RCC          (&g_sHostHAL_RCC)
+#define SPI1         (&g_sHostHAL_SPI1)
+#define GPIOA        (&g_asHostHAL_GPIO[0])
+#define GPIOB        (&g_asHostHAL_GPIO[1])
+#define DMA1_Stream0 (&g_asHostHAL_DMAStreams[0])
+#define DMA1_Stream1 (&g_asHostHAL_DMAStreams[1])
+#define DMA1_Stream2 (&g_asHostHAL_DMAStreams[2])
+#define DMA1_Stream3 (&g_asHostHAL_DMAStreams[3])
+
+/* Clock gates and resets, nothing is gated in the models */
+#define __HAL_RCC_SYSCFG_CLK_ENABLE()   ((void)0)
+#define __HAL_RCC_GPIOA_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE()    ((void)0)
+#define __HAL_RCC_DMA1_CLK_ENABLE()     ((void)0)
+#define __HAL_RCC_TIM2_CLK_ENABLE()     ((void)0)
+#define __HAL_RCC_TIM2_CLK_DISABLE()    ((void)0)
+#define __HAL_RCC_TIM5_CLK_ENABLE()     ((void)0)
+#define __HAL_RCC_SPI1_CLK_ENABLE()     ((void)0)
+#define __HAL_RCC_SPI1_CLK_DISABLE()    ((void)0)
+#define __HAL_RCC_I2C1_CLK_ENABLE()     ((void)0)
+#define __HAL_RCC_I2C1_CLK_DISABLE()    ((void)0)
+#define __HAL_RCC_I2C1_FORCE_RESET()    vHostHAL_resetI2C1()
+#define __HAL_RCC_I2C1_RELEASE_RESET()  ((void)0)
+#define __HAL_PWR_VOLTAGESCALING_CONFIG(__REGULATOR__) ((void)(__REGULATOR__))
+#define __HAL_PWR_GET_FLAG(__FLAG__)    (1U)
+
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+  do { \
+    (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__); \
+    (__DMA_HANDLE__).Parent = (__HANDLE__); \
+  } while (0)
+
+#define __HAL_I2C_ENABLE(__HANDLE__)  SET_BIT((__HANDLE__)->Instance->CR1, I2C_CR1_PE)
+#define __HAL_I2C_DISABLE(__HANDLE__) CLEAR_BIT((__HANDLE__)->Instance->CR1, I2C_CR1_PE)
+
+#define __HAL_TIM_SET_AUTORELOAD(__HANDLE__, __AUTORELOAD__) \
+  do { \
+    (__HANDLE__)->Instance->ARR = (__AUTORELOAD__); \
+    (__HANDLE__)->Init.Period = (__AUTORELOAD__); \
+  } while (0)
+#define __HAL_TIM_SET_COMPARE(__HANDLE__, __CHANNEL__, __COMPARE__) \
+  ((void)(__CHANNEL__), (__HANDLE__)->Instance->CCR1 = (__COMPARE__))
+#define __HAL_TIM_SET_COUNTER(__HANDLE__, __COUNTER__) ((__HANDLE__)->Instance->CNT = (__COUNTER__))
+#define __HAL_TIM_CLEAR_FLAG(__HANDLE__, __FLAG__)     ((__HANDLE__)->Instance->SR = ~(__FLAG__))
+#define __HAL_TIM_ENABLE_IT(__HANDLE__, __INTERRUPT__)  ((__HANDLE__)->Instance->DIER |= (__INTERRUPT__))
+#define __HAL_TIM_DISABLE_IT(__HANDLE__, __INTERRUPT__) ((__HANDLE__)->Instance->DIER &= ~(__INTERRUPT__))
+
+#define __HAL_GPIO_EXTI_GET_IT(__EXTI_LINE__)   (u32HostHAL_getEXTI() & (__EXTI_LINE__))
+#define __HAL_GPIO_EXTI_CLEAR_IT(__EXTI_LINE__) vHostHAL_clearEXTI(__EXTI_LINE__)
+
+/* Exported variables --------------------------------------------------------*/
+extern volatile uint32_t uwTick;
+extern uint32_t SystemCoreClock;
+extern CoreDebug_Type g_sHostHAL_CoreDebug;
+extern RCC_TypeDef g_sHostHAL_RCC;
+extern SPI_TypeDef g_sHostHAL_SPI1;
+extern GPIO_TypeDef g_asHostHAL_GPIO[2];
+extern DMA_Stream_TypeDef g_asHostHAL_DMAStreams[4];
+
+/* Exported functions prototypes ---------------------------------------------*/
+
+/* Accessors of the register-level peripherals */
+DWT_Type* psHostHAL_DWT(void);
+SCB_Type* psHostHAL_SCB(void);
+TIM_TypeDef* psHostHAL_TIM2(void);
+TIM_TypeDef* psHostHAL_TIM5(void);
+I2C_TypeDef* psHostHAL_I2C1(void);
+void vHostHAL_resetI2C1(void);
+uint32_t u32HostHAL_getEXTI(void);
+void vHostHAL_clearEXTI(uint32_t p_u32Lines);
+
+/* CMSIS core */
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_BASEPRI(void);
+void __set_BASEPRI(uint32_t basePri);
+void __set_BASEPRI_MAX(uint32_t basePri);
+void __DSB(void);
+void __DMB(void);
+void __ISB(void);
+void __WFI(void);
+void __NOP(void);
+void NVIC_SetPendingIRQ(IRQn_Type IRQn);
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn);
+uint32_t NVIC_GetEnableIRQ(IRQn_Type IRQn);
+uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn);
+uint32_t NVIC_GetActive(IRQn_Type IRQn);
+
+/* HAL core and Cortex */
+HAL_StatusTypeDef HAL_Init(void);
+void HAL_MspInit(void);
+void HAL_IncTick(void);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+void HAL_SuspendTick(void);
+void HAL_ResumeTick(void);
+void HAL_NVIC_SetPriorityGrouping(uint32_t PriorityGroup);
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_ClearPendingIRQ(IRQn_Type IRQn);
+void HAL_MPU_Disable(void);
+void HAL_MPU_Enable(uint32_t MPU_Control);
+void HAL_MPU_ConfigRegion(MPU_Region_InitTypeDef* MPU_Init);
+
+/* RCC and PWR */
+HAL_StatusTypeDef HAL_PWREx_ConfigSupply(uint32_t SupplySource);
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef* RCC_OscInitStruct);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef* RCC_ClkInitStruct, uint32_t FLatency);
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef* PeriphClkInit);
+uint32_t HAL_RCC_GetSysClockFreq(void);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+
+/* GPIO */
+void HAL_GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_Init);
+void HAL_GPIO_DeInit(GPIO_TypeDef* GPIOx, uint32_t GPIO_Pin);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+
+/* DMA */
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma);
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef* hdma);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma);
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef* hdma);
+
+/* I2C */
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef HAL_I2CEx_ConfigAnalogFilter(I2C_HandleTypeDef* hi2c, uint32_t AnalogFilter);
+HAL_StatusTypeDef HAL_I2CEx_ConfigDigitalFilter(I2C_HandleTypeDef* hi2c, uint32_t DigitalFilter);
+void HAL_I2C_MspInit(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MspDeInit(I2C_HandleTypeDef* hi2c);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Master_Receive_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size);
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c);
+
+/* SPI */
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef* hspi);
+void HAL_SPI_MspInit(SPI_HandleTypeDef* hspi);
+void HAL_SPI_MspDeInit(SPI_HandleTypeDef* hspi);
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_IT(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef* hspi);
+void HAL_SPI_IRQHandler(SPI_HandleTypeDef* hspi);
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi);
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi);
+
+/* TIM */
+HAL_StatusTypeDef HAL_TIM_OC_Init(TIM_HandleTypeDef* htim);
+void HAL_TIM_OC_MspInit(TIM_HandleTypeDef* htim);
+void HAL_TIM_OC_MspDeInit(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef* htim, TIM_OC_InitTypeDef* sConfig, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_Start_IT(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_OC_Stop_IT(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIM_GenerateEvent(TIM_HandleTypeDef* htim, uint32_t EventSource);
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef* htim);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim);
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef* htim);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HOST_STM32H7XX_HAL_ */
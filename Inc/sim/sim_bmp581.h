@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  * @file           : sim_bmp581.h
+  * @brief          : Header file for the simulated BMP581 register model
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _SIM_BMP581_
+#define _SIM_BMP581_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+#include "sim/sim_bus.h"
+#include "sim/sim_rand.h"
+#include "sim/sim_signal.h"
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Exported constants --------------------------------------------------------*/
+#define cSIM_BMP581_REG_NB    128
+#define cSIM_BMP581_RESET_US  (uint32_t)1500 //Soft reset, the device NACKs meanwhile
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Struct holding one simulated BMP581
+ * 
+ * Models the register file, the soft reset and the forced, normal and
+ * continuous mode conversions. A conversion samples the pressure and
+ * temperature signals at its middle, adds the RMS noise of its effective
+ * OSR and goes through the IIR filters of DSP_IIR. The FIFO, the
+ * out-of-range detection and the NVM are not modelled.
+ * Fields are private to the model.
+ * 
+ */
+typedef struct {
+  uint8_t au8_registers[cSIM_BMP581_REG_NB];
+  bool b_resetting;
+  uint32_t u32_reset_end_us;
+  bool b_clocked;             //A transfer gave the bus time
+  uint32_t u32_last_us;       //Bus time of the last transfer
+  uint64_t u64_now_us;        //Time since the first transfer, does not wrap
+  bool b_converting;
+  uint64_t u64_conv_start_us;
+  uint64_t u64_conv_end_us;
+  uint32_t u32_conversions;   //Completed conversions
+  sSIM_Signal_t s_press;      //Pa
+  sSIM_Signal_t s_temp;       //Degree Celsius
+  sSIM_Rand_t s_rand;         //Noise draws
+  bool b_noise;
+  bool b_iir_primed;
+  double d_iir_press;
+  double d_iir_temp;
+} sSIM_BMP581_t;
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vSIM_BMP581_init(sSIM_BMP581_t* p_psDevice);
+bool bSIM_BMP581_attach(sSIM_BMP581_t* p_psDevice, uint8_t p_u8Address);
+void vSIM_BMP581_setEnvironment(sSIM_BMP581_t* p_psDevice, uint32_t p_u32PressRaw, int32_t p_s32TempRaw);
+void vSIM_BMP581_setSignals(sSIM_BMP581_t* p_psDevice, const sSIM_Signal_t* p_psPress, const sSIM_Signal_t* p_psTemp);
+void vSIM_BMP581_setNoise(sSIM_BMP581_t* p_psDevice, bool p_bEnabled, uint32_t p_u32Seed);
+uint32_t u32SIM_BMP581_getConversions(const sSIM_BMP581_t* p_psDevice);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SIM_BMP581_ */
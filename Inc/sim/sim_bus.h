@@ -0,0 +1,103 @@
+/**
+  ******************************************************************************
+  * @file           : sim_bus.h
+  * @brief          : Header file for the simulated I2C bus and its fault
+  * injection
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _SIM_BUS_
+#define _SIM_BUS_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+typedef enum {
+  ceSIM_BUS_OK = 0,
+  ceSIM_BUS_NACK,       //Address not acknowledged, nothing transferred
+  ceSIM_BUS_ARB_LOST,   //Arbitration lost during the address, nothing transferred
+  ceSIM_BUS_DMA_ERROR,  //Bytes went over the bus but the DMA did not move them
+} eSIM_BusResult_t;
+
+/* Device side of a memory transfer, false to NACK the address */
+typedef bool (*pfSIM_BusRead_t)(void* p_pvDevice, uint32_t p_u32NowUs, uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size);
+typedef bool (*pfSIM_BusWrite_t)(void* p_pvDevice, uint32_t p_u32NowUs, uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size);
+
+/**
+ * @brief Struct describing a device attached to the simulated bus
+ * 
+ */
+typedef struct {
+  uint8_t u8_address; //7-bit address
+  pfSIM_BusRead_t pf_read;
+  pfSIM_BusWrite_t pf_write;
+  void* pv_device;
+} sSIM_BusDevice_t;
+
+/**
+ * @brief Struct holding the fault rates of the simulated bus
+ * 
+ * Rates are per transfer, in parts per million, drawn independently.
+ */
+typedef struct {
+  uint32_t u32_nack_ppm;
+  uint32_t u32_arb_lost_ppm;
+  uint32_t u32_dma_error_ppm;
+  uint32_t u32_stretch_ppm;     //Transfers slowed by the slave stretching SCL
+  uint32_t u32_stretch_max_us;
+  uint32_t u32_latency_max_us;  //Random start latency added to every transfer
+  uint32_t u32_sda_stuck_ppm;   //Transfers after which the slave keeps SDA low
+} sSIM_BusFaults_t;
+
+/**
+ * @brief Struct holding the counters of the simulated bus
+ * 
+ */
+typedef struct {
+  uint32_t u32_transfers;
+  uint32_t u32_bytes;       //Data bytes that reached their destination
+  uint32_t u32_nacks;       //Injected and device NACKs
+  uint32_t u32_arb_lost;
+  uint32_t u32_dma_errors;
+  uint32_t u32_stretches;
+  uint32_t u32_sda_stuck;   //Times a slave was left holding SDA low
+  uint32_t u32_sda_clocks;  //SCL pulses given while SDA was held
+  uint64_t u64_busy_us;     //Time the bus was held, faults included
+} sSIM_BusStats_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define cSIM_BUS_DEVICE_MAX 4
+#define cSIM_BUS_BIT_US     (uint32_t)10 //100 kHz, as hi2c1
+#define cSIM_BUS_BYTE_BITS  (uint32_t)9  //8 data bits and the acknowledge
+#define cSIM_BUS_SDA_CLOCKS (uint32_t)8  //Most SCL pulses a stuck slave needs to release SDA
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vSIM_Bus_init(uint32_t p_u32Seed);
+void vSIM_Bus_setFaults(const sSIM_BusFaults_t* p_psFaults);
+bool bSIM_Bus_attach(const sSIM_BusDevice_t* p_psDevice);
+eSIM_BusResult_t eSIM_Bus_memRead(uint8_t p_u8Address, uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size, uint32_t p_u32NowUs, uint32_t* p_pu32DurationUs);
+eSIM_BusResult_t eSIM_Bus_memWrite(uint8_t p_u8Address, uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size, uint32_t p_u32NowUs, uint32_t* p_pu32DurationUs);
+void vSIM_Bus_getStats(sSIM_BusStats_t* p_psStats);
+bool bSIM_Bus_isSDAHeld(void);
+void vSIM_Bus_clockSCL(void);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SIM_BUS_ */
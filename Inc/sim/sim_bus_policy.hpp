@@ -0,0 +1,64 @@
+/**
+  ******************************************************************************
+  * @file           : sim_bus_policy.hpp
+  * @brief          : Bus policy of the C++ BMP581 driver over the simulated
+  * I2C bus, in virtual time
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _SIM_BUS_POLICY_HPP_
+#define _SIM_BUS_POLICY_HPP_
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+#include "sim/sim_bus.h"
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Bus policy driving the simulated I2C bus
+ * 
+ * Transfers are blocking and advance the virtual clock by their duration,
+ * delays advance it by their length. No retry, a faulted transfer fails.
+ * 
+ * @tparam Address the 7-bit address of the device on the simulated bus
+ */
+template <uint8_t Address>
+struct SimBusPolicy {
+  static bool bRead(uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+    uint32_t l_u32DurationUs;
+    eSIM_BusResult_t l_eResult = eSIM_Bus_memRead(Address, p_u8Register, p_pu8Data, p_u16Size, s_u32NowUs, &l_u32DurationUs);
+
+    s_u32NowUs += l_u32DurationUs;
+    return l_eResult == ceSIM_BUS_OK;
+  }
+
+  static bool bWrite(uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+    uint32_t l_u32DurationUs;
+    eSIM_BusResult_t l_eResult = eSIM_Bus_memWrite(Address, p_u8Register, p_pu8Data, p_u16Size, s_u32NowUs, &l_u32DurationUs);
+
+    s_u32NowUs += l_u32DurationUs;
+    return l_eResult == ceSIM_BUS_OK;
+  }
+
+  static void vDelayUs(uint32_t p_u32Us) {
+    s_u32NowUs += p_u32Us;
+  }
+
+  static uint32_t u32NowMs() {
+    return s_u32NowUs / 1000;
+  }
+
+  static uint32_t s_u32NowUs; //Virtual time
+};
+
+template <uint8_t Address>
+uint32_t SimBusPolicy<Address>::s_u32NowUs = 0;
+
+#endif /* _SIM_BUS_POLICY_HPP_ */
@@ -0,0 +1,55 @@
+/**
+  ******************************************************************************
+  * @file           : sim_rand.h
+  * @brief          : Header file for the seeded pseudo random generator of
+  * the host simulator
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _SIM_RAND_
+#define _SIM_RAND_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Struct holding one random stream
+ * 
+ * Each simulated part owns its stream, so adding draws to one part does
+ * not shift the sequence of the others.
+ */
+typedef struct {
+  uint32_t u32_state;
+} sSIM_Rand_t;
+
+/* Exported constants --------------------------------------------------------*/
+#define cSIM_RAND_PPM (uint32_t)1000000 //Rates are given in parts per million
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vSIM_Rand_seed(sSIM_Rand_t* p_psRand, uint32_t p_u32Seed);
+uint32_t u32SIM_Rand_next(sSIM_Rand_t* p_psRand);
+uint32_t u32SIM_Rand_below(sSIM_Rand_t* p_psRand, uint32_t p_u32Max);
+bool bSIM_Rand_chance(sSIM_Rand_t* p_psRand, uint32_t p_u32RatePpm);
+double dSIM_Rand_gaussian(sSIM_Rand_t* p_psRand);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SIM_RAND_ */
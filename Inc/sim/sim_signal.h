@@ -0,0 +1,72 @@
+/**
+  ******************************************************************************
+  * @file           : sim_signal.h
+  * @brief          : Header file for the physical quantities seen by the
+  * simulated sensors: constants, ramps, sinusoids and recorded traces
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef _SIM_SIGNAL_
+#define _SIM_SIGNAL_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Private includes ----------------------------------------------------------*/
+
+/* Exported types ------------------------------------------------------------*/
+
+/**
+ * @brief Struct holding one point of a recorded trace
+ *
+ */
+typedef struct {
+  uint64_t u64_time_us;
+  double d_value;
+} sSIM_SignalPoint_t;
+
+/**
+ * @brief Struct describing a signal as the sum of its terms
+ *
+ * A constant only sets d_offset. The ramp holds its last value after
+ * u32_ramp_s seconds, the sinusoid is off with a 0 amplitude or period.
+ * The trace is interpolated linearly between its points, held before the
+ * first and after the last one unless it loops. The points are not
+ * copied and must stay valid while the signal is used.
+ */
+typedef struct {
+  double d_offset;
+  double d_slope_per_s;
+  uint32_t u32_ramp_s;                  //Ramp duration, 0 for no end
+  double d_amplitude;                   //Sinusoid peak
+  double d_period_s;
+  double d_phase_deg;
+  const sSIM_SignalPoint_t* ps_trace;   //Increasing times
+  uint32_t u32_trace_nb;
+  bool b_trace_loop;                    //Repeats the trace from its first point after the last
+} sSIM_Signal_t;
+
+/* Exported constants --------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions prototypes ---------------------------------------------*/
+void vSIM_Signal_constant(sSIM_Signal_t* p_psSignal, double p_dValue);
+double dSIM_Signal_at(const sSIM_Signal_t* p_psSignal, uint64_t p_u64TimeUs);
+uint32_t u32SIM_Signal_loadTrace(const char* p_pcPath, sSIM_SignalPoint_t* p_psPoints, uint32_t p_u32PointMax);
+
+/* Private defines -----------------------------------------------------------*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SIM_SIGNAL_ */
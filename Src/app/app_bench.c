@@ -0,0 +1,251 @@
+/**
+  ******************************************************************************
+  * @file           : app_bench.c
+  * @brief          : Decode, solver and queue suites timed on the host and on
+  * the target
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+
+/* Used interfaces (dependencies includes ) ----------------------------------*/
+#include <stddef.h>
+#include <string.h>
+#include "app/app_bmp581.h"
+#include "app/app_bmp581_regmap.h"
+#include "app/app_bmp581_timing.h"
+#include "app/app_sample_ring.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "app/app_bench.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef uint32_t (*pfAPP_Bench_Batch_t)(uint32_t p_u32First, uint32_t p_u32Count);
+
+/* Private define ------------------------------------------------------------*/
+#define cAPP_BENCH_BATCH       (uint32_t)64 //Iterations between two cycle counter reads
+#define cAPP_BENCH_FRAME_NB    (uint32_t)16 //Data frames decoded in turn, power of two
+#define cAPP_BENCH_RATE_NB     (uint32_t)8  //Sample rates given in turn to the solver
+#define cAPP_BENCH_QUEUE_BURST (uint32_t)8  //Samples popped at once, like the event loop drain
+
+_Static_assert((cAPP_BENCH_FRAME_NB & (cAPP_BENCH_FRAME_NB - 1U)) == 0U, "cAPP_BENCH_FRAME_NB must be a power of two");
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Volatile so the inputs are not known at compile time, even with -flto */
+static volatile uint32_t s_u32Seed = 0x2545F491U;
+
+static uint8_t s_au8Frames[cAPP_BENCH_FRAME_NB][BMP581_DATA_SIZE];
+static uint32_t s_u32NoiseOffsetMPa;
+static sSampleRing_t s_sRing;
+static sAPPBenchResult_t s_asResults[ceAPP_BENCH_NB];
+
+static const uint32_t s_au32RatesMHz[cAPP_BENCH_RATE_NB] = {
+  1000U, 5000U, 10000U, 25000U, 50000U, 100000U, 160000U, 240000U
+};
+
+static const char* const s_apcNames[ceAPP_BENCH_NB] = {"decode", "solver", "queue"};
+
+/* Private function prototypes -----------------------------------------------*/
+static void vAPP_Bench_initInputs(void);
+static uint32_t u32APP_Bench_decode(uint32_t p_u32First, uint32_t p_u32Count);
+static uint32_t u32APP_Bench_solve(uint32_t p_u32First, uint32_t p_u32Count);
+static uint32_t u32APP_Bench_queue(uint32_t p_u32First, uint32_t p_u32Count);
+
+/* Batch of each suite, s_apfBatches[eAPPBenchSuite_t] */
+static const pfAPP_Bench_Batch_t s_apfBatches[ceAPP_BENCH_NB] = {
+  [ceAPP_BENCH_DECODE] = u32APP_Bench_decode,
+  [ceAPP_BENCH_SOLVER] = u32APP_Bench_solve,
+  [ceAPP_BENCH_QUEUE] = u32APP_Bench_queue
+};
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Times a suite
+ * 
+ * The iterations run in batches of cAPP_BENCH_BATCH between two reads of
+ * the cycle counter, so a 32-bit counter never wraps twice in a batch.
+ * The inputs are reset first, so the checksum only depends on the suite
+ * and the number of iterations.
+ * 
+ * @param p_eSuite the suite
+ * @param p_u32Iterations the number of iterations
+ * @param p_pfGetCycles the cycle counter
+ * @param p_psResult the outcome
+ * @return
+ */
+void vAPP_Bench_runSuite(eAPPBenchSuite_t p_eSuite, uint32_t p_u32Iterations, pfAPP_Bench_GetCycles_t p_pfGetCycles, sAPPBenchResult_t* p_psResult) {
+  uint32_t l_u32Done;
+  uint32_t l_u32Count;
+  uint32_t l_u32Start;
+
+  if (p_psResult == NULL) {
+    return;
+  }
+  memset(p_psResult, 0, sizeof(*p_psResult));
+  if (p_eSuite >= ceAPP_BENCH_NB || p_pfGetCycles == NULL) {
+    return;
+  }
+
+  vAPP_Bench_initInputs();
+
+  for (l_u32Done = 0; l_u32Done < p_u32Iterations; l_u32Done += l_u32Count) {
+    l_u32Count = p_u32Iterations - l_u32Done;
+    if (l_u32Count > cAPP_BENCH_BATCH) {
+      l_u32Count = cAPP_BENCH_BATCH;
+    }
+    l_u32Start = p_pfGetCycles();
+    p_psResult->u32_checksum += s_apfBatches[p_eSuite](l_u32Done, l_u32Count);
+    p_psResult->u64_cycles += (uint32_t)(p_pfGetCycles() - l_u32Start);
+  }
+  p_psResult->u32_iterations = p_u32Iterations;
+}
+
+/**
+ * @brief Times every suite and keeps the outcomes
+ * 
+ * Used on the target, where the outcomes are read back with the debugger
+ * or through psAPP_Bench_getResult.
+ * 
+ * @param p_u32Iterations the number of iterations of each suite
+ * @param p_pfGetCycles the cycle counter
+ * @return
+ */
+void vAPP_Bench_runAll(uint32_t p_u32Iterations, pfAPP_Bench_GetCycles_t p_pfGetCycles) {
+  uint32_t l_u32Suite;
+
+  for (l_u32Suite = 0; l_u32Suite < ceAPP_BENCH_NB; l_u32Suite++) {
+    vAPP_Bench_runSuite((eAPPBenchSuite_t)l_u32Suite, p_u32Iterations, p_pfGetCycles, &s_asResults[l_u32Suite]);
+  }
+}
+
+/**
+ * @brief Gives the outcome kept by vAPP_Bench_runAll
+ * 
+ * @param p_eSuite the suite
+ * @return the outcome, NULL if the suite does not exist
+ */
+const sAPPBenchResult_t* psAPP_Bench_getResult(eAPPBenchSuite_t p_eSuite) {
+  return (p_eSuite < ceAPP_BENCH_NB) ? &s_asResults[p_eSuite] : NULL;
+}
+
+/**
+ * @brief Gives the name of a suite
+ * 
+ * @param p_eSuite the suite
+ * @return the name, "?" if the suite does not exist
+ */
+const char* pcAPP_Bench_getName(eAPPBenchSuite_t p_eSuite) {
+  return (p_eSuite < ceAPP_BENCH_NB) ? s_apcNames[p_eSuite] : "?";
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Fills the inputs of the suites and empties the ring
+ * 
+ * @return
+ */
+static void vAPP_Bench_initInputs(void) {
+  uint32_t l_u32State = s_u32Seed;
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 0; i < cAPP_BENCH_FRAME_NB; i++) {
+    for (j = 0; j < BMP581_DATA_SIZE; j++) {
+      /* Numerical Recipes LCG, the high byte is the best mixed */
+      l_u32State = l_u32State * 1664525U + 1013904223U;
+      s_au8Frames[i][j] = (uint8_t)(l_u32State >> 24);
+    }
+  }
+  s_u32NoiseOffsetMPa = l_u32State >> 28;
+
+  vAPP_SampleRing_init(&s_sRing);
+}
+
+/**
+ * @brief Decodes data frames, as done once per sample
+ * 
+ * @param p_u32First the index of the first iteration
+ * @param p_u32Count the number of iterations
+ * @return the checksum of the samples
+ */
+static uint32_t u32APP_Bench_decode(uint32_t p_u32First, uint32_t p_u32Count) {
+  sBMP581Sample_t l_sSample;
+  uint32_t l_u32Checksum = 0;
+  uint32_t i;
+
+  for (i = p_u32First; i < p_u32First + p_u32Count; i++) {
+    vAPP_BMP581_unpackData(s_au8Frames[i & (cAPP_BENCH_FRAME_NB - 1U)], &l_sSample);
+    l_u32Checksum += l_sSample.u32_press_raw ^ (uint32_t)l_sSample.s32_temp_raw;
+  }
+
+  return l_u32Checksum;
+}
+
+/**
+ * @brief Solves configurations for a range of rates and noise budgets
+ * 
+ * The BMP581 compensates its samples on chip, so the solver is the heaviest
+ * computation the driver runs.
+ * 
+ * @param p_u32First the index of the first iteration
+ * @param p_u32Count the number of iterations
+ * @return the checksum of the solutions
+ */
+static uint32_t u32APP_Bench_solve(uint32_t p_u32First, uint32_t p_u32Count) {
+  sBMP581Requirements_t l_sRequirements;
+  sBMP581Solution_t l_sSolution;
+  uint32_t l_u32Checksum = 0;
+  uint32_t i;
+
+  l_sRequirements.u32_current_na = UINT32_MAX;
+  for (i = p_u32First; i < p_u32First + p_u32Count; i++) {
+    l_sRequirements.u32_rate_mhz = s_au32RatesMHz[i % cAPP_BENCH_RATE_NB];
+    l_sRequirements.u32_noise_mpa = 50U + s_u32NoiseOffsetMPa + (i / cAPP_BENCH_RATE_NB) % 32U * 25U;
+    if (errAPP_BMP581_solveConfig(&l_sRequirements, &l_sSolution) == ceAPP_BMP581_OK) {
+      l_u32Checksum += l_sSolution.u32_current_na + l_sSolution.u32_noise_mpa +
+        ((uint32_t)l_sSolution.e_odr << 24) + ((uint32_t)l_sSolution.e_set_iir_p << 16) +
+        ((uint32_t)l_sSolution.e_osr_p << 8) + (uint32_t)l_sSolution.e_osr_t;
+    }
+  }
+
+  return l_u32Checksum;
+}
+
+/**
+ * @brief Pushes samples one by one and pops them in bursts, as the
+ * acquisition interrupt and the event loop do
+ * 
+ * @param p_u32First the index of the first iteration
+ * @param p_u32Count the number of iterations
+ * @return the checksum of the samples popped
+ */
+static uint32_t u32APP_Bench_queue(uint32_t p_u32First, uint32_t p_u32Count) {
+  sBMP581Sample_t l_asSamples[cAPP_BENCH_QUEUE_BURST];
+  sBMP581Sample_t l_sSample;
+  uint32_t l_u32Checksum = 0;
+  uint32_t l_u32Popped;
+  uint32_t i;
+  uint32_t j;
+
+  for (i = p_u32First; i < p_u32First + p_u32Count; i++) {
+    vAPP_BMP581_unpackData(s_au8Frames[i & (cAPP_BENCH_FRAME_NB - 1U)], &l_sSample);
+    l_sSample.u32_timestamp_ms = i;
+    (void)bAPP_SampleRing_push(&s_sRing, &l_sSample);
+
+    if (u32APP_SampleRing_getCount(&s_sRing) >= cAPP_BENCH_QUEUE_BURST) {
+      l_u32Popped = u32APP_SampleRing_popBulk(&s_sRing, l_asSamples, cAPP_BENCH_QUEUE_BURST);
+      for (j = 0; j < l_u32Popped; j++) {
+        l_u32Checksum += l_asSamples[j].u32_press_raw + l_asSamples[j].u32_timestamp_ms;
+      }
+    }
+  }
+
+  return l_u32Checksum;
+}
@@ -10,138 +10,324 @@
 /* General interfaces --------------------------------------------------------*/
 
 /* Used interfaces (dependencies includes ) ----------------------------------*/
+#include <stddef.h>
 #include "app/app_bmp581.h"
 
 /* Associated interfaces -----------------------------------------------------*/
 #include "app/app_sensor_module.h"
+#include "app/app_bmp581_timing.h"
+#include "app/app_bmp581_regmap.h"
+#include "app/app_sample_ring.h"
+#include "app/app_sample_snapshot.h"
+#include "app/app_event.h"
 #include "hal/hal_i2c.h"
+#include "hal/hal_tim.h"
+#include "hal/hal_timer.h"
+#include "hal/hal_clock.h"
+#include "hal/hal_sched.h"
+#include "hal/hal_nvic.h"
 
 /* Private typedef -----------------------------------------------------------*/
-typedef struct
-{
-  uint8_t u8_CMD;
-  uint8_t u8_OSR_EFF;
-  uint8_t u8_ODR_CONFIG;
-  uint8_t u8_OSR_CONFIG;
-  uint8_t u8_OOR_CONFIG;
-  uint8_t u8_OOR_RANGE;
-  uint8_t u8_OOR_THR_P_MSB;
-  uint8_t u8_OOR_THR_P_LSB;
-  uint8_t u8_DSP_IIR;
-  uint8_t u8_DSP_CONFIG;
-  uint8_t u8_NVM_DATA_MSB;
-  uint8_t u8_NVM_DATA_LSB;
-  uint8_t u8_NVM_ADDR;
-  uint8_t u8_FIFO_DATA;
-  uint8_t u8_STATUS;
-  uint8_t u8_INT_STATUS;
-  uint8_t u8_PRESS_DATA_MSB;
-  uint8_t u8_PRESS_DATA_LSB;
-  uint8_t u8_PRESS_DATA_XLSB;
-  uint8_t u8_TEMP_DATA_MSB;
-  uint8_t u8_TEMP_DATA_LSB;
-  uint8_t u8_TEMP_DATA_XLSB;
-  uint8_t u8_FIFO_SEL;
-  uint8_t u8_FIFO_COUNT;
-  uint8_t u8_FIFO_CONFIG;
-  uint8_t u8_INT_SOURCE;
-  uint8_t u8_INT_CONFIG;
-  uint8_t u8_DRIVE_CONFIG;
-  uint8_t u8_CHIP_STATUS;
-  uint8_t u8_REV_ID;
-  uint8_t u8_CHIP_ID;
-} sBMP581Sensor_t; //Registers of BMP581 sensor object
+typedef struct {
+  uint8_t u8_register;
+  uint8_t u8_value;
+} sBMP581RegisterWrite_t;
+
+#ifndef BMP581_NO_FIFO
+typedef enum {
+  ceAPP_BMP581_READ_IDLE = 0,
+  ceAPP_BMP581_READ_PENDING,  //Queued, the image byte is not written yet
+  ceAPP_BMP581_READ_DONE,     //The image byte holds a value not given yet
+} eBMP581ReadState_t;
+
+/* Read-only register read through the queue into the register image */
+typedef struct {
+  uint8_t u8_register;
+  volatile eBMP581ReadState_t e_state;
+} sBMP581RegisterRead_t;
+#endif
 
 /* Private define ------------------------------------------------------------*/
+#define cAPP_BMP581_CONFIG_NB (sizeof(s_asInitConfig) / sizeof(s_asInitConfig[0]))
+
+/* Tasks submitting transfers, the timers only activate them. The forced
+ * mode trigger runs first when both forced mode tasks are due */
+#define cAPP_BMP581_TASK_TRIGGER  ceHAL_SCHED_TASK_0
+#define cAPP_BMP581_TASK_READ     ceHAL_SCHED_TASK_1
+#define cAPP_BMP581_TASK_POLL_POR ceHAL_SCHED_TASK_2
+#define cAPP_BMP581_TASK_PRIORITY cHAL_NVIC_PRIO_TASK_FIRST
+
+/* Every field fits in its register and no two fields of a register overlap */
+APP_BMP581_FIELDS(APP_BMP581_CHECK_FIELD)
+APP_BMP581_FIELD_REGISTERS(APP_BMP581_CHECK_REGISTER)
+
+/* Each named register of the image sits at its address */
+_Static_assert(sizeof(uBMP581Registers_t) == cAPP_BMP581_REG_NB, "The register image must end at OSR_EFF");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.u8_chip_id) == cAPP_BMP581_REG_CHIP_ID, "CHIP_ID misplaced in the register image");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.u_chip_status) == cAPP_BMP581_REG_CHIP_STATUS, "CHIP_STATUS misplaced in the register image");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.u_drive_config) == cAPP_BMP581_REG_DRIVE_CONFIG, "DRIVE_CONFIG misplaced in the register image");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.s_int) == cAPP_BMP581_REG_INT_CONFIG, "INT_CONFIG misplaced in the register image");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.u_fifo_sel) == cAPP_BMP581_REG_FIFO_SEL, "FIFO_SEL misplaced in the register image");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.au8_data) == cAPP_BMP581_REG_TEMP_DATA_XLSB, "TEMP_DATA misplaced in the register image");
+_Static_assert(sizeof(((uBMP581Registers_t*)0)->s_regs.au8_data) == BMP581_DATA_SIZE, "The data registers must hold one sample");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.u_int_status) == cAPP_BMP581_REG_INT_STATUS, "INT_STATUS misplaced in the register image");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.u8_nvm_addr) == cAPP_BMP581_REG_NVM_ADDR, "NVM_ADDR misplaced in the register image");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.s_dsp) == cAPP_BMP581_REG_DSP_CONFIG, "DSP_CONFIG misplaced in the register image");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.s_oor) == cAPP_BMP581_REG_OOR_THR_P_LSB, "OOR_THR_P_LSB misplaced in the register image");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.u_osr_config) == cAPP_BMP581_REG_OSR_CONFIG, "OSR_CONFIG misplaced in the register image");
+_Static_assert(offsetof(uBMP581Registers_t, s_regs.u_osr_eff) == cAPP_BMP581_REG_OSR_EFF, "OSR_EFF misplaced in the register image");
 
 /* Private macro -------------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
-static sBMP581Sensor_t g_BMP581Sensor = {0};
-
-static sI2CSensor_t g_I2CSensor_BMP581 = {
-  {"BMP581", ceApp_Sensor_PRESSURE, ceApp_Sensor_PASCAL}, //Sensor object attributes
-  BMP581_I2C_ADDR_PRIM, //BMP581 I2C address
-  BMP581_REGISTER_SIZE
+static const sSensor_t s_sBMP581Sensor = {"BMP581", ceApp_Sensor_PRESSURE, ceApp_Sensor_PASCAL};
+
+/* Written in order once the soft reset is done, ODR_CONFIG last */
+static const sBMP581RegisterWrite_t s_asInitConfig[] = {
+  /* Enable pressure measurements */
+  {cAPP_BMP581_REG_OSR_CONFIG, APP_BMP581_SET(OSR_CONFIG, PRESS_EN, 1)},
+#ifndef BMP581_NO_FIFO
+  /* Enable FIFO for Pressure and Temperature */
+  {cAPP_BMP581_REG_FIFO_SEL, APP_BMP581_SET(FIFO_SEL, FIFO_FRAME_SEL, ceAPP_BMP581_FIFO_PRESS_AND_TEMP)},
+  /* Configure FIFO to stop on full */
+  {cAPP_BMP581_REG_FIFO_CONFIG, APP_BMP581_SET(FIFO_CONFIG, FIFO_MODE, 1)},
+#endif
+  /* Configure interrupts, active high open drain */
+  {cAPP_BMP581_REG_INT_CONFIG, APP_BMP581_SET(INT_CONFIG, INT_POL, 1) | APP_BMP581_SET(INT_CONFIG, INT_OD, 1) | APP_BMP581_SET(INT_CONFIG, INT_EN, 1)},
+#ifndef BMP581_NO_FIFO
+  /* Activate FIFO full interrupt */
+  {cAPP_BMP581_REG_INT_SOURCE, APP_BMP581_SET(INT_SOURCE, FIFO_FULL_EN, 1)},
+#endif
+  /* Configure ODR to 240Hz, standby */
+  {cAPP_BMP581_REG_ODR_CONFIG, APP_BMP581_SET(ODR_CONFIG, ODR, ceAPP_BMP581_240_000Hz) | APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_STANDBY)},
 };
 
+static sBMP581Device_t g_BMP581Device = {0};
+
+static uint8_t s_au8ForcedData[BMP581_DATA_SIZE] = {0};
+static volatile bool s_bForcedReadPending = false;
+static volatile uint32_t s_u32FirstSampleUs = 0; //0 until the first sample is decoded
+static sSampleRing_t s_sSampleRing;
+static sSampleSnapshot_t s_sSampleSnapshot;
+
+#ifndef BMP581_NO_FIFO
+static sBMP581RegisterRead_t s_sFIFOCountRead = {cAPP_BMP581_REG_FIFO_COUNT, ceAPP_BMP581_READ_IDLE};
+static sBMP581RegisterRead_t s_sFIFODataRead = {cAPP_BMP581_REG_FIFO_DATA, ceAPP_BMP581_READ_IDLE};
+#endif
+
+/* Devices ever started, scanned by cAPP_BMP581_TASK_POLL_POR for a pending poll */
+static sBMP581Device_t* volatile s_psStartedDevices;
+
 /* Private function prototypes -----------------------------------------------*/
+static bool bAPP_BMP581_submit(sBMP581Device_t* p_psDevice, uint8_t p_u8Register, bool p_bRead, uint8_t* p_pu8Data, uint16_t p_u16Size, pfI2C_TransferDone_t p_pfDone);
+static eBMP581Err_t errAPP_BMP581_writeRegisters(uint8_t p_u8Register, uint16_t p_u16Size);
+static void vAPP_BMP581_initTransferDone(void* p_pvArg, bool p_bSuccess);
+static bool bAPP_BMP581_initConfigure(sBMP581Device_t* p_psDevice);
+static void vAPP_BMP581_initTimeout(void* p_pvArg);
+static void vAPP_BMP581_pollPOR(void);
+static void vAPP_BMP581_addStarted(sBMP581Device_t* p_psDevice);
+static void vAPP_BMP581_initEnd(sBMP581Device_t* p_psDevice, eBMP581InitState_t p_eState, eBMP581Err_t p_eError);
+static void vAPP_BMP581_initDone(sBMP581Device_t* p_psDevice);
+static void vAPP_BMP581_activateTrigger(void);
+static void vAPP_BMP581_activateRead(void);
+static void vAPP_BMP581_forcedTrigger(void);
+static void vAPP_BMP581_forcedRead(void);
+static void vAPP_BMP581_writeDone(void* p_pvArg, bool p_bSuccess);
+static void vAPP_BMP581_forcedReadDone(void* p_pvArg, bool p_bSuccess);
+static void vAPP_BMP581_decodeSample(const uint8_t* p_pu8Data, sBMP581Sample_t* p_psSample);
+#ifndef BMP581_NO_FIFO
+static eBMP581Err_t errAPP_BMP581_readRegister(sBMP581RegisterRead_t* p_psRead, uint8_t* p_pu8Value);
+static void vAPP_BMP581_readRegisterDone(void* p_pvArg, bool p_bSuccess);
+#endif
 
 /* Public functions ----------------------------------------------------------*/
 
 /**
  * @brief Initialises the I2C BMP581 sensor
  * 
- * This function initialises the BMP581 I2C sensor
+ * Starts the initialisation of the BMP581 at the primary address and
+ * returns. ceAPP_EVENT_SENSOR_READY is posted once it ended, check
+ * bAPP_BMP581_isReady before starting an acquisition.
  * 
  * @return
  */
 void vAPP_BMP581_init(void) {
-  /* Read chip ID, Rev, status and state synchronously */
-  vI2C_read(&g_I2CSensor_BMP581, cAPP_BMP581_REG_CHIP_ID, &g_BMP581Sensor.u8_CHIP_ID, 1);
-  vI2C_read(&g_I2CSensor_BMP581, cAPP_BMP581_REG_REV_ID, &g_BMP581Sensor.u8_REV_ID, 1);
-  vI2C_read(&g_I2CSensor_BMP581, cAPP_BMP581_REG_STATUS, &g_BMP581Sensor.u8_CHIP_STATUS, 1);
-  vI2C_read(&g_I2CSensor_BMP581, cAPP_BMP581_REG_INT_STATUS, &g_BMP581Sensor.u8_INT_STATUS, 1);
-  vI2C_read(&g_I2CSensor_BMP581, cAPP_BMP581_REG_ODR_CONFIG, &g_BMP581Sensor.u8_ODR_CONFIG, 1);
-
-  /* Verify the retrieved data if no error */
-  if 
-  (
-    g_BMP581Sensor.u8_CHIP_ID == BMP581_I2C_CHIP_ID && 
-    g_BMP581Sensor.u8_REV_ID == BMP581_I2C_REV_ID &&
-    g_BMP581Sensor.u8_INT_STATUS == BMP581_I2C_INT_STATUS_READY &&
-    g_BMP581Sensor.u8_CHIP_STATUS & BMP581_I2C_STATUS_READY
+  if (errAPP_BMP581_startInit(&g_BMP581Device, BMP581_I2C_ADDR_PRIM, vAPP_BMP581_initDone) != ceAPP_BMP581_OK) {
+    vAPP_Event_post(ceAPP_EVENT_SENSOR_READY);
+  }
+}
+
+/**
+ * @brief Tells whether the BMP581 initialisation succeeded
+ * 
+ * @return true if the sensor is configured
+ */
+bool bAPP_BMP581_isReady(void) {
+  return g_BMP581Device.e_state == ceAPP_BMP581_INIT_READY;
+}
+
+/**
+ * @brief Calibrates the I2C transfer modes against the BMP581
+ * 
+ * Built with APP_BENCH_BUS, also times the read paths and the DMA stream
+ * profiles, see psI2C_getBenchmark and psI2C_getDMABenchmark. Must be called from thread mode once the sensor is
+ * ready, with the bus idle.
+ * 
+ * @return
+ */
+void vAPP_BMP581_calibrateBus(void) {
+  /* CHIP_ID onwards holds no clear-on-read register for the calibration reads */
+  vI2C_calibrate(&g_BMP581Device.s_i2c, cAPP_BMP581_REG_CHIP_ID);
+#ifdef APP_BENCH_BUS
+  vI2C_benchmark(&g_BMP581Device.s_i2c, cAPP_BMP581_REG_CHIP_ID);
+  vI2C_benchmarkDMA(&g_BMP581Device.s_i2c, cAPP_BMP581_REG_CHIP_ID);
+#endif
+}
+
+/**
+ * @brief Gives the time from the timer service start to the first sample
+ * 
+ * @return the time in us, 0 if no sample was decoded yet
+ */
+uint32_t u32APP_BMP581_getBootToSampleUs(void) {
+  return s_u32FirstSampleUs;
+}
+
+/**
+ * @brief Starts the non-blocking initialisation of a BMP581
+ * 
+ * Reads the IDs, checks the NVM status, soft resets the sensor, waits for
+ * the POR flag, reads CHIP_STATUS and writes the configuration, one
+ * queued transfer at a time. Each completion moves the state machine on
+ * from PendSV, so the caller and other sensors keep running. p_pfDone is called in PendSV
+ * once the state is ceAPP_BMP581_INIT_READY or ceAPP_BMP581_INIT_FAILED.
+ * 
+ * @param p_psDevice the device, must stay valid during the initialisation
+ * @param p_u8Address the 7-bit I2C address of the sensor
+ * @param p_pfDone the callback called at the end, can be NULL
+ * @return ceAPP_BMP581_ERR_BUS if the first transfer could not be queued
+ */
+eBMP581Err_t errAPP_BMP581_startInit(sBMP581Device_t* p_psDevice, uint8_t p_u8Address, pfAPP_BMP581_InitDone_t p_pfDone) {
+  if (p_psDevice == NULL) {
+    return ceAPP_BMP581_ERR_PARAM;
+  }
+  if (
+    p_psDevice->e_state != ceAPP_BMP581_INIT_IDLE &&
+    p_psDevice->e_state != ceAPP_BMP581_INIT_READY &&
+    p_psDevice->e_state != ceAPP_BMP581_INIT_FAILED
   ) {
-    if (g_BMP581Sensor.u8_ODR_CONFIG == ceAPP_BMP581_STANDBY) {
-      /* Enable pressure measurements */
-      vI2C_write_DMA(&g_I2CSensor_BMP581, cAPP_BMP581_REG_OSR_CONFIG, 0x40, 1);
-      /* Configure ODR to 240Hz */
-      vI2C_write_DMA(&g_I2CSensor_BMP581, cAPP_BMP581_REG_ODR_CONFIG, 0x00, 1);
-      /* Configure OSR (TBD) */
-      //TODO
-      /* Enable FIFO for Pressure and Temperature */
-      vI2C_write_DMA(&g_I2CSensor_BMP581, cAPP_BMP581_REG_FIFO_SEL, 0x03, 1);
-      /* Confifure FIFO to be stop on full */
-      vI2C_write_DMA(&g_I2CSensor_BMP581, cAPP_BMP581_REG_FIFO_CONFIG, 0x20, 1);
-      /* Enable IIR filter (TBD) */
-      //TODO
-      /* Configure interrupts (INT_CONFIG) */
-      vI2C_write_DMA(&g_I2CSensor_BMP581, cAPP_BMP581_REG_INT_CONFIG, 0x0E, 1);
-      /* Activate FIFO full interrupt (INT_SOURCE register) */
-      vI2C_write_DMA(&g_I2CSensor_BMP581, cAPP_BMP581_REG_INT_SOURCE, 0x02, 1);
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
 
-    }
-    else {
-      //TODO return error code : can't init
-    }
+  p_psDevice->s_i2c.s_Sensor = s_sBMP581Sensor;
+  p_psDevice->s_i2c.u8_i2cAddress = p_u8Address;
+  p_psDevice->s_i2c.u8_i2cRegisterSize = BMP581_REGISTER_SIZE;
+  p_psDevice->e_error = ceAPP_BMP581_OK;
+  p_psDevice->u8_step = 0;
+  p_psDevice->u32_start_us = u32HAL_Timer_now();
+  p_psDevice->u32_ready_us = 0;
+  p_psDevice->pf_done = p_pfDone;
+  p_psDevice->b_por_poll = false;
+  vHAL_Timer_create(&p_psDevice->s_timer, vAPP_BMP581_initTimeout, p_psDevice);
+  vAPP_BMP581_addStarted(p_psDevice);
+  if (!bHAL_Sched_setTask(cAPP_BMP581_TASK_POLL_POR, vAPP_BMP581_pollPOR, cAPP_BMP581_TASK_PRIORITY)) {
+    return ceAPP_BMP581_ERR_PARAM;
   }
-  else {
-    //TODO return error code : can't init
+  vHAL_Sched_addTaskUser(psI2C_getResource(), cAPP_BMP581_TASK_POLL_POR);
+
+  /* CHIP_ID and REV_ID are contiguous, one read */
+  p_psDevice->e_state = ceAPP_BMP581_INIT_READ_IDS;
+  if (!bAPP_BMP581_submit(p_psDevice, cAPP_BMP581_REG_CHIP_ID, true, &p_psDevice->u_registers.au8_bytes[cAPP_BMP581_REG_CHIP_ID], 2, vAPP_BMP581_initTransferDone)) {
+    p_psDevice->e_state = ceAPP_BMP581_INIT_FAILED;
+    p_psDevice->e_error = ceAPP_BMP581_ERR_BUS;
+    return ceAPP_BMP581_ERR_BUS;
   }
+
+  return ceAPP_BMP581_OK;
 }
 
 /**
- * @brief TODO
+ * @brief Gives the initialisation step of a BMP581
  * 
- * TODO
+ * @param p_psDevice the device
+ * @return the current step
+ */
+eBMP581InitState_t eAPP_BMP581_getInitState(const sBMP581Device_t* p_psDevice) {
+  if (p_psDevice == NULL) {
+    return ceAPP_BMP581_INIT_IDLE;
+  }
+
+  return p_psDevice->e_state;
+}
+
+/**
+ * @brief Writes a command in the CMD register of the sensor
  * 
- * @return
+ * @param p_u8Command the command, e.g. BMP581_CMD_SOFT_RESET
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
  */
-void errAPP_BMP581_writeCommand(uint8_t p_u8Command) {
+eBMP581Err_t errAPP_BMP581_writeCommand(uint8_t p_u8Command) {
+  if (!bAPP_BMP581_isReady()) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
 
+  g_BMP581Device.u8_tx = p_u8Command;
+  if (!bAPP_BMP581_submit(&g_BMP581Device, cAPP_BMP581_REG_CMD, false, &g_BMP581Device.u8_tx, 1, vAPP_BMP581_writeDone)) {
+    return ceAPP_BMP581_ERR_BUS;
+  }
+
+  return ceAPP_BMP581_OK;
 }
 
 /**
- * @brief TODO
+ * @brief Configures the power mode and the ODR
  * 
- * TODO
+ * @param p_sODRConfig the configuration to write in ODR_CONFIG
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+eBMP581Err_t errAPP_BMP581_configureODR(sODRConfig_t p_sODRConfig) {
+  return errAPP_BMP581_writeODRRegister(uAPP_BMP581_packODRConfig(&p_sODRConfig));
+}
+
+/**
+ * @brief Configures the oversampling and enables the pressure
  * 
- * @return
+ * @param p_sOSRConfig the configuration to write in OSR_CONFIG
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
  */
-void errAPP_BMP581_configureODR(sODRConfig_t p_sODRConfig) {
+eBMP581Err_t errAPP_BMP581_configureOSR(sOSRConfig_t p_sOSRConfig) {
+  return errAPP_BMP581_writeOSRRegister(uAPP_BMP581_packOSRConfig(&p_sOSRConfig));
+}
+
+#ifndef BMP581_NO_OOR
+/**
+ * @brief Configures the pressure out-of-range detection
+ * 
+ * @param p_sOORConfig the configuration to write in OOR_THR_P_LSB to
+ * OOR_CONFIG
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+eBMP581Err_t errAPP_BMP581_configureOOR(sOORConfig_t p_sOORConfig) {
+  return errAPP_BMP581_writeOORRegisters(sAPP_BMP581_packOORConfig(&p_sOORConfig));
+}
+#endif
 
+/**
+ * @brief Configures the IIR filters and the compensation
+ * 
+ * @param p_sDSPConfig the configuration to write in DSP_CONFIG and DSP_IIR
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+eBMP581Err_t errAPP_BMP581_configureDSP(sDSPConfig_t p_sDSPConfig) {
+  return errAPP_BMP581_writeDSPRegisters(sAPP_BMP581_packDSPConfig(&p_sDSPConfig));
 }
 
+#ifndef BMP581_NO_NVM
 /**
  * @brief TODO
  * 
@@ -149,8 +335,9 @@ void errAPP_BMP581_configureODR(sODRConfig_t p_sODRConfig) {
  * 
  * @return
  */
-void errAPP_BMP581_configureOSR(sOSRConfig_t p_sOSRConfig) {
-
+void errAPP_BMP581_writeNVM(uint8_t p_u8NVMAddress, uint8_t p_u8NVMData) {
+  (void)p_u8NVMAddress;
+  (void)p_u8NVMData;
 }
 
 /**
@@ -160,272 +347,989 @@ void errAPP_BMP581_configureOSR(sOSRConfig_t p_sOSRConfig) {
  * 
  * @return
  */
-void errAPP_BMP581_configureOOR(sOORConfig_t p_sOORConfig) {
+void errAPP_BMP581_readNVM(uint8_t p_u8NVMAddress, uint8_t p_u8NVMData) {
+  (void)p_u8NVMAddress;
+  (void)p_u8NVMData;
+}
+#endif
 
+#ifndef BMP581_NO_FIFO
+/**
+ * @brief Configures the FIFO
+ * 
+ * @param p_sFIFOConfig the configuration to write in FIFO_CONFIG and FIFO_SEL
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+eBMP581Err_t errAPP_BMP581_configureFIFO(sFIFOConfig_t p_sFIFOConfig) {
+  return errAPP_BMP581_writeFIFORegisters(sAPP_BMP581_packFIFOConfig(&p_sFIFOConfig));
 }
+#endif
 
 /**
- * @brief TODO
+ * @brief Configures the interrupt pin and its sources
  * 
- * TODO
+ * @param p_sIntConfig the configuration to write in INT_CONFIG and INT_SOURCE
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+eBMP581Err_t errAPP_BMP581_configureInterrupt(sIntConfig_t p_sIntConfig) {
+  return errAPP_BMP581_writeIntRegisters(sAPP_BMP581_packIntConfig(&p_sIntConfig));
+}
+
+/**
+ * @brief Configures the interface pads
  * 
- * @return
+ * @param p_sDriveConfig the configuration to write in DRIVE_CONFIG
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+eBMP581Err_t errAPP_BMP581_configureDrive(sDriveConfig_t p_sDriveConfig) {
+  return errAPP_BMP581_writeDriveRegister(uAPP_BMP581_packDriveConfig(&p_sDriveConfig));
+}
+
+/**
+ * @brief Writes the ODR_CONFIG register
+ * 
+ * The register is copied in the register image, which the bus reads.
+ * 
+ * @param p_uODRConfig the register
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
  */
-void errAPP_BMP581_configureDSP(sDSPConfig_t p_sDSPConfig) {
+eBMP581Err_t errAPP_BMP581_writeODRRegister(uBMP581_ODR_CONFIG_t p_uODRConfig) {
+  if (!bAPP_BMP581_isReady()) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
 
+  g_BMP581Device.u_registers.s_regs.u_odr_config = p_uODRConfig;
+  return errAPP_BMP581_writeRegisters(cAPP_BMP581_REG_ODR_CONFIG, sizeof(p_uODRConfig));
 }
 
 /**
- * @brief TODO
+ * @brief Writes the OSR_CONFIG register
  * 
- * TODO
+ * The register is copied in the register image, which the bus reads.
  * 
- * @return
+ * @param p_uOSRConfig the register
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
  */
-void errAPP_BMP581_writeNVM(uint8_t p_u8NVMAddress, uint8_t p_u8NVMData) {
+eBMP581Err_t errAPP_BMP581_writeOSRRegister(uBMP581_OSR_CONFIG_t p_uOSRConfig) {
+  if (!bAPP_BMP581_isReady()) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
 
+  g_BMP581Device.u_registers.s_regs.u_osr_config = p_uOSRConfig;
+  return errAPP_BMP581_writeRegisters(cAPP_BMP581_REG_OSR_CONFIG, sizeof(p_uOSRConfig));
 }
 
+#ifndef BMP581_NO_OOR
 /**
- * @brief TODO
+ * @brief Writes the OOR_THR_P_LSB to OOR_CONFIG registers
  * 
- * TODO
+ * The registers are copied in the register image and written in one
+ * transfer.
  * 
- * @return
+ * @param p_sOORRegisters the registers
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
  */
-void errAPP_BMP581_readNVM(uint8_t p_u8NVMAddress, uint8_t p_u8NVMData) {
+eBMP581Err_t errAPP_BMP581_writeOORRegisters(sBMP581OORRegs_t p_sOORRegisters) {
+  if (!bAPP_BMP581_isReady()) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
 
+  g_BMP581Device.u_registers.s_regs.s_oor = p_sOORRegisters;
+  return errAPP_BMP581_writeRegisters(cAPP_BMP581_REG_OOR_THR_P_LSB, sizeof(p_sOORRegisters));
 }
+#endif
 
 /**
- * @brief TODO
+ * @brief Writes the DSP_CONFIG and DSP_IIR registers
  * 
- * TODO
+ * The registers are copied in the register image and written in one
+ * transfer.
  * 
- * @return
+ * @param p_sDSPRegisters the registers
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
  */
-void errAPP_BMP581_configureFIFO(sFIFOConfig_t p_sFIFOConfig) {
+eBMP581Err_t errAPP_BMP581_writeDSPRegisters(sBMP581DSPRegs_t p_sDSPRegisters) {
+  if (!bAPP_BMP581_isReady()) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
 
+  g_BMP581Device.u_registers.s_regs.s_dsp = p_sDSPRegisters;
+  return errAPP_BMP581_writeRegisters(cAPP_BMP581_REG_DSP_CONFIG, sizeof(p_sDSPRegisters));
 }
 
+#ifndef BMP581_NO_FIFO
 /**
- * @brief TODO
+ * @brief Writes the FIFO_CONFIG and FIFO_SEL registers
  * 
- * TODO
+ * The registers are copied in the register image. They are not
+ * contiguous and are written in two transfers.
  * 
- * @return
+ * @param p_sFIFORegisters the registers
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
  */
-void errAPP_BMP581_configureInterrupt(sIntConfig_t p_sIntConfig) {
+eBMP581Err_t errAPP_BMP581_writeFIFORegisters(sBMP581FIFORegs_t p_sFIFORegisters) {
+  eBMP581Err_t l_eError;
 
+  if (!bAPP_BMP581_isReady()) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
+
+  g_BMP581Device.u_registers.s_regs.u_fifo_config = p_sFIFORegisters.u_fifo_config;
+  g_BMP581Device.u_registers.s_regs.u_fifo_sel = p_sFIFORegisters.u_fifo_sel;
+
+  l_eError = errAPP_BMP581_writeRegisters(cAPP_BMP581_REG_FIFO_CONFIG, sizeof(p_sFIFORegisters.u_fifo_config));
+  if (l_eError != ceAPP_BMP581_OK) {
+    return l_eError;
+  }
+  return errAPP_BMP581_writeRegisters(cAPP_BMP581_REG_FIFO_SEL, sizeof(p_sFIFORegisters.u_fifo_sel));
 }
+#endif
 
 /**
- * @brief TODO
+ * @brief Writes the INT_CONFIG and INT_SOURCE registers
  * 
- * TODO
+ * The registers are copied in the register image and written in one
+ * transfer.
  * 
- * @return
+ * @param p_sIntRegisters the registers
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
  */
-void errAPP_BMP581_configureDrive(sDriveConfig_t p_sDriveConfig) {
+eBMP581Err_t errAPP_BMP581_writeIntRegisters(sBMP581IntRegs_t p_sIntRegisters) {
+  if (!bAPP_BMP581_isReady()) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
 
+  g_BMP581Device.u_registers.s_regs.s_int = p_sIntRegisters;
+  return errAPP_BMP581_writeRegisters(cAPP_BMP581_REG_INT_CONFIG, sizeof(p_sIntRegisters));
 }
 
 /**
- * @brief TODO
+ * @brief Writes the DRIVE_CONFIG register
  * 
- * TODO
+ * The register is copied in the register image, which the bus reads.
+ * 
+ * @param p_uDriveConfig the register
+ * @return ceAPP_BMP581_ERR_NOT_READY if the sensor is not initialised,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+eBMP581Err_t errAPP_BMP581_writeDriveRegister(uBMP581_DRIVE_CONFIG_t p_uDriveConfig) {
+  if (!bAPP_BMP581_isReady()) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
+
+  g_BMP581Device.u_registers.s_regs.u_drive_config = p_uDriveConfig;
+  return errAPP_BMP581_writeRegisters(cAPP_BMP581_REG_DRIVE_CONFIG, sizeof(p_uDriveConfig));
+}
+
+/**
+ * @brief Gives the last command written in CMD
  * 
+ * @param p_u8Command the command to fill
  * @return
  */
 void errAPP_BMP581_getCommand(uint8_t* p_u8Command) {
-
+  if (p_u8Command != NULL) {
+    *p_u8Command = g_BMP581Device.u8_tx;
+  }
 }
 
 /**
- * @brief TODO
+ * @brief Gives the ODR configuration
  * 
- * TODO
+ * Unpacked from the register image, no bus access.
  * 
+ * @param p_sODRConfig the configuration to fill
  * @return
  */
 void errAPP_BMP581_getODRConfig(sODRConfig_t* p_sODRConfig) {
-
+  if (p_sODRConfig != NULL) {
+    vAPP_BMP581_unpackODRConfig(g_BMP581Device.u_registers.s_regs.u_odr_config, p_sODRConfig);
+  }
 }
 
 /**
- * @brief TODO
+ * @brief Gives the OSR configuration
  * 
- * TODO
+ * Unpacked from the register image, no bus access.
  * 
+ * @param p_sOSRConfig the configuration to fill
  * @return
  */
 void errAPP_BMP581_getOSRConfig(sOSRConfig_t* p_sOSRConfig) {
-
+  if (p_sOSRConfig != NULL) {
+    vAPP_BMP581_unpackOSRConfig(g_BMP581Device.u_registers.s_regs.u_osr_config, p_sOSRConfig);
+  }
 }
 
+#ifndef BMP581_NO_OOR
 /**
- * @brief TODO
+ * @brief Gives the out-of-range configuration
  * 
- * TODO
+ * Unpacked from the register image, no bus access.
  * 
+ * @param p_sOORConfig the configuration to fill
  * @return
  */
 void errAPP_BMP581_getOORConfig(sOORConfig_t* p_sOORConfig) {
-
+  if (p_sOORConfig != NULL) {
+    vAPP_BMP581_unpackOORConfig(&g_BMP581Device.u_registers.s_regs.s_oor, p_sOORConfig);
+  }
 }
+#endif
 
 /**
- * @brief TODO
+ * @brief Gives the DSP configuration
  * 
- * TODO
+ * Unpacked from the register image, no bus access.
  * 
+ * @param p_sDSPConfig the configuration to fill
  * @return
  */
 void errAPP_BMP581_getDSPConfig(sDSPConfig_t* p_sDSPConfig) {
-
+  if (p_sDSPConfig != NULL) {
+    vAPP_BMP581_unpackDSPConfig(&g_BMP581Device.u_registers.s_regs.s_dsp, p_sDSPConfig);
+  }
 }
 
+#ifndef BMP581_NO_FIFO
 /**
- * @brief TODO
+ * @brief Gives the FIFO configuration
  * 
- * TODO
+ * Unpacked from the register image, no bus access.
  * 
+ * @param p_sFIFOConfig the configuration to fill
  * @return
  */
 void errAPP_BMP581_getFIFOConfig(sFIFOConfig_t* p_sFIFOConfig) {
+  sBMP581FIFORegs_t l_sRegisters;
 
+  if (p_sFIFOConfig != NULL) {
+    l_sRegisters.u_fifo_config = g_BMP581Device.u_registers.s_regs.u_fifo_config;
+    l_sRegisters.u_fifo_sel = g_BMP581Device.u_registers.s_regs.u_fifo_sel;
+    vAPP_BMP581_unpackFIFOConfig(&l_sRegisters, p_sFIFOConfig);
+  }
 }
+#endif
 
 /**
- * @brief TODO
+ * @brief Gives the interrupt configuration
  * 
- * TODO
+ * Unpacked from the register image, no bus access.
  * 
+ * @param p_sIntConfig the configuration to fill
  * @return
  */
 void errAPP_BMP581_getInterruptConfig(sIntConfig_t* p_sIntConfig) {
-
+  if (p_sIntConfig != NULL) {
+    vAPP_BMP581_unpackIntConfig(&g_BMP581Device.u_registers.s_regs.s_int, p_sIntConfig);
+  }
 }
 
 /**
- * @brief TODO
+ * @brief Gives the interface pads configuration
  * 
- * TODO
+ * Unpacked from the register image, no bus access.
  * 
+ * @param p_sDriveConfig the configuration to fill
  * @return
  */
 void errAPP_BMP581_getDriveConfig(sDriveConfig_t* p_sDriveConfig) {
+  if (p_sDriveConfig != NULL) {
+    vAPP_BMP581_unpackDriveConfig(g_BMP581Device.u_registers.s_regs.u_drive_config, p_sDriveConfig);
+  }
+}
+
+/**
+ * @brief Starts the timer-triggered forced mode acquisition
+ * 
+ * A hardware timer writes ODR_CONFIG in forced mode every p_u32PeriodUs,
+ * then reads the data registers once the conversion time of the given OSR
+ * configuration has elapsed. The sensor goes back to standby between
+ * conversions and any period is allowed, not only the ODR table values.
+ * 
+ * @param p_u32PeriodUs the sampling period in us
+ * @param p_sOSRConfig the oversampling configuration to apply
+ * @return ceAPP_BMP581_ERR_PARAM if the conversion and bus transfers do not
+ * fit in the period, ceAPP_BMP581_ERR_NOT_READY if the sensor is not
+ * initialised
+ */
+eBMP581Err_t errAPP_BMP581_startForced(uint32_t p_u32PeriodUs, sOSRConfig_t p_sOSRConfig) {
+  uint32_t l_u32ConvTimeUs = u32APP_BMP581_getConversionTimeUs(
+    p_sOSRConfig.e_osr_t,
+    p_sOSRConfig.e_osr_p,
+    p_sOSRConfig.b_press_en
+  );
+  uint32_t l_u32ReadDelayUs = cAPP_BMP581_FORCED_CMD_US + l_u32ConvTimeUs;
+
+  if (l_u32ConvTimeUs == 0 || p_u32PeriodUs <= l_u32ReadDelayUs + cAPP_BMP581_FORCED_READ_US) {
+    return ceAPP_BMP581_ERR_PARAM;
+  }
+  if (!bAPP_BMP581_isReady()) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
 
+  vAPP_BMP581_stopForced();
+  vAPP_SampleRing_init(&s_sSampleRing);
+  vAPP_SampleSnapshot_init(&s_sSampleSnapshot);
+
+  /* Queued ahead of the first trigger, the queue keeps the order */
+  if (errAPP_BMP581_configureOSR(p_sOSRConfig) != ceAPP_BMP581_OK) {
+    return ceAPP_BMP581_ERR_BUS;
+  }
+
+  /* The timer only activates the tasks, the submissions run at a task
+   * priority declared on the hi2c1 resource */
+  if (
+    !bHAL_Sched_setTask(cAPP_BMP581_TASK_TRIGGER, vAPP_BMP581_forcedTrigger, cAPP_BMP581_TASK_PRIORITY) ||
+    !bHAL_Sched_setTask(cAPP_BMP581_TASK_READ, vAPP_BMP581_forcedRead, cAPP_BMP581_TASK_PRIORITY)
+  ) {
+    return ceAPP_BMP581_ERR_PARAM;
+  }
+  vHAL_Sched_addTaskUser(psI2C_getResource(), cAPP_BMP581_TASK_TRIGGER);
+  vHAL_Sched_addTaskUser(psI2C_getResource(), cAPP_BMP581_TASK_READ);
+
+  if (!bHAL_TIM_startTrigger(p_u32PeriodUs, l_u32ReadDelayUs, vAPP_BMP581_activateTrigger, vAPP_BMP581_activateRead)) {
+    return ceAPP_BMP581_ERR_PARAM;
+  }
+
+  return ceAPP_BMP581_OK;
 }
 
 /**
- * @brief TODO
+ * @brief Stops the timer-triggered forced mode acquisition
  * 
- * TODO
+ * The sensor ends its ongoing conversion and stays in standby.
  * 
  * @return
  */
-void errAPP_BMP581_getEffectiveOSR(sOSREff_t* p_sOSREff) {
+void vAPP_BMP581_stopForced(void) {
+  vHAL_TIM_stopTrigger();
+  s_bForcedReadPending = false;
+}
+
+/**
+ * @brief Gives the latest sample read by the acquisition
+ * 
+ * Pressure and temperature always come from the same conversion. This
+ * reads a RAM snapshot, never the bus, and must only be called from the
+ * main loop.
+ * 
+ * @param p_sSample the sample to fill
+ * @return ceAPP_BMP581_ERR_NOT_READY if no sample was read yet
+ */
+eBMP581Err_t errAPP_BMP581_getLastSample(sBMP581Sample_t* p_sSample) {
+  if (p_sSample == NULL) {
+    return ceAPP_BMP581_ERR_PARAM;
+  }
+  if (!bAPP_SampleSnapshot_read(&s_sSampleSnapshot, p_sSample)) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
 
+  return ceAPP_BMP581_OK;
 }
 
 /**
- * @brief TODO
+ * @brief Pops the samples queued by the acquisition interrupts
  * 
- * TODO
+ * Must only be called from the main loop, the single consumer of the
+ * sample ring.
  * 
+ * @param p_psSamples the array to fill
+ * @param p_u32Max the size of p_psSamples
+ * @return the number of samples read
+ */
+uint32_t u32APP_BMP581_readSamples(sBMP581Sample_t* p_psSamples, uint32_t p_u32Max) {
+  return u32APP_SampleRing_popBulk(&s_sSampleRing, p_psSamples, p_u32Max);
+}
+
+/**
+ * @brief Gives the number of samples lost because the main loop did not
+ * read them in time
+ * 
+ * @return the number of dropped samples
+ */
+uint32_t u32APP_BMP581_getDroppedSamples(void) {
+  return u32APP_SampleRing_getDroppedSamples(&s_sSampleRing);
+}
+
+/**
+ * @brief Gives the effective oversampling
+ * 
+ * Unpacked from the register image as last read by the driver, no bus
+ * access.
+ * 
+ * @param p_sOSREff the effective OSR to fill
  * @return
  */
-void errAPP_BMP581_getFIFOData(uint8_t* p_u8FIFOData) {
+void errAPP_BMP581_getEffectiveOSR(sOSREff_t* p_sOSREff) {
+  if (p_sOSREff != NULL) {
+    vAPP_BMP581_unpackOSREff(g_BMP581Device.u_registers.s_regs.u_osr_eff, p_sOSREff);
+  }
+}
 
+#ifndef BMP581_NO_FIFO
+/**
+ * @brief Gives the next FIFO_DATA byte
+ * 
+ * Each call gives the byte read through the queue by the previous call
+ * and queues the read of the next one, so every byte popped from the FIFO
+ * is given once. Must only be called from the main loop.
+ * 
+ * @param p_u8FIFOData the byte to fill
+ * @return ceAPP_BMP581_ERR_NOT_READY while no byte was read yet,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+eBMP581Err_t errAPP_BMP581_getFIFOData(uint8_t* p_u8FIFOData) {
+  return errAPP_BMP581_readRegister(&s_sFIFODataRead, p_u8FIFOData);
 }
+#endif
 
 /**
- * @brief TODO
+ * @brief Gives the status of the sensor
  * 
- * TODO
+ * Unpacked from the register image as last read by the driver, no bus
+ * access.
  * 
+ * @param p_sStatus the status to fill
  * @return
  */
 void errAPP_BMP581_getStatus(sStatus_t* p_sStatus) {
-
+  if (p_sStatus != NULL) {
+    vAPP_BMP581_unpackStatus(g_BMP581Device.u_registers.s_regs.u_status, p_sStatus);
+  }
 }
 
 /**
- * @brief TODO
+ * @brief Gives the interrupt status
  * 
- * TODO
+ * Unpacked from the register image as last read by the driver, no bus
+ * access.
  * 
+ * @param p_sIntStatus the interrupt status to fill
  * @return
  */
 void errAPP_BMP581_getIntStatus(sIntStatus_t* p_sIntStatus) {
-
+  if (p_sIntStatus != NULL) {
+    vAPP_BMP581_unpackIntStatus(g_BMP581Device.u_registers.s_regs.u_int_status, p_sIntStatus);
+  }
 }
 
 /**
- * @brief TODO
+ * @brief Gives the latest pressure data
  * 
- * TODO
+ * Fills the PRESS_DATA bytes from the latest sample snapshot instead of reading
+ * the bus. Left untouched if no sample was read yet. Use
+ * errAPP_BMP581_getLastSample to get a consistent pressure and temperature
+ * pair.
  * 
+ * @param p_sPressData the pressure data to fill
  * @return
  */
 void errAPP_BMP581_getPressData(sPressData_t* p_sPressData) {
+  sBMP581Sample_t l_sSample;
 
+  if (p_sPressData != NULL && errAPP_BMP581_getLastSample(&l_sSample) == ceAPP_BMP581_OK) {
+    p_sPressData->u8_press_7_0 = (uint8_t)l_sSample.u32_press_raw;
+    p_sPressData->u8_press_15_8 = (uint8_t)(l_sSample.u32_press_raw >> 8);
+    p_sPressData->u8_press_23_16 = (uint8_t)(l_sSample.u32_press_raw >> 16);
+  }
 }
 
 /**
- * @brief TODO
+ * @brief Gives the latest temperature data
  * 
- * TODO
+ * Fills the TEMP_DATA bytes from the latest sample snapshot instead of reading
+ * the bus. Left untouched if no sample was read yet. Use
+ * errAPP_BMP581_getLastSample to get a consistent pressure and temperature
+ * pair.
  * 
+ * @param p_sTempData the temperature data to fill
  * @return
  */
 void errAPP_BMP581_getTempData(sTempData_t* p_sTempData) {
+  sBMP581Sample_t l_sSample;
 
+  if (p_sTempData != NULL && errAPP_BMP581_getLastSample(&l_sSample) == ceAPP_BMP581_OK) {
+    p_sTempData->u8_temp_7_0 = (uint8_t)l_sSample.s32_temp_raw;
+    p_sTempData->u8_temp_15_8 = (uint8_t)(l_sSample.s32_temp_raw >> 8);
+    p_sTempData->u8_temp_23_16 = (uint8_t)(l_sSample.s32_temp_raw >> 16);
+  }
 }
 
+#ifndef BMP581_NO_FIFO
 /**
- * @brief TODO
+ * @brief Gives the number of frames in the FIFO
  * 
- * TODO
+ * Each call gives the count read through the queue by the previous call
+ * and queues a new read. Must only be called from the main loop.
  * 
+ * @param p_u8FIFOCount the count to fill
+ * @return ceAPP_BMP581_ERR_NOT_READY while no count was read yet,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+eBMP581Err_t errAPP_BMP581_getFIFOCount(uint8_t* p_u8FIFOCount) {
+  return errAPP_BMP581_readRegister(&s_sFIFOCountRead, p_u8FIFOCount);
+}
+#endif
+
+/**
+ * @brief Gives the chip status
+ * 
+ * Unpacked from the register image, CHIP_STATUS is read once the soft
+ * reset of the initialisation is over, no bus access.
+ * 
+ * @param p_sChipStatus the chip status to fill
  * @return
  */
-void errAPP_BMP581_getFIFOCount(uint8_t* p_u8FIFOCount) {
+void errAPP_BMP581_getChipStatus(sChipStatus_t* p_sChipStatus) {
+  if (p_sChipStatus != NULL) {
+    vAPP_BMP581_unpackChipStatus(g_BMP581Device.u_registers.s_regs.u_chip_status, p_sChipStatus);
+  }
+}
 
+/**
+ * @brief Gives the chip ID
+ * 
+ * Read during the initialisation.
+ * 
+ * @param p_u8ChipID the chip ID to fill
+ * @return
+ */
+void errAPP_BMP581_getChipID(uint8_t* p_u8ChipID) {
+  if (p_u8ChipID != NULL) {
+    *p_u8ChipID = g_BMP581Device.u_registers.s_regs.u8_chip_id;
+  }
 }
 
 /**
- * @brief TODO
+ * @brief Gives the revision ID
  * 
- * TODO
+ * Read during the initialisation.
  * 
+ * @param p_u8RevID the revision ID to fill
  * @return
  */
-void errAPP_BMP581_getChipStatus(sChipStatus_t* p_sChipStatus) {
+void errAPP_BMP581_getRevID(uint8_t* p_u8RevID) {
+  if (p_u8RevID != NULL) {
+    *p_u8RevID = g_BMP581Device.u_registers.s_regs.u8_rev_id;
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Queues one register transfer of a BMP581
+ * 
+ * @param p_psDevice the device
+ * @param p_u8Register the first register
+ * @param p_bRead true to read, false to write
+ * @param p_pu8Data the bytes to read or write, must stay valid until done
+ * @param p_u16Size the number of bytes
+ * @param p_pfDone the callback called in PendSV with the device as argument
+ * @return false if the I2C queue is full
+ */
+static bool bAPP_BMP581_submit(sBMP581Device_t* p_psDevice, uint8_t p_u8Register, bool p_bRead, uint8_t* p_pu8Data, uint16_t p_u16Size, pfI2C_TransferDone_t p_pfDone) {
+  sI2CTransfer_t l_sTransfer = {
+    .ps_sensor = &p_psDevice->s_i2c,
+    .u8_register = p_u8Register,
+    .b_read = p_bRead,
+    .pu8_data = p_pu8Data,
+    .u16_size = p_u16Size,
+    .pf_done = p_pfDone,
+    .pv_arg = p_psDevice
+  };
+
+  return bI2C_submit(&l_sTransfer);
+}
+
+/**
+ * @brief Queues the write of registers of the default sensor from its
+ * register image
+ * 
+ * The bytes are read from the image when the transfer starts, so a later
+ * write of the same registers queued meanwhile wins.
+ * 
+ * @param p_u8Register the first register
+ * @param p_u16Size the number of contiguous registers
+ * @return ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+static eBMP581Err_t errAPP_BMP581_writeRegisters(uint8_t p_u8Register, uint16_t p_u16Size) {
+  if (!bAPP_BMP581_submit(&g_BMP581Device, p_u8Register, false, &g_BMP581Device.u_registers.au8_bytes[p_u8Register], p_u16Size, vAPP_BMP581_writeDone)) {
+    return ceAPP_BMP581_ERR_BUS;
+  }
 
+  return ceAPP_BMP581_OK;
 }
 
 /**
- * @brief TODO
+ * @brief Moves the initialisation on once a transfer ended
  * 
- * TODO
+ * Called in PendSV by the I2C queue.
  * 
+ * @param p_pvArg the device
+ * @param p_bSuccess the transfer result
  * @return
  */
-void errAPP_BMP581_getChipID(uint8_t* p_u8ChipID) {
+static void vAPP_BMP581_initTransferDone(void* p_pvArg, bool p_bSuccess) {
+  sBMP581Device_t* l_psDevice = (sBMP581Device_t*)p_pvArg;
+  bool l_bQueued = true;
 
+  if (!p_bSuccess) {
+    vAPP_BMP581_initEnd(l_psDevice, ceAPP_BMP581_INIT_FAILED, ceAPP_BMP581_ERR_BUS);
+    return;
+  }
+
+  switch (l_psDevice->e_state) {
+    case ceAPP_BMP581_INIT_READ_IDS:
+      if (
+        l_psDevice->u_registers.s_regs.u8_chip_id != BMP581_I2C_CHIP_ID ||
+        l_psDevice->u_registers.s_regs.u8_rev_id != BMP581_I2C_REV_ID
+      ) {
+        vAPP_BMP581_initEnd(l_psDevice, ceAPP_BMP581_INIT_FAILED, ceAPP_BMP581_ERR_DEVICE);
+        return;
+      }
+      l_psDevice->e_state = ceAPP_BMP581_INIT_CHECK_STATUS;
+      l_bQueued = bAPP_BMP581_submit(l_psDevice, cAPP_BMP581_REG_STATUS, true, &l_psDevice->u_registers.au8_bytes[cAPP_BMP581_REG_STATUS], 1, vAPP_BMP581_initTransferDone);
+      break;
+    case ceAPP_BMP581_INIT_CHECK_STATUS:
+      if (!l_psDevice->u_registers.s_regs.u_status.s_bits.NVM_RDY || l_psDevice->u_registers.s_regs.u_status.s_bits.NVM_ERR) {
+        vAPP_BMP581_initEnd(l_psDevice, ceAPP_BMP581_INIT_FAILED, ceAPP_BMP581_ERR_DEVICE);
+        return;
+      }
+      l_psDevice->e_state = ceAPP_BMP581_INIT_SOFT_RESET;
+      l_psDevice->u8_tx = BMP581_CMD_SOFT_RESET;
+      l_bQueued = bAPP_BMP581_submit(l_psDevice, cAPP_BMP581_REG_CMD, false, &l_psDevice->u8_tx, 1, vAPP_BMP581_initTransferDone);
+      break;
+    case ceAPP_BMP581_INIT_SOFT_RESET:
+      /* The sensor does not answer until its reset is over, wait instead of polling */
+      l_psDevice->e_state = ceAPP_BMP581_INIT_WAIT_POR;
+      l_psDevice->u8_step = 0;
+      l_bQueued = bHAL_Timer_start(&l_psDevice->s_timer, cAPP_BMP581_POR_US, 0);
+      break;
+    case ceAPP_BMP581_INIT_WAIT_POR:
+      if (!l_psDevice->u_registers.s_regs.u_int_status.s_bits.POR) {
+        l_psDevice->u8_step++;
+        if (l_psDevice->u8_step >= cAPP_BMP581_POR_POLL_NB) {
+          vAPP_BMP581_initEnd(l_psDevice, ceAPP_BMP581_INIT_FAILED, ceAPP_BMP581_ERR_NOT_READY);
+          return;
+        }
+        l_bQueued = bHAL_Timer_start(&l_psDevice->s_timer, cAPP_BMP581_POR_US, 0);
+        break;
+      }
+      l_psDevice->e_state = ceAPP_BMP581_INIT_CHIP_STATUS;
+      l_bQueued = bAPP_BMP581_submit(l_psDevice, cAPP_BMP581_REG_CHIP_STATUS, true, &l_psDevice->u_registers.au8_bytes[cAPP_BMP581_REG_CHIP_STATUS], 1, vAPP_BMP581_initTransferDone);
+      break;
+    case ceAPP_BMP581_INIT_CHIP_STATUS:
+      l_psDevice->e_state = ceAPP_BMP581_INIT_CONFIGURE;
+      l_psDevice->u8_step = 0;
+      l_bQueued = bAPP_BMP581_initConfigure(l_psDevice);
+      break;
+    case ceAPP_BMP581_INIT_CONFIGURE:
+      l_psDevice->u8_step++;
+      if (l_psDevice->u8_step >= cAPP_BMP581_CONFIG_NB) {
+        vAPP_BMP581_initEnd(l_psDevice, ceAPP_BMP581_INIT_READY, ceAPP_BMP581_OK);
+        return;
+      }
+      l_bQueued = bAPP_BMP581_initConfigure(l_psDevice);
+      break;
+    default:
+      /* Stale completion of an ended initialisation */
+      return;
+  }
+
+  if (!l_bQueued) {
+    vAPP_BMP581_initEnd(l_psDevice, ceAPP_BMP581_INIT_FAILED, ceAPP_BMP581_ERR_BUS);
+  }
 }
 
 /**
- * @brief TODO
+ * @brief Queues the configuration write of the current step
  * 
- * TODO
+ * The value goes through the register image, which keeps it for the bus
+ * and for the get functions.
  * 
+ * @param p_psDevice the device, u8_step indexes s_asInitConfig
+ * @return false if the I2C queue is full
+ */
+static bool bAPP_BMP581_initConfigure(sBMP581Device_t* p_psDevice) {
+  uint8_t l_u8Register = s_asInitConfig[p_psDevice->u8_step].u8_register;
+
+  p_psDevice->u_registers.au8_bytes[l_u8Register] = s_asInitConfig[p_psDevice->u8_step].u8_value;
+  return bAPP_BMP581_submit(p_psDevice, l_u8Register, false, &p_psDevice->u_registers.au8_bytes[l_u8Register], 1, vAPP_BMP581_initTransferDone);
+}
+
+/**
+ * @brief Activates the POR poll once the soft reset wait elapsed
+ * 
+ * Called from the timer service interrupt, which is more urgent than the
+ * I2C resource ceiling and must not submit.
+ * 
+ * @param p_pvArg the device
  * @return
  */
-void errAPP_BMP581_getRevID(uint8_t* p_u8RevID) {
+static void vAPP_BMP581_initTimeout(void* p_pvArg) {
+  ((sBMP581Device_t*)p_pvArg)->b_por_poll = true;
+  vHAL_Sched_activate(cAPP_BMP581_TASK_POLL_POR);
+}
+
+/**
+ * @brief Polls the POR flag of every device whose wait elapsed
+ * 
+ * Runs as a task activated by vAPP_BMP581_initTimeout. Several waits may
+ * elapse before the task runs, each device keeps its own pending flag.
+ * 
+ * @return
+ */
+static void vAPP_BMP581_pollPOR(void) {
+  sBMP581Device_t* l_psDevice;
 
+  for (l_psDevice = s_psStartedDevices; l_psDevice != NULL; l_psDevice = l_psDevice->ps_next) {
+    if (!l_psDevice->b_por_poll) {
+      continue;
+    }
+    l_psDevice->b_por_poll = false;
+    if (
+      l_psDevice->e_state == ceAPP_BMP581_INIT_WAIT_POR &&
+      !bAPP_BMP581_submit(l_psDevice, cAPP_BMP581_REG_INT_STATUS, true, &l_psDevice->u_registers.au8_bytes[cAPP_BMP581_REG_INT_STATUS], 1, vAPP_BMP581_initTransferDone)
+    ) {
+      vAPP_BMP581_initEnd(l_psDevice, ceAPP_BMP581_INIT_FAILED, ceAPP_BMP581_ERR_BUS);
+    }
+  }
 }
 
-/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief Links a device in the list scanned by the POR poll task
+ * 
+ * A device started again is already linked. The device is complete
+ * before the head is written, so the task never sees a partial entry.
+ * 
+ * @param p_psDevice the device
+ * @return
+ */
+static void vAPP_BMP581_addStarted(sBMP581Device_t* p_psDevice) {
+  sBMP581Device_t* l_psDevice;
+
+  for (l_psDevice = s_psStartedDevices; l_psDevice != NULL; l_psDevice = l_psDevice->ps_next) {
+    if (l_psDevice == p_psDevice) {
+      return;
+    }
+  }
+
+  p_psDevice->ps_next = s_psStartedDevices;
+  s_psStartedDevices = p_psDevice;
+}
+
+/**
+ * @brief Ends the initialisation and notifies its owner
+ * 
+ * @param p_psDevice the device
+ * @param p_eState ceAPP_BMP581_INIT_READY or ceAPP_BMP581_INIT_FAILED
+ * @param p_eError the error reported
+ * @return
+ */
+static void vAPP_BMP581_initEnd(sBMP581Device_t* p_psDevice, eBMP581InitState_t p_eState, eBMP581Err_t p_eError) {
+  vHAL_Timer_stop(&p_psDevice->s_timer);
+  p_psDevice->e_error = p_eError;
+  p_psDevice->u32_ready_us = u32HAL_Timer_now();
+  p_psDevice->e_state = p_eState;
+
+  if (p_psDevice->pf_done != NULL) {
+    p_psDevice->pf_done(p_psDevice);
+  }
+}
+
+/**
+ * @brief Reports the end of the default sensor initialisation to the event loop
+ * 
+ * @param p_psDevice the default device
+ * @return
+ */
+static void vAPP_BMP581_initDone(sBMP581Device_t* p_psDevice) {
+  (void)p_psDevice;
+  vAPP_Event_post(ceAPP_EVENT_SENSOR_READY);
+}
+
+/**
+ * @brief Activates the trigger task from the timer update interrupt
+ * 
+ * @return
+ */
+static void vAPP_BMP581_activateTrigger(void) {
+  vHAL_Sched_activate(cAPP_BMP581_TASK_TRIGGER);
+}
+
+/**
+ * @brief Activates the read task from the timer compare interrupt
+ * 
+ * @return
+ */
+static void vAPP_BMP581_activateRead(void) {
+  vHAL_Sched_activate(cAPP_BMP581_TASK_READ);
+}
+
+/**
+ * @brief Starts one forced mode conversion
+ * 
+ * Runs as a task activated at the start of each period.
+ * 
+ * @return
+ */
+static void vAPP_BMP581_forcedTrigger(void) {
+  uint8_t* l_pu8ODRConfig = &g_BMP581Device.u_registers.au8_bytes[cAPP_BMP581_REG_ODR_CONFIG];
+
+  /* Through the register image, like the other configuration writes, so ODR is kept and the get functions see the mode */
+  *l_pu8ODRConfig = (uint8_t)(((uint32_t)*l_pu8ODRConfig & ~(uint32_t)cAPP_BMP581_ODR_CONFIG_PWR_MODE_MSK) | APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_FORCED));
+  if (!bAPP_BMP581_submit(&g_BMP581Device, cAPP_BMP581_REG_ODR_CONFIG, false, l_pu8ODRConfig, 1, vAPP_BMP581_writeDone)) {
+    vAPP_Event_post(ceAPP_EVENT_BUS_ERROR);
+  }
+}
+
+/**
+ * @brief Reads the data registers of the finished conversion
+ * 
+ * Runs as a task activated once the conversion time elapsed.
+ * 
+ * @return
+ */
+static void vAPP_BMP581_forcedRead(void) {
+  s_bForcedReadPending = true;
+  if (!bAPP_BMP581_submit(&g_BMP581Device, cAPP_BMP581_REG_TEMP_DATA_XLSB, true, s_au8ForcedData, BMP581_DATA_SIZE, vAPP_BMP581_forcedReadDone)) {
+    s_bForcedReadPending = false;
+    vAPP_Event_post(ceAPP_EVENT_BUS_ERROR);
+  }
+}
+
+/**
+ * @brief Reports a failed register write to the event loop
+ * 
+ * @param p_pvArg the device
+ * @param p_bSuccess the transfer result
+ * @return
+ */
+static void vAPP_BMP581_writeDone(void* p_pvArg, bool p_bSuccess) {
+  (void)p_pvArg;
+
+  if (!p_bSuccess) {
+    vAPP_Event_post(ceAPP_EVENT_BUS_ERROR);
+  }
+}
+
+/**
+ * @brief Decodes the data registers once the read completes
+ * 
+ * Called in PendSV by the I2C queue, so the decode and the queue pushes
+ * no longer delay the bus interrupts.
+ * 
+ * @param p_pvArg the device
+ * @param p_bSuccess the transfer result
+ * @return
+ */
+static void vAPP_BMP581_forcedReadDone(void* p_pvArg, bool p_bSuccess) {
+  sBMP581Sample_t l_sSample;
+
+  (void)p_pvArg;
+
+  if (!s_bForcedReadPending) {
+    return;
+  }
+  s_bForcedReadPending = false;
+
+  if (!p_bSuccess) {
+    vAPP_Event_post(ceAPP_EVENT_BUS_ERROR);
+    return;
+  }
+
+  vAPP_BMP581_decodeSample(s_au8ForcedData, &l_sSample);
+  vAPP_SampleSnapshot_publish(&s_sSampleSnapshot, &l_sSample);
+  (void)bAPP_SampleRing_push(&s_sSampleRing, &l_sSample);
+  if (s_u32FirstSampleUs == 0) {
+    s_u32FirstSampleUs = u32HAL_Timer_now();
+  }
+  vAPP_Event_post(ceAPP_EVENT_SAMPLE);
+}
+
+/**
+ * @brief Decodes TEMP_DATA and PRESS_DATA registers into a sample
+ * 
+ * @param p_pu8Data the 6 bytes read from TEMP_DATA_XLSB to PRESS_DATA_MSB
+ * @param p_psSample the sample to fill
+ * @return
+ */
+static void vAPP_BMP581_decodeSample(const uint8_t* p_pu8Data, sBMP581Sample_t* p_psSample) {
+  vAPP_BMP581_unpackData(p_pu8Data, p_psSample);
+  p_psSample->u32_timestamp_ms = u32HAL_Clock_getTick();
+}
+
+#ifndef BMP581_NO_FIFO
+/**
+ * @brief Gives the value of a read-only register of the default sensor
+ * and queues its next read
+ * 
+ * The read lands in the register image. A value is given once, the
+ * caller gets ceAPP_BMP581_ERR_NOT_READY until the queued read completed.
+ * 
+ * @param p_psRead the register and the state of its read
+ * @param p_pu8Value the value to fill
+ * @return ceAPP_BMP581_ERR_NOT_READY if no value is available,
+ * ceAPP_BMP581_ERR_BUS if the I2C queue is full
+ */
+static eBMP581Err_t errAPP_BMP581_readRegister(sBMP581RegisterRead_t* p_psRead, uint8_t* p_pu8Value) {
+  eBMP581Err_t l_eError = ceAPP_BMP581_ERR_NOT_READY;
+  sI2CTransfer_t l_sTransfer = {
+    .ps_sensor = &g_BMP581Device.s_i2c,
+    .u8_register = p_psRead->u8_register,
+    .b_read = true,
+    .pu8_data = &g_BMP581Device.u_registers.au8_bytes[p_psRead->u8_register],
+    .u16_size = 1,
+    .pf_done = vAPP_BMP581_readRegisterDone,
+    .pv_arg = p_psRead
+  };
+
+  if (p_pu8Value == NULL) {
+    return ceAPP_BMP581_ERR_PARAM;
+  }
+  if (!bAPP_BMP581_isReady() || p_psRead->e_state == ceAPP_BMP581_READ_PENDING) {
+    return ceAPP_BMP581_ERR_NOT_READY;
+  }
+
+  if (p_psRead->e_state == ceAPP_BMP581_READ_DONE) {
+    *p_pu8Value = g_BMP581Device.u_registers.au8_bytes[p_psRead->u8_register];
+    l_eError = ceAPP_BMP581_OK;
+  }
+
+  p_psRead->e_state = ceAPP_BMP581_READ_PENDING;
+  if (!bI2C_submit(&l_sTransfer)) {
+    p_psRead->e_state = ceAPP_BMP581_READ_IDLE;
+    return (l_eError == ceAPP_BMP581_OK) ? ceAPP_BMP581_OK : ceAPP_BMP581_ERR_BUS;
+  }
+
+  return l_eError;
+}
+
+/**
+ * @brief Marks a register read as completed
+ * 
+ * Called in PendSV by the I2C queue.
+ * 
+ * @param p_pvArg the register read
+ * @param p_bSuccess the transfer result
+ * @return
+ */
+static void vAPP_BMP581_readRegisterDone(void* p_pvArg, bool p_bSuccess) {
+  sBMP581RegisterRead_t* l_psRead = (sBMP581RegisterRead_t*)p_pvArg;
+
+  l_psRead->e_state = p_bSuccess ? ceAPP_BMP581_READ_DONE : ceAPP_BMP581_READ_IDLE;
+  if (!p_bSuccess) {
+    vAPP_Event_post(ceAPP_EVENT_BUS_ERROR);
+  }
+}
+#endif
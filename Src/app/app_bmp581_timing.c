@@ -0,0 +1,282 @@
+/**
+  ******************************************************************************
+  * @file           : app_bmp581_timing.c
+  * @brief          : BMP581 conversion timing tables
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/21
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+
+/* Used interfaces (dependencies includes ) ----------------------------------*/
+#include <stddef.h>
+#include "app/app_bmp581.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "app/app_bmp581_timing.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cAPP_BMP581_OSR_COUNT ((uint8_t)ceAPP_BMP581_OSR_128 + 1U)
+#define cAPP_BMP581_ODR_COUNT ((uint8_t)ceAPP_BMP581_000_125Hz + 1U)
+#define cAPP_BMP581_IIR_COUNT ((uint8_t)ceAPP_BMP581_FILTER_COEFF_127 + 1U)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/**
+ * Typical conversion time in us of one forced-mode measurement, indexed by
+ * [osr_t][osr_p]. Each entry is a fixed 1000 us wake-up and readout overhead,
+ * plus 380 us per temperature sample and 620 us per pressure sample, which
+ * matches the maximum ODR per OSR given in the datasheet.
+ */
+static const uint32_t s_au32ConversionTimeUs[cAPP_BMP581_OSR_COUNT][cAPP_BMP581_OSR_COUNT] = {
+  /*  osr_p:  x1      x2      x4      x8      x16     x32     x64     x128 */
+  /* x1   */ { 2000U,  2620U,  3860U,  6340U, 11300U, 21220U, 41060U,  80740U},
+  /* x2   */ { 2380U,  3000U,  4240U,  6720U, 11680U, 21600U, 41440U,  81120U},
+  /* x4   */ { 3140U,  3760U,  5000U,  7480U, 12440U, 22360U, 42200U,  81880U},
+  /* x8   */ { 4660U,  5280U,  6520U,  9000U, 13960U, 23880U, 43720U,  83400U},
+  /* x16  */ { 7700U,  8320U,  9560U, 12040U, 17000U, 26920U, 46760U,  86440U},
+  /* x32  */ {13780U, 14400U, 15640U, 18120U, 23080U, 33000U, 52840U,  92520U},
+  /* x64  */ {25940U, 26560U, 27800U, 30280U, 35240U, 45160U, 65000U, 104680U},
+  /* x128 */ {50260U, 50880U, 52120U, 54600U, 59560U, 69480U, 89320U, 129000U},
+};
+
+/**
+ * Pressure share of each s_au32ConversionTimeUs entry, removed when the
+ * pressure measurement is disabled (press_en = 0).
+ */
+static const uint32_t s_au32PressTimeUs[cAPP_BMP581_OSR_COUNT] = {
+  620U, 1240U, 2480U, 4960U, 9920U, 19840U, 39680U, 79360U
+};
+
+/**
+ * Output data rate of each ODR_CONFIG odr value, in mHz.
+ */
+static const uint32_t s_au32ODRFrequencyMHz[cAPP_BMP581_ODR_COUNT] = {
+  240000U, 218537U, 199111U, 179200U, 160000U, 149333U, 140000U, 129855U,
+  120000U, 110164U, 100299U, 89600U, 80000U, 70000U, 60000U, 50056U,
+  45025U, 40000U, 35000U, 30000U, 25005U, 20000U, 15000U, 10000U,
+  5000U, 4000U, 3000U, 2000U, 1000U, 500U, 250U, 125U
+};
+
+/**
+ * Typical pressure RMS noise in mPa for each osr_p value with the IIR
+ * filter bypassed. Averaging n samples divides the noise by sqrt(n).
+ */
+static const uint32_t s_au32PressNoiseMPa[cAPP_BMP581_OSR_COUNT] = {
+  780U, 552U, 390U, 276U, 195U, 138U, 98U, 69U
+};
+
+/**
+ * Noise reduction of each IIR coefficient, in 1/1000. A first order IIR
+ * of coefficient c divides the RMS noise of white noise by sqrt(2c + 1).
+ */
+static const uint32_t s_au32IIRNoiseFactor[cAPP_BMP581_IIR_COUNT] = {
+  1000U, 577U, 378U, 258U, 180U, 126U, 89U, 63U
+};
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Gives the conversion time of one measurement
+ * 
+ * Looks up the typical time the BMP581 needs to complete a forced-mode
+ * conversion for the given oversampling pair. This is the delay to wait
+ * after the ODR_CONFIG write before the data registers hold the new sample.
+ * 
+ * @param p_eOSRTemp the temperature oversampling (osr_t)
+ * @param p_eOSRPress the pressure oversampling (osr_p)
+ * @param p_bPressEn true if the pressure measurement is enabled (press_en)
+ * @return the conversion time in us, 0 if an OSR value is out of range
+ */
+uint32_t u32APP_BMP581_getConversionTimeUs(eBMP581OSR_t p_eOSRTemp, eBMP581OSR_t p_eOSRPress, bool p_bPressEn) {
+  uint32_t l_u32TimeUs = 0;
+
+  if ((uint32_t)p_eOSRTemp < cAPP_BMP581_OSR_COUNT && (uint32_t)p_eOSRPress < cAPP_BMP581_OSR_COUNT) {
+    l_u32TimeUs = s_au32ConversionTimeUs[p_eOSRTemp][p_eOSRPress];
+    if (!p_bPressEn) {
+      l_u32TimeUs -= s_au32PressTimeUs[p_eOSRPress];
+    }
+  }
+
+  return l_u32TimeUs;
+}
+
+/**
+ * @brief Gives the sampling period of an ODR value
+ * 
+ * @param p_eODR the odr value of ODR_CONFIG
+ * @return the period in us, 0 if the ODR value is out of range
+ */
+uint32_t u32APP_BMP581_getODRPeriodUs(eBMP581ODR_t p_eODR) {
+  uint32_t l_u32PeriodUs = 0;
+
+  if ((uint32_t)p_eODR < cAPP_BMP581_ODR_COUNT) {
+    l_u32PeriodUs = (uint32_t)(1000000000ULL / s_au32ODRFrequencyMHz[p_eODR]);
+  }
+
+  return l_u32PeriodUs;
+}
+
+/**
+ * @brief Gives the output data rate of an ODR value
+ * 
+ * @param p_eODR the odr value of ODR_CONFIG
+ * @return the rate in mHz, 0 if the ODR value is out of range
+ */
+uint32_t u32APP_BMP581_getODRFrequencyMHz(eBMP581ODR_t p_eODR) {
+  uint32_t l_u32FrequencyMHz = 0;
+
+  if ((uint32_t)p_eODR < cAPP_BMP581_ODR_COUNT) {
+    l_u32FrequencyMHz = s_au32ODRFrequencyMHz[p_eODR];
+  }
+
+  return l_u32FrequencyMHz;
+}
+
+/**
+ * @brief Predicts the odr_is_valid bit of OSR_EFF
+ * 
+ * The BMP581 accepts any ODR/OSR pair but reduces the effective OSR and
+ * clears odr_is_valid when one conversion does not fit in the ODR period.
+ * This gives the same answer from the timing table, without writing the
+ * configuration and reading OSR_EFF back.
+ * 
+ * @param p_eODR the odr value of ODR_CONFIG
+ * @param p_eOSRTemp the temperature oversampling (osr_t)
+ * @param p_eOSRPress the pressure oversampling (osr_p)
+ * @param p_bPressEn true if the pressure measurement is enabled (press_en)
+ * @return true if the sensor will keep the requested OSR at this ODR
+ */
+bool bAPP_BMP581_isODRValid(eBMP581ODR_t p_eODR, eBMP581OSR_t p_eOSRTemp, eBMP581OSR_t p_eOSRPress, bool p_bPressEn) {
+  uint32_t l_u32PeriodUs = u32APP_BMP581_getODRPeriodUs(p_eODR);
+  uint32_t l_u32ConvTimeUs = u32APP_BMP581_getConversionTimeUs(p_eOSRTemp, p_eOSRPress, p_bPressEn);
+
+  return l_u32PeriodUs != 0 && l_u32ConvTimeUs != 0 && l_u32ConvTimeUs <= l_u32PeriodUs;
+}
+
+/**
+ * @brief Gives the pressure RMS noise of an OSR and IIR configuration
+ * 
+ * @param p_eOSRPress the pressure oversampling (osr_p)
+ * @param p_eIIR the pressure IIR coefficient (set_iir_p)
+ * @return the RMS noise in mPa, 0 if a value is out of range
+ */
+uint32_t u32APP_BMP581_getPressNoiseMPa(eBMP581OSR_t p_eOSRPress, eBMP581IRRFilter_t p_eIIR) {
+  uint32_t l_u32NoiseMPa = 0;
+
+  if ((uint32_t)p_eOSRPress < cAPP_BMP581_OSR_COUNT && (uint32_t)p_eIIR < cAPP_BMP581_IIR_COUNT) {
+    l_u32NoiseMPa = (s_au32PressNoiseMPa[p_eOSRPress] * s_au32IIRNoiseFactor[p_eIIR] + 500U) / 1000U;
+  }
+
+  return l_u32NoiseMPa;
+}
+
+/**
+ * @brief Gives the average supply current of a normal mode configuration
+ * 
+ * The sensor draws the active current during each conversion and the
+ * standby current for the rest of the ODR period.
+ * 
+ * @param p_eODR the odr value of ODR_CONFIG
+ * @param p_eOSRTemp the temperature oversampling (osr_t)
+ * @param p_eOSRPress the pressure oversampling (osr_p)
+ * @return the average current in nA, 0 if a value is out of range
+ */
+uint32_t u32APP_BMP581_getCurrentNA(eBMP581ODR_t p_eODR, eBMP581OSR_t p_eOSRTemp, eBMP581OSR_t p_eOSRPress) {
+  uint32_t l_u32PeriodUs = u32APP_BMP581_getODRPeriodUs(p_eODR);
+  uint32_t l_u32ConvTimeUs = u32APP_BMP581_getConversionTimeUs(p_eOSRTemp, p_eOSRPress, true);
+
+  if (l_u32PeriodUs == 0 || l_u32ConvTimeUs == 0) {
+    return 0;
+  }
+  if (l_u32ConvTimeUs > l_u32PeriodUs) {
+    l_u32ConvTimeUs = l_u32PeriodUs;
+  }
+
+  return cAPP_BMP581_STANDBY_CURRENT_NA + (uint32_t)(
+    ((uint64_t)cAPP_BMP581_ACTIVE_CURRENT_UA * 1000U * l_u32ConvTimeUs) / l_u32PeriodUs
+  );
+}
+
+/**
+ * @brief Picks the ODR, OSR and IIR configuration meeting the requirements
+ * 
+ * Searches every odr, osr_t, osr_p and set_iir_p combination the sensor
+ * keeps valid (see bAPP_BMP581_isODRValid) with an ODR at or above the
+ * requested rate and within the noise and current budgets. The IIR filter
+ * costs no current but delays the response to pressure steps, so the
+ * smallest IIR coefficient wins first, then the lowest current, then the
+ * lowest noise. This function has no side effects and touches no bus.
+ * 
+ * @param p_psRequirements the rate, noise and current to meet
+ * @param p_psSolution the configuration found
+ * @return ceAPP_BMP581_ERR_NOT_READY if no configuration meets the
+ * requirements
+ */
+eBMP581Err_t errAPP_BMP581_solveConfig(const sBMP581Requirements_t* p_psRequirements, sBMP581Solution_t* p_psSolution) {
+  uint32_t l_u32IIR;
+  uint32_t l_u32ODR;
+  uint32_t l_u32OSRTemp;
+  uint32_t l_u32OSRPress;
+  bool l_bFound = false;
+
+  if (p_psRequirements == NULL || p_psSolution == NULL) {
+    return ceAPP_BMP581_ERR_PARAM;
+  }
+
+  for (l_u32IIR = 0; l_u32IIR < cAPP_BMP581_IIR_COUNT && !l_bFound; l_u32IIR++) {
+    for (l_u32ODR = 0; l_u32ODR < cAPP_BMP581_ODR_COUNT; l_u32ODR++) {
+      if (s_au32ODRFrequencyMHz[l_u32ODR] < p_psRequirements->u32_rate_mhz) {
+        /* ODR values are sorted by decreasing rate */
+        break;
+      }
+
+      for (l_u32OSRPress = 0; l_u32OSRPress < cAPP_BMP581_OSR_COUNT; l_u32OSRPress++) {
+        uint32_t l_u32NoiseMPa = u32APP_BMP581_getPressNoiseMPa((eBMP581OSR_t)l_u32OSRPress, (eBMP581IRRFilter_t)l_u32IIR);
+
+        if (l_u32NoiseMPa > p_psRequirements->u32_noise_mpa) {
+          continue;
+        }
+
+        for (l_u32OSRTemp = 0; l_u32OSRTemp < cAPP_BMP581_OSR_COUNT; l_u32OSRTemp++) {
+          uint32_t l_u32CurrentNA;
+
+          if (!bAPP_BMP581_isODRValid((eBMP581ODR_t)l_u32ODR, (eBMP581OSR_t)l_u32OSRTemp, (eBMP581OSR_t)l_u32OSRPress, true)) {
+            /* Conversion time only grows with osr_t */
+            break;
+          }
+
+          l_u32CurrentNA = u32APP_BMP581_getCurrentNA((eBMP581ODR_t)l_u32ODR, (eBMP581OSR_t)l_u32OSRTemp, (eBMP581OSR_t)l_u32OSRPress);
+          if (l_u32CurrentNA > p_psRequirements->u32_current_na) {
+            break;
+          }
+
+          if (
+            !l_bFound ||
+            l_u32CurrentNA < p_psSolution->u32_current_na ||
+            (l_u32CurrentNA == p_psSolution->u32_current_na && l_u32NoiseMPa < p_psSolution->u32_noise_mpa)
+          ) {
+            p_psSolution->e_odr = (eBMP581ODR_t)l_u32ODR;
+            p_psSolution->e_osr_t = (eBMP581OSR_t)l_u32OSRTemp;
+            p_psSolution->e_osr_p = (eBMP581OSR_t)l_u32OSRPress;
+            p_psSolution->e_set_iir_p = (eBMP581IRRFilter_t)l_u32IIR;
+            p_psSolution->u32_noise_mpa = l_u32NoiseMPa;
+            p_psSolution->u32_current_na = l_u32CurrentNA;
+            l_bFound = true;
+          }
+        }
+      }
+    }
+  }
+
+  return l_bFound ? ceAPP_BMP581_OK : ceAPP_BMP581_ERR_NOT_READY;
+}
+
+/* Private functions ---------------------------------------------------------*/
@@ -0,0 +1,139 @@
+/**
+  ******************************************************************************
+  * @file           : app_event.c
+  * @brief          : Event flags posted by interrupts and the event loop
+  * dispatching them, sleeping when idle
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/30
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+
+/* Used interfaces (dependencies includes ) ----------------------------------*/
+#include <stddef.h>
+#include "stm32h7xx_hal.h"
+#include "hal/hal_timer.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "app/app_event.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static atomic_uint s_u32Pending;
+static pfAPP_EventHandler_t s_apfHandlers[ceAPP_EVENT_NB];
+static sHAL_Timer_t s_sHeartbeat;
+static uint32_t s_u32Wakeups = 0;
+
+_Static_assert(ceAPP_EVENT_NB <= 32, "Events must fit in the pending mask");
+
+/* Private function prototypes -----------------------------------------------*/
+static void vAPP_Event_onHeartbeat(void* p_pvArg);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Initialises the event flags and removes every handler
+ * 
+ * Starts the heartbeat timer, vHAL_Timer_init must have been called.
+ * 
+ * @return
+ */
+void vAPP_Event_init(void) {
+  uint32_t i;
+
+  atomic_store(&s_u32Pending, 0U);
+  for (i = 0; i < ceAPP_EVENT_NB; i++) {
+    s_apfHandlers[i] = NULL;
+  }
+  s_u32Wakeups = 0;
+
+  vHAL_Timer_create(&s_sHeartbeat, vAPP_Event_onHeartbeat, NULL);
+  (void)bHAL_Timer_start(&s_sHeartbeat, cAPP_EVENT_HEARTBEAT_MS * 1000U, cAPP_EVENT_HEARTBEAT_MS * 1000U);
+}
+
+/**
+ * @brief Sets the function run by the loop when an event is posted
+ * 
+ * @param p_eEvent the event
+ * @param p_pfHandler the handler, NULL to ignore the event
+ * @return
+ */
+void vAPP_Event_register(eAppEvent_t p_eEvent, pfAPP_EventHandler_t p_pfHandler) {
+  if (p_eEvent < ceAPP_EVENT_NB) {
+    s_apfHandlers[p_eEvent] = p_pfHandler;
+  }
+}
+
+/**
+ * @brief Posts an event, safe from any interrupt
+ * 
+ * Posting an event already pending merges both, the handler runs once.
+ * 
+ * @param p_eEvent the event
+ * @return
+ */
+void vAPP_Event_post(eAppEvent_t p_eEvent) {
+  if (p_eEvent < ceAPP_EVENT_NB) {
+    atomic_fetch_or(&s_u32Pending, 1U << p_eEvent);
+  }
+}
+
+/**
+ * @brief Event loop, never returns
+ * 
+ * Takes every pending event at once and runs their handlers by event
+ * order. When nothing is pending, the core sleeps with WFI and SysTick
+ * stopped until the next interrupt. Interrupts are masked between the
+ * last check and WFI so an event posted in between still wakes the core.
+ * 
+ * @return
+ */
+void vAPP_Event_run(void) {
+  uint32_t l_u32Events;
+  uint32_t i;
+
+  while (1) {
+    l_u32Events = atomic_exchange(&s_u32Pending, 0U);
+
+    for (i = 0; i < ceAPP_EVENT_NB; i++) {
+      if ((l_u32Events & (1U << i)) != 0 && s_apfHandlers[i] != NULL) {
+        s_apfHandlers[i]();
+      }
+    }
+
+    __disable_irq();
+    if (atomic_load(&s_u32Pending) == 0) {
+      vHAL_Timer_idle();
+      s_u32Wakeups++;
+    }
+    __enable_irq();
+  }
+}
+
+/**
+ * @brief Gives the number of times the loop woke from WFI
+ * 
+ * @return the wake-up count
+ */
+uint32_t u32APP_Event_getWakeups(void) {
+  return s_u32Wakeups;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Posts the heartbeat event, called by the heartbeat timer
+ * 
+ * @param p_pvArg unused
+ * @return
+ */
+static void vAPP_Event_onHeartbeat(void* p_pvArg) {
+  (void)p_pvArg;
+  vAPP_Event_post(ceAPP_EVENT_HEARTBEAT);
+}
@@ -15,23 +15,48 @@
 /* Used interfaces (dependencies includes) -----------------------------------*/
 #include "hal/hal_dma.h"
 #include "hal/hal_i2c.h"
+#ifndef BMP581_NO_SPI
 #include "hal/hal_spi.h"
+#endif
 #include "hal/hal_gpio.h"
 #include "hal/hal_clock.h"
 #include "hal/hal_mpu.h"
+#include "hal/hal_tim.h"
+#include "hal/hal_dwt.h"
+#include "hal/hal_nvic.h"
+#include "hal/hal_defer.h"
+#include "hal/hal_sched.h"
+#include "hal/hal_timer.h"
+#ifdef HAL_BUS_TRACE
+#include "hal/hal_trace.h"
+#endif
 #include "app/app_bmp581.h"
+#include "app/app_event.h"
+#ifdef APP_BENCH_SUITES
+#include "app/app_bench.h"
+#endif
 
 /* Private typedef -----------------------------------------------------------*/
 
 /* Private define ------------------------------------------------------------*/
+#define cAPP_MAIN_PERIOD_US     (uint32_t)40000 //25 Hz acquisition
+#define cAPP_MAIN_SAMPLE_BATCH  16
+#define cAPP_MAIN_BENCH_NB      (uint32_t)10000 //Iterations of each suite
+#define cAPP_MAIN_INIT_ATTEMPTS (uint32_t)3     //Sensor initialisations before giving up
 
 /* Private macro -------------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
+static sBMP581Sample_t s_asSamples[cAPP_MAIN_SAMPLE_BATCH];
+static uint32_t s_u32SampleCount = 0;
+static uint32_t s_u32BusErrorCount = 0;
+static uint32_t s_u32InitAttempts = 0;
 
 /* Private function prototypes -----------------------------------------------*/
-
-/* Private function prototypes -----------------------------------------------*/
+static void vAPP_Main_onSample(void);
+static void vAPP_Main_onBusError(void);
+static void vAPP_Main_onHeartbeat(void);
+static void vAPP_Main_onSensorReady(void);
 
 /* Public functions ----------------------------------------------------------*/
 
@@ -49,25 +74,120 @@ int main(void)
 
   /* Reset of all peripherals, Initializes the Flash interface and the Systick. */
   HAL_Init();
+  vHAL_NVIC_init();
+  vHAL_Defer_init();
+  vHAL_Sched_init();
 
   /* Configure the system clock */
   vHAL_Clock_init();
+  vHAL_DWT_init();
+#ifdef HAL_BUS_TRACE
+  vHAL_Trace_init();
+#endif
+
+#ifdef APP_BENCH_SUITES
+  /* Cycle counts of the suites, before any interrupt source is started */
+  vAPP_Bench_runAll(cAPP_MAIN_BENCH_NB, u32HAL_DWT_getCycles);
+#endif
 
   /* Initialize all configured peripherals */
   vHAL_GPIO_init();
   vHAL_DMA_init();
   vI2C_init();
+#ifndef BMP581_NO_SPI
+  /* No SPI device on the board, vSPI_calibrate runs once one is attached */
   vSPI_init();
-
-  /* Main infinite loop */
-  while (1) {
-    vHAL_GPIO_toggleGreenLED();
-    vHAL_Clock_delay(1000);
-  }
+#ifdef APP_BENCH_BUS
+  /* Drain time per DMA stream profile, read with psSPI_getDMABenchmark */
+  vSPI_benchmarkDMA();
+#endif
+#endif
+  vHAL_TIM_init();
+  vHAL_Timer_init();
+
+  /* Start the acquisition */
+  vAPP_Event_init();
+  vAPP_Event_register(ceAPP_EVENT_SAMPLE, vAPP_Main_onSample);
+  vAPP_Event_register(ceAPP_EVENT_BUS_ERROR, vAPP_Main_onBusError);
+  vAPP_Event_register(ceAPP_EVENT_HEARTBEAT, vAPP_Main_onHeartbeat);
+  vAPP_Event_register(ceAPP_EVENT_SENSOR_READY, vAPP_Main_onSensorReady);
+
+  /* Returns at once, the acquisition starts on ceAPP_EVENT_SENSOR_READY */
+  vAPP_BMP581_init();
+
+  /* Main event loop, sleeps when idle */
+  vAPP_Event_run();
 }
 
 /* Private functions ---------------------------------------------------------*/
 
+/**
+  * @brief  Drains the samples acquired since the last event
+  * 
+  * @return None
+  */
+static void vAPP_Main_onSample(void)
+{
+  uint32_t l_u32Count;
+
+  do {
+    l_u32Count = u32APP_BMP581_readSamples(s_asSamples, cAPP_MAIN_SAMPLE_BATCH);
+    s_u32SampleCount += l_u32Count;
+  } while (l_u32Count == cAPP_MAIN_SAMPLE_BATCH);
+}
+
+/**
+  * @brief  Flags a failed bus transfer on the red LED
+  * 
+  * @return None
+  */
+static void vAPP_Main_onBusError(void)
+{
+  s_u32BusErrorCount++;
+  vHAL_GPIO_toggleRedLED();
+}
+
+/**
+  * @brief  Blinks the green LED while the system runs
+  * 
+  * @return None
+  */
+static void vAPP_Main_onHeartbeat(void)
+{
+  vHAL_GPIO_toggleGreenLED();
+}
+
+/**
+  * @brief  Starts the acquisition once the sensor is initialised
+  * 
+  * A failed initialisation is flagged as a bus error and started again,
+  * up to cAPP_MAIN_INIT_ATTEMPTS times. The system keeps running without
+  * acquisition after that, or when the acquisition cannot start.
+  * 
+  * @return None
+  */
+static void vAPP_Main_onSensorReady(void)
+{
+  sOSRConfig_t l_sOSRConfig = {
+    .e_osr_t = ceAPP_BMP581_OSR_1,
+    .e_osr_p = ceAPP_BMP581_OSR_16,
+    .b_press_en = true
+  };
+
+  if (!bAPP_BMP581_isReady()) {
+    vAPP_Event_post(ceAPP_EVENT_BUS_ERROR);
+    if (++s_u32InitAttempts < cAPP_MAIN_INIT_ATTEMPTS) {
+      vAPP_BMP581_init();
+    }
+    return;
+  }
+
+  vAPP_BMP581_calibrateBus();
+  if (errAPP_BMP581_startForced(cAPP_MAIN_PERIOD_US, l_sOSRConfig) != ceAPP_BMP581_OK) {
+    vAPP_Event_post(ceAPP_EVENT_BUS_ERROR);
+  }
+}
+
 /**
   * @brief  This function is executed in case of error occurrence.
   * 
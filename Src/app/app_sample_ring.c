@@ -0,0 +1,230 @@
+/**
+  ******************************************************************************
+  * @file           : app_sample_ring.c
+  * @brief          : Single-producer single-consumer sample ring buffer
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/23
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+
+/* Used interfaces (dependencies includes ) ----------------------------------*/
+#include <stddef.h>
+#include <stdatomic.h>
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "app/app_sample_ring.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cAPP_SAMPLE_RING_MASK (cAPP_SAMPLE_RING_SIZE - 1U)
+
+_Static_assert((cAPP_SAMPLE_RING_SIZE & cAPP_SAMPLE_RING_MASK) == 0U, "cAPP_SAMPLE_RING_SIZE must be a power of two");
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void vAPP_SampleRing_copyIn(sSampleRing_t* p_psRing, uint32_t p_u32Index, const sBMP581Sample_t* p_psSamples, uint32_t p_u32Count);
+static void vAPP_SampleRing_copyOut(const sSampleRing_t* p_psRing, uint32_t p_u32Index, sBMP581Sample_t* p_psSamples, uint32_t p_u32Count);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Initialises an empty ring
+ * 
+ * Must be called before the producer interrupt is enabled.
+ * 
+ * @param p_psRing the ring to initialise
+ * @return
+ */
+void vAPP_SampleRing_init(sSampleRing_t* p_psRing) {
+  if (p_psRing != NULL) {
+    p_psRing->u32_head = 0;
+    p_psRing->u32_tail = 0;
+    p_psRing->u32_overflow_events = 0;
+    p_psRing->u32_dropped_samples = 0;
+  }
+}
+
+/**
+ * @brief Pushes one sample, producer side only
+ * 
+ * @param p_psRing the ring to push to
+ * @param p_psSample the sample to copy into the ring
+ * @return false if the ring is full, the sample is then dropped and counted
+ */
+bool bAPP_SampleRing_push(sSampleRing_t* p_psRing, const sBMP581Sample_t* p_psSample) {
+  return u32APP_SampleRing_pushBulk(p_psRing, p_psSample, 1) == 1U;
+}
+
+/**
+ * @brief Pushes a span of samples with a single index update
+ * 
+ * Copies as many samples as fit, then publishes them all at once so the
+ * consumer sees either none or all of them. Samples that do not fit are
+ * dropped and counted.
+ * 
+ * @param p_psRing the ring to push to
+ * @param p_psSamples the samples to copy into the ring
+ * @param p_u32Count the number of samples to push
+ * @return the number of samples pushed
+ */
+uint32_t u32APP_SampleRing_pushBulk(sSampleRing_t* p_psRing, const sBMP581Sample_t* p_psSamples, uint32_t p_u32Count) {
+  uint32_t l_u32Head;
+  uint32_t l_u32Free;
+  uint32_t l_u32Pushed;
+
+  if (p_psRing == NULL || p_psSamples == NULL || p_u32Count == 0) {
+    return 0;
+  }
+
+  l_u32Head = p_psRing->u32_head;
+  l_u32Free = cAPP_SAMPLE_RING_SIZE - (l_u32Head - p_psRing->u32_tail);
+  /* Do not write slots before reading the tail that frees them */
+  atomic_thread_fence(memory_order_seq_cst);
+
+  l_u32Pushed = (p_u32Count < l_u32Free) ? p_u32Count : l_u32Free;
+  if (l_u32Pushed < p_u32Count) {
+    p_psRing->u32_overflow_events++;
+    p_psRing->u32_dropped_samples += p_u32Count - l_u32Pushed;
+  }
+
+  if (l_u32Pushed != 0) {
+    vAPP_SampleRing_copyIn(p_psRing, l_u32Head, p_psSamples, l_u32Pushed);
+    /* Samples must be visible before the head that publishes them */
+    atomic_thread_fence(memory_order_seq_cst);
+    p_psRing->u32_head = l_u32Head + l_u32Pushed;
+  }
+
+  return l_u32Pushed;
+}
+
+/**
+ * @brief Pops one sample, consumer side only
+ * 
+ * @param p_psRing the ring to pop from
+ * @param p_psSample the sample to fill
+ * @return false if the ring is empty
+ */
+bool bAPP_SampleRing_pop(sSampleRing_t* p_psRing, sBMP581Sample_t* p_psSample) {
+  return u32APP_SampleRing_popBulk(p_psRing, p_psSample, 1) == 1U;
+}
+
+/**
+ * @brief Pops up to p_u32Max samples with a single index update
+ * 
+ * @param p_psRing the ring to pop from
+ * @param p_psSamples the array to fill
+ * @param p_u32Max the size of p_psSamples
+ * @return the number of samples popped
+ */
+uint32_t u32APP_SampleRing_popBulk(sSampleRing_t* p_psRing, sBMP581Sample_t* p_psSamples, uint32_t p_u32Max) {
+  uint32_t l_u32Tail;
+  uint32_t l_u32Used;
+  uint32_t l_u32Popped;
+
+  if (p_psRing == NULL || p_psSamples == NULL || p_u32Max == 0) {
+    return 0;
+  }
+
+  l_u32Tail = p_psRing->u32_tail;
+  l_u32Used = p_psRing->u32_head - l_u32Tail;
+  /* Do not read slots before reading the head that publishes them */
+  atomic_thread_fence(memory_order_seq_cst);
+
+  l_u32Popped = (p_u32Max < l_u32Used) ? p_u32Max : l_u32Used;
+  if (l_u32Popped != 0) {
+    vAPP_SampleRing_copyOut(p_psRing, l_u32Tail, p_psSamples, l_u32Popped);
+    /* Slots must be read before the tail that frees them */
+    atomic_thread_fence(memory_order_seq_cst);
+    p_psRing->u32_tail = l_u32Tail + l_u32Popped;
+  }
+
+  return l_u32Popped;
+}
+
+/**
+ * @brief Gives the number of samples waiting in the ring
+ * 
+ * @param p_psRing the ring
+ * @return the number of samples
+ */
+uint32_t u32APP_SampleRing_getCount(const sSampleRing_t* p_psRing) {
+  return (p_psRing != NULL) ? p_psRing->u32_head - p_psRing->u32_tail : 0U;
+}
+
+/**
+ * @brief Gives the number of pushes that did not fit entirely
+ * 
+ * @param p_psRing the ring
+ * @return the number of overflow events
+ */
+uint32_t u32APP_SampleRing_getOverflowEvents(const sSampleRing_t* p_psRing) {
+  return (p_psRing != NULL) ? p_psRing->u32_overflow_events : 0U;
+}
+
+/**
+ * @brief Gives the number of samples dropped because the ring was full
+ * 
+ * @param p_psRing the ring
+ * @return the number of dropped samples
+ */
+uint32_t u32APP_SampleRing_getDroppedSamples(const sSampleRing_t* p_psRing) {
+  return (p_psRing != NULL) ? p_psRing->u32_dropped_samples : 0U;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Copies samples into the ring, wrapping at the end of the buffer
+ * 
+ * @param p_psRing the ring
+ * @param p_u32Index the free running index of the first slot
+ * @param p_psSamples the samples to copy
+ * @param p_u32Count the number of samples, at most the free space
+ * @return
+ */
+static void vAPP_SampleRing_copyIn(sSampleRing_t* p_psRing, uint32_t p_u32Index, const sBMP581Sample_t* p_psSamples, uint32_t p_u32Count) {
+  uint32_t l_u32Slot = p_u32Index & cAPP_SAMPLE_RING_MASK;
+  uint32_t l_u32First = cAPP_SAMPLE_RING_SIZE - l_u32Slot;
+  uint32_t i;
+
+  if (l_u32First > p_u32Count) {
+    l_u32First = p_u32Count;
+  }
+  for (i = 0; i < l_u32First; i++) {
+    p_psRing->as_samples[l_u32Slot + i] = p_psSamples[i];
+  }
+  for (; i < p_u32Count; i++) {
+    p_psRing->as_samples[i - l_u32First] = p_psSamples[i];
+  }
+}
+
+/**
+ * @brief Copies samples out of the ring, wrapping at the end of the buffer
+ * 
+ * @param p_psRing the ring
+ * @param p_u32Index the free running index of the first slot
+ * @param p_psSamples the array to fill
+ * @param p_u32Count the number of samples, at most the used space
+ * @return
+ */
+static void vAPP_SampleRing_copyOut(const sSampleRing_t* p_psRing, uint32_t p_u32Index, sBMP581Sample_t* p_psSamples, uint32_t p_u32Count) {
+  uint32_t l_u32Slot = p_u32Index & cAPP_SAMPLE_RING_MASK;
+  uint32_t l_u32First = cAPP_SAMPLE_RING_SIZE - l_u32Slot;
+  uint32_t i;
+
+  if (l_u32First > p_u32Count) {
+    l_u32First = p_u32Count;
+  }
+  for (i = 0; i < l_u32First; i++) {
+    p_psSamples[i] = p_psRing->as_samples[l_u32Slot + i];
+  }
+  for (; i < p_u32Count; i++) {
+    p_psSamples[i] = p_psRing->as_samples[i - l_u32First];
+  }
+}
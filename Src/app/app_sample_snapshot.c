@@ -0,0 +1,110 @@
+/**
+  ******************************************************************************
+  * @file           : app_sample_snapshot.c
+  * @brief          : Triple-buffered latest sample snapshot
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/24
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+
+/* Used interfaces (dependencies includes ) ----------------------------------*/
+#include <stddef.h>
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "app/app_sample_snapshot.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cAPP_SNAPSHOT_SLOT_MASK (uint32_t)0x03
+#define cAPP_SNAPSHOT_FRESH     (uint32_t)0x04
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Initialises an empty snapshot
+ * 
+ * Must be called before the producer interrupt is enabled.
+ * 
+ * @param p_psSnapshot the snapshot to initialise
+ * @return
+ */
+void vAPP_SampleSnapshot_init(sSampleSnapshot_t* p_psSnapshot) {
+  if (p_psSnapshot != NULL) {
+    p_psSnapshot->u32_write_slot = 0;
+    p_psSnapshot->u32_middle = 1;
+    p_psSnapshot->u32_read_slot = 2;
+    p_psSnapshot->b_valid = false;
+  }
+}
+
+/**
+ * @brief Publishes a new sample, producer side only
+ * 
+ * Writes the sample in the producer slot then swaps it with the middle
+ * slot, so the consumer picks it up on its next read. A sample that was
+ * never read is overwritten.
+ * 
+ * @param p_psSnapshot the snapshot
+ * @param p_psSample the sample to publish
+ * @return
+ */
+void vAPP_SampleSnapshot_publish(sSampleSnapshot_t* p_psSnapshot, const sBMP581Sample_t* p_psSample) {
+  uint32_t l_u32Previous;
+
+  if (p_psSnapshot == NULL || p_psSample == NULL) {
+    return;
+  }
+
+  p_psSnapshot->as_slots[p_psSnapshot->u32_write_slot] = *p_psSample;
+  l_u32Previous = atomic_exchange_explicit(
+    &p_psSnapshot->u32_middle,
+    p_psSnapshot->u32_write_slot | cAPP_SNAPSHOT_FRESH,
+    memory_order_acq_rel
+  );
+  p_psSnapshot->u32_write_slot = l_u32Previous & cAPP_SNAPSHOT_SLOT_MASK;
+}
+
+/**
+ * @brief Reads the latest sample, consumer side only
+ * 
+ * Takes the middle slot if the producer published since the last read,
+ * otherwise returns the same sample again. Never touches the bus.
+ * 
+ * @param p_psSnapshot the snapshot
+ * @param p_psSample the sample to fill
+ * @return false if no sample was published yet
+ */
+bool bAPP_SampleSnapshot_read(sSampleSnapshot_t* p_psSnapshot, sBMP581Sample_t* p_psSample) {
+  uint32_t l_u32Previous;
+
+  if (p_psSnapshot == NULL || p_psSample == NULL) {
+    return false;
+  }
+
+  if ((atomic_load_explicit(&p_psSnapshot->u32_middle, memory_order_relaxed) & cAPP_SNAPSHOT_FRESH) != 0U) {
+    l_u32Previous = atomic_exchange_explicit(
+      &p_psSnapshot->u32_middle,
+      p_psSnapshot->u32_read_slot,
+      memory_order_acq_rel
+    );
+    p_psSnapshot->u32_read_slot = l_u32Previous & cAPP_SNAPSHOT_SLOT_MASK;
+    p_psSnapshot->b_valid = true;
+  }
+
+  if (p_psSnapshot->b_valid) {
+    *p_psSample = p_psSnapshot->as_slots[p_psSnapshot->u32_read_slot];
+  }
+
+  return p_psSnapshot->b_valid;
+}
+
+/* Private functions ---------------------------------------------------------*/
@@ -86,4 +86,8 @@ void vHAL_Clock_delay(uint32_t pu32Delay) {
   HAL_Delay(pu32Delay);
 }
 
+uint32_t u32HAL_Clock_getTick(void) {
+  return HAL_GetTick();
+}
+
 /* Private functions ---------------------------------------------------------*/
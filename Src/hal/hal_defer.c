@@ -0,0 +1,162 @@
+/**
+  ******************************************************************************
+  * @file           : hal_defer.c
+  * @brief          : Deferred-call queue, interrupt handlers post work that
+  * runs from PendSV at the lowest priority
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/29
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stddef.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "hal/hal_dwt.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "hal/hal_defer.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  pfHAL_DeferCall_t pf_call;
+  uint32_t u32_post_cycles;
+} sHAL_DeferEntry_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sHAL_DeferEntry_t s_asQueue[cHAL_DEFER_QUEUE_SIZE];
+static volatile uint32_t s_u32Head = 0; //Written by the posting handlers
+static volatile uint32_t s_u32Tail = 0; //Written by PendSV only
+static sHAL_DeferStats_t s_sStats;
+
+_Static_assert((cHAL_DEFER_QUEUE_SIZE & (cHAL_DEFER_QUEUE_SIZE - 1)) == 0, "cHAL_DEFER_QUEUE_SIZE must be a power of two");
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Init function for the deferred-call queue
+ * 
+ * PendSV priority is set by vHAL_NVIC_init.
+ * 
+ * @return
+ */
+void vHAL_Defer_init(void) {
+  s_u32Head = 0;
+  s_u32Tail = 0;
+  vHAL_Defer_resetStats();
+}
+
+/**
+ * @brief Queues a call and pends PendSV to run it
+ * 
+ * Safe from any interrupt priority and from thread mode. Calls run in
+ * posting order once no other interrupt is active.
+ * 
+ * @param p_pfCall the function to call
+ * @return false if the queue is full, the call is dropped
+ */
+bool bHAL_Defer_post(pfHAL_DeferCall_t p_pfCall) {
+  uint32_t l_u32Primask;
+  uint32_t l_u32Depth;
+
+  if (p_pfCall == NULL) {
+    return false;
+  }
+
+  l_u32Primask = __get_PRIMASK();
+  __disable_irq();
+
+  l_u32Depth = s_u32Head - s_u32Tail;
+  if (l_u32Depth >= cHAL_DEFER_QUEUE_SIZE) {
+    s_sStats.u32_dropped++;
+    __set_PRIMASK(l_u32Primask);
+    return false;
+  }
+
+  s_asQueue[s_u32Head & (cHAL_DEFER_QUEUE_SIZE - 1)].pf_call = p_pfCall;
+  s_asQueue[s_u32Head & (cHAL_DEFER_QUEUE_SIZE - 1)].u32_post_cycles = u32HAL_DWT_getCycles();
+  s_u32Head++;
+  s_sStats.u32_posted++;
+  if (l_u32Depth + 1 > s_sStats.u32_high_watermark) {
+    s_sStats.u32_high_watermark = l_u32Depth + 1;
+  }
+
+  __set_PRIMASK(l_u32Primask);
+
+  SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+  return true;
+}
+
+/**
+ * @brief Runs every queued call
+ * 
+ * Called from PendSV_Handler. Calls posted while draining run in the same
+ * pass.
+ * 
+ * @return
+ */
+void vHAL_Defer_run(void) {
+  sHAL_DeferEntry_t l_sEntry;
+  uint32_t l_u32Latency;
+
+  while (s_u32Tail != s_u32Head) {
+    l_sEntry = s_asQueue[s_u32Tail & (cHAL_DEFER_QUEUE_SIZE - 1)];
+    __DMB();
+    s_u32Tail++;
+
+    l_u32Latency = u32HAL_DWT_getCycles() - l_sEntry.u32_post_cycles;
+    s_sStats.u32_last_latency_cycles = l_u32Latency;
+    if (l_u32Latency > s_sStats.u32_max_latency_cycles) {
+      s_sStats.u32_max_latency_cycles = l_u32Latency;
+    }
+    s_sStats.u32_run++;
+
+    l_sEntry.pf_call();
+  }
+}
+
+/**
+ * @brief Gives a copy of the queue statistics
+ * 
+ * @param p_psStats the statistics
+ * @return
+ */
+void vHAL_Defer_getStats(sHAL_DeferStats_t* p_psStats) {
+  uint32_t l_u32Primask;
+
+  if (p_psStats == NULL) {
+    return;
+  }
+
+  l_u32Primask = __get_PRIMASK();
+  __disable_irq();
+  *p_psStats = s_sStats;
+  __set_PRIMASK(l_u32Primask);
+}
+
+/**
+ * @brief Clears the queue statistics
+ * 
+ * @return
+ */
+void vHAL_Defer_resetStats(void) {
+  uint32_t l_u32Primask = __get_PRIMASK();
+
+  __disable_irq();
+  s_sStats.u32_posted = 0;
+  s_sStats.u32_run = 0;
+  s_sStats.u32_dropped = 0;
+  s_sStats.u32_high_watermark = s_u32Head - s_u32Tail;
+  s_sStats.u32_max_latency_cycles = 0;
+  s_sStats.u32_last_latency_cycles = 0;
+  __set_PRIMASK(l_u32Primask);
+}
+
+/* Private functions ---------------------------------------------------------*/
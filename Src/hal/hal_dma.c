@@ -10,7 +10,9 @@
 /* General interfaces --------------------------------------------------------*/
 
 /* Used interfaces (dependencies includes) -----------------------------------*/
+#include <stddef.h>
 #include "stm32h7xx_hal.h"
+#include "hal/hal_nvic.h"
 
 /* Associated interfaces -----------------------------------------------------*/
 #include "hal/hal_dma.h"
@@ -34,18 +36,113 @@ void vHAL_DMA_init(void)
 
   /* DMA interrupt init */
   /* DMA1_Stream0_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(DMA1_Stream0_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(DMA1_Stream0_IRQn);
+  vHAL_NVIC_enable(DMA1_Stream0_IRQn);
   /* DMA1_Stream1_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(DMA1_Stream1_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(DMA1_Stream1_IRQn);
+  vHAL_NVIC_enable(DMA1_Stream1_IRQn);
+#ifndef BMP581_NO_SPI
   /* DMA1_Stream2_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(DMA1_Stream2_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(DMA1_Stream2_IRQn);
+  vHAL_NVIC_enable(DMA1_Stream2_IRQn);
   /* DMA1_Stream3_IRQn interrupt configuration */
-  HAL_NVIC_SetPriority(DMA1_Stream3_IRQn, 0, 0);
-  HAL_NVIC_EnableIRQ(DMA1_Stream3_IRQn);
+  vHAL_NVIC_enable(DMA1_Stream3_IRQn);
+#endif
 
 }
 
+/**
+ * @brief Picks the stream profile of a transfer
+ * 
+ * The burst profile needs a whole number of bursts and a buffer aligned on
+ * a burst, so bursts neither straddle a 1 KB boundary nor leave a partial
+ * word in the FIFO at the end of the transfer.
+ * 
+ * @param p_pvBuffer the memory side buffer
+ * @param p_u32Size the transfer size in bytes
+ * @return the burst profile when allowed, the single profile otherwise
+ */
+eHAL_DMAProfile_t eHAL_DMA_selectProfile(const void* p_pvBuffer, uint32_t p_u32Size) {
+  if (
+    p_u32Size != 0 &&
+    (p_u32Size % cHAL_DMA_BURST_BYTES) == 0 &&
+    ((uintptr_t)p_pvBuffer % cHAL_DMA_BURST_BYTES) == 0
+  ) {
+    return ceHAL_DMA_PROFILE_BURST;
+  }
+
+  return ceHAL_DMA_PROFILE_SINGLE;
+}
+
+/**
+ * @brief Reconfigures an idle stream for a profile
+ * 
+ * Does nothing if the stream already uses the profile and priority, so it
+ * can be called before each transfer. The stream must not be running.
+ * 
+ * @param p_phDma the stream handle
+ * @param p_eProfile the profile to use
+ * @param p_u32Priority the stream priority (DMA_PRIORITY_x)
+ * @param p_u32PeriphBurst the peripheral burst of the burst profile, must
+ * match the data count of one peripheral request (SPI FIFO threshold)
+ * @return
+ */
+void vHAL_DMA_applyProfile(DMA_HandleTypeDef* p_phDma, eHAL_DMAProfile_t p_eProfile, uint32_t p_u32Priority, uint32_t p_u32PeriphBurst) {
+  uint32_t l_u32FIFOMode;
+  uint32_t l_u32MemAlign;
+  uint32_t l_u32MemBurst;
+  uint32_t l_u32PeriphBurst;
+
+  if (p_phDma == NULL || p_phDma->State == HAL_DMA_STATE_BUSY) {
+    return;
+  }
+
+  if (p_eProfile == ceHAL_DMA_PROFILE_BURST) {
+    l_u32FIFOMode = DMA_FIFOMODE_ENABLE;
+    l_u32MemAlign = DMA_MDATAALIGN_WORD;
+    l_u32MemBurst = DMA_MBURST_INC4;
+    l_u32PeriphBurst = p_u32PeriphBurst;
+  }
+  else {
+    l_u32FIFOMode = DMA_FIFOMODE_DISABLE;
+    l_u32MemAlign = DMA_MDATAALIGN_BYTE;
+    l_u32MemBurst = DMA_MBURST_SINGLE;
+    l_u32PeriphBurst = DMA_PBURST_SINGLE;
+  }
+
+  if (
+    p_phDma->Init.FIFOMode == l_u32FIFOMode &&
+    p_phDma->Init.MemDataAlignment == l_u32MemAlign &&
+    p_phDma->Init.MemBurst == l_u32MemBurst &&
+    p_phDma->Init.PeriphBurst == l_u32PeriphBurst &&
+    p_phDma->Init.Priority == p_u32Priority
+  ) {
+    return;
+  }
+
+  p_phDma->Init.FIFOMode = l_u32FIFOMode;
+  p_phDma->Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+  p_phDma->Init.MemDataAlignment = l_u32MemAlign;
+  p_phDma->Init.MemBurst = l_u32MemBurst;
+  p_phDma->Init.PeriphBurst = l_u32PeriphBurst;
+  p_phDma->Init.Priority = p_u32Priority;
+  HAL_DMA_Init(p_phDma);
+}
+
+/**
+ * @brief Number of memory side bus transactions of a transfer
+ * 
+ * The bus matrix has no transaction counter, the number is derived from
+ * the stream configuration: one per byte in direct mode, one per 4 beat
+ * burst with the FIFO, plus the words left after the last burst.
+ * 
+ * @param p_eProfile the stream profile
+ * @param p_u32Size the transfer size in bytes
+ * @return the number of AHB transactions
+ */
+uint32_t u32HAL_DMA_getTransactions(eHAL_DMAProfile_t p_eProfile, uint32_t p_u32Size) {
+  if (p_eProfile == ceHAL_DMA_PROFILE_BURST) {
+    return (p_u32Size / cHAL_DMA_BURST_BYTES) + ((p_u32Size % cHAL_DMA_BURST_BYTES) + 3) / 4;
+  }
+
+  return p_u32Size;
+}
+
 /* Private functions ---------------------------------------------------------*/
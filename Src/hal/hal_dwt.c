@@ -0,0 +1,79 @@
+/**
+  ******************************************************************************
+  * @file           : hal_dwt.c
+  * @brief          : DWT cycle counter used for profiling
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/25
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "hal/hal_dwt.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cHAL_DWT_LAR_UNLOCK (uint32_t)0xC5ACCE55
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Init function for the DWT cycle counter
+ * 
+ * Enables the trace block and starts CYCCNT, counting CPU cycles.
+ * 
+ * @return
+ */
+void vHAL_DWT_init(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->LAR = cHAL_DWT_LAR_UNLOCK;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief Gives the current CPU cycle count
+ * 
+ * The counter wraps, so only differences between two reads are meaningful.
+ * 
+ * @return the cycle count
+ */
+uint32_t u32HAL_DWT_getCycles(void) {
+  return DWT->CYCCNT;
+}
+
+/**
+ * @brief Converts a cycle count into microseconds
+ * 
+ * @param p_u32Cycles the number of CPU cycles
+ * @return the duration in us
+ */
+uint32_t u32HAL_DWT_cyclesToUs(uint32_t p_u32Cycles) {
+  return (uint32_t)(((uint64_t)p_u32Cycles * 1000000U) / SystemCoreClock);
+}
+
+/**
+ * @brief Converts microseconds into a cycle count
+ * 
+ * For timeouts measured on the cycle counter, which wraps after a few
+ * seconds.
+ * 
+ * @param p_u32Us the duration in us
+ * @return the number of CPU cycles
+ */
+uint32_t u32HAL_DWT_usToCycles(uint32_t p_u32Us) {
+  return (SystemCoreClock / 1000000U) * p_u32Us;
+}
+
+/* Private functions ---------------------------------------------------------*/
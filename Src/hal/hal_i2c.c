@@ -15,10 +15,32 @@
 
 /* Associated interfaces -----------------------------------------------------*/
 #include "hal/hal_i2c.h"
+#include "hal/hal_dwt.h"
+#include "hal/hal_dma.h"
+#include "hal/hal_nvic.h"
+#include "hal/hal_defer.h"
+#include "hal/hal_timer.h"
+#include "hal/hal_trace.h"
 
 /* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  sI2CTransfer_t s_transfer;
+  bool b_success;
+  uint8_t u8_retries;
+} sI2CQueueSlot_t;
 
 /* Private define ------------------------------------------------------------*/
+#define cI2C_TIMEOUT_MS    (uint32_t)1000
+#define cI2C_LL_TIMEOUT_US (uint32_t)10000 //Register-level transfer, on the cycle counter
+#define cI2C_LL_MAX_NBYTES (uint32_t)255
+#define cI2C_LL_ERRORS     (I2C_ISR_NACKF | I2C_ISR_BERR | I2C_ISR_ARLO)
+#define cI2C_BENCH_MAX_SIZE 32
+#define cI2C_QUEUE_MASK    (uint32_t)(cI2C_QUEUE_SIZE - 1)
+#define cI2C_SCL_PIN       GPIO_PIN_6
+#define cI2C_SDA_PIN       GPIO_PIN_7
+#define cI2C_RECOVERY_CLOCKS 9
+#define cI2C_RECOVERY_HALF_US (uint32_t)5 //Bus clear at 100 kHz, slowest slave speed
+#define cI2C_BUS_ERRORS    (HAL_I2C_ERROR_ARLO | HAL_I2C_ERROR_TIMEOUT) //May leave a slave holding the bus
 
 /* Private macro -------------------------------------------------------------*/
 
@@ -26,8 +48,62 @@
 static I2C_HandleTypeDef hi2c1;
 static DMA_HandleTypeDef hdma_i2c1_tx;
 static DMA_HandleTypeDef hdma_i2c1_rx;
+static uint8_t s_u8TxByte = 0; //vI2C_write_DMA source, must outlive the call
+static sHAL_TransferDispatch_t s_sDispatch;
+static sHAL_SchedResource_t s_sResource; //hi2c1 and its DMA streams
+static volatile uint32_t s_u32IsrCycles = 0; //CPU cycles spent in I2C and I2C DMA interrupts
+
+/* Free running indices: submitted up to head, on the bus at active, notified up to tail */
+static sI2CQueueSlot_t s_asQueue[cI2C_QUEUE_SIZE];
+static volatile uint32_t s_u32QueueHead = 0;
+static volatile uint32_t s_u32QueueActive = 0;
+static volatile uint32_t s_u32QueueTail = 0;
+static volatile bool s_bQueueOnBus = false;     //The transfer at active was started
+static volatile bool s_bQueueDrainPosted = false;
+
+static sHAL_Timer_t s_sWatchdog;                 //Timeout of the transfer on the bus
+static volatile bool s_bQueueTimeout = false;    //Set by the watchdog, handled in I2C1_ER
+static volatile bool s_bRecoveryPending = false; //hi2c1 held busy until recovered in I2C1_ER
+static volatile bool s_bBusClearPending = false; //The pending recovery must clear the bus
+static sI2CRecoveryStats_t s_sRecoveryStats = {0};
+#ifdef I2C_FAULT_INJECTION
+static eI2CFault_t s_eFault = ceI2C_FAULT_NONE;
+static uint32_t s_u32FaultCount = 0;
+#endif
+
+static uint8_t s_au8CalBuffer[cI2C_BENCH_MAX_SIZE] __attribute__((aligned(cHAL_DMA_BURST_BYTES)));
+static const uint16_t s_au16BenchSizes[cI2C_BENCH_SIZE_NB] = {1, 2, 4, 6, 16, cI2C_BENCH_MAX_SIZE};
+static sI2CBenchmark_t s_asBenchmark[cI2C_BENCH_SIZE_NB];
+static const uint16_t s_au16DMABenchSizes[cI2C_DMA_BENCH_SIZE_NB] = {16, cI2C_BENCH_MAX_SIZE};
+static sHAL_DMABenchmark_t s_asDMABenchmark[cI2C_DMA_BENCH_SIZE_NB];
 
 /* Private function prototypes -----------------------------------------------*/
+static bool bI2C_llAcquire(void);
+static void vI2C_llRelease(void);
+static bool bI2C_llWaitFlag(uint32_t p_u32Flag, uint32_t p_u32Start);
+static bool bI2C_llExpired(uint32_t p_u32Start);
+static void vI2C_llStartChunk(uint32_t p_u32Remaining, uint32_t p_u32Start);
+static bool bI2C_llMemRead(uint16_t p_u16DevAddress, uint8_t p_u8MemAddress, uint8_t* p_pu8Data, uint16_t p_u16Size);
+static bool bI2C_llMemWrite(uint16_t p_u16DevAddress, uint8_t p_u8MemAddress, const uint8_t* p_pu8Data, uint16_t p_u16Size);
+static void vI2C_llAbort(void);
+static void vI2C_prepareRxDMA(const uint8_t* p_pu8Data, uint16_t p_u16Size);
+static bool bI2C_waitReady(uint32_t p_u32Start, uint16_t p_u16Size);
+static uint32_t u32I2C_benchAdd(uint32_t p_u32Total, bool p_bSuccess, uint32_t p_u32Cycles);
+static void vI2C_busDone(bool p_bSuccess);
+static void vI2C_queueStart(void);
+static bool bI2C_queueStartTransfer(const sI2CQueueSlot_t* p_psSlot);
+static void vI2C_queueComplete(bool p_bSuccess);
+static void vI2C_queueDrain(void);
+static void vI2C_queueFail(void);
+static void vI2C_watchdog(void* p_pvArg);
+static void vI2C_serviceRecovery(void);
+static void vI2C_recoverBus(void);
+static void vI2C_resetPeripheral(void);
+static void vI2C_configure(void);
+static void vI2C_waitUs(uint32_t p_u32DelayUs);
+#ifdef I2C_FAULT_INJECTION
+static bool bI2C_injectStart(void);
+#endif
 
 /* Public functions ----------------------------------------------------------*/
 
@@ -40,20 +116,19 @@ static DMA_HandleTypeDef hdma_i2c1_rx;
  */
 void vI2C_init(void)
 {
-  hi2c1.Instance = I2C1;
-  hi2c1.Init.Timing = 0x00707CBB;
-  hi2c1.Init.OwnAddress1 = 0;
-  hi2c1.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
-  hi2c1.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
-  hi2c1.Init.OwnAddress2 = 0;
-  hi2c1.Init.OwnAddress2Masks = I2C_OA2_NOMASK;
-  hi2c1.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
-  hi2c1.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
-  
-  HAL_I2C_Init(&hi2c1);
-  HAL_I2CEx_ConfigAnalogFilter(&hi2c1, I2C_ANALOGFILTER_ENABLE);
-  HAL_I2CEx_ConfigDigitalFilter(&hi2c1, 0);
+  vI2C_configure();
+
+  vHAL_Transfer_init(&s_sDispatch);
+  vHAL_Timer_create(&s_sWatchdog, vI2C_watchdog, NULL);
 
+  /* Interrupts driving hi2c1 and PendSV chaining transfers from the
+   * completion callbacks, tasks starting transfers add themselves */
+  vHAL_Sched_initResource(&s_sResource);
+  vHAL_Sched_addUser(&s_sResource, u32HAL_NVIC_getPriority(I2C1_EV_IRQn));
+  vHAL_Sched_addUser(&s_sResource, u32HAL_NVIC_getPriority(I2C1_ER_IRQn));
+  vHAL_Sched_addUser(&s_sResource, u32HAL_NVIC_getPriority(DMA1_Stream0_IRQn));
+  vHAL_Sched_addUser(&s_sResource, u32HAL_NVIC_getPriority(DMA1_Stream1_IRQn));
+  vHAL_Sched_addUser(&s_sResource, cHAL_NVIC_PRIO_DEFERRED);
 }
 
 /**
@@ -102,7 +177,7 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef* i2cHandle)
     hdma_i2c1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_i2c1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
     hdma_i2c1_tx.Init.Mode = DMA_NORMAL;
-    hdma_i2c1_tx.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_i2c1_tx.Init.Priority = cHAL_DMA_PRIORITY_I2C_TX;
     hdma_i2c1_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
     HAL_DMA_Init(&hdma_i2c1_tx);
 
@@ -117,17 +192,15 @@ void HAL_I2C_MspInit(I2C_HandleTypeDef* i2cHandle)
     hdma_i2c1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_i2c1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
     hdma_i2c1_rx.Init.Mode = DMA_NORMAL;
-    hdma_i2c1_rx.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_i2c1_rx.Init.Priority = cHAL_DMA_PRIORITY_I2C_RX;
     hdma_i2c1_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
     HAL_DMA_Init(&hdma_i2c1_rx);
 
     __HAL_LINKDMA(i2cHandle,hdmarx,hdma_i2c1_rx);
 
     /* I2C1 interrupt Init */
-    HAL_NVIC_SetPriority(I2C1_EV_IRQn, 0, 0);
-    HAL_NVIC_EnableIRQ(I2C1_EV_IRQn);
-    HAL_NVIC_SetPriority(I2C1_ER_IRQn, 0, 0);
-    HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
+    vHAL_NVIC_enable(I2C1_EV_IRQn);
+    vHAL_NVIC_enable(I2C1_ER_IRQn);
   }
 }
 
@@ -190,7 +263,7 @@ void vI2C_transmit_DMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t* p_pu8Data, uint1
   if (p_pi2cSensorInfo != NULL) {
     HAL_I2C_Master_Transmit_DMA(
       &hi2c1, 
-      (uint16_t)p_pi2cSensorInfo->u8_i2cAddress,
+      (uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1, //Left shift of one byte for the HAL needed
       p_pu8Data,
       p_u16Size //In bytes
     );
@@ -211,7 +284,7 @@ void vI2C_receive_DMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t* p_pu8Data, uint16
   if (p_pi2cSensorInfo != NULL) {
     HAL_I2C_Master_Receive_DMA(
       &hi2c1,
-      (uint16_t)p_pi2cSensorInfo->u8_i2cAddress,
+      (uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1, //Left shift of one byte for the HAL needed
       p_pu8Data,
       p_u16Size //In bytes
     );
@@ -225,18 +298,20 @@ void vI2C_receive_DMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t* p_pu8Data, uint16
  * 
  * @param p_pi2cSensorInfo the I2C sensor object to write
  * @param p_u8WriteAddress the I2C register address to write data
- * @param p_pu8Data the data array to write into I2C device's register
- * @param p_u16Size the size of the data array to write
+ * @param p_pu8Data the byte to write into I2C device's register
+ * @param p_u16Size the size of the data to write, only 1 is accepted
  * @return
  */
 void vI2C_write_DMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8WriteAddress, uint8_t p_pu8Data, uint16_t p_u16Size) {
-  if (p_pi2cSensorInfo != NULL) {
+  if (p_pi2cSensorInfo != NULL && p_u16Size == 1 && hi2c1.State == HAL_I2C_STATE_READY) {
+    /* The DMA reads the byte after this function returns */
+    s_u8TxByte = p_pu8Data;
     HAL_I2C_Mem_Write_DMA(
       &hi2c1,
-      (uint16_t)p_pi2cSensorInfo->u8_i2cAddress,
+      (uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1, //Left shift of one byte for the HAL needed
       (uint16_t)p_u8WriteAddress,
       (uint16_t)p_pi2cSensorInfo->u8_i2cRegisterSize,
-      &p_pu8Data,
+      &s_u8TxByte,
       p_u16Size //In bytes
     );
   }
@@ -254,15 +329,18 @@ void vI2C_write_DMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8WriteAddress, ui
  * @return
  */
 void vI2C_write(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8WriteAddress, uint8_t p_pu8Data, uint16_t p_u16Size) {
-  if (p_pi2cSensorInfo != NULL) {
+  if (p_pi2cSensorInfo != NULL && p_pi2cSensorInfo->u8_i2cRegisterSize == 1 && p_u16Size <= cI2C_LL_MAX_SIZE) {
+    (void)bI2C_write_LL(p_pi2cSensorInfo, p_u8WriteAddress, &p_pu8Data, p_u16Size);
+  }
+  else if (p_pi2cSensorInfo != NULL) {
     HAL_I2C_Mem_Write(
       &hi2c1,
-      (uint16_t)p_pi2cSensorInfo->u8_i2cAddress,
+      (uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1, //Left shift of one byte for the HAL needed
       (uint16_t)p_u8WriteAddress,
       (uint16_t)p_pi2cSensorInfo->u8_i2cRegisterSize,
       &p_pu8Data,
       p_u16Size, //In bytes
-      1000
+      cI2C_TIMEOUT_MS
     );
   }
 }
@@ -280,6 +358,7 @@ void vI2C_write(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8WriteAddress, uint8_
  */
 void vI2C_read_DMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress, uint8_t* p_pu8Data, uint16_t p_u16Size) {
   if (p_pi2cSensorInfo != NULL) {
+    vI2C_prepareRxDMA(p_pu8Data, p_u16Size);
     HAL_I2C_Mem_Read_DMA(
       &hi2c1,
       (uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1, //Left shift of one byte for the HAL needed
@@ -303,7 +382,10 @@ void vI2C_read_DMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress, uint
  * @return
  */
 void vI2C_read(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress, uint8_t* p_pu8Data, uint16_t p_u16Size) {
-  if (p_pi2cSensorInfo != NULL) {
+  if (p_pi2cSensorInfo != NULL && p_pi2cSensorInfo->u8_i2cRegisterSize == 1 && p_u16Size <= cI2C_LL_MAX_SIZE) {
+    (void)bI2C_read_LL(p_pi2cSensorInfo, p_u8ReadAddress, p_pu8Data, p_u16Size);
+  }
+  else if (p_pi2cSensorInfo != NULL) {
     HAL_I2C_Mem_Read(
       &hi2c1,
       (uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1, //Left shift of one byte for the HAL needed
@@ -311,25 +393,1162 @@ void vI2C_read(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress, uint8_t*
       (uint16_t)p_pi2cSensorInfo->u8_i2cRegisterSize,
       p_pu8Data,
       p_u16Size, //In bytes
-      1000
+      cI2C_TIMEOUT_MS
     );
   }
 }
 
+/**
+ * @brief Read data from I2C device with the register-level engine
+ * 
+ * Drives CR2, TXDR and RXDR directly instead of going through the HAL
+ * state machine, which dominates the cost of 1 or 2 byte register reads.
+ * Blocking, for 8-bit register addresses only.
+ * 
+ * @param p_pi2cSensorInfo the I2C sensor object to read
+ * @param p_u8ReadAddress the I2C register address to read data
+ * @param p_pu8Data the data array to read into I2C device's register
+ * @param p_u16Size the size of the data array to read
+ * @return false if the bus is busy, the device did not answer or timed out
+ */
+bool bI2C_read_LL(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  bool l_bResult;
+
+  if (p_pi2cSensorInfo == NULL || p_pu8Data == NULL || p_u16Size == 0 || !bI2C_llAcquire()) {
+    return false;
+  }
+
+  vHAL_Trace_transferBegin(ceHAL_TRACE_I2C1, p_pi2cSensorInfo->u8_i2cAddress, p_u8ReadAddress, true, p_u16Size, ceHAL_TRANSFER_POLLING);
+  l_bResult = bI2C_llMemRead((uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1, p_u8ReadAddress, p_pu8Data, p_u16Size);
+  vHAL_Trace_transferEnd(ceHAL_TRACE_I2C1, l_bResult ? ceHAL_TRACE_OK : ceHAL_TRACE_ERROR);
+  vI2C_llRelease();
+
+  return l_bResult;
+}
+
+/**
+ * @brief Write data to I2C device with the register-level engine
+ * 
+ * Blocking, for 8-bit register addresses only.
+ * 
+ * @param p_pi2cSensorInfo the I2C sensor object to write
+ * @param p_u8WriteAddress the I2C register address to write data
+ * @param p_pu8Data the data array to write into I2C device's register
+ * @param p_u16Size the size of the data array to write
+ * @return false if the bus is busy, the device did not answer or timed out
+ */
+bool bI2C_write_LL(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8WriteAddress, const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  bool l_bResult;
+
+  if (p_pi2cSensorInfo == NULL || p_pu8Data == NULL || p_u16Size == 0 || !bI2C_llAcquire()) {
+    return false;
+  }
+
+  vHAL_Trace_transferBegin(ceHAL_TRACE_I2C1, p_pi2cSensorInfo->u8_i2cAddress, p_u8WriteAddress, false, p_u16Size, ceHAL_TRANSFER_POLLING);
+  l_bResult = bI2C_llMemWrite((uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1, p_u8WriteAddress, p_pu8Data, p_u16Size);
+  vHAL_Trace_transferEnd(ceHAL_TRACE_I2C1, l_bResult ? ceHAL_TRACE_OK : ceHAL_TRACE_ERROR);
+  vI2C_llRelease();
+
+  return l_bResult;
+}
+
+/**
+ * @brief Queues a memory transfer
+ * 
+ * Transfers run one after the other in submission order, with interrupts
+ * or DMA as picked by the calibrated thresholds, and their completion is
+ * notified in PendSV. A failed or timed out transfer is replayed after a
+ * recovery, up to cI2C_RETRY_MAX times. Callable from any user of the
+ * hi2c1 resource (see psI2C_getResource) and from thread mode, including
+ * a completion callback to chain the next transfer. A transfer that
+ * cannot start is notified as failed.
+ * 
+ * @param p_psTransfer the transfer, copied into the queue
+ * @return false if the transfer is invalid or the queue is full
+ */
+bool bI2C_submit(const sI2CTransfer_t* p_psTransfer) {
+  uint32_t l_u32Key;
+
+  if (
+    p_psTransfer == NULL ||
+    p_psTransfer->ps_sensor == NULL ||
+    p_psTransfer->pu8_data == NULL ||
+    p_psTransfer->u16_size == 0
+  ) {
+    return false;
+  }
+
+  l_u32Key = u32HAL_Sched_lock(&s_sResource);
+
+  if (s_u32QueueHead - s_u32QueueTail >= cI2C_QUEUE_SIZE) {
+    vHAL_Sched_unlock(l_u32Key);
+    return false;
+  }
+
+  s_asQueue[s_u32QueueHead & cI2C_QUEUE_MASK].s_transfer = *p_psTransfer;
+  s_asQueue[s_u32QueueHead & cI2C_QUEUE_MASK].b_success = false;
+  s_asQueue[s_u32QueueHead & cI2C_QUEUE_MASK].u8_retries = 0;
+  s_u32QueueHead++;
+  vI2C_queueStart();
+
+  vHAL_Sched_unlock(l_u32Key);
+  return true;
+}
+
+/**
+ * @brief Gives the number of queued transfers not notified yet
+ * 
+ * @return the queue depth
+ */
+uint32_t u32I2C_getQueueDepth(void) {
+  return s_u32QueueHead - s_u32QueueTail;
+}
+
+/**
+ * @brief Gives a copy of the error recovery counters
+ * 
+ * @param p_psStats the counters
+ * @return
+ */
+void vI2C_getRecoveryStats(sI2CRecoveryStats_t* p_psStats) {
+  uint32_t l_u32Key;
+
+  if (p_psStats == NULL) {
+    return;
+  }
+
+  l_u32Key = u32HAL_Sched_lock(&s_sResource);
+  *p_psStats = s_sRecoveryStats;
+  vHAL_Sched_unlock(l_u32Key);
+}
+
+#ifdef I2C_FAULT_INJECTION
+/**
+ * @brief Forces a fault on the next queued transfers
+ * 
+ * The transfers are not started and go through the same error, retry and
+ * bus recovery path as a real fault. Replays count, so a count above
+ * cI2C_RETRY_MAX makes a transfer fail for good.
+ * 
+ * @param p_eFault the fault to force
+ * @param p_u32Count the number of transfer starts to fault
+ * @return
+ */
+void vI2C_injectFault(eI2CFault_t p_eFault, uint32_t p_u32Count) {
+  uint32_t l_u32Key;
+
+  l_u32Key = u32HAL_Sched_lock(&s_sResource);
+  s_eFault = p_eFault;
+  s_u32FaultCount = (p_eFault == ceI2C_FAULT_NONE) ? 0 : p_u32Count;
+  vHAL_Sched_unlock(l_u32Key);
+}
+#endif
+
+/**
+ * @brief Calibrates the transfer mode thresholds
+ * 
+ * Reads p_u8ReadAddress onwards once per mode for each calibration size
+ * and measures the CPU cycles each mode keeps the core busy: the whole
+ * transfer when polling, the start call plus the interrupt handlers with
+ * interrupts or DMA. The thresholds are then set where the cheapest mode
+ * changes. A read that fails or outlasts the queue watchdog time is
+ * stopped and its point left out as UINT32_MAX. Registers read must not
+ * be clear-on-read (INT_STATUS) nor pop data (FIFO_DATA). Must be called
+ * at boot from thread mode with the bus idle.
+ * 
+ * @param p_pi2cSensorInfo the I2C sensor object to read
+ * @param p_u8ReadAddress the first register to read
+ * @return
+ */
+void vI2C_calibrate(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress) {
+  uint16_t l_u16DevAddress;
+  uint16_t l_u16Size;
+  uint32_t l_u32Start;
+  uint32_t l_u32Busy;
+  HAL_StatusTypeDef l_eStatus;
+  uint32_t i;
+  uint32_t l_u32Mode;
+
+  if (p_pi2cSensorInfo == NULL) {
+    return;
+  }
+
+  l_u16DevAddress = (uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1;
+
+  for (i = 0; i < cHAL_TRANSFER_CAL_SIZE_NB; i++) {
+    l_u16Size = u16HAL_Transfer_getCalSize(i);
+
+    for (l_u32Mode = 0; l_u32Mode < ceHAL_TRANSFER_MODE_NB; l_u32Mode++) {
+      s_u32IsrCycles = 0;
+      l_u32Start = u32HAL_DWT_getCycles();
+
+      if (l_u32Mode == ceHAL_TRANSFER_POLLING) {
+        l_eStatus = bI2C_read_LL(p_pi2cSensorInfo, p_u8ReadAddress, s_au8CalBuffer, l_u16Size) ? HAL_OK : HAL_ERROR;
+      }
+      else if (l_u32Mode == ceHAL_TRANSFER_IT) {
+        l_eStatus = HAL_I2C_Mem_Read_IT(&hi2c1, l_u16DevAddress, p_u8ReadAddress, I2C_MEMADD_SIZE_8BIT,
+                                        s_au8CalBuffer, l_u16Size);
+      }
+      else {
+        vI2C_prepareRxDMA(s_au8CalBuffer, l_u16Size);
+        l_eStatus = HAL_I2C_Mem_Read_DMA(&hi2c1, l_u16DevAddress, p_u8ReadAddress, I2C_MEMADD_SIZE_8BIT,
+                                         s_au8CalBuffer, l_u16Size);
+      }
+
+      l_u32Busy = u32HAL_DWT_getCycles() - l_u32Start;
+      if (l_eStatus == HAL_OK && l_u32Mode != ceHAL_TRANSFER_POLLING && !bI2C_waitReady(l_u32Start, l_u16Size)) {
+        l_eStatus = HAL_ERROR;
+      }
+
+      if (l_u32Mode != ceHAL_TRANSFER_POLLING) {
+        /* The core is free between interrupts, only the handlers count */
+        l_u32Busy += s_u32IsrCycles;
+      }
+      s_sDispatch.au32_cal_cycles[i][l_u32Mode] = (l_eStatus == HAL_OK) ? l_u32Busy : UINT32_MAX;
+    }
+  }
+
+  vHAL_Transfer_applyCalibration(&s_sDispatch);
+}
+
+/**
+ * @brief Gives the calibrated thresholds and per-mode counters
+ * 
+ * @return the I2C dispatcher
+ */
+const sHAL_TransferDispatch_t* psI2C_getDispatch(void) {
+  return &s_sDispatch;
+}
+
+/**
+ * @brief Gives the scheduler resource guarding hi2c1
+ * 
+ * Every I2C access locks it. Tasks submitting transfers declare themselves
+ * with vHAL_Sched_addTaskUser, interrupts more urgent than the ceiling
+ * must not use the bus.
+ * 
+ * @return the hi2c1 resource
+ */
+sHAL_SchedResource_t* psI2C_getResource(void) {
+  return &s_sResource;
+}
+
+/**
+ * @brief Measures the cost of a memory read on each transfer path
+ * 
+ * For each size of s_au16BenchSizes, reads p_u8ReadAddress onwards with
+ * the HAL polling path (HAL_I2C_Mem_Read), the HAL DMA path and the
+ * register-level path, and records the average CPU cycles per read, see
+ * psI2C_getBenchmark. Registers read must not be clear-on-read
+ * (INT_STATUS) nor pop data (FIFO_DATA). Must be called from thread mode
+ * with the bus idle, vHAL_DWT_init must have been called.
+ * 
+ * @param p_pi2cSensorInfo the I2C sensor object to read
+ * @param p_u8ReadAddress the first register to read
+ * @return
+ */
+void vI2C_benchmark(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress) {
+  uint16_t l_u16DevAddress;
+  uint16_t l_u16Size;
+  uint32_t l_u32Start;
+  uint32_t l_u32Poll;
+  uint32_t l_u32DMA;
+  uint32_t l_u32LL;
+  bool l_bSuccess;
+  uint32_t i;
+  uint32_t j;
+
+  if (p_pi2cSensorInfo == NULL) {
+    return;
+  }
+
+  l_u16DevAddress = (uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1;
+
+  for (i = 0; i < cI2C_BENCH_SIZE_NB; i++) {
+    l_u16Size = s_au16BenchSizes[i];
+    l_u32Poll = 0;
+    l_u32DMA = 0;
+    l_u32LL = 0;
+
+    for (j = 0; j < cI2C_BENCH_REPS; j++) {
+      l_u32Start = u32HAL_DWT_getCycles();
+      l_bSuccess = HAL_I2C_Mem_Read(&hi2c1, l_u16DevAddress, p_u8ReadAddress, I2C_MEMADD_SIZE_8BIT,
+                                    s_au8CalBuffer, l_u16Size, cI2C_TIMEOUT_MS) == HAL_OK;
+      l_u32Poll = u32I2C_benchAdd(l_u32Poll, l_bSuccess, u32HAL_DWT_getCycles() - l_u32Start);
+
+      vI2C_prepareRxDMA(s_au8CalBuffer, l_u16Size);
+      l_u32Start = u32HAL_DWT_getCycles();
+      l_bSuccess = HAL_I2C_Mem_Read_DMA(&hi2c1, l_u16DevAddress, p_u8ReadAddress, I2C_MEMADD_SIZE_8BIT,
+                                        s_au8CalBuffer, l_u16Size) == HAL_OK &&
+                   bI2C_waitReady(l_u32Start, l_u16Size);
+      l_u32DMA = u32I2C_benchAdd(l_u32DMA, l_bSuccess, u32HAL_DWT_getCycles() - l_u32Start);
+
+      l_u32Start = u32HAL_DWT_getCycles();
+      l_bSuccess = bI2C_read_LL(p_pi2cSensorInfo, p_u8ReadAddress, s_au8CalBuffer, l_u16Size);
+      l_u32LL = u32I2C_benchAdd(l_u32LL, l_bSuccess, u32HAL_DWT_getCycles() - l_u32Start);
+    }
+
+    s_asBenchmark[i].u16_size = l_u16Size;
+    s_asBenchmark[i].u32_hal_poll_cycles = (l_u32Poll == UINT32_MAX) ? UINT32_MAX : l_u32Poll / cI2C_BENCH_REPS;
+    s_asBenchmark[i].u32_hal_dma_cycles = (l_u32DMA == UINT32_MAX) ? UINT32_MAX : l_u32DMA / cI2C_BENCH_REPS;
+    s_asBenchmark[i].u32_ll_cycles = (l_u32LL == UINT32_MAX) ? UINT32_MAX : l_u32LL / cI2C_BENCH_REPS;
+  }
+}
+
+/**
+ * @brief Gives the read costs measured by vI2C_benchmark
+ * 
+ * @return the results, cI2C_BENCH_SIZE_NB sizes in increasing order, zeroed
+ * until the benchmark ran
+ */
+const sI2CBenchmark_t* psI2C_getBenchmark(void) {
+  return s_asBenchmark;
+}
+
+/**
+ * @brief Measures the DMA read drain time of each stream profile
+ * 
+ * For each size of s_au16DMABenchSizes, reads p_u8ReadAddress onwards with
+ * the RX stream forced to each profile and records the average cycles from
+ * the start of the transfer to its completion, with the memory side bus
+ * transactions of the profile, see psI2C_getDMABenchmark. Same register
+ * and calling constraints as vI2C_benchmark.
+ * 
+ * @param p_pi2cSensorInfo the I2C sensor object to read
+ * @param p_u8ReadAddress the first register to read
+ * @return
+ */
+void vI2C_benchmarkDMA(sI2CSensor_t* p_pi2cSensorInfo, uint8_t p_u8ReadAddress) {
+  uint16_t l_u16DevAddress;
+  uint16_t l_u16Size;
+  uint32_t l_u32Start;
+  uint32_t l_u32Cycles;
+  uint32_t l_u32Profile;
+  bool l_bSuccess;
+  uint32_t i;
+  uint32_t j;
+
+  if (p_pi2cSensorInfo == NULL) {
+    return;
+  }
+
+  l_u16DevAddress = (uint16_t)p_pi2cSensorInfo->u8_i2cAddress << 1;
+
+  for (i = 0; i < cI2C_DMA_BENCH_SIZE_NB; i++) {
+    l_u16Size = s_au16DMABenchSizes[i];
+    s_asDMABenchmark[i].u16_size = l_u16Size;
+
+    for (l_u32Profile = 0; l_u32Profile < ceHAL_DMA_PROFILE_NB; l_u32Profile++) {
+      vHAL_DMA_applyProfile(&hdma_i2c1_rx, (eHAL_DMAProfile_t)l_u32Profile, cHAL_DMA_PRIORITY_I2C_RX, DMA_PBURST_SINGLE);
+      l_u32Cycles = 0;
+
+      for (j = 0; j < cI2C_BENCH_REPS; j++) {
+        l_u32Start = u32HAL_DWT_getCycles();
+        l_bSuccess = HAL_I2C_Mem_Read_DMA(&hi2c1, l_u16DevAddress, p_u8ReadAddress, I2C_MEMADD_SIZE_8BIT,
+                                          s_au8CalBuffer, l_u16Size) == HAL_OK &&
+                     bI2C_waitReady(l_u32Start, l_u16Size);
+        l_u32Cycles = u32I2C_benchAdd(l_u32Cycles, l_bSuccess, u32HAL_DWT_getCycles() - l_u32Start);
+      }
+
+      s_asDMABenchmark[i].au32_drain_cycles[l_u32Profile] = (l_u32Cycles == UINT32_MAX) ? UINT32_MAX : l_u32Cycles / cI2C_BENCH_REPS;
+      s_asDMABenchmark[i].au32_transactions[l_u32Profile] = u32HAL_DMA_getTransactions((eHAL_DMAProfile_t)l_u32Profile, l_u16Size);
+    }
+  }
+
+  vHAL_DMA_applyProfile(&hdma_i2c1_rx, ceHAL_DMA_PROFILE_SINGLE, cHAL_DMA_PRIORITY_I2C_RX, DMA_PBURST_SINGLE);
+}
+
+/**
+ * @brief Gives the drain times measured by vI2C_benchmarkDMA
+ * 
+ * @return the results, cI2C_DMA_BENCH_SIZE_NB sizes in increasing order,
+ * zeroed until the benchmark ran
+ */
+const sHAL_DMABenchmark_t* psI2C_getDMABenchmark(void) {
+  return s_asDMABenchmark;
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c) {
+  if (hi2c->Instance == I2C1) {
+    vI2C_busDone(true);
+  }
+}
+
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c) {
+  if (hi2c->Instance == I2C1) {
+    vI2C_busDone(true);
+  }
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c) {
+  if (hi2c->Instance == I2C1) {
+    vI2C_busDone(false);
+  }
+}
+
 void I2C1_EV_IRQHandler(void) {
+  uint32_t l_u32Start;
+
+  vHAL_NVIC_latencyEntry(I2C1_EV_IRQn);
+  l_u32Start = u32HAL_DWT_getCycles();
   HAL_I2C_EV_IRQHandler(&hi2c1);
+  s_u32IsrCycles += u32HAL_DWT_getCycles() - l_u32Start;
 }
 
 void I2C1_ER_IRQHandler(void) {
+  uint32_t l_u32Start;
+
+  vHAL_NVIC_latencyEntry(I2C1_ER_IRQn);
+  l_u32Start = u32HAL_DWT_getCycles();
   HAL_I2C_ER_IRQHandler(&hi2c1);
+  vI2C_serviceRecovery();
+  s_u32IsrCycles += u32HAL_DWT_getCycles() - l_u32Start;
 }
 
 void DMA1_Stream0_IRQHandler(void) {
+  uint32_t l_u32Start;
+
+  vHAL_NVIC_latencyEntry(DMA1_Stream0_IRQn);
+  l_u32Start = u32HAL_DWT_getCycles();
   HAL_DMA_IRQHandler(&hdma_i2c1_tx);
+  s_u32IsrCycles += u32HAL_DWT_getCycles() - l_u32Start;
 }
 
 void DMA1_Stream1_IRQHandler(void) {
+  uint32_t l_u32Start;
+
+  vHAL_NVIC_latencyEntry(DMA1_Stream1_IRQn);
+  l_u32Start = u32HAL_DWT_getCycles();
   HAL_DMA_IRQHandler(&hdma_i2c1_rx);
+  s_u32IsrCycles += u32HAL_DWT_getCycles() - l_u32Start;
 }
 
 /* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Takes the I2C handle for a register-level transfer
+ * 
+ * Marks the HAL handle busy so interrupt-driven HAL transfers started
+ * meanwhile are rejected instead of corrupting the transfer.
+ * 
+ * @return false if a HAL transfer is ongoing
+ */
+static bool bI2C_llAcquire(void) {
+  uint32_t l_u32Key;
+  bool l_bAcquired = false;
+
+  l_u32Key = u32HAL_Sched_lock(&s_sResource);
+  if (hi2c1.State == HAL_I2C_STATE_READY) {
+    hi2c1.State = HAL_I2C_STATE_BUSY;
+    l_bAcquired = true;
+  }
+  vHAL_Sched_unlock(l_u32Key);
+
+  return l_bAcquired;
+}
+
+/**
+ * @brief Gives the I2C handle back to the HAL
+ * 
+ * Starts the queued transfers submitted while the handle was taken, they
+ * found it busy and wait for this release.
+ * 
+ * @return
+ */
+static void vI2C_llRelease(void) {
+  uint32_t l_u32Key;
+
+  l_u32Key = u32HAL_Sched_lock(&s_sResource);
+  hi2c1.State = HAL_I2C_STATE_READY;
+  vI2C_queueStart();
+  vHAL_Sched_unlock(l_u32Key);
+}
+
+/**
+ * @brief Waits for an ISR flag of the I2C peripheral
+ * 
+ * @param p_u32Flag the I2C_ISR flag to wait for
+ * @param p_u32Start the cycle count the transfer started at
+ * @return false on NACK, bus error, arbitration loss or timeout
+ */
+static bool bI2C_llWaitFlag(uint32_t p_u32Flag, uint32_t p_u32Start) {
+  while ((I2C1->ISR & p_u32Flag) == 0U) {
+    if ((I2C1->ISR & cI2C_LL_ERRORS) != 0U || bI2C_llExpired(p_u32Start)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Tells whether a register-level transfer ran out of time
+ * 
+ * Timed on the cycle counter, the SysTick does not advance while a more
+ * urgent interrupt or a resource lock holds the caller.
+ * 
+ * @param p_u32Start the cycle count the transfer started at
+ * @return true once cI2C_LL_TIMEOUT_US elapsed
+ */
+static bool bI2C_llExpired(uint32_t p_u32Start) {
+  return (u32HAL_DWT_getCycles() - p_u32Start) > u32HAL_DWT_usToCycles(cI2C_LL_TIMEOUT_US);
+}
+
+/**
+ * @brief Loads NBYTES for the next chunk of a transfer
+ * 
+ * Chunks longer than 255 bytes use RELOAD, the last chunk uses AUTOEND so
+ * the peripheral sends the STOP condition by itself.
+ * 
+ * @param p_u32Remaining the number of bytes left in the transfer
+ * @param p_u32Start the SADD, RD_WRN and START bits for a new transfer, 0
+ * to continue after a reload
+ * @return
+ */
+static void vI2C_llStartChunk(uint32_t p_u32Remaining, uint32_t p_u32Start) {
+  uint32_t l_u32CR2;
+
+  if (p_u32Remaining > cI2C_LL_MAX_NBYTES) {
+    l_u32CR2 = (cI2C_LL_MAX_NBYTES << I2C_CR2_NBYTES_Pos) | I2C_CR2_RELOAD;
+  }
+  else {
+    l_u32CR2 = (p_u32Remaining << I2C_CR2_NBYTES_Pos) | I2C_CR2_AUTOEND;
+  }
+
+  if (p_u32Start != 0U) {
+    I2C1->CR2 = l_u32CR2 | p_u32Start;
+  }
+  else {
+    MODIFY_REG(I2C1->CR2, I2C_CR2_NBYTES | I2C_CR2_RELOAD | I2C_CR2_AUTOEND, l_u32CR2);
+  }
+}
+
+/**
+ * @brief Register-level memory read
+ * 
+ * Writes the register address without STOP, then reads with a repeated
+ * START, reloading NBYTES every 255 bytes.
+ * 
+ * @param p_u16DevAddress the 8-bit device address
+ * @param p_u8MemAddress the register address
+ * @param p_pu8Data the array to fill
+ * @param p_u16Size the number of bytes to read
+ * @return false if the transfer failed
+ */
+static bool bI2C_llMemRead(uint16_t p_u16DevAddress, uint8_t p_u8MemAddress, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  uint32_t l_u32Start = u32HAL_DWT_getCycles();
+  uint32_t l_u32Remaining = p_u16Size;
+  uint32_t l_u32Chunk;
+
+  while ((I2C1->ISR & I2C_ISR_BUSY) != 0U) {
+    if (bI2C_llExpired(l_u32Start)) {
+      return false;
+    }
+  }
+
+  /* Register address, software end so a repeated START follows */
+  I2C1->CR2 = ((uint32_t)p_u16DevAddress & I2C_CR2_SADD) | (1U << I2C_CR2_NBYTES_Pos) | I2C_CR2_START;
+  if (!bI2C_llWaitFlag(I2C_ISR_TXIS, l_u32Start)) {
+    vI2C_llAbort();
+    return false;
+  }
+  I2C1->TXDR = p_u8MemAddress;
+  if (!bI2C_llWaitFlag(I2C_ISR_TC, l_u32Start)) {
+    vI2C_llAbort();
+    return false;
+  }
+
+  vI2C_llStartChunk(l_u32Remaining, ((uint32_t)p_u16DevAddress & I2C_CR2_SADD) | I2C_CR2_RD_WRN | I2C_CR2_START);
+  l_u32Chunk = (l_u32Remaining > cI2C_LL_MAX_NBYTES) ? cI2C_LL_MAX_NBYTES : l_u32Remaining;
+
+  while (l_u32Remaining > 0U) {
+    if (!bI2C_llWaitFlag(I2C_ISR_RXNE, l_u32Start)) {
+      vI2C_llAbort();
+      return false;
+    }
+    *p_pu8Data++ = (uint8_t)I2C1->RXDR;
+    l_u32Remaining--;
+    l_u32Chunk--;
+
+    if (l_u32Chunk == 0U && l_u32Remaining > 0U) {
+      if (!bI2C_llWaitFlag(I2C_ISR_TCR, l_u32Start)) {
+        vI2C_llAbort();
+        return false;
+      }
+      vI2C_llStartChunk(l_u32Remaining, 0);
+      l_u32Chunk = (l_u32Remaining > cI2C_LL_MAX_NBYTES) ? cI2C_LL_MAX_NBYTES : l_u32Remaining;
+    }
+  }
+
+  if (!bI2C_llWaitFlag(I2C_ISR_STOPF, l_u32Start)) {
+    vI2C_llAbort();
+    return false;
+  }
+  I2C1->ICR = I2C_ICR_STOPCF;
+  I2C1->CR2 &= ~(I2C_CR2_SADD | I2C_CR2_HEAD10R | I2C_CR2_NBYTES | I2C_CR2_RELOAD | I2C_CR2_RD_WRN);
+
+  return true;
+}
+
+/**
+ * @brief Register-level memory write
+ * 
+ * Sends the register address followed by the data in one transfer,
+ * reloading NBYTES every 255 bytes.
+ * 
+ * @param p_u16DevAddress the 8-bit device address
+ * @param p_u8MemAddress the register address
+ * @param p_pu8Data the data to write
+ * @param p_u16Size the number of bytes to write
+ * @return false if the transfer failed
+ */
+static bool bI2C_llMemWrite(uint16_t p_u16DevAddress, uint8_t p_u8MemAddress, const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  uint32_t l_u32Start = u32HAL_DWT_getCycles();
+  uint32_t l_u32Remaining = (uint32_t)p_u16Size + 1U;
+  uint32_t l_u32Chunk;
+  bool l_bAddressSent = false;
+
+  while ((I2C1->ISR & I2C_ISR_BUSY) != 0U) {
+    if (bI2C_llExpired(l_u32Start)) {
+      return false;
+    }
+  }
+
+  vI2C_llStartChunk(l_u32Remaining, ((uint32_t)p_u16DevAddress & I2C_CR2_SADD) | I2C_CR2_START);
+  l_u32Chunk = (l_u32Remaining > cI2C_LL_MAX_NBYTES) ? cI2C_LL_MAX_NBYTES : l_u32Remaining;
+
+  while (l_u32Remaining > 0U) {
+    if (!bI2C_llWaitFlag(I2C_ISR_TXIS, l_u32Start)) {
+      vI2C_llAbort();
+      return false;
+    }
+    if (!l_bAddressSent) {
+      I2C1->TXDR = p_u8MemAddress;
+      l_bAddressSent = true;
+    }
+    else {
+      I2C1->TXDR = *p_pu8Data++;
+    }
+    l_u32Remaining--;
+    l_u32Chunk--;
+
+    if (l_u32Chunk == 0U && l_u32Remaining > 0U) {
+      if (!bI2C_llWaitFlag(I2C_ISR_TCR, l_u32Start)) {
+        vI2C_llAbort();
+        return false;
+      }
+      vI2C_llStartChunk(l_u32Remaining, 0);
+      l_u32Chunk = (l_u32Remaining > cI2C_LL_MAX_NBYTES) ? cI2C_LL_MAX_NBYTES : l_u32Remaining;
+    }
+  }
+
+  if (!bI2C_llWaitFlag(I2C_ISR_STOPF, l_u32Start)) {
+    vI2C_llAbort();
+    return false;
+  }
+  I2C1->ICR = I2C_ICR_STOPCF;
+  I2C1->CR2 &= ~(I2C_CR2_SADD | I2C_CR2_HEAD10R | I2C_CR2_NBYTES | I2C_CR2_RELOAD | I2C_CR2_RD_WRN);
+
+  return true;
+}
+
+/**
+ * @brief Ends a failed register-level transfer
+ * 
+ * Sends STOP if the peripheral did not, then clears the error flags and
+ * flushes TXDR so the next transfer starts clean.
+ * 
+ * @return
+ */
+static void vI2C_llAbort(void) {
+  uint32_t l_u32Start = u32HAL_DWT_getCycles();
+
+  if ((I2C1->ISR & I2C_ISR_BUSY) != 0U && (I2C1->ISR & I2C_ISR_STOPF) == 0U) {
+    I2C1->CR2 |= I2C_CR2_STOP;
+  }
+  while ((I2C1->ISR & I2C_ISR_BUSY) != 0U && (I2C1->ISR & I2C_ISR_STOPF) == 0U) {
+    if (bI2C_llExpired(l_u32Start)) {
+      break;
+    }
+  }
+
+  I2C1->ICR = I2C_ICR_STOPCF | I2C_ICR_NACKCF | I2C_ICR_BERRCF | I2C_ICR_ARLOCF;
+  I2C1->ISR |= I2C_ISR_TXE;
+  I2C1->CR2 &= ~(I2C_CR2_SADD | I2C_CR2_HEAD10R | I2C_CR2_NBYTES | I2C_CR2_RELOAD | I2C_CR2_RD_WRN);
+}
+
+/**
+ * @brief Sets the RX stream profile for the coming DMA read
+ * 
+ * @param p_pu8Data the destination buffer
+ * @param p_u16Size the read size
+ * @return
+ */
+static void vI2C_prepareRxDMA(const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  vHAL_DMA_applyProfile(&hdma_i2c1_rx, eHAL_DMA_selectProfile(p_pu8Data, p_u16Size), cHAL_DMA_PRIORITY_I2C_RX, DMA_PBURST_SINGLE);
+}
+
+/**
+ * @brief Waits for the end of a transfer started outside the queue
+ * 
+ * For the measurements run at boot, the queue watchdog does not cover
+ * them. A transfer still running after the watchdog time of its size is
+ * stopped by the recovery of a timed out queued transfer, bus clear
+ * included, pended on I2C1_ER and run as soon as the caller unlocks.
+ * Called from thread mode.
+ * 
+ * @param p_u32Start the cycle count the transfer started at
+ * @param p_u16Size the transfer size
+ * @return false if the transfer failed or timed out
+ */
+static bool bI2C_waitReady(uint32_t p_u32Start, uint16_t p_u16Size) {
+  const uint32_t l_u32Timeout = u32HAL_DWT_usToCycles(cI2C_WATCHDOG_US + cI2C_WATCHDOG_BYTE_US * p_u16Size);
+  uint32_t l_u32Key;
+
+  while (hi2c1.State != HAL_I2C_STATE_READY) {
+    if ((u32HAL_DWT_getCycles() - p_u32Start) > l_u32Timeout) {
+      l_u32Key = u32HAL_Sched_lock(&s_sResource);
+      if (hi2c1.State != HAL_I2C_STATE_READY && !s_bRecoveryPending) {
+        hi2c1.ErrorCode |= HAL_I2C_ERROR_TIMEOUT;
+        hi2c1.State = HAL_I2C_STATE_BUSY;
+        s_bBusClearPending = true;
+        s_bRecoveryPending = true;
+        NVIC_SetPendingIRQ(I2C1_ER_IRQn);
+      }
+      vHAL_Sched_unlock(l_u32Key);
+      return false;
+    }
+  }
+
+  return hi2c1.ErrorCode == HAL_I2C_ERROR_NONE;
+}
+
+/**
+ * @brief Adds the cycles of one measured transfer to a total
+ * 
+ * @param p_u32Total the total so far, UINT32_MAX once a transfer failed
+ * @param p_bSuccess the transfer result
+ * @param p_u32Cycles the cycles of the transfer
+ * @return the new total, UINT32_MAX if a transfer failed
+ */
+static uint32_t u32I2C_benchAdd(uint32_t p_u32Total, bool p_bSuccess, uint32_t p_u32Cycles) {
+  if (!p_bSuccess || p_u32Total == UINT32_MAX || p_u32Cycles >= UINT32_MAX - p_u32Total) {
+    return UINT32_MAX;
+  }
+
+  return p_u32Total + p_u32Cycles;
+}
+
+/**
+ * @brief Dispatches the end of a memory transfer
+ * 
+ * Ends or replays the queued transfer on the bus, then starts the next
+ * queued transfer. Locks hi2c1 so a submission from a more urgent user
+ * cannot start a transfer at the same time.
+ * 
+ * @param p_bSuccess the transfer result
+ * @return
+ */
+static void vI2C_busDone(bool p_bSuccess) {
+  uint32_t l_u32Key;
+
+  vHAL_Trace_transferEnd(ceHAL_TRACE_I2C1, p_bSuccess ? ceHAL_TRACE_OK : ceHAL_TRACE_ERROR);
+  l_u32Key = u32HAL_Sched_lock(&s_sResource);
+  if (s_bQueueOnBus && p_bSuccess) {
+    vI2C_queueComplete(true);
+  }
+  else if (s_bQueueOnBus) {
+    vI2C_queueFail();
+  }
+  vI2C_queueStart();
+  vHAL_Sched_unlock(l_u32Key);
+}
+
+/**
+ * @brief Starts the next queued transfer if the bus is free
+ * 
+ * Called with hi2c1 locked. Waits for the completion of a transfer
+ * started outside the queue, and notifies the transfers the HAL refuses to
+ * start as failed.
+ * 
+ * @return
+ */
+static void vI2C_queueStart(void) {
+  sI2CQueueSlot_t* l_psSlot;
+
+  while (
+    !s_bQueueOnBus &&
+    !s_bRecoveryPending &&
+    s_u32QueueActive != s_u32QueueHead &&
+    hi2c1.State == HAL_I2C_STATE_READY
+  ) {
+    l_psSlot = &s_asQueue[s_u32QueueActive & cI2C_QUEUE_MASK];
+#ifdef I2C_FAULT_INJECTION
+    if (bI2C_injectStart()) {
+      continue;
+    }
+#endif
+    if (bI2C_queueStartTransfer(l_psSlot)) {
+      s_bQueueOnBus = true;
+      (void)bHAL_Timer_start(&s_sWatchdog, cI2C_WATCHDOG_US + cI2C_WATCHDOG_BYTE_US * l_psSlot->s_transfer.u16_size, 0);
+    }
+    else {
+      vI2C_queueComplete(false);
+    }
+  }
+}
+
+/**
+ * @brief Starts one queued transfer with interrupts or DMA
+ * 
+ * Transfers picked for polling use interrupts instead, the queue is driven
+ * from interrupts and must not block. The dispatcher counts the mode
+ * actually used, once per transfer: replays are not counted again.
+ * 
+ * @param p_psSlot the queue slot of the transfer to start
+ * @return false if the HAL refused the transfer
+ */
+static bool bI2C_queueStartTransfer(const sI2CQueueSlot_t* p_psSlot) {
+  const sI2CTransfer_t* l_psTransfer = &p_psSlot->s_transfer;
+  uint16_t l_u16DevAddress = (uint16_t)l_psTransfer->ps_sensor->u8_i2cAddress << 1;
+  uint16_t l_u16MemSize = (uint16_t)l_psTransfer->ps_sensor->u8_i2cRegisterSize;
+  bool l_bDMA = eHAL_Transfer_pick(&s_sDispatch, l_psTransfer->u16_size) == ceHAL_TRANSFER_DMA;
+  eHAL_TransferMode_t l_eMode = l_bDMA ? ceHAL_TRANSFER_DMA : ceHAL_TRANSFER_IT;
+  HAL_StatusTypeDef l_eStatus;
+
+  if (l_psTransfer->b_read && l_bDMA) {
+    vI2C_prepareRxDMA(l_psTransfer->pu8_data, l_psTransfer->u16_size);
+    l_eStatus = HAL_I2C_Mem_Read_DMA(&hi2c1, l_u16DevAddress, l_psTransfer->u8_register, l_u16MemSize,
+                                     l_psTransfer->pu8_data, l_psTransfer->u16_size);
+  }
+  else if (l_psTransfer->b_read) {
+    l_eStatus = HAL_I2C_Mem_Read_IT(&hi2c1, l_u16DevAddress, l_psTransfer->u8_register, l_u16MemSize,
+                                    l_psTransfer->pu8_data, l_psTransfer->u16_size);
+  }
+  else if (l_bDMA) {
+    l_eStatus = HAL_I2C_Mem_Write_DMA(&hi2c1, l_u16DevAddress, l_psTransfer->u8_register, l_u16MemSize,
+                                      l_psTransfer->pu8_data, l_psTransfer->u16_size);
+  }
+  else {
+    l_eStatus = HAL_I2C_Mem_Write_IT(&hi2c1, l_u16DevAddress, l_psTransfer->u8_register, l_u16MemSize,
+                                     l_psTransfer->pu8_data, l_psTransfer->u16_size);
+  }
+
+  if (l_eStatus == HAL_OK) {
+    vHAL_Trace_transferBegin(ceHAL_TRACE_I2C1, l_psTransfer->ps_sensor->u8_i2cAddress, l_psTransfer->u8_register,
+                             l_psTransfer->b_read, l_psTransfer->u16_size, l_eMode);
+    if (p_psSlot->u8_retries == 0U) {
+      vHAL_Transfer_count(&s_sDispatch, l_eMode, l_psTransfer->u16_size);
+    }
+  }
+
+  return l_eStatus == HAL_OK;
+}
+
+/**
+ * @brief Ends the transfer at the active index and schedules its notification
+ * 
+ * @param p_bSuccess the transfer result
+ * @return
+ */
+static void vI2C_queueComplete(bool p_bSuccess) {
+  vHAL_Timer_stop(&s_sWatchdog);
+  s_bQueueTimeout = false;
+  s_asQueue[s_u32QueueActive & cI2C_QUEUE_MASK].b_success = p_bSuccess;
+  s_bQueueOnBus = false;
+  s_u32QueueActive++;
+
+  if (!s_bQueueDrainPosted) {
+    s_bQueueDrainPosted = bHAL_Defer_post(vI2C_queueDrain);
+  }
+}
+
+/**
+ * @brief Notifies the ended transfers in submission order
+ * 
+ * Deferred to PendSV. A slot is released once its callback returned, so
+ * the callback can still read the transfer buffer and submit the next one.
+ * 
+ * @return
+ */
+static void vI2C_queueDrain(void) {
+  sI2CQueueSlot_t* l_psSlot;
+
+  s_bQueueDrainPosted = false;
+
+  while (s_u32QueueTail != s_u32QueueActive) {
+    l_psSlot = &s_asQueue[s_u32QueueTail & cI2C_QUEUE_MASK];
+    if (l_psSlot->s_transfer.pf_done != NULL) {
+      l_psSlot->s_transfer.pf_done(l_psSlot->s_transfer.pv_arg, l_psSlot->b_success);
+    }
+    s_u32QueueTail++;
+  }
+}
+
+/**
+ * @brief Handles a failed or timed out queued transfer
+ * 
+ * Called with hi2c1 locked. The transfer stays at the active index to
+ * be replayed, up to cI2C_RETRY_MAX times, then is notified as failed.
+ * Either way hi2c1 is held busy and the recovery is pended on I2C1_ER,
+ * the next start happens once the peripheral is usable again. Only an
+ * arbitration loss or a timeout asks for the bus clear, a NACK or a DMA
+ * error left the bus idle.
+ * 
+ * @return
+ */
+static void vI2C_queueFail(void) {
+  sI2CQueueSlot_t* l_psSlot = &s_asQueue[s_u32QueueActive & cI2C_QUEUE_MASK];
+
+  s_sRecoveryStats.u32_errors++;
+
+  if (l_psSlot->u8_retries < cI2C_RETRY_MAX) {
+    vHAL_Timer_stop(&s_sWatchdog);
+    s_bQueueTimeout = false;
+    s_bQueueOnBus = false;
+    l_psSlot->u8_retries++;
+    s_sRecoveryStats.u32_retries++;
+  }
+  else {
+    s_sRecoveryStats.u32_abandoned++;
+    vI2C_queueComplete(false);
+  }
+
+  if ((hi2c1.ErrorCode & cI2C_BUS_ERRORS) != 0U) {
+    s_bBusClearPending = true;
+  }
+  hi2c1.State = HAL_I2C_STATE_BUSY;
+  s_bRecoveryPending = true;
+  NVIC_SetPendingIRQ(I2C1_ER_IRQn);
+}
+
+/**
+ * @brief Flags the transfer on the bus as timed out
+ * 
+ * Called from the timer service interrupt, the abort and recovery run at
+ * the bus error priority.
+ * 
+ * @param p_pvArg unused
+ * @return
+ */
+static void vI2C_watchdog(void* p_pvArg) {
+  (void)p_pvArg;
+
+  s_bQueueTimeout = true;
+  NVIC_SetPendingIRQ(I2C1_ER_IRQn);
+}
+
+/**
+ * @brief Aborts a timed out transfer and recovers the bus if needed
+ * 
+ * Called from I2C1_ER_IRQHandler. The transfer is stopped with hi2c1
+ * locked so no bus interrupt touches it afterwards. A failure that left
+ * the bus idle only resets the peripheral state machine. The bus clear and
+ * the RCC reset run after an arbitration loss or a timeout, or with SDA
+ * held low, unlocked while hi2c1 is held busy.
+ * 
+ * @return
+ */
+static void vI2C_serviceRecovery(void) {
+  uint32_t l_u32Key;
+  bool l_bRecover;
+  bool l_bBusClear;
+
+  l_u32Key = u32HAL_Sched_lock(&s_sResource);
+  if (s_bQueueTimeout) {
+    s_bQueueTimeout = false;
+    if (s_bQueueOnBus) {
+      hi2c1.ErrorCode |= HAL_I2C_ERROR_TIMEOUT;
+      vHAL_Trace_transferEnd(ceHAL_TRACE_I2C1, ceHAL_TRACE_TIMEOUT);
+      vI2C_queueFail();
+    }
+  }
+
+  l_bRecover = s_bRecoveryPending;
+  if (l_bRecover) {
+    __HAL_I2C_DISABLE(&hi2c1);
+    hi2c1.XferISR = NULL;
+    if (hdma_i2c1_tx.State == HAL_DMA_STATE_BUSY) {
+      (void)HAL_DMA_Abort(&hdma_i2c1_tx);
+    }
+    if (hdma_i2c1_rx.State == HAL_DMA_STATE_BUSY) {
+      (void)HAL_DMA_Abort(&hdma_i2c1_rx);
+    }
+    NVIC_ClearPendingIRQ(I2C1_EV_IRQn);
+  }
+  l_bBusClear = s_bBusClearPending;
+  s_bBusClearPending = false;
+  vHAL_Sched_unlock(l_u32Key);
+
+  if (!l_bRecover) {
+    return;
+  }
+
+  if (l_bBusClear || HAL_GPIO_ReadPin(GPIOB, cI2C_SDA_PIN) == GPIO_PIN_RESET) {
+    vI2C_recoverBus();
+  }
+  else {
+    vI2C_resetPeripheral();
+  }
+
+  l_u32Key = u32HAL_Sched_lock(&s_sResource);
+  s_bRecoveryPending = false;
+  vI2C_queueStart();
+  vHAL_Sched_unlock(l_u32Key);
+}
+
+/**
+ * @brief Frees the bus and resets the peripheral
+ * 
+ * Drives SCL and SDA as open-drain GPIOs, clocks SCL until the slave
+ * holding SDA low releases it, at most cI2C_RECOVERY_CLOCKS times, sends a
+ * STOP, then gives the pins back to I2C1 and resets it through RCC. Takes
+ * a few us with SDA released, about 100 us for a full bus clear.
+ * 
+ * @return
+ */
+static void vI2C_recoverBus(void) {
+  GPIO_InitTypeDef l_sGPIO = {0};
+  uint32_t l_u32Start = u32HAL_DWT_getCycles();
+  uint32_t l_u32Cycles;
+  uint32_t i;
+
+  HAL_GPIO_WritePin(GPIOB, cI2C_SCL_PIN | cI2C_SDA_PIN, GPIO_PIN_SET);
+  l_sGPIO.Pin = cI2C_SCL_PIN | cI2C_SDA_PIN;
+  l_sGPIO.Mode = GPIO_MODE_OUTPUT_OD;
+  l_sGPIO.Pull = GPIO_PULLUP;
+  l_sGPIO.Speed = GPIO_SPEED_FREQ_VERY_HIGH;
+  HAL_GPIO_Init(GPIOB, &l_sGPIO);
+
+  if (HAL_GPIO_ReadPin(GPIOB, cI2C_SDA_PIN) == GPIO_PIN_RESET) {
+    s_sRecoveryStats.u32_bus_clears++;
+    for (i = 0; i < cI2C_RECOVERY_CLOCKS && HAL_GPIO_ReadPin(GPIOB, cI2C_SDA_PIN) == GPIO_PIN_RESET; i++) {
+      HAL_GPIO_WritePin(GPIOB, cI2C_SCL_PIN, GPIO_PIN_RESET);
+      vI2C_waitUs(cI2C_RECOVERY_HALF_US);
+      HAL_GPIO_WritePin(GPIOB, cI2C_SCL_PIN, GPIO_PIN_SET);
+      vI2C_waitUs(cI2C_RECOVERY_HALF_US);
+    }
+  }
+
+  /* STOP, SDA rises while SCL is high */
+  HAL_GPIO_WritePin(GPIOB, cI2C_SCL_PIN, GPIO_PIN_RESET);
+  HAL_GPIO_WritePin(GPIOB, cI2C_SDA_PIN, GPIO_PIN_RESET);
+  vI2C_waitUs(cI2C_RECOVERY_HALF_US);
+  HAL_GPIO_WritePin(GPIOB, cI2C_SCL_PIN, GPIO_PIN_SET);
+  vI2C_waitUs(cI2C_RECOVERY_HALF_US);
+  HAL_GPIO_WritePin(GPIOB, cI2C_SDA_PIN, GPIO_PIN_SET);
+  vI2C_waitUs(cI2C_RECOVERY_HALF_US);
+
+  if (HAL_GPIO_ReadPin(GPIOB, cI2C_SDA_PIN) == GPIO_PIN_RESET) {
+    s_sRecoveryStats.u32_stuck++;
+  }
+
+  l_sGPIO.Mode = GPIO_MODE_AF_OD;
+  l_sGPIO.Alternate = GPIO_AF4_I2C1;
+  HAL_GPIO_Init(GPIOB, &l_sGPIO);
+
+  /* hi2c1 is not in reset state, HAL_I2C_Init skips the MSP init */
+  __HAL_RCC_I2C1_FORCE_RESET();
+  __HAL_RCC_I2C1_RELEASE_RESET();
+  vI2C_configure();
+
+  l_u32Cycles = u32HAL_DWT_getCycles() - l_u32Start;
+  s_sRecoveryStats.u32_recoveries++;
+  s_sRecoveryStats.u32_last_cycles = l_u32Cycles;
+  if (l_u32Cycles > s_sRecoveryStats.u32_max_cycles) {
+    s_sRecoveryStats.u32_max_cycles = l_u32Cycles;
+  }
+}
+
+/**
+ * @brief Resets the peripheral state machine, the bus being idle
+ * 
+ * PE is already cleared by vI2C_serviceRecovery, it must read back low
+ * before being set again. Clears the flags and the HAL error, the
+ * configuration and the pins are kept.
+ * 
+ * @return
+ */
+static void vI2C_resetPeripheral(void) {
+  __HAL_I2C_DISABLE(&hi2c1);
+  while ((I2C1->CR1 & I2C_CR1_PE) != 0U) {}
+  __HAL_I2C_ENABLE(&hi2c1);
+
+  hi2c1.ErrorCode = HAL_I2C_ERROR_NONE;
+  hi2c1.Mode = HAL_I2C_MODE_NONE;
+  hi2c1.State = HAL_I2C_STATE_READY;
+  s_sRecoveryStats.u32_soft_resets++;
+}
+
+/**
+ * @brief Configures hi2c1 and its filters
+ * 
+ * Runs the MSP init on the first call only.
+ * 
+ * @return
+ */
+static void vI2C_configure(void) {
+  hi2c1.Instance = I2C1;
+  hi2c1.Init.Timing = 0x00707CBB;
+  hi2c1.Init.OwnAddress1 = 0;
+  hi2c1.Init.AddressingMode = I2C_ADDRESSINGMODE_7BIT;
+  hi2c1.Init.DualAddressMode = I2C_DUALADDRESS_DISABLE;
+  hi2c1.Init.OwnAddress2 = 0;
+  hi2c1.Init.OwnAddress2Masks = I2C_OA2_NOMASK;
+  hi2c1.Init.GeneralCallMode = I2C_GENERALCALL_DISABLE;
+  hi2c1.Init.NoStretchMode = I2C_NOSTRETCH_DISABLE;
+
+  HAL_I2C_Init(&hi2c1);
+  HAL_I2CEx_ConfigAnalogFilter(&hi2c1, I2C_ANALOGFILTER_ENABLE);
+  HAL_I2CEx_ConfigDigitalFilter(&hi2c1, 0);
+}
+
+/**
+ * @brief Busy-waits on the timer service counter
+ * 
+ * Usable from interrupts, for the few us of the bus clear only.
+ * 
+ * @param p_u32DelayUs the delay in us
+ * @return
+ */
+static void vI2C_waitUs(uint32_t p_u32DelayUs) {
+  uint32_t l_u32Start = u32HAL_Timer_now();
+
+  while (u32HAL_Timer_now() - l_u32Start < p_u32DelayUs) {}
+}
+
+#ifdef I2C_FAULT_INJECTION
+/**
+ * @brief Replaces the start of the active transfer by the injected fault
+ * 
+ * Called with hi2c1 locked from vI2C_queueStart.
+ * 
+ * @return true if a fault was injected instead of starting the transfer
+ */
+static bool bI2C_injectStart(void) {
+  if (s_u32FaultCount == 0) {
+    return false;
+  }
+
+  s_u32FaultCount--;
+  s_bQueueOnBus = true;
+
+  switch (s_eFault) {
+    case ceI2C_FAULT_NACK:
+      hi2c1.ErrorCode = HAL_I2C_ERROR_AF;
+      vI2C_queueFail();
+      break;
+    case ceI2C_FAULT_ARB_LOST:
+      hi2c1.ErrorCode = HAL_I2C_ERROR_ARLO;
+      vI2C_queueFail();
+      break;
+    default:
+      /* Nothing completes, the watchdog aborts it */
+      hi2c1.State = HAL_I2C_STATE_BUSY;
+      (void)bHAL_Timer_start(&s_sWatchdog, cI2C_WATCHDOG_US, 0);
+      break;
+  }
+
+  return true;
+}
+#endif
@@ -0,0 +1,248 @@
+/**
+  ******************************************************************************
+  * @file           : hal_nvic.c
+  * @brief          : Interrupt priority map applied to every peripheral
+  * interrupt, and ISR entry latency measurement
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/28
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "hal/hal_dwt.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "hal/hal_nvic.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef struct {
+  IRQn_Type e_irq;
+  uint32_t u32_preempt;
+} sHAL_NVICMapEntry_t;
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+/* The only place interrupt priorities are set, see hal_nvic.h for the levels */
+static const sHAL_NVICMapEntry_t s_asPriorityMap[cHAL_NVIC_MAP_SIZE] = {
+  {TIM2_IRQn,          cHAL_NVIC_PRIO_SENSOR},    //Forced mode trigger and read
+  {TIM5_IRQn,          cHAL_NVIC_PRIO_SENSOR},    //Timer service deadlines
+  {DMA1_Stream1_IRQn,  cHAL_NVIC_PRIO_DMA_RX},    //I2C1 RX
+#ifndef BMP581_NO_SPI
+  {DMA1_Stream3_IRQn,  cHAL_NVIC_PRIO_DMA_RX},    //SPI1 RX
+#endif
+  {DMA1_Stream0_IRQn,  cHAL_NVIC_PRIO_DMA_TX},    //I2C1 TX
+#ifndef BMP581_NO_SPI
+  {DMA1_Stream2_IRQn,  cHAL_NVIC_PRIO_DMA_TX},    //SPI1 TX
+#endif
+  {I2C1_EV_IRQn,       cHAL_NVIC_PRIO_BUS_EVENT},
+#ifndef BMP581_NO_SPI
+  {SPI1_IRQn,          cHAL_NVIC_PRIO_BUS_EVENT},
+#endif
+  {I2C1_ER_IRQn,       cHAL_NVIC_PRIO_BUS_ERROR}
+};
+
+#ifdef HAL_NVIC_LATENCY_MEASURE
+static volatile uint32_t s_au32PendCycles[cHAL_NVIC_MAP_SIZE];
+static volatile bool s_abArmed[cHAL_NVIC_MAP_SIZE];
+static volatile uint32_t s_au32MaxCycles[cHAL_NVIC_MAP_SIZE];
+static volatile uint32_t s_au32Samples[cHAL_NVIC_MAP_SIZE];
+static uint32_t s_u32ProbeSlot = 0;
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static int32_t s32HAL_NVIC_findSlot(IRQn_Type p_eIRQn);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Init function for the interrupt priorities
+ * 
+ * Sets the priority grouping and the priority of every mapped interrupt,
+ * without enabling them. Must be called after HAL_Init and before any
+ * peripheral init.
+ * 
+ * @return
+ */
+void vHAL_NVIC_init(void) {
+  uint32_t i;
+
+  HAL_NVIC_SetPriorityGrouping(cHAL_NVIC_GROUPING);
+  HAL_NVIC_SetPriority(SysTick_IRQn, cHAL_NVIC_PRIO_TICK, 0);
+  HAL_NVIC_SetPriority(PendSV_IRQn, cHAL_NVIC_PRIO_DEFERRED, 0);
+
+  for (i = 0; i < cHAL_NVIC_MAP_SIZE; i++) {
+    HAL_NVIC_SetPriority(s_asPriorityMap[i].e_irq, s_asPriorityMap[i].u32_preempt, 0);
+  }
+}
+
+/**
+ * @brief Enables an interrupt at its mapped priority
+ * 
+ * Interrupts missing from the map get the tick priority, the lowest level.
+ * 
+ * @param p_eIRQn the interrupt to enable
+ * @return
+ */
+void vHAL_NVIC_enable(IRQn_Type p_eIRQn) {
+  HAL_NVIC_SetPriority(p_eIRQn, u32HAL_NVIC_getPriority(p_eIRQn), 0);
+  HAL_NVIC_EnableIRQ(p_eIRQn);
+}
+
+/**
+ * @brief Disables an interrupt
+ * 
+ * @param p_eIRQn the interrupt to disable
+ * @return
+ */
+void vHAL_NVIC_disable(IRQn_Type p_eIRQn) {
+  HAL_NVIC_DisableIRQ(p_eIRQn);
+}
+
+/**
+ * @brief Gives the mapped preemption priority of an interrupt
+ * 
+ * @param p_eIRQn the interrupt
+ * @return the preemption priority
+ */
+uint32_t u32HAL_NVIC_getPriority(IRQn_Type p_eIRQn) {
+  int32_t l_s32Slot = s32HAL_NVIC_findSlot(p_eIRQn);
+
+  if (l_s32Slot < 0) {
+    return cHAL_NVIC_PRIO_TICK;
+  }
+
+  return s_asPriorityMap[l_s32Slot].u32_preempt;
+}
+
+#ifdef HAL_NVIC_LATENCY_MEASURE
+/**
+ * @brief Records the entry latency of a probed interrupt
+ * 
+ * Called through vHAL_NVIC_latencyEntry at the start of each mapped
+ * handler. Only entries following a probe are measured, since the pend
+ * time of a hardware request is unknown.
+ * 
+ * @param p_eIRQn the interrupt being handled
+ * @return
+ */
+void vHAL_NVIC_recordEntry(IRQn_Type p_eIRQn) {
+  uint32_t l_u32Now = u32HAL_DWT_getCycles();
+  uint32_t l_u32Latency;
+  int32_t l_s32Slot = s32HAL_NVIC_findSlot(p_eIRQn);
+
+  if (l_s32Slot < 0 || !s_abArmed[l_s32Slot]) {
+    return;
+  }
+
+  s_abArmed[l_s32Slot] = false;
+  l_u32Latency = l_u32Now - s_au32PendCycles[l_s32Slot];
+  if (l_u32Latency > s_au32MaxCycles[l_s32Slot]) {
+    s_au32MaxCycles[l_s32Slot] = l_u32Latency;
+  }
+  s_au32Samples[l_s32Slot]++;
+}
+
+/**
+ * @brief Pends the next mapped interrupt and stamps the pend time
+ * 
+ * Walks the map round robin, one interrupt per call, skipping disabled,
+ * pending or active ones. Called periodically from SysTick so the
+ * latencies include the preemption by the real workload. The handlers
+ * find no peripheral flag set and return.
+ * 
+ * @return
+ */
+void vHAL_NVIC_probeNext(void) {
+  IRQn_Type l_eIRQn = s_asPriorityMap[s_u32ProbeSlot].e_irq;
+  uint32_t l_u32Primask;
+
+  if (
+    NVIC_GetEnableIRQ(l_eIRQn) != 0 &&
+    NVIC_GetPendingIRQ(l_eIRQn) == 0 &&
+    NVIC_GetActive(l_eIRQn) == 0
+  ) {
+    l_u32Primask = __get_PRIMASK();
+    __disable_irq();
+    s_abArmed[s_u32ProbeSlot] = true;
+    s_au32PendCycles[s_u32ProbeSlot] = u32HAL_DWT_getCycles();
+    NVIC_SetPendingIRQ(l_eIRQn);
+    __set_PRIMASK(l_u32Primask);
+  }
+
+  s_u32ProbeSlot = (s_u32ProbeSlot + 1) % cHAL_NVIC_MAP_SIZE;
+}
+
+/**
+ * @brief Clears the recorded latencies
+ * 
+ * @return
+ */
+void vHAL_NVIC_resetLatency(void) {
+  uint32_t i;
+
+  for (i = 0; i < cHAL_NVIC_MAP_SIZE; i++) {
+    s_abArmed[i] = false;
+    s_au32MaxCycles[i] = 0;
+    s_au32Samples[i] = 0;
+  }
+}
+#endif
+
+/**
+ * @brief Gives the worst-case entry latency of each mapped interrupt
+ * 
+ * Latencies stay at 0 unless built with HAL_NVIC_LATENCY_MEASURE.
+ * 
+ * @param p_psLatency the results, one per mapped interrupt
+ * @param p_u32Max the number of entries of p_psLatency
+ * @return the number of entries written
+ */
+uint32_t u32HAL_NVIC_getLatency(sHAL_NVICLatency_t* p_psLatency, uint32_t p_u32Max) {
+  uint32_t i;
+
+  if (p_psLatency == NULL) {
+    return 0;
+  }
+
+  for (i = 0; i < cHAL_NVIC_MAP_SIZE && i < p_u32Max; i++) {
+    p_psLatency[i].e_irq = s_asPriorityMap[i].e_irq;
+    p_psLatency[i].u32_preempt = s_asPriorityMap[i].u32_preempt;
+#ifdef HAL_NVIC_LATENCY_MEASURE
+    p_psLatency[i].u32_max_cycles = s_au32MaxCycles[i];
+    p_psLatency[i].u32_samples = s_au32Samples[i];
+#else
+    p_psLatency[i].u32_max_cycles = 0;
+    p_psLatency[i].u32_samples = 0;
+#endif
+  }
+
+  return i;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Finds the map entry of an interrupt
+ * 
+ * @param p_eIRQn the interrupt
+ * @return the index in s_asPriorityMap, -1 if not mapped
+ */
+static int32_t s32HAL_NVIC_findSlot(IRQn_Type p_eIRQn) {
+  int32_t i;
+
+  for (i = 0; i < cHAL_NVIC_MAP_SIZE; i++) {
+    if (s_asPriorityMap[i].e_irq == p_eIRQn) {
+      return i;
+    }
+  }
+
+  return -1;
+}
@@ -0,0 +1,246 @@
+/**
+  ******************************************************************************
+  * @file           : hal_sched.c
+  * @brief          : Run-to-completion task scheduler, each task owns an
+  * NVIC vector left unused by the board and runs as its handler, the NVIC
+  * does the preemption on a single stack
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/31
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stddef.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "hal/hal_nvic.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "hal/hal_sched.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cHAL_SCHED_BASEPRI_SHIFT (8U - __NVIC_PRIO_BITS)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+/* Vectors of peripherals the board does not use, by increasing number
+ * since the NVIC breaks priority ties on the lowest one */
+static const IRQn_Type s_aeTaskIRQn[ceHAL_SCHED_TASK_NB] = {
+  SAI4_IRQn,
+  OCTOSPI2_IRQn,
+  FMAC_IRQn,
+  CORDIC_IRQn
+};
+
+static pfHAL_SchedTask_t s_apfTasks[ceHAL_SCHED_TASK_NB];
+static uint32_t s_au32Priority[ceHAL_SCHED_TASK_NB];
+static volatile uint32_t s_au32Activations[ceHAL_SCHED_TASK_NB];
+static volatile uint32_t s_au32Runs[ceHAL_SCHED_TASK_NB];
+
+/* Private function prototypes -----------------------------------------------*/
+static void vHAL_Sched_dispatch(eHAL_SchedTask_t p_eTask);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Init function for the scheduler
+ * 
+ * Removes every task and disables their vectors.
+ * 
+ * @return
+ */
+void vHAL_Sched_init(void) {
+  uint32_t i;
+
+  for (i = 0; i < ceHAL_SCHED_TASK_NB; i++) {
+    HAL_NVIC_DisableIRQ(s_aeTaskIRQn[i]);
+    HAL_NVIC_ClearPendingIRQ(s_aeTaskIRQn[i]);
+    s_apfTasks[i] = NULL;
+    s_au32Priority[i] = cHAL_NVIC_PRIO_TASK_LAST;
+    s_au32Activations[i] = 0;
+    s_au32Runs[i] = 0;
+  }
+}
+
+/**
+ * @brief Installs a task on its vector
+ * 
+ * Tasks of equal priority never preempt each other, the lower task number
+ * runs first. Tasks run to completion and must not wait for each other.
+ * 
+ * @param p_eTask the task slot
+ * @param p_pfTask the task body
+ * @param p_u32Priority the NVIC preemption level, from
+ * cHAL_NVIC_PRIO_TASK_FIRST (most urgent) to cHAL_NVIC_PRIO_TASK_LAST
+ * @return false if a parameter is out of range
+ */
+bool bHAL_Sched_setTask(eHAL_SchedTask_t p_eTask, pfHAL_SchedTask_t p_pfTask, uint32_t p_u32Priority) {
+  if (
+    p_eTask >= ceHAL_SCHED_TASK_NB ||
+    p_pfTask == NULL ||
+    p_u32Priority < cHAL_NVIC_PRIO_TASK_FIRST ||
+    p_u32Priority > cHAL_NVIC_PRIO_TASK_LAST
+  ) {
+    return false;
+  }
+
+  HAL_NVIC_DisableIRQ(s_aeTaskIRQn[p_eTask]);
+  s_apfTasks[p_eTask] = p_pfTask;
+  s_au32Priority[p_eTask] = p_u32Priority;
+  HAL_NVIC_SetPriority(s_aeTaskIRQn[p_eTask], p_u32Priority, 0);
+  HAL_NVIC_EnableIRQ(s_aeTaskIRQn[p_eTask]);
+
+  return true;
+}
+
+/**
+ * @brief Requests a run of a task
+ * 
+ * Safe from any context. The task runs as soon as no more urgent
+ * interrupt or task is active, right away if the caller is less urgent.
+ * Each activation gives one run.
+ * 
+ * @param p_eTask the task to activate
+ * @return
+ */
+void vHAL_Sched_activate(eHAL_SchedTask_t p_eTask) {
+  uint32_t l_u32Primask;
+
+  if (p_eTask >= ceHAL_SCHED_TASK_NB || s_apfTasks[p_eTask] == NULL) {
+    return;
+  }
+
+  l_u32Primask = __get_PRIMASK();
+  __disable_irq();
+  s_au32Activations[p_eTask]++;
+  __set_PRIMASK(l_u32Primask);
+
+  NVIC_SetPendingIRQ(s_aeTaskIRQn[p_eTask]);
+}
+
+/**
+ * @brief Initialises a resource with no user
+ * 
+ * @param p_psResource the resource
+ * @return
+ */
+void vHAL_Sched_initResource(sHAL_SchedResource_t* p_psResource) {
+  if (p_psResource != NULL) {
+    p_psResource->u32_ceiling = cHAL_SCHED_NO_CEILING;
+  }
+}
+
+/**
+ * @brief Declares an interrupt or task priority using a resource
+ * 
+ * Lowers the ceiling to the priority if it is more urgent. A user more
+ * urgent than the current ceiling must be declared before the resource is
+ * first locked. Level 0 cannot be masked by BASEPRI, so level 0 users are
+ * not allowed.
+ * 
+ * @param p_psResource the resource
+ * @param p_u32Priority the NVIC preemption level of the user
+ * @return
+ */
+void vHAL_Sched_addUser(sHAL_SchedResource_t* p_psResource, uint32_t p_u32Priority) {
+  if (p_psResource != NULL && p_u32Priority > 0 && p_u32Priority < p_psResource->u32_ceiling) {
+    p_psResource->u32_ceiling = p_u32Priority;
+  }
+}
+
+/**
+ * @brief Declares a task using a resource
+ * 
+ * @param p_psResource the resource
+ * @param p_eTask the task, installed with its final priority
+ * @return
+ */
+void vHAL_Sched_addTaskUser(sHAL_SchedResource_t* p_psResource, eHAL_SchedTask_t p_eTask) {
+  if (p_eTask < ceHAL_SCHED_TASK_NB) {
+    vHAL_Sched_addUser(p_psResource, s_au32Priority[p_eTask]);
+  }
+}
+
+/**
+ * @brief Locks a resource by raising BASEPRI to its ceiling
+ * 
+ * Every user of the resource is masked until the unlock, more urgent
+ * interrupts still run. Locks nest, BASEPRI is only ever raised. Once the
+ * owner holds it, no other user can be waiting for it, so tasks and
+ * interrupts sharing resources cannot deadlock.
+ * 
+ * @param p_psResource the resource
+ * @return the key to give to vHAL_Sched_unlock
+ */
+uint32_t u32HAL_Sched_lock(const sHAL_SchedResource_t* p_psResource) {
+  uint32_t l_u32Key = __get_BASEPRI();
+
+  if (p_psResource != NULL && p_psResource->u32_ceiling != cHAL_SCHED_NO_CEILING) {
+    __set_BASEPRI_MAX(p_psResource->u32_ceiling << cHAL_SCHED_BASEPRI_SHIFT);
+  }
+
+  return l_u32Key;
+}
+
+/**
+ * @brief Unlocks a resource, restoring the BASEPRI of the lock
+ * 
+ * @param p_u32Key the value returned by the matching lock
+ * @return
+ */
+void vHAL_Sched_unlock(uint32_t p_u32Key) {
+  __set_BASEPRI(p_u32Key);
+}
+
+/**
+ * @brief Gives the activation and run counts of a task
+ * 
+ * @param p_eTask the task
+ * @param p_psStats the statistics
+ * @return
+ */
+void vHAL_Sched_getStats(eHAL_SchedTask_t p_eTask, sHAL_SchedTaskStats_t* p_psStats) {
+  if (p_eTask < ceHAL_SCHED_TASK_NB && p_psStats != NULL) {
+    p_psStats->u32_priority = s_au32Priority[p_eTask];
+    p_psStats->u32_activations = s_au32Activations[p_eTask];
+    p_psStats->u32_runs = s_au32Runs[p_eTask];
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Runs a task once per pending activation
+ * 
+ * Activations during the run pend the vector again, the loop catches them
+ * without an extra exception entry.
+ * 
+ * @param p_eTask the task
+ * @return
+ */
+static void vHAL_Sched_dispatch(eHAL_SchedTask_t p_eTask) {
+  while (s_au32Runs[p_eTask] != s_au32Activations[p_eTask]) {
+    s_au32Runs[p_eTask]++;
+    s_apfTasks[p_eTask]();
+  }
+}
+
+void SAI4_IRQHandler(void) {
+  vHAL_Sched_dispatch(ceHAL_SCHED_TASK_0);
+}
+
+void OCTOSPI2_IRQHandler(void) {
+  vHAL_Sched_dispatch(ceHAL_SCHED_TASK_1);
+}
+
+void FMAC_IRQHandler(void) {
+  vHAL_Sched_dispatch(ceHAL_SCHED_TASK_2);
+}
+
+void CORDIC_IRQHandler(void) {
+  vHAL_Sched_dispatch(ceHAL_SCHED_TASK_3);
+}
@@ -11,7 +11,13 @@
 /* General interfaces --------------------------------------------------------*/
 
 /* Used interfaces (dependencies includes) -----------------------------------*/
+#include <stddef.h>
 #include "stm32h7xx_hal.h"
+#include "hal/hal_dwt.h"
+#include "hal/hal_dma.h"
+#include "hal/hal_nvic.h"
+#include "hal/hal_defer.h"
+#include "hal/hal_trace.h"
 
 /* Associated interfaces -----------------------------------------------------*/
 #include "hal/hal_spi.h"
@@ -19,6 +25,10 @@
 /* Private typedef -----------------------------------------------------------*/
 
 /* Private define ------------------------------------------------------------*/
+#define cSPI_TIMEOUT_MS  1000
+#define cSPI_BENCH_MAX_SIZE 128
+#define cSPI_BENCH_REPS   16
+#define cSPI_WAIT_US      (uint32_t)10000 //Boot time measurement transfers, far above cSPI_BENCH_MAX_SIZE bytes
 
 /* Private macro -------------------------------------------------------------*/
 
@@ -27,7 +37,19 @@ SPI_HandleTypeDef hspi1;
 DMA_HandleTypeDef hdma_spi1_tx;
 DMA_HandleTypeDef hdma_spi1_rx;
 
+static sHAL_TransferDispatch_t s_sDispatch;
+static pfSPI_Callback_t s_pfTxRxCplt = NULL;
+static pfSPI_Callback_t s_pfError = NULL;
+static volatile uint32_t s_u32IsrCycles = 0; //CPU cycles spent in SPI and SPI DMA interrupts
+static uint8_t s_au8CalTx[cSPI_BENCH_MAX_SIZE] __attribute__((aligned(cHAL_DMA_BURST_BYTES)));
+static uint8_t s_au8CalRx[cSPI_BENCH_MAX_SIZE] __attribute__((aligned(cHAL_DMA_BURST_BYTES)));
+static const uint16_t s_au16DMABenchSizes[cSPI_DMA_BENCH_SIZE_NB] = {16, 32, 64, cSPI_BENCH_MAX_SIZE};
+static sHAL_DMABenchmark_t s_asDMABenchmark[cSPI_DMA_BENCH_SIZE_NB];
+
 /* Private function prototypes -----------------------------------------------*/
+static void vSPI_applyProfile(eHAL_DMAProfile_t p_eProfile);
+static bool bSPI_waitReady(uint32_t p_u32Start);
+static inline void vSPI_traceBegin(uint8_t p_u8Address, uint16_t p_u16Size, eHAL_TransferMode_t p_eMode);
 
 /* Public functions ----------------------------------------------------------*/
 /* SPI1 init function */
@@ -36,7 +58,7 @@ void vSPI_init(void)
   hspi1.Instance = SPI1;
   hspi1.Init.Mode = SPI_MODE_MASTER;
   hspi1.Init.Direction = SPI_DIRECTION_2LINES;
-  hspi1.Init.DataSize = SPI_DATASIZE_4BIT;
+  hspi1.Init.DataSize = SPI_DATASIZE_8BIT;
   hspi1.Init.CLKPolarity = SPI_POLARITY_LOW;
   hspi1.Init.CLKPhase = SPI_PHASE_1EDGE;
   hspi1.Init.NSS = SPI_NSS_SOFT;
@@ -57,6 +79,257 @@ void vSPI_init(void)
   hspi1.Init.IOSwap = SPI_IO_SWAP_DISABLE;
   HAL_SPI_Init(&hspi1);
 
+  vHAL_Transfer_init(&s_sDispatch);
+}
+
+/**
+ * @brief Sets the functions called when an asynchronous transfer ends
+ * 
+ * The callbacks are deferred to PendSV when an interrupt or DMA transfer
+ * ends, or run from the caller context for a polled transfer.
+ * 
+ * @param p_pfTxRxCplt called when the transfer completes, can be NULL
+ * @param p_pfError called when the transfer fails, can be NULL
+ * @return
+ */
+void vSPI_setCallbacks(pfSPI_Callback_t p_pfTxRxCplt, pfSPI_Callback_t p_pfError) {
+  s_pfTxRxCplt = p_pfTxRxCplt;
+  s_pfError = p_pfError;
+}
+
+/**
+ * @brief Full duplex transfer with the cheapest transfer mode
+ * 
+ * Polls, uses interrupts or DMA depending on the size and the calibrated
+ * thresholds. Both buffers must stay valid until the transfer complete
+ * callback. The chip select is left to the caller.
+ * 
+ * @param p_pu8TxData the data to send
+ * @param p_pu8RxData the received data
+ * @param p_u16Size the number of bytes to exchange
+ * @return false if the transfer could not start or the polled transfer failed
+ */
+bool bSPI_transferAuto(const uint8_t* p_pu8TxData, uint8_t* p_pu8RxData, uint16_t p_u16Size) {
+  bool l_bResult = false;
+  eHAL_TransferMode_t l_eMode;
+
+  if (p_pu8TxData == NULL || p_pu8RxData == NULL || p_u16Size == 0) {
+    return false;
+  }
+
+  l_eMode = eHAL_Transfer_select(&s_sDispatch, p_u16Size);
+  switch (l_eMode) {
+    case ceHAL_TRANSFER_POLLING:
+      vSPI_applyProfile(ceHAL_DMA_PROFILE_SINGLE);
+      vSPI_traceBegin(p_pu8TxData[0], p_u16Size - 1U, l_eMode);
+      l_bResult = HAL_SPI_TransmitReceive(&hspi1, (uint8_t*)p_pu8TxData, p_pu8RxData, p_u16Size, cSPI_TIMEOUT_MS) == HAL_OK;
+      vHAL_Trace_transferEnd(ceHAL_TRACE_SPI1, l_bResult ? ceHAL_TRACE_OK : ceHAL_TRACE_ERROR);
+      if (l_bResult && s_pfTxRxCplt != NULL) {
+        s_pfTxRxCplt();
+      }
+      break;
+    case ceHAL_TRANSFER_IT:
+      vSPI_applyProfile(ceHAL_DMA_PROFILE_SINGLE);
+      l_bResult = HAL_SPI_TransmitReceive_IT(&hspi1, (uint8_t*)p_pu8TxData, p_pu8RxData, p_u16Size) == HAL_OK;
+      break;
+    default:
+      /* Both buffers share the profile, the SPI FIFO threshold is common */
+      if (eHAL_DMA_selectProfile(p_pu8TxData, p_u16Size) == ceHAL_DMA_PROFILE_BURST) {
+        vSPI_applyProfile(eHAL_DMA_selectProfile(p_pu8RxData, p_u16Size));
+      }
+      else {
+        vSPI_applyProfile(ceHAL_DMA_PROFILE_SINGLE);
+      }
+      l_bResult = HAL_SPI_TransmitReceive_DMA(&hspi1, (uint8_t*)p_pu8TxData, p_pu8RxData, p_u16Size) == HAL_OK;
+      break;
+  }
+  if (l_bResult && l_eMode != ceHAL_TRANSFER_POLLING) {
+    vSPI_traceBegin(p_pu8TxData[0], p_u16Size - 1U, l_eMode);
+  }
+
+  return l_bResult;
+}
+
+/**
+ * @brief Reads registers of the selected device, polled
+ * 
+ * Sends the register address with cSPI_READ_BIT set, then clocks the
+ * data in. Blocking, the chip select is left to the caller.
+ * 
+ * @param p_u8Register the first register to read
+ * @param p_pu8Data the data array to fill
+ * @param p_u16Size the number of registers to read
+ * @return false if a parameter is invalid or the transfer failed
+ */
+bool bSPI_memRead(uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  uint8_t l_u8Address = p_u8Register | cSPI_READ_BIT;
+  bool l_bResult;
+
+  if (p_pu8Data == NULL || p_u16Size == 0) {
+    return false;
+  }
+
+  vSPI_traceBegin(l_u8Address, p_u16Size, ceHAL_TRANSFER_POLLING);
+  l_bResult =
+    HAL_SPI_Transmit(&hspi1, &l_u8Address, 1, cSPI_TIMEOUT_MS) == HAL_OK &&
+    HAL_SPI_Receive(&hspi1, p_pu8Data, p_u16Size, cSPI_TIMEOUT_MS) == HAL_OK;
+  vHAL_Trace_transferEnd(ceHAL_TRACE_SPI1, l_bResult ? ceHAL_TRACE_OK : ceHAL_TRACE_ERROR);
+
+  return l_bResult;
+}
+
+/**
+ * @brief Writes registers of the selected device, polled
+ * 
+ * Blocking, the chip select is left to the caller.
+ * 
+ * @param p_u8Register the first register to write
+ * @param p_pu8Data the data to write
+ * @param p_u16Size the number of registers to write
+ * @return false if a parameter is invalid or the transfer failed
+ */
+bool bSPI_memWrite(uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  uint8_t l_u8Address = p_u8Register & (uint8_t)~cSPI_READ_BIT;
+  bool l_bResult;
+
+  if (p_pu8Data == NULL || p_u16Size == 0) {
+    return false;
+  }
+
+  vSPI_traceBegin(l_u8Address, p_u16Size, ceHAL_TRANSFER_POLLING);
+  l_bResult =
+    HAL_SPI_Transmit(&hspi1, &l_u8Address, 1, cSPI_TIMEOUT_MS) == HAL_OK &&
+    HAL_SPI_Transmit(&hspi1, (uint8_t*)p_pu8Data, p_u16Size, cSPI_TIMEOUT_MS) == HAL_OK;
+  vHAL_Trace_transferEnd(ceHAL_TRACE_SPI1, l_bResult ? ceHAL_TRACE_OK : ceHAL_TRACE_ERROR);
+
+  return l_bResult;
+}
+
+/**
+ * @brief Calibrates the transfer mode thresholds
+ * 
+ * Exchanges dummy bytes once per mode for each calibration size and
+ * measures the CPU cycles each mode keeps the core busy: the whole
+ * transfer when polling, the start call plus the interrupt handlers with
+ * interrupts or DMA. Must be called once a device is attached, before its
+ * first transfer and with no device selected. The default thresholds
+ * apply until then.
+ * 
+ * @return
+ */
+void vSPI_calibrate(void) {
+  uint16_t l_u16Size;
+  uint32_t l_u32Start;
+  uint32_t l_u32Busy;
+  HAL_StatusTypeDef l_eStatus;
+  uint32_t i;
+  uint32_t l_u32Mode;
+
+  for (i = 0; i < cSPI_BENCH_MAX_SIZE; i++) {
+    s_au8CalTx[i] = 0xFF;
+  }
+
+  for (i = 0; i < cHAL_TRANSFER_CAL_SIZE_NB; i++) {
+    l_u16Size = u16HAL_Transfer_getCalSize(i);
+
+    for (l_u32Mode = 0; l_u32Mode < ceHAL_TRANSFER_MODE_NB; l_u32Mode++) {
+      s_u32IsrCycles = 0;
+      l_u32Start = u32HAL_DWT_getCycles();
+
+      if (l_u32Mode == ceHAL_TRANSFER_POLLING) {
+        vSPI_applyProfile(ceHAL_DMA_PROFILE_SINGLE);
+        l_eStatus = HAL_SPI_TransmitReceive(&hspi1, s_au8CalTx, s_au8CalRx, l_u16Size, cSPI_TIMEOUT_MS);
+      }
+      else if (l_u32Mode == ceHAL_TRANSFER_IT) {
+        vSPI_applyProfile(ceHAL_DMA_PROFILE_SINGLE);
+        l_eStatus = HAL_SPI_TransmitReceive_IT(&hspi1, s_au8CalTx, s_au8CalRx, l_u16Size);
+      }
+      else {
+        vSPI_applyProfile(eHAL_DMA_selectProfile(s_au8CalRx, l_u16Size));
+        l_eStatus = HAL_SPI_TransmitReceive_DMA(&hspi1, s_au8CalTx, s_au8CalRx, l_u16Size);
+      }
+
+      l_u32Busy = u32HAL_DWT_getCycles() - l_u32Start;
+      if (l_eStatus == HAL_OK && !bSPI_waitReady(l_u32Start)) {
+        l_eStatus = HAL_TIMEOUT;
+      }
+
+      if (l_u32Mode != ceHAL_TRANSFER_POLLING) {
+        /* The core is free between interrupts, only the handlers count */
+        l_u32Busy += s_u32IsrCycles;
+      }
+      s_sDispatch.au32_cal_cycles[i][l_u32Mode] = (l_eStatus == HAL_OK) ? l_u32Busy : UINT32_MAX;
+    }
+  }
+
+  vHAL_Transfer_applyCalibration(&s_sDispatch);
+}
+
+/**
+ * @brief Gives the calibrated thresholds and per-mode counters
+ * 
+ * @return the SPI dispatcher
+ */
+const sHAL_TransferDispatch_t* psSPI_getDispatch(void) {
+  return &s_sDispatch;
+}
+
+/**
+ * @brief Measures the DMA drain time of each stream profile
+ * 
+ * For each size of s_au16DMABenchSizes, exchanges dummy bytes with both
+ * streams forced to each profile and records the average cycles from the
+ * start of the transfer to its completion, with the memory side bus
+ * transactions of both streams, see psSPI_getDMABenchmark. Must be called
+ * from thread mode with no device selected, vHAL_DWT_init must have been
+ * called.
+ * 
+ * @return
+ */
+void vSPI_benchmarkDMA(void) {
+  uint16_t l_u16Size;
+  uint32_t l_u32Start;
+  uint32_t l_u32Cycles;
+  uint32_t l_u32Profile;
+  bool l_bSuccess;
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 0; i < cSPI_BENCH_MAX_SIZE; i++) {
+    s_au8CalTx[i] = 0xFF;
+  }
+
+  for (i = 0; i < cSPI_DMA_BENCH_SIZE_NB; i++) {
+    l_u16Size = s_au16DMABenchSizes[i];
+    s_asDMABenchmark[i].u16_size = l_u16Size;
+
+    for (l_u32Profile = 0; l_u32Profile < ceHAL_DMA_PROFILE_NB; l_u32Profile++) {
+      vSPI_applyProfile((eHAL_DMAProfile_t)l_u32Profile);
+      l_u32Cycles = 0;
+
+      for (j = 0; j < cSPI_BENCH_REPS && l_u32Cycles != UINT32_MAX; j++) {
+        l_u32Start = u32HAL_DWT_getCycles();
+        l_bSuccess = HAL_SPI_TransmitReceive_DMA(&hspi1, s_au8CalTx, s_au8CalRx, l_u16Size) == HAL_OK &&
+                     bSPI_waitReady(l_u32Start);
+        l_u32Cycles = l_bSuccess ? l_u32Cycles + (u32HAL_DWT_getCycles() - l_u32Start) : UINT32_MAX;
+      }
+
+      s_asDMABenchmark[i].au32_drain_cycles[l_u32Profile] = (l_u32Cycles == UINT32_MAX) ? UINT32_MAX : l_u32Cycles / cSPI_BENCH_REPS;
+      s_asDMABenchmark[i].au32_transactions[l_u32Profile] = 2 * u32HAL_DMA_getTransactions((eHAL_DMAProfile_t)l_u32Profile, l_u16Size);
+    }
+  }
+
+  vSPI_applyProfile(ceHAL_DMA_PROFILE_SINGLE);
+}
+
+/**
+ * @brief Gives the drain times measured by vSPI_benchmarkDMA
+ * 
+ * @return the results, cSPI_DMA_BENCH_SIZE_NB sizes in increasing order,
+ * zeroed until the benchmark ran
+ */
+const sHAL_DMABenchmark_t* psSPI_getDMABenchmark(void) {
+  return s_asDMABenchmark;
 }
 
 /* Private functions ---------------------------------------------------------*/
@@ -100,7 +373,7 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef* spiHandle)
     hdma_spi1_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_spi1_tx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
     hdma_spi1_tx.Init.Mode = DMA_NORMAL;
-    hdma_spi1_tx.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_spi1_tx.Init.Priority = cHAL_DMA_PRIORITY_SPI_TX;
     hdma_spi1_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
     HAL_DMA_Init(&hdma_spi1_tx);
 
@@ -115,15 +388,14 @@ void HAL_SPI_MspInit(SPI_HandleTypeDef* spiHandle)
     hdma_spi1_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
     hdma_spi1_rx.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
     hdma_spi1_rx.Init.Mode = DMA_NORMAL;
-    hdma_spi1_rx.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_spi1_rx.Init.Priority = cHAL_DMA_PRIORITY_SPI_RX;
     hdma_spi1_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
     HAL_DMA_Init(&hdma_spi1_rx);
 
     __HAL_LINKDMA(spiHandle,hdmarx,hdma_spi1_rx);
 
     /* SPI1 interrupt Init */
-    HAL_NVIC_SetPriority(SPI1_IRQn, 0, 0);
-    HAL_NVIC_EnableIRQ(SPI1_IRQn);
+    vHAL_NVIC_enable(SPI1_IRQn);
 
   }
 }
@@ -152,3 +424,110 @@ void HAL_SPI_MspDeInit(SPI_HandleTypeDef* spiHandle)
 
   }
 }
+
+/**
+ * @brief Waits for the end of a transfer of the boot time measurements
+ * 
+ * A transfer still running after cSPI_WAIT_US is aborted, the streams
+ * and the handle are ready again.
+ * 
+ * @param p_u32Start the cycle count the transfer started at
+ * @return false if the transfer failed or timed out
+ */
+static bool bSPI_waitReady(uint32_t p_u32Start) {
+  const uint32_t l_u32Timeout = u32HAL_DWT_usToCycles(cSPI_WAIT_US);
+
+  while (hspi1.State != HAL_SPI_STATE_READY) {
+    if ((u32HAL_DWT_getCycles() - p_u32Start) > l_u32Timeout) {
+      (void)HAL_SPI_Abort(&hspi1);
+      return false;
+    }
+  }
+
+  return hspi1.ErrorCode == HAL_SPI_ERROR_NONE;
+}
+
+/**
+ * @brief Sets the stream profile of both SPI streams and the FIFO threshold
+ * 
+ * With the burst profile, the SPI raises one DMA request per 4 data and
+ * the streams move them as one peripheral burst. The threshold can only
+ * change while the SPI is disabled, which the HAL does after each transfer.
+ * 
+ * @param p_eProfile the profile of the coming transfer
+ * @return
+ */
+static void vSPI_applyProfile(eHAL_DMAProfile_t p_eProfile) {
+  uint32_t l_u32Threshold;
+
+  if (hspi1.State != HAL_SPI_STATE_READY) {
+    return;
+  }
+
+  l_u32Threshold = (p_eProfile == ceHAL_DMA_PROFILE_BURST) ? SPI_FIFO_THRESHOLD_04DATA : SPI_FIFO_THRESHOLD_01DATA;
+  if (hspi1.Init.FifoThreshold != l_u32Threshold) {
+    hspi1.Init.FifoThreshold = l_u32Threshold;
+    MODIFY_REG(hspi1.Instance->CFG1, SPI_CFG1_FTHLV, l_u32Threshold);
+  }
+
+  vHAL_DMA_applyProfile(&hdma_spi1_tx, p_eProfile, cHAL_DMA_PRIORITY_SPI_TX, DMA_PBURST_INC4);
+  vHAL_DMA_applyProfile(&hdma_spi1_rx, p_eProfile, cHAL_DMA_PRIORITY_SPI_RX, DMA_PBURST_INC4);
+}
+
+/**
+ * @brief Opens the trace of an SPI register transaction
+ * 
+ * @param p_u8Address the first byte sent, register address and read bit
+ * @param p_u16Size the number of data bytes
+ * @param p_eMode how the transfer is driven
+ * @return
+ */
+static inline void vSPI_traceBegin(uint8_t p_u8Address, uint16_t p_u16Size, eHAL_TransferMode_t p_eMode) {
+  vHAL_Trace_transferBegin(ceHAL_TRACE_SPI1, 0, p_u8Address & (uint8_t)~cSPI_READ_BIT,
+                           (p_u8Address & cSPI_READ_BIT) != 0U, p_u16Size, p_eMode);
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+  if (hspi->Instance == SPI1) {
+    vHAL_Trace_transferEnd(ceHAL_TRACE_SPI1, ceHAL_TRACE_OK);
+  }
+  if (hspi->Instance == SPI1 && s_pfTxRxCplt != NULL) {
+    bHAL_Defer_post(s_pfTxRxCplt);
+  }
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+  if (hspi->Instance == SPI1) {
+    vHAL_Trace_transferEnd(ceHAL_TRACE_SPI1, ceHAL_TRACE_ERROR);
+  }
+  if (hspi->Instance == SPI1 && s_pfError != NULL) {
+    bHAL_Defer_post(s_pfError);
+  }
+}
+
+void SPI1_IRQHandler(void) {
+  uint32_t l_u32Start;
+
+  vHAL_NVIC_latencyEntry(SPI1_IRQn);
+  l_u32Start = u32HAL_DWT_getCycles();
+  HAL_SPI_IRQHandler(&hspi1);
+  s_u32IsrCycles += u32HAL_DWT_getCycles() - l_u32Start;
+}
+
+void DMA1_Stream2_IRQHandler(void) {
+  uint32_t l_u32Start;
+
+  vHAL_NVIC_latencyEntry(DMA1_Stream2_IRQn);
+  l_u32Start = u32HAL_DWT_getCycles();
+  HAL_DMA_IRQHandler(&hdma_spi1_tx);
+  s_u32IsrCycles += u32HAL_DWT_getCycles() - l_u32Start;
+}
+
+void DMA1_Stream3_IRQHandler(void) {
+  uint32_t l_u32Start;
+
+  vHAL_NVIC_latencyEntry(DMA1_Stream3_IRQn);
+  l_u32Start = u32HAL_DWT_getCycles();
+  HAL_DMA_IRQHandler(&hdma_spi1_rx);
+  s_u32IsrCycles += u32HAL_DWT_getCycles() - l_u32Start;
+}
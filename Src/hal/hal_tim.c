@@ -0,0 +1,168 @@
+/**
+  ******************************************************************************
+  * @file           : hal_tim.c
+  * @brief          : This file provides code for the timers scheduling
+  * sensor acquisitions
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/21
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "hal/hal_nvic.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "hal/hal_tim.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static TIM_HandleTypeDef htim2;
+static pfHAL_TIM_Callback_t s_pfTrigger = NULL;
+static pfHAL_TIM_Callback_t s_pfDelayed = NULL;
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Init function for the acquisition timer
+ * 
+ * Initialises TIM2 as a 32-bit up-counter ticking every microsecond. The
+ * update event starts an acquisition and the channel 1 compare event fires
+ * a fixed delay later in the same period.
+ * 
+ * @return
+ */
+void vHAL_TIM_init(void) {
+  TIM_OC_InitTypeDef sConfigOC = {0};
+  uint32_t l_u32TimClock = HAL_RCC_GetPCLK1Freq();
+
+  /* APB1 timers run at twice PCLK1 when the APB1 prescaler is not 1 */
+  if ((RCC->D2CFGR & RCC_D2CFGR_D2PPRE1) != RCC_APB1_DIV1) {
+    l_u32TimClock *= 2;
+  }
+
+  htim2.Instance = TIM2;
+  htim2.Init.Prescaler = (l_u32TimClock / cHAL_TIM_TICK_HZ) - 1;
+  htim2.Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim2.Init.Period = 0xFFFFFFFF;
+  htim2.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim2.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_ENABLE;
+  HAL_TIM_OC_Init(&htim2);
+
+  sConfigOC.OCMode = TIM_OCMODE_TIMING;
+  sConfigOC.Pulse = 0;
+  sConfigOC.OCPolarity = TIM_OCPOLARITY_HIGH;
+  sConfigOC.OCFastMode = TIM_OCFAST_DISABLE;
+  HAL_TIM_OC_ConfigChannel(&htim2, &sConfigOC, TIM_CHANNEL_1);
+}
+
+/**
+ * @brief Init function for timer clock and interrupt
+ * 
+ * @param timHandle the structure containing all configurations of the timer
+ * @return
+ */
+void HAL_TIM_OC_MspInit(TIM_HandleTypeDef* timHandle) {
+  if (timHandle->Instance == TIM2) {
+    /* TIM2 clock enable */
+    __HAL_RCC_TIM2_CLK_ENABLE();
+
+    /* TIM2 interrupt Init */
+    vHAL_NVIC_enable(TIM2_IRQn);
+  }
+}
+
+/**
+ * @brief Deinit function for timer clock and interrupt
+ * 
+ * @param timHandle the structure containing all configurations of the timer
+ * @return
+ */
+void HAL_TIM_OC_MspDeInit(TIM_HandleTypeDef* timHandle) {
+  if (timHandle->Instance == TIM2) {
+    /* Peripheral clock disable */
+    __HAL_RCC_TIM2_CLK_DISABLE();
+
+    /* TIM2 interrupt Deinit */
+    HAL_NVIC_DisableIRQ(TIM2_IRQn);
+  }
+}
+
+/**
+ * @brief Starts the periodic acquisition trigger
+ * 
+ * The trigger callback is called from the update interrupt right away,
+ * then every p_u32PeriodUs, the delayed callback is called p_u32DelayUs
+ * after each trigger from the compare interrupt. Both run in interrupt
+ * context.
+ * 
+ * @param p_u32PeriodUs the trigger period in us
+ * @param p_u32DelayUs the delay between trigger and delayed callbacks in us
+ * @param p_pfTrigger the callback called at the start of each period
+ * @param p_pfDelayed the callback called p_u32DelayUs after the trigger
+ * @return true if started, false if the delay does not fit in the period
+ */
+bool bHAL_TIM_startTrigger(uint32_t p_u32PeriodUs, uint32_t p_u32DelayUs, pfHAL_TIM_Callback_t p_pfTrigger, pfHAL_TIM_Callback_t p_pfDelayed) {
+  if (p_u32PeriodUs < 2 || p_u32DelayUs == 0 || p_u32DelayUs >= p_u32PeriodUs) {
+    return false;
+  }
+
+  vHAL_TIM_stopTrigger();
+
+  s_pfTrigger = p_pfTrigger;
+  s_pfDelayed = p_pfDelayed;
+
+  __HAL_TIM_SET_AUTORELOAD(&htim2, p_u32PeriodUs - 1);
+  __HAL_TIM_SET_COMPARE(&htim2, TIM_CHANNEL_1, p_u32DelayUs);
+  __HAL_TIM_SET_COUNTER(&htim2, 0);
+
+  /* Load ARR, the update flag raised by the reload is kept so the first
+   * trigger runs as soon as its interrupt is enabled, ahead of the first
+   * compare */
+  HAL_TIM_GenerateEvent(&htim2, TIM_EVENTSOURCE_UPDATE);
+  __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_CC1);
+
+  __HAL_TIM_ENABLE_IT(&htim2, TIM_IT_UPDATE);
+  HAL_TIM_OC_Start_IT(&htim2, TIM_CHANNEL_1);
+
+  return true;
+}
+
+/**
+ * @brief Stops the periodic acquisition trigger
+ * 
+ * @return
+ */
+void vHAL_TIM_stopTrigger(void) {
+  HAL_TIM_OC_Stop_IT(&htim2, TIM_CHANNEL_1);
+  __HAL_TIM_DISABLE_IT(&htim2, TIM_IT_UPDATE);
+  __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE | TIM_FLAG_CC1);
+}
+
+void TIM2_IRQHandler(void) {
+  vHAL_NVIC_latencyEntry(TIM2_IRQn);
+  HAL_TIM_IRQHandler(&htim2);
+}
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {
+  if (htim->Instance == TIM2 && s_pfTrigger != NULL) {
+    s_pfTrigger();
+  }
+}
+
+void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef* htim) {
+  if (htim->Instance == TIM2 && htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1 && s_pfDelayed != NULL) {
+    s_pfDelayed();
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
@@ -0,0 +1,412 @@
+/**
+  ******************************************************************************
+  * @file           : hal_timer.c
+  * @brief          : Tickless timer service, a min-heap of software timers
+  * on TIM5 with only the nearest deadline programmed in its compare channel
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/04
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stddef.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "hal/hal_nvic.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "hal/hal_timer.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cHAL_TIMER_TICK_HZ (uint32_t)1000000 //Counter tick of 1 us
+#define cHAL_TIMER_US_PER_TICK_MS (uint32_t)1000
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sHAL_Timer_t* s_apsHeap[cHAL_TIMER_HEAP_SIZE];
+static uint32_t s_u32Count = 0;
+static uint32_t s_u32IdleRemainderUs = 0; //Sleep time not yet added to the HAL tick
+
+/* Private function prototypes -----------------------------------------------*/
+static bool bHAL_Timer_before(const sHAL_Timer_t* p_psA, const sHAL_Timer_t* p_psB);
+static void vHAL_Timer_place(uint32_t p_u32Index, sHAL_Timer_t* p_psTimer);
+static void vHAL_Timer_siftUp(uint32_t p_u32Index);
+static void vHAL_Timer_siftDown(uint32_t p_u32Index);
+static bool bHAL_Timer_insert(sHAL_Timer_t* p_psTimer);
+static void vHAL_Timer_remove(sHAL_Timer_t* p_psTimer);
+static void vHAL_Timer_program(void);
+static void vHAL_Timer_wake(void* p_pvArg);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Init function for the timer service
+ * 
+ * Starts TIM5 as a free running 32-bit counter ticking every microsecond.
+ * Its channel 1 compare holds the nearest deadline, the interrupt only
+ * fires when a timer expires.
+ * 
+ * @return
+ */
+void vHAL_Timer_init(void) {
+  uint32_t l_u32TimClock = HAL_RCC_GetPCLK1Freq();
+
+  /* APB1 timers run at twice PCLK1 when the APB1 prescaler is not 1 */
+  if ((RCC->D2CFGR & RCC_D2CFGR_D2PPRE1) != RCC_APB1_DIV1) {
+    l_u32TimClock *= 2;
+  }
+
+  s_u32Count = 0;
+
+  __HAL_RCC_TIM5_CLK_ENABLE();
+  TIM5->CR1 = 0;
+  TIM5->PSC = (l_u32TimClock / cHAL_TIMER_TICK_HZ) - 1;
+  TIM5->ARR = 0xFFFFFFFF;
+  TIM5->CCMR1 = 0; //Channel 1 frozen output, compare only
+  TIM5->DIER = 0;
+  TIM5->EGR = TIM_EGR_UG; //Load the prescaler
+  TIM5->SR = 0;
+  TIM5->CR1 = TIM_CR1_CEN;
+
+  vHAL_NVIC_enable(TIM5_IRQn);
+}
+
+/**
+ * @brief Gives the current time
+ * 
+ * Wraps every 71 minutes, only differences are meaningful.
+ * 
+ * @return the time in us
+ */
+uint32_t u32HAL_Timer_now(void) {
+  return TIM5->CNT;
+}
+
+/**
+ * @brief Initialises a stopped timer
+ * 
+ * @param p_psTimer the timer
+ * @param p_pfCallback the function called from the TIM5 interrupt on expiry
+ * @param p_pvArg the argument given to the callback
+ * @return
+ */
+void vHAL_Timer_create(sHAL_Timer_t* p_psTimer, pfHAL_TimerCallback_t p_pfCallback, void* p_pvArg) {
+  if (p_psTimer != NULL) {
+    p_psTimer->u32_deadline = 0;
+    p_psTimer->u32_period_us = 0;
+    p_psTimer->pf_callback = p_pfCallback;
+    p_psTimer->pv_arg = p_pvArg;
+    p_psTimer->u32_heap_index = cHAL_TIMER_NOT_ARMED;
+  }
+}
+
+/**
+ * @brief Arms a timer, restarting it if already armed
+ * 
+ * Safe from any context. Periodic timers keep their phase: each deadline
+ * is the previous one plus the period, unless a whole period was missed.
+ * 
+ * @param p_psTimer the timer, created with vHAL_Timer_create
+ * @param p_u32DelayUs the delay before the first expiry in us
+ * @param p_u32PeriodUs the period in us, 0 for a one-shot timer
+ * @return false if a parameter is out of range or the heap is full
+ */
+bool bHAL_Timer_start(sHAL_Timer_t* p_psTimer, uint32_t p_u32DelayUs, uint32_t p_u32PeriodUs) {
+  uint32_t l_u32Primask;
+  bool l_bResult;
+
+  if (
+    p_psTimer == NULL ||
+    p_psTimer->pf_callback == NULL ||
+    p_u32DelayUs > cHAL_TIMER_MAX_US ||
+    p_u32PeriodUs > cHAL_TIMER_MAX_US
+  ) {
+    return false;
+  }
+
+  l_u32Primask = __get_PRIMASK();
+  __disable_irq();
+
+  vHAL_Timer_remove(p_psTimer);
+  p_psTimer->u32_deadline = u32HAL_Timer_now() + p_u32DelayUs;
+  p_psTimer->u32_period_us = p_u32PeriodUs;
+  l_bResult = bHAL_Timer_insert(p_psTimer);
+  vHAL_Timer_program();
+
+  __set_PRIMASK(l_u32Primask);
+
+  return l_bResult;
+}
+
+/**
+ * @brief Disarms a timer, does nothing if already stopped
+ * 
+ * @param p_psTimer the timer
+ * @return
+ */
+void vHAL_Timer_stop(sHAL_Timer_t* p_psTimer) {
+  uint32_t l_u32Primask;
+
+  if (p_psTimer == NULL) {
+    return;
+  }
+
+  l_u32Primask = __get_PRIMASK();
+  __disable_irq();
+  vHAL_Timer_remove(p_psTimer);
+  vHAL_Timer_program();
+  __set_PRIMASK(l_u32Primask);
+}
+
+/**
+ * @brief Tells if a timer is armed
+ * 
+ * @param p_psTimer the timer
+ * @return true if the timer will expire
+ */
+bool bHAL_Timer_isArmed(const sHAL_Timer_t* p_psTimer) {
+  return p_psTimer != NULL && p_psTimer->u32_heap_index != cHAL_TIMER_NOT_ARMED;
+}
+
+/**
+ * @brief Gives the number of armed timers
+ * 
+ * @return the number of timers in the heap
+ */
+uint32_t u32HAL_Timer_getArmedCount(void) {
+  return s_u32Count;
+}
+
+/**
+ * @brief Waits with the core asleep, thread mode only
+ * 
+ * Replaces HAL_Delay busy-waits. Other interrupts are served while
+ * waiting.
+ * 
+ * @param p_u32DelayUs the delay in us
+ * @return
+ */
+void vHAL_Timer_sleepUs(uint32_t p_u32DelayUs) {
+  volatile bool l_bElapsed = false;
+  sHAL_Timer_t l_sTimer;
+
+  vHAL_Timer_create(&l_sTimer, vHAL_Timer_wake, (void*)&l_bElapsed);
+  if (!bHAL_Timer_start(&l_sTimer, p_u32DelayUs, 0)) {
+    return;
+  }
+
+  while (!l_bElapsed) {
+    __disable_irq();
+    if (!l_bElapsed) {
+      vHAL_Timer_idle();
+    }
+    __enable_irq();
+  }
+}
+
+/**
+ * @brief Sleeps until the next interrupt with SysTick stopped
+ * 
+ * Must be called with interrupts masked by PRIMASK, the pending interrupt
+ * runs once the caller unmasks them. The HAL tick is advanced by the time
+ * slept, measured on TIM5, so HAL_GetTick stays right without waking the
+ * core every millisecond.
+ * 
+ * @return
+ */
+void vHAL_Timer_idle(void) {
+  uint32_t l_u32Start;
+  uint32_t l_u32SleptUs;
+
+  HAL_SuspendTick();
+  l_u32Start = u32HAL_Timer_now();
+
+  __DSB();
+  __WFI();
+
+  l_u32SleptUs = (u32HAL_Timer_now() - l_u32Start) + s_u32IdleRemainderUs;
+  uwTick += l_u32SleptUs / cHAL_TIMER_US_PER_TICK_MS;
+  s_u32IdleRemainderUs = l_u32SleptUs % cHAL_TIMER_US_PER_TICK_MS;
+  HAL_ResumeTick();
+}
+
+void TIM5_IRQHandler(void) {
+  sHAL_Timer_t* l_psTimer;
+  uint32_t l_u32Now;
+
+  vHAL_NVIC_latencyEntry(TIM5_IRQn);
+  TIM5->SR = ~TIM_SR_CC1IF;
+
+  while (1) {
+    __disable_irq();
+    l_u32Now = u32HAL_Timer_now();
+    if (s_u32Count == 0 || (int32_t)(l_u32Now - s_apsHeap[0]->u32_deadline) < 0) {
+      vHAL_Timer_program();
+      __enable_irq();
+      break;
+    }
+
+    l_psTimer = s_apsHeap[0];
+    vHAL_Timer_remove(l_psTimer);
+    if (l_psTimer->u32_period_us != 0) {
+      l_psTimer->u32_deadline += l_psTimer->u32_period_us;
+      if ((int32_t)(l_u32Now - l_psTimer->u32_deadline) >= 0) {
+        /* Late by a whole period, skip the missed expiries */
+        l_psTimer->u32_deadline = l_u32Now + l_psTimer->u32_period_us;
+      }
+      (void)bHAL_Timer_insert(l_psTimer);
+    }
+    __enable_irq();
+
+    l_psTimer->pf_callback(l_psTimer->pv_arg);
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Orders two timers by deadline, valid across the counter wrap
+ * 
+ * @param p_psA the first timer
+ * @param p_psB the second timer
+ * @return true if p_psA expires first
+ */
+static bool bHAL_Timer_before(const sHAL_Timer_t* p_psA, const sHAL_Timer_t* p_psB) {
+  return (int32_t)(p_psA->u32_deadline - p_psB->u32_deadline) < 0;
+}
+
+/**
+ * @brief Stores a timer in a heap slot and records the slot in the timer
+ * 
+ * @param p_u32Index the heap slot
+ * @param p_psTimer the timer
+ * @return
+ */
+static void vHAL_Timer_place(uint32_t p_u32Index, sHAL_Timer_t* p_psTimer) {
+  s_apsHeap[p_u32Index] = p_psTimer;
+  p_psTimer->u32_heap_index = p_u32Index;
+}
+
+/**
+ * @brief Moves a timer up until its parent expires first
+ * 
+ * @param p_u32Index the heap slot of the timer
+ * @return
+ */
+static void vHAL_Timer_siftUp(uint32_t p_u32Index) {
+  sHAL_Timer_t* l_psTimer = s_apsHeap[p_u32Index];
+  uint32_t l_u32Parent;
+
+  while (p_u32Index > 0) {
+    l_u32Parent = (p_u32Index - 1) / 2;
+    if (!bHAL_Timer_before(l_psTimer, s_apsHeap[l_u32Parent])) {
+      break;
+    }
+    vHAL_Timer_place(p_u32Index, s_apsHeap[l_u32Parent]);
+    p_u32Index = l_u32Parent;
+  }
+  vHAL_Timer_place(p_u32Index, l_psTimer);
+}
+
+/**
+ * @brief Moves a timer down until it expires before its children
+ * 
+ * @param p_u32Index the heap slot of the timer
+ * @return
+ */
+static void vHAL_Timer_siftDown(uint32_t p_u32Index) {
+  sHAL_Timer_t* l_psTimer = s_apsHeap[p_u32Index];
+  uint32_t l_u32Child;
+
+  while ((l_u32Child = 2 * p_u32Index + 1) < s_u32Count) {
+    if (l_u32Child + 1 < s_u32Count && bHAL_Timer_before(s_apsHeap[l_u32Child + 1], s_apsHeap[l_u32Child])) {
+      l_u32Child++;
+    }
+    if (!bHAL_Timer_before(s_apsHeap[l_u32Child], l_psTimer)) {
+      break;
+    }
+    vHAL_Timer_place(p_u32Index, s_apsHeap[l_u32Child]);
+    p_u32Index = l_u32Child;
+  }
+  vHAL_Timer_place(p_u32Index, l_psTimer);
+}
+
+/**
+ * @brief Adds a stopped timer to the heap, interrupts masked
+ * 
+ * @param p_psTimer the timer
+ * @return false if the heap is full
+ */
+static bool bHAL_Timer_insert(sHAL_Timer_t* p_psTimer) {
+  if (s_u32Count >= cHAL_TIMER_HEAP_SIZE) {
+    return false;
+  }
+
+  vHAL_Timer_place(s_u32Count, p_psTimer);
+  s_u32Count++;
+  vHAL_Timer_siftUp(s_u32Count - 1);
+
+  return true;
+}
+
+/**
+ * @brief Takes a timer out of the heap if armed, interrupts masked
+ * 
+ * @param p_psTimer the timer
+ * @return
+ */
+static void vHAL_Timer_remove(sHAL_Timer_t* p_psTimer) {
+  uint32_t l_u32Index = p_psTimer->u32_heap_index;
+  sHAL_Timer_t* l_psLast;
+
+  if (l_u32Index == cHAL_TIMER_NOT_ARMED) {
+    return;
+  }
+
+  p_psTimer->u32_heap_index = cHAL_TIMER_NOT_ARMED;
+  s_u32Count--;
+  if (l_u32Index == s_u32Count) {
+    return;
+  }
+
+  /* Fill the hole with the last timer and restore the heap order */
+  l_psLast = s_apsHeap[s_u32Count];
+  vHAL_Timer_place(l_u32Index, l_psLast);
+  vHAL_Timer_siftUp(l_u32Index);
+  vHAL_Timer_siftDown(l_psLast->u32_heap_index);
+}
+
+/**
+ * @brief Programs the compare channel with the nearest deadline
+ * 
+ * If the deadline passed while programming, the compare event is forced
+ * so it is not missed for a whole counter wrap. Interrupts masked.
+ * 
+ * @return
+ */
+static void vHAL_Timer_program(void) {
+  if (s_u32Count == 0) {
+    TIM5->DIER &= ~TIM_DIER_CC1IE;
+    return;
+  }
+
+  TIM5->CCR1 = s_apsHeap[0]->u32_deadline;
+  TIM5->DIER |= TIM_DIER_CC1IE;
+  if ((int32_t)(u32HAL_Timer_now() - s_apsHeap[0]->u32_deadline) >= 0) {
+    TIM5->EGR = TIM_EGR_CC1G;
+  }
+}
+
+/**
+ * @brief Sets the flag waited on by vHAL_Timer_sleepUs
+ * 
+ * @param p_pvArg the flag
+ * @return
+ */
+static void vHAL_Timer_wake(void* p_pvArg) {
+  *(volatile bool*)p_pvArg = true;
+}
@@ -0,0 +1,132 @@
+/**
+  ******************************************************************************
+  * @file           : hal_trace.c
+  * @brief          : Bus transaction tracer, records each I2C and SPI
+  * transaction into a ring read back by a debugger or the host
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "hal/hal_dwt.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "hal/hal_trace.h"
+
+#ifdef HAL_BUS_TRACE
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cHAL_TRACE_MASK (uint32_t)(cHAL_TRACE_RECORD_NB - 1)
+
+_Static_assert((cHAL_TRACE_RECORD_NB & (cHAL_TRACE_RECORD_NB - 1)) == 0, "cHAL_TRACE_RECORD_NB is not a power of 2");
+_Static_assert(sizeof(sHAL_TraceRecord_t) == 16, "trace record layout changed, update the converter");
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+sHAL_TraceBuffer_t g_sHAL_Trace;
+
+/* Transaction on the bus, copied into the ring when it ends */
+static sHAL_TraceRecord_t s_asOpen[ceHAL_TRACE_BUS_NB];
+static volatile bool s_abOpen[ceHAL_TRACE_BUS_NB];
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Init function for the bus tracer
+ *
+ * Empties the ring. Must be called after the clock and the DWT init, the
+ * cycle rate is read from SystemCoreClock.
+ *
+ * @return
+ */
+void vHAL_Trace_init(void) {
+  uint32_t i;
+
+  g_sHAL_Trace.u32_magic = cHAL_TRACE_MAGIC;
+  g_sHAL_Trace.u16_version = cHAL_TRACE_VERSION;
+  g_sHAL_Trace.u16_record_nb = (uint16_t)cHAL_TRACE_RECORD_NB;
+  g_sHAL_Trace.u32_cpu_hz = SystemCoreClock;
+  g_sHAL_Trace.u32_written = 0;
+
+  for (i = 0; i < (uint32_t)ceHAL_TRACE_BUS_NB; i++) {
+    s_abOpen[i] = false;
+  }
+}
+
+/**
+ * @brief Opens a transaction on a bus
+ *
+ * Called once the transfer is accepted, from the context starting it.
+ * A transaction still open on the bus is replaced.
+ *
+ * @param p_eBus the bus
+ * @param p_u8Address the 7-bit device address
+ * @param p_u8Register the first register
+ * @param p_bRead true for a read
+ * @param p_u16Size the number of data bytes
+ * @param p_eMode how the transfer is driven
+ * @return
+ */
+void vHAL_Trace_begin(eHAL_TraceBus_t p_eBus, uint8_t p_u8Address, uint8_t p_u8Register, bool p_bRead, uint16_t p_u16Size, eHAL_TransferMode_t p_eMode) {
+  sHAL_TraceRecord_t* l_psRecord = &s_asOpen[p_eBus];
+
+  l_psRecord->u32_start_cycles = u32HAL_DWT_getCycles();
+  l_psRecord->u16_size = p_u16Size;
+  l_psRecord->u8_bus = (uint8_t)p_eBus;
+  l_psRecord->u8_address = p_u8Address;
+  l_psRecord->u8_register = p_u8Register;
+  l_psRecord->u8_read = (uint8_t)p_bRead;
+  l_psRecord->u8_mode = (uint8_t)p_eMode;
+  s_abOpen[p_eBus] = true;
+}
+
+/**
+ * @brief Closes the transaction open on a bus and records it
+ *
+ * Callable from any interrupt, the slot is taken with interrupts masked.
+ *
+ * @param p_eBus the bus
+ * @param p_eResult the outcome
+ * @return
+ */
+void vHAL_Trace_end(eHAL_TraceBus_t p_eBus, eHAL_TraceResult_t p_eResult) {
+  uint32_t l_u32End = u32HAL_DWT_getCycles();
+  uint32_t l_u32Primask;
+  sHAL_TraceRecord_t* l_psSlot;
+
+  if (!s_abOpen[p_eBus]) {
+    return;
+  }
+
+  l_u32Primask = __get_PRIMASK();
+  __disable_irq();
+  s_abOpen[p_eBus] = false;
+  l_psSlot = &g_sHAL_Trace.as_records[g_sHAL_Trace.u32_written & cHAL_TRACE_MASK];
+  *l_psSlot = s_asOpen[p_eBus];
+  l_psSlot->u32_end_cycles = l_u32End;
+  l_psSlot->u8_result = (uint8_t)p_eResult;
+  g_sHAL_Trace.u32_written++;
+  __set_PRIMASK(l_u32Primask);
+}
+
+/**
+ * @brief Gives the trace ring
+ *
+ * @return the ring, to copy or dump while no transaction ends
+ */
+const sHAL_TraceBuffer_t* psHAL_Trace_get(void) {
+  return &g_sHAL_Trace;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+#endif /* HAL_BUS_TRACE */
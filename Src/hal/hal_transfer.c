@@ -0,0 +1,160 @@
+/**
+  ******************************************************************************
+  * @file           : hal_transfer.c
+  * @brief          : Bus transfer mode selection shared by the I2C and SPI
+  * drivers
+  * @author         : Julien Cruvieux
+  * @date           : 2024/10/28
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include <stddef.h>
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "hal/hal_transfer.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cHAL_TRANSFER_DEFAULT_IT  (uint16_t)3 //Used until calibrated
+#define cHAL_TRANSFER_DEFAULT_DMA (uint16_t)8
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static const uint16_t s_au16CalSizes[cHAL_TRANSFER_CAL_SIZE_NB] = {1, 2, 3, 4, 6, 8, 16, 32};
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Initialises a dispatcher with default thresholds
+ * 
+ * @param p_psDispatch the dispatcher to initialise
+ * @return
+ */
+void vHAL_Transfer_init(sHAL_TransferDispatch_t* p_psDispatch) {
+  uint32_t i;
+  uint32_t j;
+
+  if (p_psDispatch == NULL) {
+    return;
+  }
+
+  p_psDispatch->u16_it_threshold = cHAL_TRANSFER_DEFAULT_IT;
+  p_psDispatch->u16_dma_threshold = cHAL_TRANSFER_DEFAULT_DMA;
+  for (j = 0; j < ceHAL_TRANSFER_MODE_NB; j++) {
+    p_psDispatch->au32_transfers[j] = 0;
+    p_psDispatch->au32_bytes[j] = 0;
+    for (i = 0; i < cHAL_TRANSFER_CAL_SIZE_NB; i++) {
+      p_psDispatch->au32_cal_cycles[i][j] = 0;
+    }
+  }
+}
+
+/**
+ * @brief Picks the transfer mode for a transfer size and counts it
+ * 
+ * @param p_psDispatch the dispatcher
+ * @param p_u16Size the transfer size in bytes
+ * @return the mode to use
+ */
+eHAL_TransferMode_t eHAL_Transfer_select(sHAL_TransferDispatch_t* p_psDispatch, uint16_t p_u16Size) {
+  eHAL_TransferMode_t l_eMode = eHAL_Transfer_pick(p_psDispatch, p_u16Size);
+
+  vHAL_Transfer_count(p_psDispatch, l_eMode, p_u16Size);
+  return l_eMode;
+}
+
+/**
+ * @brief Picks the transfer mode for a transfer size without counting it
+ * 
+ * For callers that may drive the transfer another way or start it more
+ * than once, they count it with vHAL_Transfer_count.
+ * 
+ * @param p_psDispatch the dispatcher
+ * @param p_u16Size the transfer size in bytes
+ * @return the mode the thresholds pick
+ */
+eHAL_TransferMode_t eHAL_Transfer_pick(const sHAL_TransferDispatch_t* p_psDispatch, uint16_t p_u16Size) {
+  if (p_u16Size < p_psDispatch->u16_it_threshold) {
+    return ceHAL_TRANSFER_POLLING;
+  }
+  if (p_u16Size < p_psDispatch->u16_dma_threshold) {
+    return ceHAL_TRANSFER_IT;
+  }
+
+  return ceHAL_TRANSFER_DMA;
+}
+
+/**
+ * @brief Counts a transfer in the usage counters of its mode
+ * 
+ * @param p_psDispatch the dispatcher
+ * @param p_eMode the mode the transfer was driven with
+ * @param p_u16Size the transfer size in bytes
+ * @return
+ */
+void vHAL_Transfer_count(sHAL_TransferDispatch_t* p_psDispatch, eHAL_TransferMode_t p_eMode, uint16_t p_u16Size) {
+  p_psDispatch->au32_transfers[p_eMode]++;
+  p_psDispatch->au32_bytes[p_eMode] += p_u16Size;
+}
+
+/**
+ * @brief Gives the transfer size of a calibration point
+ * 
+ * @param p_u32Index the calibration point, below cHAL_TRANSFER_CAL_SIZE_NB
+ * @return the size in bytes, 0 if out of range
+ */
+uint16_t u16HAL_Transfer_getCalSize(uint32_t p_u32Index) {
+  return (p_u32Index < cHAL_TRANSFER_CAL_SIZE_NB) ? s_au16CalSizes[p_u32Index] : 0U;
+}
+
+/**
+ * @brief Derives the thresholds from the measured costs
+ * 
+ * au32_cal_cycles must hold, for each calibration size and mode, the CPU
+ * cycles the transfer kept the core busy: the whole transfer when polling,
+ * the start call plus the interrupt handlers otherwise. Each threshold is
+ * the first calibrated size from which the next mode is cheaper.
+ * 
+ * @param p_psDispatch the dispatcher holding the measurements
+ * @return
+ */
+void vHAL_Transfer_applyCalibration(sHAL_TransferDispatch_t* p_psDispatch) {
+  uint16_t l_u16ITThreshold = UINT16_MAX;
+  uint16_t l_u16DMAThreshold = UINT16_MAX;
+  uint32_t i;
+
+  if (p_psDispatch == NULL) {
+    return;
+  }
+
+  for (i = 0; i < cHAL_TRANSFER_CAL_SIZE_NB; i++) {
+    const uint32_t* l_pu32Cost = p_psDispatch->au32_cal_cycles[i];
+    uint32_t l_u32Async = (l_pu32Cost[ceHAL_TRANSFER_IT] < l_pu32Cost[ceHAL_TRANSFER_DMA])
+      ? l_pu32Cost[ceHAL_TRANSFER_IT] : l_pu32Cost[ceHAL_TRANSFER_DMA];
+
+    if (l_u16ITThreshold == UINT16_MAX && l_u32Async < l_pu32Cost[ceHAL_TRANSFER_POLLING]) {
+      l_u16ITThreshold = s_au16CalSizes[i];
+    }
+    if (l_u16DMAThreshold == UINT16_MAX && l_pu32Cost[ceHAL_TRANSFER_DMA] < l_pu32Cost[ceHAL_TRANSFER_IT]
+        && l_pu32Cost[ceHAL_TRANSFER_DMA] < l_pu32Cost[ceHAL_TRANSFER_POLLING]) {
+      l_u16DMAThreshold = s_au16CalSizes[i];
+    }
+  }
+
+  /* Polling wins up to the IT threshold, DMA never applies below it */
+  if (l_u16DMAThreshold < l_u16ITThreshold) {
+    l_u16ITThreshold = l_u16DMAThreshold;
+  }
+
+  p_psDispatch->u16_it_threshold = l_u16ITThreshold;
+  p_psDispatch->u16_dma_threshold = l_u16DMAThreshold;
+}
+
+/* Private functions ---------------------------------------------------------*/
@@ -0,0 +1,363 @@
+/**
+  ******************************************************************************
+  * @file           : host_app.c
+  * @brief          : Host entry point running the firmware main in virtual
+  * time against the simulated bus and BMP581
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "app/app_bmp581.h"
+#include "app/app_event.h"
+#include "hal/hal_i2c.h"
+#ifndef BMP581_NO_SPI
+#include "hal/hal_spi.h"
+#endif
+#include "hal/hal_defer.h"
+#include "hal/hal_sched.h"
+#include "hal/hal_trace.h"
+#include "sim/sim_bus.h"
+#include "sim/sim_bmp581.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "host/host_hal.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Struct holding the parameters of a run
+ *
+ */
+typedef struct {
+  uint32_t u32_seconds;     //Virtual time to run
+  uint32_t u32_seed;
+  uint32_t u32_access_ns;
+  sSIM_BusFaults_t s_faults;
+  uint32_t u32_noise;           //0 for exact conversions
+  uint32_t u32_sine_pa;         //Pressure sinusoid peak
+  uint32_t u32_sine_period_s;
+  const char* pc_trace;         //Pressure trace file, added to the sea level
+  const char* pc_bus_trace;     //Bus trace ring written there at the end
+} sHostAppConfig_t;
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_APP_ADDRESS   BMP581_I2C_ADDR_PRIM
+#define cHOST_APP_SEA_LEVEL 101325.0 //Pa
+#define cHOST_APP_TRACE_NB  65536
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sSIM_BMP581_t s_sDevice;
+static sSIM_SignalPoint_t s_asTrace[cHOST_APP_TRACE_NB];
+
+/* Private function prototypes -----------------------------------------------*/
+int APP_main(void); //main of app_main.c, renamed by the build
+static void vHostApp_report(const sHostAppConfig_t* p_psConfig, uint64_t p_u64RealNs);
+#ifdef APP_BENCH_BUS
+static void vHostApp_reportBench(void);
+static void vHostApp_reportDMABench(const char* p_pcName, const sHAL_DMABenchmark_t* p_psResults, uint32_t p_u32Nb);
+#endif
+static bool bHostApp_parse(int p_iArgc, char** p_ppcArgv, sHostAppConfig_t* p_psConfig);
+static bool bHostApp_setSignals(const sHostAppConfig_t* p_psConfig);
+static bool bHostApp_writeBusTrace(const char* p_pcPath);
+static uint64_t u64HostApp_getNs(void);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ *
+ * Runs the unmodified firmware from reset for the given virtual time.
+ * The output only depends on the arguments, the real time line aside.
+ *
+ * @param argc the number of arguments
+ * @param argv the arguments, see the usage text
+ * @return 0 on success, 1 on a bad argument
+ */
+int main(int argc, char** argv) {
+  sHostAppConfig_t l_sConfig = {
+    .u32_seconds = 3600,
+    .u32_seed = 1,
+    .u32_access_ns = cHOST_HAL_ACCESS_NS_DEFAULT,
+    .s_faults = {0},
+    .u32_noise = 1,
+    .u32_sine_pa = 0,
+    .u32_sine_period_s = 600,
+    .pc_trace = NULL,
+    .pc_bus_trace = NULL
+  };
+  sHostHALConfig_t l_sHALConfig;
+  uint64_t l_u64StartNs;
+
+  if (!bHostApp_parse(argc, argv, &l_sConfig)) {
+    fprintf(stderr,
+      "usage: %s [--seconds N] [--seed N] [--access-ns N] [--nack-ppm N] [--arb-ppm N]\n"
+      "          [--dma-ppm N] [--stretch-ppm N] [--stretch-max-us N] [--latency-max-us N] [--sda-ppm N]\n"
+      "          [--noise 0|1] [--press-sine-pa N] [--press-period-s N] [--press-trace FILE]\n"
+      "          [--bus-trace FILE]\n",
+      argv[0]);
+    return 1;
+  }
+
+  vSIM_Bus_init(l_sConfig.u32_seed);
+  vSIM_Bus_setFaults(&l_sConfig.s_faults);
+  vSIM_BMP581_init(&s_sDevice);
+  (void)bSIM_BMP581_attach(&s_sDevice, cHOST_APP_ADDRESS);
+  vSIM_BMP581_setNoise(&s_sDevice, l_sConfig.u32_noise != 0U, l_sConfig.u32_seed);
+  if (!bHostApp_setSignals(&l_sConfig)) {
+    fprintf(stderr, "%s: no point read from %s\n", argv[0], l_sConfig.pc_trace);
+    return 1;
+  }
+
+  l_sHALConfig.u64_duration_ns = (uint64_t)l_sConfig.u32_seconds * 1000000000ULL;
+  l_sHALConfig.u32_access_ns = l_sConfig.u32_access_ns;
+  vHostHAL_init(&l_sHALConfig);
+
+  l_u64StartNs = u64HostApp_getNs();
+  (void)u64HostHAL_run(APP_main);
+  vHostApp_report(&l_sConfig, u64HostApp_getNs() - l_u64StartNs);
+
+  if (l_sConfig.pc_bus_trace != NULL && !bHostApp_writeBusTrace(l_sConfig.pc_bus_trace)) {
+    fprintf(stderr, "%s: cannot write %s\n", argv[0], l_sConfig.pc_bus_trace);
+    return 1;
+  }
+
+  return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Prints the outcome of the run
+ *
+ * @param p_psConfig the run parameters
+ * @param p_u64RealNs the host time the run took
+ * @return
+ */
+static void vHostApp_report(const sHostAppConfig_t* p_psConfig, uint64_t p_u64RealNs) {
+  sHostHALStats_t l_sHAL;
+  sSIM_BusStats_t l_sBus;
+  sI2CRecoveryStats_t l_sRecovery;
+  sHAL_DeferStats_t l_sDefer;
+  sHAL_SchedTaskStats_t l_sTask;
+  uint32_t i;
+  double l_dVirtualS;
+  double l_dRealS = (double)p_u64RealNs / 1e9;
+
+  vHostHAL_getStats(&l_sHAL);
+  vSIM_Bus_getStats(&l_sBus);
+  vI2C_getRecoveryStats(&l_sRecovery);
+  vHAL_Defer_getStats(&l_sDefer);
+  l_dVirtualS = (double)l_sHAL.u64_now_ns / 1e9;
+
+  printf("seed %u, access %u ns, faults nack %u ppm, arb lost %u ppm, dma %u ppm, stretch %u ppm, sda stuck %u ppm\n",
+         p_psConfig->u32_seed, p_psConfig->u32_access_ns, p_psConfig->s_faults.u32_nack_ppm,
+         p_psConfig->s_faults.u32_arb_lost_ppm, p_psConfig->s_faults.u32_dma_error_ppm,
+         p_psConfig->s_faults.u32_stretch_ppm, p_psConfig->s_faults.u32_sda_stuck_ppm);
+  printf("signal      noise %s, sine %u Pa over %u s, trace %s\n",
+         (p_psConfig->u32_noise != 0U) ? "on" : "off", p_psConfig->u32_sine_pa,
+         p_psConfig->u32_sine_period_s, (p_psConfig->pc_trace != NULL) ? p_psConfig->pc_trace : "none");
+  printf("virtual     %.3f s%s\n", l_dVirtualS, l_sHAL.b_idle_end ? ", stopped idle with nothing armed" : "");
+  printf("real        %.3f s, x%.1f\n", l_dRealS, (l_dRealS > 0.0) ? l_dVirtualS / l_dRealS : 0.0);
+  printf("sensor      %u conversions, boot to first sample %u us, %u samples dropped\n",
+         u32SIM_BMP581_getConversions(&s_sDevice), u32APP_BMP581_getBootToSampleUs(),
+         u32APP_BMP581_getDroppedSamples());
+  printf("cpu         %.2f %% asleep, %u wakeups, %llu interrupts, %llu accesses, %u pumps\n",
+         (l_sHAL.u64_now_ns != 0U) ? 100.0 * (double)l_sHAL.u64_sleep_ns / (double)l_sHAL.u64_now_ns : 0.0,
+         u32APP_Event_getWakeups(), (unsigned long long)l_sHAL.u64_irqs,
+         (unsigned long long)l_sHAL.u64_accesses, l_sHAL.u32_pumps);
+  printf("bus         %u transfers, %u bytes, %u nacks, %u arb lost, %u dma errors, %u stretched, %u sda stuck, %.3f %% busy\n",
+         l_sBus.u32_transfers, l_sBus.u32_bytes, l_sBus.u32_nacks, l_sBus.u32_arb_lost,
+         l_sBus.u32_dma_errors, l_sBus.u32_stretches, l_sBus.u32_sda_stuck,
+         (l_sHAL.u64_now_ns != 0U) ? 100.0 * (double)l_sBus.u64_busy_us * 1000.0 / (double)l_sHAL.u64_now_ns : 0.0);
+  printf("i2c         %u register level, %u it, %u dma, %u blocking, %u errors, %u resets\n",
+         l_sHAL.u32_i2c_ll, l_sHAL.u32_i2c_it, l_sHAL.u32_i2c_dma, l_sHAL.u32_i2c_blocking,
+         l_sHAL.u32_i2c_errors, l_sHAL.u32_i2c_resets);
+  printf("recovery    %u errors, %u retries, %u abandoned, %u soft resets, %u recoveries, %u bus clears\n",
+         l_sRecovery.u32_errors, l_sRecovery.u32_retries, l_sRecovery.u32_abandoned,
+         l_sRecovery.u32_soft_resets, l_sRecovery.u32_recoveries, l_sRecovery.u32_bus_clears);
+  printf("defer       %u posted, %u run, %u dropped, depth %u, latency max %u cycles\n",
+         l_sDefer.u32_posted, l_sDefer.u32_run, l_sDefer.u32_dropped,
+         l_sDefer.u32_high_watermark, l_sDefer.u32_max_latency_cycles);
+  printf("tasks      ");
+  for (i = 0; i < (uint32_t)ceHAL_SCHED_TASK_NB; i++) {
+    vHAL_Sched_getStats((eHAL_SchedTask_t)i, &l_sTask);
+    printf(" %u/%u", l_sTask.u32_runs, l_sTask.u32_activations);
+  }
+  printf(" runs/activations, hi2c1 ceiling %u\n", psI2C_getResource()->u32_ceiling);
+  printf("leds        green %u toggles, red %u toggles\n",
+         u32HostHAL_getToggles(GPIOB, GPIO_PIN_0), u32HostHAL_getToggles(GPIOB, GPIO_PIN_14));
+#ifdef APP_BENCH_BUS
+  vHostApp_reportBench();
+#endif
+}
+
+#ifdef APP_BENCH_BUS
+/**
+ * @brief Prints the read path and DMA profile cycles measured at startup
+ *
+ * @return
+ */
+static void vHostApp_reportBench(void) {
+  const sI2CBenchmark_t* l_psPaths = psI2C_getBenchmark();
+  uint32_t i;
+
+  printf("i2c paths  ");
+  for (i = 0; i < cI2C_BENCH_SIZE_NB; i++) {
+    printf(" %u B %u/%u/%u", l_psPaths[i].u16_size, l_psPaths[i].u32_hal_poll_cycles,
+           l_psPaths[i].u32_hal_dma_cycles, l_psPaths[i].u32_ll_cycles);
+  }
+  printf(" cycles hal poll/hal dma/register level\n");
+  vHostApp_reportDMABench("i2c dma   ", psI2C_getDMABenchmark(), cI2C_DMA_BENCH_SIZE_NB);
+#ifndef BMP581_NO_SPI
+  vHostApp_reportDMABench("spi dma   ", psSPI_getDMABenchmark(), cSPI_DMA_BENCH_SIZE_NB);
+#endif
+}
+
+/**
+ * @brief Prints the drain cycles and bus transactions per DMA profile
+ *
+ * @param p_pcName the line header
+ * @param p_psResults the results
+ * @param p_u32Nb the number of sizes
+ * @return
+ */
+static void vHostApp_reportDMABench(const char* p_pcName, const sHAL_DMABenchmark_t* p_psResults, uint32_t p_u32Nb) {
+  uint32_t i;
+
+  printf("%s", p_pcName);
+  for (i = 0; i < p_u32Nb; i++) {
+    printf(" %u B %u/%u (%u/%u)", p_psResults[i].u16_size,
+           p_psResults[i].au32_drain_cycles[ceHAL_DMA_PROFILE_SINGLE], p_psResults[i].au32_drain_cycles[ceHAL_DMA_PROFILE_BURST],
+           p_psResults[i].au32_transactions[ceHAL_DMA_PROFILE_SINGLE], p_psResults[i].au32_transactions[ceHAL_DMA_PROFILE_BURST]);
+  }
+  printf(" cycles (transactions) single/burst\n");
+}
+#endif
+
+/**
+ * @brief Parses the command line
+ *
+ * @param p_iArgc the number of arguments
+ * @param p_ppcArgv the arguments
+ * @param p_psConfig the run parameters to update
+ * @return false on an unknown option or a missing value
+ */
+static bool bHostApp_parse(int p_iArgc, char** p_ppcArgv, sHostAppConfig_t* p_psConfig) {
+  uint32_t* l_pu32Value;
+  const char** l_ppcPath;
+  int i;
+
+  for (i = 1; i < p_iArgc; i++) {
+    if (strcmp(p_ppcArgv[i], "--press-trace") == 0) l_ppcPath = &p_psConfig->pc_trace;
+    else if (strcmp(p_ppcArgv[i], "--bus-trace") == 0) l_ppcPath = &p_psConfig->pc_bus_trace;
+    else l_ppcPath = NULL;
+
+    if (l_ppcPath != NULL) {
+      if (i + 1 >= p_iArgc) {
+        return false;
+      }
+      i++;
+      *l_ppcPath = p_ppcArgv[i];
+      continue;
+    }
+
+    if (strcmp(p_ppcArgv[i], "--seconds") == 0) l_pu32Value = &p_psConfig->u32_seconds;
+    else if (strcmp(p_ppcArgv[i], "--seed") == 0) l_pu32Value = &p_psConfig->u32_seed;
+    else if (strcmp(p_ppcArgv[i], "--access-ns") == 0) l_pu32Value = &p_psConfig->u32_access_ns;
+    else if (strcmp(p_ppcArgv[i], "--nack-ppm") == 0) l_pu32Value = &p_psConfig->s_faults.u32_nack_ppm;
+    else if (strcmp(p_ppcArgv[i], "--arb-ppm") == 0) l_pu32Value = &p_psConfig->s_faults.u32_arb_lost_ppm;
+    else if (strcmp(p_ppcArgv[i], "--dma-ppm") == 0) l_pu32Value = &p_psConfig->s_faults.u32_dma_error_ppm;
+    else if (strcmp(p_ppcArgv[i], "--stretch-ppm") == 0) l_pu32Value = &p_psConfig->s_faults.u32_stretch_ppm;
+    else if (strcmp(p_ppcArgv[i], "--stretch-max-us") == 0) l_pu32Value = &p_psConfig->s_faults.u32_stretch_max_us;
+    else if (strcmp(p_ppcArgv[i], "--latency-max-us") == 0) l_pu32Value = &p_psConfig->s_faults.u32_latency_max_us;
+    else if (strcmp(p_ppcArgv[i], "--sda-ppm") == 0) l_pu32Value = &p_psConfig->s_faults.u32_sda_stuck_ppm;
+    else if (strcmp(p_ppcArgv[i], "--noise") == 0) l_pu32Value = &p_psConfig->u32_noise;
+    else if (strcmp(p_ppcArgv[i], "--press-sine-pa") == 0) l_pu32Value = &p_psConfig->u32_sine_pa;
+    else if (strcmp(p_ppcArgv[i], "--press-period-s") == 0) l_pu32Value = &p_psConfig->u32_sine_period_s;
+    else return false;
+
+    if (i + 1 >= p_iArgc) {
+      return false;
+    }
+    i++;
+    *l_pu32Value = (uint32_t)strtoul(p_ppcArgv[i], NULL, 0);
+  }
+
+  return p_psConfig->u32_seconds != 0 && p_psConfig->u32_access_ns != 0;
+}
+
+/**
+ * @brief Sets the pressure signal of the device
+ *
+ * Sea level plus the sinusoid and the trace, which loops over the run.
+ * The temperature stays at the device default.
+ *
+ * @param p_psConfig the run parameters
+ * @return false if the trace file gives no point
+ */
+static bool bHostApp_setSignals(const sHostAppConfig_t* p_psConfig) {
+  sSIM_Signal_t l_sPress;
+
+  vSIM_Signal_constant(&l_sPress, cHOST_APP_SEA_LEVEL);
+  l_sPress.d_amplitude = (double)p_psConfig->u32_sine_pa;
+  l_sPress.d_period_s = (double)p_psConfig->u32_sine_period_s;
+
+  if (p_psConfig->pc_trace != NULL) {
+    l_sPress.u32_trace_nb = u32SIM_Signal_loadTrace(p_psConfig->pc_trace, s_asTrace, cHOST_APP_TRACE_NB);
+    if (l_sPress.u32_trace_nb == 0) {
+      return false;
+    }
+    l_sPress.ps_trace = s_asTrace;
+    l_sPress.b_trace_loop = true;
+  }
+
+  vSIM_BMP581_setSignals(&s_sDevice, &l_sPress, NULL);
+  return true;
+}
+
+/**
+ * @brief Writes the bus trace ring as bmp581_trace reads it
+ *
+ * @param p_pcPath the file
+ * @return false if the file cannot be written or the firmware was built
+ * without BMP581_BUS_TRACE
+ */
+static bool bHostApp_writeBusTrace(const char* p_pcPath) {
+#ifdef HAL_BUS_TRACE
+  FILE* l_pFile = fopen(p_pcPath, "wb");
+  bool l_bResult;
+
+  if (l_pFile == NULL) {
+    return false;
+  }
+
+  l_bResult = fwrite(psHAL_Trace_get(), sizeof(sHAL_TraceBuffer_t), 1, l_pFile) == 1U;
+  return fclose(l_pFile) == 0 && l_bResult;
+#else
+  (void)p_pcPath;
+  fprintf(stderr, "bus trace: built without BMP581_BUS_TRACE\n");
+  return false;
+#endif
+}
+
+/**
+ * @brief Gives the monotonic time
+ *
+ * @return the time in ns
+ */
+static uint64_t u64HostApp_getNs(void) {
+  struct timespec l_sNow;
+
+  clock_gettime(CLOCK_MONOTONIC, &l_sNow);
+  return (uint64_t)l_sNow.tv_sec * 1000000000ULL + (uint64_t)l_sNow.tv_nsec;
+}
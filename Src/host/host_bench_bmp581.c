@@ -0,0 +1,605 @@
+/**
+  ******************************************************************************
+  * @file           : host_bench_bmp581.c
+  * @brief          : Host benchmark suite of the BMP581 driver and of the
+  * acquisition pipeline, to catch performance regressions before the target
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "app/app_bmp581.h"
+#include "app/app_bmp581_regmap.h"
+#include "app/app_bmp581_timing.h"
+#include "app/app_sample_ring.h"
+#include "hal/hal_transfer.h"
+#include "sim/sim_bus.h"
+#include "sim/sim_bmp581.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "host/host_harness.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Struct holding the inputs of a FIFO decode case
+ *
+ */
+typedef struct {
+  eBMP581FIFOSel_t e_frame_sel;
+  uint8_t au8_fifo[BMP581_FIFO_SIZE];
+} sHostBenchFIFO_t;
+
+/**
+ * @brief Struct holding the sensors of an end-to-end case
+ *
+ */
+typedef struct {
+  uint32_t u32_sensors;
+  uint32_t u32_now_us; //Virtual time of the simulated bus
+} sHostBenchPipeline_t;
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_BENCH_SENSOR_MAX  cSIM_BUS_DEVICE_MAX
+#define cHOST_BENCH_CONFIG_NB   4 //Configurations packed in turn
+#define cHOST_BENCH_RATE_NB     8 //Sample rates given in turn to the solver
+#define cHOST_BENCH_RING_BURST  8 //Samples popped at once, like the event loop drain
+#define cHOST_BENCH_CASE_MAX    32
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sODRConfig_t s_asODR[cHOST_BENCH_CONFIG_NB];
+static sOSRConfig_t s_asOSR[cHOST_BENCH_CONFIG_NB];
+static sDSPConfig_t s_asDSP[cHOST_BENCH_CONFIG_NB];
+static sIntConfig_t s_asInt[cHOST_BENCH_CONFIG_NB];
+static sFIFOConfig_t s_asFIFO[cHOST_BENCH_CONFIG_NB];
+static sDriveConfig_t s_asDrive[cHOST_BENCH_CONFIG_NB];
+static sOORConfig_t s_asOOR[cHOST_BENCH_CONFIG_NB];
+static uBMP581Registers_t s_auImages[cHOST_BENCH_CONFIG_NB];
+
+static sHostBenchFIFO_t s_asFIFOInputs[] = {
+  {ceAPP_BMP581_FIFO_TEMP_ONLY, {0}},
+  {ceAPP_BMP581_FIFO_PRESS_ONLY, {0}},
+  {ceAPP_BMP581_FIFO_PRESS_AND_TEMP, {0}},
+};
+
+static sSampleRing_t s_sRing;
+static sHAL_TransferDispatch_t s_sDispatch;
+static sSIM_BMP581_t s_asDevices[cHOST_BENCH_SENSOR_MAX];
+static uint32_t s_u32BusNowUs;
+
+static sHostBenchPipeline_t s_asPipelines[cHOST_BENCH_SENSOR_MAX] = {
+  {1, 0}, {2, 0}, {3, 0}, {4, 0}
+};
+
+static const uint32_t s_au32RatesMHz[cHOST_BENCH_RATE_NB] = {
+  1000U, 5000U, 10000U, 25000U, 50000U, 100000U, 160000U, 240000U
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void vHostBench_setupRegmap(void* p_pvContext);
+static uint32_t u32HostBench_pack(void* p_pvContext, uint32_t p_u32Iterations);
+static uint32_t u32HostBench_unpack(void* p_pvContext, uint32_t p_u32Iterations);
+static void vHostBench_setupFIFO(void* p_pvContext);
+static uint32_t u32HostBench_decodeFIFO(void* p_pvContext, uint32_t p_u32Iterations);
+static uint32_t u32HostBench_solve(void* p_pvContext, uint32_t p_u32Iterations);
+static void vHostBench_setupRing(void* p_pvContext);
+static uint32_t u32HostBench_ringSingle(void* p_pvContext, uint32_t p_u32Iterations);
+static uint32_t u32HostBench_ringBurst(void* p_pvContext, uint32_t p_u32Iterations);
+static void vHostBench_setupBus(void* p_pvContext);
+static uint32_t u32HostBench_busTransfer(void* p_pvContext, uint32_t p_u32Iterations);
+static void vHostBench_setupPipeline(void* p_pvContext);
+static uint32_t u32HostBench_pipeline(void* p_pvContext, uint32_t p_u32Iterations);
+static uint32_t u32HostBench_sampleChecksum(const sBMP581Sample_t* p_psSample);
+static bool bHostBench_parse(int p_iArgc, char** p_ppcArgv, sHostHarnessConfig_t* p_psConfig, bool* p_pbJSON, const char** p_ppcFilter);
+
+/* Cases in report order, names are "<area>/<variant>" */
+static const sHostHarnessCase_t s_asCases[] = {
+  {"regmap/pack", vHostBench_setupRegmap, u32HostBench_pack, NULL, 1000, 1},
+  {"regmap/unpack", vHostBench_setupRegmap, u32HostBench_unpack, NULL, 1000, 1},
+  {"fifo/temp", vHostBench_setupFIFO, u32HostBench_decodeFIFO, &s_asFIFOInputs[0], 100, BMP581_FIFO_SIZE / 3},
+  {"fifo/press", vHostBench_setupFIFO, u32HostBench_decodeFIFO, &s_asFIFOInputs[1], 100, BMP581_FIFO_SIZE / 3},
+  {"fifo/press_temp", vHostBench_setupFIFO, u32HostBench_decodeFIFO, &s_asFIFOInputs[2], 100, BMP581_FIFO_SIZE / 6},
+  {"solver/config", NULL, u32HostBench_solve, NULL, 10, 1},
+  {"ring/single", vHostBench_setupRing, u32HostBench_ringSingle, NULL, 1000, 1},
+  {"ring/burst", vHostBench_setupRing, u32HostBench_ringBurst, NULL, 100, cHOST_BENCH_RING_BURST},
+  {"bus/transfer", vHostBench_setupBus, u32HostBench_busTransfer, NULL, 100, 2},
+  {"pipeline/1_sensor", vHostBench_setupPipeline, u32HostBench_pipeline, &s_asPipelines[0], 100, 1},
+  {"pipeline/2_sensors", vHostBench_setupPipeline, u32HostBench_pipeline, &s_asPipelines[1], 100, 2},
+  {"pipeline/3_sensors", vHostBench_setupPipeline, u32HostBench_pipeline, &s_asPipelines[2], 100, 3},
+  {"pipeline/4_sensors", vHostBench_setupPipeline, u32HostBench_pipeline, &s_asPipelines[3], 100, 4},
+};
+
+#define cHOST_BENCH_CASE_NB (sizeof(s_asCases) / sizeof(s_asCases[0]))
+
+_Static_assert(cHOST_BENCH_CASE_NB <= cHOST_BENCH_CASE_MAX, "cHOST_BENCH_CASE_MAX is too small");
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ *
+ * Times the register pack and unpack, the FIFO decode of each frame mode,
+ * the configuration solver, the sample ring, transfers on the simulated bus
+ * and the forced mode pipeline of 1 to 4 sensors. The BMP581 compensates
+ * its samples on chip, the solver is the heaviest computation the driver
+ * runs. Items are register images, frames, solutions, samples or transfers.
+ *
+ * @param argc the number of arguments
+ * @param argv the arguments, see the usage text
+ * @return 0 on success, 1 on a bad argument or no case selected
+ */
+int main(int argc, char** argv) {
+  sHostHarnessConfig_t l_sConfig = {.u32_warmup = 20, .u32_repetitions = 200};
+  sHostHarnessCase_t l_asSelected[cHOST_BENCH_CASE_MAX];
+  sHostHarnessStats_t l_asStats[cHOST_BENCH_CASE_MAX];
+  const char* l_pcFilter = NULL;
+  bool l_bJSON = false;
+  uint32_t l_u32Count = 0;
+  uint32_t i;
+
+  if (!bHostBench_parse(argc, argv, &l_sConfig, &l_bJSON, &l_pcFilter)) {
+    fprintf(stderr,
+      "usage: %s [--warmup N] [--repetitions N] [--filter TEXT] [--json]\n"
+      "       repetitions are at most %u\n",
+      argv[0], (unsigned int)cHOST_HARNESS_REPETITION_MAX);
+    return 1;
+  }
+
+  for (i = 0; i < cHOST_BENCH_CASE_NB; i++) {
+    if (l_pcFilter == NULL || strstr(s_asCases[i].pc_name, l_pcFilter) != NULL) {
+      l_asSelected[l_u32Count] = s_asCases[i];
+      vHostHarness_run(&l_sConfig, &l_asSelected[l_u32Count], &l_asStats[l_u32Count]);
+      l_u32Count++;
+    }
+  }
+  if (l_u32Count == 0) {
+    fprintf(stderr, "no case matches \"%s\"\n", l_pcFilter);
+    return 1;
+  }
+
+  if (l_bJSON) {
+    vHostHarness_printJSON(stdout, &l_sConfig, l_asSelected, l_asStats, l_u32Count);
+  }
+  else {
+    vHostHarness_printTable(stdout, l_asSelected, l_asStats, l_u32Count);
+  }
+
+  return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Fills the configurations packed in turn and their images
+ *
+ * @param p_pvContext unused
+ * @return
+ */
+static void vHostBench_setupRegmap(void* p_pvContext) {
+  uint32_t i;
+
+  (void)p_pvContext;
+  memset(s_auImages, 0, sizeof(s_auImages));
+  for (i = 0; i < cHOST_BENCH_CONFIG_NB; i++) {
+    s_asODR[i] = (sODRConfig_t){(eBMP581PwrMode_t)(i % 4), (eBMP581ODR_t)(i * 7), (i & 1) != 0};
+    s_asOSR[i] = (sOSRConfig_t){(eBMP581OSR_t)i, (eBMP581OSR_t)(7 - i), (i & 1) != 0};
+    memset(&s_asDSP[i], (int)(i & 1), sizeof(s_asDSP[i]));
+    s_asDSP[i].e_set_iir_t = (eBMP581IRRFilter_t)i;
+    s_asDSP[i].e_set_iir_p = (eBMP581IRRFilter_t)(7 - i);
+    memset(&s_asInt[i], (int)((i >> 1) & 1), sizeof(s_asInt[i]));
+    memset(&s_asFIFO[i], 0, sizeof(s_asFIFO[i]));
+    s_asFIFO[i].e_fifo_frame_sel = (eBMP581FIFOSel_t)(i % 4);
+    s_asFIFO[i].e_fifo_dec_sel = (eBMP581FIFODec_t)i;
+    memset(&s_asDrive[i], (int)(i & 1), sizeof(s_asDrive[i]));
+    memset(&s_asOOR[i], 0, sizeof(s_asOOR[i]));
+    s_asOOR[i].u8_oor_thr_p_15_8 = (uint8_t)(0x6FU + i);
+    s_asOOR[i].u8_oor_thr_p_7_0 = (uint8_t)(0x30U * i);
+    s_asOOR[i].u8_oor_range_p = (uint8_t)(16U << i);
+
+    s_auImages[i].s_regs.u_odr_config = uAPP_BMP581_packODRConfig(&s_asODR[i]);
+    s_auImages[i].s_regs.u_osr_config = uAPP_BMP581_packOSRConfig(&s_asOSR[i]);
+    s_auImages[i].s_regs.s_dsp = sAPP_BMP581_packDSPConfig(&s_asDSP[i]);
+    s_auImages[i].s_regs.s_int = sAPP_BMP581_packIntConfig(&s_asInt[i]);
+    s_auImages[i].s_regs.u_drive_config = uAPP_BMP581_packDriveConfig(&s_asDrive[i]);
+    s_auImages[i].s_regs.s_oor = sAPP_BMP581_packOORConfig(&s_asOOR[i]);
+    s_auImages[i].s_regs.u_status.u8_raw = (uint8_t)(0x02U << i);
+    s_auImages[i].s_regs.u_int_status.u8_raw = (uint8_t)(0x10U >> i);
+  }
+}
+
+/**
+ * @brief Packs every configuration struct into a register image
+ *
+ * @param p_pvContext unused
+ * @param p_u32Iterations the number of images to pack
+ * @return the checksum of the images
+ */
+static uint32_t u32HostBench_pack(void* p_pvContext, uint32_t p_u32Iterations) {
+  uBMP581Registers_t l_uImage;
+  sBMP581FIFORegs_t l_sFIFO;
+  uint32_t l_u32Checksum = 0;
+  uint32_t i;
+
+  (void)p_pvContext;
+  memset(&l_uImage, 0, sizeof(l_uImage));
+  for (i = 0; i < p_u32Iterations; i++) {
+    const uint32_t l_u32Config = i % cHOST_BENCH_CONFIG_NB;
+
+    l_uImage.s_regs.u_odr_config = uAPP_BMP581_packODRConfig(&s_asODR[l_u32Config]);
+    l_uImage.s_regs.u_osr_config = uAPP_BMP581_packOSRConfig(&s_asOSR[l_u32Config]);
+    l_uImage.s_regs.s_dsp = sAPP_BMP581_packDSPConfig(&s_asDSP[l_u32Config]);
+    l_uImage.s_regs.s_int = sAPP_BMP581_packIntConfig(&s_asInt[l_u32Config]);
+    l_sFIFO = sAPP_BMP581_packFIFOConfig(&s_asFIFO[l_u32Config]);
+    l_uImage.s_regs.u_fifo_config = l_sFIFO.u_fifo_config;
+    l_uImage.s_regs.u_fifo_sel = l_sFIFO.u_fifo_sel;
+    l_uImage.s_regs.u_drive_config = uAPP_BMP581_packDriveConfig(&s_asDrive[l_u32Config]);
+    l_uImage.s_regs.s_oor = sAPP_BMP581_packOORConfig(&s_asOOR[l_u32Config]);
+
+    l_u32Checksum += l_uImage.s_regs.u_odr_config.u8_raw + l_uImage.s_regs.u_osr_config.u8_raw +
+      l_uImage.s_regs.u_fifo_sel.u8_raw + l_uImage.s_regs.u_drive_config.u8_raw;
+  }
+
+  return l_u32Checksum;
+}
+
+/**
+ * @brief Unpacks every configuration and status register of an image
+ *
+ * @param p_pvContext unused
+ * @param p_u32Iterations the number of images to unpack
+ * @return the checksum of the structs
+ */
+static uint32_t u32HostBench_unpack(void* p_pvContext, uint32_t p_u32Iterations) {
+  sODRConfig_t l_sODR;
+  sOSRConfig_t l_sOSR;
+  sDSPConfig_t l_sDSP;
+  sIntConfig_t l_sInt;
+  sFIFOConfig_t l_sFIFO;
+  sDriveConfig_t l_sDrive;
+  sOORConfig_t l_sOOR;
+  sStatus_t l_sStatus;
+  sIntStatus_t l_sIntStatus;
+  sBMP581FIFORegs_t l_sFIFORegs;
+  uint32_t l_u32Checksum = 0;
+  uint32_t i;
+
+  (void)p_pvContext;
+  for (i = 0; i < p_u32Iterations; i++) {
+    const uBMP581Registers_t* l_puImage = &s_auImages[i % cHOST_BENCH_CONFIG_NB];
+
+    vAPP_BMP581_unpackODRConfig(l_puImage->s_regs.u_odr_config, &l_sODR);
+    vAPP_BMP581_unpackOSRConfig(l_puImage->s_regs.u_osr_config, &l_sOSR);
+    vAPP_BMP581_unpackDSPConfig(&l_puImage->s_regs.s_dsp, &l_sDSP);
+    vAPP_BMP581_unpackIntConfig(&l_puImage->s_regs.s_int, &l_sInt);
+    l_sFIFORegs.u_fifo_config = l_puImage->s_regs.u_fifo_config;
+    l_sFIFORegs.u_fifo_sel = l_puImage->s_regs.u_fifo_sel;
+    vAPP_BMP581_unpackFIFOConfig(&l_sFIFORegs, &l_sFIFO);
+    vAPP_BMP581_unpackDriveConfig(l_puImage->s_regs.u_drive_config, &l_sDrive);
+    vAPP_BMP581_unpackOORConfig(&l_puImage->s_regs.s_oor, &l_sOOR);
+    vAPP_BMP581_unpackStatus(l_puImage->s_regs.u_status, &l_sStatus);
+    vAPP_BMP581_unpackIntStatus(l_puImage->s_regs.u_int_status, &l_sIntStatus);
+
+    l_u32Checksum += (uint32_t)l_sODR.e_odr + (uint32_t)l_sOSR.e_osr_p + (uint32_t)l_sDSP.e_set_iir_p +
+      (uint32_t)l_sFIFO.e_fifo_dec_sel + l_sOOR.u8_oor_thr_p_15_8 + (uint32_t)l_sStatus.b_status_nvm_rdy +
+      (uint32_t)l_sIntStatus.b_por;
+  }
+
+  return l_u32Checksum;
+}
+
+/**
+ * @brief Fills a FIFO read with full frames of varying values
+ *
+ * @param p_pvContext the FIFO case
+ * @return
+ */
+static void vHostBench_setupFIFO(void* p_pvContext) {
+  sHostBenchFIFO_t* l_psFIFO = (sHostBenchFIFO_t*)p_pvContext;
+  uint32_t l_u32State = 0x2545F491U;
+  uint32_t i;
+
+  for (i = 0; i < BMP581_FIFO_SIZE; i++) {
+    /* Numerical Recipes LCG, 0x7F bytes are avoided so no frame reads empty */
+    l_u32State = l_u32State * 1664525U + 1013904223U;
+    l_psFIFO->au8_fifo[i] = (uint8_t)((l_u32State >> 24) & 0x7EU);
+  }
+}
+
+/**
+ * @brief Decodes a full FIFO read
+ *
+ * @param p_pvContext the FIFO case
+ * @param p_u32Iterations the number of FIFO reads to decode
+ * @return the checksum of the samples
+ */
+static uint32_t u32HostBench_decodeFIFO(void* p_pvContext, uint32_t p_u32Iterations) {
+  const sHostBenchFIFO_t* l_psFIFO = (const sHostBenchFIFO_t*)p_pvContext;
+  sBMP581Sample_t l_asSamples[BMP581_FIFO_SIZE / 3];
+  uint32_t l_u32Checksum = 0;
+  uint32_t l_u32Count;
+  uint32_t i;
+  uint32_t j;
+
+  for (i = 0; i < p_u32Iterations; i++) {
+    l_u32Count = u32APP_BMP581_unpackFIFO(
+      l_psFIFO->au8_fifo, BMP581_FIFO_SIZE, l_psFIFO->e_frame_sel,
+      l_asSamples, sizeof(l_asSamples) / sizeof(l_asSamples[0])
+    );
+    for (j = 0; j < l_u32Count; j++) {
+      l_u32Checksum += u32HostBench_sampleChecksum(&l_asSamples[j]);
+    }
+  }
+
+  return l_u32Checksum;
+}
+
+/**
+ * @brief Solves configurations for a range of rates and noise budgets
+ *
+ * @param p_pvContext unused
+ * @param p_u32Iterations the number of solutions
+ * @return the checksum of the solutions
+ */
+static uint32_t u32HostBench_solve(void* p_pvContext, uint32_t p_u32Iterations) {
+  sBMP581Requirements_t l_sRequirements;
+  sBMP581Solution_t l_sSolution;
+  uint32_t l_u32Checksum = 0;
+  uint32_t i;
+
+  (void)p_pvContext;
+  l_sRequirements.u32_current_na = UINT32_MAX;
+  for (i = 0; i < p_u32Iterations; i++) {
+    l_sRequirements.u32_rate_mhz = s_au32RatesMHz[i % cHOST_BENCH_RATE_NB];
+    l_sRequirements.u32_noise_mpa = 50U + (i / cHOST_BENCH_RATE_NB) % 32U * 25U;
+    if (errAPP_BMP581_solveConfig(&l_sRequirements, &l_sSolution) == ceAPP_BMP581_OK) {
+      l_u32Checksum += l_sSolution.u32_current_na + (uint32_t)l_sSolution.e_odr;
+    }
+  }
+
+  return l_u32Checksum;
+}
+
+/**
+ * @brief Empties the sample ring
+ *
+ * @param p_pvContext unused
+ * @return
+ */
+static void vHostBench_setupRing(void* p_pvContext) {
+  (void)p_pvContext;
+  vAPP_SampleRing_init(&s_sRing);
+}
+
+/**
+ * @brief Pushes then pops one sample
+ *
+ * @param p_pvContext unused
+ * @param p_u32Iterations the number of samples
+ * @return the checksum of the samples popped
+ */
+static uint32_t u32HostBench_ringSingle(void* p_pvContext, uint32_t p_u32Iterations) {
+  sBMP581Sample_t l_sSample = {0};
+  uint32_t l_u32Checksum = 0;
+  uint32_t i;
+
+  (void)p_pvContext;
+  for (i = 0; i < p_u32Iterations; i++) {
+    l_sSample.u32_timestamp_ms = i;
+    (void)bAPP_SampleRing_push(&s_sRing, &l_sSample);
+    if (bAPP_SampleRing_pop(&s_sRing, &l_sSample)) {
+      l_u32Checksum += l_sSample.u32_timestamp_ms;
+    }
+  }
+
+  return l_u32Checksum;
+}
+
+/**
+ * @brief Pushes a burst of samples one by one, as the acquisition
+ * interrupt does, then pops it at once, as the event loop does
+ *
+ * @param p_pvContext unused
+ * @param p_u32Iterations the number of bursts
+ * @return the checksum of the samples popped
+ */
+static uint32_t u32HostBench_ringBurst(void* p_pvContext, uint32_t p_u32Iterations) {
+  sBMP581Sample_t l_asSamples[cHOST_BENCH_RING_BURST];
+  sBMP581Sample_t l_sSample = {0};
+  uint32_t l_u32Checksum = 0;
+  uint32_t l_u32Popped;
+  uint32_t i;
+  uint32_t j;
+
+  (void)p_pvContext;
+  for (i = 0; i < p_u32Iterations; i++) {
+    for (j = 0; j < cHOST_BENCH_RING_BURST; j++) {
+      l_sSample.u32_timestamp_ms = i + j;
+      (void)bAPP_SampleRing_push(&s_sRing, &l_sSample);
+    }
+    l_u32Popped = u32APP_SampleRing_popBulk(&s_sRing, l_asSamples, cHOST_BENCH_RING_BURST);
+    for (j = 0; j < l_u32Popped; j++) {
+      l_u32Checksum += l_asSamples[j].u32_timestamp_ms;
+    }
+  }
+
+  return l_u32Checksum;
+}
+
+/**
+ * @brief Attaches one fault free simulated BMP581 with a dispatcher
+ *
+ * @param p_pvContext unused
+ * @return
+ */
+static void vHostBench_setupBus(void* p_pvContext) {
+  (void)p_pvContext;
+  vSIM_Bus_init(1);
+  vSIM_BMP581_init(&s_asDevices[0]);
+  (void)bSIM_BMP581_attach(&s_asDevices[0], BMP581_I2C_ADDR_PRIM);
+  vHAL_Transfer_init(&s_sDispatch);
+  s_u32BusNowUs = 0;
+}
+
+/**
+ * @brief Runs the two transfers of a forced measurement on the simulated
+ * bus, each picked a mode by the dispatcher as on the target
+ *
+ * @param p_pvContext unused
+ * @param p_u32Iterations the number of transfer pairs
+ * @return the checksum of the data read
+ */
+static uint32_t u32HostBench_busTransfer(void* p_pvContext, uint32_t p_u32Iterations) {
+  uint8_t l_au8Data[BMP581_DATA_SIZE];
+  uint8_t l_u8ODRConfig = APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_FORCED);
+  uint32_t l_u32Checksum = 0;
+  uint32_t l_u32DurationUs;
+  uint32_t i;
+
+  (void)p_pvContext;
+  for (i = 0; i < p_u32Iterations; i++) {
+    (void)eHAL_Transfer_select(&s_sDispatch, sizeof(l_u8ODRConfig));
+    if (eSIM_Bus_memWrite(BMP581_I2C_ADDR_PRIM, cAPP_BMP581_REG_ODR_CONFIG, &l_u8ODRConfig, sizeof(l_u8ODRConfig), s_u32BusNowUs, &l_u32DurationUs) == ceSIM_BUS_OK) {
+      l_u32Checksum++;
+    }
+    s_u32BusNowUs += l_u32DurationUs;
+
+    (void)eHAL_Transfer_select(&s_sDispatch, sizeof(l_au8Data));
+    if (eSIM_Bus_memRead(BMP581_I2C_ADDR_PRIM, cAPP_BMP581_REG_TEMP_DATA_XLSB, l_au8Data, sizeof(l_au8Data), s_u32BusNowUs, &l_u32DurationUs) == ceSIM_BUS_OK) {
+      l_u32Checksum += l_au8Data[5];
+    }
+    s_u32BusNowUs += l_u32DurationUs;
+  }
+
+  return l_u32Checksum;
+}
+
+/**
+ * @brief Attaches the simulated sensors of a pipeline and configures them
+ *
+ * The BMP581 only has two addresses, the others stand for sensors behind
+ * a second bus or a multiplexer, at the same bus cost.
+ *
+ * @param p_pvContext the pipeline
+ * @return
+ */
+static void vHostBench_setupPipeline(void* p_pvContext) {
+  sHostBenchPipeline_t* l_psPipeline = (sHostBenchPipeline_t*)p_pvContext;
+  const sOSRConfig_t l_sOSRConfig = {ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_16, true};
+  const uint8_t l_u8OSRConfig = uAPP_BMP581_packOSRConfig(&l_sOSRConfig).u8_raw;
+  uint32_t l_u32DurationUs;
+  uint32_t k;
+
+  vSIM_Bus_init(1);
+  l_psPipeline->u32_now_us = 0;
+  for (k = 0; k < l_psPipeline->u32_sensors; k++) {
+    vSIM_BMP581_init(&s_asDevices[k]);
+    vSIM_BMP581_setEnvironment(&s_asDevices[k], 101325U * 64U + k, (int32_t)(25 * 65536 + k));
+    (void)bSIM_BMP581_attach(&s_asDevices[k], (uint8_t)(BMP581_I2C_ADDR_PRIM + k));
+    (void)eSIM_Bus_memWrite((uint8_t)(BMP581_I2C_ADDR_PRIM + k), cAPP_BMP581_REG_OSR_CONFIG, &l_u8OSRConfig, 1, l_psPipeline->u32_now_us, &l_u32DurationUs);
+    l_psPipeline->u32_now_us += l_u32DurationUs;
+  }
+  vAPP_SampleRing_init(&s_sRing);
+}
+
+/**
+ * @brief Runs forced measurement rounds over every sensor of a pipeline
+ *
+ * A round triggers each sensor, waits the conversion time in virtual time,
+ * reads and decodes each sample, pushes it in the ring and drains the ring.
+ *
+ * @param p_pvContext the pipeline
+ * @param p_u32Iterations the number of rounds
+ * @return the checksum of the samples drained
+ */
+static uint32_t u32HostBench_pipeline(void* p_pvContext, uint32_t p_u32Iterations) {
+  sHostBenchPipeline_t* l_psPipeline = (sHostBenchPipeline_t*)p_pvContext;
+  const uint8_t l_u8ODRConfig = APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_FORCED);
+  const uint32_t l_u32ConversionUs = u32APP_BMP581_getConversionTimeUs(ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_16, true);
+  sBMP581Sample_t l_asSamples[cHOST_BENCH_SENSOR_MAX];
+  uint8_t l_au8Data[BMP581_DATA_SIZE];
+  sBMP581Sample_t l_sSample;
+  uint32_t l_u32Checksum = 0;
+  uint32_t l_u32DurationUs;
+  uint32_t l_u32Popped;
+  uint32_t i;
+  uint32_t k;
+
+  for (i = 0; i < p_u32Iterations; i++) {
+    for (k = 0; k < l_psPipeline->u32_sensors; k++) {
+      (void)eSIM_Bus_memWrite((uint8_t)(BMP581_I2C_ADDR_PRIM + k), cAPP_BMP581_REG_ODR_CONFIG, &l_u8ODRConfig, 1, l_psPipeline->u32_now_us, &l_u32DurationUs);
+      l_psPipeline->u32_now_us += l_u32DurationUs;
+    }
+    l_psPipeline->u32_now_us += l_u32ConversionUs;
+
+    for (k = 0; k < l_psPipeline->u32_sensors; k++) {
+      if (eSIM_Bus_memRead((uint8_t)(BMP581_I2C_ADDR_PRIM + k), cAPP_BMP581_REG_TEMP_DATA_XLSB, l_au8Data, sizeof(l_au8Data), l_psPipeline->u32_now_us, &l_u32DurationUs) == ceSIM_BUS_OK) {
+        vAPP_BMP581_unpackData(l_au8Data, &l_sSample);
+        l_sSample.u32_timestamp_ms = l_psPipeline->u32_now_us / 1000U;
+        (void)bAPP_SampleRing_push(&s_sRing, &l_sSample);
+      }
+      l_psPipeline->u32_now_us += l_u32DurationUs;
+    }
+
+    l_u32Popped = u32APP_SampleRing_popBulk(&s_sRing, l_asSamples, cHOST_BENCH_SENSOR_MAX);
+    for (k = 0; k < l_u32Popped; k++) {
+      l_u32Checksum += u32HostBench_sampleChecksum(&l_asSamples[k]);
+    }
+  }
+
+  return l_u32Checksum;
+}
+
+/**
+ * @brief Folds a sample into a checksum
+ *
+ * @param p_psSample the sample
+ * @return its checksum
+ */
+static uint32_t u32HostBench_sampleChecksum(const sBMP581Sample_t* p_psSample) {
+  return p_psSample->u32_press_raw ^ (uint32_t)p_psSample->s32_temp_raw;
+}
+
+/**
+ * @brief Parses the command line
+ *
+ * @param p_iArgc the number of arguments
+ * @param p_ppcArgv the arguments
+ * @param p_psConfig the warmup and repetitions to update
+ * @param p_pbJSON set if --json is given
+ * @param p_ppcFilter set to the text given with --filter
+ * @return false on a bad argument
+ */
+static bool bHostBench_parse(int p_iArgc, char** p_ppcArgv, sHostHarnessConfig_t* p_psConfig, bool* p_pbJSON, const char** p_ppcFilter) {
+  int i;
+
+  for (i = 1; i < p_iArgc; i++) {
+    if (strcmp(p_ppcArgv[i], "--json") == 0) {
+      *p_pbJSON = true;
+    }
+    else if (i + 1 >= p_iArgc) {
+      return false;
+    }
+    else if (strcmp(p_ppcArgv[i], "--warmup") == 0) {
+      p_psConfig->u32_warmup = (uint32_t)strtoul(p_ppcArgv[++i], NULL, 0);
+    }
+    else if (strcmp(p_ppcArgv[i], "--repetitions") == 0) {
+      p_psConfig->u32_repetitions = (uint32_t)strtoul(p_ppcArgv[++i], NULL, 0);
+    }
+    else if (strcmp(p_ppcArgv[i], "--filter") == 0) {
+      *p_ppcFilter = p_ppcArgv[++i];
+    }
+    else {
+      return false;
+    }
+  }
+
+  return p_psConfig->u32_repetitions != 0 && p_psConfig->u32_repetitions <= cHOST_HARNESS_REPETITION_MAX;
+}
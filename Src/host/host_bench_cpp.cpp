@@ -0,0 +1,97 @@
+/**
+  ******************************************************************************
+  * @file           : host_bench_cpp.cpp
+  * @brief          : BMP581 driver path of the host driver benchmark going
+  * through the C++ bus policies
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <string.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "app/app_bmp581.hpp"
+#include "sim/sim_bus_policy.hpp"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "host/host_bench.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Bus policy on the RAM register file, as the RAM ops table
+ * 
+ */
+struct RamBusPolicy {
+  static bool bRead(uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+    memcpy(p_pu8Data, &g_au8HostBenchRam[p_u8Register], p_u16Size);
+    return true;
+  }
+
+  static bool bWrite(uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+    /* CMD is not stored, a soft reset would clear the register file */
+    if (p_u8Register != cAPP_BMP581_REG_CMD) {
+      memcpy(&g_au8HostBenchRam[p_u8Register], p_pu8Data, p_u16Size);
+    }
+    return true;
+  }
+
+  static void vDelayUs(uint32_t p_u32Us) {
+    s_u32NowUs += p_u32Us;
+  }
+
+  static uint32_t u32NowMs() {
+    return s_u32NowUs / 1000;
+  }
+
+  static uint32_t s_u32NowUs; //Virtual time
+};
+
+uint32_t RamBusPolicy::s_u32NowUs = 0;
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static Bmp581<RamBusPolicy> s_ramDevice;
+static Bmp581<SimBusPolicy<cHOST_BENCH_ADDRESS> > s_simDevice;
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Checks the chip, soft resets it and writes the oversampling
+ * 
+ * @param p_eBus the bus
+ * @param p_sOSRConfig the oversampling of the measurements
+ * @return ceAPP_BMP581_ERR_BUS if a transfer failed,
+ * ceAPP_BMP581_ERR_DEVICE if the chip is not a ready BMP581
+ */
+eBMP581Err_t errHostBench_cppInit(eHostBenchBus_t p_eBus, sOSRConfig_t p_sOSRConfig) {
+  eBMP581Err_t l_eError;
+
+  if (p_eBus == ceHOST_BENCH_BUS_RAM) {
+    l_eError = s_ramDevice.errInit();
+    return l_eError != ceAPP_BMP581_OK ? l_eError : s_ramDevice.errConfigureOSR(p_sOSRConfig);
+  }
+  l_eError = s_simDevice.errInit();
+  return l_eError != ceAPP_BMP581_OK ? l_eError : s_simDevice.errConfigureOSR(p_sOSRConfig);
+}
+
+/**
+ * @brief Runs one forced mode conversion and reads its result
+ * 
+ * @param p_eBus the bus
+ * @param p_psSample the sample to fill
+ * @return ceAPP_BMP581_ERR_BUS if a transfer failed
+ */
+eBMP581Err_t errHostBench_cppMeasure(eHostBenchBus_t p_eBus, sBMP581Sample_t* p_psSample) {
+  if (p_eBus == ceHOST_BENCH_BUS_RAM) {
+    return s_ramDevice.errMeasureForced(*p_psSample);
+  }
+  return s_simDevice.errMeasureForced(*p_psSample);
+}
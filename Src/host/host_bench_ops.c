@@ -0,0 +1,309 @@
+/**
+  ******************************************************************************
+  * @file           : host_bench_ops.c
+  * @brief          : BMP581 driver path of the host driver benchmark going
+  * through a C bus ops table
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <string.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "app/app_bmp581.h"
+#include "app/app_bmp581_regmap.h"
+#include "app/app_bmp581_timing.h"
+#include "sim/sim_bus.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "host/host_bench.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+uint8_t g_au8HostBenchRam[cHOST_BENCH_RAM_NB];
+
+static uint32_t s_u32RamNowUs = 0;
+static uint32_t s_u32SimNowUs = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+static bool bHostBench_ramRead(void* p_pvBus, uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size);
+static bool bHostBench_ramWrite(void* p_pvBus, uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size);
+static bool bHostBench_simRead(void* p_pvBus, uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size);
+static bool bHostBench_simWrite(void* p_pvBus, uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size);
+static void vHostBench_delayUs(void* p_pvBus, uint32_t p_u32Us);
+static uint32_t u32HostBench_nowMs(void* p_pvBus);
+static eBMP581Err_t errHostBench_opsRead(const sHostBenchBusOps_t* p_psOps, uBMP581Registers_t* p_puRegisters, uint8_t p_u8Register, uint16_t p_u16Size);
+static eBMP581Err_t errHostBench_opsWrite(const sHostBenchBusOps_t* p_psOps, uBMP581Registers_t* p_puRegisters, uint8_t p_u8Register, uint16_t p_u16Size);
+
+/* Bus ops tables, s_asOps[eHostBenchBus_t] */
+static const sHostBenchBusOps_t s_asOps[ceHOST_BENCH_BUS_NB] = {
+  [ceHOST_BENCH_BUS_RAM] = {
+    .pf_read = bHostBench_ramRead,
+    .pf_write = bHostBench_ramWrite,
+    .pf_delay_us = vHostBench_delayUs,
+    .pf_now_ms = u32HostBench_nowMs,
+    .pv_bus = &s_u32RamNowUs
+  },
+  [ceHOST_BENCH_BUS_SIM] = {
+    .pf_read = bHostBench_simRead,
+    .pf_write = bHostBench_simWrite,
+    .pf_delay_us = vHostBench_delayUs,
+    .pf_now_ms = u32HostBench_nowMs,
+    .pv_bus = &s_u32SimNowUs
+  },
+};
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Sets the RAM register file as a BMP581 out of reset
+ * 
+ * @return
+ */
+void vHostBench_resetRam(void) {
+  memset(g_au8HostBenchRam, 0, sizeof(g_au8HostBenchRam));
+  g_au8HostBenchRam[cAPP_BMP581_REG_CHIP_ID] = BMP581_I2C_CHIP_ID;
+  g_au8HostBenchRam[cAPP_BMP581_REG_REV_ID] = BMP581_I2C_REV_ID;
+  g_au8HostBenchRam[cAPP_BMP581_REG_STATUS] = APP_BMP581_SET(STATUS, NVM_RDY, 1);
+  g_au8HostBenchRam[cAPP_BMP581_REG_INT_STATUS] = APP_BMP581_SET(INT_STATUS, POR, 1);
+  /* 25 degrees Celsius and 101325 Pa */
+  g_au8HostBenchRam[cAPP_BMP581_REG_TEMP_DATA_XLSB + 1] = 0x00;
+  g_au8HostBenchRam[cAPP_BMP581_REG_TEMP_DATA_XLSB + 2] = 25;
+  g_au8HostBenchRam[cAPP_BMP581_REG_TEMP_DATA_XLSB + 3] = (uint8_t)(101325UL * 64);
+  g_au8HostBenchRam[cAPP_BMP581_REG_TEMP_DATA_XLSB + 4] = (uint8_t)((101325UL * 64) >> 8);
+  g_au8HostBenchRam[cAPP_BMP581_REG_TEMP_DATA_XLSB + 5] = (uint8_t)((101325UL * 64) >> 16);
+}
+
+/**
+ * @brief Gives the ops table of a bus
+ * 
+ * @param p_eBus the bus
+ * @return the table
+ */
+const sHostBenchBusOps_t* psHostBench_getOps(eHostBenchBus_t p_eBus) {
+  return &s_asOps[p_eBus];
+}
+
+/**
+ * @brief Checks the chip, soft resets it and writes the oversampling
+ * 
+ * Same sequence as Bmp581::errInit followed by errConfigureOSR.
+ * 
+ * @param p_psOps the bus
+ * @param p_puRegisters the register image of the device
+ * @param p_sOSRConfig the oversampling of the measurements
+ * @return ceAPP_BMP581_ERR_BUS if a transfer failed,
+ * ceAPP_BMP581_ERR_DEVICE if the chip is not a ready BMP581
+ */
+eBMP581Err_t errHostBench_opsInit(const sHostBenchBusOps_t* p_psOps, uBMP581Registers_t* p_puRegisters, sOSRConfig_t p_sOSRConfig) {
+  const uint8_t l_u8Command = BMP581_CMD_SOFT_RESET;
+  eBMP581Err_t l_eError;
+  uint32_t l_u32WaitedUs = 0;
+
+  l_eError = errHostBench_opsRead(p_psOps, p_puRegisters, cAPP_BMP581_REG_CHIP_ID, 2);
+  if (l_eError != ceAPP_BMP581_OK) {
+    return l_eError;
+  }
+  if (
+    p_puRegisters->s_regs.u8_chip_id != BMP581_I2C_CHIP_ID ||
+    p_puRegisters->s_regs.u8_rev_id != BMP581_I2C_REV_ID
+  ) {
+    return ceAPP_BMP581_ERR_DEVICE;
+  }
+
+  l_eError = errHostBench_opsRead(p_psOps, p_puRegisters, cAPP_BMP581_REG_STATUS, 1);
+  if (l_eError != ceAPP_BMP581_OK) {
+    return l_eError;
+  }
+  if (!p_puRegisters->s_regs.u_status.s_bits.NVM_RDY || p_puRegisters->s_regs.u_status.s_bits.NVM_ERR) {
+    return ceAPP_BMP581_ERR_DEVICE;
+  }
+
+  /* CMD is past the register image */
+  if (!p_psOps->pf_write(p_psOps->pv_bus, cAPP_BMP581_REG_CMD, &l_u8Command, 1)) {
+    return ceAPP_BMP581_ERR_BUS;
+  }
+
+  do {
+    p_psOps->pf_delay_us(p_psOps->pv_bus, cAPP_BMP581_POR_US / 2);
+    l_u32WaitedUs += cAPP_BMP581_POR_US / 2;
+    l_eError = errHostBench_opsRead(p_psOps, p_puRegisters, cAPP_BMP581_REG_INT_STATUS, 1);
+  } while (
+    (l_eError != ceAPP_BMP581_OK || !p_puRegisters->s_regs.u_int_status.s_bits.POR) &&
+    l_u32WaitedUs < 4 * cAPP_BMP581_POR_US
+  );
+
+  if (l_eError != ceAPP_BMP581_OK) {
+    return l_eError;
+  }
+  if (!p_puRegisters->s_regs.u_int_status.s_bits.POR) {
+    return ceAPP_BMP581_ERR_DEVICE;
+  }
+
+  p_puRegisters->s_regs.u_osr_config = uAPP_BMP581_packOSRConfig(&p_sOSRConfig);
+  return errHostBench_opsWrite(p_psOps, p_puRegisters, cAPP_BMP581_REG_OSR_CONFIG, 1);
+}
+
+/**
+ * @brief Runs one forced mode conversion and reads its result
+ * 
+ * Same sequence as Bmp581::errMeasureForced.
+ * 
+ * @param p_psOps the bus
+ * @param p_puRegisters the register image of the device
+ * @param p_psSample the sample to fill
+ * @return ceAPP_BMP581_ERR_BUS if a transfer failed
+ */
+eBMP581Err_t errHostBench_opsMeasure(const sHostBenchBusOps_t* p_psOps, uBMP581Registers_t* p_puRegisters, sBMP581Sample_t* p_psSample) {
+  const uBMP581_OSR_CONFIG_t l_uOSRConfig = p_puRegisters->s_regs.u_osr_config;
+  const uint8_t* l_pu8Data = p_puRegisters->s_regs.au8_data;
+  eBMP581Err_t l_eError;
+
+  p_puRegisters->s_regs.u_odr_config.s_bits.PWR_MODE = ceAPP_BMP581_FORCED;
+  l_eError = errHostBench_opsWrite(p_psOps, p_puRegisters, cAPP_BMP581_REG_ODR_CONFIG, 1);
+  if (l_eError != ceAPP_BMP581_OK) {
+    return l_eError;
+  }
+
+  p_psOps->pf_delay_us(p_psOps->pv_bus, u32APP_BMP581_getConversionTimeUs(
+    (eBMP581OSR_t)l_uOSRConfig.s_bits.OSR_T,
+    (eBMP581OSR_t)l_uOSRConfig.s_bits.OSR_P,
+    l_uOSRConfig.s_bits.PRESS_EN
+  ));
+
+  l_eError = errHostBench_opsRead(p_psOps, p_puRegisters, cAPP_BMP581_REG_TEMP_DATA_XLSB, BMP581_DATA_SIZE);
+  if (l_eError != ceAPP_BMP581_OK) {
+    return l_eError;
+  }
+
+  vAPP_BMP581_unpackData(l_pu8Data, p_psSample);
+  p_psSample->u32_timestamp_ms = p_psOps->pf_now_ms(p_psOps->pv_bus);
+  return ceAPP_BMP581_OK;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Reads registers of the device into its image
+ * 
+ * @param p_psOps the bus
+ * @param p_puRegisters the register image of the device
+ * @param p_u8Register the first register
+ * @param p_u16Size the number of registers
+ * @return ceAPP_BMP581_ERR_BUS if the transfer failed
+ */
+static eBMP581Err_t errHostBench_opsRead(const sHostBenchBusOps_t* p_psOps, uBMP581Registers_t* p_puRegisters, uint8_t p_u8Register, uint16_t p_u16Size) {
+  return p_psOps->pf_read(p_psOps->pv_bus, p_u8Register, &p_puRegisters->au8_bytes[p_u8Register], p_u16Size) ?
+    ceAPP_BMP581_OK : ceAPP_BMP581_ERR_BUS;
+}
+
+/**
+ * @brief Writes registers of the device from its image
+ * 
+ * @param p_psOps the bus
+ * @param p_puRegisters the register image of the device
+ * @param p_u8Register the first register
+ * @param p_u16Size the number of registers
+ * @return ceAPP_BMP581_ERR_BUS if the transfer failed
+ */
+static eBMP581Err_t errHostBench_opsWrite(const sHostBenchBusOps_t* p_psOps, uBMP581Registers_t* p_puRegisters, uint8_t p_u8Register, uint16_t p_u16Size) {
+  return p_psOps->pf_write(p_psOps->pv_bus, p_u8Register, &p_puRegisters->au8_bytes[p_u8Register], p_u16Size) ?
+    ceAPP_BMP581_OK : ceAPP_BMP581_ERR_BUS;
+}
+
+/**
+ * @brief Reads the RAM register file
+ * 
+ * @param p_pvBus unused
+ * @param p_u8Register the first register
+ * @param p_pu8Data the bytes read
+ * @param p_u16Size the number of registers
+ * @return true
+ */
+static bool bHostBench_ramRead(void* p_pvBus, uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  (void)p_pvBus;
+  memcpy(p_pu8Data, &g_au8HostBenchRam[p_u8Register], p_u16Size);
+  return true;
+}
+
+/**
+ * @brief Writes the RAM register file
+ * 
+ * @param p_pvBus unused
+ * @param p_u8Register the first register
+ * @param p_pu8Data the bytes to write
+ * @param p_u16Size the number of registers
+ * @return true
+ */
+static bool bHostBench_ramWrite(void* p_pvBus, uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  (void)p_pvBus;
+  /* CMD is not stored, a soft reset would clear the register file */
+  if (p_u8Register != cAPP_BMP581_REG_CMD) {
+    memcpy(&g_au8HostBenchRam[p_u8Register], p_pu8Data, p_u16Size);
+  }
+  return true;
+}
+
+/**
+ * @brief Reads the simulated BMP581
+ * 
+ * @param p_pvBus the virtual time, advanced by the transfer
+ * @param p_u8Register the first register
+ * @param p_pu8Data the bytes read
+ * @param p_u16Size the number of registers
+ * @return false if the transfer faulted
+ */
+static bool bHostBench_simRead(void* p_pvBus, uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  uint32_t* l_pu32NowUs = (uint32_t*)p_pvBus;
+  uint32_t l_u32DurationUs;
+  eSIM_BusResult_t l_eResult = eSIM_Bus_memRead(cHOST_BENCH_ADDRESS, p_u8Register, p_pu8Data, p_u16Size, *l_pu32NowUs, &l_u32DurationUs);
+
+  *l_pu32NowUs += l_u32DurationUs;
+  return l_eResult == ceSIM_BUS_OK;
+}
+
+/**
+ * @brief Writes the simulated BMP581
+ * 
+ * @param p_pvBus the virtual time, advanced by the transfer
+ * @param p_u8Register the first register
+ * @param p_pu8Data the bytes to write
+ * @param p_u16Size the number of registers
+ * @return false if the transfer faulted
+ */
+static bool bHostBench_simWrite(void* p_pvBus, uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  uint32_t* l_pu32NowUs = (uint32_t*)p_pvBus;
+  uint32_t l_u32DurationUs;
+  eSIM_BusResult_t l_eResult = eSIM_Bus_memWrite(cHOST_BENCH_ADDRESS, p_u8Register, p_pu8Data, p_u16Size, *l_pu32NowUs, &l_u32DurationUs);
+
+  *l_pu32NowUs += l_u32DurationUs;
+  return l_eResult == ceSIM_BUS_OK;
+}
+
+/**
+ * @brief Waits in virtual time
+ * 
+ * @param p_pvBus the virtual time to advance
+ * @param p_u32Us the wait
+ * @return
+ */
+static void vHostBench_delayUs(void* p_pvBus, uint32_t p_u32Us) {
+  *(uint32_t*)p_pvBus += p_u32Us;
+}
+
+/**
+ * @brief Gives the virtual time
+ * 
+ * @param p_pvBus the virtual time
+ * @return the virtual time in ms
+ */
+static uint32_t u32HostBench_nowMs(void* p_pvBus) {
+  return *(uint32_t*)p_pvBus / 1000;
+}
@@ -0,0 +1,216 @@
+/**
+  ******************************************************************************
+  * @file           : host_driver_bench.c
+  * @brief          : Host benchmark of the cost per sample of the BMP581
+  * driver through a C bus ops table and through the C++ bus policies
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "app/app_bmp581.h"
+#include "sim/sim_bus.h"
+#include "sim/sim_bmp581.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "host/host_bench.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Enumeration defining the driver paths compared
+ * 
+ */
+typedef enum {
+  ceHOST_BENCH_PATH_OPS = 0, //C driver calling the bus through an ops table
+  ceHOST_BENCH_PATH_CPP,     //Bmp581<BusPolicy>, bus calls resolved at compile time
+  ceHOST_BENCH_PATH_NB,
+} eHostBenchPath_t;
+
+/**
+ * @brief Struct holding the outcome of one run
+ * 
+ */
+typedef struct {
+  uint64_t u64_ns;
+  uint64_t u64_cycles;   //0 when the host has no cycle counter
+  uint64_t u64_checksum; //Sum of the samples, equal for both paths
+  uint32_t u32_failed;
+} sHostBenchResult_t;
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_BENCH_WARMUP 1000 //Samples run before the measurement
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sSIM_BMP581_t s_sDevice;
+static uBMP581Registers_t s_uRegisters;
+
+static const char* const s_apcBusNames[ceHOST_BENCH_BUS_NB] = {"ram", "sim-i2c"};
+static const char* const s_apcPathNames[ceHOST_BENCH_PATH_NB] = {"c-ops", "cpp-policy"};
+
+/* Private function prototypes -----------------------------------------------*/
+static bool bHostBench_run(eHostBenchBus_t p_eBus, eHostBenchPath_t p_ePath, uint32_t p_u32Samples, sHostBenchResult_t* p_psResult);
+static eBMP581Err_t errHostBench_measure(eHostBenchBus_t p_eBus, eHostBenchPath_t p_ePath, sBMP581Sample_t* p_psSample);
+static uint64_t u64HostBench_getNs(void);
+static uint64_t u64HostBench_getCycles(void);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ * 
+ * The code size of both paths is given by the bmp581_driver_size target.
+ * 
+ * @param argc the number of arguments
+ * @param argv the arguments, see the usage text
+ * @return 0 on success, 1 on a bad argument or a failed run
+ */
+int main(int argc, char** argv) {
+  sHostBenchResult_t l_asResults[ceHOST_BENCH_PATH_NB];
+  uint32_t l_u32Samples = 100000;
+  bool l_bSuccess = true;
+  uint32_t l_u32Bus;
+  uint32_t l_u32Path;
+
+  if (argc == 3 && strcmp(argv[1], "--samples") == 0) {
+    l_u32Samples = (uint32_t)strtoul(argv[2], NULL, 0);
+  }
+  else if (argc != 1) {
+    l_u32Samples = 0;
+  }
+  if (l_u32Samples == 0) {
+    fprintf(stderr, "usage: %s [--samples N]\n", argv[0]);
+    return 1;
+  }
+
+  printf("%-8s %-11s %10s %12s %18s\n", "bus", "path", "ns/sample", "cycles/sample", "checksum");
+  for (l_u32Bus = 0; l_u32Bus < ceHOST_BENCH_BUS_NB; l_u32Bus++) {
+    for (l_u32Path = 0; l_u32Path < ceHOST_BENCH_PATH_NB; l_u32Path++) {
+      if (!bHostBench_run((eHostBenchBus_t)l_u32Bus, (eHostBenchPath_t)l_u32Path, l_u32Samples, &l_asResults[l_u32Path])) {
+        printf("%-8s %-11s initialisation failed\n", s_apcBusNames[l_u32Bus], s_apcPathNames[l_u32Path]);
+        l_bSuccess = false;
+        continue;
+      }
+      printf("%-8s %-11s %10.1f %12.1f %18llu\n",
+        s_apcBusNames[l_u32Bus], s_apcPathNames[l_u32Path],
+        (double)l_asResults[l_u32Path].u64_ns / l_u32Samples,
+        (double)l_asResults[l_u32Path].u64_cycles / l_u32Samples,
+        (unsigned long long)l_asResults[l_u32Path].u64_checksum);
+      l_bSuccess = l_bSuccess && l_asResults[l_u32Path].u32_failed == 0;
+    }
+    if (l_asResults[ceHOST_BENCH_PATH_OPS].u64_checksum != l_asResults[ceHOST_BENCH_PATH_CPP].u64_checksum) {
+      printf("%-8s the paths read different samples\n", s_apcBusNames[l_u32Bus]);
+      l_bSuccess = false;
+    }
+  }
+
+  return l_bSuccess ? 0 : 1;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Initialises the device on a bus then times forced measurements
+ * 
+ * @param p_eBus the bus
+ * @param p_ePath the driver path
+ * @param p_u32Samples the number of measurements timed
+ * @param p_psResult the outcome
+ * @return false if the initialisation failed
+ */
+static bool bHostBench_run(eHostBenchBus_t p_eBus, eHostBenchPath_t p_ePath, uint32_t p_u32Samples, sHostBenchResult_t* p_psResult) {
+  const sOSRConfig_t l_sOSRConfig = {ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_16, true};
+  sBMP581Sample_t l_sSample;
+  eBMP581Err_t l_eError;
+  uint64_t l_u64StartNs;
+  uint64_t l_u64StartCycles;
+  uint32_t k;
+
+  memset(p_psResult, 0, sizeof(*p_psResult));
+
+  vHostBench_resetRam();
+  vSIM_Bus_init(1);
+  vSIM_BMP581_init(&s_sDevice);
+  (void)bSIM_BMP581_attach(&s_sDevice, cHOST_BENCH_ADDRESS);
+  memset(&s_uRegisters, 0, sizeof(s_uRegisters));
+
+  if (p_ePath == ceHOST_BENCH_PATH_OPS) {
+    l_eError = errHostBench_opsInit(psHostBench_getOps(p_eBus), &s_uRegisters, l_sOSRConfig);
+  }
+  else {
+    l_eError = errHostBench_cppInit(p_eBus, l_sOSRConfig);
+  }
+  if (l_eError != ceAPP_BMP581_OK) {
+    return false;
+  }
+
+  for (k = 0; k < cHOST_BENCH_WARMUP; k++) {
+    (void)errHostBench_measure(p_eBus, p_ePath, &l_sSample);
+  }
+
+  l_u64StartNs = u64HostBench_getNs();
+  l_u64StartCycles = u64HostBench_getCycles();
+  for (k = 0; k < p_u32Samples; k++) {
+    if (errHostBench_measure(p_eBus, p_ePath, &l_sSample) != ceAPP_BMP581_OK) {
+      p_psResult->u32_failed++;
+      continue;
+    }
+    p_psResult->u64_checksum += l_sSample.u32_press_raw + (uint32_t)l_sSample.s32_temp_raw;
+  }
+  p_psResult->u64_cycles = u64HostBench_getCycles() - l_u64StartCycles;
+  p_psResult->u64_ns = u64HostBench_getNs() - l_u64StartNs;
+
+  return true;
+}
+
+/**
+ * @brief Runs one forced measurement through a driver path
+ * 
+ * @param p_eBus the bus
+ * @param p_ePath the driver path
+ * @param p_psSample the sample to fill
+ * @return the error of the driver
+ */
+static eBMP581Err_t errHostBench_measure(eHostBenchBus_t p_eBus, eHostBenchPath_t p_ePath, sBMP581Sample_t* p_psSample) {
+  if (p_ePath == ceHOST_BENCH_PATH_OPS) {
+    return errHostBench_opsMeasure(psHostBench_getOps(p_eBus), &s_uRegisters, p_psSample);
+  }
+  return errHostBench_cppMeasure(p_eBus, p_psSample);
+}
+
+/**
+ * @brief Gives the monotonic time
+ * 
+ * @return the time in ns
+ */
+static uint64_t u64HostBench_getNs(void) {
+  struct timespec l_sNow;
+
+  clock_gettime(CLOCK_MONOTONIC, &l_sNow);
+  return (uint64_t)l_sNow.tv_sec * 1000000000ULL + (uint64_t)l_sNow.tv_nsec;
+}
+
+/**
+ * @brief Gives the CPU time stamp counter
+ * 
+ * @return the counter, 0 when the host has none
+ */
+static uint64_t u64HostBench_getCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
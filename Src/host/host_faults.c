@@ -0,0 +1,429 @@
+/**
+  ******************************************************************************
+  * @file           : host_faults.c
+  * @brief          : Host benchmark of the forced mode acquisition of the
+  * firmware over the HAL shim and the fault-injecting simulated bus,
+  * reporting throughput, retries and data loss
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "app/app_bmp581.h"
+#include "app/app_event.h"
+#include "hal/hal_nvic.h"
+#include "hal/hal_defer.h"
+#include "hal/hal_sched.h"
+#include "hal/hal_clock.h"
+#include "hal/hal_dwt.h"
+#include "hal/hal_gpio.h"
+#include "hal/hal_dma.h"
+#include "hal/hal_i2c.h"
+#ifndef BMP581_NO_SPI
+#include "hal/hal_spi.h"
+#endif
+#include "hal/hal_tim.h"
+#include "hal/hal_timer.h"
+#include "sim/sim_bus.h"
+#include "sim/sim_bmp581.h"
+#include "host/host_hal.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Struct holding the parameters of one run
+ *
+ */
+typedef struct {
+  uint32_t u32_seed;
+  uint32_t u32_samples;    //Acquisition periods to run
+  uint32_t u32_period_us;
+  sSIM_BusFaults_t s_faults;
+} sHostFaultsConfig_t;
+
+/**
+ * @brief Struct holding the outcome of one run
+ *
+ */
+typedef struct {
+  bool b_started;          //The acquisition ran, faults applied from its first sample
+  uint32_t u32_periods;    //Nominal periods from the first sample to the end
+  uint32_t u32_read;       //Samples read by the main loop
+  uint32_t u32_stale;      //Samples of a conversion already read, its trigger write failed
+  uint32_t u32_bus_events; //ceAPP_EVENT_BUS_ERROR posted by the driver
+  uint32_t u32_gap_max_ms; //Longest time between two samples read
+  uint32_t u32_dropped;
+  uint32_t u32_conversions;
+  sI2CRecoveryStats_t s_recovery;
+  sSIM_BusStats_t s_bus;
+  uint64_t u64_elapsed_ns;
+} sHostFaultsResult_t;
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_FAULTS_ADDRESS  BMP581_I2C_ADDR_PRIM
+#define cHOST_FAULTS_BOOT_US  (uint64_t)2000000 //Boot, calibration and first sample, fault free
+#define cHOST_FAULTS_BATCH    16
+#define cHOST_FAULTS_SWEEP_NB 6
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sSIM_BMP581_t s_sDevice;
+static sHostFaultsConfig_t s_sConfig;
+static sHostFaultsResult_t s_sResult;
+static sBMP581Sample_t s_asSamples[cHOST_FAULTS_BATCH];
+static uint64_t s_u64StartNs;
+static uint32_t s_u32LastMs;
+static uint32_t s_u32LastConversions;
+
+/* Fault rate multipliers of the sweep, applied to the configured rates */
+static const uint32_t s_au32SweepScale[cHOST_FAULTS_SWEEP_NB] = {0, 1, 2, 5, 10, 20};
+
+/* Private function prototypes -----------------------------------------------*/
+static void vHostFaults_run(const sHostFaultsConfig_t* p_psConfig, sHostFaultsResult_t* p_psResult);
+static int iHostFaults_main(void);
+static void vHostFaults_onSensorReady(void);
+static void vHostFaults_onSample(void);
+static void vHostFaults_onBusError(void);
+static void vHostFaults_report(const sHostFaultsConfig_t* p_psConfig, const sHostFaultsResult_t* p_psResult);
+static void vHostFaults_sweep(const sHostFaultsConfig_t* p_psConfig);
+static void vHostFaults_sweepRow(const sHostFaultsConfig_t* p_psConfig, uint32_t p_u32Scale);
+static bool bHostFaults_parse(int p_iArgc, char** p_ppcArgv, sHostFaultsConfig_t* p_psConfig, bool* p_pbSweep);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ *
+ * @param argc the number of arguments
+ * @param argv the arguments, see the usage text
+ * @return 0 on success, 1 on a bad argument or if the acquisition did
+ * not start
+ */
+int main(int argc, char** argv) {
+  sHostFaultsConfig_t l_sConfig = {
+    .u32_seed = 1,
+    .u32_samples = 10000,
+    .u32_period_us = 40000,
+    .s_faults = {
+      .u32_nack_ppm = 1000,
+      .u32_arb_lost_ppm = 500,
+      .u32_dma_error_ppm = 500,
+      .u32_stretch_ppm = 20000,
+      .u32_stretch_max_us = 200,
+      .u32_latency_max_us = 50
+    }
+  };
+  sHostFaultsResult_t l_sResult;
+  bool l_bSweep = false;
+
+  if (!bHostFaults_parse(argc, argv, &l_sConfig, &l_bSweep)) {
+    fprintf(stderr,
+      "usage: %s [--seed N] [--samples N] [--period-us N] [--nack-ppm N] [--arb-ppm N]\n"
+      "          [--dma-ppm N] [--stretch-ppm N] [--stretch-max-us N] [--latency-max-us N] [--sda-ppm N]\n"
+      "          [--sweep]\n",
+      argv[0]);
+    return 1;
+  }
+
+  if (l_bSweep) {
+    vHostFaults_sweep(&l_sConfig);
+    return 0;
+  }
+
+  vHostFaults_run(&l_sConfig, &l_sResult);
+  vHostFaults_report(&l_sConfig, &l_sResult);
+  return l_sResult.b_started ? 0 : 1;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Runs the firmware acquisition in virtual time
+ *
+ * The driver, the I2C queue and its recovery run unmodified over the shim.
+ * The firmware statics are only initialised once, a process runs a
+ * single acquisition.
+ *
+ * @param p_psConfig the run parameters
+ * @param p_psResult the outcome
+ * @return
+ */
+static void vHostFaults_run(const sHostFaultsConfig_t* p_psConfig, sHostFaultsResult_t* p_psResult) {
+  sHostHALConfig_t l_sHALConfig = {
+    .u64_duration_ns = (cHOST_FAULTS_BOOT_US + (uint64_t)p_psConfig->u32_samples * p_psConfig->u32_period_us) * 1000U,
+    .u32_access_ns = cHOST_HAL_ACCESS_NS_DEFAULT,
+  };
+
+  s_sConfig = *p_psConfig;
+  memset(&s_sResult, 0, sizeof(s_sResult));
+
+  vSIM_Bus_init(p_psConfig->u32_seed);
+  vSIM_BMP581_init(&s_sDevice);
+  (void)bSIM_BMP581_attach(&s_sDevice, cHOST_FAULTS_ADDRESS);
+
+  vHostHAL_init(&l_sHALConfig);
+  (void)u64HostHAL_run(iHostFaults_main);
+
+  if (s_sResult.b_started) {
+    s_sResult.u64_elapsed_ns = u64HostHAL_getNowNs() - s_u64StartNs;
+    /* The period of the first sample, then the ones started since */
+    s_sResult.u32_periods = 1U + (uint32_t)(s_sResult.u64_elapsed_ns / ((uint64_t)p_psConfig->u32_period_us * 1000U));
+  }
+  s_sResult.u32_dropped = u32APP_BMP581_getDroppedSamples();
+  s_sResult.u32_conversions = u32SIM_BMP581_getConversions(&s_sDevice);
+  vI2C_getRecoveryStats(&s_sResult.s_recovery);
+  vSIM_Bus_getStats(&s_sResult.s_bus);
+  *p_psResult = s_sResult;
+}
+
+/**
+ * @brief Thread mode of the target, the start sequence and event loop of
+ * the firmware main with the period of the run
+ *
+ * @return 0
+ */
+static int iHostFaults_main(void) {
+  HAL_Init();
+  vHAL_NVIC_init();
+  vHAL_Defer_init();
+  vHAL_Sched_init();
+  vHAL_Clock_init();
+  vHAL_DWT_init();
+  vHAL_GPIO_init();
+  vHAL_DMA_init();
+  vI2C_init();
+#ifndef BMP581_NO_SPI
+  vSPI_init();
+#endif
+  vHAL_TIM_init();
+  vHAL_Timer_init();
+
+  vAPP_Event_init();
+  vAPP_Event_register(ceAPP_EVENT_SAMPLE, vHostFaults_onSample);
+  vAPP_Event_register(ceAPP_EVENT_BUS_ERROR, vHostFaults_onBusError);
+  vAPP_Event_register(ceAPP_EVENT_SENSOR_READY, vHostFaults_onSensorReady);
+
+  vAPP_BMP581_init();
+  vAPP_Event_run();
+
+  return 0;
+}
+
+/**
+ * @brief Calibrates the bus and starts the acquisition as the firmware
+ * main does
+ *
+ * @return
+ */
+static void vHostFaults_onSensorReady(void) {
+  sOSRConfig_t l_sOSRConfig = {
+    .e_osr_t = ceAPP_BMP581_OSR_1,
+    .e_osr_p = ceAPP_BMP581_OSR_16,
+    .b_press_en = true
+  };
+
+  if (!bAPP_BMP581_isReady()) {
+    return;
+  }
+
+  vAPP_BMP581_calibrateBus();
+  (void)errAPP_BMP581_startForced(s_sConfig.u32_period_us, l_sOSRConfig);
+}
+
+/**
+ * @brief Drains the samples, the first one turns the faults on
+ *
+ * A sample is stale when the simulated sensor ran no conversion since the
+ * previous one. The next trigger is a period away, the count seen here is
+ * the one of the sample read.
+ *
+ * @return
+ */
+static void vHostFaults_onSample(void) {
+  uint32_t l_u32Count;
+  uint32_t i;
+
+  do {
+    l_u32Count = u32APP_BMP581_readSamples(s_asSamples, cHOST_FAULTS_BATCH);
+    for (i = 0; i < l_u32Count; i++) {
+      if (!s_sResult.b_started) {
+        /* Configuration is done fault free, only the acquisition is measured */
+        s_sResult.b_started = true;
+        s_u64StartNs = u64HostHAL_getNowNs();
+        vSIM_Bus_setFaults(&s_sConfig.s_faults);
+      }
+      else if (s_asSamples[i].u32_timestamp_ms - s_u32LastMs > s_sResult.u32_gap_max_ms) {
+        s_sResult.u32_gap_max_ms = s_asSamples[i].u32_timestamp_ms - s_u32LastMs;
+      }
+      s_u32LastMs = s_asSamples[i].u32_timestamp_ms;
+      if (u32SIM_BMP581_getConversions(&s_sDevice) == s_u32LastConversions) {
+        s_sResult.u32_stale++;
+      }
+      s_u32LastConversions = u32SIM_BMP581_getConversions(&s_sDevice);
+    }
+    s_sResult.u32_read += l_u32Count;
+  } while (l_u32Count == cHOST_FAULTS_BATCH);
+}
+
+/**
+ * @brief Counts a failed transfer reported by the driver
+ *
+ * @return
+ */
+static void vHostFaults_onBusError(void) {
+  s_sResult.u32_bus_events++;
+}
+
+/**
+ * @brief Prints the outcome of one run
+ *
+ * @param p_psConfig the run parameters
+ * @param p_psResult the outcome
+ * @return
+ */
+static void vHostFaults_report(const sHostFaultsConfig_t* p_psConfig, const sHostFaultsResult_t* p_psResult) {
+  double l_dSeconds = (double)p_psResult->u64_elapsed_ns / 1e9;
+  uint32_t l_u32Good = p_psResult->u32_read - p_psResult->u32_stale;
+  uint32_t l_u32Lost = (p_psResult->u32_periods > l_u32Good) ? p_psResult->u32_periods - l_u32Good : 0U;
+
+  printf("seed %u, %u periods of %u us\n", p_psConfig->u32_seed, p_psConfig->u32_samples, p_psConfig->u32_period_us);
+  printf("faults      nack %u ppm, arb lost %u ppm, dma %u ppm, stretch %u ppm up to %u us, latency up to %u us, sda stuck %u ppm\n",
+         p_psConfig->s_faults.u32_nack_ppm, p_psConfig->s_faults.u32_arb_lost_ppm,
+         p_psConfig->s_faults.u32_dma_error_ppm, p_psConfig->s_faults.u32_stretch_ppm,
+         p_psConfig->s_faults.u32_stretch_max_us, p_psConfig->s_faults.u32_latency_max_us,
+         p_psConfig->s_faults.u32_sda_stuck_ppm);
+  if (!p_psResult->b_started) {
+    printf("acquisition not started, %u conversions, %u bus error events\n",
+           p_psResult->u32_conversions, p_psResult->u32_bus_events);
+    return;
+  }
+  printf("bus         %u transfers, %u nacks, %u arb lost, %u dma errors, %u stretched, %u sda stuck\n",
+         p_psResult->s_bus.u32_transfers, p_psResult->s_bus.u32_nacks, p_psResult->s_bus.u32_arb_lost,
+         p_psResult->s_bus.u32_dma_errors, p_psResult->s_bus.u32_stretches, p_psResult->s_bus.u32_sda_stuck);
+  printf("recovery    %u errors, %u retries, %u abandoned, %u soft resets, %u recoveries, %u bus clears, max %u cycles\n",
+         p_psResult->s_recovery.u32_errors, p_psResult->s_recovery.u32_retries, p_psResult->s_recovery.u32_abandoned,
+         p_psResult->s_recovery.u32_soft_resets, p_psResult->s_recovery.u32_recoveries,
+         p_psResult->s_recovery.u32_bus_clears, p_psResult->s_recovery.u32_max_cycles);
+  printf("samples     %u good, %u lost of %u periods (%u stale, %u dropped by the ring), %u bus error events\n",
+         l_u32Good, l_u32Lost, p_psResult->u32_periods, p_psResult->u32_stale, p_psResult->u32_dropped, p_psResult->u32_bus_events);
+  printf("throughput  %.3f samples/s, %.3f %% of nominal\n",
+         (l_dSeconds > 0.0) ? (double)l_u32Good / l_dSeconds : 0.0,
+         100.0 * (double)l_u32Good / (double)p_psResult->u32_periods);
+  printf("gap         max %u ms between samples, period %u ms\n",
+         p_psResult->u32_gap_max_ms, p_psConfig->u32_period_us / 1000U);
+}
+
+/**
+ * @brief Runs the configured rates scaled by s_au32SweepScale, one line each
+ *
+ * @param p_psConfig the run parameters, the rates are the x1 row
+ * @return
+ */
+static void vHostFaults_sweep(const sHostFaultsConfig_t* p_psConfig) {
+  uint32_t i;
+
+  printf("scale  nack_ppm  arb_ppm  dma_ppm  retries  abandoned  recoveries   good  lost  throughput_%%  gap_max_ms\n");
+
+  for (i = 0; i < cHOST_FAULTS_SWEEP_NB; i++) {
+    vHostFaults_sweepRow(p_psConfig, s_au32SweepScale[i]);
+  }
+}
+
+/**
+ * @brief Runs one row of the sweep in a child process
+ *
+ * The firmware keeps its state in statics, each row starts from reset in
+ * a process of its own. The rows still print in order.
+ *
+ * @param p_psConfig the run parameters, the rates are the x1 row
+ * @param p_u32Scale the fault rate multiplier
+ * @return
+ */
+static void vHostFaults_sweepRow(const sHostFaultsConfig_t* p_psConfig, uint32_t p_u32Scale) {
+  sHostFaultsConfig_t l_sConfig = *p_psConfig;
+  sHostFaultsResult_t l_sResult;
+  uint32_t l_u32Good;
+  pid_t l_iPid;
+
+  l_sConfig.s_faults.u32_nack_ppm *= p_u32Scale;
+  l_sConfig.s_faults.u32_arb_lost_ppm *= p_u32Scale;
+  l_sConfig.s_faults.u32_dma_error_ppm *= p_u32Scale;
+  l_sConfig.s_faults.u32_stretch_ppm *= p_u32Scale;
+  l_sConfig.s_faults.u32_sda_stuck_ppm *= p_u32Scale;
+
+  fflush(stdout);
+  l_iPid = fork();
+  if (l_iPid < 0) {
+    perror("fork");
+    return;
+  }
+  if (l_iPid > 0) {
+    (void)waitpid(l_iPid, NULL, 0);
+    return;
+  }
+
+  vHostFaults_run(&l_sConfig, &l_sResult);
+  l_u32Good = l_sResult.u32_read - l_sResult.u32_stale;
+  printf("%5u  %8u  %7u  %7u  %7u  %9u  %10u  %5u  %4u  %12.3f  %10u\n",
+         p_u32Scale, l_sConfig.s_faults.u32_nack_ppm, l_sConfig.s_faults.u32_arb_lost_ppm,
+         l_sConfig.s_faults.u32_dma_error_ppm, l_sResult.s_recovery.u32_retries, l_sResult.s_recovery.u32_abandoned,
+         l_sResult.s_recovery.u32_recoveries, l_u32Good,
+         (l_sResult.u32_periods > l_u32Good) ? l_sResult.u32_periods - l_u32Good : 0U,
+         (l_sResult.u32_periods != 0U) ? 100.0 * (double)l_u32Good / (double)l_sResult.u32_periods : 0.0,
+         l_sResult.u32_gap_max_ms);
+  fflush(stdout);
+  _exit(0);
+}
+
+/**
+ * @brief Parses the command line
+ *
+ * @param p_iArgc the number of arguments
+ * @param p_ppcArgv the arguments
+ * @param p_psConfig the run parameters to update
+ * @param p_pbSweep set if --sweep is given
+ * @return false on an unknown option or a missing value
+ */
+static bool bHostFaults_parse(int p_iArgc, char** p_ppcArgv, sHostFaultsConfig_t* p_psConfig, bool* p_pbSweep) {
+  uint32_t* l_pu32Value;
+  int i;
+
+  for (i = 1; i < p_iArgc; i++) {
+    if (strcmp(p_ppcArgv[i], "--sweep") == 0) {
+      *p_pbSweep = true;
+      continue;
+    }
+
+    if (strcmp(p_ppcArgv[i], "--seed") == 0) l_pu32Value = &p_psConfig->u32_seed;
+    else if (strcmp(p_ppcArgv[i], "--samples") == 0) l_pu32Value = &p_psConfig->u32_samples;
+    else if (strcmp(p_ppcArgv[i], "--period-us") == 0) l_pu32Value = &p_psConfig->u32_period_us;
+    else if (strcmp(p_ppcArgv[i], "--nack-ppm") == 0) l_pu32Value = &p_psConfig->s_faults.u32_nack_ppm;
+    else if (strcmp(p_ppcArgv[i], "--arb-ppm") == 0) l_pu32Value = &p_psConfig->s_faults.u32_arb_lost_ppm;
+    else if (strcmp(p_ppcArgv[i], "--dma-ppm") == 0) l_pu32Value = &p_psConfig->s_faults.u32_dma_error_ppm;
+    else if (strcmp(p_ppcArgv[i], "--stretch-ppm") == 0) l_pu32Value = &p_psConfig->s_faults.u32_stretch_ppm;
+    else if (strcmp(p_ppcArgv[i], "--stretch-max-us") == 0) l_pu32Value = &p_psConfig->s_faults.u32_stretch_max_us;
+    else if (strcmp(p_ppcArgv[i], "--latency-max-us") == 0) l_pu32Value = &p_psConfig->s_faults.u32_latency_max_us;
+    else if (strcmp(p_ppcArgv[i], "--sda-ppm") == 0) l_pu32Value = &p_psConfig->s_faults.u32_sda_stuck_ppm;
+    else return false;
+
+    if (i + 1 >= p_iArgc) {
+      return false;
+    }
+    i++;
+    *l_pu32Value = (uint32_t)strtoul(p_ppcArgv[i], NULL, 0);
+  }
+
+  return p_psConfig->u32_samples != 0 && p_psConfig->u32_period_us != 0;
+}
@@ -0,0 +1,2711 @@
+/**
+  ******************************************************************************
+  * @file           : host_hal.c
+  * @brief          : Virtual-time models of the STM32H7 core and peripherals
+  * behind the host HAL shim, so the firmware main runs unmodified on Linux
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/**
+ * Time is a 64-bit nanosecond counter that only moves inside the shim:
+ * each register access and HAL call takes u32_access_ns, blocking calls
+ * jump to their end, WFI jumps to the next event. Events (SysTick, TIM2,
+ * TIM5, I2C, SPI, EXTI) sit in fixed slots, the earliest runs first and
+ * ties go to the lowest slot, so a run only depends on its inputs.
+ *
+ * Interrupts go through an NVIC model with the preemption priorities,
+ * PRIMASK and BASEPRI of the firmware. A pending interrupt is delivered at
+ * the next access by calling its handler on the current stack, so a
+ * handler preempts the code exactly at a register access or HAL call.
+ *
+ * The thread-level waits of the firmware read the cycle counter while
+ * they poll a handle State, so the time moves on. A wait touching no
+ * register would see nothing in the shim run, so a CPU time timer checks
+ * that no access happened for a whole period and then moves the time to
+ * the next event. Such a wait takes no virtual time while it spins, hence
+ * the pump keeps the run deterministic. Code that computes for longer
+ * than a period without any access would be taken for such a wait, the
+ * bench suites are therefore not built in the host firmware.
+ */
+
+/* General interfaces --------------------------------------------------------*/
+#include <setjmp.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "sim/sim_bus.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "host/host_hal.h"
+
+/* Private typedef -----------------------------------------------------------*/
+typedef enum {
+  ceHOST_HAL_EVENT_SYSTICK = 0,
+  ceHOST_HAL_EVENT_TIM2,
+  ceHOST_HAL_EVENT_TIM5,
+  ceHOST_HAL_EVENT_I2C,
+  ceHOST_HAL_EVENT_SPI,
+  ceHOST_HAL_EVENT_EXTI,
+  ceHOST_HAL_EVENT_NB
+} eHostHALEvent_t;
+
+/**
+ * @brief Struct holding a general purpose timer model
+ *
+ * The counter is u32_base_count at u64_base_ns plus the ticks since, the
+ * base moves only when the firmware changes the counting.
+ */
+typedef struct {
+  TIM_TypeDef s_regs;       //Firmware view
+  TIM_TypeDef s_seen;       //Firmware view at the last sync, to spot the writes
+  IRQn_Type e_irq;
+  eHostHALEvent_t e_event;
+  uint32_t u32_psc;
+  uint32_t u32_arr;
+  bool b_running;
+  uint64_t u64_base_ns;
+  uint32_t u32_base_count;
+  uint32_t u32_sr;
+  uint32_t u32_raised;      //Flags the armed event raises
+} sHostHALTimer_t;
+
+typedef enum {
+  ceHOST_HAL_LL_IDLE = 0,
+  ceHOST_HAL_LL_TX,         //Waiting for TXDR writes
+  ceHOST_HAL_LL_RESTART,    //Register sent, waiting for the repeated START
+  ceHOST_HAL_LL_RX,         //Handing the read bytes through RXDR
+  ceHOST_HAL_LL_END         //Waiting for STOP
+} eHostHALLLPhase_t;
+
+/**
+ * @brief Struct holding the register-level I2C1 model
+ *
+ * A transfer reaches the simulated bus at its last byte, its flags are
+ * raised when the bus time has passed. A firmware polling for them before
+ * that waits, the time moves to u64_ready_ns.
+ */
+typedef struct {
+  I2C_TypeDef s_regs;
+  eHostHALLLPhase_t e_phase;
+  uint32_t u32_isr;
+  uint8_t u8_address;       //7-bit
+  uint8_t u8_register;
+  bool b_register;
+  bool b_autoend;
+  uint32_t u32_nbytes;
+  uint16_t u16_size;
+  uint16_t u16_index;
+  uint32_t u32_rx_accesses; //Accesses since the byte in RXDR was shown
+  uint32_t u32_depth;       //Nesting the transfer belongs to
+  bool b_pending;
+  uint64_t u64_ready_ns;
+  uint32_t u32_ready_set;
+  uint32_t u32_ready_clear;
+  uint8_t au8_data[cHOST_HAL_I2C_BUFFER_SIZE];
+} sHostHALI2CLL_t;
+
+typedef enum {
+  ceHOST_HAL_XFER_IDLE = 0,
+  ceHOST_HAL_XFER_IT,       //One event per byte
+  ceHOST_HAL_XFER_DMA,      //Stream complete, then STOP
+  ceHOST_HAL_XFER_STOP,
+  ceHOST_HAL_XFER_ERROR
+} eHostHALXferPhase_t;
+
+typedef enum {
+  ceHOST_HAL_MODE_BLOCKING = 0,
+  ceHOST_HAL_MODE_IT,
+  ceHOST_HAL_MODE_DMA
+} eHostHALMode_t;
+
+/**
+ * @brief Struct holding the HAL-level I2C transfer in flight
+ *
+ * The simulated bus runs the whole transfer at its start into au8_data,
+ * the events hand it to the HAL handle over the bus time.
+ */
+typedef struct {
+  I2C_HandleTypeDef* ph_i2c;
+  eHostHALXferPhase_t e_phase;
+  eSIM_BusResult_t e_result;
+  bool b_read;
+  bool b_ev;                //Event flags for HAL_I2C_EV/ER_IRQHandler
+  bool b_er;
+  uint16_t u16_size;
+  uint16_t u16_fired;
+  uint16_t u16_served;
+  uint64_t u64_start_ns;
+  uint64_t u64_end_ns;
+  DMA_HandleTypeDef* ph_dma;
+  uint8_t au8_data[cHOST_HAL_I2C_BUFFER_SIZE];
+} sHostHALI2CXfer_t;
+
+/**
+ * @brief Struct holding the SPI transfer in flight, nothing answers on MISO
+ *
+ */
+typedef struct {
+  SPI_HandleTypeDef* ph_spi;
+  bool b_dma;
+  bool b_done;
+} sHostHALSPIXfer_t;
+
+typedef struct {
+  uint16_t u16_pin;
+  uint64_t u64_at_ns;
+} sHostHALEXTI_t;
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_HAL_IRQ_OFFSET      16    //Exceptions below 0
+#define cHOST_HAL_IRQ_NB          (cHOST_HAL_IRQ_OFFSET + 164)
+#define cHOST_HAL_NESTING_MAX     17U   //16 priorities and the thread
+#define cHOST_HAL_THREAD_PRIORITY 0x100U
+#define cHOST_HAL_TICK_NS         1000000ULL
+#define cHOST_HAL_PUMP_US         1000
+#define cHOST_HAL_SPI_KERNEL_HZ   64000000ULL
+#define cHOST_HAL_TXDR_EMPTY      0xFFFFFFFFU //Never a byte, spots the TXDR writes
+#define cHOST_HAL_DMA_TC          0x1U
+#define cHOST_HAL_DMA_TE          0x2U
+#define cHOST_HAL_DMA_STREAM_NB   4U
+#define cHOST_HAL_GPIO_PORT_NB    2U
+#define cHOST_HAL_I2C_SCL_PIN     GPIO_PIN_6 //I2C1 on PB6 and PB7
+#define cHOST_HAL_I2C_SDA_PIN     GPIO_PIN_7
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+volatile uint32_t uwTick = 0;
+uint32_t SystemCoreClock = HSI_VALUE;
+CoreDebug_Type g_sHostHAL_CoreDebug;
+RCC_TypeDef g_sHostHAL_RCC;
+SPI_TypeDef g_sHostHAL_SPI1;
+GPIO_TypeDef g_asHostHAL_GPIO[cHOST_HAL_GPIO_PORT_NB];
+DMA_Stream_TypeDef g_asHostHAL_DMAStreams[cHOST_HAL_DMA_STREAM_NB];
+
+static sHostHALConfig_t s_sConfig = {
+  .u64_duration_ns = 0,
+  .u32_access_ns = cHOST_HAL_ACCESS_NS_DEFAULT
+};
+static sHostHALStats_t s_sStats;
+static uint64_t s_u64NowNs;
+static bool s_abArmed[ceHOST_HAL_EVENT_NB];
+static uint64_t s_au64AtNs[ceHOST_HAL_EVENT_NB];
+static bool s_bRunning = false;
+static sigjmp_buf s_sExit;
+
+/* Read by the pump */
+static volatile sig_atomic_t s_iInside = 0;     //Shim calls on the stack
+static volatile uint64_t s_u64Accesses = 0;
+static volatile uint64_t s_u64PumpMark = 0;
+
+/* NVIC */
+static uint8_t s_au8Priority[cHOST_HAL_IRQ_NB];
+static bool s_abEnabled[cHOST_HAL_IRQ_NB];
+static bool s_abPending[cHOST_HAL_IRQ_NB];
+static bool s_abActive[cHOST_HAL_IRQ_NB];
+static uint32_t s_au32ActivePriority[cHOST_HAL_NESTING_MAX];
+static uint32_t s_u32ActiveDepth;
+static uint32_t s_u32Primask;
+static uint32_t s_u32Basepri;
+static uint64_t s_u64Delivered;
+
+/* Clocks */
+static RCC_OscInitTypeDef s_sOscillators;
+static uint32_t s_u32PCLK1Hz;
+static bool s_bTickSuspended;
+
+/* Core peripherals */
+static DWT_Type s_sDWT;
+static uint32_t s_u32CycleOffset;
+static uint32_t s_u32CycleSeen;        //CYCCNT published, to spot the writes
+static bool s_bCycleRunning;
+static SCB_Type s_sSCB;
+
+/* Device peripherals */
+static sHostHALTimer_t s_asTimers[2];
+static sHostHALI2CLL_t s_sI2C;
+static sHostHALI2CXfer_t s_sXfer;
+static sHostHALSPIXfer_t s_sSPI;
+static uint32_t s_au32DMAFlags[cHOST_HAL_DMA_STREAM_NB];
+static uint32_t s_aau32PinMode[cHOST_HAL_GPIO_PORT_NB][16];
+static uint32_t s_aau32Toggles[cHOST_HAL_GPIO_PORT_NB][16];
+static uint32_t s_u32EXTIPending;
+static sHostHALEXTI_t s_asEXTIQueue[cHOST_HAL_EXTI_QUEUE_SIZE];
+static uint32_t s_u32EXTICount;
+
+/* Private function prototypes -----------------------------------------------*/
+static void vHostHAL_enter(void);
+static void vHostHAL_leave(void);
+static sig_atomic_t iHostHAL_release(void);
+static void vHostHAL_reacquire(sig_atomic_t p_iInside);
+static void vHostHAL_access(void);
+static void vHostHAL_sync(void);
+static void vHostHAL_end(bool p_bIdle);
+static void vHostHAL_arm(eHostHALEvent_t p_eEvent, uint64_t p_u64AtNs);
+static void vHostHAL_disarm(eHostHALEvent_t p_eEvent);
+static bool bHostHAL_nextEvent(eHostHALEvent_t* p_peEvent, uint64_t* p_pu64AtNs);
+static void vHostHAL_advanceTo(uint64_t p_u64TargetNs);
+static void vHostHAL_waitNextEvent(void);
+static void vHostHAL_fire(eHostHALEvent_t p_eEvent);
+static void vHostHAL_pump(int p_iSignal);
+static int32_t s32HostHAL_index(IRQn_Type p_eIRQ);
+static void vHostHAL_pend(IRQn_Type p_eIRQ);
+static int32_t s32HostHAL_selectIRQ(void);
+static void vHostHAL_deliver(void);
+static void (*pfHostHAL_handler(int32_t p_s32Index))(void);
+static uint32_t u32HostHAL_cycles(void);
+static uint64_t u64HostHAL_timerTickNs(const sHostHALTimer_t* p_psTimer);
+static uint32_t u32HostHAL_timerCount(const sHostHALTimer_t* p_psTimer);
+static void vHostHAL_rebaseTimer(sHostHALTimer_t* p_psTimer, uint32_t p_u32Count);
+static void vHostHAL_syncTimer(sHostHALTimer_t* p_psTimer);
+static void vHostHAL_scheduleTimer(sHostHALTimer_t* p_psTimer);
+static sHostHALTimer_t* psHostHAL_timer(const TIM_TypeDef* p_psInstance);
+static uint32_t u32HostHAL_busUs(void);
+static void vHostHAL_stepI2C(void);
+static void vHostHAL_startI2C(uint32_t p_u32CR2);
+static void vHostHAL_writeI2C(uint8_t p_u8Byte);
+static void vHostHAL_readyI2C(eSIM_BusResult_t p_eResult, uint32_t p_u32DurationUs);
+static uint32_t u32HostHAL_i2cErrorCode(eSIM_BusResult_t p_eResult);
+static void vHostHAL_cancelI2C(void);
+static HAL_StatusTypeDef eHostHAL_startXfer(I2C_HandleTypeDef* p_phI2C, uint16_t p_u16DevAddress, uint16_t p_u16MemAddress, uint8_t* p_pu8Data, uint16_t p_u16Size, bool p_bRead, eHostHALMode_t p_eMode);
+static void vHostHAL_fireI2C(void);
+static void vHostHAL_finishXfer(void);
+static void vHostHAL_xferDMACplt(DMA_HandleTypeDef* p_phDMA);
+static void vHostHAL_xferDMAError(DMA_HandleTypeDef* p_phDMA);
+static int32_t s32HostHAL_stream(const DMA_HandleTypeDef* p_phDMA);
+static void vHostHAL_raiseDMA(DMA_HandleTypeDef* p_phDMA, uint32_t p_u32Flag);
+static HAL_StatusTypeDef eHostHAL_startSPI(SPI_HandleTypeDef* p_phSPI, uint8_t* p_pu8RxData, uint16_t p_u16Size, eHostHALMode_t p_eMode);
+static void vHostHAL_fireSPI(void);
+static void vHostHAL_finishSPI(SPI_HandleTypeDef* p_phSPI);
+static void vHostHAL_spiDMARxCplt(DMA_HandleTypeDef* p_phDMA);
+static void vHostHAL_spiDMATxCplt(DMA_HandleTypeDef* p_phDMA);
+static int32_t s32HostHAL_port(const GPIO_TypeDef* p_psPort);
+static void vHostHAL_fireEXTI(void);
+
+/* Vectors, the firmware defines the ones it uses */
+void NMI_Handler(void);
+void HardFault_Handler(void);
+void MemManage_Handler(void);
+void BusFault_Handler(void);
+void UsageFault_Handler(void);
+void SVC_Handler(void);
+void DebugMon_Handler(void);
+void PendSV_Handler(void);
+void SysTick_Handler(void);
+void EXTI0_IRQHandler(void);
+void EXTI1_IRQHandler(void);
+void EXTI2_IRQHandler(void);
+void EXTI3_IRQHandler(void);
+void EXTI4_IRQHandler(void);
+void EXTI9_5_IRQHandler(void);
+void EXTI15_10_IRQHandler(void);
+void DMA1_Stream0_IRQHandler(void);
+void DMA1_Stream1_IRQHandler(void);
+void DMA1_Stream2_IRQHandler(void);
+void DMA1_Stream3_IRQHandler(void);
+void TIM2_IRQHandler(void);
+void TIM5_IRQHandler(void);
+void I2C1_EV_IRQHandler(void);
+void I2C1_ER_IRQHandler(void);
+void SPI1_IRQHandler(void);
+void SAI4_IRQHandler(void);
+void OCTOSPI2_IRQHandler(void);
+void FMAC_IRQHandler(void);
+void CORDIC_IRQHandler(void);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Init function for the models
+ *
+ * Puts the core and the peripherals in their reset state at time 0: HSI
+ * at 64 MHz, every interrupt disabled at priority 0, no event armed.
+ *
+ * @param p_psConfig the run parameters
+ * @return
+ */
+void vHostHAL_init(const sHostHALConfig_t* p_psConfig) {
+  uint32_t i;
+
+  s_sConfig = *p_psConfig;
+  if (s_sConfig.u32_access_ns == 0U) {
+    s_sConfig.u32_access_ns = 1U;
+  }
+
+  memset(&s_sStats, 0, sizeof(s_sStats));
+  s_u64NowNs = 0;
+  memset(s_abArmed, 0, sizeof(s_abArmed));
+  s_u64Accesses = 0;
+  s_u64PumpMark = 0;
+  s_iInside = 0;
+
+  memset(s_au8Priority, 0, sizeof(s_au8Priority));
+  memset(s_abEnabled, 0, sizeof(s_abEnabled));
+  memset(s_abPending, 0, sizeof(s_abPending));
+  memset(s_abActive, 0, sizeof(s_abActive));
+  for (i = 0; i < (uint32_t)cHOST_HAL_IRQ_OFFSET; i++) {
+    s_abEnabled[i] = true; //Exceptions cannot be disabled
+  }
+  s_u32ActiveDepth = 0;
+  s_u32Primask = 0;
+  s_u32Basepri = 0;
+  s_u64Delivered = 0;
+
+  uwTick = 0;
+  SystemCoreClock = HSI_VALUE;
+  s_u32PCLK1Hz = HSI_VALUE;
+  s_bTickSuspended = false;
+  memset(&s_sOscillators, 0, sizeof(s_sOscillators));
+  memset(&g_sHostHAL_RCC, 0, sizeof(g_sHostHAL_RCC));
+  memset(&g_sHostHAL_CoreDebug, 0, sizeof(g_sHostHAL_CoreDebug));
+  memset(&g_sHostHAL_SPI1, 0, sizeof(g_sHostHAL_SPI1));
+  memset(g_asHostHAL_DMAStreams, 0, sizeof(g_asHostHAL_DMAStreams));
+  memset(s_au32DMAFlags, 0, sizeof(s_au32DMAFlags));
+
+  memset(&s_sDWT, 0, sizeof(s_sDWT));
+  s_u32CycleOffset = 0;
+  s_u32CycleSeen = 0;
+  s_bCycleRunning = false;
+  memset(&s_sSCB, 0, sizeof(s_sSCB));
+
+  memset(s_asTimers, 0, sizeof(s_asTimers));
+  s_asTimers[0].e_irq = TIM2_IRQn;
+  s_asTimers[0].e_event = ceHOST_HAL_EVENT_TIM2;
+  s_asTimers[1].e_irq = TIM5_IRQn;
+  s_asTimers[1].e_event = ceHOST_HAL_EVENT_TIM5;
+  for (i = 0; i < 2U; i++) {
+    s_asTimers[i].u32_arr = 0xFFFFFFFFU;
+    s_asTimers[i].s_regs.ARR = 0xFFFFFFFFU;
+    s_asTimers[i].s_seen = s_asTimers[i].s_regs;
+  }
+
+  memset(&s_sI2C, 0, sizeof(s_sI2C));
+  memset(&s_sXfer, 0, sizeof(s_sXfer));
+  vHostHAL_cancelI2C();
+  memset(&s_sSPI, 0, sizeof(s_sSPI));
+
+  for (i = 0; i < cHOST_HAL_GPIO_PORT_NB; i++) {
+    g_asHostHAL_GPIO[i].IDR = 0x0000FFFFU; //Floating inputs read high
+    g_asHostHAL_GPIO[i].ODR = 0;
+  }
+  memset(s_aau32PinMode, 0, sizeof(s_aau32PinMode));
+  memset(s_aau32Toggles, 0, sizeof(s_aau32Toggles));
+  s_u32EXTIPending = 0;
+  s_u32EXTICount = 0;
+}
+
+/**
+ * @brief Runs a firmware main until the configured virtual time
+ *
+ * The main never returns on the target, the run ends from inside the shim
+ * when the time reaches u64_duration_ns, or when the firmware sleeps with
+ * no event left to wake it.
+ *
+ * @param p_pfMain the firmware main
+ * @return the virtual time the run stopped at, in ns
+ */
+uint64_t u64HostHAL_run(pfHostHAL_Main_t p_pfMain) {
+  struct sigaction l_sAction;
+  struct sigaction l_sPrevious;
+  struct itimerval l_sTimer;
+
+  memset(&l_sAction, 0, sizeof(l_sAction));
+  l_sAction.sa_handler = vHostHAL_pump;
+  sigemptyset(&l_sAction.sa_mask);
+  l_sAction.sa_flags = SA_RESTART;
+  sigaction(SIGVTALRM, &l_sAction, &l_sPrevious);
+
+  memset(&l_sTimer, 0, sizeof(l_sTimer));
+  l_sTimer.it_interval.tv_usec = cHOST_HAL_PUMP_US;
+  l_sTimer.it_value.tv_usec = cHOST_HAL_PUMP_US;
+
+  s_bRunning = true;
+  if (sigsetjmp(s_sExit, 1) == 0) {
+    setitimer(ITIMER_VIRTUAL, &l_sTimer, NULL);
+    (void)p_pfMain();
+    s_sStats.b_idle_end = false; //Returned, not a target behaviour
+  }
+
+  memset(&l_sTimer, 0, sizeof(l_sTimer));
+  setitimer(ITIMER_VIRTUAL, &l_sTimer, NULL);
+  sigaction(SIGVTALRM, &l_sPrevious, NULL);
+
+  s_bRunning = false;
+  s_iInside = 0;
+  return s_u64NowNs;
+}
+
+/**
+ * @brief Gives the virtual time
+ *
+ * @return the time since vHostHAL_init, in ns
+ */
+uint64_t u64HostHAL_getNowNs(void) {
+  return s_u64NowNs;
+}
+
+/**
+ * @brief Raises an EXTI line at a given time
+ *
+ * The line pends its interrupt if a pin of that number was initialised in
+ * an interrupt mode, as the SYSCFG routing of the target. The firmware
+ * uses no EXTI line yet, this is the entry point for data ready stimuli.
+ *
+ * @param p_u16Pin the GPIO_PIN_x of the line
+ * @param p_u64AtNs the virtual time to raise it at
+ * @return false if the queue is full
+ */
+bool bHostHAL_scheduleEXTI(uint16_t p_u16Pin, uint64_t p_u64AtNs) {
+  uint32_t l_u32Position;
+
+  if (s_u32EXTICount >= cHOST_HAL_EXTI_QUEUE_SIZE || p_u16Pin == 0U) {
+    return false;
+  }
+
+  /* Sorted, equal times keep their order */
+  l_u32Position = s_u32EXTICount;
+  while (l_u32Position > 0U && s_asEXTIQueue[l_u32Position - 1U].u64_at_ns > p_u64AtNs) {
+    s_asEXTIQueue[l_u32Position] = s_asEXTIQueue[l_u32Position - 1U];
+    l_u32Position--;
+  }
+  s_asEXTIQueue[l_u32Position].u16_pin = p_u16Pin;
+  s_asEXTIQueue[l_u32Position].u64_at_ns = p_u64AtNs;
+  s_u32EXTICount++;
+
+  vHostHAL_arm(ceHOST_HAL_EVENT_EXTI, s_asEXTIQueue[0].u64_at_ns);
+  return true;
+}
+
+/**
+ * @brief Gives the number of toggles of a pin, the LED activity
+ *
+ * @param p_psPort GPIOA or GPIOB
+ * @param p_u16Pin a single GPIO_PIN_x
+ * @return the HAL_GPIO_TogglePin calls on that pin
+ */
+uint32_t u32HostHAL_getToggles(const GPIO_TypeDef* p_psPort, uint16_t p_u16Pin) {
+  int32_t l_s32Port = s32HostHAL_port(p_psPort);
+
+  if (l_s32Port < 0 || p_u16Pin == 0U) {
+    return 0;
+  }
+  return s_aau32Toggles[l_s32Port][__builtin_ctz(p_u16Pin)];
+}
+
+/**
+ * @brief Gives the statistics of the run
+ *
+ * @param p_psStats the struct to fill
+ * @return
+ */
+void vHostHAL_getStats(sHostHALStats_t* p_psStats) {
+  *p_psStats = s_sStats;
+  p_psStats->u64_now_ns = s_u64NowNs;
+  p_psStats->u64_accesses = s_u64Accesses;
+}
+
+/* Accessors ------------------------------------------------------------------*/
+
+DWT_Type* psHostHAL_DWT(void) {
+  vHostHAL_enter();
+
+  /* A write rebases the counter, so does enabling or stopping it */
+  if (s_sDWT.CYCCNT != s_u32CycleSeen || ((s_sDWT.CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0U) != s_bCycleRunning) {
+    s_u32CycleOffset = u32HostHAL_cycles() - s_sDWT.CYCCNT;
+    s_bCycleRunning = (s_sDWT.CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0U;
+  }
+  if (s_bCycleRunning) {
+    s_sDWT.CYCCNT = u32HostHAL_cycles() - s_u32CycleOffset;
+  }
+  s_u32CycleSeen = s_sDWT.CYCCNT;
+
+  vHostHAL_leave();
+  return &s_sDWT;
+}
+
+SCB_Type* psHostHAL_SCB(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+  return &s_sSCB;
+}
+
+TIM_TypeDef* psHostHAL_TIM2(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+  return &s_asTimers[0].s_regs;
+}
+
+TIM_TypeDef* psHostHAL_TIM5(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+  return &s_asTimers[1].s_regs;
+}
+
+I2C_TypeDef* psHostHAL_I2C1(void) {
+  vHostHAL_enter();
+  vHostHAL_stepI2C();
+  vHostHAL_leave();
+  return &s_sI2C.s_regs;
+}
+
+/**
+ * @brief Kernel reset of I2C1, drops whatever transfer is in flight
+ *
+ * @return
+ */
+void vHostHAL_resetI2C1(void) {
+  vHostHAL_enter();
+  vHostHAL_cancelI2C();
+  s_sStats.u32_i2c_resets++;
+  vHostHAL_leave();
+}
+
+uint32_t u32HostHAL_getEXTI(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+  return s_u32EXTIPending;
+}
+
+void vHostHAL_clearEXTI(uint32_t p_u32Lines) {
+  vHostHAL_enter();
+  s_u32EXTIPending &= ~p_u32Lines;
+  vHostHAL_leave();
+}
+
+/* CMSIS core -----------------------------------------------------------------*/
+
+uint32_t __get_PRIMASK(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+  return s_u32Primask;
+}
+
+void __set_PRIMASK(uint32_t priMask) {
+  vHostHAL_enter();
+  s_u32Primask = priMask & 1U;
+  vHostHAL_deliver();
+  vHostHAL_leave();
+}
+
+void __disable_irq(void) {
+  vHostHAL_enter();
+  s_u32Primask = 1U;
+  vHostHAL_leave();
+}
+
+void __enable_irq(void) {
+  vHostHAL_enter();
+  s_u32Primask = 0U;
+  vHostHAL_deliver();
+  vHostHAL_leave();
+}
+
+uint32_t __get_BASEPRI(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+  return s_u32Basepri;
+}
+
+void __set_BASEPRI(uint32_t basePri) {
+  vHostHAL_enter();
+  s_u32Basepri = basePri & 0xF0U;
+  vHostHAL_deliver();
+  vHostHAL_leave();
+}
+
+void __set_BASEPRI_MAX(uint32_t basePri) {
+  vHostHAL_enter();
+  basePri &= 0xF0U;
+  if (basePri != 0U && (s_u32Basepri == 0U || basePri < s_u32Basepri)) {
+    s_u32Basepri = basePri;
+  }
+  vHostHAL_leave();
+}
+
+void __DSB(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+}
+
+void __DMB(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+}
+
+void __ISB(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+}
+
+/**
+ * @brief Sleeps until an interrupt that would preempt the current level
+ * is pending, PRIMASK does not prevent the wake-up
+ *
+ * @return
+ */
+void __WFI(void) {
+  uint64_t l_u64Delivered;
+  uint64_t l_u64SleepNs;
+
+  vHostHAL_enter();
+  l_u64Delivered = s_u64Delivered;
+
+  while (s_u64Delivered == l_u64Delivered && s32HostHAL_selectIRQ() < 0) {
+    l_u64SleepNs = s_u64NowNs;
+    vHostHAL_waitNextEvent();
+    s_sStats.u64_sleep_ns += s_u64NowNs - l_u64SleepNs;
+  }
+
+  vHostHAL_leave();
+}
+
+void __NOP(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+}
+
+void NVIC_SetPendingIRQ(IRQn_Type IRQn) {
+  vHostHAL_enter();
+  vHostHAL_pend(IRQn);
+  vHostHAL_deliver();
+  vHostHAL_leave();
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn) {
+  int32_t l_s32Index;
+
+  vHostHAL_enter();
+  l_s32Index = s32HostHAL_index(IRQn);
+  if (l_s32Index >= 0) {
+    s_abPending[l_s32Index] = false;
+  }
+  vHostHAL_leave();
+}
+
+uint32_t NVIC_GetEnableIRQ(IRQn_Type IRQn) {
+  int32_t l_s32Index;
+
+  vHostHAL_enter();
+  l_s32Index = s32HostHAL_index(IRQn);
+  vHostHAL_leave();
+  return (l_s32Index >= 0 && s_abEnabled[l_s32Index]) ? 1U : 0U;
+}
+
+uint32_t NVIC_GetPendingIRQ(IRQn_Type IRQn) {
+  int32_t l_s32Index;
+
+  vHostHAL_enter();
+  l_s32Index = s32HostHAL_index(IRQn);
+  vHostHAL_leave();
+  return (l_s32Index >= 0 && s_abPending[l_s32Index]) ? 1U : 0U;
+}
+
+uint32_t NVIC_GetActive(IRQn_Type IRQn) {
+  int32_t l_s32Index;
+
+  vHostHAL_enter();
+  l_s32Index = s32HostHAL_index(IRQn);
+  vHostHAL_leave();
+  return (l_s32Index >= 0 && s_abActive[l_s32Index]) ? 1U : 0U;
+}
+
+/* HAL core and Cortex --------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_Init(void) {
+  sig_atomic_t l_iInside;
+
+  vHostHAL_enter();
+  HAL_NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_4);
+  HAL_NVIC_SetPriority(SysTick_IRQn, TICK_INT_PRIORITY, 0U);
+  vHostHAL_arm(ceHOST_HAL_EVENT_SYSTICK, s_u64NowNs + cHOST_HAL_TICK_NS);
+
+  l_iInside = iHostHAL_release();
+  HAL_MspInit();
+  vHostHAL_reacquire(l_iInside);
+
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+__weak void HAL_MspInit(void) {
+}
+
+void HAL_IncTick(void) {
+  vHostHAL_enter();
+  uwTick += 1U;
+  vHostHAL_leave();
+}
+
+uint32_t HAL_GetTick(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+  return uwTick;
+}
+
+/**
+ * @brief Waits at least Delay ms of SysTick, as the HAL
+ *
+ * The interrupts are delivered during the wait, with the tick masked or
+ * suspended the wait only ends with the run.
+ *
+ * @param Delay the delay in ms
+ * @return
+ */
+void HAL_Delay(uint32_t Delay) {
+  uint32_t l_u32Start;
+  uint32_t l_u32Wait = Delay;
+
+  vHostHAL_enter();
+  l_u32Start = uwTick;
+  if (l_u32Wait < HAL_MAX_DELAY) {
+    l_u32Wait += 1U;
+  }
+
+  while ((uwTick - l_u32Start) < l_u32Wait) {
+    vHostHAL_waitNextEvent();
+  }
+  vHostHAL_leave();
+}
+
+void HAL_SuspendTick(void) {
+  vHostHAL_enter();
+  s_bTickSuspended = true;
+  vHostHAL_leave();
+}
+
+void HAL_ResumeTick(void) {
+  vHostHAL_enter();
+  s_bTickSuspended = false;
+  vHostHAL_leave();
+}
+
+void HAL_NVIC_SetPriorityGrouping(uint32_t PriorityGroup) {
+  vHostHAL_enter();
+  (void)PriorityGroup; //Only group 4 is modelled, every bit preempts
+  vHostHAL_leave();
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority) {
+  int32_t l_s32Index;
+
+  vHostHAL_enter();
+  (void)SubPriority;
+  l_s32Index = s32HostHAL_index(IRQn);
+  if (l_s32Index >= 0) {
+    s_au8Priority[l_s32Index] = (uint8_t)(PreemptPriority & 0x0FU);
+  }
+  vHostHAL_leave();
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+  int32_t l_s32Index;
+
+  vHostHAL_enter();
+  l_s32Index = s32HostHAL_index(IRQn);
+  if (l_s32Index >= 0) {
+    s_abEnabled[l_s32Index] = true;
+  }
+  vHostHAL_deliver();
+  vHostHAL_leave();
+}
+
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+  int32_t l_s32Index;
+
+  vHostHAL_enter();
+  l_s32Index = s32HostHAL_index(IRQn);
+  if (l_s32Index >= (int32_t)cHOST_HAL_IRQ_OFFSET) {
+    s_abEnabled[l_s32Index] = false;
+  }
+  vHostHAL_leave();
+}
+
+void HAL_NVIC_ClearPendingIRQ(IRQn_Type IRQn) {
+  NVIC_ClearPendingIRQ(IRQn);
+}
+
+void HAL_MPU_Disable(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+}
+
+void HAL_MPU_Enable(uint32_t MPU_Control) {
+  vHostHAL_enter();
+  (void)MPU_Control;
+  vHostHAL_leave();
+}
+
+void HAL_MPU_ConfigRegion(MPU_Region_InitTypeDef* MPU_Init) {
+  vHostHAL_enter();
+  (void)MPU_Init;
+  vHostHAL_leave();
+}
+
+/* RCC and PWR ----------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_PWREx_ConfigSupply(uint32_t SupplySource) {
+  vHostHAL_enter();
+  (void)SupplySource;
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef* RCC_OscInitStruct) {
+  vHostHAL_enter();
+  s_sOscillators = *RCC_OscInitStruct;
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+/**
+ * @brief Switches SYSCLK and the APB1 prescaler
+ *
+ * The timers keep their count across the change, their tick follows the
+ * new PCLK1.
+ *
+ * @param RCC_ClkInitStruct the clock tree
+ * @param FLatency unused
+ * @return HAL_ERROR if the PLL is selected without a valid configuration
+ */
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef* RCC_ClkInitStruct, uint32_t FLatency) {
+  const RCC_PLLInitTypeDef* l_psPLL = &s_sOscillators.PLL;
+  uint32_t l_u32Divider;
+  uint32_t i;
+
+  vHostHAL_enter();
+  (void)FLatency;
+
+  for (i = 0; i < 2U; i++) {
+    vHostHAL_rebaseTimer(&s_asTimers[i], u32HostHAL_timerCount(&s_asTimers[i]));
+  }
+
+  if ((RCC_ClkInitStruct->ClockType & RCC_CLOCKTYPE_SYSCLK) != 0U) {
+    if (RCC_ClkInitStruct->SYSCLKSource == RCC_SYSCLKSOURCE_PLLCLK) {
+      if (l_psPLL->PLLState != RCC_PLL_ON || l_psPLL->PLLM == 0U || l_psPLL->PLLP == 0U) {
+        vHostHAL_leave();
+        return HAL_ERROR;
+      }
+      SystemCoreClock = (uint32_t)((uint64_t)HSI_VALUE / l_psPLL->PLLM * l_psPLL->PLLN / l_psPLL->PLLP);
+    }
+    else {
+      SystemCoreClock = HSI_VALUE;
+    }
+  }
+
+  if ((RCC_ClkInitStruct->ClockType & RCC_CLOCKTYPE_PCLK1) != 0U) {
+    g_sHostHAL_RCC.D2CFGR = (g_sHostHAL_RCC.D2CFGR & ~RCC_D2CFGR_D2PPRE1) | RCC_ClkInitStruct->APB1CLKDivider;
+  }
+  switch (g_sHostHAL_RCC.D2CFGR & RCC_D2CFGR_D2PPRE1) {
+    case RCC_APB1_DIV2: l_u32Divider = 2U; break;
+    case RCC_APB1_DIV4: l_u32Divider = 4U; break;
+    case RCC_APB1_DIV8: l_u32Divider = 8U; break;
+    case RCC_APB1_DIV16: l_u32Divider = 16U; break;
+    default: l_u32Divider = 1U; break;
+  }
+  s_u32PCLK1Hz = SystemCoreClock / l_u32Divider;
+
+  for (i = 0; i < 2U; i++) {
+    vHostHAL_scheduleTimer(&s_asTimers[i]);
+  }
+
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef* PeriphClkInit) {
+  vHostHAL_enter();
+  (void)PeriphClkInit;
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetSysClockFreq(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+  return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+  vHostHAL_enter();
+  vHostHAL_leave();
+  return s_u32PCLK1Hz;
+}
+
+/* GPIO -----------------------------------------------------------------------*/
+
+void HAL_GPIO_Init(GPIO_TypeDef* GPIOx, GPIO_InitTypeDef* GPIO_Init) {
+  int32_t l_s32Port;
+  uint32_t i;
+
+  vHostHAL_enter();
+  l_s32Port = s32HostHAL_port(GPIOx);
+  if (l_s32Port >= 0) {
+    for (i = 0; i < 16U; i++) {
+      if ((GPIO_Init->Pin & (1UL << i)) == 0U) {
+        continue;
+      }
+      s_aau32PinMode[l_s32Port][i] = GPIO_Init->Mode;
+      if (GPIO_Init->Pull == GPIO_PULLDOWN) {
+        GPIOx->IDR &= ~(1UL << i);
+      }
+      else {
+        GPIOx->IDR |= (1UL << i);
+      }
+    }
+  }
+  vHostHAL_leave();
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef* GPIOx, uint32_t GPIO_Pin) {
+  int32_t l_s32Port;
+  uint32_t i;
+
+  vHostHAL_enter();
+  l_s32Port = s32HostHAL_port(GPIOx);
+  if (l_s32Port >= 0) {
+    for (i = 0; i < 16U; i++) {
+      if ((GPIO_Pin & (1UL << i)) != 0U) {
+        s_aau32PinMode[l_s32Port][i] = GPIO_MODE_INPUT;
+      }
+    }
+  }
+  vHostHAL_leave();
+}
+
+/**
+ * @brief Reads a pin, an output reads back its level
+ *
+ * Open-drain outputs read their own level too, only a slave of the
+ * simulated bus holding SDA low pulls the I2C1 SDA line down.
+ */
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+  int32_t l_s32Port;
+  uint32_t l_u32Mode;
+  uint32_t l_u32Level;
+
+  vHostHAL_enter();
+  l_s32Port = s32HostHAL_port(GPIOx);
+  l_u32Mode = (l_s32Port >= 0 && GPIO_Pin != 0U) ? s_aau32PinMode[l_s32Port][__builtin_ctz(GPIO_Pin)] : GPIO_MODE_INPUT;
+  l_u32Level = ((l_u32Mode & 0x3U) == GPIO_MODE_OUTPUT_PP) ? GPIOx->ODR : GPIOx->IDR;
+  if (GPIOx == GPIOB && bSIM_Bus_isSDAHeld()) {
+    l_u32Level &= ~(uint32_t)cHOST_HAL_I2C_SDA_PIN;
+  }
+  vHostHAL_leave();
+  return ((l_u32Level & GPIO_Pin) != 0U) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+/**
+ * @brief Writes a pin, a rising SCL driven as an output clocks the slaves
+ * of the simulated bus
+ */
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+  vHostHAL_enter();
+  if (
+    GPIOx == GPIOB && PinState != GPIO_PIN_RESET &&
+    (GPIO_Pin & cHOST_HAL_I2C_SCL_PIN) != 0U && (GPIOx->ODR & cHOST_HAL_I2C_SCL_PIN) == 0U &&
+    (s_aau32PinMode[s32HostHAL_port(GPIOB)][__builtin_ctz(cHOST_HAL_I2C_SCL_PIN)] & 0x3U) == GPIO_MODE_OUTPUT_PP
+  ) {
+    vSIM_Bus_clockSCL();
+  }
+  if (PinState != GPIO_PIN_RESET) {
+    GPIOx->ODR |= GPIO_Pin;
+  }
+  else {
+    GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+  }
+  vHostHAL_leave();
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+  int32_t l_s32Port;
+  uint32_t i;
+
+  vHostHAL_enter();
+  GPIOx->ODR ^= GPIO_Pin;
+  l_s32Port = s32HostHAL_port(GPIOx);
+  if (l_s32Port >= 0) {
+    for (i = 0; i < 16U; i++) {
+      if ((GPIO_Pin & (1UL << i)) != 0U) {
+        s_aau32Toggles[l_s32Port][i]++;
+      }
+    }
+  }
+  vHostHAL_leave();
+}
+
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin) {
+  sig_atomic_t l_iInside;
+
+  vHostHAL_enter();
+  if ((s_u32EXTIPending & GPIO_Pin) != 0U) {
+    s_u32EXTIPending &= ~(uint32_t)GPIO_Pin;
+    l_iInside = iHostHAL_release();
+    HAL_GPIO_EXTI_Callback(GPIO_Pin);
+    vHostHAL_reacquire(l_iInside);
+  }
+  vHostHAL_leave();
+}
+
+__weak void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+  UNUSED(GPIO_Pin);
+}
+
+/* DMA ------------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef* hdma) {
+  int32_t l_s32Stream;
+
+  vHostHAL_enter();
+  if (hdma->State == HAL_DMA_STATE_BUSY) {
+    vHostHAL_leave();
+    return HAL_BUSY;
+  }
+  l_s32Stream = s32HostHAL_stream(hdma);
+  if (l_s32Stream >= 0) {
+    s_au32DMAFlags[l_s32Stream] = 0;
+  }
+  hdma->Lock = HAL_UNLOCKED;
+  hdma->ErrorCode = HAL_DMA_ERROR_NONE;
+  hdma->State = HAL_DMA_STATE_READY;
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef* hdma) {
+  vHostHAL_enter();
+  hdma->State = HAL_DMA_STATE_RESET;
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef* hdma) {
+  int32_t l_s32Stream;
+
+  vHostHAL_enter();
+  l_s32Stream = s32HostHAL_stream(hdma);
+  if (l_s32Stream >= 0) {
+    s_au32DMAFlags[l_s32Stream] = 0;
+  }
+  hdma->State = HAL_DMA_STATE_READY;
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+void HAL_DMA_IRQHandler(DMA_HandleTypeDef* hdma) {
+  int32_t l_s32Stream;
+  uint32_t l_u32Flags;
+  sig_atomic_t l_iInside;
+
+  vHostHAL_enter();
+  l_s32Stream = s32HostHAL_stream(hdma);
+  l_u32Flags = (l_s32Stream >= 0) ? s_au32DMAFlags[l_s32Stream] : 0U;
+  if (l_s32Stream >= 0) {
+    s_au32DMAFlags[l_s32Stream] = 0;
+  }
+
+  if ((l_u32Flags & cHOST_HAL_DMA_TE) != 0U) {
+    hdma->ErrorCode |= HAL_DMA_ERROR_TE;
+    hdma->State = HAL_DMA_STATE_READY;
+    if (hdma->XferErrorCallback != NULL) {
+      l_iInside = iHostHAL_release();
+      hdma->XferErrorCallback(hdma);
+      vHostHAL_reacquire(l_iInside);
+    }
+  }
+  else if ((l_u32Flags & cHOST_HAL_DMA_TC) != 0U) {
+    hdma->State = HAL_DMA_STATE_READY;
+    if (hdma->XferCpltCallback != NULL) {
+      l_iInside = iHostHAL_release();
+      hdma->XferCpltCallback(hdma);
+      vHostHAL_reacquire(l_iInside);
+    }
+  }
+  vHostHAL_leave();
+}
+
+/* I2C ------------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef* hi2c) {
+  sig_atomic_t l_iInside;
+
+  vHostHAL_enter();
+  if (hi2c->State == HAL_I2C_STATE_RESET) {
+    hi2c->Lock = HAL_UNLOCKED;
+    l_iInside = iHostHAL_release();
+    HAL_I2C_MspInit(hi2c);
+    vHostHAL_reacquire(l_iInside);
+  }
+
+  /* The peripheral is disabled and enabled again, nothing survives */
+  if (s_sXfer.e_phase != ceHOST_HAL_XFER_IDLE || s_sI2C.e_phase != ceHOST_HAL_LL_IDLE) {
+    vHostHAL_cancelI2C();
+  }
+  s_sI2C.s_regs.TIMINGR = hi2c->Init.Timing;
+  s_sI2C.s_regs.CR1 |= I2C_CR1_PE;
+
+  hi2c->ErrorCode = HAL_I2C_ERROR_NONE;
+  hi2c->State = HAL_I2C_STATE_READY;
+  hi2c->PreviousState = 0;
+  hi2c->Mode = HAL_I2C_MODE_NONE;
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_I2CEx_ConfigAnalogFilter(I2C_HandleTypeDef* hi2c, uint32_t AnalogFilter) {
+  vHostHAL_enter();
+  (void)AnalogFilter;
+  vHostHAL_leave();
+  return (hi2c->State == HAL_I2C_STATE_READY) ? HAL_OK : HAL_BUSY;
+}
+
+HAL_StatusTypeDef HAL_I2CEx_ConfigDigitalFilter(I2C_HandleTypeDef* hi2c, uint32_t DigitalFilter) {
+  vHostHAL_enter();
+  (void)DigitalFilter;
+  vHostHAL_leave();
+  return (hi2c->State == HAL_I2C_STATE_READY) ? HAL_OK : HAL_BUSY;
+}
+
+__weak void HAL_I2C_MspInit(I2C_HandleTypeDef* hi2c) {
+  UNUSED(hi2c);
+}
+
+__weak void HAL_I2C_MspDeInit(I2C_HandleTypeDef* hi2c) {
+  UNUSED(hi2c);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+  (void)MemAddSize;
+  (void)Timeout;
+  return eHostHAL_startXfer(hi2c, DevAddress, MemAddress, pData, Size, true, ceHOST_HAL_MODE_BLOCKING);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+  (void)MemAddSize;
+  (void)Timeout;
+  return eHostHAL_startXfer(hi2c, DevAddress, MemAddress, pData, Size, false, ceHOST_HAL_MODE_BLOCKING);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size) {
+  (void)MemAddSize;
+  return eHostHAL_startXfer(hi2c, DevAddress, MemAddress, pData, Size, true, ceHOST_HAL_MODE_IT);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size) {
+  (void)MemAddSize;
+  return eHostHAL_startXfer(hi2c, DevAddress, MemAddress, pData, Size, false, ceHOST_HAL_MODE_IT);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size) {
+  (void)MemAddSize;
+  return eHostHAL_startXfer(hi2c, DevAddress, MemAddress, pData, Size, true, ceHOST_HAL_MODE_DMA);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size) {
+  (void)MemAddSize;
+  return eHostHAL_startXfer(hi2c, DevAddress, MemAddress, pData, Size, false, ceHOST_HAL_MODE_DMA);
+}
+
+/* Plain master transfers are not modelled, the firmware only uses them in
+ * the legacy vI2C_transmit_DMA and vI2C_receive_DMA */
+HAL_StatusTypeDef HAL_I2C_Master_Transmit_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size) {
+  vHostHAL_enter();
+  (void)hi2c;
+  (void)DevAddress;
+  (void)pData;
+  (void)Size;
+  vHostHAL_leave();
+  return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_I2C_Master_Receive_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size) {
+  vHostHAL_enter();
+  (void)hi2c;
+  (void)DevAddress;
+  (void)pData;
+  (void)Size;
+  vHostHAL_leave();
+  return HAL_ERROR;
+}
+
+/**
+ * @brief Event interrupt of the HAL transfer: bytes in IT mode, STOP after
+ * the DMA, completes the transfer on its last event
+ *
+ * Only the flags raised by the model count, a pend from the firmware
+ * finds nothing to do.
+ */
+void HAL_I2C_EV_IRQHandler(I2C_HandleTypeDef* hi2c) {
+  uint16_t l_u16New;
+
+  vHostHAL_enter();
+  if (s_sXfer.ph_i2c == hi2c && s_sXfer.b_ev) {
+    s_sXfer.b_ev = false;
+
+    if (s_sXfer.e_phase == ceHOST_HAL_XFER_IT) {
+      l_u16New = (uint16_t)(s_sXfer.u16_fired - s_sXfer.u16_served);
+      s_sXfer.u16_served = s_sXfer.u16_fired;
+      hi2c->XferCount = (hi2c->XferCount > l_u16New) ? (uint16_t)(hi2c->XferCount - l_u16New) : 0U;
+      if (hi2c->XferCount == 0U) {
+        vHostHAL_finishXfer();
+      }
+    }
+    else if (s_sXfer.e_phase == ceHOST_HAL_XFER_STOP) {
+      hi2c->XferCount = 0;
+      vHostHAL_finishXfer();
+    }
+  }
+  vHostHAL_leave();
+}
+
+/**
+ * @brief Error interrupt of the HAL transfer: NACK, arbitration loss or bus
+ * error, the transfer ends with the STOP the peripheral sent
+ *
+ */
+void HAL_I2C_ER_IRQHandler(I2C_HandleTypeDef* hi2c) {
+  sig_atomic_t l_iInside;
+
+  vHostHAL_enter();
+  if (s_sXfer.ph_i2c == hi2c && s_sXfer.b_er) {
+    s_sXfer.b_er = false;
+    s_sXfer.e_phase = ceHOST_HAL_XFER_IDLE;
+    s_sStats.u32_i2c_errors++;
+
+    hi2c->ErrorCode |= u32HostHAL_i2cErrorCode(s_sXfer.e_result);
+    hi2c->State = HAL_I2C_STATE_READY;
+    hi2c->Mode = HAL_I2C_MODE_NONE;
+    hi2c->XferISR = NULL;
+
+    l_iInside = iHostHAL_release();
+    HAL_I2C_ErrorCallback(hi2c);
+    vHostHAL_reacquire(l_iInside);
+  }
+  vHostHAL_leave();
+}
+
+__weak void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c) {
+  UNUSED(hi2c);
+}
+
+__weak void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c) {
+  UNUSED(hi2c);
+}
+
+__weak void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c) {
+  UNUSED(hi2c);
+}
+
+/* SPI ------------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_SPI_Init(SPI_HandleTypeDef* hspi) {
+  sig_atomic_t l_iInside;
+
+  vHostHAL_enter();
+  if (hspi->State == HAL_SPI_STATE_RESET) {
+    hspi->Lock = HAL_UNLOCKED;
+    l_iInside = iHostHAL_release();
+    HAL_SPI_MspInit(hspi);
+    vHostHAL_reacquire(l_iInside);
+  }
+  hspi->ErrorCode = HAL_SPI_ERROR_NONE;
+  hspi->State = HAL_SPI_STATE_READY;
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+__weak void HAL_SPI_MspInit(SPI_HandleTypeDef* hspi) {
+  UNUSED(hspi);
+}
+
+__weak void HAL_SPI_MspDeInit(SPI_HandleTypeDef* hspi) {
+  UNUSED(hspi);
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+  (void)pData;
+  (void)Timeout;
+  return eHostHAL_startSPI(hspi, NULL, Size, ceHOST_HAL_MODE_BLOCKING);
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+  (void)Timeout;
+  return eHostHAL_startSPI(hspi, pData, Size, ceHOST_HAL_MODE_BLOCKING);
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size, uint32_t Timeout) {
+  (void)pTxData;
+  (void)Timeout;
+  return eHostHAL_startSPI(hspi, pRxData, Size, ceHOST_HAL_MODE_BLOCKING);
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_IT(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size) {
+  (void)pTxData;
+  return eHostHAL_startSPI(hspi, pRxData, Size, ceHOST_HAL_MODE_IT);
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size) {
+  (void)pTxData;
+  return eHostHAL_startSPI(hspi, pRxData, Size, ceHOST_HAL_MODE_DMA);
+}
+
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef* hspi) {
+  vHostHAL_enter();
+  if (s_sSPI.ph_spi == hspi) {
+    vHostHAL_disarm(ceHOST_HAL_EVENT_SPI);
+    s_sSPI.ph_spi = NULL;
+    s_sSPI.b_done = false;
+  }
+  if (hspi->hdmatx != NULL) {
+    hspi->hdmatx->State = HAL_DMA_STATE_READY;
+  }
+  if (hspi->hdmarx != NULL) {
+    hspi->hdmarx->State = HAL_DMA_STATE_READY;
+  }
+  hspi->State = HAL_SPI_STATE_READY;
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+void HAL_SPI_IRQHandler(SPI_HandleTypeDef* hspi) {
+  vHostHAL_enter();
+  if (s_sSPI.ph_spi == hspi && s_sSPI.b_done && !s_sSPI.b_dma) {
+    s_sSPI.b_done = false;
+    vHostHAL_finishSPI(hspi);
+  }
+  vHostHAL_leave();
+}
+
+__weak void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi) {
+  UNUSED(hspi);
+}
+
+__weak void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi) {
+  UNUSED(hspi);
+}
+
+/* TIM ------------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_TIM_OC_Init(TIM_HandleTypeDef* htim) {
+  sHostHALTimer_t* l_psTimer;
+  sig_atomic_t l_iInside;
+
+  vHostHAL_enter();
+  l_psTimer = psHostHAL_timer(htim->Instance);
+  if (l_psTimer == NULL) {
+    vHostHAL_leave();
+    return HAL_ERROR;
+  }
+
+  if (htim->State == HAL_TIM_STATE_RESET) {
+    htim->Lock = HAL_UNLOCKED;
+    l_iInside = iHostHAL_release();
+    HAL_TIM_OC_MspInit(htim);
+    vHostHAL_reacquire(l_iInside);
+  }
+
+  /* The update event loads PSC, its flag is cleared as the HAL does */
+  l_psTimer->s_regs.PSC = htim->Init.Prescaler;
+  l_psTimer->s_regs.ARR = htim->Init.Period;
+  l_psTimer->s_regs.EGR = TIM_EGR_UG;
+  vHostHAL_syncTimer(l_psTimer);
+  l_psTimer->s_regs.SR = ~TIM_SR_UIF;
+  vHostHAL_syncTimer(l_psTimer);
+
+  htim->State = HAL_TIM_STATE_READY;
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+__weak void HAL_TIM_OC_MspInit(TIM_HandleTypeDef* htim) {
+  UNUSED(htim);
+}
+
+__weak void HAL_TIM_OC_MspDeInit(TIM_HandleTypeDef* htim) {
+  UNUSED(htim);
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_ConfigChannel(TIM_HandleTypeDef* htim, TIM_OC_InitTypeDef* sConfig, uint32_t Channel) {
+  sHostHALTimer_t* l_psTimer;
+
+  vHostHAL_enter();
+  l_psTimer = psHostHAL_timer(htim->Instance);
+  if (l_psTimer == NULL || Channel != TIM_CHANNEL_1) {
+    vHostHAL_leave();
+    return HAL_ERROR;
+  }
+  l_psTimer->s_regs.CCMR1 = sConfig->OCMode;
+  l_psTimer->s_regs.CCR1 = sConfig->Pulse;
+  vHostHAL_syncTimer(l_psTimer);
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_Start_IT(TIM_HandleTypeDef* htim, uint32_t Channel) {
+  sHostHALTimer_t* l_psTimer;
+
+  vHostHAL_enter();
+  l_psTimer = psHostHAL_timer(htim->Instance);
+  if (l_psTimer == NULL || Channel != TIM_CHANNEL_1) {
+    vHostHAL_leave();
+    return HAL_ERROR;
+  }
+  l_psTimer->s_regs.DIER |= TIM_DIER_CC1IE;
+  l_psTimer->s_regs.CR1 |= TIM_CR1_CEN;
+  vHostHAL_syncTimer(l_psTimer);
+  vHostHAL_deliver();
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_OC_Stop_IT(TIM_HandleTypeDef* htim, uint32_t Channel) {
+  sHostHALTimer_t* l_psTimer;
+
+  vHostHAL_enter();
+  l_psTimer = psHostHAL_timer(htim->Instance);
+  if (l_psTimer == NULL || Channel != TIM_CHANNEL_1) {
+    vHostHAL_leave();
+    return HAL_ERROR;
+  }
+  /* The only channel stops, so does the counter */
+  l_psTimer->s_regs.DIER &= ~TIM_DIER_CC1IE;
+  l_psTimer->s_regs.CR1 &= ~TIM_CR1_CEN;
+  vHostHAL_syncTimer(l_psTimer);
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_GenerateEvent(TIM_HandleTypeDef* htim, uint32_t EventSource) {
+  sHostHALTimer_t* l_psTimer;
+
+  vHostHAL_enter();
+  l_psTimer = psHostHAL_timer(htim->Instance);
+  if (l_psTimer == NULL) {
+    vHostHAL_leave();
+    return HAL_ERROR;
+  }
+  l_psTimer->s_regs.EGR = EventSource;
+  vHostHAL_syncTimer(l_psTimer);
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+/**
+ * @brief Timer interrupt, channel 1 then update as the HAL
+ *
+ */
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef* htim) {
+  sHostHALTimer_t* l_psTimer;
+  sig_atomic_t l_iInside;
+
+  vHostHAL_enter();
+  l_psTimer = psHostHAL_timer(htim->Instance);
+  if (l_psTimer == NULL) {
+    vHostHAL_leave();
+    return;
+  }
+
+  if ((l_psTimer->u32_sr & TIM_SR_CC1IF) != 0U && (l_psTimer->s_regs.DIER & TIM_DIER_CC1IE) != 0U) {
+    l_psTimer->s_regs.SR = ~TIM_SR_CC1IF;
+    vHostHAL_syncTimer(l_psTimer);
+    htim->Channel = HAL_TIM_ACTIVE_CHANNEL_1;
+    l_iInside = iHostHAL_release();
+    HAL_TIM_OC_DelayElapsedCallback(htim);
+    vHostHAL_reacquire(l_iInside);
+    htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+  }
+
+  if ((l_psTimer->u32_sr & TIM_SR_UIF) != 0U && (l_psTimer->s_regs.DIER & TIM_DIER_UIE) != 0U) {
+    l_psTimer->s_regs.SR = ~TIM_SR_UIF;
+    vHostHAL_syncTimer(l_psTimer);
+    l_iInside = iHostHAL_release();
+    HAL_TIM_PeriodElapsedCallback(htim);
+    vHostHAL_reacquire(l_iInside);
+  }
+  vHostHAL_leave();
+}
+
+__weak void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {
+  UNUSED(htim);
+}
+
+__weak void HAL_TIM_OC_DelayElapsedCallback(TIM_HandleTypeDef* htim) {
+  UNUSED(htim);
+}
+
+/* Default vectors ------------------------------------------------------------*/
+
+__weak void NMI_Handler(void) {
+}
+
+__weak void HardFault_Handler(void) {
+}
+
+__weak void MemManage_Handler(void) {
+}
+
+__weak void BusFault_Handler(void) {
+}
+
+__weak void UsageFault_Handler(void) {
+}
+
+__weak void SVC_Handler(void) {
+}
+
+__weak void DebugMon_Handler(void) {
+}
+
+__weak void PendSV_Handler(void) {
+}
+
+__weak void SysTick_Handler(void) {
+  HAL_IncTick();
+}
+
+__weak void EXTI0_IRQHandler(void) {
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_0);
+}
+
+__weak void EXTI1_IRQHandler(void) {
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_1);
+}
+
+__weak void EXTI2_IRQHandler(void) {
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_2);
+}
+
+__weak void EXTI3_IRQHandler(void) {
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_3);
+}
+
+__weak void EXTI4_IRQHandler(void) {
+  HAL_GPIO_EXTI_IRQHandler(GPIO_PIN_4);
+}
+
+__weak void EXTI9_5_IRQHandler(void) {
+  uint32_t i;
+
+  for (i = 5; i <= 9U; i++) {
+    HAL_GPIO_EXTI_IRQHandler((uint16_t)(1UL << i));
+  }
+}
+
+__weak void EXTI15_10_IRQHandler(void) {
+  uint32_t i;
+
+  for (i = 10; i <= 15U; i++) {
+    HAL_GPIO_EXTI_IRQHandler((uint16_t)(1UL << i));
+  }
+}
+
+__weak void DMA1_Stream0_IRQHandler(void) {
+}
+
+__weak void DMA1_Stream1_IRQHandler(void) {
+}
+
+__weak void DMA1_Stream2_IRQHandler(void) {
+}
+
+__weak void DMA1_Stream3_IRQHandler(void) {
+}
+
+__weak void TIM2_IRQHandler(void) {
+}
+
+__weak void TIM5_IRQHandler(void) {
+}
+
+__weak void I2C1_EV_IRQHandler(void) {
+}
+
+__weak void I2C1_ER_IRQHandler(void) {
+}
+
+__weak void SPI1_IRQHandler(void) {
+}
+
+__weak void SAI4_IRQHandler(void) {
+}
+
+__weak void OCTOSPI2_IRQHandler(void) {
+}
+
+__weak void FMAC_IRQHandler(void) {
+}
+
+__weak void CORDIC_IRQHandler(void) {
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Entry of every shim call: one access worth of time, then the
+ * due events and interrupts
+ *
+ * @return
+ */
+static void vHostHAL_enter(void) {
+  s_iInside++;
+  vHostHAL_access();
+}
+
+static void vHostHAL_leave(void) {
+  s_iInside--;
+}
+
+/**
+ * @brief Marks the stack as firmware code around a handler or callback,
+ * so the pump can break a wait in there
+ *
+ * @return the shim depth to restore
+ */
+static sig_atomic_t iHostHAL_release(void) {
+  sig_atomic_t l_iInside = s_iInside;
+
+  s_iInside = 0;
+  return l_iInside;
+}
+
+static void vHostHAL_reacquire(sig_atomic_t p_iInside) {
+  s_iInside = p_iInside;
+}
+
+static void vHostHAL_access(void) {
+  if (!s_bRunning) {
+    return;
+  }
+  s_u64Accesses++;
+  vHostHAL_sync();
+  vHostHAL_advanceTo(s_u64NowNs + s_sConfig.u32_access_ns);
+  vHostHAL_deliver();
+}
+
+/**
+ * @brief Lets the register models catch up with the firmware writes
+ *
+ * @return
+ */
+static void vHostHAL_sync(void) {
+  vHostHAL_syncTimer(&s_asTimers[0]);
+  vHostHAL_syncTimer(&s_asTimers[1]);
+
+  if ((s_sSCB.ICSR & SCB_ICSR_PENDSVSET_Msk) != 0U) {
+    vHostHAL_pend(PendSV_IRQn);
+  }
+  if ((s_sSCB.ICSR & SCB_ICSR_PENDSVCLR_Msk) != 0U) {
+    s_abPending[PendSV_IRQn + cHOST_HAL_IRQ_OFFSET] = false;
+  }
+  s_sSCB.ICSR = 0;
+}
+
+/**
+ * @brief Leaves the firmware, back to u64HostHAL_run
+ *
+ * @param p_bIdle true if the firmware sleeps with nothing left to wake it
+ * @return
+ */
+static void vHostHAL_end(bool p_bIdle) {
+  s_sStats.b_idle_end = p_bIdle;
+  siglongjmp(s_sExit, 1);
+}
+
+static void vHostHAL_arm(eHostHALEvent_t p_eEvent, uint64_t p_u64AtNs) {
+  s_abArmed[p_eEvent] = true;
+  s_au64AtNs[p_eEvent] = p_u64AtNs;
+}
+
+static void vHostHAL_disarm(eHostHALEvent_t p_eEvent) {
+  s_abArmed[p_eEvent] = false;
+}
+
+/**
+ * @brief Finds the earliest armed event, the lowest slot on a tie
+ *
+ * @param p_peEvent the event found
+ * @param p_pu64AtNs its time
+ * @return false if nothing is armed
+ */
+static bool bHostHAL_nextEvent(eHostHALEvent_t* p_peEvent, uint64_t* p_pu64AtNs) {
+  bool l_bFound = false;
+  uint32_t i;
+
+  for (i = 0; i < (uint32_t)ceHOST_HAL_EVENT_NB; i++) {
+    if (s_abArmed[i] && (!l_bFound || s_au64AtNs[i] < *p_pu64AtNs)) {
+      *p_peEvent = (eHostHALEvent_t)i;
+      *p_pu64AtNs = s_au64AtNs[i];
+      l_bFound = true;
+    }
+  }
+
+  return l_bFound;
+}
+
+/**
+ * @brief Moves the time to p_u64TargetNs, running the events on the way
+ *
+ * Each event runs at its own time and its interrupts are delivered
+ * before the next one. The run ends here when the time reaches the
+ * configured duration.
+ *
+ * @param p_u64TargetNs the time to reach
+ * @return
+ */
+static void vHostHAL_advanceTo(uint64_t p_u64TargetNs) {
+  eHostHALEvent_t l_eEvent = ceHOST_HAL_EVENT_SYSTICK;
+  uint64_t l_u64AtNs = s_u64NowNs;
+
+  while (bHostHAL_nextEvent(&l_eEvent, &l_u64AtNs) && l_u64AtNs <= p_u64TargetNs) {
+    if (l_u64AtNs >= s_sConfig.u64_duration_ns) {
+      break;
+    }
+    if (l_u64AtNs > s_u64NowNs) {
+      s_u64NowNs = l_u64AtNs;
+    }
+    s_abArmed[l_eEvent] = false;
+    vHostHAL_fire(l_eEvent);
+    vHostHAL_deliver();
+  }
+
+  if (p_u64TargetNs >= s_sConfig.u64_duration_ns) {
+    s_u64NowNs = s_sConfig.u64_duration_ns;
+    vHostHAL_end(false);
+  }
+  if (p_u64TargetNs > s_u64NowNs) {
+    s_u64NowNs = p_u64TargetNs;
+  }
+}
+
+/**
+ * @brief Moves the time to the next event, ends the run if there is none
+ *
+ * @return
+ */
+static void vHostHAL_waitNextEvent(void) {
+  eHostHALEvent_t l_eEvent = ceHOST_HAL_EVENT_SYSTICK;
+  uint64_t l_u64AtNs = s_u64NowNs;
+
+  if (!bHostHAL_nextEvent(&l_eEvent, &l_u64AtNs)) {
+    vHostHAL_end(true);
+  }
+  vHostHAL_advanceTo((l_u64AtNs > s_u64NowNs) ? l_u64AtNs : s_u64NowNs);
+}
+
+static void vHostHAL_fire(eHostHALEvent_t p_eEvent) {
+  sHostHALTimer_t* l_psTimer;
+
+  switch (p_eEvent) {
+    case ceHOST_HAL_EVENT_SYSTICK:
+      vHostHAL_arm(ceHOST_HAL_EVENT_SYSTICK, s_u64NowNs + cHOST_HAL_TICK_NS);
+      if (!s_bTickSuspended) {
+        vHostHAL_pend(SysTick_IRQn);
+      }
+      break;
+
+    case ceHOST_HAL_EVENT_TIM2:
+    case ceHOST_HAL_EVENT_TIM5:
+      l_psTimer = &s_asTimers[(p_eEvent == ceHOST_HAL_EVENT_TIM2) ? 0 : 1];
+      l_psTimer->u32_sr |= l_psTimer->u32_raised;
+      l_psTimer->s_seen.SR = l_psTimer->u32_sr;
+      l_psTimer->s_regs.SR = l_psTimer->u32_sr;
+      vHostHAL_syncTimer(l_psTimer);
+      break;
+
+    case ceHOST_HAL_EVENT_I2C:
+      vHostHAL_fireI2C();
+      break;
+
+    case ceHOST_HAL_EVENT_SPI:
+      vHostHAL_fireSPI();
+      break;
+
+    case ceHOST_HAL_EVENT_EXTI:
+      vHostHAL_fireEXTI();
+      break;
+
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief CPU time tick: breaks a wait that touches no register
+ *
+ * Acts only when no shim call is on the stack and no access happened
+ * since the previous tick, the firmware is then polling memory that only
+ * an interrupt can change.
+ *
+ * @param p_iSignal SIGVTALRM
+ * @return
+ */
+static void vHostHAL_pump(int p_iSignal) {
+  const uint64_t l_u64Accesses = s_u64Accesses;
+
+  (void)p_iSignal;
+  if (!s_bRunning || s_iInside != 0 || l_u64Accesses != s_u64PumpMark) {
+    s_u64PumpMark = l_u64Accesses;
+    return;
+  }
+
+  s_sStats.u32_pumps++;
+  s_iInside++;
+  vHostHAL_waitNextEvent();
+  s_iInside--;
+  s_u64PumpMark = s_u64Accesses;
+}
+
+static int32_t s32HostHAL_index(IRQn_Type p_eIRQ) {
+  const int32_t l_s32Index = (int32_t)p_eIRQ + cHOST_HAL_IRQ_OFFSET;
+
+  return (l_s32Index >= 0 && l_s32Index < (int32_t)cHOST_HAL_IRQ_NB) ? l_s32Index : -1;
+}
+
+static void vHostHAL_pend(IRQn_Type p_eIRQ) {
+  const int32_t l_s32Index = s32HostHAL_index(p_eIRQ);
+
+  if (l_s32Index >= 0) {
+    s_abPending[l_s32Index] = true;
+  }
+}
+
+/**
+ * @brief Finds the pending interrupt that would preempt the current level
+ *
+ * Lowest priority number first, lowest IRQ number on a tie. BASEPRI
+ * masks, PRIMASK is left to the caller since it does not stop WFI.
+ *
+ * @return the index of the interrupt, -1 if none
+ */
+static int32_t s32HostHAL_selectIRQ(void) {
+  uint32_t l_u32Threshold = (s_u32ActiveDepth > 0U) ? s_au32ActivePriority[s_u32ActiveDepth - 1U] : cHOST_HAL_THREAD_PRIORITY;
+  int32_t l_s32Best = -1;
+  int32_t i;
+
+  if (s_u32Basepri != 0U && (s_u32Basepri >> (8U - __NVIC_PRIO_BITS)) < l_u32Threshold) {
+    l_u32Threshold = s_u32Basepri >> (8U - __NVIC_PRIO_BITS);
+  }
+
+  for (i = 0; i < (int32_t)cHOST_HAL_IRQ_NB; i++) {
+    if (
+      s_abPending[i] && s_abEnabled[i] && !s_abActive[i] &&
+      s_au8Priority[i] < l_u32Threshold &&
+      (l_s32Best < 0 || s_au8Priority[i] < s_au8Priority[l_s32Best])
+    ) {
+      l_s32Best = i;
+    }
+  }
+
+  return l_s32Best;
+}
+
+/**
+ * @brief Runs the pending interrupts the current level lets through,
+ * nested on the current stack
+ *
+ * @return
+ */
+static void vHostHAL_deliver(void) {
+  void (*l_pfHandler)(void);
+  sig_atomic_t l_iInside;
+  int32_t l_s32Index;
+
+  while (s_bRunning && s_u32Primask == 0U && s_u32ActiveDepth < cHOST_HAL_NESTING_MAX && (l_s32Index = s32HostHAL_selectIRQ()) >= 0) {
+    s_abPending[l_s32Index] = false;
+    s_abActive[l_s32Index] = true;
+    s_au32ActivePriority[s_u32ActiveDepth++] = s_au8Priority[l_s32Index];
+    s_sStats.u64_irqs++;
+    s_u64Delivered++;
+
+    l_pfHandler = pfHostHAL_handler(l_s32Index);
+    if (l_pfHandler != NULL) {
+      l_iInside = iHostHAL_release();
+      l_pfHandler();
+      vHostHAL_reacquire(l_iInside);
+    }
+
+    s_u32ActiveDepth--;
+    s_abActive[l_s32Index] = false;
+    vHostHAL_sync();
+  }
+}
+
+static void (*pfHostHAL_handler(int32_t p_s32Index))(void) {
+  switch (p_s32Index - cHOST_HAL_IRQ_OFFSET) {
+    case NonMaskableInt_IRQn: return NMI_Handler;
+    case HardFault_IRQn: return HardFault_Handler;
+    case MemoryManagement_IRQn: return MemManage_Handler;
+    case BusFault_IRQn: return BusFault_Handler;
+    case UsageFault_IRQn: return UsageFault_Handler;
+    case SVCall_IRQn: return SVC_Handler;
+    case DebugMonitor_IRQn: return DebugMon_Handler;
+    case PendSV_IRQn: return PendSV_Handler;
+    case SysTick_IRQn: return SysTick_Handler;
+    case EXTI0_IRQn: return EXTI0_IRQHandler;
+    case EXTI1_IRQn: return EXTI1_IRQHandler;
+    case EXTI2_IRQn: return EXTI2_IRQHandler;
+    case EXTI3_IRQn: return EXTI3_IRQHandler;
+    case EXTI4_IRQn: return EXTI4_IRQHandler;
+    case DMA1_Stream0_IRQn: return DMA1_Stream0_IRQHandler;
+    case DMA1_Stream1_IRQn: return DMA1_Stream1_IRQHandler;
+    case DMA1_Stream2_IRQn: return DMA1_Stream2_IRQHandler;
+    case DMA1_Stream3_IRQn: return DMA1_Stream3_IRQHandler;
+    case EXTI9_5_IRQn: return EXTI9_5_IRQHandler;
+    case TIM2_IRQn: return TIM2_IRQHandler;
+    case I2C1_EV_IRQn: return I2C1_EV_IRQHandler;
+    case I2C1_ER_IRQn: return I2C1_ER_IRQHandler;
+    case SPI1_IRQn: return SPI1_IRQHandler;
+    case EXTI15_10_IRQn: return EXTI15_10_IRQHandler;
+    case TIM5_IRQn: return TIM5_IRQHandler;
+    case SAI4_IRQn: return SAI4_IRQHandler;
+    case OCTOSPI2_IRQn: return OCTOSPI2_IRQHandler;
+    case FMAC_IRQn: return FMAC_IRQHandler;
+    case CORDIC_IRQn: return CORDIC_IRQHandler;
+    default: return NULL;
+  }
+}
+
+/**
+ * @brief Core cycles since time 0 at SystemCoreClock
+ *
+ * @return the cycles, modulo 2^32 as CYCCNT
+ */
+static uint32_t u32HostHAL_cycles(void) {
+  const uint64_t l_u64Seconds = s_u64NowNs / 1000000000ULL;
+  const uint64_t l_u64Remainder = s_u64NowNs % 1000000000ULL;
+
+  return (uint32_t)(l_u64Seconds * SystemCoreClock + l_u64Remainder * SystemCoreClock / 1000000000ULL);
+}
+
+/**
+ * @brief Tick of a timer: twice PCLK1 when APB1 is divided, as RCC_D2CFGR
+ *
+ * @param p_psTimer the timer
+ * @return the tick in ns, at least 1
+ */
+static uint64_t u64HostHAL_timerTickNs(const sHostHALTimer_t* p_psTimer) {
+  uint64_t l_u64ClockHz = s_u32PCLK1Hz;
+  uint64_t l_u64TickNs;
+
+  if ((g_sHostHAL_RCC.D2CFGR & RCC_D2CFGR_D2PPRE1) != RCC_APB1_DIV1) {
+    l_u64ClockHz *= 2U;
+  }
+  l_u64TickNs = ((uint64_t)p_psTimer->u32_psc + 1U) * 1000000000ULL / l_u64ClockHz;
+  return (l_u64TickNs > 0U) ? l_u64TickNs : 1U;
+}
+
+static uint32_t u32HostHAL_timerCount(const sHostHALTimer_t* p_psTimer) {
+  const uint64_t l_u64Period = (uint64_t)p_psTimer->u32_arr + 1U;
+  uint64_t l_u64Ticks;
+
+  if (!p_psTimer->b_running) {
+    return p_psTimer->u32_base_count;
+  }
+  l_u64Ticks = (s_u64NowNs - p_psTimer->u64_base_ns) / u64HostHAL_timerTickNs(p_psTimer);
+  return (uint32_t)(((uint64_t)p_psTimer->u32_base_count + l_u64Ticks) % l_u64Period);
+}
+
+static void vHostHAL_rebaseTimer(sHostHALTimer_t* p_psTimer, uint32_t p_u32Count) {
+  p_psTimer->u64_base_ns = s_u64NowNs;
+  p_psTimer->u32_base_count = p_u32Count;
+}
+
+/**
+ * @brief Applies the firmware writes to a timer, publishes CNT and SR,
+ * pends the interrupt and arms the next event
+ *
+ * SR is rc_w0, EGR is self-clearing, a CNT, PSC or ARR write rebases the
+ * counter. The interrupt line is level sensitive: it pends while an
+ * enabled flag is set and the handler is not active.
+ *
+ * @param p_psTimer the timer
+ * @return
+ */
+static void vHostHAL_syncTimer(sHostHALTimer_t* p_psTimer) {
+  TIM_TypeDef* l_psRegs = &p_psTimer->s_regs;
+  const TIM_TypeDef* l_psSeen = &p_psTimer->s_seen;
+  uint32_t l_u32Count = u32HostHAL_timerCount(p_psTimer);
+  bool l_bRebase = false;
+  const int32_t l_s32Index = s32HostHAL_index(p_psTimer->e_irq);
+
+  if (l_psRegs->CNT != l_psSeen->CNT) {
+    l_u32Count = l_psRegs->CNT;
+    l_bRebase = true;
+  }
+  if (l_psRegs->SR != l_psSeen->SR) {
+    p_psTimer->u32_sr &= l_psRegs->SR;
+  }
+  if ((l_psRegs->EGR & TIM_EGR_UG) != 0U) {
+    l_u32Count = 0;
+    p_psTimer->u32_sr |= TIM_SR_UIF;
+    l_bRebase = true;
+  }
+  if ((l_psRegs->EGR & TIM_EGR_CC1G) != 0U) {
+    p_psTimer->u32_sr |= TIM_SR_CC1IF;
+  }
+  if (
+    l_psRegs->PSC != p_psTimer->u32_psc || l_psRegs->ARR != p_psTimer->u32_arr ||
+    ((l_psRegs->CR1 & TIM_CR1_CEN) != 0U) != p_psTimer->b_running
+  ) {
+    l_bRebase = true;
+  }
+
+  if (l_bRebase) {
+    p_psTimer->u32_psc = l_psRegs->PSC;
+    p_psTimer->u32_arr = l_psRegs->ARR;
+    p_psTimer->b_running = (l_psRegs->CR1 & TIM_CR1_CEN) != 0U;
+    vHostHAL_rebaseTimer(p_psTimer, l_u32Count);
+  }
+
+  l_psRegs->CNT = u32HostHAL_timerCount(p_psTimer);
+  l_psRegs->SR = p_psTimer->u32_sr;
+  l_psRegs->EGR = 0;
+  p_psTimer->s_seen = *l_psRegs;
+
+  if ((p_psTimer->u32_sr & l_psRegs->DIER & (TIM_SR_UIF | TIM_SR_CC1IF)) != 0U && !s_abActive[l_s32Index]) {
+    s_abPending[l_s32Index] = true;
+  }
+
+  vHostHAL_scheduleTimer(p_psTimer);
+}
+
+/**
+ * @brief Arms the next update or compare match of a running timer
+ *
+ * A compare equal to the counter matches one period later.
+ *
+ * @param p_psTimer the timer
+ * @return
+ */
+static void vHostHAL_scheduleTimer(sHostHALTimer_t* p_psTimer) {
+  const uint64_t l_u64Period = (uint64_t)p_psTimer->u32_arr + 1U;
+  uint64_t l_u64TickNs;
+  uint64_t l_u64Ticks;
+  uint64_t l_u64Count;
+  uint64_t l_u64ToUpdate;
+  uint64_t l_u64ToCompare = UINT64_MAX;
+  uint64_t l_u64Delta;
+
+  if (!p_psTimer->b_running) {
+    vHostHAL_disarm(p_psTimer->e_event);
+    return;
+  }
+
+  l_u64TickNs = u64HostHAL_timerTickNs(p_psTimer);
+  l_u64Ticks = (s_u64NowNs - p_psTimer->u64_base_ns) / l_u64TickNs;
+  l_u64Count = ((uint64_t)p_psTimer->u32_base_count + l_u64Ticks) % l_u64Period;
+
+  l_u64ToUpdate = l_u64Period - l_u64Count;
+  if ((uint64_t)p_psTimer->s_regs.CCR1 < l_u64Period) {
+    l_u64ToCompare = ((uint64_t)p_psTimer->s_regs.CCR1 + l_u64Period - l_u64Count) % l_u64Period;
+    if (l_u64ToCompare == 0U) {
+      l_u64ToCompare = l_u64Period;
+    }
+  }
+
+  l_u64Delta = (l_u64ToCompare < l_u64ToUpdate) ? l_u64ToCompare : l_u64ToUpdate;
+  p_psTimer->u32_raised = ((l_u64Delta == l_u64ToUpdate) ? TIM_SR_UIF : 0U) | ((l_u64Delta == l_u64ToCompare) ? TIM_SR_CC1IF : 0U);
+  vHostHAL_arm(p_psTimer->e_event, p_psTimer->u64_base_ns + (l_u64Ticks + l_u64Delta) * l_u64TickNs);
+}
+
+static sHostHALTimer_t* psHostHAL_timer(const TIM_TypeDef* p_psInstance) {
+  if (p_psInstance == &s_asTimers[0].s_regs) {
+    return &s_asTimers[0];
+  }
+  if (p_psInstance == &s_asTimers[1].s_regs) {
+    return &s_asTimers[1];
+  }
+  return NULL;
+}
+
+static uint32_t u32HostHAL_busUs(void) {
+  return (uint32_t)(s_u64NowNs / 1000U);
+}
+
+/**
+ * @brief Register-level I2C1 step, on each access to I2C1
+ *
+ * Picks the ICR, CR2 and TXDR writes, raises the flags of a transfer once
+ * its bus time has passed and hands the read bytes through RXDR: the next
+ * byte shows on the second access after the previous one, the RXDR read
+ * and the next ISR poll of the firmware loop. Accesses from an interrupt
+ * nested in the transfer only see the registers.
+ *
+ * @return
+ */
+static void vHostHAL_stepI2C(void) {
+  I2C_TypeDef* l_psRegs = &s_sI2C.s_regs;
+
+  if (s_sI2C.e_phase != ceHOST_HAL_LL_IDLE && s_sI2C.u32_depth != s_u32ActiveDepth) {
+    l_psRegs->ISR = s_sI2C.u32_isr;
+    return;
+  }
+
+  if (l_psRegs->ICR != 0U) {
+    s_sI2C.u32_isr &= ~(l_psRegs->ICR & (I2C_ICR_NACKCF | I2C_ICR_STOPCF | I2C_ICR_BERRCF | I2C_ICR_ARLOCF));
+    l_psRegs->ICR = 0;
+  }
+
+  if ((l_psRegs->CR2 & I2C_CR2_STOP) != 0U) {
+    l_psRegs->CR2 &= ~I2C_CR2_STOP;
+    if (s_sI2C.e_phase != ceHOST_HAL_LL_IDLE) {
+      s_sI2C.e_phase = ceHOST_HAL_LL_IDLE;
+      s_sI2C.b_pending = false;
+      s_sI2C.u32_isr &= ~(I2C_ISR_BUSY | I2C_ISR_TXIS | I2C_ISR_TC | I2C_ISR_RXNE);
+      s_sI2C.u32_isr |= I2C_ISR_STOPF;
+    }
+  }
+
+  if ((l_psRegs->CR2 & I2C_CR2_START) != 0U) {
+    l_psRegs->CR2 &= ~I2C_CR2_START;
+    vHostHAL_startI2C(l_psRegs->CR2);
+  }
+
+  if (l_psRegs->TXDR != cHOST_HAL_TXDR_EMPTY) {
+    vHostHAL_writeI2C((uint8_t)l_psRegs->TXDR);
+    l_psRegs->TXDR = cHOST_HAL_TXDR_EMPTY;
+  }
+
+  if (s_sI2C.b_pending) {
+    /* The firmware polls before the bus is done, the time passes */
+    if (s_u64NowNs < s_sI2C.u64_ready_ns) {
+      vHostHAL_advanceTo(s_sI2C.u64_ready_ns);
+    }
+    s_sI2C.b_pending = false;
+    s_sI2C.u32_isr = (s_sI2C.u32_isr & ~s_sI2C.u32_ready_clear) | s_sI2C.u32_ready_set;
+    if (s_sI2C.e_phase == ceHOST_HAL_LL_RX) {
+      s_sI2C.u16_index = 0;
+      s_sI2C.u32_rx_accesses = 0;
+      l_psRegs->RXDR = s_sI2C.au8_data[0];
+    }
+  }
+  else if (s_sI2C.e_phase == ceHOST_HAL_LL_RX && ++s_sI2C.u32_rx_accesses >= 2U) {
+    s_sI2C.u32_rx_accesses = 0;
+    s_sI2C.u16_index++;
+    if (s_sI2C.u16_index < s_sI2C.u16_size) {
+      l_psRegs->RXDR = s_sI2C.au8_data[s_sI2C.u16_index];
+    }
+    else {
+      s_sI2C.e_phase = ceHOST_HAL_LL_IDLE;
+      s_sI2C.u32_isr &= ~(I2C_ISR_RXNE | I2C_ISR_BUSY);
+      s_sI2C.u32_isr |= I2C_ISR_STOPF;
+    }
+  }
+
+  l_psRegs->ISR = s_sI2C.u32_isr;
+}
+
+/**
+ * @brief START written in CR2: a write phase waits for TXDR, a read
+ * phase runs on the simulated bus with the register sent before
+ *
+ * @param p_u32CR2 the CR2 value
+ * @return
+ */
+static void vHostHAL_startI2C(uint32_t p_u32CR2) {
+  eSIM_BusResult_t l_eResult;
+  uint32_t l_u32DurationUs = 0;
+
+  s_sI2C.u8_address = (uint8_t)((p_u32CR2 & I2C_CR2_SADD) >> 1);
+  s_sI2C.u32_nbytes = (p_u32CR2 & I2C_CR2_NBYTES) >> I2C_CR2_NBYTES_Pos;
+  s_sI2C.b_autoend = (p_u32CR2 & I2C_CR2_AUTOEND) != 0U;
+  s_sI2C.u32_depth = s_u32ActiveDepth;
+  s_sI2C.b_pending = false;
+  s_sI2C.u32_isr &= ~(I2C_ISR_TXIS | I2C_ISR_TC | I2C_ISR_RXNE | I2C_ISR_STOPF);
+  s_sI2C.u32_isr |= I2C_ISR_BUSY;
+
+  if ((p_u32CR2 & I2C_CR2_RD_WRN) == 0U) {
+    s_sI2C.e_phase = ceHOST_HAL_LL_TX;
+    s_sI2C.b_register = false;
+    s_sI2C.u16_size = 0;
+    s_sI2C.u32_isr |= I2C_ISR_TXIS;
+    return;
+  }
+
+  s_sI2C.u16_size = (uint16_t)s_sI2C.u32_nbytes;
+  s_sStats.u32_i2c_ll++;
+  l_eResult = eSIM_Bus_memRead(s_sI2C.u8_address, s_sI2C.u8_register, s_sI2C.au8_data, s_sI2C.u16_size, u32HostHAL_busUs(), &l_u32DurationUs);
+  s_sI2C.e_phase = (l_eResult == ceSIM_BUS_OK && s_sI2C.u16_size > 0U) ? ceHOST_HAL_LL_RX : ceHOST_HAL_LL_END;
+  vHostHAL_readyI2C(l_eResult, l_u32DurationUs);
+}
+
+/**
+ * @brief Byte written in TXDR: the register first, then the data, the
+ * transfer runs on the simulated bus at its last byte
+ *
+ * @param p_u8Byte the byte
+ * @return
+ */
+static void vHostHAL_writeI2C(uint8_t p_u8Byte) {
+  eSIM_BusResult_t l_eResult;
+  uint32_t l_u32DurationUs = 0;
+
+  if (s_sI2C.e_phase != ceHOST_HAL_LL_TX || s_sI2C.u32_nbytes == 0U) {
+    return;
+  }
+
+  if (!s_sI2C.b_register) {
+    s_sI2C.u8_register = p_u8Byte;
+    s_sI2C.b_register = true;
+  }
+  else if (s_sI2C.u16_size < cHOST_HAL_I2C_BUFFER_SIZE) {
+    s_sI2C.au8_data[s_sI2C.u16_size++] = p_u8Byte;
+  }
+
+  if (--s_sI2C.u32_nbytes > 0U) {
+    return;
+  }
+  s_sI2C.u32_isr &= ~I2C_ISR_TXIS;
+
+  if (!s_sI2C.b_autoend) {
+    /* Register phase of a read, the repeated START follows */
+    s_sI2C.e_phase = ceHOST_HAL_LL_RESTART;
+    s_sI2C.u32_isr |= I2C_ISR_TC;
+    return;
+  }
+
+  s_sStats.u32_i2c_ll++;
+  l_eResult = eSIM_Bus_memWrite(s_sI2C.u8_address, s_sI2C.u8_register, s_sI2C.au8_data, s_sI2C.u16_size, u32HostHAL_busUs(), &l_u32DurationUs);
+  s_sI2C.e_phase = ceHOST_HAL_LL_END;
+  vHostHAL_readyI2C(l_eResult, l_u32DurationUs);
+}
+
+/**
+ * @brief Sets the flags a transfer raises once its bus time has passed
+ *
+ * A DMA error of the simulated bus has no DMA to hit here, it is taken
+ * as a bus error.
+ *
+ * @param p_eResult the simulated bus result
+ * @param p_u32DurationUs the bus time
+ * @return
+ */
+static void vHostHAL_readyI2C(eSIM_BusResult_t p_eResult, uint32_t p_u32DurationUs) {
+  s_sI2C.b_pending = true;
+  s_sI2C.u64_ready_ns = s_u64NowNs + (uint64_t)p_u32DurationUs * 1000U;
+
+  if (p_eResult == ceSIM_BUS_OK) {
+    if (s_sI2C.e_phase == ceHOST_HAL_LL_RX) {
+      s_sI2C.u32_ready_set = I2C_ISR_RXNE;
+      s_sI2C.u32_ready_clear = 0;
+    }
+    else {
+      s_sI2C.e_phase = ceHOST_HAL_LL_IDLE;
+      s_sI2C.u32_ready_set = I2C_ISR_STOPF;
+      s_sI2C.u32_ready_clear = I2C_ISR_BUSY;
+    }
+    return;
+  }
+
+  s_sStats.u32_i2c_errors++;
+  s_sI2C.e_phase = ceHOST_HAL_LL_IDLE;
+  s_sI2C.u32_ready_clear = I2C_ISR_BUSY;
+  if (p_eResult == ceSIM_BUS_NACK) {
+    s_sI2C.u32_ready_set = I2C_ISR_STOPF | I2C_ISR_NACKF;
+  }
+  else if (p_eResult == ceSIM_BUS_ARB_LOST) {
+    s_sI2C.u32_ready_set = I2C_ISR_ARLO;
+  }
+  else {
+    s_sI2C.u32_ready_set = I2C_ISR_STOPF | I2C_ISR_BERR;
+  }
+}
+
+static uint32_t u32HostHAL_i2cErrorCode(eSIM_BusResult_t p_eResult) {
+  switch (p_eResult) {
+    case ceSIM_BUS_NACK: return HAL_I2C_ERROR_AF;
+    case ceSIM_BUS_ARB_LOST: return HAL_I2C_ERROR_ARLO;
+    case ceSIM_BUS_DMA_ERROR: return HAL_I2C_ERROR_BERR;
+    default: return HAL_I2C_ERROR_NONE;
+  }
+}
+
+/**
+ * @brief Drops the transfers in flight and resets the I2C1 registers
+ *
+ * @return
+ */
+static void vHostHAL_cancelI2C(void) {
+  s_sI2C.e_phase = ceHOST_HAL_LL_IDLE;
+  s_sI2C.b_pending = false;
+  s_sI2C.u32_isr = I2C_ISR_TXE;
+  s_sI2C.s_regs.CR1 = 0;
+  s_sI2C.s_regs.CR2 = 0;
+  s_sI2C.s_regs.ICR = 0;
+  s_sI2C.s_regs.ISR = I2C_ISR_TXE;
+  s_sI2C.s_regs.TXDR = cHOST_HAL_TXDR_EMPTY;
+
+  s_sXfer.e_phase = ceHOST_HAL_XFER_IDLE;
+  s_sXfer.b_ev = false;
+  s_sXfer.b_er = false;
+  vHostHAL_disarm(ceHOST_HAL_EVENT_I2C);
+}
+
+/**
+ * @brief Starts a HAL memory transfer
+ *
+ * The simulated bus runs it now. Blocking transfers wait for its end,
+ * the others get their events: one per byte in IT mode, the stream
+ * complete one bit before the end then STOP in DMA mode, the error at the
+ * end on a NACK or arbitration loss.
+ *
+ * @return HAL_BUSY if the handle is not ready, HAL_ERROR on a size the
+ * simulated bus does not take or a failed blocking transfer
+ */
+static HAL_StatusTypeDef eHostHAL_startXfer(I2C_HandleTypeDef* p_phI2C, uint16_t p_u16DevAddress, uint16_t p_u16MemAddress, uint8_t* p_pu8Data, uint16_t p_u16Size, bool p_bRead, eHostHALMode_t p_eMode) {
+  uint32_t l_u32DurationUs = 0;
+  uint64_t l_u64BitNs;
+
+  vHostHAL_enter();
+  if (p_phI2C->State != HAL_I2C_STATE_READY) {
+    vHostHAL_leave();
+    return HAL_BUSY;
+  }
+  if (p_u16Size == 0U || p_u16Size > cHOST_HAL_I2C_BUFFER_SIZE || p_pu8Data == NULL) {
+    p_phI2C->ErrorCode = HAL_I2C_ERROR_NONE;
+    vHostHAL_leave();
+    return HAL_ERROR;
+  }
+
+  p_phI2C->State = p_bRead ? HAL_I2C_STATE_BUSY_RX : HAL_I2C_STATE_BUSY_TX;
+  p_phI2C->Mode = HAL_I2C_MODE_MEM;
+  p_phI2C->ErrorCode = HAL_I2C_ERROR_NONE;
+  p_phI2C->pBuffPtr = p_pu8Data;
+  p_phI2C->XferSize = p_u16Size;
+  p_phI2C->XferCount = p_u16Size;
+  p_phI2C->Devaddress = p_u16DevAddress;
+  p_phI2C->Memaddress = p_u16MemAddress;
+
+  s_sXfer.ph_i2c = p_phI2C;
+  s_sXfer.b_read = p_bRead;
+  s_sXfer.u16_size = p_u16Size;
+  s_sXfer.u16_fired = 0;
+  s_sXfer.u16_served = 0;
+  s_sXfer.b_ev = false;
+  s_sXfer.b_er = false;
+
+  if (p_bRead) {
+    s_sXfer.e_result = eSIM_Bus_memRead((uint8_t)(p_u16DevAddress >> 1), (uint8_t)p_u16MemAddress, s_sXfer.au8_data, p_u16Size, u32HostHAL_busUs(), &l_u32DurationUs);
+  }
+  else {
+    memcpy(s_sXfer.au8_data, p_pu8Data, p_u16Size);
+    s_sXfer.e_result = eSIM_Bus_memWrite((uint8_t)(p_u16DevAddress >> 1), (uint8_t)p_u16MemAddress, s_sXfer.au8_data, p_u16Size, u32HostHAL_busUs(), &l_u32DurationUs);
+  }
+  s_sXfer.u64_start_ns = s_u64NowNs;
+  s_sXfer.u64_end_ns = s_u64NowNs + (uint64_t)l_u32DurationUs * 1000U;
+
+  if (p_eMode == ceHOST_HAL_MODE_BLOCKING) {
+    s_sStats.u32_i2c_blocking++;
+    vHostHAL_advanceTo(s_sXfer.u64_end_ns);
+    p_phI2C->State = HAL_I2C_STATE_READY;
+    p_phI2C->Mode = HAL_I2C_MODE_NONE;
+    if (s_sXfer.e_result != ceSIM_BUS_OK) {
+      s_sStats.u32_i2c_errors++;
+      p_phI2C->ErrorCode = u32HostHAL_i2cErrorCode(s_sXfer.e_result);
+      vHostHAL_leave();
+      return HAL_ERROR;
+    }
+    if (p_bRead) {
+      memcpy(p_pu8Data, s_sXfer.au8_data, p_u16Size);
+    }
+    vHostHAL_leave();
+    return HAL_OK;
+  }
+
+  if (p_eMode == ceHOST_HAL_MODE_IT) {
+    s_sStats.u32_i2c_it++;
+    if (s_sXfer.e_result == ceSIM_BUS_OK) {
+      s_sXfer.e_phase = ceHOST_HAL_XFER_IT;
+      vHostHAL_arm(ceHOST_HAL_EVENT_I2C, s_sXfer.u64_start_ns + (s_sXfer.u64_end_ns - s_sXfer.u64_start_ns) / p_u16Size);
+    }
+    else {
+      s_sXfer.e_phase = ceHOST_HAL_XFER_ERROR;
+      vHostHAL_arm(ceHOST_HAL_EVENT_I2C, s_sXfer.u64_end_ns);
+    }
+    vHostHAL_leave();
+    return HAL_OK;
+  }
+
+  s_sStats.u32_i2c_dma++;
+  s_sXfer.ph_dma = p_bRead ? p_phI2C->hdmarx : p_phI2C->hdmatx;
+  if (s_sXfer.ph_dma != NULL) {
+    s_sXfer.ph_dma->State = HAL_DMA_STATE_BUSY;
+    s_sXfer.ph_dma->ErrorCode = HAL_DMA_ERROR_NONE;
+    s_sXfer.ph_dma->XferCpltCallback = vHostHAL_xferDMACplt;
+    s_sXfer.ph_dma->XferErrorCallback = vHostHAL_xferDMAError;
+  }
+  if (s_sXfer.e_result == ceSIM_BUS_OK || s_sXfer.e_result == ceSIM_BUS_DMA_ERROR) {
+    l_u64BitNs = (uint64_t)cSIM_BUS_BIT_US * 1000U;
+    s_sXfer.e_phase = ceHOST_HAL_XFER_DMA;
+    vHostHAL_arm(ceHOST_HAL_EVENT_I2C, (s_sXfer.u64_end_ns - s_sXfer.u64_start_ns > l_u64BitNs) ? s_sXfer.u64_end_ns - l_u64BitNs : s_sXfer.u64_start_ns);
+  }
+  else {
+    s_sXfer.e_phase = ceHOST_HAL_XFER_ERROR;
+    vHostHAL_arm(ceHOST_HAL_EVENT_I2C, s_sXfer.u64_end_ns);
+  }
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+static void vHostHAL_fireI2C(void) {
+  switch (s_sXfer.e_phase) {
+    case ceHOST_HAL_XFER_IT:
+      s_sXfer.u16_fired++;
+      s_sXfer.b_ev = true;
+      vHostHAL_pend(I2C1_EV_IRQn);
+      if (s_sXfer.u16_fired < s_sXfer.u16_size) {
+        vHostHAL_arm(
+          ceHOST_HAL_EVENT_I2C,
+          s_sXfer.u64_start_ns + (s_sXfer.u64_end_ns - s_sXfer.u64_start_ns) * (s_sXfer.u16_fired + 1U) / s_sXfer.u16_size
+        );
+      }
+      break;
+
+    case ceHOST_HAL_XFER_DMA:
+      if (s_sXfer.ph_dma == NULL) {
+        s_sXfer.e_phase = ceHOST_HAL_XFER_STOP;
+        vHostHAL_arm(ceHOST_HAL_EVENT_I2C, s_sXfer.u64_end_ns);
+        break;
+      }
+      vHostHAL_raiseDMA(s_sXfer.ph_dma, (s_sXfer.e_result == ceSIM_BUS_OK) ? cHOST_HAL_DMA_TC : cHOST_HAL_DMA_TE);
+      break;
+
+    case ceHOST_HAL_XFER_STOP:
+      s_sXfer.b_ev = true;
+      vHostHAL_pend(I2C1_EV_IRQn);
+      break;
+
+    case ceHOST_HAL_XFER_ERROR:
+      s_sXfer.b_er = true;
+      vHostHAL_pend(I2C1_ER_IRQn);
+      break;
+
+    default:
+      break;
+  }
+}
+
+/**
+ * @brief Completes the HAL transfer: data to the caller, handle ready,
+ * completion callback
+ *
+ * @return
+ */
+static void vHostHAL_finishXfer(void) {
+  I2C_HandleTypeDef* l_phI2C = s_sXfer.ph_i2c;
+  sig_atomic_t l_iInside;
+
+  s_sXfer.e_phase = ceHOST_HAL_XFER_IDLE;
+  if (s_sXfer.b_read) {
+    memcpy(l_phI2C->pBuffPtr, s_sXfer.au8_data, s_sXfer.u16_size);
+  }
+  l_phI2C->XferISR = NULL;
+  l_phI2C->PreviousState = (uint32_t)l_phI2C->State;
+  l_phI2C->State = HAL_I2C_STATE_READY;
+  l_phI2C->Mode = HAL_I2C_MODE_NONE;
+
+  l_iInside = iHostHAL_release();
+  if (s_sXfer.b_read) {
+    HAL_I2C_MemRxCpltCallback(l_phI2C);
+  }
+  else {
+    HAL_I2C_MemTxCpltCallback(l_phI2C);
+  }
+  vHostHAL_reacquire(l_iInside);
+}
+
+/* Stream done, the peripheral sends STOP after the last byte */
+static void vHostHAL_xferDMACplt(DMA_HandleTypeDef* p_phDMA) {
+  (void)p_phDMA;
+  if (s_sXfer.e_phase == ceHOST_HAL_XFER_DMA) {
+    s_sXfer.e_phase = ceHOST_HAL_XFER_STOP;
+    vHostHAL_arm(ceHOST_HAL_EVENT_I2C, (s_sXfer.u64_end_ns > s_u64NowNs) ? s_sXfer.u64_end_ns : s_u64NowNs);
+  }
+}
+
+static void vHostHAL_xferDMAError(DMA_HandleTypeDef* p_phDMA) {
+  I2C_HandleTypeDef* l_phI2C = (I2C_HandleTypeDef*)p_phDMA->Parent;
+
+  if (s_sXfer.e_phase != ceHOST_HAL_XFER_DMA || l_phI2C == NULL) {
+    return;
+  }
+  s_sXfer.e_phase = ceHOST_HAL_XFER_IDLE;
+  s_sStats.u32_i2c_errors++;
+  l_phI2C->ErrorCode |= HAL_I2C_ERROR_DMA;
+  l_phI2C->XferISR = NULL;
+  l_phI2C->State = HAL_I2C_STATE_READY;
+  l_phI2C->Mode = HAL_I2C_MODE_NONE;
+  HAL_I2C_ErrorCallback(l_phI2C); //Called from HAL_DMA_IRQHandler, already released
+}
+
+static int32_t s32HostHAL_stream(const DMA_HandleTypeDef* p_phDMA) {
+  const DMA_Stream_TypeDef* l_psStream = (const DMA_Stream_TypeDef*)p_phDMA->Instance;
+
+  if (l_psStream < &g_asHostHAL_DMAStreams[0] || l_psStream >= &g_asHostHAL_DMAStreams[cHOST_HAL_DMA_STREAM_NB]) {
+    return -1;
+  }
+  return (int32_t)(l_psStream - &g_asHostHAL_DMAStreams[0]);
+}
+
+static void vHostHAL_raiseDMA(DMA_HandleTypeDef* p_phDMA, uint32_t p_u32Flag) {
+  const int32_t l_s32Stream = s32HostHAL_stream(p_phDMA);
+
+  if (l_s32Stream < 0) {
+    return;
+  }
+  s_au32DMAFlags[l_s32Stream] |= p_u32Flag;
+  vHostHAL_pend((IRQn_Type)((int32_t)DMA1_Stream0_IRQn + l_s32Stream));
+}
+
+/**
+ * @brief Starts an SPI transfer, MISO reads 0xFF
+ *
+ * A byte takes 8 SCK periods of the 64 MHz kernel clock divided by the
+ * baud rate prescaler.
+ *
+ * @return HAL_BUSY if the handle is not ready
+ */
+static HAL_StatusTypeDef eHostHAL_startSPI(SPI_HandleTypeDef* p_phSPI, uint8_t* p_pu8RxData, uint16_t p_u16Size, eHostHALMode_t p_eMode) {
+  const uint64_t l_u64Divider = 2ULL << (p_phSPI->Init.BaudRatePrescaler >> 28);
+  const uint64_t l_u64EndNs = s_u64NowNs + (uint64_t)p_u16Size * 8U * l_u64Divider * 1000000000ULL / cHOST_HAL_SPI_KERNEL_HZ;
+
+  vHostHAL_enter();
+  if (p_phSPI->State != HAL_SPI_STATE_READY) {
+    vHostHAL_leave();
+    return HAL_BUSY;
+  }
+  s_sStats.u32_spi++;
+
+  p_phSPI->ErrorCode = HAL_SPI_ERROR_NONE;
+  p_phSPI->pRxBuffPtr = p_pu8RxData;
+  p_phSPI->RxXferSize = p_u16Size;
+  p_phSPI->TxXferSize = p_u16Size;
+
+  if (p_eMode == ceHOST_HAL_MODE_BLOCKING) {
+    p_phSPI->State = HAL_SPI_STATE_BUSY_TX_RX;
+    vHostHAL_advanceTo(l_u64EndNs);
+    if (p_pu8RxData != NULL) {
+      memset(p_pu8RxData, 0xFF, p_u16Size);
+    }
+    p_phSPI->State = HAL_SPI_STATE_READY;
+    vHostHAL_leave();
+    return HAL_OK;
+  }
+
+  p_phSPI->State = HAL_SPI_STATE_BUSY_TX_RX;
+  s_sSPI.ph_spi = p_phSPI;
+  s_sSPI.b_dma = (p_eMode == ceHOST_HAL_MODE_DMA);
+  s_sSPI.b_done = false;
+  if (s_sSPI.b_dma) {
+    if (p_phSPI->hdmarx != NULL) {
+      p_phSPI->hdmarx->State = HAL_DMA_STATE_BUSY;
+      p_phSPI->hdmarx->XferCpltCallback = vHostHAL_spiDMARxCplt;
+    }
+    if (p_phSPI->hdmatx != NULL) {
+      p_phSPI->hdmatx->State = HAL_DMA_STATE_BUSY;
+      p_phSPI->hdmatx->XferCpltCallback = vHostHAL_spiDMATxCplt;
+    }
+  }
+  vHostHAL_arm(ceHOST_HAL_EVENT_SPI, l_u64EndNs);
+  vHostHAL_leave();
+  return HAL_OK;
+}
+
+static void vHostHAL_fireSPI(void) {
+  SPI_HandleTypeDef* l_phSPI = s_sSPI.ph_spi;
+
+  if (l_phSPI == NULL) {
+    return;
+  }
+  if (!s_sSPI.b_dma) {
+    s_sSPI.b_done = true;
+    vHostHAL_pend(SPI1_IRQn);
+    return;
+  }
+  if (l_phSPI->hdmatx != NULL) {
+    vHostHAL_raiseDMA(l_phSPI->hdmatx, cHOST_HAL_DMA_TC);
+  }
+  if (l_phSPI->hdmarx != NULL) {
+    vHostHAL_raiseDMA(l_phSPI->hdmarx, cHOST_HAL_DMA_TC);
+  }
+  else {
+    vHostHAL_finishSPI(l_phSPI);
+  }
+}
+
+static void vHostHAL_finishSPI(SPI_HandleTypeDef* p_phSPI) {
+  sig_atomic_t l_iInside;
+
+  if (p_phSPI->pRxBuffPtr != NULL) {
+    memset(p_phSPI->pRxBuffPtr, 0xFF, p_phSPI->RxXferSize);
+  }
+  p_phSPI->RxXferCount = 0;
+  p_phSPI->TxXferCount = 0;
+  p_phSPI->State = HAL_SPI_STATE_READY;
+  s_sSPI.ph_spi = NULL;
+
+  l_iInside = iHostHAL_release();
+  HAL_SPI_TxRxCpltCallback(p_phSPI);
+  vHostHAL_reacquire(l_iInside);
+}
+
+static void vHostHAL_spiDMARxCplt(DMA_HandleTypeDef* p_phDMA) {
+  SPI_HandleTypeDef* l_phSPI = (SPI_HandleTypeDef*)p_phDMA->Parent;
+
+  if (l_phSPI != NULL && l_phSPI->State == HAL_SPI_STATE_BUSY_TX_RX) {
+    vHostHAL_finishSPI(l_phSPI);
+  }
+}
+
+static void vHostHAL_spiDMATxCplt(DMA_HandleTypeDef* p_phDMA) {
+  (void)p_phDMA; //The receive stream completes the transfer
+}
+
+static int32_t s32HostHAL_port(const GPIO_TypeDef* p_psPort) {
+  if (p_psPort < &g_asHostHAL_GPIO[0] || p_psPort >= &g_asHostHAL_GPIO[cHOST_HAL_GPIO_PORT_NB]) {
+    return -1;
+  }
+  return (int32_t)(p_psPort - &g_asHostHAL_GPIO[0]);
+}
+
+/**
+ * @brief Raises the next queued EXTI line
+ *
+ * @return
+ */
+static void vHostHAL_fireEXTI(void) {
+  const uint16_t l_u16Pin = s_asEXTIQueue[0].u16_pin;
+  const uint32_t l_u32Line = (uint32_t)__builtin_ctz(l_u16Pin);
+  bool l_bRouted = false;
+  uint32_t i;
+
+  s_u32EXTICount--;
+  memmove(&s_asEXTIQueue[0], &s_asEXTIQueue[1], s_u32EXTICount * sizeof(s_asEXTIQueue[0]));
+  if (s_u32EXTICount > 0U) {
+    vHostHAL_arm(ceHOST_HAL_EVENT_EXTI, s_asEXTIQueue[0].u64_at_ns);
+  }
+
+  for (i = 0; i < cHOST_HAL_GPIO_PORT_NB; i++) {
+    if ((s_aau32PinMode[i][l_u32Line] & GPIO_MODE_EXTI_IT) != 0U) {
+      l_bRouted = true;
+    }
+  }
+  if (!l_bRouted) {
+    return;
+  }
+
+  s_sStats.u32_exti++;
+  s_u32EXTIPending |= l_u16Pin;
+  if (l_u32Line <= 4U) {
+    vHostHAL_pend((IRQn_Type)((int32_t)EXTI0_IRQn + (int32_t)l_u32Line));
+  }
+  else if (l_u32Line <= 9U) {
+    vHostHAL_pend(EXTI9_5_IRQn);
+  }
+  else {
+    vHostHAL_pend(EXTI15_10_IRQn);
+  }
+}
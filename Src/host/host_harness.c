@@ -0,0 +1,170 @@
+/**
+  ******************************************************************************
+  * @file           : host_harness.c
+  * @brief          : Host benchmark harness: warmup, timed repetitions,
+  * median and p99, table or JSON report
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "host/host_harness.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+volatile uint32_t g_u32HostHarnessSink;
+
+static double s_adSamplesNs[cHOST_HARNESS_REPETITION_MAX];
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t u64HostHarness_getNs(void);
+static int iHostHarness_compare(const void* p_pvLeft, const void* p_pvRight);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Runs a case and computes its statistics
+ * 
+ * Each repetition times u32_iterations iterations with the monotonic clock
+ * and gives one time per iteration. The median and the p99 are taken over
+ * the repetitions, the p99 being the nearest rank.
+ * 
+ * @param p_psConfig the warmup and repetitions
+ * @param p_psCase the case
+ * @param p_psStats the statistics to fill
+ * @return
+ */
+void vHostHarness_run(const sHostHarnessConfig_t* p_psConfig, const sHostHarnessCase_t* p_psCase, sHostHarnessStats_t* p_psStats) {
+  uint32_t l_u32Repetitions = p_psConfig->u32_repetitions;
+  uint32_t l_u32Checksum = 0;
+  uint64_t l_u64StartNs;
+  uint32_t l_u32Rank;
+  uint32_t k;
+
+  memset(p_psStats, 0, sizeof(*p_psStats));
+  if (l_u32Repetitions == 0 || p_psCase->u32_iterations == 0) {
+    return;
+  }
+  if (l_u32Repetitions > cHOST_HARNESS_REPETITION_MAX) {
+    l_u32Repetitions = cHOST_HARNESS_REPETITION_MAX;
+  }
+
+  if (p_psCase->pf_setup != NULL) {
+    p_psCase->pf_setup(p_psCase->pv_context);
+  }
+  for (k = 0; k < p_psConfig->u32_warmup; k++) {
+    g_u32HostHarnessSink += p_psCase->pf_run(p_psCase->pv_context, p_psCase->u32_iterations);
+  }
+
+  for (k = 0; k < l_u32Repetitions; k++) {
+    l_u64StartNs = u64HostHarness_getNs();
+    l_u32Checksum += p_psCase->pf_run(p_psCase->pv_context, p_psCase->u32_iterations);
+    s_adSamplesNs[k] = (double)(u64HostHarness_getNs() - l_u64StartNs) / p_psCase->u32_iterations;
+  }
+  g_u32HostHarnessSink += l_u32Checksum;
+
+  qsort(s_adSamplesNs, l_u32Repetitions, sizeof(s_adSamplesNs[0]), iHostHarness_compare);
+  l_u32Rank = (l_u32Repetitions * 99U + 99U) / 100U;
+
+  p_psStats->d_median_ns = (l_u32Repetitions % 2U != 0) ?
+    s_adSamplesNs[l_u32Repetitions / 2U] :
+    (s_adSamplesNs[l_u32Repetitions / 2U - 1U] + s_adSamplesNs[l_u32Repetitions / 2U]) / 2.0;
+  p_psStats->d_p99_ns = s_adSamplesNs[l_u32Rank - 1U];
+  p_psStats->d_min_ns = s_adSamplesNs[0];
+  p_psStats->d_max_ns = s_adSamplesNs[l_u32Repetitions - 1U];
+  p_psStats->d_items_per_s = (p_psStats->d_median_ns > 0.0) ?
+    p_psCase->u32_items * 1e9 / p_psStats->d_median_ns : 0.0;
+  p_psStats->u32_checksum = l_u32Checksum;
+}
+
+/**
+ * @brief Prints the statistics as a table
+ * 
+ * @param p_pFile the output
+ * @param p_psCases the cases
+ * @param p_psStats the statistics of each case
+ * @param p_u32Count the number of cases
+ * @return
+ */
+void vHostHarness_printTable(FILE* p_pFile, const sHostHarnessCase_t* p_psCases, const sHostHarnessStats_t* p_psStats, uint32_t p_u32Count) {
+  uint32_t i;
+
+  fprintf(p_pFile, "%-24s %12s %12s %12s %14s\n", "case", "median ns", "p99 ns", "min ns", "items/s");
+  for (i = 0; i < p_u32Count; i++) {
+    fprintf(p_pFile, "%-24s %12.2f %12.2f %12.2f %14.0f\n",
+      p_psCases[i].pc_name, p_psStats[i].d_median_ns, p_psStats[i].d_p99_ns,
+      p_psStats[i].d_min_ns, p_psStats[i].d_items_per_s);
+  }
+}
+
+/**
+ * @brief Prints the statistics as a JSON document
+ * 
+ * Times are in ns per iteration. Case names are printed as is, they must
+ * not need escaping.
+ * 
+ * @param p_pFile the output
+ * @param p_psConfig the warmup and repetitions the cases ran with
+ * @param p_psCases the cases
+ * @param p_psStats the statistics of each case
+ * @param p_u32Count the number of cases
+ * @return
+ */
+void vHostHarness_printJSON(FILE* p_pFile, const sHostHarnessConfig_t* p_psConfig, const sHostHarnessCase_t* p_psCases, const sHostHarnessStats_t* p_psStats, uint32_t p_u32Count) {
+  uint32_t i;
+
+  fprintf(p_pFile, "{\n  \"warmup\": %u,\n  \"repetitions\": %u,\n  \"cases\": [",
+    (unsigned int)p_psConfig->u32_warmup, (unsigned int)p_psConfig->u32_repetitions);
+  for (i = 0; i < p_u32Count; i++) {
+    fprintf(p_pFile,
+      "%s\n    {\"name\": \"%s\", \"iterations\": %u, \"items\": %u, "
+      "\"median_ns\": %.3f, \"p99_ns\": %.3f, \"min_ns\": %.3f, \"max_ns\": %.3f, "
+      "\"items_per_s\": %.1f, \"checksum\": %u}",
+      (i == 0) ? "" : ",",
+      p_psCases[i].pc_name, (unsigned int)p_psCases[i].u32_iterations, (unsigned int)p_psCases[i].u32_items,
+      p_psStats[i].d_median_ns, p_psStats[i].d_p99_ns, p_psStats[i].d_min_ns, p_psStats[i].d_max_ns,
+      p_psStats[i].d_items_per_s, (unsigned int)p_psStats[i].u32_checksum);
+  }
+  fprintf(p_pFile, "\n  ]\n}\n");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Gives the monotonic time
+ * 
+ * @return the time in ns
+ */
+static uint64_t u64HostHarness_getNs(void) {
+  struct timespec l_sNow;
+
+  clock_gettime(CLOCK_MONOTONIC, &l_sNow);
+  return (uint64_t)l_sNow.tv_sec * 1000000000ULL + (uint64_t)l_sNow.tv_nsec;
+}
+
+/**
+ * @brief Orders two times for qsort
+ * 
+ * @param p_pvLeft the first time
+ * @param p_pvRight the second time
+ * @return -1, 0 or 1
+ */
+static int iHostHarness_compare(const void* p_pvLeft, const void* p_pvRight) {
+  const double l_dLeft = *(const double*)p_pvLeft;
+  const double l_dRight = *(const double*)p_pvRight;
+
+  return (l_dLeft > l_dRight) - (l_dLeft < l_dRight);
+}
@@ -0,0 +1,125 @@
+/**
+  ******************************************************************************
+  * @file           : host_suites.c
+  * @brief          : Host run of the decode, solver and queue suites, timed
+  * for the optimisation level the host build was configured with
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "app/app_bench.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_SUITES_WARMUP 10000 //Iterations run before the measurement
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t u64HostSuites_getNs(void);
+static uint32_t u32HostSuites_getCycles(void);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ * 
+ * Prints ns and cycles per iteration of each suite, as a table or as CSV
+ * lines "suite,ns,cycles,checksum" for cmake/speed.cmake. Cycles come from
+ * the time stamp counter, 0 when the host has none.
+ * 
+ * @param argc the number of arguments
+ * @param argv the arguments, see the usage text
+ * @return 0 on success, 1 on a bad argument
+ */
+int main(int argc, char** argv) {
+  sAPPBenchResult_t l_sResult;
+  uint32_t l_u32Iterations = 100000;
+  bool l_bCSV = false;
+  bool l_bUsage = false;
+  uint64_t l_u64StartNs;
+  uint64_t l_u64Ns;
+  uint32_t l_u32Suite;
+  int i;
+
+  for (i = 1; i < argc && !l_bUsage; i++) {
+    if (strcmp(argv[i], "--csv") == 0) {
+      l_bCSV = true;
+    }
+    else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+      l_u32Iterations = (uint32_t)strtoul(argv[++i], NULL, 0);
+      l_bUsage = l_u32Iterations == 0;
+    }
+    else {
+      l_bUsage = true;
+    }
+  }
+  if (l_bUsage) {
+    fprintf(stderr, "usage: %s [--iterations N] [--csv]\n", argv[0]);
+    return 1;
+  }
+
+  if (!l_bCSV) {
+    printf("%-8s %10s %12s %12s\n", "suite", "ns/iter", "cycles/iter", "checksum");
+  }
+  for (l_u32Suite = 0; l_u32Suite < ceAPP_BENCH_NB; l_u32Suite++) {
+    vAPP_Bench_runSuite((eAPPBenchSuite_t)l_u32Suite, cHOST_SUITES_WARMUP, u32HostSuites_getCycles, &l_sResult);
+
+    l_u64StartNs = u64HostSuites_getNs();
+    vAPP_Bench_runSuite((eAPPBenchSuite_t)l_u32Suite, l_u32Iterations, u32HostSuites_getCycles, &l_sResult);
+    l_u64Ns = u64HostSuites_getNs() - l_u64StartNs;
+
+    printf(l_bCSV ? "%s,%.2f,%.2f,%08x\n" : "%-8s %10.2f %12.2f     %08x\n",
+      pcAPP_Bench_getName((eAPPBenchSuite_t)l_u32Suite),
+      (double)l_u64Ns / l_u32Iterations,
+      (double)l_sResult.u64_cycles / l_u32Iterations,
+      (unsigned int)l_sResult.u32_checksum);
+  }
+
+  return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Gives the monotonic time
+ * 
+ * @return the time in ns
+ */
+static uint64_t u64HostSuites_getNs(void) {
+  struct timespec l_sNow;
+
+  clock_gettime(CLOCK_MONOTONIC, &l_sNow);
+  return (uint64_t)l_sNow.tv_sec * 1000000000ULL + (uint64_t)l_sNow.tv_nsec;
+}
+
+/**
+ * @brief Gives the low half of the CPU time stamp counter, the suites only
+ * take differences over short batches
+ * 
+ * @return the counter, 0 when the host has none
+ */
+static uint32_t u32HostSuites_getCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return (uint32_t)__rdtsc();
+#else
+  return 0;
+#endif
+}
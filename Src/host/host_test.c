@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file           : host_test.c
+  * @brief          : Host unit test checks, counted and reported to ctest
+  * through the exit code
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stdio.h>
+#include <stdarg.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "host/host_test.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t s_u32Checks = 0;
+static uint32_t s_u32Failures = 0;
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Counts a check, printing its message when it failed
+ * 
+ * Not thread safe, checks are made from one thread.
+ * 
+ * @param p_bPassed the check result
+ * @param p_pcFile the source file of the check
+ * @param p_iLine the source line of the check
+ * @param p_pcFormat the printf format of the failure message
+ * @return
+ */
+void vHostTest_check(bool p_bPassed, const char* p_pcFile, int p_iLine, const char* p_pcFormat, ...) {
+  va_list l_vaArgs;
+
+  s_u32Checks++;
+  if (p_bPassed) {
+    return;
+  }
+
+  s_u32Failures++;
+  if (s_u32Failures <= cHOST_TEST_FAILURES_PRINTED) {
+    fprintf(stderr, "%s:%d: ", p_pcFile, p_iLine);
+    va_start(l_vaArgs, p_pcFormat);
+    vfprintf(stderr, p_pcFormat, l_vaArgs);
+    va_end(l_vaArgs);
+    fputc('\n', stderr);
+  }
+}
+
+/**
+ * @brief Prints the check and failure counts
+ * 
+ * @param p_pcName the test name
+ * @return the exit code, 0 if every check passed
+ */
+int iHostTest_report(const char* p_pcName) {
+  printf("%s: %u checks, %u failures\n", p_pcName, (unsigned)s_u32Checks, (unsigned)s_u32Failures);
+
+  return s_u32Failures == 0 && s_u32Checks != 0 ? 0 : 1;
+}
+
+/* Private functions ---------------------------------------------------------*/
@@ -0,0 +1,200 @@
+/**
+  ******************************************************************************
+  * @file           : host_test_faults.c
+  * @brief          : Host test of the I2C recovery, the forced mode
+  * acquisition running over the HAL shim against a simulated bus injecting
+  * NACKs, arbitration losses, DMA errors and a slave stuck on SDA
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stddef.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "app/app_bmp581.h"
+#include "app/app_event.h"
+#include "hal/hal_nvic.h"
+#include "hal/hal_defer.h"
+#include "hal/hal_sched.h"
+#include "hal/hal_clock.h"
+#include "hal/hal_dwt.h"
+#include "hal/hal_gpio.h"
+#include "hal/hal_dma.h"
+#include "hal/hal_i2c.h"
+#include "hal/hal_tim.h"
+#include "hal/hal_timer.h"
+#include "sim/sim_bus.h"
+#include "sim/sim_bmp581.h"
+#include "host/host_hal.h"
+#include "host/host_test.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_TEST_FAULTS_DURATION  (uint64_t)100000000000 //Virtual ns, never reached
+#define cHOST_TEST_FAULTS_PERIOD_US (uint32_t)40000
+#define cHOST_TEST_FAULTS_PERIODS   (uint32_t)1000
+#define cHOST_TEST_FAULTS_START_US  (uint32_t)500000       //Sensor ready and first sample, fault free
+#define cHOST_TEST_FAULTS_GOOD_PCT  90U                    //Samples read per half run, at least
+#define cHOST_TEST_FAULTS_LOST_PCT  1U                     //Abandoned transfers per period, at most
+#define cHOST_TEST_FAULTS_BATCH     16
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sSIM_BMP581_t s_sSensor;
+static sBMP581Sample_t s_asSamples[cHOST_TEST_FAULTS_BATCH];
+
+/* Per transfer rates, every recovery path runs several times a run */
+static const sSIM_BusFaults_t s_sFaults = {
+  .u32_nack_ppm = 20000,
+  .u32_arb_lost_ppm = 20000,
+  .u32_dma_error_ppm = 20000,
+  .u32_sda_stuck_ppm = 5000,
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static int iHostTestFaults_main(void);
+static bool bHostTestFaults_waitSample(uint32_t p_u32TimeoutUs);
+static uint32_t u32HostTestFaults_drain(uint32_t p_u32Us);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ *
+ * @return 0 if every check passed
+ */
+int main(void) {
+  sHostHALConfig_t l_sConfig = {
+    .u64_duration_ns = cHOST_TEST_FAULTS_DURATION,
+    .u32_access_ns = cHOST_HAL_ACCESS_NS_DEFAULT,
+  };
+
+  vSIM_Bus_init(1);
+  vSIM_BMP581_init(&s_sSensor);
+  HOST_TEST_CHECK(bSIM_BMP581_attach(&s_sSensor, BMP581_I2C_ADDR_PRIM), "sensor not attached");
+
+  vHostHAL_init(&l_sConfig);
+  (void)u64HostHAL_run(iHostTestFaults_main);
+  HOST_TEST_CHECK(u64HostHAL_getNowNs() < cHOST_TEST_FAULTS_DURATION, "the run did not end, the acquisition is stuck");
+
+  return iHostTest_report("faults");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Thread mode of the target, starts the acquisition fault free,
+ * then runs it under faults
+ *
+ * Each half of the run must keep reading samples, the recoveries clear
+ * the stuck SDA and the retries hide most failures.
+ *
+ * @return 0
+ */
+static int iHostTestFaults_main(void) {
+  const sOSRConfig_t l_sOSRConfig = {ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_16, true};
+  const uint32_t l_u32HalfUs = cHOST_TEST_FAULTS_PERIODS / 2U * cHOST_TEST_FAULTS_PERIOD_US;
+  const uint32_t l_u32GoodMin = cHOST_TEST_FAULTS_PERIODS / 2U * cHOST_TEST_FAULTS_GOOD_PCT / 100U;
+  sI2CRecoveryStats_t l_sRecovery;
+  sSIM_BusStats_t l_sBus;
+  eBMP581Err_t l_eErr;
+  uint32_t l_u32First;
+  uint32_t l_u32Second;
+  uint32_t l_u32Conversions;
+
+  HAL_Init();
+  vHAL_NVIC_init();
+  vHAL_Defer_init();
+  vHAL_Sched_init();
+  vHAL_Clock_init();
+  vHAL_DWT_init();
+  vHAL_GPIO_init();
+  vHAL_DMA_init();
+  vI2C_init();
+  vHAL_TIM_init();
+  vHAL_Timer_init();
+  vAPP_Event_init();
+
+  vAPP_BMP581_init();
+  while (!bAPP_BMP581_isReady() && u32HAL_Timer_now() < cHOST_TEST_FAULTS_START_US) {
+    __WFI();
+  }
+  HOST_TEST_CHECK(bAPP_BMP581_isReady(), "sensor not ready");
+  l_eErr = errAPP_BMP581_startForced(cHOST_TEST_FAULTS_PERIOD_US, l_sOSRConfig);
+  HOST_TEST_CHECK(l_eErr == ceAPP_BMP581_OK, "acquisition not started: error %d", (int)l_eErr);
+  if (l_eErr != ceAPP_BMP581_OK || !bHostTestFaults_waitSample(cHOST_TEST_FAULTS_START_US)) {
+    HOST_TEST_CHECK(false, "no sample before the faults");
+    return 0;
+  }
+
+  vSIM_Bus_setFaults(&s_sFaults);
+  l_u32First = u32HostTestFaults_drain(l_u32HalfUs);
+  l_u32Conversions = u32SIM_BMP581_getConversions(&s_sSensor);
+  l_u32Second = u32HostTestFaults_drain(l_u32HalfUs);
+  l_u32Conversions = u32SIM_BMP581_getConversions(&s_sSensor) - l_u32Conversions;
+
+  vI2C_getRecoveryStats(&l_sRecovery);
+  vSIM_Bus_getStats(&l_sBus);
+
+  HOST_TEST_CHECK(l_sRecovery.u32_recoveries > 0U, "no recovery for %u errors", (unsigned)l_sRecovery.u32_errors);
+  HOST_TEST_CHECK(l_sRecovery.u32_retries > 0U, "no retry for %u errors", (unsigned)l_sRecovery.u32_errors);
+  HOST_TEST_CHECK(l_sBus.u32_sda_stuck > 0U, "SDA never stuck, the bus clear is not covered");
+  HOST_TEST_CHECK(
+    l_sRecovery.u32_bus_clears >= l_sBus.u32_sda_stuck - (bSIM_Bus_isSDAHeld() ? 1U : 0U),
+    "%u bus clears for SDA stuck %u times", (unsigned)l_sRecovery.u32_bus_clears, (unsigned)l_sBus.u32_sda_stuck
+  );
+  HOST_TEST_CHECK(l_sRecovery.u32_stuck == 0U, "SDA still low after %u bus clears", (unsigned)l_sRecovery.u32_stuck);
+  HOST_TEST_CHECK(l_u32First >= l_u32GoodMin, "%u samples in the first half, %u expected", (unsigned)l_u32First, (unsigned)l_u32GoodMin);
+  HOST_TEST_CHECK(l_u32Second >= l_u32GoodMin, "%u samples in the second half, %u expected", (unsigned)l_u32Second, (unsigned)l_u32GoodMin);
+  HOST_TEST_CHECK(l_u32Conversions >= l_u32GoodMin, "%u conversions in the second half, %u expected", (unsigned)l_u32Conversions, (unsigned)l_u32GoodMin);
+  HOST_TEST_CHECK(
+    l_sRecovery.u32_abandoned * 100U <= cHOST_TEST_FAULTS_PERIODS * cHOST_TEST_FAULTS_LOST_PCT,
+    "%u transfers abandoned over %u periods", (unsigned)l_sRecovery.u32_abandoned, (unsigned)cHOST_TEST_FAULTS_PERIODS
+  );
+
+  return 0;
+}
+
+/**
+ * @brief Sleeps until a sample is read
+ *
+ * @param p_u32TimeoutUs the longest wait
+ * @return false if no sample came
+ */
+static bool bHostTestFaults_waitSample(uint32_t p_u32TimeoutUs) {
+  uint32_t l_u32StartUs = u32HAL_Timer_now();
+
+  while (u32HAL_Timer_now() - l_u32StartUs < p_u32TimeoutUs) {
+    if (u32APP_BMP581_readSamples(s_asSamples, cHOST_TEST_FAULTS_BATCH) != 0U) {
+      return true;
+    }
+    __WFI();
+  }
+
+  return false;
+}
+
+/**
+ * @brief Reads the samples as they come for some time
+ *
+ * @param p_u32Us the time to run
+ * @return the number of samples read
+ */
+static uint32_t u32HostTestFaults_drain(uint32_t p_u32Us) {
+  uint32_t l_u32StartUs = u32HAL_Timer_now();
+  uint32_t l_u32Count = 0;
+
+  while (u32HAL_Timer_now() - l_u32StartUs < p_u32Us) {
+    __WFI();
+    l_u32Count += u32APP_BMP581_readSamples(s_asSamples, cHOST_TEST_FAULTS_BATCH);
+  }
+
+  return l_u32Count;
+}
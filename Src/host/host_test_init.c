@@ -0,0 +1,260 @@
+/**
+  ******************************************************************************
+  * @file           : host_test_init.c
+  * @brief          : Host test of concurrent BMP581 initialisations, the
+  * driver, the I2C queue and the timer service running over the HAL shim
+  * against simulated sensors
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stddef.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "app/app_bmp581.h"
+#include "app/app_event.h"
+#include "hal/hal_nvic.h"
+#include "hal/hal_defer.h"
+#include "hal/hal_sched.h"
+#include "hal/hal_clock.h"
+#include "hal/hal_dwt.h"
+#include "hal/hal_gpio.h"
+#include "hal/hal_dma.h"
+#include "hal/hal_i2c.h"
+#include "hal/hal_tim.h"
+#include "hal/hal_timer.h"
+#include "sim/sim_bus.h"
+#include "sim/sim_bmp581.h"
+#include "host/host_hal.h"
+#include "host/host_test.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_TEST_INIT_DEVICE_NB 4U
+#define cHOST_TEST_INIT_DURATION  (uint64_t)10000000000 //Virtual ns, never reached
+#define cHOST_TEST_INIT_TIMEOUT_US (uint32_t)100000      //Initialisations still running then are stuck
+#define cHOST_TEST_INIT_HOLD_US   (cAPP_BMP581_POR_US + 100U) //Longer than every POR wait started before
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* The two BMP581 addresses, then two more the driver does not tell apart */
+static const uint8_t s_au8Addresses[cHOST_TEST_INIT_DEVICE_NB] = {
+  BMP581_I2C_ADDR_PRIM, BMP581_I2C_ADDR_SEC, 0x48, 0x49
+};
+
+static sSIM_BMP581_t s_asSensors[cHOST_TEST_INIT_DEVICE_NB];
+static sBMP581Device_t s_asDevices[cHOST_TEST_INIT_DEVICE_NB];
+static volatile uint32_t s_u32Done;
+static uint32_t s_u32SoloUs;  //Initialisation time of one sensor alone
+static sHAL_Timer_t s_sHoldTimer;
+static volatile bool s_bHoldOver;
+
+/* Private function prototypes -----------------------------------------------*/
+static int iHostTestInit_main(void);
+static void vHostTestInit_start(uint32_t p_u32Nb, bool p_bHoldPoll);
+static void vHostTestInit_holdPoll(uint32_t p_u32Nb);
+static bool bHostTestInit_allInState(uint32_t p_u32Nb, eBMP581InitState_t p_eState);
+static void vHostTestInit_holdOver(void* p_pvArg);
+static void vHostTestInit_done(sBMP581Device_t* p_psDevice);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ *
+ * @return 0 if every check passed
+ */
+int main(void) {
+  sHostHALConfig_t l_sConfig = {
+    .u64_duration_ns = cHOST_TEST_INIT_DURATION,
+    .u32_access_ns = cHOST_HAL_ACCESS_NS_DEFAULT,
+  };
+  uint32_t l_u32Device;
+
+  vSIM_Bus_init(1);
+  for (l_u32Device = 0; l_u32Device < cHOST_TEST_INIT_DEVICE_NB; l_u32Device++) {
+    vSIM_BMP581_init(&s_asSensors[l_u32Device]);
+    HOST_TEST_CHECK(bSIM_BMP581_attach(&s_asSensors[l_u32Device], s_au8Addresses[l_u32Device]), "sensor %u not attached", (unsigned)l_u32Device);
+  }
+
+  vHostHAL_init(&l_sConfig);
+  (void)u64HostHAL_run(iHostTestInit_main);
+  HOST_TEST_CHECK(u64HostHAL_getNowNs() < cHOST_TEST_INIT_DURATION, "the run did not end, an initialisation is stuck");
+
+  return iHostTest_report("init");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Thread mode of the target, times one initialisation alone, then
+ * starts every sensor at once
+ *
+ * The I2C resource is held over the POR waits of the concurrent run, so
+ * every wait elapses before the POR poll task can run. The transfers
+ * share the bus but the POR waits overlap, so every initialisation must
+ * end ready within the bus time of all of them plus the hold. A lost
+ * POR poll leaves its sensor waiting, initialisations run one after the
+ * other add a wait per sensor.
+ *
+ * @return 0
+ */
+static int iHostTestInit_main(void) {
+  uint32_t l_u32Device;
+  uint32_t l_u32TimeUs;
+  uint32_t l_u32BoundUs;
+
+  HAL_Init();
+  vHAL_NVIC_init();
+  vHAL_Defer_init();
+  vHAL_Sched_init();
+  vHAL_Clock_init();
+  vHAL_DWT_init();
+  vHAL_GPIO_init();
+  vHAL_DMA_init();
+  vI2C_init();
+  vHAL_TIM_init();
+  vHAL_Timer_init();
+  vAPP_Event_init();
+
+  vHostTestInit_start(1, false);
+  HOST_TEST_CHECK(eAPP_BMP581_getInitState(&s_asDevices[0]) == ceAPP_BMP581_INIT_READY, "sensor 0 alone: state %d", (int)eAPP_BMP581_getInitState(&s_asDevices[0]));
+  s_u32SoloUs = s_asDevices[0].u32_ready_us - s_asDevices[0].u32_start_us;
+  l_u32BoundUs = cHOST_TEST_INIT_DEVICE_NB * (s_u32SoloUs - cAPP_BMP581_POR_US) + cHOST_TEST_INIT_HOLD_US;
+
+  vHostTestInit_start(cHOST_TEST_INIT_DEVICE_NB, true);
+  for (l_u32Device = 0; l_u32Device < cHOST_TEST_INIT_DEVICE_NB; l_u32Device++) {
+    l_u32TimeUs = s_asDevices[l_u32Device].u32_ready_us - s_asDevices[l_u32Device].u32_start_us;
+    HOST_TEST_CHECK(
+      eAPP_BMP581_getInitState(&s_asDevices[l_u32Device]) == ceAPP_BMP581_INIT_READY,
+      "sensor %u at 0x%02X: state %d, error %d",
+      (unsigned)l_u32Device, s_au8Addresses[l_u32Device], (int)eAPP_BMP581_getInitState(&s_asDevices[l_u32Device]), (int)s_asDevices[l_u32Device].e_error
+    );
+    HOST_TEST_CHECK(
+      s_asDevices[l_u32Device].e_state != ceAPP_BMP581_INIT_READY || l_u32TimeUs <= l_u32BoundUs,
+      "sensor %u at 0x%02X: ready after %u us, %u us alone, bound %u us",
+      (unsigned)l_u32Device, s_au8Addresses[l_u32Device], (unsigned)l_u32TimeUs, (unsigned)s_u32SoloUs, (unsigned)l_u32BoundUs
+    );
+  }
+
+  /* The queue drives the sizes picked for polling with interrupts */
+  HOST_TEST_CHECK(
+    psI2C_getDispatch()->au32_transfers[ceHAL_TRANSFER_POLLING] == 0U,
+    "%u queued transfers counted as polled", (unsigned)psI2C_getDispatch()->au32_transfers[ceHAL_TRANSFER_POLLING]
+  );
+
+  return 0;
+}
+
+/**
+ * @brief Starts the first sensors together and sleeps until each one is
+ * ready or failed, or until cHOST_TEST_INIT_TIMEOUT_US elapsed
+ *
+ * @param p_u32Nb the number of sensors
+ * @param p_bHoldPoll true to delay the POR poll task past every POR wait
+ * @return
+ */
+static void vHostTestInit_start(uint32_t p_u32Nb, bool p_bHoldPoll) {
+  uint32_t l_u32Device;
+  eBMP581Err_t l_eErr;
+  uint32_t l_u32StartUs = u32HAL_Timer_now();
+
+  s_u32Done = 0;
+  for (l_u32Device = 0; l_u32Device < p_u32Nb; l_u32Device++) {
+    l_eErr = errAPP_BMP581_startInit(&s_asDevices[l_u32Device], s_au8Addresses[l_u32Device], vHostTestInit_done);
+    HOST_TEST_CHECK(l_eErr == ceAPP_BMP581_OK, "sensor %u not started: error %d", (unsigned)l_u32Device, (int)l_eErr);
+    if (l_eErr != ceAPP_BMP581_OK) {
+      s_u32Done++;
+    }
+  }
+
+  if (p_bHoldPoll) {
+    vHostTestInit_holdPoll(p_u32Nb);
+  }
+
+  while (s_u32Done < p_u32Nb && u32HAL_Timer_now() - l_u32StartUs < cHOST_TEST_INIT_TIMEOUT_US) {
+    __WFI();
+  }
+}
+
+/**
+ * @brief Holds the I2C resource from the time every sensor waits for its
+ * POR flag until all the waits elapsed
+ *
+ * The timer service is more urgent than the resource ceiling and still
+ * runs, the POR poll task is kept pending as if a longer task held the bus.
+ * The hold ends on a timer of its own, the only interrupt left to wake
+ * the core once the POR waits elapsed.
+ *
+ * @param p_u32Nb the number of sensors
+ * @return
+ */
+static void vHostTestInit_holdPoll(uint32_t p_u32Nb) {
+  uint32_t l_u32Key;
+
+  while (!bHostTestInit_allInState(p_u32Nb, ceAPP_BMP581_INIT_WAIT_POR) && s_u32Done == 0) {
+    __WFI();
+  }
+
+  s_bHoldOver = false;
+  vHAL_Timer_create(&s_sHoldTimer, vHostTestInit_holdOver, NULL);
+  l_u32Key = u32HAL_Sched_lock(psI2C_getResource());
+  HOST_TEST_CHECK(bHAL_Timer_start(&s_sHoldTimer, cHOST_TEST_INIT_HOLD_US, 0), "hold timer not started");
+  while (!s_bHoldOver) {
+    __WFI();
+  }
+  vHAL_Sched_unlock(l_u32Key);
+}
+
+/**
+ * @brief Tells whether the first sensors are all in one step
+ *
+ * @param p_u32Nb the number of sensors
+ * @param p_eState the step
+ * @return true if every sensor is in p_eState
+ */
+static bool bHostTestInit_allInState(uint32_t p_u32Nb, eBMP581InitState_t p_eState) {
+  uint32_t l_u32Device;
+
+  for (l_u32Device = 0; l_u32Device < p_u32Nb; l_u32Device++) {
+    if (eAPP_BMP581_getInitState(&s_asDevices[l_u32Device]) != p_eState) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Counts an ended initialisation
+ *
+ * Called in PendSV by the driver.
+ *
+ * @param p_psDevice the device
+ * @return
+ */
+static void vHostTestInit_done(sBMP581Device_t* p_psDevice) {
+  (void)p_psDevice;
+  s_u32Done++;
+}
+
+/**
+ * @brief Ends the hold of the I2C resource
+ *
+ * Called from the timer service interrupt.
+ *
+ * @param p_pvArg unused
+ * @return
+ */
+static void vHostTestInit_holdOver(void* p_pvArg) {
+  (void)p_pvArg;
+  s_bHoldOver = true;
+}
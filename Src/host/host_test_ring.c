@@ -0,0 +1,199 @@
+/**
+  ******************************************************************************
+  * @file           : host_test_ring.c
+  * @brief          : Host unit test of the sample ring, a producer and a
+  * consumer thread hammering it with spans of different sizes
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "app/app_sample_ring.h"
+#include "host/host_test.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Struct holding the tallies of each side, read once both joined
+ * 
+ */
+typedef struct {
+  uint32_t u32_spans;
+  uint32_t u32_short_spans;    //Spans the ring could not take whole
+  uint32_t u32_dropped;
+  uint32_t u32_popped;
+  uint32_t u32_out_of_order;   //Lost, duplicated or reordered samples
+  uint32_t u32_torn;           //Samples whose fields do not match
+} sHostTestRingTally_t;
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_TEST_RING_SAMPLES (uint32_t)2000000 //Samples to get through
+#define cHOST_TEST_RING_SPAN_MAX (cAPP_SAMPLE_RING_SIZE + 1U)
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sSampleRing_t s_sRing;
+static sHostTestRingTally_t s_sProducer;
+static sHostTestRingTally_t s_sConsumer;
+
+/* Span sizes, the last one never fits so the ring overflows every round */
+static const uint32_t s_au32PushSpans[] = {1, 2, 3, 5, 8, 13, 31, 1, 64, cHOST_TEST_RING_SPAN_MAX};
+static const uint32_t s_au32PopSpans[] = {1, 7, 2, 64, 3, 16, 1, 33};
+
+/* Private function prototypes -----------------------------------------------*/
+static void vHostTest_encode(uint32_t p_u32Sequence, sBMP581Sample_t* p_psSample);
+static void* pvHostTest_produce(void* p_pvArg);
+static void* pvHostTest_consume(void* p_pvArg);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ * 
+ * The producer numbers the samples of each span from the first sample not
+ * yet accepted, so the accepted ones form the sequence 0, 1, 2... that the
+ * consumer must see exactly once and in order.
+ * 
+ * @return 0 if every check passed
+ */
+int main(void) {
+  pthread_t l_sProducer;
+  pthread_t l_sConsumer;
+
+  vAPP_SampleRing_init(&s_sRing);
+
+  HOST_TEST_CHECK(pthread_create(&l_sConsumer, NULL, pvHostTest_consume, NULL) == 0, "consumer not started");
+  HOST_TEST_CHECK(pthread_create(&l_sProducer, NULL, pvHostTest_produce, NULL) == 0, "producer not started");
+  pthread_join(l_sProducer, NULL);
+  pthread_join(l_sConsumer, NULL);
+
+  HOST_TEST_CHECK(
+    s_sConsumer.u32_popped == cHOST_TEST_RING_SAMPLES,
+    "%u samples popped, expected %u", (unsigned)s_sConsumer.u32_popped, (unsigned)cHOST_TEST_RING_SAMPLES
+  );
+  HOST_TEST_CHECK(s_sConsumer.u32_out_of_order == 0, "%u samples lost, duplicated or reordered", (unsigned)s_sConsumer.u32_out_of_order);
+  HOST_TEST_CHECK(s_sConsumer.u32_torn == 0, "%u torn samples", (unsigned)s_sConsumer.u32_torn);
+  HOST_TEST_CHECK(u32APP_SampleRing_getCount(&s_sRing) == 0, "%u samples left", (unsigned)u32APP_SampleRing_getCount(&s_sRing));
+
+  HOST_TEST_CHECK(s_sProducer.u32_short_spans != 0, "the ring never overflowed");
+  HOST_TEST_CHECK(
+    u32APP_SampleRing_getOverflowEvents(&s_sRing) == s_sProducer.u32_short_spans,
+    "%u overflow events, %u short spans",
+    (unsigned)u32APP_SampleRing_getOverflowEvents(&s_sRing), (unsigned)s_sProducer.u32_short_spans
+  );
+  HOST_TEST_CHECK(
+    u32APP_SampleRing_getDroppedSamples(&s_sRing) == s_sProducer.u32_dropped,
+    "%u dropped samples, %u refused",
+    (unsigned)u32APP_SampleRing_getDroppedSamples(&s_sRing), (unsigned)s_sProducer.u32_dropped
+  );
+
+  return iHostTest_report("ring");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Fills every field of a sample from its sequence number
+ * 
+ * @param p_u32Sequence the sequence number
+ * @param p_psSample the sample
+ * @return
+ */
+static void vHostTest_encode(uint32_t p_u32Sequence, sBMP581Sample_t* p_psSample) {
+  p_psSample->u32_timestamp_ms = p_u32Sequence;
+  p_psSample->u32_press_raw = p_u32Sequence * 2654435761U;
+  p_psSample->s32_temp_raw = (int32_t)~p_u32Sequence;
+}
+
+/**
+ * @brief Producer thread, pushes spans until every sample is accepted
+ * 
+ * @param p_pvArg unused
+ * @return NULL
+ */
+static void* pvHostTest_produce(void* p_pvArg) {
+  sBMP581Sample_t l_asSpan[cHOST_TEST_RING_SPAN_MAX];
+  uint32_t l_u32Next = 0;
+  uint32_t l_u32Count;
+  uint32_t l_u32Pushed;
+  uint32_t i;
+
+  (void)p_pvArg;
+
+  while (l_u32Next < cHOST_TEST_RING_SAMPLES) {
+    l_u32Count = s_au32PushSpans[s_sProducer.u32_spans % (sizeof(s_au32PushSpans) / sizeof(s_au32PushSpans[0]))];
+    if (l_u32Count > cHOST_TEST_RING_SAMPLES - l_u32Next) {
+      l_u32Count = cHOST_TEST_RING_SAMPLES - l_u32Next;
+    }
+    for (i = 0; i < l_u32Count; i++) {
+      vHostTest_encode(l_u32Next + i, &l_asSpan[i]);
+    }
+
+    l_u32Pushed = (l_u32Count == 1) ?
+      (uint32_t)bAPP_SampleRing_push(&s_sRing, l_asSpan) :
+      u32APP_SampleRing_pushBulk(&s_sRing, l_asSpan, l_u32Count);
+    s_sProducer.u32_spans++;
+    if (l_u32Pushed < l_u32Count) {
+      s_sProducer.u32_short_spans++;
+      s_sProducer.u32_dropped += l_u32Count - l_u32Pushed;
+      sched_yield();
+    }
+    l_u32Next += l_u32Pushed;
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Consumer thread, pops spans until every sample is received
+ * 
+ * @param p_pvArg unused
+ * @return NULL
+ */
+static void* pvHostTest_consume(void* p_pvArg) {
+  sBMP581Sample_t l_asSpan[cAPP_SAMPLE_RING_SIZE];
+  sBMP581Sample_t l_sExpected;
+  uint32_t l_u32Next = 0;
+  uint32_t l_u32Spans = 0;
+  uint32_t l_u32Max;
+  uint32_t l_u32Popped;
+  uint32_t i;
+
+  (void)p_pvArg;
+
+  while (l_u32Next < cHOST_TEST_RING_SAMPLES) {
+    l_u32Max = s_au32PopSpans[l_u32Spans++ % (sizeof(s_au32PopSpans) / sizeof(s_au32PopSpans[0]))];
+    l_u32Popped = (l_u32Max == 1) ?
+      (uint32_t)bAPP_SampleRing_pop(&s_sRing, l_asSpan) :
+      u32APP_SampleRing_popBulk(&s_sRing, l_asSpan, l_u32Max);
+    if (l_u32Popped == 0) {
+      sched_yield();
+    }
+
+    for (i = 0; i < l_u32Popped; i++) {
+      if (l_asSpan[i].u32_timestamp_ms != l_u32Next) {
+        s_sConsumer.u32_out_of_order++;
+      }
+      vHostTest_encode(l_asSpan[i].u32_timestamp_ms, &l_sExpected);
+      if (
+        l_asSpan[i].u32_press_raw != l_sExpected.u32_press_raw ||
+        l_asSpan[i].s32_temp_raw != l_sExpected.s32_temp_raw
+      ) {
+        s_sConsumer.u32_torn++;
+      }
+      /* Resynchronise on the received sequence so one loss counts once */
+      l_u32Next = l_asSpan[i].u32_timestamp_ms + 1;
+      s_sConsumer.u32_popped++;
+    }
+  }
+
+  return NULL;
+}
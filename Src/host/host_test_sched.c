@@ -0,0 +1,531 @@
+/**
+  ******************************************************************************
+  * @file           : host_test_sched.c
+  * @brief          : Host unit test of the task scheduler on the NVIC model
+  * of the host HAL: run order, preemption, resource locks and a stress run
+  * of tasks and an urgent interrupt sharing one resource
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "hal/hal_nvic.h"
+#include "hal/hal_sched.h"
+#include "host/host_hal.h"
+#include "host/host_test.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+typedef void (*pfHostTestSched_Step_t)(eHAL_SchedTask_t p_eTask);
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_TEST_SCHED_LOG_SIZE   32U
+#define cHOST_TEST_SCHED_MARK       (uint32_t)10 //Logged by the steps
+#define cHOST_TEST_SCHED_URGENT     (uint32_t)11 //Logged by TIM5, above the ceiling
+#define cHOST_TEST_SCHED_ROUNDS     (uint32_t)20000
+#define cHOST_TEST_SCHED_DURATION   (uint64_t)60000000000 //Virtual ns, never reached
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t s_au32Log[cHOST_TEST_SCHED_LOG_SIZE];
+static uint32_t s_u32LogNb;
+static pfHostTestSched_Step_t s_pfStep;
+static pfHostTestSched_Step_t s_pfUrgentStep;
+
+static sHAL_SchedResource_t s_sResource;
+static volatile uint32_t s_u32Owners;
+static uint32_t s_u32Violations;
+static uint32_t s_u32Budget;  //Activations the stress steps may still make
+static uint32_t s_u32Random;
+
+/* Private function prototypes -----------------------------------------------*/
+static int iHostTestSched_main(void);
+static void vHostTestSched_testOrder(void);
+static void vHostTestSched_testActivations(void);
+static void vHostTestSched_testPreemption(void);
+static void vHostTestSched_testLock(void);
+static void vHostTestSched_testStress(void);
+static void vHostTestSched_install(const uint32_t* p_pu32Priorities);
+static void vHostTestSched_log(uint32_t p_u32Entry);
+static void vHostTestSched_checkLog(const char* p_pcName, const uint32_t* p_pu32Expected, uint32_t p_u32Nb);
+static void vHostTestSched_run(eHAL_SchedTask_t p_eTask);
+static void vHostTestSched_task0(void);
+static void vHostTestSched_task1(void);
+static void vHostTestSched_task2(void);
+static void vHostTestSched_task3(void);
+static void vHostTestSched_preemptStep(eHAL_SchedTask_t p_eTask);
+static void vHostTestSched_lockStep(eHAL_SchedTask_t p_eTask);
+static void vHostTestSched_stressStep(eHAL_SchedTask_t p_eTask);
+static void vHostTestSched_stressUrgent(eHAL_SchedTask_t p_eTask);
+static uint32_t u32HostTestSched_random(uint32_t p_u32Range);
+void TIM5_IRQHandler(void);
+
+static const pfHAL_SchedTask_t s_apfTasks[ceHAL_SCHED_TASK_NB] = {
+  vHostTestSched_task0,
+  vHostTestSched_task1,
+  vHostTestSched_task2,
+  vHostTestSched_task3
+};
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ *
+ * @return 0 if every check passed
+ */
+int main(void) {
+  sHostHALConfig_t l_sConfig = {
+    .u64_duration_ns = cHOST_TEST_SCHED_DURATION,
+    .u32_access_ns = cHOST_HAL_ACCESS_NS_DEFAULT,
+  };
+
+  vHostHAL_init(&l_sConfig);
+  (void)u64HostHAL_run(iHostTestSched_main);
+  HOST_TEST_CHECK(u64HostHAL_getNowNs() < cHOST_TEST_SCHED_DURATION, "the run did not end, a task or a lock is stuck");
+
+  return iHostTest_report("sched");
+}
+
+/**
+ * @brief Urgent interrupt, above every task and resource ceiling
+ *
+ * @return
+ */
+void TIM5_IRQHandler(void) {
+  vHostTestSched_log(cHOST_TEST_SCHED_URGENT);
+  if (s_pfUrgentStep != NULL) {
+    s_pfUrgentStep(ceHAL_SCHED_TASK_NB);
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Thread mode of the target, runs each test in turn
+ *
+ * @return 0
+ */
+static int iHostTestSched_main(void) {
+  HAL_NVIC_SetPriority(TIM5_IRQn, cHAL_NVIC_PRIO_SENSOR, 0);
+  HAL_NVIC_EnableIRQ(TIM5_IRQn);
+
+  vHostTestSched_testOrder();
+  vHostTestSched_testActivations();
+  vHostTestSched_testPreemption();
+  vHostTestSched_testLock();
+  vHostTestSched_testStress();
+
+  return 0;
+}
+
+/**
+ * @brief Pending tasks run by priority, ties by task number
+ *
+ * @return
+ */
+static void vHostTestSched_testOrder(void) {
+  static const uint32_t s_au32Priorities[ceHAL_SCHED_TASK_NB] = {
+    cHAL_NVIC_PRIO_TASK_FIRST + 2U,
+    cHAL_NVIC_PRIO_TASK_FIRST,
+    cHAL_NVIC_PRIO_TASK_FIRST + 2U,
+    cHAL_NVIC_PRIO_TASK_FIRST + 1U
+  };
+  static const uint32_t s_au32Expected[] = {1, 3, 0, 2};
+
+  vHostTestSched_install(s_au32Priorities);
+
+  __disable_irq();
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_2);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_0);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_3);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_1);
+  HOST_TEST_CHECK(s_u32LogNb == 0, "order: a task ran with interrupts masked");
+  __enable_irq();
+
+  vHostTestSched_checkLog("order", s_au32Expected, sizeof(s_au32Expected) / sizeof(s_au32Expected[0]));
+}
+
+/**
+ * @brief Each activation gives one run, even when merged in one pending
+ * vector, and a task out of range or not installed is ignored
+ *
+ * @return
+ */
+static void vHostTestSched_testActivations(void) {
+  static const uint32_t s_au32Priorities[ceHAL_SCHED_TASK_NB] = {
+    cHAL_NVIC_PRIO_TASK_FIRST,
+    cHAL_NVIC_PRIO_TASK_FIRST,
+    cHAL_NVIC_PRIO_TASK_FIRST,
+    cHAL_NVIC_PRIO_TASK_FIRST
+  };
+  static const uint32_t s_au32Expected[] = {0, 0, 0, 2};
+  sHAL_SchedTaskStats_t l_sStats;
+
+  vHostTestSched_install(s_au32Priorities);
+  HOST_TEST_CHECK(
+    !bHAL_Sched_setTask(ceHAL_SCHED_TASK_3, vHostTestSched_task3, cHAL_NVIC_PRIO_TASK_FIRST - 1U),
+    "activations: a task took an interrupt priority"
+  );
+  HOST_TEST_CHECK(
+    !bHAL_Sched_setTask(ceHAL_SCHED_TASK_3, vHostTestSched_task3, cHAL_NVIC_PRIO_DEFERRED),
+    "activations: a task took the deferred call priority"
+  );
+  HOST_TEST_CHECK(!bHAL_Sched_setTask(ceHAL_SCHED_TASK_NB, vHostTestSched_task3, cHAL_NVIC_PRIO_TASK_FIRST), "activations: out of range task installed");
+
+  vHAL_Sched_init();
+  HOST_TEST_CHECK(bHAL_Sched_setTask(ceHAL_SCHED_TASK_0, vHostTestSched_task0, cHAL_NVIC_PRIO_TASK_FIRST), "activations: task 0 not installed");
+  HOST_TEST_CHECK(bHAL_Sched_setTask(ceHAL_SCHED_TASK_2, vHostTestSched_task2, cHAL_NVIC_PRIO_TASK_FIRST), "activations: task 2 not installed");
+
+  __disable_irq();
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_0);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_1);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_0);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_NB);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_0);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_2);
+  __enable_irq();
+
+  vHostTestSched_checkLog("activations", s_au32Expected, sizeof(s_au32Expected) / sizeof(s_au32Expected[0]));
+
+  vHAL_Sched_getStats(ceHAL_SCHED_TASK_0, &l_sStats);
+  HOST_TEST_CHECK(
+    l_sStats.u32_activations == 3 && l_sStats.u32_runs == 3,
+    "activations: task 0 activated %u times and run %u times, expected 3", l_sStats.u32_activations, l_sStats.u32_runs
+  );
+  vHAL_Sched_getStats(ceHAL_SCHED_TASK_1, &l_sStats);
+  HOST_TEST_CHECK(l_sStats.u32_activations == 0 && l_sStats.u32_runs == 0, "activations: task 1 not installed but counted");
+}
+
+/**
+ * @brief A task activating a more urgent one is preempted on the spot, a
+ * less urgent one or one of equal priority waits for its end
+ *
+ * @return
+ */
+static void vHostTestSched_testPreemption(void) {
+  static const uint32_t s_au32Priorities[ceHAL_SCHED_TASK_NB] = {
+    cHAL_NVIC_PRIO_TASK_LAST,
+    cHAL_NVIC_PRIO_TASK_FIRST,
+    cHAL_NVIC_PRIO_TASK_FIRST + 1U,
+    cHAL_NVIC_PRIO_TASK_FIRST + 1U
+  };
+  static const uint32_t s_au32Expected[] = {
+    2, 1, cHOST_TEST_SCHED_URGENT, cHOST_TEST_SCHED_MARK, 3, 0
+  };
+
+  vHostTestSched_install(s_au32Priorities);
+  s_pfStep = vHostTestSched_preemptStep;
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_2);
+  s_pfStep = NULL;
+
+  vHostTestSched_checkLog("preemption", s_au32Expected, sizeof(s_au32Expected) / sizeof(s_au32Expected[0]));
+}
+
+/**
+ * @brief A locked resource holds back its other users, task or not, until
+ * the unlock, while interrupts above its ceiling still run
+ *
+ * @return
+ */
+static void vHostTestSched_testLock(void) {
+  static const uint32_t s_au32Priorities[ceHAL_SCHED_TASK_NB] = {
+    cHAL_NVIC_PRIO_TASK_LAST,
+    cHAL_NVIC_PRIO_TASK_FIRST,
+    cHAL_NVIC_PRIO_TASK_FIRST + 1U,
+    cHAL_NVIC_PRIO_TASK_FIRST + 2U
+  };
+  static const uint32_t s_au32Expected[] = {
+    0, cHOST_TEST_SCHED_URGENT, cHOST_TEST_SCHED_MARK, 1, 2, 3, cHOST_TEST_SCHED_MARK
+  };
+
+  vHostTestSched_install(s_au32Priorities);
+  vHAL_Sched_initResource(&s_sResource);
+  HOST_TEST_CHECK(s_sResource.u32_ceiling == cHAL_SCHED_NO_CEILING, "lock: a resource with no user has a ceiling");
+  vHAL_Sched_addTaskUser(&s_sResource, ceHAL_SCHED_TASK_0);
+  vHAL_Sched_addTaskUser(&s_sResource, ceHAL_SCHED_TASK_1);
+  vHAL_Sched_addUser(&s_sResource, 0);
+  HOST_TEST_CHECK(
+    s_sResource.u32_ceiling == cHAL_NVIC_PRIO_TASK_FIRST,
+    "lock: ceiling %u, expected %u", s_sResource.u32_ceiling, cHAL_NVIC_PRIO_TASK_FIRST
+  );
+
+  s_u32Violations = 0;
+  s_pfStep = vHostTestSched_lockStep;
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_0);
+  s_pfStep = NULL;
+
+  vHostTestSched_checkLog("lock", s_au32Expected, sizeof(s_au32Expected) / sizeof(s_au32Expected[0]));
+  HOST_TEST_CHECK(s_u32Violations == 0, "lock: %u users ran while the resource was locked", s_u32Violations);
+  HOST_TEST_CHECK(__get_BASEPRI() == 0, "lock: BASEPRI left at %u", (unsigned)__get_BASEPRI());
+}
+
+/**
+ * @brief Tasks of every priority, one tie included, lock a shared
+ * resource and activate each other at random while an interrupt above the
+ * ceiling activates them too. The run must end with every activation run
+ * and no two owners at once.
+ *
+ * @return
+ */
+static void vHostTestSched_testStress(void) {
+  static const uint32_t s_au32Priorities[ceHAL_SCHED_TASK_NB] = {
+    cHAL_NVIC_PRIO_TASK_LAST,
+    cHAL_NVIC_PRIO_TASK_FIRST + 1U,
+    cHAL_NVIC_PRIO_TASK_FIRST + 1U,
+    cHAL_NVIC_PRIO_TASK_FIRST
+  };
+  sHAL_SchedTaskStats_t l_sStats;
+  uint32_t l_u32Activations = 0;
+  uint32_t i;
+
+  vHostTestSched_install(s_au32Priorities);
+  vHAL_Sched_initResource(&s_sResource);
+  for (i = 0; i < ceHAL_SCHED_TASK_NB; i++) {
+    vHAL_Sched_addTaskUser(&s_sResource, (eHAL_SchedTask_t)i);
+  }
+
+  s_u32Owners = 0;
+  s_u32Violations = 0;
+  s_u32Budget = cHOST_TEST_SCHED_ROUNDS;
+  s_u32Random = 1;
+  s_pfStep = vHostTestSched_stressStep;
+  s_pfUrgentStep = vHostTestSched_stressUrgent;
+
+  for (i = 0; i < cHOST_TEST_SCHED_ROUNDS; i++) {
+    if (u32HostTestSched_random(4) == 0) {
+      NVIC_SetPendingIRQ(TIM5_IRQn);
+    } else {
+      vHAL_Sched_activate((eHAL_SchedTask_t)u32HostTestSched_random(ceHAL_SCHED_TASK_NB));
+    }
+  }
+
+  s_pfStep = NULL;
+  s_pfUrgentStep = NULL;
+
+  for (i = 0; i < ceHAL_SCHED_TASK_NB; i++) {
+    vHAL_Sched_getStats((eHAL_SchedTask_t)i, &l_sStats);
+    HOST_TEST_CHECK(
+      l_sStats.u32_runs == l_sStats.u32_activations,
+      "stress: task %u run %u times for %u activations", (unsigned)i, l_sStats.u32_runs, l_sStats.u32_activations
+    );
+    l_u32Activations += l_sStats.u32_activations;
+  }
+  HOST_TEST_CHECK(l_u32Activations > cHOST_TEST_SCHED_ROUNDS, "stress: only %u activations, the steps did not nest", l_u32Activations);
+  HOST_TEST_CHECK(s_u32Violations == 0, "stress: %u runs found the resource owned", s_u32Violations);
+  HOST_TEST_CHECK(s_u32Owners == 0, "stress: %u owners left", s_u32Owners);
+  HOST_TEST_CHECK(__get_BASEPRI() == 0, "stress: BASEPRI left at %u", (unsigned)__get_BASEPRI());
+}
+
+/**
+ * @brief Reinstalls the four tasks and empties the log
+ *
+ * @param p_pu32Priorities the priority of each task
+ * @return
+ */
+static void vHostTestSched_install(const uint32_t* p_pu32Priorities) {
+  uint32_t i;
+
+  vHAL_Sched_init();
+  for (i = 0; i < ceHAL_SCHED_TASK_NB; i++) {
+    HOST_TEST_CHECK(
+      bHAL_Sched_setTask((eHAL_SchedTask_t)i, s_apfTasks[i], p_pu32Priorities[i]),
+      "task %u not installed at priority %u", (unsigned)i, p_pu32Priorities[i]
+    );
+  }
+  s_u32LogNb = 0;
+}
+
+/**
+ * @brief Appends an entry to the run log, extra entries are counted only
+ *
+ * @param p_u32Entry a task number or a marker
+ * @return
+ */
+static void vHostTestSched_log(uint32_t p_u32Entry) {
+  if (s_u32LogNb < cHOST_TEST_SCHED_LOG_SIZE) {
+    s_au32Log[s_u32LogNb] = p_u32Entry;
+  }
+  s_u32LogNb++;
+}
+
+/**
+ * @brief Compares the run log with the expected one
+ *
+ * @param p_pcName the test name
+ * @param p_pu32Expected the expected entries
+ * @param p_u32Nb the number of expected entries
+ * @return
+ */
+static void vHostTestSched_checkLog(const char* p_pcName, const uint32_t* p_pu32Expected, uint32_t p_u32Nb) {
+  uint32_t i;
+
+  HOST_TEST_CHECK(s_u32LogNb == p_u32Nb, "%s: %u entries logged, expected %u", p_pcName, s_u32LogNb, p_u32Nb);
+  for (i = 0; i < p_u32Nb && i < s_u32LogNb && i < cHOST_TEST_SCHED_LOG_SIZE; i++) {
+    HOST_TEST_CHECK(
+      s_au32Log[i] == p_pu32Expected[i],
+      "%s: entry %u is %u, expected %u", p_pcName, (unsigned)i, s_au32Log[i], p_pu32Expected[i]
+    );
+  }
+}
+
+/**
+ * @brief Body shared by the tasks: logs the run then does the test step
+ *
+ * @param p_eTask the running task
+ * @return
+ */
+static void vHostTestSched_run(eHAL_SchedTask_t p_eTask) {
+  vHostTestSched_log((uint32_t)p_eTask);
+  if (s_pfStep != NULL) {
+    s_pfStep(p_eTask);
+  }
+}
+
+static void vHostTestSched_task0(void) {
+  vHostTestSched_run(ceHAL_SCHED_TASK_0);
+}
+
+static void vHostTestSched_task1(void) {
+  vHostTestSched_run(ceHAL_SCHED_TASK_1);
+}
+
+static void vHostTestSched_task2(void) {
+  vHostTestSched_run(ceHAL_SCHED_TASK_2);
+}
+
+static void vHostTestSched_task3(void) {
+  vHostTestSched_run(ceHAL_SCHED_TASK_3);
+}
+
+/**
+ * @brief Step of the preemption test, task 2 activates the others
+ *
+ * @param p_eTask the running task
+ * @return
+ */
+static void vHostTestSched_preemptStep(eHAL_SchedTask_t p_eTask) {
+  if (p_eTask != ceHAL_SCHED_TASK_2) {
+    return;
+  }
+
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_0);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_3);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_1);
+  NVIC_SetPendingIRQ(TIM5_IRQn);
+  vHostTestSched_log(cHOST_TEST_SCHED_MARK);
+}
+
+/**
+ * @brief Step of the lock test, task 0 locks then activates the others
+ *
+ * Task 1 is a user, tasks 2 and 3 are not but sit between the ceiling
+ * and task 0: all three wait for the unlock, then preempt task 0.
+ *
+ * @param p_eTask the running task
+ * @return
+ */
+static void vHostTestSched_lockStep(eHAL_SchedTask_t p_eTask) {
+  uint32_t l_u32Key;
+
+  if (p_eTask != ceHAL_SCHED_TASK_0) {
+    if (s_u32Owners != 0) {
+      s_u32Violations++;
+    }
+    return;
+  }
+
+  l_u32Key = u32HAL_Sched_lock(&s_sResource);
+  s_u32Owners++;
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_3);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_2);
+  vHAL_Sched_activate(ceHAL_SCHED_TASK_1);
+  NVIC_SetPendingIRQ(TIM5_IRQn);
+  vHostTestSched_log(cHOST_TEST_SCHED_MARK);
+  s_u32Owners--;
+  vHAL_Sched_unlock(l_u32Key);
+  vHostTestSched_log(cHOST_TEST_SCHED_MARK);
+}
+
+/**
+ * @brief Step of the stress test, the task owns the resource while it
+ * activates other tasks and pends the urgent interrupt
+ *
+ * @param p_eTask the running task
+ * @return
+ */
+static void vHostTestSched_stressStep(eHAL_SchedTask_t p_eTask) {
+  uint32_t l_u32Key;
+  uint32_t l_u32InnerKey;
+  uint32_t l_u32Nb;
+  uint32_t i;
+
+  (void)p_eTask;
+
+  l_u32Key = u32HAL_Sched_lock(&s_sResource);
+  if (s_u32Owners != 0) {
+    s_u32Violations++;
+  }
+  s_u32Owners++;
+
+  l_u32Nb = u32HostTestSched_random(3);
+  for (i = 0; i < l_u32Nb && s_u32Budget > 0; i++) {
+    s_u32Budget--;
+    if (u32HostTestSched_random(3) == 0) {
+      NVIC_SetPendingIRQ(TIM5_IRQn);
+    } else {
+      vHAL_Sched_activate((eHAL_SchedTask_t)u32HostTestSched_random(ceHAL_SCHED_TASK_NB));
+    }
+  }
+
+  s_u32Owners--;
+  vHAL_Sched_unlock(l_u32Key);
+
+  /* Nested lock, BASEPRI must only be raised */
+  if (u32HostTestSched_random(2) == 0) {
+    l_u32Key = u32HAL_Sched_lock(&s_sResource);
+    l_u32InnerKey = u32HAL_Sched_lock(&s_sResource);
+    s_u32Owners++;
+    vHAL_Sched_unlock(l_u32InnerKey);
+    if (s_u32Owners != 1) {
+      s_u32Violations++;
+    }
+    s_u32Owners--;
+    vHAL_Sched_unlock(l_u32Key);
+  }
+}
+
+/**
+ * @brief Urgent step of the stress test, runs while a task may own the
+ * resource and only activates tasks
+ *
+ * @param p_eTask unused
+ * @return
+ */
+static void vHostTestSched_stressUrgent(eHAL_SchedTask_t p_eTask) {
+  (void)p_eTask;
+
+  if (s_u32Budget > 0) {
+    s_u32Budget--;
+    vHAL_Sched_activate((eHAL_SchedTask_t)u32HostTestSched_random(ceHAL_SCHED_TASK_NB));
+  }
+}
+
+/**
+ * @brief Linear congruential generator, the same sequence on every run
+ *
+ * @param p_u32Range the number of values
+ * @return a value below p_u32Range
+ */
+static uint32_t u32HostTestSched_random(uint32_t p_u32Range) {
+  s_u32Random = s_u32Random * 1664525U + 1013904223U;
+  return (s_u32Random >> 16) % p_u32Range;
+}
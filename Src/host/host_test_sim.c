@@ -0,0 +1,531 @@
+/**
+  ******************************************************************************
+  * @file           : host_test_sim.c
+  * @brief          : Host unit test of the simulated BMP581: noise of each
+  * oversampling, IIR noise reduction, conversion timing and noise seeding
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <math.h>
+#include <stddef.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "app/app_bmp581.h"
+#include "app/app_bmp581_timing.h"
+#include "sim/sim_bus.h"
+#include "sim/sim_bmp581.h"
+#include "host/host_test.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Struct holding the statistics of a run of conversions
+ *
+ */
+typedef struct {
+  double d_press_mean;  //Pa, offset from the set pressure
+  double d_press_rms;   //Pa
+  double d_temp_mean;   //Degree Celsius, offset from the set temperature
+  double d_temp_rms;    //Degree Celsius
+} sHostTestSimStats_t;
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_TEST_SIM_ADDRESS        BMP581_I2C_ADDR_PRIM
+#define cHOST_TEST_SIM_OSR_NB         8
+#define cHOST_TEST_SIM_ODR_NB         32
+#define cHOST_TEST_SIM_IIR_NB         8
+#define cHOST_TEST_SIM_PRESS_RAW      (uint32_t)6484800 //101325 Pa
+#define cHOST_TEST_SIM_TEMP_RAW       (int32_t)1638400  //25 degree Celsius
+#define cHOST_TEST_SIM_PRESS_LSB      64.0              //Raw units per Pa
+#define cHOST_TEST_SIM_TEMP_LSB       65536.0           //Raw units per degree Celsius
+#define cHOST_TEST_SIM_TEMP_NOISE_C   3e-3              //Temperature RMS noise at x1
+#define cHOST_TEST_SIM_NOISE_SAMPLES  (uint32_t)20000
+#define cHOST_TEST_SIM_NOISE_TOL      0.05              //Relative, 7 standard errors
+#define cHOST_TEST_SIM_IIR_SAMPLES    (uint32_t)2000    //Per unit of 2c + 1, the filter correlates the samples
+#define cHOST_TEST_SIM_IIR_TOL        0.06              //Relative, the table is rounded to 1 mPa
+#define cHOST_TEST_SIM_PERIODS        (uint32_t)16
+#define cHOST_TEST_SIM_SEED           (uint32_t)0x5EED
+#define cHOST_TEST_SIM_SEED_SAMPLES   (uint32_t)256
+#define cHOST_TEST_SIM_RAMP_OFFSET    100000.0          //Pa
+#define cHOST_TEST_SIM_RAMP_SLOPE     6400.0            //Pa per second
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sSIM_BMP581_t s_sDevice;
+static uint32_t s_u32NowUs;
+static uint32_t s_u32BusFailures;  //Transfers not acknowledged, checked once at the end
+
+/* Private function prototypes -----------------------------------------------*/
+static void vHostTestSim_testNoise(void);
+static void vHostTestSim_testIIR(void);
+static void vHostTestSim_testContinuous(void);
+static void vHostTestSim_testNormal(void);
+static void vHostTestSim_testForced(void);
+static void vHostTestSim_testSeed(void);
+static void vHostTestSim_start(uint8_t p_u8OSRConfig, uint8_t p_u8DSPConfig, uint8_t p_u8DSPIIR, uint8_t p_u8ODRConfig, bool p_bNoise, uint32_t p_u32Seed);
+static void vHostTestSim_write(uint8_t p_u8Register, uint8_t p_u8Value);
+static void vHostTestSim_read(uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size);
+static void vHostTestSim_readData(uint32_t* p_pu32PressRaw, int32_t* p_ps32TempRaw);
+static uint32_t u32HostTestSim_conversionsAt(uint32_t p_u32NowUs);
+static void vHostTestSim_measure(uint32_t p_u32PeriodUs, uint32_t p_u32Skipped, uint32_t p_u32Samples, sHostTestSimStats_t* p_psStats);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ *
+ * @return 0 if every check passed
+ */
+int main(void) {
+  vHostTestSim_testNoise();
+  vHostTestSim_testIIR();
+  vHostTestSim_testContinuous();
+  vHostTestSim_testNormal();
+  vHostTestSim_testForced();
+  vHostTestSim_testSeed();
+
+  HOST_TEST_CHECK(s_u32BusFailures == 0, "%u transfers failed", (unsigned)s_u32BusFailures);
+  return iHostTest_report("sim");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Checks the RMS noise of each osr_p and osr_t without filter
+ *
+ * The pressure one is the datasheet figure of u32APP_BMP581_getPressNoiseMPa,
+ * the temperature one 3 mC averaged down by the square root of the
+ * oversampling. Both are centred on the set values.
+ *
+ * @return
+ */
+static void vHostTestSim_testNoise(void) {
+  uint32_t l_u32OSR;
+  uint32_t l_u32OSRTemp;
+  uint32_t l_u32ConvUs;
+  double l_dPressExpected;
+  double l_dTempExpected;
+  sHostTestSimStats_t l_sStats;
+
+  for (l_u32OSR = 0; l_u32OSR < cHOST_TEST_SIM_OSR_NB; l_u32OSR++) {
+    /* osr_t runs the other way so a mix-up of the two shows */
+    l_u32OSRTemp = cHOST_TEST_SIM_OSR_NB - 1U - l_u32OSR;
+    vHostTestSim_start(
+      APP_BMP581_SET(OSR_CONFIG, OSR_T, l_u32OSRTemp) | APP_BMP581_SET(OSR_CONFIG, OSR_P, l_u32OSR) | APP_BMP581_SET(OSR_CONFIG, PRESS_EN, 1),
+      0, 0, APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_CONTINUOUS),
+      true, cHOST_TEST_SIM_SEED
+    );
+    l_u32ConvUs = u32APP_BMP581_getConversionTimeUs((eBMP581OSR_t)l_u32OSRTemp, (eBMP581OSR_t)l_u32OSR, true);
+    vHostTestSim_measure(l_u32ConvUs, 0, cHOST_TEST_SIM_NOISE_SAMPLES, &l_sStats);
+
+    l_dPressExpected = (double)u32APP_BMP581_getPressNoiseMPa((eBMP581OSR_t)l_u32OSR, ceAPP_BMP581_FILTER_BYPASS) / 1e3;
+    l_dTempExpected = cHOST_TEST_SIM_TEMP_NOISE_C / sqrt((double)(1U << l_u32OSRTemp));
+    HOST_TEST_CHECK(
+      fabs(l_sStats.d_press_rms / l_dPressExpected - 1.0) < cHOST_TEST_SIM_NOISE_TOL,
+      "osr_p %u: pressure noise %.4f Pa, expected %.4f Pa", (unsigned)l_u32OSR, l_sStats.d_press_rms, l_dPressExpected
+    );
+    HOST_TEST_CHECK(
+      fabs(l_sStats.d_temp_rms / l_dTempExpected - 1.0) < cHOST_TEST_SIM_NOISE_TOL,
+      "osr_t %u: temperature noise %.6f C, expected %.6f C", (unsigned)l_u32OSRTemp, l_sStats.d_temp_rms, l_dTempExpected
+    );
+    HOST_TEST_CHECK(
+      fabs(l_sStats.d_press_mean) < l_dPressExpected * cHOST_TEST_SIM_NOISE_TOL,
+      "osr_p %u: pressure biased by %.4f Pa", (unsigned)l_u32OSR, l_sStats.d_press_mean
+    );
+    HOST_TEST_CHECK(
+      fabs(l_sStats.d_temp_mean) < l_dTempExpected * cHOST_TEST_SIM_NOISE_TOL,
+      "osr_t %u: temperature biased by %.6f C", (unsigned)l_u32OSRTemp, l_sStats.d_temp_mean
+    );
+  }
+}
+
+/**
+ * @brief Checks that each IIR coefficient c divides the RMS noise of the
+ * shadowed data by sqrt(2c + 1)
+ *
+ * The filter correlates the outputs over about c conversions, so the run
+ * first lets the priming sample fade and then lasts 2c + 1 times longer
+ * to keep the same statistical error. The pressure result is also checked
+ * against u32APP_BMP581_getPressNoiseMPa, which the configuration solver
+ * relies on.
+ *
+ * @return
+ */
+static void vHostTestSim_testIIR(void) {
+  uint32_t l_u32IIR;
+  uint32_t l_u32Coefficient = 0;
+  uint32_t l_u32ConvUs = u32APP_BMP581_getConversionTimeUs(ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_1, true);
+  double l_dReduction;
+  double l_dTable;
+  sHostTestSimStats_t l_sBypass = {0};
+  sHostTestSimStats_t l_sStats;
+
+  for (l_u32IIR = 0; l_u32IIR < cHOST_TEST_SIM_IIR_NB; l_u32IIR++) {
+    vHostTestSim_start(
+      APP_BMP581_SET(OSR_CONFIG, PRESS_EN, 1),
+      APP_BMP581_SET(DSP_CONFIG, SHDW_SEL_IIR_T, 1) | APP_BMP581_SET(DSP_CONFIG, SHDW_SEL_IIR_P, 1),
+      APP_BMP581_SET(DSP_IIR, SET_IIR_T, l_u32IIR) | APP_BMP581_SET(DSP_IIR, SET_IIR_P, l_u32IIR),
+      APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_CONTINUOUS),
+      true, cHOST_TEST_SIM_SEED
+    );
+    vHostTestSim_measure(
+      l_u32ConvUs, 8U * (l_u32Coefficient + 1U), cHOST_TEST_SIM_IIR_SAMPLES * (2U * l_u32Coefficient + 1U), &l_sStats
+    );
+    if (l_u32IIR == 0) {
+      l_sBypass = l_sStats;
+    }
+
+    l_dReduction = 1.0 / sqrt(2.0 * (double)l_u32Coefficient + 1.0);
+    HOST_TEST_CHECK(
+      fabs(l_sStats.d_press_rms / (l_sBypass.d_press_rms * l_dReduction) - 1.0) < cHOST_TEST_SIM_IIR_TOL,
+      "set_iir_p %u: pressure noise %.4f Pa, expected %.4f Pa", (unsigned)l_u32IIR, l_sStats.d_press_rms, l_sBypass.d_press_rms * l_dReduction
+    );
+    HOST_TEST_CHECK(
+      fabs(l_sStats.d_temp_rms / (l_sBypass.d_temp_rms * l_dReduction) - 1.0) < cHOST_TEST_SIM_IIR_TOL,
+      "set_iir_t %u: temperature noise %.6f C, expected %.6f C", (unsigned)l_u32IIR, l_sStats.d_temp_rms, l_sBypass.d_temp_rms * l_dReduction
+    );
+
+    l_dTable = (double)u32APP_BMP581_getPressNoiseMPa(ceAPP_BMP581_OSR_1, (eBMP581IRRFilter_t)l_u32IIR) / 1e3;
+    HOST_TEST_CHECK(
+      fabs(l_sStats.d_press_rms / l_dTable - 1.0) < cHOST_TEST_SIM_IIR_TOL,
+      "set_iir_p %u: pressure noise %.4f Pa, table %.4f Pa", (unsigned)l_u32IIR, l_sStats.d_press_rms, l_dTable
+    );
+
+    l_u32Coefficient = 2U * l_u32Coefficient + 1U;
+  }
+}
+
+/**
+ * @brief Checks that continuous mode chains conversions of the conversion
+ * time of every osr_t, osr_p and press_en
+ *
+ * @return
+ */
+static void vHostTestSim_testContinuous(void) {
+  uint32_t l_u32OSRTemp;
+  uint32_t l_u32OSRPress;
+  uint32_t l_u32Press;
+  uint32_t l_u32ConvUs;
+  uint32_t l_u32Before;
+  uint32_t l_u32After;
+
+  for (l_u32OSRTemp = 0; l_u32OSRTemp < cHOST_TEST_SIM_OSR_NB; l_u32OSRTemp++) {
+    for (l_u32OSRPress = 0; l_u32OSRPress < cHOST_TEST_SIM_OSR_NB; l_u32OSRPress++) {
+      for (l_u32Press = 0; l_u32Press < 2; l_u32Press++) {
+        vHostTestSim_start(
+          APP_BMP581_SET(OSR_CONFIG, OSR_T, l_u32OSRTemp) | APP_BMP581_SET(OSR_CONFIG, OSR_P, l_u32OSRPress) |
+          APP_BMP581_SET(OSR_CONFIG, PRESS_EN, l_u32Press),
+          0, 0, APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_CONTINUOUS),
+          false, cHOST_TEST_SIM_SEED
+        );
+        l_u32ConvUs = u32APP_BMP581_getConversionTimeUs((eBMP581OSR_t)l_u32OSRTemp, (eBMP581OSR_t)l_u32OSRPress, l_u32Press != 0);
+        l_u32Before = u32HostTestSim_conversionsAt(l_u32ConvUs - 1U);
+        l_u32After = u32HostTestSim_conversionsAt(l_u32ConvUs);
+        HOST_TEST_CHECK(
+          l_u32Before == 0 && l_u32After == 1,
+          "osr_t %u osr_p %u press_en %u: %u then %u conversions around %u us",
+          (unsigned)l_u32OSRTemp, (unsigned)l_u32OSRPress, (unsigned)l_u32Press, (unsigned)l_u32Before, (unsigned)l_u32After, (unsigned)l_u32ConvUs
+        );
+
+        l_u32Before = u32HostTestSim_conversionsAt(cHOST_TEST_SIM_PERIODS * l_u32ConvUs - 1U);
+        l_u32After = u32HostTestSim_conversionsAt(cHOST_TEST_SIM_PERIODS * l_u32ConvUs);
+        HOST_TEST_CHECK(
+          l_u32Before == cHOST_TEST_SIM_PERIODS - 1U && l_u32After == cHOST_TEST_SIM_PERIODS,
+          "osr_t %u osr_p %u press_en %u: %u then %u conversions, expected %u then %u",
+          (unsigned)l_u32OSRTemp, (unsigned)l_u32OSRPress, (unsigned)l_u32Press, (unsigned)l_u32Before, (unsigned)l_u32After,
+          (unsigned)(cHOST_TEST_SIM_PERIODS - 1U), (unsigned)cHOST_TEST_SIM_PERIODS
+        );
+      }
+    }
+  }
+}
+
+/**
+ * @brief Checks the conversion count and the effective oversampling of
+ * normal mode at every odr
+ *
+ * Conversions start one ODR period apart and last the conversion time of
+ * OSR_EFF. x1/x1 fits at every odr, x128/x128 has to be lowered until it
+ * fits in the period and only then flags odr_is_valid down.
+ *
+ * @return
+ */
+static void vHostTestSim_testNormal(void) {
+  static const uint32_t l_au32OSR[] = {ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_128};
+  uint32_t l_u32ODR;
+  uint32_t l_u32OSR;
+  uint32_t l_u32PeriodUs;
+  uint32_t l_u32ConvUs;
+  uint32_t l_u32LastUs;
+  uint32_t l_u32Before;
+  uint32_t l_u32After;
+  uint8_t l_u8OSREff;
+  bool l_bValid;
+
+  for (l_u32ODR = 0; l_u32ODR < cHOST_TEST_SIM_ODR_NB; l_u32ODR++) {
+    for (l_u32OSR = 0; l_u32OSR < sizeof(l_au32OSR) / sizeof(l_au32OSR[0]); l_u32OSR++) {
+      vHostTestSim_start(
+        APP_BMP581_SET(OSR_CONFIG, OSR_T, l_au32OSR[l_u32OSR]) | APP_BMP581_SET(OSR_CONFIG, OSR_P, l_au32OSR[l_u32OSR]) |
+        APP_BMP581_SET(OSR_CONFIG, PRESS_EN, 1),
+        0, 0, APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_NORMAL) | APP_BMP581_SET(ODR_CONFIG, ODR, l_u32ODR),
+        false, cHOST_TEST_SIM_SEED
+      );
+      vHostTestSim_read(cAPP_BMP581_REG_OSR_EFF, &l_u8OSREff, 1);
+      l_u32PeriodUs = u32APP_BMP581_getODRPeriodUs((eBMP581ODR_t)l_u32ODR);
+      l_u32ConvUs = u32APP_BMP581_getConversionTimeUs(
+        (eBMP581OSR_t)APP_BMP581_GET(OSR_EFF, OSR_T_EFF, l_u8OSREff), (eBMP581OSR_t)APP_BMP581_GET(OSR_EFF, OSR_P_EFF, l_u8OSREff), true
+      );
+      l_bValid = bAPP_BMP581_isODRValid(
+        (eBMP581ODR_t)l_u32ODR, (eBMP581OSR_t)l_au32OSR[l_u32OSR], (eBMP581OSR_t)l_au32OSR[l_u32OSR], true
+      );
+
+      HOST_TEST_CHECK(
+        (APP_BMP581_GET(OSR_EFF, ODR_IS_VALID, l_u8OSREff) != 0U) == l_bValid,
+        "odr %u osr %u: odr_is_valid %u, expected %u",
+        (unsigned)l_u32ODR, (unsigned)l_au32OSR[l_u32OSR], (unsigned)APP_BMP581_GET(OSR_EFF, ODR_IS_VALID, l_u8OSREff), l_bValid
+      );
+      HOST_TEST_CHECK(
+        l_u32ConvUs <= l_u32PeriodUs,
+        "odr %u osr %u: OSR_EFF 0x%02X converts in %u us, longer than the %u us period",
+        (unsigned)l_u32ODR, (unsigned)l_au32OSR[l_u32OSR], l_u8OSREff, (unsigned)l_u32ConvUs, (unsigned)l_u32PeriodUs
+      );
+      HOST_TEST_CHECK(
+        !l_bValid || APP_BMP581_GET(OSR_EFF, OSR_P_EFF, l_u8OSREff) == l_au32OSR[l_u32OSR],
+        "odr %u osr %u: OSR_EFF 0x%02X lowered a valid oversampling",
+        (unsigned)l_u32ODR, (unsigned)l_au32OSR[l_u32OSR], l_u8OSREff
+      );
+
+      l_u32LastUs = (cHOST_TEST_SIM_PERIODS - 1U) * l_u32PeriodUs + l_u32ConvUs;
+      l_u32Before = u32HostTestSim_conversionsAt(l_u32LastUs - 1U);
+      l_u32After = u32HostTestSim_conversionsAt(l_u32LastUs);
+      HOST_TEST_CHECK(
+        l_u32Before == cHOST_TEST_SIM_PERIODS - 1U && l_u32After == cHOST_TEST_SIM_PERIODS,
+        "odr %u osr %u: %u then %u conversions around %u us, expected %u then %u",
+        (unsigned)l_u32ODR, (unsigned)l_au32OSR[l_u32OSR], (unsigned)l_u32Before, (unsigned)l_u32After, (unsigned)l_u32LastUs,
+        (unsigned)(cHOST_TEST_SIM_PERIODS - 1U), (unsigned)cHOST_TEST_SIM_PERIODS
+      );
+    }
+  }
+}
+
+/**
+ * @brief Checks that forced mode converts once, samples the signals in the
+ * middle of the conversion and goes back to standby
+ *
+ * @return
+ */
+static void vHostTestSim_testForced(void) {
+  sSIM_Signal_t l_sRamp = {0};
+  uint32_t l_u32ConvUs = u32APP_BMP581_getConversionTimeUs(ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_1, true);
+  uint32_t l_u32PressRaw;
+  uint32_t l_u32Expected;
+  int32_t l_s32TempRaw;
+  uint8_t l_u8ODRConfig;
+
+  l_sRamp.d_offset = cHOST_TEST_SIM_RAMP_OFFSET;
+  l_sRamp.d_slope_per_s = cHOST_TEST_SIM_RAMP_SLOPE;
+  vHostTestSim_start(APP_BMP581_SET(OSR_CONFIG, PRESS_EN, 1), 0, 0, APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_STANDBY), false, cHOST_TEST_SIM_SEED);
+  vSIM_BMP581_setSignals(&s_sDevice, &l_sRamp, NULL);
+  vHostTestSim_write(cAPP_BMP581_REG_ODR_CONFIG, APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_FORCED));
+
+  HOST_TEST_CHECK(u32HostTestSim_conversionsAt(l_u32ConvUs - 1U) == 0, "forced conversion done before %u us", (unsigned)l_u32ConvUs);
+  HOST_TEST_CHECK(u32HostTestSim_conversionsAt(l_u32ConvUs) == 1, "forced conversion not done at %u us", (unsigned)l_u32ConvUs);
+  HOST_TEST_CHECK(u32HostTestSim_conversionsAt(cHOST_TEST_SIM_PERIODS * l_u32ConvUs) == 1, "forced mode converted again");
+
+  vHostTestSim_read(cAPP_BMP581_REG_ODR_CONFIG, &l_u8ODRConfig, 1);
+  HOST_TEST_CHECK(
+    APP_BMP581_GET(ODR_CONFIG, PWR_MODE, l_u8ODRConfig) == (uint32_t)ceAPP_BMP581_STANDBY,
+    "pwr_mode %u after the forced conversion", (unsigned)APP_BMP581_GET(ODR_CONFIG, PWR_MODE, l_u8ODRConfig)
+  );
+
+  vHostTestSim_readData(&l_u32PressRaw, &l_s32TempRaw);
+  l_u32Expected = (uint32_t)llround(
+    (cHOST_TEST_SIM_RAMP_OFFSET + cHOST_TEST_SIM_RAMP_SLOPE * (double)(l_u32ConvUs / 2U) / 1e6) * cHOST_TEST_SIM_PRESS_LSB
+  );
+  HOST_TEST_CHECK(l_u32PressRaw == l_u32Expected, "ramp sampled at %u, expected %u mid-conversion", (unsigned)l_u32PressRaw, (unsigned)l_u32Expected);
+  HOST_TEST_CHECK(l_s32TempRaw == cHOST_TEST_SIM_TEMP_RAW, "temperature %d, expected %d", (int)l_s32TempRaw, (int)cHOST_TEST_SIM_TEMP_RAW);
+}
+
+/**
+ * @brief Checks that the noise stream only depends on its seed
+ *
+ * The same seed replays the same data, another seed gives other data and
+ * without noise the data are the set values.
+ *
+ * @return
+ */
+static void vHostTestSim_testSeed(void) {
+  static uint32_t l_au32Press[cHOST_TEST_SIM_SEED_SAMPLES];
+  static int32_t l_as32Temp[cHOST_TEST_SIM_SEED_SAMPLES];
+  uint32_t l_u32ConvUs = u32APP_BMP581_getConversionTimeUs(ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_1, true);
+  uint32_t l_u32Run;
+  uint32_t l_u32Sample;
+  uint32_t l_au32Differences[3] = {0};
+  uint32_t l_u32PressRaw;
+  int32_t l_s32TempRaw;
+
+  for (l_u32Run = 0; l_u32Run < 4; l_u32Run++) {
+    /* Reference, same seed, another seed, no noise */
+    vHostTestSim_start(
+      APP_BMP581_SET(OSR_CONFIG, PRESS_EN, 1), 0, 0, APP_BMP581_SET(ODR_CONFIG, PWR_MODE, ceAPP_BMP581_CONTINUOUS),
+      l_u32Run != 3U, (l_u32Run == 2U) ? cHOST_TEST_SIM_SEED + 1U : cHOST_TEST_SIM_SEED
+    );
+    for (l_u32Sample = 0; l_u32Sample < cHOST_TEST_SIM_SEED_SAMPLES; l_u32Sample++) {
+      s_u32NowUs = l_u32Sample * l_u32ConvUs + l_u32ConvUs + l_u32ConvUs / 2U;
+      vHostTestSim_readData(&l_u32PressRaw, &l_s32TempRaw);
+      if (l_u32Run == 0) {
+        l_au32Press[l_u32Sample] = l_u32PressRaw;
+        l_as32Temp[l_u32Sample] = l_s32TempRaw;
+      }
+      else if (l_u32Run < 3U) {
+        l_au32Differences[l_u32Run] += l_au32Press[l_u32Sample] != l_u32PressRaw || l_as32Temp[l_u32Sample] != l_s32TempRaw;
+      }
+      else {
+        l_au32Differences[0] += l_u32PressRaw != cHOST_TEST_SIM_PRESS_RAW || l_s32TempRaw != cHOST_TEST_SIM_TEMP_RAW;
+      }
+    }
+  }
+
+  HOST_TEST_CHECK(l_au32Differences[1] == 0, "same seed, %u samples differ", (unsigned)l_au32Differences[1]);
+  HOST_TEST_CHECK(
+    l_au32Differences[2] > cHOST_TEST_SIM_SEED_SAMPLES / 2U,
+    "other seed, only %u of %u samples differ", (unsigned)l_au32Differences[2], (unsigned)cHOST_TEST_SIM_SEED_SAMPLES
+  );
+  HOST_TEST_CHECK(l_au32Differences[0] == 0, "no noise, %u samples off the set values", (unsigned)l_au32Differences[0]);
+}
+
+/**
+ * @brief Powers a fresh device up on a fresh bus and configures it
+ *
+ * Every register is written at time 0, the device time 0, so the mode
+ * write starts the first conversion at 0.
+ *
+ * @param p_u8OSRConfig the OSR_CONFIG register
+ * @param p_u8DSPConfig the DSP_CONFIG register
+ * @param p_u8DSPIIR the DSP_IIR register
+ * @param p_u8ODRConfig the ODR_CONFIG register, written last
+ * @param p_bNoise true to add noise to the conversions
+ * @param p_u32Seed the seed of the noise stream
+ * @return
+ */
+static void vHostTestSim_start(uint8_t p_u8OSRConfig, uint8_t p_u8DSPConfig, uint8_t p_u8DSPIIR, uint8_t p_u8ODRConfig, bool p_bNoise, uint32_t p_u32Seed) {
+  vSIM_Bus_init(cHOST_TEST_SIM_SEED);
+  vSIM_BMP581_init(&s_sDevice);
+  HOST_TEST_CHECK(bSIM_BMP581_attach(&s_sDevice, cHOST_TEST_SIM_ADDRESS), "device not attached");
+  vSIM_BMP581_setEnvironment(&s_sDevice, cHOST_TEST_SIM_PRESS_RAW, cHOST_TEST_SIM_TEMP_RAW);
+  vSIM_BMP581_setNoise(&s_sDevice, p_bNoise, p_u32Seed);
+
+  s_u32NowUs = 0;
+  vHostTestSim_write(cAPP_BMP581_REG_DSP_CONFIG, p_u8DSPConfig);
+  vHostTestSim_write(cAPP_BMP581_REG_DSP_IIR, p_u8DSPIIR);
+  vHostTestSim_write(cAPP_BMP581_REG_OSR_CONFIG, p_u8OSRConfig);
+  vHostTestSim_write(cAPP_BMP581_REG_ODR_CONFIG, p_u8ODRConfig);
+}
+
+/**
+ * @brief Writes one register at the current time
+ *
+ * @param p_u8Register the register
+ * @param p_u8Value the value
+ * @return
+ */
+static void vHostTestSim_write(uint8_t p_u8Register, uint8_t p_u8Value) {
+  uint32_t l_u32DurationUs;
+
+  s_u32BusFailures += eSIM_Bus_memWrite(cHOST_TEST_SIM_ADDRESS, p_u8Register, &p_u8Value, 1, s_u32NowUs, &l_u32DurationUs) != ceSIM_BUS_OK;
+}
+
+/**
+ * @brief Reads registers at the current time
+ *
+ * @param p_u8Register the first register
+ * @param p_pu8Data the bytes read
+ * @param p_u16Size the number of bytes
+ * @return
+ */
+static void vHostTestSim_read(uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  uint32_t l_u32DurationUs;
+
+  s_u32BusFailures += eSIM_Bus_memRead(cHOST_TEST_SIM_ADDRESS, p_u8Register, p_pu8Data, p_u16Size, s_u32NowUs, &l_u32DurationUs) != ceSIM_BUS_OK;
+}
+
+/**
+ * @brief Reads the data registers at the current time
+ *
+ * @param p_pu32PressRaw the pressure in 1/64 Pa
+ * @param p_ps32TempRaw the temperature in 1/65536 degree Celsius
+ * @return
+ */
+static void vHostTestSim_readData(uint32_t* p_pu32PressRaw, int32_t* p_ps32TempRaw) {
+  uint8_t l_au8Data[6];
+  uint32_t l_u32Temp;
+
+  vHostTestSim_read(cAPP_BMP581_REG_TEMP_DATA_XLSB, l_au8Data, sizeof(l_au8Data));
+  l_u32Temp = (uint32_t)l_au8Data[0] | ((uint32_t)l_au8Data[1] << 8) | ((uint32_t)l_au8Data[2] << 16);
+  *p_ps32TempRaw = (int32_t)(l_u32Temp << 8) >> 8;
+  *p_pu32PressRaw = (uint32_t)l_au8Data[3] | ((uint32_t)l_au8Data[4] << 8) | ((uint32_t)l_au8Data[5] << 16);
+}
+
+/**
+ * @brief Gives the number of conversions completed at a time
+ *
+ * The device only moves on at a transfer, CHIP_ID is read to bring it to
+ * p_u32NowUs.
+ *
+ * @param p_u32NowUs the time, not before the previous transfer
+ * @return the number of conversions since the device init
+ */
+static uint32_t u32HostTestSim_conversionsAt(uint32_t p_u32NowUs) {
+  uint8_t l_u8ChipId;
+
+  s_u32NowUs = p_u32NowUs;
+  vHostTestSim_read(cAPP_BMP581_REG_CHIP_ID, &l_u8ChipId, 1);
+  return u32SIM_BMP581_getConversions(&s_sDevice);
+}
+
+/**
+ * @brief Reads every conversion of a continuous run and gives the
+ * statistics of the data
+ *
+ * Each read falls in the middle of a conversion so it sees the previous
+ * one only.
+ *
+ * @param p_u32PeriodUs the time between two conversions
+ * @param p_u32Skipped the conversions read but left out of the statistics
+ * @param p_u32Samples the conversions in the statistics
+ * @param p_psStats the statistics, offsets from the set values
+ * @return
+ */
+static void vHostTestSim_measure(uint32_t p_u32PeriodUs, uint32_t p_u32Skipped, uint32_t p_u32Samples, sHostTestSimStats_t* p_psStats) {
+  uint32_t l_u32Sample;
+  uint32_t l_u32PressRaw;
+  int32_t l_s32TempRaw;
+  double l_dPress;
+  double l_dTemp;
+  double l_adSum[4] = {0.0};
+
+  for (l_u32Sample = 0; l_u32Sample < p_u32Skipped + p_u32Samples; l_u32Sample++) {
+    s_u32NowUs = l_u32Sample * p_u32PeriodUs + p_u32PeriodUs + p_u32PeriodUs / 2U;
+    vHostTestSim_readData(&l_u32PressRaw, &l_s32TempRaw);
+    if (l_u32Sample >= p_u32Skipped) {
+      /* Offsets keep the sums of squares well within the double precision */
+      l_dPress = ((double)l_u32PressRaw - (double)cHOST_TEST_SIM_PRESS_RAW) / cHOST_TEST_SIM_PRESS_LSB;
+      l_dTemp = ((double)l_s32TempRaw - (double)cHOST_TEST_SIM_TEMP_RAW) / cHOST_TEST_SIM_TEMP_LSB;
+      l_adSum[0] += l_dPress;
+      l_adSum[1] += l_dPress * l_dPress;
+      l_adSum[2] += l_dTemp;
+      l_adSum[3] += l_dTemp * l_dTemp;
+    }
+  }
+
+  p_psStats->d_press_mean = l_adSum[0] / (double)p_u32Samples;
+  p_psStats->d_press_rms = sqrt(l_adSum[1] / (double)p_u32Samples - p_psStats->d_press_mean * p_psStats->d_press_mean);
+  p_psStats->d_temp_mean = l_adSum[2] / (double)p_u32Samples;
+  p_psStats->d_temp_rms = sqrt(l_adSum[3] / (double)p_u32Samples - p_psStats->d_temp_mean * p_psStats->d_temp_mean);
+}
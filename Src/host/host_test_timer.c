@@ -0,0 +1,406 @@
+/**
+  ******************************************************************************
+  * @file           : host_test_timer.c
+  * @brief          : Host unit test of the timer service on a fake TIM5
+  * whose counter only moves when the test sets it: heap order and slot
+  * bookkeeping across the counter wrap, periodic phase and missed periods,
+  * forced compare events
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stddef.h>
+#include <string.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "stm32h7xx_hal.h"
+#include "hal/hal_nvic.h"
+#include "hal/hal_timer.h"
+#include "host/host_test.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Struct holding a test timer and what its expiries looked like
+ *
+ */
+typedef struct {
+  sHAL_Timer_t s_timer;
+  uint32_t u32_deadline;    //Expected next expiry
+  uint32_t u32_fired;
+  uint32_t u32_late;        //Expiries before their deadline or after another one's
+} sHostTestTimer_t;
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_TEST_TIMER_NB       (uint32_t)300
+#define cHOST_TEST_TIMER_SPREAD   (uint32_t)0x4000 //Largest delay of the heap test, us
+#define cHOST_TEST_TIMER_WRAP_US  (uint32_t)0x2000 //Counter start before the wrap
+#define cHOST_TEST_TIMER_STEP_US  (uint32_t)7      //Counter step between interrupts
+#define cHOST_TEST_TIMER_PERIOD   (uint32_t)1000
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static TIM_TypeDef s_sTIM5;
+static uint32_t s_u32Primask;
+static uint32_t s_u32Random;
+
+static sHostTestTimer_t s_asTimers[cHOST_TEST_TIMER_NB];
+static uint32_t s_u32LastExpiry;   //Deadline of the latest expiry, for the order check
+static uint32_t s_u32Expiries;
+
+/* Fake of the shim calls the timer service uses */
+RCC_TypeDef g_sHostHAL_RCC;
+volatile uint32_t uwTick;
+
+/* Private function prototypes -----------------------------------------------*/
+static void vHostTestTimer_testHeap(void);
+static void vHostTestTimer_testPeriodic(void);
+static void vHostTestTimer_testForced(void);
+static void vHostTestTimer_reset(uint32_t p_u32Now);
+static void vHostTestTimer_checkSlots(const char* p_pcName);
+static void vHostTestTimer_interrupt(void);
+static void vHostTestTimer_expired(void* p_pvArg);
+static uint32_t u32HostTestTimer_random(uint32_t p_u32Range);
+void TIM5_IRQHandler(void);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ *
+ * @return 0 if every check passed
+ */
+int main(void) {
+  vHostTestTimer_testHeap();
+  vHostTestTimer_testPeriodic();
+  vHostTestTimer_testForced();
+
+  return iHostTest_report("timer");
+}
+
+TIM_TypeDef* psHostHAL_TIM5(void) {
+  return &s_sTIM5;
+}
+
+uint32_t __get_PRIMASK(void) {
+  return s_u32Primask;
+}
+
+void __set_PRIMASK(uint32_t priMask) {
+  s_u32Primask = priMask;
+}
+
+void __disable_irq(void) {
+  s_u32Primask = 1U;
+}
+
+void __enable_irq(void) {
+  s_u32Primask = 0U;
+}
+
+void __DSB(void) {
+}
+
+void __WFI(void) {
+}
+
+void HAL_SuspendTick(void) {
+}
+
+void HAL_ResumeTick(void) {
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) {
+  return 100000000U;
+}
+
+void vHAL_NVIC_enable(IRQn_Type p_eIRQn) {
+  (void)p_eIRQn;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Arms timers with deadlines on both sides of the counter wrap,
+ * stops and restarts some of them on the way and checks they expire once
+ * each, by deadline, with the compare channel on the nearest one
+ *
+ * @return
+ */
+static void vHostTestTimer_testHeap(void) {
+  uint32_t l_u32Now = 0U - cHOST_TEST_TIMER_WRAP_US;
+  uint32_t l_u32MovesEnd = l_u32Now + cHOST_TEST_TIMER_SPREAD; //Last deadline moves
+  uint32_t l_u32End = l_u32MovesEnd + cHOST_TEST_TIMER_SPREAD;
+  uint32_t l_u32Stopped = 0;
+  uint32_t l_u32Fired = 0;
+  uint32_t l_u32Delay;
+  uint32_t i;
+
+  vHostTestTimer_reset(l_u32Now);
+  for (i = 0; i < cHOST_TEST_TIMER_NB; i++) {
+    /* Few distinct deadlines, so equal ones go through the heap too */
+    l_u32Delay = u32HostTestTimer_random(cHOST_TEST_TIMER_SPREAD / 16U) * 16U;
+    HOST_TEST_CHECK(bHAL_Timer_start(&s_asTimers[i].s_timer, l_u32Delay, 0), "heap: timer %u not armed", (unsigned)i);
+    s_asTimers[i].u32_deadline = l_u32Now + l_u32Delay;
+  }
+  HOST_TEST_CHECK(
+    u32HAL_Timer_getArmedCount() == cHOST_TEST_TIMER_NB,
+    "heap: %u timers armed, expected %u", u32HAL_Timer_getArmedCount(), cHOST_TEST_TIMER_NB
+  );
+  vHostTestTimer_checkSlots("heap armed");
+
+  while ((int32_t)(l_u32Now - l_u32End) < 0) {
+    l_u32Now += cHOST_TEST_TIMER_STEP_US;
+    s_sTIM5.CNT = l_u32Now;
+
+    /* Stops, moves or rearms a random timer, wherever it sits in the heap */
+    i = u32HostTestTimer_random(cHOST_TEST_TIMER_NB);
+    switch (((int32_t)(l_u32Now - l_u32MovesEnd) < 0) ? u32HostTestTimer_random(8) : 8U) {
+      case 0:
+        if (bHAL_Timer_isArmed(&s_asTimers[i].s_timer)) {
+          l_u32Stopped++;
+        }
+        vHAL_Timer_stop(&s_asTimers[i].s_timer);
+        break;
+      case 1:
+        if (!bHAL_Timer_isArmed(&s_asTimers[i].s_timer) && s_asTimers[i].u32_fired == 0) {
+          l_u32Stopped--;
+        }
+        l_u32Delay = u32HostTestTimer_random(cHOST_TEST_TIMER_SPREAD);
+        if (bHAL_Timer_isArmed(&s_asTimers[i].s_timer) || s_asTimers[i].u32_fired == 0) {
+          (void)bHAL_Timer_start(&s_asTimers[i].s_timer, l_u32Delay, 0);
+          s_asTimers[i].u32_deadline = l_u32Now + l_u32Delay;
+        }
+        break;
+      default:
+        break;
+    }
+
+    HOST_TEST_CHECK(s_u32Primask == 0, "heap: interrupts left masked");
+    if (u32HAL_Timer_getArmedCount() != 0) {
+      HOST_TEST_CHECK((s_sTIM5.DIER & TIM_DIER_CC1IE) != 0, "heap: compare interrupt off with %u timers armed", u32HAL_Timer_getArmedCount());
+    }
+    vHostTestTimer_checkSlots("heap");
+
+    /* The hardware raises the compare once the counter reached CCR1 */
+    if ((int32_t)(l_u32Now - s_sTIM5.CCR1) >= 0 || (s_sTIM5.EGR & TIM_EGR_CC1G) != 0) {
+      s_sTIM5.EGR = 0;
+      vHostTestTimer_interrupt();
+    }
+  }
+
+  for (i = 0; i < cHOST_TEST_TIMER_NB; i++) {
+    l_u32Fired += s_asTimers[i].u32_fired;
+    HOST_TEST_CHECK(s_asTimers[i].u32_fired <= 1, "heap: one-shot timer %u fired %u times", (unsigned)i, s_asTimers[i].u32_fired);
+    HOST_TEST_CHECK(s_asTimers[i].u32_late == 0, "heap: timer %u expired out of order", (unsigned)i);
+    HOST_TEST_CHECK(!bHAL_Timer_isArmed(&s_asTimers[i].s_timer), "heap: timer %u still armed", (unsigned)i);
+  }
+  HOST_TEST_CHECK(u32HAL_Timer_getArmedCount() == 0, "heap: %u timers left", u32HAL_Timer_getArmedCount());
+  HOST_TEST_CHECK(
+    l_u32Fired + l_u32Stopped == cHOST_TEST_TIMER_NB,
+    "heap: %u fired and %u stopped for %u timers", l_u32Fired, l_u32Stopped, cHOST_TEST_TIMER_NB
+  );
+  HOST_TEST_CHECK((s_sTIM5.DIER & TIM_DIER_CC1IE) == 0, "heap: compare interrupt left on with no timer");
+}
+
+/**
+ * @brief A periodic timer served late keeps its phase, one served more
+ * than a period late skips the missed expiries, both across the wrap
+ *
+ * @return
+ */
+static void vHostTestTimer_testPeriodic(void) {
+  uint32_t l_u32Start = 0U - 1500U;
+  sHostTestTimer_t* l_psTimer = &s_asTimers[0];
+  uint32_t l_u32Deadline = l_u32Start + 500U;
+
+  vHostTestTimer_reset(l_u32Start);
+  HOST_TEST_CHECK(bHAL_Timer_start(&l_psTimer->s_timer, 500U, cHOST_TEST_TIMER_PERIOD), "periodic: not armed");
+  l_psTimer->u32_deadline = l_u32Deadline;
+  HOST_TEST_CHECK(s_sTIM5.CCR1 == l_u32Deadline, "periodic: CCR1 0x%08x, expected 0x%08x", s_sTIM5.CCR1, l_u32Deadline);
+
+  /* Served 37 us late, the next deadline keeps the phase past the wrap */
+  s_sTIM5.CNT = l_u32Deadline + 37U;
+  vHostTestTimer_interrupt();
+  l_u32Deadline += cHOST_TEST_TIMER_PERIOD;
+  HOST_TEST_CHECK(l_psTimer->u32_fired == 1, "periodic: fired %u times, expected 1", l_psTimer->u32_fired);
+  HOST_TEST_CHECK(s_sTIM5.CCR1 == l_u32Deadline, "periodic: CCR1 0x%08x after a late expiry, expected 0x%08x", s_sTIM5.CCR1, l_u32Deadline);
+  HOST_TEST_CHECK(l_u32Deadline < l_u32Start, "periodic: the test deadline did not wrap");
+
+  /* Served on time */
+  s_sTIM5.CNT = l_u32Deadline;
+  l_psTimer->u32_deadline = l_u32Deadline;
+  vHostTestTimer_interrupt();
+  l_u32Deadline += cHOST_TEST_TIMER_PERIOD;
+  HOST_TEST_CHECK(l_psTimer->u32_fired == 2, "periodic: fired %u times, expected 2", l_psTimer->u32_fired);
+  HOST_TEST_CHECK(s_sTIM5.CCR1 == l_u32Deadline, "periodic: CCR1 0x%08x, expected 0x%08x", s_sTIM5.CCR1, l_u32Deadline);
+
+  /* Served 3.5 periods late, one expiry and a new phase from now */
+  s_sTIM5.CNT = l_u32Deadline + 3U * cHOST_TEST_TIMER_PERIOD + cHOST_TEST_TIMER_PERIOD / 2U;
+  l_psTimer->u32_deadline = l_u32Deadline;
+  vHostTestTimer_interrupt();
+  l_u32Deadline = s_sTIM5.CNT + cHOST_TEST_TIMER_PERIOD;
+  HOST_TEST_CHECK(l_psTimer->u32_fired == 3, "periodic: fired %u times after missed periods, expected 3", l_psTimer->u32_fired);
+  HOST_TEST_CHECK(s_sTIM5.CCR1 == l_u32Deadline, "periodic: CCR1 0x%08x after missed periods, expected 0x%08x", s_sTIM5.CCR1, l_u32Deadline);
+
+  /* Exactly one period late, the next expiry is a period away, not due */
+  s_sTIM5.CNT = l_u32Deadline + cHOST_TEST_TIMER_PERIOD;
+  l_psTimer->u32_deadline = l_u32Deadline;
+  vHostTestTimer_interrupt();
+  l_u32Deadline = s_sTIM5.CNT + cHOST_TEST_TIMER_PERIOD;
+  HOST_TEST_CHECK(l_psTimer->u32_fired == 4, "periodic: fired %u times, expected 4", l_psTimer->u32_fired);
+  HOST_TEST_CHECK(s_sTIM5.CCR1 == l_u32Deadline, "periodic: CCR1 0x%08x one period late, expected 0x%08x", s_sTIM5.CCR1, l_u32Deadline);
+
+  HOST_TEST_CHECK(l_psTimer->u32_late == 0, "periodic: expired before its deadline");
+  HOST_TEST_CHECK(bHAL_Timer_isArmed(&l_psTimer->s_timer), "periodic: disarmed by its expiry");
+  vHAL_Timer_stop(&l_psTimer->s_timer);
+  HOST_TEST_CHECK(!bHAL_Timer_isArmed(&l_psTimer->s_timer), "periodic: still armed once stopped");
+}
+
+/**
+ * @brief The compare event is forced when the nearest deadline already
+ * passed as it is programmed, never otherwise
+ *
+ * @return
+ */
+static void vHostTestTimer_testForced(void) {
+  uint32_t l_u32Now = 0xFFFFFFF0U;
+
+  vHostTestTimer_reset(l_u32Now);
+
+  HOST_TEST_CHECK(bHAL_Timer_start(&s_asTimers[0].s_timer, 100U, 0), "forced: timer 0 not armed");
+  HOST_TEST_CHECK((s_sTIM5.EGR & TIM_EGR_CC1G) == 0, "forced: compare forced for a future deadline");
+
+  /* Zero delay, the deadline is the current count */
+  HOST_TEST_CHECK(bHAL_Timer_start(&s_asTimers[1].s_timer, 0, 0), "forced: timer 1 not armed");
+  HOST_TEST_CHECK(s_sTIM5.CCR1 == l_u32Now, "forced: CCR1 0x%08x, expected 0x%08x", s_sTIM5.CCR1, l_u32Now);
+  HOST_TEST_CHECK((s_sTIM5.EGR & TIM_EGR_CC1G) != 0, "forced: compare not forced for a deadline reached");
+
+  /* Counter moved past both deadlines before the nearest one is
+   * stopped: the new nearest one is programmed already passed */
+  s_sTIM5.EGR = 0;
+  s_sTIM5.CNT = l_u32Now + 200U;
+  vHAL_Timer_stop(&s_asTimers[1].s_timer);
+  HOST_TEST_CHECK(s_sTIM5.CCR1 == l_u32Now + 100U, "forced: CCR1 0x%08x, expected 0x%08x", s_sTIM5.CCR1, l_u32Now + 100U);
+  HOST_TEST_CHECK((s_sTIM5.EGR & TIM_EGR_CC1G) != 0, "forced: compare not forced for a deadline passed across the wrap");
+
+  s_sTIM5.EGR = 0;
+  s_asTimers[0].u32_deadline = l_u32Now + 100U;
+  vHostTestTimer_interrupt();
+  HOST_TEST_CHECK(s_asTimers[0].u32_fired == 1, "forced: timer 0 fired %u times, expected 1", s_asTimers[0].u32_fired);
+  HOST_TEST_CHECK(s_asTimers[1].u32_fired == 0, "forced: stopped timer 1 fired");
+  HOST_TEST_CHECK((s_sTIM5.EGR & TIM_EGR_CC1G) == 0, "forced: compare forced with no timer");
+  HOST_TEST_CHECK((s_sTIM5.DIER & TIM_DIER_CC1IE) == 0, "forced: compare interrupt left on with no timer");
+}
+
+/**
+ * @brief Starts the service on the fake TIM5 and creates every test timer
+ *
+ * @param p_u32Now the counter value
+ * @return
+ */
+static void vHostTestTimer_reset(uint32_t p_u32Now) {
+  uint32_t i;
+
+  memset(&s_sTIM5, 0, sizeof(s_sTIM5));
+  vHAL_Timer_init();
+  s_sTIM5.CNT = p_u32Now;
+  s_sTIM5.EGR = 0;
+
+  memset(s_asTimers, 0, sizeof(s_asTimers));
+  for (i = 0; i < cHOST_TEST_TIMER_NB; i++) {
+    vHAL_Timer_create(&s_asTimers[i].s_timer, vHostTestTimer_expired, &s_asTimers[i]);
+  }
+  s_u32LastExpiry = p_u32Now;
+  s_u32Expiries = 0;
+  s_u32Random = 1;
+}
+
+/**
+ * @brief Checks the armed timers hold every heap slot once and the
+ * compare channel holds the nearest deadline
+ *
+ * @param p_pcName the test name
+ * @return
+ */
+static void vHostTestTimer_checkSlots(const char* p_pcName) {
+  static bool s_abTaken[cHOST_TEST_TIMER_NB];
+  uint32_t l_u32Count = u32HAL_Timer_getArmedCount();
+  uint32_t l_u32Armed = 0;
+  uint32_t l_u32Slot;
+  const sHAL_Timer_t* l_psNearest = NULL;
+  uint32_t i;
+
+  memset(s_abTaken, 0, sizeof(s_abTaken));
+  for (i = 0; i < cHOST_TEST_TIMER_NB; i++) {
+    if (!bHAL_Timer_isArmed(&s_asTimers[i].s_timer)) {
+      continue;
+    }
+    l_u32Armed++;
+    l_u32Slot = s_asTimers[i].s_timer.u32_heap_index;
+    if (l_u32Slot >= l_u32Count || s_abTaken[l_u32Slot]) {
+      HOST_TEST_CHECK(false, "%s: timer %u in slot %u of %u, taken or out of the heap", p_pcName, (unsigned)i, l_u32Slot, l_u32Count);
+      continue;
+    }
+    s_abTaken[l_u32Slot] = true;
+    if (l_psNearest == NULL || (int32_t)(s_asTimers[i].s_timer.u32_deadline - l_psNearest->u32_deadline) < 0) {
+      l_psNearest = &s_asTimers[i].s_timer;
+    }
+  }
+
+  HOST_TEST_CHECK(l_u32Armed == l_u32Count, "%s: %u timers armed, the heap holds %u", p_pcName, l_u32Armed, l_u32Count);
+  if (l_psNearest != NULL) {
+    HOST_TEST_CHECK(
+      s_sTIM5.CCR1 == l_psNearest->u32_deadline,
+      "%s: CCR1 0x%08x, nearest deadline 0x%08x", p_pcName, s_sTIM5.CCR1, l_psNearest->u32_deadline
+    );
+  }
+}
+
+/**
+ * @brief Runs the TIM5 handler as the NVIC would, flag set first
+ *
+ * @return
+ */
+static void vHostTestTimer_interrupt(void) {
+  s_sTIM5.SR |= TIM_SR_CC1IF;
+  TIM5_IRQHandler();
+  HOST_TEST_CHECK(s_u32Primask == 0, "interrupts left masked by the handler");
+}
+
+/**
+ * @brief Timer callback, records the expiry and checks its order
+ *
+ * @param p_pvArg the test timer
+ * @return
+ */
+static void vHostTestTimer_expired(void* p_pvArg) {
+  sHostTestTimer_t* l_psTimer = (sHostTestTimer_t*)p_pvArg;
+  uint32_t l_u32Now = s_sTIM5.CNT;
+
+  if (
+    (int32_t)(l_u32Now - l_psTimer->u32_deadline) < 0 ||
+    (s_u32Expiries != 0 && (int32_t)(l_psTimer->u32_deadline - s_u32LastExpiry) < 0)
+  ) {
+    l_psTimer->u32_late++;
+  }
+  s_u32LastExpiry = l_psTimer->u32_deadline;
+  s_u32Expiries++;
+  l_psTimer->u32_fired++;
+}
+
+/**
+ * @brief Linear congruential generator, the same sequence on every run
+ *
+ * @param p_u32Range the number of values
+ * @return a value below p_u32Range
+ */
+static uint32_t u32HostTestTimer_random(uint32_t p_u32Range) {
+  s_u32Random = s_u32Random * 1664525U + 1013904223U;
+  return (s_u32Random >> 16) % p_u32Range;
+}
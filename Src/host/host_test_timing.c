@@ -0,0 +1,300 @@
+/**
+  ******************************************************************************
+  * @file           : host_test_timing.c
+  * @brief          : Host unit test of the BMP581 conversion timing tables
+  * against the datasheet and of the configuration solver
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "app/app_bmp581_timing.h"
+#include "host/host_test.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_TEST_OSR_NB 8
+#define cHOST_TEST_ODR_NB 32
+#define cHOST_TEST_IIR_NB 8
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Datasheet typical forced mode conversion time in us, by [osr_t][osr_p] */
+static const uint32_t s_au32ConversionUs[cHOST_TEST_OSR_NB][cHOST_TEST_OSR_NB] = {
+  /*  osr_p:  x1       x2       x4       x8       x16      x32      x64      x128 */
+  /* x1   */ {  2000U,   2620U,   3860U,   6340U,  11300U,  21220U,  41060U,  80740U},
+  /* x2   */ {  2380U,   3000U,   4240U,   6720U,  11680U,  21600U,  41440U,  81120U},
+  /* x4   */ {  3140U,   3760U,   5000U,   7480U,  12440U,  22360U,  42200U,  81880U},
+  /* x8   */ {  4660U,   5280U,   6520U,   9000U,  13960U,  23880U,  43720U,  83400U},
+  /* x16  */ {  7700U,   8320U,   9560U,  12040U,  17000U,  26920U,  46760U,  86440U},
+  /* x32  */ { 13780U,  14400U,  15640U,  18120U,  23080U,  33000U,  52840U,  92520U},
+  /* x64  */ { 25940U,  26560U,  27800U,  30280U,  35240U,  45160U,  65000U, 104680U},
+  /* x128 */ { 50260U,  50880U,  52120U,  54600U,  59560U,  69480U,  89320U, 129000U},
+};
+
+/* Datasheet conversion time in us with the pressure disabled, by osr_t */
+static const uint32_t s_au32TempOnlyConversionUs[cHOST_TEST_OSR_NB] = {
+  1380U, 1760U, 2520U, 4040U, 7080U, 13160U, 25320U, 49640U
+};
+
+/* Datasheet output data rate of each odr value, in Hz */
+static const double s_adODRHz[cHOST_TEST_ODR_NB] = {
+  240.0, 218.537, 199.111, 179.2, 160.0, 149.333, 140.0, 129.855,
+  120.0, 110.164, 100.299, 89.6, 80.0, 70.0, 60.0, 50.056,
+  45.025, 40.0, 35.0, 30.0, 25.005, 20.0, 15.0, 10.0,
+  5.0, 4.0, 3.0, 2.0, 1.0, 0.5, 0.25, 0.125
+};
+
+/* Requirement grid of the solver test */
+static const uint32_t s_au32RateMHz[] = {0, 125, 1000, 10000, 25005, 50000, 100000, 160000, 240000, 250000};
+static const uint32_t s_au32NoiseMPa[] = {0, 20, 50, 69, 100, 150, 200, 300, 400, 780, 1000};
+static const uint32_t s_au32CurrentNA[] = {0, 600, 1000, 5000, 20000, 100000, 400000, 800000, UINT32_MAX};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t u32HostTest_expectedConversionUs(uint32_t p_u32OSRTemp, uint32_t p_u32OSRPress, bool p_bPressEn);
+static void vHostTest_conversionTime(void);
+static bool bHostTest_expectedValid(uint32_t p_u32ODR, uint32_t p_u32OSRTemp, uint32_t p_u32OSRPress, bool p_bPressEn);
+static void vHostTest_validity(void);
+static void vHostTest_solver(const sBMP581Requirements_t* p_psRequirements);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ * 
+ * @return 0 if every check passed
+ */
+int main(void) {
+  uint32_t l_u32Rate;
+  uint32_t l_u32Noise;
+  uint32_t l_u32Current;
+  sBMP581Requirements_t l_sRequirements;
+
+  vHostTest_conversionTime();
+  vHostTest_validity();
+
+  for (l_u32Rate = 0; l_u32Rate < sizeof(s_au32RateMHz) / sizeof(s_au32RateMHz[0]); l_u32Rate++) {
+    for (l_u32Noise = 0; l_u32Noise < sizeof(s_au32NoiseMPa) / sizeof(s_au32NoiseMPa[0]); l_u32Noise++) {
+      for (l_u32Current = 0; l_u32Current < sizeof(s_au32CurrentNA) / sizeof(s_au32CurrentNA[0]); l_u32Current++) {
+        l_sRequirements.u32_rate_mhz = s_au32RateMHz[l_u32Rate];
+        l_sRequirements.u32_noise_mpa = s_au32NoiseMPa[l_u32Noise];
+        l_sRequirements.u32_current_na = s_au32CurrentNA[l_u32Current];
+        vHostTest_solver(&l_sRequirements);
+      }
+    }
+  }
+
+  return iHostTest_report("timing");
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Gives the datasheet conversion time of an OSR pair
+ * 
+ * @param p_u32OSRTemp the osr_t value
+ * @param p_u32OSRPress the osr_p value
+ * @param p_bPressEn true if the pressure is measured
+ * @return the conversion time in us
+ */
+static uint32_t u32HostTest_expectedConversionUs(uint32_t p_u32OSRTemp, uint32_t p_u32OSRPress, bool p_bPressEn) {
+  return p_bPressEn ? s_au32ConversionUs[p_u32OSRTemp][p_u32OSRPress] : s_au32TempOnlyConversionUs[p_u32OSRTemp];
+}
+
+/**
+ * @brief Checks the conversion time of every OSR pair, with and without
+ * pressure, and the rejection of out of range values
+ * 
+ * @return
+ */
+static void vHostTest_conversionTime(void) {
+  uint32_t l_u32OSRTemp;
+  uint32_t l_u32OSRPress;
+  uint32_t l_u32Expected;
+  uint32_t l_u32Actual;
+  uint32_t l_u32Press;
+
+  for (l_u32OSRTemp = 0; l_u32OSRTemp < cHOST_TEST_OSR_NB; l_u32OSRTemp++) {
+    for (l_u32OSRPress = 0; l_u32OSRPress < cHOST_TEST_OSR_NB; l_u32OSRPress++) {
+      for (l_u32Press = 0; l_u32Press < 2; l_u32Press++) {
+        l_u32Expected = u32HostTest_expectedConversionUs(l_u32OSRTemp, l_u32OSRPress, l_u32Press != 0);
+        l_u32Actual = u32APP_BMP581_getConversionTimeUs((eBMP581OSR_t)l_u32OSRTemp, (eBMP581OSR_t)l_u32OSRPress, l_u32Press != 0);
+        HOST_TEST_CHECK(
+          l_u32Actual == l_u32Expected,
+          "osr_t %u osr_p %u press_en %u: %u us, expected %u us",
+          (unsigned)l_u32OSRTemp, (unsigned)l_u32OSRPress, (unsigned)l_u32Press, (unsigned)l_u32Actual, (unsigned)l_u32Expected
+        );
+      }
+    }
+  }
+
+  /* Corners quoted by the datasheet */
+  HOST_TEST_CHECK(u32APP_BMP581_getConversionTimeUs(ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_1, true) == 2000U, "x1/x1 is not 2 ms");
+  HOST_TEST_CHECK(u32APP_BMP581_getConversionTimeUs(ceAPP_BMP581_OSR_128, ceAPP_BMP581_OSR_128, true) == 129000U, "x128/x128 is not 129 ms");
+
+  HOST_TEST_CHECK(u32APP_BMP581_getConversionTimeUs((eBMP581OSR_t)cHOST_TEST_OSR_NB, ceAPP_BMP581_OSR_1, true) == 0, "osr_t out of range accepted");
+  HOST_TEST_CHECK(u32APP_BMP581_getConversionTimeUs(ceAPP_BMP581_OSR_1, (eBMP581OSR_t)cHOST_TEST_OSR_NB, true) == 0, "osr_p out of range accepted");
+}
+
+/**
+ * @brief Tells if the datasheet conversion time fits in the ODR period
+ * 
+ * @param p_u32ODR the odr value
+ * @param p_u32OSRTemp the osr_t value
+ * @param p_u32OSRPress the osr_p value
+ * @param p_bPressEn true if the pressure is measured
+ * @return true if the sensor keeps the OSR at this ODR
+ */
+static bool bHostTest_expectedValid(uint32_t p_u32ODR, uint32_t p_u32OSRTemp, uint32_t p_u32OSRPress, bool p_bPressEn) {
+  double l_dPeriodUs = 1e6 / s_adODRHz[p_u32ODR];
+
+  return (double)u32HostTest_expectedConversionUs(p_u32OSRTemp, p_u32OSRPress, p_bPressEn) <= l_dPeriodUs;
+}
+
+/**
+ * @brief Checks the validity prediction of every odr, osr_t and osr_p
+ * combination, with and without pressure
+ * 
+ * @return
+ */
+static void vHostTest_validity(void) {
+  uint32_t l_u32ODR;
+  uint32_t l_u32OSRTemp;
+  uint32_t l_u32OSRPress;
+  uint32_t l_u32Press;
+  uint32_t l_u32Valid = 0;
+  bool l_bExpected;
+  bool l_bActual;
+
+  for (l_u32ODR = 0; l_u32ODR < cHOST_TEST_ODR_NB; l_u32ODR++) {
+    for (l_u32OSRTemp = 0; l_u32OSRTemp < cHOST_TEST_OSR_NB; l_u32OSRTemp++) {
+      for (l_u32OSRPress = 0; l_u32OSRPress < cHOST_TEST_OSR_NB; l_u32OSRPress++) {
+        for (l_u32Press = 0; l_u32Press < 2; l_u32Press++) {
+          l_bExpected = bHostTest_expectedValid(l_u32ODR, l_u32OSRTemp, l_u32OSRPress, l_u32Press != 0);
+          l_bActual = bAPP_BMP581_isODRValid((eBMP581ODR_t)l_u32ODR, (eBMP581OSR_t)l_u32OSRTemp, (eBMP581OSR_t)l_u32OSRPress, l_u32Press != 0);
+          HOST_TEST_CHECK(
+            l_bActual == l_bExpected,
+            "odr %u osr_t %u osr_p %u press_en %u: valid %u, expected %u",
+            (unsigned)l_u32ODR, (unsigned)l_u32OSRTemp, (unsigned)l_u32OSRPress, (unsigned)l_u32Press, l_bActual, l_bExpected
+          );
+          l_u32Valid += l_bExpected && l_u32Press != 0;
+        }
+      }
+    }
+  }
+
+  /* Guards against a vacuous run: x1/x1 fits at 240 Hz, x128/x128 does not
+   * fit above 5 Hz */
+  HOST_TEST_CHECK(l_u32Valid > 0 && l_u32Valid < cHOST_TEST_ODR_NB * cHOST_TEST_OSR_NB * cHOST_TEST_OSR_NB, "%u valid combinations", (unsigned)l_u32Valid);
+  HOST_TEST_CHECK(bAPP_BMP581_isODRValid(ceAPP_BMP581_240_000Hz, ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_1, true), "x1/x1 rejected at 240 Hz");
+  HOST_TEST_CHECK(!bAPP_BMP581_isODRValid(ceAPP_BMP581_010_000Hz, ceAPP_BMP581_OSR_128, ceAPP_BMP581_OSR_128, true), "x128/x128 accepted at 10 Hz");
+  HOST_TEST_CHECK(bAPP_BMP581_isODRValid(ceAPP_BMP581_005_000Hz, ceAPP_BMP581_OSR_128, ceAPP_BMP581_OSR_128, true), "x128/x128 rejected at 5 Hz");
+  HOST_TEST_CHECK(!bAPP_BMP581_isODRValid((eBMP581ODR_t)cHOST_TEST_ODR_NB, ceAPP_BMP581_OSR_1, ceAPP_BMP581_OSR_1, true), "odr out of range accepted");
+}
+
+/**
+ * @brief Checks the solver against a search of every odr, osr_t, osr_p and
+ * set_iir_p combination
+ * 
+ * The expected configuration has the smallest IIR coefficient, then the
+ * lowest current, then the lowest noise, among the valid ones meeting the
+ * requirements.
+ * 
+ * @param p_psRequirements the requirements
+ * @return
+ */
+static void vHostTest_solver(const sBMP581Requirements_t* p_psRequirements) {
+  sBMP581Solution_t l_sSolution;
+  eBMP581Err_t l_eErr;
+  uint32_t l_u32IIR;
+  uint32_t l_u32ODR;
+  uint32_t l_u32OSRTemp;
+  uint32_t l_u32OSRPress;
+  uint32_t l_u32Noise;
+  uint32_t l_u32Current;
+  bool l_bFound = false;
+  uint32_t l_u32BestIIR = 0;
+  uint32_t l_u32BestCurrent = 0;
+  uint32_t l_u32BestNoise = 0;
+
+  for (l_u32IIR = 0; l_u32IIR < cHOST_TEST_IIR_NB; l_u32IIR++) {
+    for (l_u32ODR = 0; l_u32ODR < cHOST_TEST_ODR_NB; l_u32ODR++) {
+      for (l_u32OSRTemp = 0; l_u32OSRTemp < cHOST_TEST_OSR_NB; l_u32OSRTemp++) {
+        for (l_u32OSRPress = 0; l_u32OSRPress < cHOST_TEST_OSR_NB; l_u32OSRPress++) {
+          if (
+            !bHostTest_expectedValid(l_u32ODR, l_u32OSRTemp, l_u32OSRPress, true) ||
+            s_adODRHz[l_u32ODR] * 1000.0 < (double)p_psRequirements->u32_rate_mhz
+          ) {
+            continue;
+          }
+
+          l_u32Noise = u32APP_BMP581_getPressNoiseMPa((eBMP581OSR_t)l_u32OSRPress, (eBMP581IRRFilter_t)l_u32IIR);
+          l_u32Current = u32APP_BMP581_getCurrentNA((eBMP581ODR_t)l_u32ODR, (eBMP581OSR_t)l_u32OSRTemp, (eBMP581OSR_t)l_u32OSRPress);
+          if (l_u32Noise > p_psRequirements->u32_noise_mpa || l_u32Current > p_psRequirements->u32_current_na) {
+            continue;
+          }
+
+          if (
+            !l_bFound ||
+            l_u32IIR < l_u32BestIIR ||
+            (l_u32IIR == l_u32BestIIR && l_u32Current < l_u32BestCurrent) ||
+            (l_u32IIR == l_u32BestIIR && l_u32Current == l_u32BestCurrent && l_u32Noise < l_u32BestNoise)
+          ) {
+            l_u32BestIIR = l_u32IIR;
+            l_u32BestCurrent = l_u32Current;
+            l_u32BestNoise = l_u32Noise;
+            l_bFound = true;
+          }
+        }
+      }
+    }
+  }
+
+  l_eErr = errAPP_BMP581_solveConfig(p_psRequirements, &l_sSolution);
+  HOST_TEST_CHECK(
+    (l_eErr == ceAPP_BMP581_OK) == l_bFound,
+    "rate %u mHz noise %u mPa current %u nA: error %d, expected a solution %u",
+    (unsigned)p_psRequirements->u32_rate_mhz, (unsigned)p_psRequirements->u32_noise_mpa, (unsigned)p_psRequirements->u32_current_na,
+    (int)l_eErr, l_bFound
+  );
+  if (l_eErr != ceAPP_BMP581_OK || !l_bFound) {
+    return;
+  }
+
+  HOST_TEST_CHECK(
+    bHostTest_expectedValid(l_sSolution.e_odr, l_sSolution.e_osr_t, l_sSolution.e_osr_p, true) &&
+    bAPP_BMP581_isODRValid(l_sSolution.e_odr, l_sSolution.e_osr_t, l_sSolution.e_osr_p, true),
+    "solution odr %u osr_t %u osr_p %u is not valid",
+    (unsigned)l_sSolution.e_odr, (unsigned)l_sSolution.e_osr_t, (unsigned)l_sSolution.e_osr_p
+  );
+  HOST_TEST_CHECK(
+    s_adODRHz[l_sSolution.e_odr] * 1000.0 >= (double)p_psRequirements->u32_rate_mhz &&
+    l_sSolution.u32_noise_mpa <= p_psRequirements->u32_noise_mpa &&
+    l_sSolution.u32_current_na <= p_psRequirements->u32_current_na,
+    "solution odr %u noise %u mPa current %u nA misses rate %u mHz noise %u mPa current %u nA",
+    (unsigned)l_sSolution.e_odr, (unsigned)l_sSolution.u32_noise_mpa, (unsigned)l_sSolution.u32_current_na,
+    (unsigned)p_psRequirements->u32_rate_mhz, (unsigned)p_psRequirements->u32_noise_mpa, (unsigned)p_psRequirements->u32_current_na
+  );
+  HOST_TEST_CHECK(
+    l_sSolution.u32_noise_mpa == u32APP_BMP581_getPressNoiseMPa(l_sSolution.e_osr_p, l_sSolution.e_set_iir_p) &&
+    l_sSolution.u32_current_na == u32APP_BMP581_getCurrentNA(l_sSolution.e_odr, l_sSolution.e_osr_t, l_sSolution.e_osr_p),
+    "solution noise or current does not match its configuration"
+  );
+  HOST_TEST_CHECK(
+    (uint32_t)l_sSolution.e_set_iir_p == l_u32BestIIR &&
+    l_sSolution.u32_current_na == l_u32BestCurrent &&
+    l_sSolution.u32_noise_mpa == l_u32BestNoise,
+    "rate %u mHz noise %u mPa current %u nA: iir %u %u nA %u mPa, cheapest iir %u %u nA %u mPa",
+    (unsigned)p_psRequirements->u32_rate_mhz, (unsigned)p_psRequirements->u32_noise_mpa, (unsigned)p_psRequirements->u32_current_na,
+    (unsigned)l_sSolution.e_set_iir_p, (unsigned)l_sSolution.u32_current_na, (unsigned)l_sSolution.u32_noise_mpa,
+    (unsigned)l_u32BestIIR, (unsigned)l_u32BestCurrent, (unsigned)l_u32BestNoise
+  );
+}
@@ -0,0 +1,311 @@
+/**
+  ******************************************************************************
+  * @file           : host_trace.c
+  * @brief          : Host tool converting a bus trace ring into a Chrome
+  * trace JSON timeline, with the idle gaps of each bus
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "hal/hal_trace.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Struct holding the totals of one bus
+ *
+ */
+typedef struct {
+  uint32_t u32_transactions;
+  uint32_t u32_errors;
+  uint32_t u32_timeouts;
+  uint64_t u64_bytes;
+  double d_busy_us;
+  double d_first_us;
+  double d_last_end_us;
+  double d_gap_max_us;        //Longest idle time between two transactions
+  double d_gap_max_at_us;     //Start of the transaction ending it
+} sHostTraceBus_t;
+
+/* Private define ------------------------------------------------------------*/
+#define cHOST_TRACE_HEADER_SIZE 16U
+#define cHOST_TRACE_RECORD_SIZE 16U
+#define cHOST_TRACE_PID         1
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static const char* const s_apcBusNames[ceHAL_TRACE_BUS_NB] = {"I2C1", "SPI1"};
+static const char* const s_apcModeNames[ceHAL_TRANSFER_MODE_NB] = {"polling", "it", "dma"};
+static const char* const s_apcResultNames[ceHAL_TRACE_RESULT_NB] = {"ok", "error", "timeout"};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t* pu8HostTrace_load(const char* p_pcPath, size_t* p_pSize);
+static uint32_t u32HostTrace_le32(const uint8_t* p_pu8Bytes);
+static uint16_t u16HostTrace_le16(const uint8_t* p_pu8Bytes);
+static void vHostTrace_decode(const uint8_t* p_pu8Bytes, sHAL_TraceRecord_t* p_psRecord);
+static void vHostTrace_convert(const uint8_t* p_pu8File, uint32_t p_u32CpuHz, uint32_t p_u32RecordNb,
+                               uint32_t p_u32Written, double p_dGapMinUs);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Host entry point
+ *
+ * Reads a ring written by bmp581_app --bus-trace or dumped from the target,
+ * prints the timeline on stdout for chrome://tracing or Perfetto and the
+ * totals of each bus on stderr. Each bus gets a track of transactions
+ * and a track of the idle gaps between them.
+ *
+ * @param argc the number of arguments
+ * @param argv the arguments, see the usage text
+ * @return 0 on success, 1 on a bad argument or file
+ */
+int main(int argc, char** argv) {
+  const char* l_pcPath = NULL;
+  double l_dGapMinUs = 0.0;
+  uint8_t* l_pu8File;
+  size_t l_size;
+  uint32_t l_u32RecordNb;
+  uint32_t l_u32CpuHz;
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--gap-us") == 0 && i + 1 < argc) {
+      l_dGapMinUs = strtod(argv[++i], NULL);
+    }
+    else if (l_pcPath == NULL && argv[i][0] != '-') {
+      l_pcPath = argv[i];
+    }
+    else {
+      l_pcPath = NULL;
+      break;
+    }
+  }
+
+  if (l_pcPath == NULL) {
+    fprintf(stderr, "usage: %s [--gap-us N] TRACE > timeline.json\n", argv[0]);
+    return 1;
+  }
+
+  l_pu8File = pu8HostTrace_load(l_pcPath, &l_size);
+  if (l_pu8File == NULL || l_size < cHOST_TRACE_HEADER_SIZE) {
+    fprintf(stderr, "%s: cannot read %s\n", argv[0], l_pcPath);
+    free(l_pu8File);
+    return 1;
+  }
+
+  l_u32RecordNb = u16HostTrace_le16(&l_pu8File[6]);
+  l_u32CpuHz = u32HostTrace_le32(&l_pu8File[8]);
+  if (
+    u32HostTrace_le32(&l_pu8File[0]) != cHAL_TRACE_MAGIC ||
+    u16HostTrace_le16(&l_pu8File[4]) != cHAL_TRACE_VERSION ||
+    l_size < cHOST_TRACE_HEADER_SIZE + (size_t)l_u32RecordNb * cHOST_TRACE_RECORD_SIZE ||
+    l_u32RecordNb == 0 || l_u32CpuHz == 0
+  ) {
+    fprintf(stderr, "%s: %s is not a version %u bus trace\n", argv[0], l_pcPath, cHAL_TRACE_VERSION);
+    free(l_pu8File);
+    return 1;
+  }
+
+  vHostTrace_convert(l_pu8File, l_u32CpuHz, l_u32RecordNb, u32HostTrace_le32(&l_pu8File[12]), l_dGapMinUs);
+  free(l_pu8File);
+
+  return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Prints the timeline and the totals of a ring
+ *
+ * Records are in completion order. Their 32-bit cycle counts are unwrapped
+ * against the previous record, which holds while two consecutive
+ * transactions are less than 2^31 cycles apart.
+ *
+ * @param p_pu8File the file content, header checked
+ * @param p_u32CpuHz the rate of the cycle counts
+ * @param p_u32RecordNb the ring size
+ * @param p_u32Written the number of records written since the init
+ * @param p_dGapMinUs the shortest idle gap put on the timeline
+ * @return
+ */
+static void vHostTrace_convert(const uint8_t* p_pu8File, uint32_t p_u32CpuHz, uint32_t p_u32RecordNb,
+                               uint32_t p_u32Written, double p_dGapMinUs) {
+  sHostTraceBus_t l_asBus[ceHAL_TRACE_BUS_NB];
+  uint32_t l_u32Count = (p_u32Written < p_u32RecordNb) ? p_u32Written : p_u32RecordNb;
+  uint32_t l_u32First = (p_u32Written < p_u32RecordNb) ? 0 : p_u32Written % p_u32RecordNb;
+  double l_dCyclesPerUs = (double)p_u32CpuHz / 1e6;
+  sHAL_TraceRecord_t l_sRecord;
+  sHostTraceBus_t* l_psBus;
+  uint32_t l_u32RefCycles = 0;
+  int64_t l_s64RefCycles = 0;
+  int64_t l_s64Start;
+  int64_t l_s64End;
+  double l_dStartUs;
+  double l_dDurUs;
+  double l_dGapUs;
+  uint32_t i;
+
+  memset(l_asBus, 0, sizeof(l_asBus));
+
+  printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  for (i = 0; i < (uint32_t)ceHAL_TRACE_BUS_NB; i++) {
+    printf("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n",
+           cHOST_TRACE_PID, 2U * i, s_apcBusNames[i]);
+    printf("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"%s idle\"}},\n",
+           cHOST_TRACE_PID, 2U * i + 1U, s_apcBusNames[i]);
+  }
+
+  for (i = 0; i < l_u32Count; i++) {
+    vHostTrace_decode(&p_pu8File[cHOST_TRACE_HEADER_SIZE + (size_t)((l_u32First + i) % p_u32RecordNb) * cHOST_TRACE_RECORD_SIZE],
+                      &l_sRecord);
+    if (
+      l_sRecord.u8_bus >= (uint8_t)ceHAL_TRACE_BUS_NB ||
+      l_sRecord.u8_mode >= (uint8_t)ceHAL_TRANSFER_MODE_NB ||
+      l_sRecord.u8_result >= (uint8_t)ceHAL_TRACE_RESULT_NB
+    ) {
+      continue;
+    }
+
+    if (i == 0) {
+      l_u32RefCycles = l_sRecord.u32_start_cycles;
+    }
+    l_s64Start = l_s64RefCycles + (int32_t)(l_sRecord.u32_start_cycles - l_u32RefCycles);
+    l_s64End = l_s64Start + (uint32_t)(l_sRecord.u32_end_cycles - l_sRecord.u32_start_cycles);
+    l_u32RefCycles = l_sRecord.u32_end_cycles;
+    l_s64RefCycles = l_s64End;
+
+    l_dStartUs = (double)l_s64Start / l_dCyclesPerUs;
+    l_dDurUs = (double)(l_s64End - l_s64Start) / l_dCyclesPerUs;
+    l_psBus = &l_asBus[l_sRecord.u8_bus];
+
+    if (l_psBus->u32_transactions == 0) {
+      l_psBus->d_first_us = l_dStartUs;
+    }
+    else {
+      l_dGapUs = l_dStartUs - l_psBus->d_last_end_us;
+      if (l_dGapUs > l_psBus->d_gap_max_us) {
+        l_psBus->d_gap_max_us = l_dGapUs;
+        l_psBus->d_gap_max_at_us = l_dStartUs;
+      }
+      if (l_dGapUs > 0.0 && l_dGapUs >= p_dGapMinUs) {
+        printf("{\"ph\":\"X\",\"name\":\"idle\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+               cHOST_TRACE_PID, 2U * l_sRecord.u8_bus + 1U, l_psBus->d_last_end_us, l_dGapUs);
+      }
+    }
+
+    printf("{\"ph\":\"X\",\"name\":\"%s 0x%02X\",\"cat\":\"%s\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+           "\"args\":{\"address\":\"0x%02X\",\"register\":\"0x%02X\",\"size\":%u,\"mode\":\"%s\",\"result\":\"%s\"}},\n",
+           l_sRecord.u8_read ? "read" : "write", l_sRecord.u8_register, s_apcBusNames[l_sRecord.u8_bus],
+           cHOST_TRACE_PID, 2U * l_sRecord.u8_bus, l_dStartUs, l_dDurUs,
+           l_sRecord.u8_address, l_sRecord.u8_register, l_sRecord.u16_size,
+           s_apcModeNames[l_sRecord.u8_mode], s_apcResultNames[l_sRecord.u8_result]);
+
+    l_psBus->u32_transactions++;
+    l_psBus->u32_errors += (l_sRecord.u8_result == (uint8_t)ceHAL_TRACE_ERROR) ? 1U : 0U;
+    l_psBus->u32_timeouts += (l_sRecord.u8_result == (uint8_t)ceHAL_TRACE_TIMEOUT) ? 1U : 0U;
+    l_psBus->u64_bytes += l_sRecord.u16_size;
+    l_psBus->d_busy_us += l_dDurUs;
+    l_psBus->d_last_end_us = l_dStartUs + l_dDurUs;
+  }
+
+  /* Closing event, JSON allows no trailing comma */
+  printf("{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":%d,\"args\":{\"name\":\"bus trace\"}}\n]}\n", cHOST_TRACE_PID);
+
+  fprintf(stderr, "%u of %u transactions kept, %.1f MHz\n", l_u32Count, p_u32Written, l_dCyclesPerUs);
+  for (i = 0; i < (uint32_t)ceHAL_TRACE_BUS_NB; i++) {
+    double l_dSpanUs = l_asBus[i].d_last_end_us - l_asBus[i].d_first_us;
+
+    if (l_asBus[i].u32_transactions == 0) {
+      continue;
+    }
+    fprintf(stderr, "%-6s %u transactions, %u errors, %u timeouts, %llu bytes, %.2f %% busy over %.3f ms, "
+                    "longest gap %.3f us before %.3f us\n",
+            s_apcBusNames[i], l_asBus[i].u32_transactions, l_asBus[i].u32_errors, l_asBus[i].u32_timeouts,
+            (unsigned long long)l_asBus[i].u64_bytes,
+            (l_dSpanUs > 0.0) ? 100.0 * l_asBus[i].d_busy_us / l_dSpanUs : 0.0, l_dSpanUs / 1e3,
+            l_asBus[i].d_gap_max_us, l_asBus[i].d_gap_max_at_us);
+  }
+}
+
+/**
+ * @brief Reads a whole file
+ *
+ * @param p_pcPath the file
+ * @param p_pSize the number of bytes read
+ * @return the content to free, NULL on failure
+ */
+static uint8_t* pu8HostTrace_load(const char* p_pcPath, size_t* p_pSize) {
+  FILE* l_pFile = fopen(p_pcPath, "rb");
+  uint8_t* l_pu8Data = NULL;
+  long l_lSize;
+
+  *p_pSize = 0;
+  if (l_pFile == NULL) {
+    return NULL;
+  }
+
+  if (fseek(l_pFile, 0, SEEK_END) == 0 && (l_lSize = ftell(l_pFile)) > 0 && fseek(l_pFile, 0, SEEK_SET) == 0) {
+    l_pu8Data = (uint8_t*)malloc((size_t)l_lSize);
+    if (l_pu8Data != NULL && fread(l_pu8Data, 1, (size_t)l_lSize, l_pFile) == (size_t)l_lSize) {
+      *p_pSize = (size_t)l_lSize;
+    }
+  }
+
+  fclose(l_pFile);
+  if (*p_pSize == 0) {
+    free(l_pu8Data);
+    return NULL;
+  }
+  return l_pu8Data;
+}
+
+/**
+ * @brief Reads a little-endian 32-bit value
+ *
+ * @param p_pu8Bytes the 4 bytes
+ * @return the value
+ */
+static uint32_t u32HostTrace_le32(const uint8_t* p_pu8Bytes) {
+  return (uint32_t)p_pu8Bytes[0] | ((uint32_t)p_pu8Bytes[1] << 8) |
+         ((uint32_t)p_pu8Bytes[2] << 16) | ((uint32_t)p_pu8Bytes[3] << 24);
+}
+
+/**
+ * @brief Reads a little-endian 16-bit value
+ *
+ * @param p_pu8Bytes the 2 bytes
+ * @return the value
+ */
+static uint16_t u16HostTrace_le16(const uint8_t* p_pu8Bytes) {
+  return (uint16_t)(p_pu8Bytes[0] | (p_pu8Bytes[1] << 8));
+}
+
+/**
+ * @brief Decodes one record as laid out by sHAL_TraceRecord_t
+ *
+ * @param p_pu8Bytes the 16 bytes of the record
+ * @param p_psRecord the decoded record
+ * @return
+ */
+static void vHostTrace_decode(const uint8_t* p_pu8Bytes, sHAL_TraceRecord_t* p_psRecord) {
+  p_psRecord->u32_start_cycles = u32HostTrace_le32(&p_pu8Bytes[0]);
+  p_psRecord->u32_end_cycles = u32HostTrace_le32(&p_pu8Bytes[4]);
+  p_psRecord->u16_size = u16HostTrace_le16(&p_pu8Bytes[8]);
+  p_psRecord->u8_bus = p_pu8Bytes[10];
+  p_psRecord->u8_address = p_pu8Bytes[11];
+  p_psRecord->u8_register = p_pu8Bytes[12];
+  p_psRecord->u8_read = p_pu8Bytes[13];
+  p_psRecord->u8_mode = p_pu8Bytes[14];
+  p_psRecord->u8_result = p_pu8Bytes[15];
+}
@@ -0,0 +1,510 @@
+/**
+  ******************************************************************************
+  * @file           : sim_bmp581.c
+  * @brief          : Simulated BMP581 register model attached to the
+  * simulated I2C bus
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <math.h>
+#include <stddef.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "app/app_bmp581.h"
+#include "app/app_bmp581_timing.h"
+#include "app/app_bmp581_regmap.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "sim/sim_bmp581.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cSIM_BMP581_ODR_CONFIG_RESET (uint8_t)0x70 //1 Hz, standby
+#define cSIM_BMP581_PRESS_DEFAULT    101325.0 //Pa, sea level
+#define cSIM_BMP581_TEMP_DEFAULT     25.0
+#define cSIM_BMP581_NOISE_SEED       (uint32_t)1
+#define cSIM_BMP581_PRESS_LSB        64.0     //Raw units per Pa
+#define cSIM_BMP581_TEMP_LSB         65536.0  //Raw units per degree Celsius
+#define cSIM_BMP581_PRESS_RAW_MAX    (int64_t)0xFFFFFF
+#define cSIM_BMP581_TEMP_RAW_MAX     (int64_t)0x7FFFFF
+#define cSIM_BMP581_TEMP_RAW_MIN     (int64_t)-0x800000
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Temperature RMS noise in micro degree Celsius for each osr_t, 3 mC at
+   x1 averaged down by the square root of the oversampling */
+static const uint32_t s_au32TempNoiseUC[] = {3000, 2121, 1500, 1061, 750, 530, 375, 265};
+
+/* IIR coefficient of each set_iir_t and set_iir_p value */
+static const uint32_t s_au32IIRCoefficient[] = {0, 1, 3, 7, 15, 31, 63, 127};
+
+/* Private function prototypes -----------------------------------------------*/
+static bool bSIM_BMP581_read(void* p_pvDevice, uint32_t p_u32NowUs, uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size);
+static bool bSIM_BMP581_write(void* p_pvDevice, uint32_t p_u32NowUs, uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size);
+static void vSIM_BMP581_update(sSIM_BMP581_t* p_psDevice, uint32_t p_u32NowUs);
+static void vSIM_BMP581_reset(sSIM_BMP581_t* p_psDevice);
+static void vSIM_BMP581_writeRegister(sSIM_BMP581_t* p_psDevice, uint32_t p_u32NowUs, uint8_t p_u8Register, uint8_t p_u8Value);
+static bool bSIM_BMP581_isReadOnly(uint8_t p_u8Register);
+static void vSIM_BMP581_updateOSREff(sSIM_BMP581_t* p_psDevice);
+static void vSIM_BMP581_schedule(sSIM_BMP581_t* p_psDevice, uint64_t p_u64StartUs);
+static void vSIM_BMP581_convert(sSIM_BMP581_t* p_psDevice);
+static double dSIM_BMP581_filter(double p_dState, double p_dSample, uint32_t p_u32SetIIR);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Powers a simulated BMP581 up
+ * 
+ * The registers hold their reset values and the POR flag is set, as after
+ * a power-on. The signals are constant at sea level and 25 degree Celsius
+ * and the noise is off, so conversions give exact values.
+ * 
+ * @param p_psDevice the device
+ * @return
+ */
+void vSIM_BMP581_init(sSIM_BMP581_t* p_psDevice) {
+  if (p_psDevice == NULL) {
+    return;
+  }
+
+  p_psDevice->u32_conversions = 0;
+  p_psDevice->b_clocked = false;
+  p_psDevice->u64_now_us = 0;
+  vSIM_Signal_constant(&p_psDevice->s_press, cSIM_BMP581_PRESS_DEFAULT);
+  vSIM_Signal_constant(&p_psDevice->s_temp, cSIM_BMP581_TEMP_DEFAULT);
+  vSIM_BMP581_setNoise(p_psDevice, false, cSIM_BMP581_NOISE_SEED);
+  vSIM_BMP581_reset(p_psDevice);
+  p_psDevice->b_resetting = false;
+}
+
+/**
+ * @brief Attaches a simulated BMP581 to the simulated bus
+ * 
+ * @param p_psDevice the device, must stay valid while attached
+ * @param p_u8Address the 7-bit I2C address
+ * @return false if the bus refused the device
+ */
+bool bSIM_BMP581_attach(sSIM_BMP581_t* p_psDevice, uint8_t p_u8Address) {
+  sSIM_BusDevice_t l_sBusDevice = {
+    .u8_address = p_u8Address,
+    .pf_read = bSIM_BMP581_read,
+    .pf_write = bSIM_BMP581_write,
+    .pv_device = p_psDevice
+  };
+
+  return p_psDevice != NULL && bSIM_Bus_attach(&l_sBusDevice);
+}
+
+/**
+ * @brief Sets the values the next conversions give
+ * 
+ * Makes both signals constant, without noise nor filtering these raw
+ * values are read back as they are.
+ * 
+ * @param p_psDevice the device
+ * @param p_u32PressRaw the pressure in 1/64 Pa, 24 bits
+ * @param p_s32TempRaw the temperature in 1/65536 degree Celsius, 24 bits signed
+ * @return
+ */
+void vSIM_BMP581_setEnvironment(sSIM_BMP581_t* p_psDevice, uint32_t p_u32PressRaw, int32_t p_s32TempRaw) {
+  if (p_psDevice != NULL) {
+    vSIM_Signal_constant(&p_psDevice->s_press, (double)p_u32PressRaw / cSIM_BMP581_PRESS_LSB);
+    vSIM_Signal_constant(&p_psDevice->s_temp, (double)p_s32TempRaw / cSIM_BMP581_TEMP_LSB);
+  }
+}
+
+/**
+ * @brief Sets the pressure and temperature signals
+ * 
+ * The signals are copied, their traces are not and must stay valid. Time 0
+ * is the first transfer to the device.
+ * 
+ * @param p_psDevice the device
+ * @param p_psPress the pressure in Pa, NULL to keep the current one
+ * @param p_psTemp the temperature in degree Celsius, NULL to keep the current one
+ * @return
+ */
+void vSIM_BMP581_setSignals(sSIM_BMP581_t* p_psDevice, const sSIM_Signal_t* p_psPress, const sSIM_Signal_t* p_psTemp) {
+  if (p_psDevice == NULL) {
+    return;
+  }
+
+  if (p_psPress != NULL) {
+    p_psDevice->s_press = *p_psPress;
+  }
+  if (p_psTemp != NULL) {
+    p_psDevice->s_temp = *p_psTemp;
+  }
+}
+
+/**
+ * @brief Turns the conversion noise on or off
+ * 
+ * The pressure RMS noise of each effective osr_p is the one of
+ * u32APP_BMP581_getPressNoiseMPa without filter, the IIR filter then
+ * lowers it as on the device. The draws come from the device own stream,
+ * so the bus faults sequence does not depend on it.
+ * 
+ * @param p_psDevice the device
+ * @param p_bEnabled true to add noise to the conversions
+ * @param p_u32Seed the seed of the noise stream
+ * @return
+ */
+void vSIM_BMP581_setNoise(sSIM_BMP581_t* p_psDevice, bool p_bEnabled, uint32_t p_u32Seed) {
+  if (p_psDevice != NULL) {
+    p_psDevice->b_noise = p_bEnabled;
+    vSIM_Rand_seed(&p_psDevice->s_rand, p_u32Seed);
+  }
+}
+
+/**
+ * @brief Gives the number of completed conversions
+ * 
+ * Lets a benchmark tell a fresh sample from a stale data register read.
+ * 
+ * @param p_psDevice the device
+ * @return the number of conversions
+ */
+uint32_t u32SIM_BMP581_getConversions(const sSIM_BMP581_t* p_psDevice) {
+  return (p_psDevice != NULL) ? p_psDevice->u32_conversions : 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Bus side of a register read
+ * 
+ * Registers auto-increment, INT_STATUS is cleared on read.
+ * 
+ * @param p_pvDevice the device
+ * @param p_u32NowUs the transfer time
+ * @param p_u8Register the first register
+ * @param p_pu8Data the bytes read
+ * @param p_u16Size the number of bytes
+ * @return false while the soft reset runs
+ */
+static bool bSIM_BMP581_read(void* p_pvDevice, uint32_t p_u32NowUs, uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  sSIM_BMP581_t* l_psDevice = (sSIM_BMP581_t*)p_pvDevice;
+  uint32_t l_u32Register;
+  uint16_t i;
+
+  vSIM_BMP581_update(l_psDevice, p_u32NowUs);
+  if (l_psDevice->b_resetting) {
+    return false;
+  }
+
+  for (i = 0; i < p_u16Size; i++) {
+    l_u32Register = (uint32_t)p_u8Register + i;
+    p_pu8Data[i] = (l_u32Register < cSIM_BMP581_REG_NB) ? l_psDevice->au8_registers[l_u32Register] : 0;
+    if (l_u32Register == cAPP_BMP581_REG_INT_STATUS) {
+      l_psDevice->au8_registers[cAPP_BMP581_REG_INT_STATUS] = 0;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Bus side of a register write
+ * 
+ * @param p_pvDevice the device
+ * @param p_u32NowUs the transfer time
+ * @param p_u8Register the first register
+ * @param p_pu8Data the bytes written
+ * @param p_u16Size the number of bytes
+ * @return false while the soft reset runs
+ */
+static bool bSIM_BMP581_write(void* p_pvDevice, uint32_t p_u32NowUs, uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size) {
+  sSIM_BMP581_t* l_psDevice = (sSIM_BMP581_t*)p_pvDevice;
+  uint32_t l_u32Register;
+  uint16_t i;
+
+  vSIM_BMP581_update(l_psDevice, p_u32NowUs);
+  if (l_psDevice->b_resetting) {
+    return false;
+  }
+
+  for (i = 0; i < p_u16Size && !l_psDevice->b_resetting; i++) {
+    l_u32Register = (uint32_t)p_u8Register + i;
+    if (l_u32Register < cSIM_BMP581_REG_NB) {
+      vSIM_BMP581_writeRegister(l_psDevice, p_u32NowUs, (uint8_t)l_u32Register, p_pu8Data[i]);
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Ends the soft reset and the conversions due at p_u32NowUs
+ * 
+ * The bus time wraps after 71 minutes, the device keeps its own 64-bit
+ * time from the elapsed bus time, transfers being much closer than that.
+ * Its time 0 is the first transfer.
+ * 
+ * @param p_psDevice the device
+ * @param p_u32NowUs the current time
+ * @return
+ */
+static void vSIM_BMP581_update(sSIM_BMP581_t* p_psDevice, uint32_t p_u32NowUs) {
+  if (!p_psDevice->b_clocked) {
+    p_psDevice->u32_last_us = p_u32NowUs;
+    p_psDevice->b_clocked = true;
+  }
+  p_psDevice->u64_now_us += (uint32_t)(p_u32NowUs - p_psDevice->u32_last_us);
+  p_psDevice->u32_last_us = p_u32NowUs;
+
+  if (p_psDevice->b_resetting && (int32_t)(p_u32NowUs - p_psDevice->u32_reset_end_us) >= 0) {
+    p_psDevice->b_resetting = false;
+  }
+
+  /* Normal and continuous modes catch up with every conversion missed */
+  while (p_psDevice->b_converting && p_psDevice->u64_conv_end_us <= p_psDevice->u64_now_us) {
+    vSIM_BMP581_convert(p_psDevice);
+  }
+}
+
+/**
+ * @brief Puts every register back to its reset value and sets the POR flag
+ * 
+ * @param p_psDevice the device
+ * @return
+ */
+static void vSIM_BMP581_reset(sSIM_BMP581_t* p_psDevice) {
+  uint32_t i;
+
+  for (i = 0; i < cSIM_BMP581_REG_NB; i++) {
+    p_psDevice->au8_registers[i] = 0;
+  }
+
+  p_psDevice->au8_registers[cAPP_BMP581_REG_CHIP_ID] = BMP581_I2C_CHIP_ID;
+  p_psDevice->au8_registers[cAPP_BMP581_REG_REV_ID] = BMP581_I2C_REV_ID;
+  p_psDevice->au8_registers[cAPP_BMP581_REG_STATUS] = BMP581_STATUS_NVM_RDY;
+  p_psDevice->au8_registers[cAPP_BMP581_REG_INT_STATUS] = BMP581_INT_STATUS_POR;
+  p_psDevice->au8_registers[cAPP_BMP581_REG_ODR_CONFIG] = cSIM_BMP581_ODR_CONFIG_RESET;
+  vSIM_BMP581_updateOSREff(p_psDevice);
+  p_psDevice->b_converting = false;
+  p_psDevice->b_iir_primed = false;
+  p_psDevice->b_resetting = true;
+}
+
+/**
+ * @brief Applies the write of one register
+ * 
+ * @param p_psDevice the device
+ * @param p_u32NowUs the transfer time
+ * @param p_u8Register the register
+ * @param p_u8Value the value written
+ * @return
+ */
+static void vSIM_BMP581_writeRegister(sSIM_BMP581_t* p_psDevice, uint32_t p_u32NowUs, uint8_t p_u8Register, uint8_t p_u8Value) {
+  if (p_u8Register == cAPP_BMP581_REG_CMD) {
+    if (p_u8Value == BMP581_CMD_SOFT_RESET) {
+      vSIM_BMP581_reset(p_psDevice);
+      p_psDevice->u32_reset_end_us = p_u32NowUs + cSIM_BMP581_RESET_US;
+    }
+    return;
+  }
+
+  if (bSIM_BMP581_isReadOnly(p_u8Register)) {
+    return;
+  }
+
+  p_psDevice->au8_registers[p_u8Register] = p_u8Value;
+
+  if (p_u8Register == cAPP_BMP581_REG_OSR_CONFIG) {
+    /* Applies from the next conversion */
+    vSIM_BMP581_updateOSREff(p_psDevice);
+  }
+  else if (p_u8Register == cAPP_BMP581_REG_ODR_CONFIG) {
+    vSIM_BMP581_updateOSREff(p_psDevice);
+    p_psDevice->b_converting = false;
+    if (APP_BMP581_GET(ODR_CONFIG, PWR_MODE, p_u8Value) != (uint32_t)ceAPP_BMP581_STANDBY) {
+      vSIM_BMP581_schedule(p_psDevice, p_psDevice->u64_now_us);
+    }
+  }
+}
+
+/**
+ * @brief Tells whether a register ignores writes
+ * 
+ * @param p_u8Register the register
+ * @return true for the ID, status and data registers
+ */
+static bool bSIM_BMP581_isReadOnly(uint8_t p_u8Register) {
+  return
+    p_u8Register == cAPP_BMP581_REG_CHIP_ID ||
+    p_u8Register == cAPP_BMP581_REG_REV_ID ||
+    p_u8Register == cAPP_BMP581_REG_CHIP_STATUS ||
+    p_u8Register == cAPP_BMP581_REG_FIFO_COUNT ||
+    (p_u8Register >= cAPP_BMP581_REG_TEMP_DATA_XLSB && p_u8Register <= cAPP_BMP581_REG_PRESS_DATA_MSB) ||
+    (p_u8Register >= cAPP_BMP581_REG_INT_STATUS && p_u8Register <= cAPP_BMP581_REG_FIFO_DATA) ||
+    p_u8Register == cAPP_BMP581_REG_OSR_EFF;
+}
+
+/**
+ * @brief Computes OSR_EFF from OSR_CONFIG and ODR_CONFIG
+ * 
+ * In normal mode an ODR too fast for the requested oversampling makes
+ * the device lower the largest of osr_t and osr_p, osr_p first, until
+ * the conversion fits in the period. odr_is_valid tells whether the
+ * requested oversampling fits.
+ * 
+ * @param p_psDevice the device
+ * @return
+ */
+static void vSIM_BMP581_updateOSREff(sSIM_BMP581_t* p_psDevice) {
+  uint8_t l_u8ODRConfig = p_psDevice->au8_registers[cAPP_BMP581_REG_ODR_CONFIG];
+  eBMP581ODR_t l_eODR = (eBMP581ODR_t)APP_BMP581_GET(ODR_CONFIG, ODR, l_u8ODRConfig);
+  uBMP581_OSR_CONFIG_t l_uOSRConfig;
+  sOSRConfig_t l_sOSRConfig;
+  bool l_bValid;
+
+  l_uOSRConfig.u8_raw = p_psDevice->au8_registers[cAPP_BMP581_REG_OSR_CONFIG];
+  vAPP_BMP581_unpackOSRConfig(l_uOSRConfig, &l_sOSRConfig);
+  l_bValid = bAPP_BMP581_isODRValid(l_eODR, l_sOSRConfig.e_osr_t, l_sOSRConfig.e_osr_p, l_sOSRConfig.b_press_en);
+
+  if (APP_BMP581_GET(ODR_CONFIG, PWR_MODE, l_u8ODRConfig) == (uint32_t)ceAPP_BMP581_NORMAL) {
+    while (
+      !bAPP_BMP581_isODRValid(l_eODR, l_sOSRConfig.e_osr_t, l_sOSRConfig.e_osr_p, l_sOSRConfig.b_press_en) &&
+      (l_sOSRConfig.e_osr_t != ceAPP_BMP581_OSR_1 || l_sOSRConfig.e_osr_p != ceAPP_BMP581_OSR_1)
+    ) {
+      if (l_sOSRConfig.e_osr_p >= l_sOSRConfig.e_osr_t && l_sOSRConfig.e_osr_p != ceAPP_BMP581_OSR_1) {
+        l_sOSRConfig.e_osr_p = (eBMP581OSR_t)((uint32_t)l_sOSRConfig.e_osr_p - 1U);
+      }
+      else {
+        l_sOSRConfig.e_osr_t = (eBMP581OSR_t)((uint32_t)l_sOSRConfig.e_osr_t - 1U);
+      }
+    }
+  }
+
+  p_psDevice->au8_registers[cAPP_BMP581_REG_OSR_EFF] =
+    APP_BMP581_SET(OSR_EFF, OSR_T_EFF, l_sOSRConfig.e_osr_t) |
+    APP_BMP581_SET(OSR_EFF, OSR_P_EFF, l_sOSRConfig.e_osr_p) |
+    APP_BMP581_SET(OSR_EFF, ODR_IS_VALID, l_bValid);
+}
+
+/**
+ * @brief Starts a conversion
+ * 
+ * It lasts the conversion time of the effective oversampling.
+ * 
+ * @param p_psDevice the device
+ * @param p_u64StartUs the start of the conversion
+ * @return
+ */
+static void vSIM_BMP581_schedule(sSIM_BMP581_t* p_psDevice, uint64_t p_u64StartUs) {
+  uint8_t l_u8OSREff = p_psDevice->au8_registers[cAPP_BMP581_REG_OSR_EFF];
+
+  p_psDevice->b_converting = true;
+  p_psDevice->u64_conv_start_us = p_u64StartUs;
+  p_psDevice->u64_conv_end_us = p_u64StartUs + u32APP_BMP581_getConversionTimeUs(
+    (eBMP581OSR_t)APP_BMP581_GET(OSR_EFF, OSR_T_EFF, l_u8OSREff),
+    (eBMP581OSR_t)APP_BMP581_GET(OSR_EFF, OSR_P_EFF, l_u8OSREff),
+    APP_BMP581_GET(OSR_CONFIG, PRESS_EN, p_psDevice->au8_registers[cAPP_BMP581_REG_OSR_CONFIG]) != 0U
+  );
+}
+
+/**
+ * @brief Ends the current conversion and starts the next one
+ * 
+ * The signals are sampled in the middle of the conversion. Forced mode
+ * goes back to standby, normal mode starts the next conversion one ODR
+ * period after this one and continuous mode right away.
+ * 
+ * @param p_psDevice the device
+ * @return
+ */
+static void vSIM_BMP581_convert(sSIM_BMP581_t* p_psDevice) {
+  const uint8_t* l_pu8Registers = p_psDevice->au8_registers;
+  uint8_t l_u8OSREff = l_pu8Registers[cAPP_BMP581_REG_OSR_EFF];
+  uint8_t l_u8DSPConfig = l_pu8Registers[cAPP_BMP581_REG_DSP_CONFIG];
+  uint8_t l_u8DSPIIR = l_pu8Registers[cAPP_BMP581_REG_DSP_IIR];
+  uint32_t l_u32Mode = APP_BMP581_GET(ODR_CONFIG, PWR_MODE, l_pu8Registers[cAPP_BMP581_REG_ODR_CONFIG]);
+  bool l_bPressEn = APP_BMP581_GET(OSR_CONFIG, PRESS_EN, l_pu8Registers[cAPP_BMP581_REG_OSR_CONFIG]) != 0U;
+  uint64_t l_u64MidUs = p_psDevice->u64_conv_start_us + (p_psDevice->u64_conv_end_us - p_psDevice->u64_conv_start_us) / 2U;
+  bool l_bFlush = l_u32Mode == (uint32_t)ceAPP_BMP581_FORCED && APP_BMP581_GET(DSP_CONFIG, IIR_FLUSH_FORCED_EN, l_u8DSPConfig) != 0U;
+  double l_dTemp = dSIM_Signal_at(&p_psDevice->s_temp, l_u64MidUs);
+  double l_dPress = dSIM_Signal_at(&p_psDevice->s_press, l_u64MidUs);
+  int64_t l_s64Raw;
+
+  if (p_psDevice->b_noise) {
+    l_dTemp += (double)s_au32TempNoiseUC[APP_BMP581_GET(OSR_EFF, OSR_T_EFF, l_u8OSREff)] / 1e6 *
+               dSIM_Rand_gaussian(&p_psDevice->s_rand);
+    l_dPress += (double)u32APP_BMP581_getPressNoiseMPa(
+                  (eBMP581OSR_t)APP_BMP581_GET(OSR_EFF, OSR_P_EFF, l_u8OSREff), ceAPP_BMP581_FILTER_BYPASS
+                ) / 1e3 * dSIM_Rand_gaussian(&p_psDevice->s_rand);
+  }
+
+  if (!p_psDevice->b_iir_primed || l_bFlush) {
+    p_psDevice->d_iir_temp = l_dTemp;
+    p_psDevice->d_iir_press = l_dPress;
+    p_psDevice->b_iir_primed = true;
+  }
+  else {
+    p_psDevice->d_iir_temp = dSIM_BMP581_filter(p_psDevice->d_iir_temp, l_dTemp, APP_BMP581_GET(DSP_IIR, SET_IIR_T, l_u8DSPIIR));
+    if (l_bPressEn) {
+      p_psDevice->d_iir_press = dSIM_BMP581_filter(p_psDevice->d_iir_press, l_dPress, APP_BMP581_GET(DSP_IIR, SET_IIR_P, l_u8DSPIIR));
+    }
+  }
+
+  if (APP_BMP581_GET(DSP_CONFIG, SHDW_SEL_IIR_T, l_u8DSPConfig) != 0U) {
+    l_dTemp = p_psDevice->d_iir_temp;
+  }
+  l_s64Raw = llround(l_dTemp * cSIM_BMP581_TEMP_LSB);
+  l_s64Raw = (l_s64Raw < cSIM_BMP581_TEMP_RAW_MIN) ? cSIM_BMP581_TEMP_RAW_MIN : l_s64Raw;
+  l_s64Raw = (l_s64Raw > cSIM_BMP581_TEMP_RAW_MAX) ? cSIM_BMP581_TEMP_RAW_MAX : l_s64Raw;
+  p_psDevice->au8_registers[cAPP_BMP581_REG_TEMP_DATA_XLSB] = (uint8_t)l_s64Raw;
+  p_psDevice->au8_registers[cAPP_BMP581_REG_TEMP_DATA_LSB] = (uint8_t)(l_s64Raw >> 8);
+  p_psDevice->au8_registers[cAPP_BMP581_REG_TEMP_DATA_MSB] = (uint8_t)(l_s64Raw >> 16);
+
+  /* Pressure data keep their last value while press_en is cleared */
+  if (l_bPressEn) {
+    if (APP_BMP581_GET(DSP_CONFIG, SHDW_SEL_IIR_P, l_u8DSPConfig) != 0U) {
+      l_dPress = p_psDevice->d_iir_press;
+    }
+    l_s64Raw = llround(l_dPress * cSIM_BMP581_PRESS_LSB);
+    l_s64Raw = (l_s64Raw < 0) ? 0 : l_s64Raw;
+    l_s64Raw = (l_s64Raw > cSIM_BMP581_PRESS_RAW_MAX) ? cSIM_BMP581_PRESS_RAW_MAX : l_s64Raw;
+    p_psDevice->au8_registers[cAPP_BMP581_REG_PRESS_DATA_XLSB] = (uint8_t)l_s64Raw;
+    p_psDevice->au8_registers[cAPP_BMP581_REG_PRESS_DATA_LSB] = (uint8_t)(l_s64Raw >> 8);
+    p_psDevice->au8_registers[cAPP_BMP581_REG_PRESS_DATA_MSB] = (uint8_t)(l_s64Raw >> 16);
+  }
+
+  p_psDevice->u32_conversions++;
+  p_psDevice->au8_registers[cAPP_BMP581_REG_INT_STATUS] |= APP_BMP581_SET(INT_STATUS, DRDY_DATA_REG, 1);
+
+  if (l_u32Mode == (uint32_t)ceAPP_BMP581_NORMAL) {
+    vSIM_BMP581_schedule(p_psDevice, p_psDevice->u64_conv_start_us + u32APP_BMP581_getODRPeriodUs(
+      (eBMP581ODR_t)APP_BMP581_GET(ODR_CONFIG, ODR, l_pu8Registers[cAPP_BMP581_REG_ODR_CONFIG])
+    ));
+  }
+  else if (l_u32Mode == (uint32_t)ceAPP_BMP581_CONTINUOUS) {
+    vSIM_BMP581_schedule(p_psDevice, p_psDevice->u64_conv_end_us);
+  }
+  else {
+    p_psDevice->b_converting = false;
+    p_psDevice->au8_registers[cAPP_BMP581_REG_ODR_CONFIG] &= (uint8_t)~cAPP_BMP581_ODR_CONFIG_PWR_MODE_MSK;
+  }
+}
+
+/**
+ * @brief One step of the IIR filter of the device
+ * 
+ * y = (c * y + x) / (c + 1), which divides the noise variance by 2c + 1.
+ * 
+ * @param p_dState the previous output
+ * @param p_dSample the new sample
+ * @param p_u32SetIIR the set_iir_t or set_iir_p value
+ * @return the new output
+ */
+static double dSIM_BMP581_filter(double p_dState, double p_dSample, uint32_t p_u32SetIIR) {
+  double l_dCoefficient = (double)s_au32IIRCoefficient[p_u32SetIIR];
+
+  return (l_dCoefficient * p_dState + p_dSample) / (l_dCoefficient + 1.0);
+}
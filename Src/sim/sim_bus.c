@@ -0,0 +1,329 @@
+/**
+  ******************************************************************************
+  * @file           : sim_bus.c
+  * @brief          : Simulated I2C bus of the host simulator, with NACK,
+  * arbitration loss, DMA error, clock stretching, latency and stuck SDA
+  * injection
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <stddef.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+#include "sim/sim_rand.h"
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "sim/sim_bus.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/**
+ * @brief Struct holding the faults drawn for one transfer
+ * 
+ */
+typedef struct {
+  bool b_nack;
+  bool b_arb_lost;
+  bool b_dma_error;
+  uint32_t u32_stretch_us;
+  uint32_t u32_latency_us;
+  bool b_sda_stuck;
+  uint32_t u32_sda_clocks;
+} sSIM_BusDraw_t;
+
+/* Private define ------------------------------------------------------------*/
+#define cSIM_BUS_FRAME_BITS (uint32_t)2 //START and STOP
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static sSIM_Rand_t s_sRand;
+static sSIM_BusFaults_t s_sFaults = {0};
+static sSIM_BusStats_t s_sStats = {0};
+static sSIM_BusDevice_t s_asDevices[cSIM_BUS_DEVICE_MAX];
+static uint32_t s_u32DeviceCount = 0;
+static uint32_t s_u32SDAHeldClocks = 0; //SCL pulses left before the slave releases SDA
+
+/* Private function prototypes -----------------------------------------------*/
+static const sSIM_BusDevice_t* psSIM_Bus_find(uint8_t p_u8Address);
+static void vSIM_Bus_draw(sSIM_BusDraw_t* p_psDraw);
+static eSIM_BusResult_t eSIM_Bus_transfer(uint8_t p_u8Address, uint8_t p_u8Register, bool p_bRead, uint8_t* p_pu8Data, uint16_t p_u16Size, uint32_t p_u32NowUs, uint32_t* p_pu32DurationUs);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Init function for the simulated bus
+ * 
+ * Detaches every device, clears the faults and the counters and seeds the
+ * fault draws. The same seed and the same transfers give the same faults.
+ * 
+ * @param p_u32Seed the seed of the fault draws
+ * @return
+ */
+void vSIM_Bus_init(uint32_t p_u32Seed) {
+  sSIM_BusFaults_t l_sNoFaults = {0};
+  sSIM_BusStats_t l_sNoStats = {0};
+
+  vSIM_Rand_seed(&s_sRand, p_u32Seed);
+  s_sFaults = l_sNoFaults;
+  s_sStats = l_sNoStats;
+  s_u32DeviceCount = 0;
+  s_u32SDAHeldClocks = 0;
+}
+
+/**
+ * @brief Sets the fault rates of the next transfers
+ * 
+ * @param p_psFaults the rates, NULL to disable every fault
+ * @return
+ */
+void vSIM_Bus_setFaults(const sSIM_BusFaults_t* p_psFaults) {
+  sSIM_BusFaults_t l_sNoFaults = {0};
+
+  s_sFaults = (p_psFaults != NULL) ? *p_psFaults : l_sNoFaults;
+}
+
+/**
+ * @brief Attaches a device to the bus
+ * 
+ * @param p_psDevice the device, copied
+ * @return false if the bus is full or the address is taken
+ */
+bool bSIM_Bus_attach(const sSIM_BusDevice_t* p_psDevice) {
+  if (
+    p_psDevice == NULL ||
+    s_u32DeviceCount >= cSIM_BUS_DEVICE_MAX ||
+    psSIM_Bus_find(p_psDevice->u8_address) != NULL
+  ) {
+    return false;
+  }
+
+  s_asDevices[s_u32DeviceCount] = *p_psDevice;
+  s_u32DeviceCount++;
+  return true;
+}
+
+/**
+ * @brief Reads registers of a device
+ * 
+ * The device sees the read at p_u32NowUs, its side effects happen even if
+ * the DMA then fails.
+ * 
+ * @param p_u8Address the 7-bit device address
+ * @param p_u8Register the first register
+ * @param p_pu8Data the bytes read, untouched unless ceSIM_BUS_OK
+ * @param p_u16Size the number of bytes
+ * @param p_u32NowUs the start time of the transfer
+ * @param p_pu32DurationUs the time the bus is held, can be NULL
+ * @return the transfer result
+ */
+eSIM_BusResult_t eSIM_Bus_memRead(uint8_t p_u8Address, uint8_t p_u8Register, uint8_t* p_pu8Data, uint16_t p_u16Size, uint32_t p_u32NowUs, uint32_t* p_pu32DurationUs) {
+  return eSIM_Bus_transfer(p_u8Address, p_u8Register, true, p_pu8Data, p_u16Size, p_u32NowUs, p_pu32DurationUs);
+}
+
+/**
+ * @brief Writes registers of a device
+ * 
+ * @param p_u8Address the 7-bit device address
+ * @param p_u8Register the first register
+ * @param p_pu8Data the bytes to write
+ * @param p_u16Size the number of bytes
+ * @param p_u32NowUs the start time of the transfer
+ * @param p_pu32DurationUs the time the bus is held, can be NULL
+ * @return the transfer result, the device is written only if ceSIM_BUS_OK
+ */
+eSIM_BusResult_t eSIM_Bus_memWrite(uint8_t p_u8Address, uint8_t p_u8Register, const uint8_t* p_pu8Data, uint16_t p_u16Size, uint32_t p_u32NowUs, uint32_t* p_pu32DurationUs) {
+  /* The write path never writes through p_pu8Data */
+  return eSIM_Bus_transfer(p_u8Address, p_u8Register, false, (uint8_t*)p_pu8Data, p_u16Size, p_u32NowUs, p_pu32DurationUs);
+}
+
+/**
+ * @brief Gives a copy of the bus counters
+ * 
+ * @param p_psStats the counters
+ * @return
+ */
+void vSIM_Bus_getStats(sSIM_BusStats_t* p_psStats) {
+  if (p_psStats != NULL) {
+    *p_psStats = s_sStats;
+  }
+}
+
+/**
+ * @brief Tells whether a slave holds SDA low
+ * 
+ * @return true until enough SCL pulses were given
+ */
+bool bSIM_Bus_isSDAHeld(void) {
+  return s_u32SDAHeldClocks != 0;
+}
+
+/**
+ * @brief Gives one SCL pulse to the slaves
+ * 
+ * A slave holding SDA low shifts out one more bit and releases SDA once
+ * the byte it was sending is over.
+ * 
+ * @return
+ */
+void vSIM_Bus_clockSCL(void) {
+  if (s_u32SDAHeldClocks != 0) {
+    s_u32SDAHeldClocks--;
+    s_sStats.u32_sda_clocks++;
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Finds an attached device
+ * 
+ * @param p_u8Address the 7-bit device address
+ * @return the device, NULL if none answers this address
+ */
+static const sSIM_BusDevice_t* psSIM_Bus_find(uint8_t p_u8Address) {
+  uint32_t i;
+
+  for (i = 0; i < s_u32DeviceCount; i++) {
+    if (s_asDevices[i].u8_address == p_u8Address) {
+      return &s_asDevices[i];
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Draws the faults of one transfer
+ * 
+ * Always draws the same number of values, so a fault rate change does
+ * not shift the draws of the following transfers.
+ * 
+ * @param p_psDraw the faults drawn
+ * @return
+ */
+static void vSIM_Bus_draw(sSIM_BusDraw_t* p_psDraw) {
+  bool l_bStretch;
+
+  p_psDraw->b_nack = bSIM_Rand_chance(&s_sRand, s_sFaults.u32_nack_ppm);
+  p_psDraw->b_arb_lost = bSIM_Rand_chance(&s_sRand, s_sFaults.u32_arb_lost_ppm);
+  p_psDraw->b_dma_error = bSIM_Rand_chance(&s_sRand, s_sFaults.u32_dma_error_ppm);
+  l_bStretch = bSIM_Rand_chance(&s_sRand, s_sFaults.u32_stretch_ppm);
+  p_psDraw->u32_stretch_us = u32SIM_Rand_below(&s_sRand, s_sFaults.u32_stretch_max_us + 1);
+  p_psDraw->u32_latency_us = u32SIM_Rand_below(&s_sRand, s_sFaults.u32_latency_max_us + 1);
+  p_psDraw->b_sda_stuck = bSIM_Rand_chance(&s_sRand, s_sFaults.u32_sda_stuck_ppm);
+  p_psDraw->u32_sda_clocks = 1U + u32SIM_Rand_below(&s_sRand, cSIM_BUS_SDA_CLOCKS);
+
+  if (!l_bStretch) {
+    p_psDraw->u32_stretch_us = 0;
+  }
+}
+
+/**
+ * @brief Runs one memory transfer
+ * 
+ * A memory read is the address, the register, a repeated START, the
+ * address again and the data. A write is the address, the register and
+ * the data. NACK and arbitration loss stop the transfer after the first
+ * address byte. While a slave holds SDA low every START loses
+ * arbitration, a stuck SDA fault leaves it so after the transfer.
+ * 
+ * @param p_u8Address the 7-bit device address
+ * @param p_u8Register the first register
+ * @param p_bRead true for a read
+ * @param p_pu8Data the bytes read or written
+ * @param p_u16Size the number of bytes
+ * @param p_u32NowUs the start time of the transfer
+ * @param p_pu32DurationUs the time the bus is held, can be NULL
+ * @return the transfer result
+ */
+static eSIM_BusResult_t eSIM_Bus_transfer(uint8_t p_u8Address, uint8_t p_u8Register, bool p_bRead, uint8_t* p_pu8Data, uint16_t p_u16Size, uint32_t p_u32NowUs, uint32_t* p_pu32DurationUs) {
+  const sSIM_BusDevice_t* l_psDevice = psSIM_Bus_find(p_u8Address);
+  sSIM_BusDraw_t l_sDraw;
+  uint8_t l_au8Scratch[256];
+  uint32_t l_u32Bytes = (p_bRead ? 3U : 2U) + p_u16Size;
+  uint32_t l_u32DurationUs;
+  uint32_t l_u32StartUs;
+  eSIM_BusResult_t l_eResult = ceSIM_BUS_OK;
+  bool l_bAck;
+  uint16_t i;
+
+  vSIM_Bus_draw(&l_sDraw);
+  s_sStats.u32_transfers++;
+  l_u32StartUs = p_u32NowUs + l_sDraw.u32_latency_us;
+
+  if (p_pu8Data == NULL || p_u16Size == 0 || p_u16Size > sizeof(l_au8Scratch)) {
+    l_eResult = ceSIM_BUS_NACK;
+  }
+  else if (l_sDraw.b_arb_lost || s_u32SDAHeldClocks != 0) {
+    l_eResult = ceSIM_BUS_ARB_LOST;
+  }
+  else if (l_sDraw.b_nack || l_psDevice == NULL) {
+    l_eResult = ceSIM_BUS_NACK;
+  }
+  else if (p_bRead) {
+    /* The device answers even if the DMA then drops the bytes */
+    l_bAck = l_psDevice->pf_read(l_psDevice->pv_device, l_u32StartUs, p_u8Register, l_au8Scratch, p_u16Size);
+    if (!l_bAck) {
+      l_eResult = ceSIM_BUS_NACK;
+    }
+    else if (l_sDraw.b_dma_error) {
+      l_eResult = ceSIM_BUS_DMA_ERROR;
+    }
+    else {
+      for (i = 0; i < p_u16Size; i++) {
+        p_pu8Data[i] = l_au8Scratch[i];
+      }
+    }
+  }
+  else if (l_sDraw.b_dma_error) {
+    /* The transmit DMA never fed the data register, the device sees a short write */
+    l_eResult = ceSIM_BUS_DMA_ERROR;
+  }
+  else if (!l_psDevice->pf_write(l_psDevice->pv_device, l_u32StartUs, p_u8Register, p_pu8Data, p_u16Size)) {
+    l_eResult = ceSIM_BUS_NACK;
+  }
+
+  switch (l_eResult) {
+    case ceSIM_BUS_OK:
+      s_sStats.u32_bytes += p_u16Size;
+      break;
+    case ceSIM_BUS_NACK:
+      s_sStats.u32_nacks++;
+      l_u32Bytes = 1;
+      break;
+    case ceSIM_BUS_ARB_LOST:
+      s_sStats.u32_arb_lost++;
+      l_u32Bytes = 1;
+      break;
+    default:
+      s_sStats.u32_dma_errors++;
+      break;
+  }
+
+  if (l_sDraw.u32_stretch_us != 0 && l_eResult != ceSIM_BUS_NACK && l_eResult != ceSIM_BUS_ARB_LOST) {
+    s_sStats.u32_stretches++;
+  }
+  else {
+    l_sDraw.u32_stretch_us = 0;
+  }
+
+  l_u32DurationUs = l_sDraw.u32_latency_us + l_sDraw.u32_stretch_us +
+                    (l_u32Bytes * cSIM_BUS_BYTE_BITS + cSIM_BUS_FRAME_BITS) * cSIM_BUS_BIT_US;
+  s_sStats.u64_busy_us += l_u32DurationUs - l_sDraw.u32_latency_us;
+
+  if (l_sDraw.b_sda_stuck && s_u32SDAHeldClocks == 0) {
+    /* The slave lost count of the clocks and still drives a 0 bit */
+    s_u32SDAHeldClocks = l_sDraw.u32_sda_clocks;
+    s_sStats.u32_sda_stuck++;
+  }
+
+  if (p_pu32DurationUs != NULL) {
+    *p_pu32DurationUs = l_u32DurationUs;
+  }
+
+  return l_eResult;
+}
@@ -0,0 +1,119 @@
+/**
+  ******************************************************************************
+  * @file           : sim_rand.c
+  * @brief          : Seeded pseudo random generator of the host simulator,
+  * the same seed always gives the same run
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <math.h>
+#include <stddef.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "sim/sim_rand.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cSIM_RAND_SEED_MIX (uint32_t)0x9E3779B9 //Spreads small seeds, never gives a 0 state for seed 0
+#define cSIM_RAND_PI       3.14159265358979323846
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Restarts a stream from a seed
+ * 
+ * @param p_psRand the stream
+ * @param p_u32Seed the seed
+ * @return
+ */
+void vSIM_Rand_seed(sSIM_Rand_t* p_psRand, uint32_t p_u32Seed) {
+  if (p_psRand == NULL) {
+    return;
+  }
+
+  p_psRand->u32_state = p_u32Seed ^ cSIM_RAND_SEED_MIX;
+  if (p_psRand->u32_state == 0) {
+    p_psRand->u32_state = cSIM_RAND_SEED_MIX;
+  }
+}
+
+/**
+ * @brief Draws the next 32-bit value
+ * 
+ * xorshift32, period 2^32 - 1, plenty for fault draws.
+ * 
+ * @param p_psRand the stream
+ * @return the value
+ */
+uint32_t u32SIM_Rand_next(sSIM_Rand_t* p_psRand) {
+  uint32_t l_u32X = p_psRand->u32_state;
+
+  l_u32X ^= l_u32X << 13;
+  l_u32X ^= l_u32X >> 17;
+  l_u32X ^= l_u32X << 5;
+  p_psRand->u32_state = l_u32X;
+
+  return l_u32X;
+}
+
+/**
+ * @brief Draws a value in [0, p_u32Max[
+ * 
+ * @param p_psRand the stream
+ * @param p_u32Max the exclusive upper bound
+ * @return the value, 0 if p_u32Max is 0
+ */
+uint32_t u32SIM_Rand_below(sSIM_Rand_t* p_psRand, uint32_t p_u32Max) {
+  uint32_t l_u32X = u32SIM_Rand_next(p_psRand);
+
+  if (p_u32Max == 0) {
+    return 0;
+  }
+
+  /* Multiply-shift instead of modulo, no bias towards small values */
+  return (uint32_t)(((uint64_t)l_u32X * p_u32Max) >> 32);
+}
+
+/**
+ * @brief Draws an event of a given rate
+ * 
+ * Always draws one value, so the sequence does not depend on the rate.
+ * 
+ * @param p_psRand the stream
+ * @param p_u32RatePpm the probability in parts per million
+ * @return true if the event happens
+ */
+bool bSIM_Rand_chance(sSIM_Rand_t* p_psRand, uint32_t p_u32RatePpm) {
+  return u32SIM_Rand_below(p_psRand, cSIM_RAND_PPM) < p_u32RatePpm;
+}
+
+/**
+ * @brief Draws a value of the standard normal distribution
+ * 
+ * Box-Muller on two draws, the second value of the pair is dropped so
+ * each call takes exactly two draws.
+ * 
+ * @param p_psRand the stream
+ * @return the value, mean 0 and standard deviation 1
+ */
+double dSIM_Rand_gaussian(sSIM_Rand_t* p_psRand) {
+  /* ]0, 1] keeps the logarithm finite */
+  double l_dU1 = ((double)u32SIM_Rand_next(p_psRand) + 1.0) / 4294967296.0;
+  double l_dU2 = (double)u32SIM_Rand_next(p_psRand) / 4294967296.0;
+
+  return sqrt(-2.0 * log(l_dU1)) * cos(2.0 * cSIM_RAND_PI * l_dU2);
+}
+
+/* Private functions ---------------------------------------------------------*/
@@ -0,0 +1,194 @@
+/**
+  ******************************************************************************
+  * @file           : sim_signal.c
+  * @brief          : Physical quantities seen by the simulated sensors:
+  * constants, ramps, sinusoids and recorded traces
+  * @author         : Julien Cruvieux
+  * @date           : 2024/11/05
+  ******************************************************************************
+  */
+
+/* General interfaces --------------------------------------------------------*/
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Used interfaces (dependencies includes) -----------------------------------*/
+
+/* Associated interfaces -----------------------------------------------------*/
+#include "sim/sim_signal.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define cSIM_SIGNAL_PI      3.14159265358979323846
+#define cSIM_SIGNAL_LINE_NB 128 //Longest trace line
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static double dSIM_Signal_trace(const sSIM_Signal_t* p_psSignal, uint64_t p_u64TimeUs);
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief Makes a signal constant
+ *
+ * @param p_psSignal the signal
+ * @param p_dValue the value
+ * @return
+ */
+void vSIM_Signal_constant(sSIM_Signal_t* p_psSignal, double p_dValue) {
+  if (p_psSignal == NULL) {
+    return;
+  }
+
+  p_psSignal->d_offset = p_dValue;
+  p_psSignal->d_slope_per_s = 0.0;
+  p_psSignal->u32_ramp_s = 0;
+  p_psSignal->d_amplitude = 0.0;
+  p_psSignal->d_period_s = 0.0;
+  p_psSignal->d_phase_deg = 0.0;
+  p_psSignal->ps_trace = NULL;
+  p_psSignal->u32_trace_nb = 0;
+  p_psSignal->b_trace_loop = false;
+}
+
+/**
+ * @brief Evaluates a signal
+ *
+ * @param p_psSignal the signal
+ * @param p_u64TimeUs the time since the start of the simulation
+ * @return the value, 0 for a NULL signal
+ */
+double dSIM_Signal_at(const sSIM_Signal_t* p_psSignal, uint64_t p_u64TimeUs) {
+  double l_dTimeS = (double)p_u64TimeUs / 1e6;
+  double l_dValue;
+
+  if (p_psSignal == NULL) {
+    return 0.0;
+  }
+
+  l_dValue = p_psSignal->d_offset;
+
+  if (p_psSignal->u32_ramp_s != 0 && l_dTimeS > (double)p_psSignal->u32_ramp_s) {
+    l_dValue += p_psSignal->d_slope_per_s * (double)p_psSignal->u32_ramp_s;
+  }
+  else {
+    l_dValue += p_psSignal->d_slope_per_s * l_dTimeS;
+  }
+
+  if (p_psSignal->d_amplitude != 0.0 && p_psSignal->d_period_s > 0.0) {
+    l_dValue += p_psSignal->d_amplitude * sin(
+      2.0 * cSIM_SIGNAL_PI * l_dTimeS / p_psSignal->d_period_s + p_psSignal->d_phase_deg * cSIM_SIGNAL_PI / 180.0
+    );
+  }
+
+  if (p_psSignal->ps_trace != NULL && p_psSignal->u32_trace_nb != 0) {
+    l_dValue += dSIM_Signal_trace(p_psSignal, p_u64TimeUs);
+  }
+
+  return l_dValue;
+}
+
+/**
+ * @brief Reads a recorded trace from a text file
+ *
+ * One point per line, the time in seconds then the value, separated by
+ * blanks or a comma. Empty lines and lines starting with # are skipped,
+ * so are points not later than the previous one.
+ *
+ * @param p_pcPath the file
+ * @param p_psPoints the points read
+ * @param p_u32PointMax the capacity of p_psPoints
+ * @return the number of points read, 0 if the file cannot be opened
+ */
+uint32_t u32SIM_Signal_loadTrace(const char* p_pcPath, sSIM_SignalPoint_t* p_psPoints, uint32_t p_u32PointMax) {
+  char l_acLine[cSIM_SIGNAL_LINE_NB];
+  uint32_t l_u32Count = 0;
+  char* l_pcEnd;
+  double l_dTimeS;
+  double l_dValue;
+  FILE* l_pFile;
+
+  if (p_pcPath == NULL || p_psPoints == NULL) {
+    return 0;
+  }
+
+  l_pFile = fopen(p_pcPath, "r");
+  if (l_pFile == NULL) {
+    return 0;
+  }
+
+  while (l_u32Count < p_u32PointMax && fgets(l_acLine, sizeof(l_acLine), l_pFile) != NULL) {
+    if (l_acLine[0] == '#') {
+      continue;
+    }
+
+    l_dTimeS = strtod(l_acLine, &l_pcEnd);
+    if (l_pcEnd == l_acLine || l_dTimeS < 0.0) {
+      continue;
+    }
+    while (*l_pcEnd == ' ' || *l_pcEnd == '\t' || *l_pcEnd == ',') {
+      l_pcEnd++;
+    }
+    l_dValue = strtod(l_pcEnd, &l_pcEnd);
+
+    p_psPoints[l_u32Count].u64_time_us = (uint64_t)llround(l_dTimeS * 1e6);
+    p_psPoints[l_u32Count].d_value = l_dValue;
+    if (l_u32Count == 0 || p_psPoints[l_u32Count].u64_time_us > p_psPoints[l_u32Count - 1].u64_time_us) {
+      l_u32Count++;
+    }
+  }
+
+  fclose(l_pFile);
+  return l_u32Count;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Interpolates the trace of a signal
+ *
+ * @param p_psSignal the signal, with a trace
+ * @param p_u64TimeUs the time
+ * @return the trace value
+ */
+static double dSIM_Signal_trace(const sSIM_Signal_t* p_psSignal, uint64_t p_u64TimeUs) {
+  const sSIM_SignalPoint_t* l_psTrace = p_psSignal->ps_trace;
+  const uint32_t l_u32Last = p_psSignal->u32_trace_nb - 1U;
+  const uint64_t l_u64FirstUs = l_psTrace[0].u64_time_us;
+  const uint64_t l_u64SpanUs = l_psTrace[l_u32Last].u64_time_us - l_u64FirstUs;
+  uint32_t l_u32Low = 0;
+  uint32_t l_u32High = l_u32Last;
+  uint32_t l_u32Mid;
+  double l_dRatio;
+
+  if (p_psSignal->b_trace_loop && l_u64SpanUs != 0 && p_u64TimeUs > l_u64FirstUs) {
+    p_u64TimeUs = l_u64FirstUs + (p_u64TimeUs - l_u64FirstUs) % l_u64SpanUs;
+  }
+  if (p_u64TimeUs <= l_u64FirstUs) {
+    return l_psTrace[0].d_value;
+  }
+  if (p_u64TimeUs >= l_psTrace[l_u32Last].u64_time_us) {
+    return l_psTrace[l_u32Last].d_value;
+  }
+
+  /* Last point not after the time, the times are increasing */
+  while (l_u32High - l_u32Low > 1U) {
+    l_u32Mid = l_u32Low + (l_u32High - l_u32Low) / 2U;
+    if (l_psTrace[l_u32Mid].u64_time_us <= p_u64TimeUs) {
+      l_u32Low = l_u32Mid;
+    }
+    else {
+      l_u32High = l_u32Mid;
+    }
+  }
+
+  l_dRatio = (double)(p_u64TimeUs - l_psTrace[l_u32Low].u64_time_us) /
+             (double)(l_psTrace[l_u32High].u64_time_us - l_psTrace[l_u32Low].u64_time_us);
+  return l_psTrace[l_u32Low].d_value + l_dRatio * (l_psTrace[l_u32High].d_value - l_psTrace[l_u32Low].d_value);
+}
@@ -0,0 +1,100 @@
+# Flash and RAM of the firmware for each feature combination.
+#
+# Run from the source directory, the ARM toolchain must be in the path:
+#   cmake -P cmake/footprint.cmake
+#   cmake -DBMP581_FOOTPRINT_BUILD_TYPE=MinSizeRel -P cmake/footprint.cmake
+#
+# Each combination is configured and built in build/footprint/<name>. The
+# table is printed and written to build/footprint/footprint.csv. Flash is
+# text plus data, RAM is data plus bss.
+
+cmake_minimum_required(VERSION 3.22)
+
+if(NOT DEFINED BMP581_FOOTPRINT_BUILD_TYPE)
+    set(BMP581_FOOTPRINT_BUILD_TYPE Release)
+endif()
+
+set(l_source_dir ${CMAKE_CURRENT_LIST_DIR}/..)
+set(l_binary_root ${l_source_dir}/build/footprint)
+set(l_features SPI MDMA FIFO OOR NVM)
+
+# Combination name and the features it turns off
+set(l_combinations
+    "full:"
+    "no-spi:SPI"
+    "no-mdma:MDMA"
+    "no-fifo:FIFO"
+    "no-oor-nvm:OOR,NVM"
+    "i2c-polling:SPI,MDMA,FIFO,OOR,NVM"
+)
+
+find_program(l_size arm-none-eabi-size REQUIRED)
+
+set(l_csv "combination,text,data,bss,flash,ram\n")
+set(l_table "")
+
+foreach(l_combination ${l_combinations})
+    string(REPLACE ":" ";" l_parts "${l_combination}")
+    list(GET l_parts 0 l_name)
+    list(LENGTH l_parts l_part_count)
+    set(l_off "")
+    if(l_part_count GREATER 1)
+        list(GET l_parts 1 l_off)
+        string(REPLACE "," ";" l_off "${l_off}")
+    endif()
+
+    set(l_options "")
+    foreach(l_feature ${l_features})
+        if(l_feature IN_LIST l_off)
+            list(APPEND l_options -DBMP581_FEATURE_${l_feature}=OFF)
+        else()
+            list(APPEND l_options -DBMP581_FEATURE_${l_feature}=ON)
+        endif()
+    endforeach()
+
+    set(l_binary_dir ${l_binary_root}/${l_name})
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -S ${l_source_dir} -B ${l_binary_dir} -G Ninja
+            -DCMAKE_TOOLCHAIN_FILE=${l_source_dir}/cmake/gcc-arm-none-eabi.cmake
+            -DCMAKE_BUILD_TYPE=${BMP581_FOOTPRINT_BUILD_TYPE}
+            ${l_options}
+        OUTPUT_QUIET
+        RESULT_VARIABLE l_result
+    )
+    if(NOT l_result EQUAL 0)
+        message(FATAL_ERROR "${l_name}: configuration failed")
+    endif()
+
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} --build ${l_binary_dir}
+        OUTPUT_QUIET
+        RESULT_VARIABLE l_result
+    )
+    if(NOT l_result EQUAL 0)
+        message(FATAL_ERROR "${l_name}: build failed")
+    endif()
+
+    # Berkeley format, the second line holds text, data, bss
+    execute_process(
+        COMMAND ${l_size} ${l_binary_dir}/BMP581_SPI_I2C.elf
+        OUTPUT_VARIABLE l_size_output
+        RESULT_VARIABLE l_result
+    )
+    if(NOT l_result EQUAL 0)
+        message(FATAL_ERROR "${l_name}: size failed")
+    endif()
+    string(REPLACE "\n" ";" l_lines "${l_size_output}")
+    list(GET l_lines 1 l_line)
+    string(REGEX MATCHALL "[0-9]+" l_values "${l_line}")
+    list(GET l_values 0 l_text)
+    list(GET l_values 1 l_data)
+    list(GET l_values 2 l_bss)
+    math(EXPR l_flash "${l_text} + ${l_data}")
+    math(EXPR l_ram "${l_data} + ${l_bss}")
+
+    string(APPEND l_csv "${l_name},${l_text},${l_data},${l_bss},${l_flash},${l_ram}\n")
+    string(APPEND l_table "${l_name}\tflash ${l_flash}\tram ${l_ram}\n")
+endforeach()
+
+file(WRITE ${l_binary_root}/footprint.csv "${l_csv}")
+message("${BMP581_FOOTPRINT_BUILD_TYPE} footprint per feature combination:\n${l_table}")
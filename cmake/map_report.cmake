@@ -0,0 +1,303 @@
+# Flash and RAM of each module and each memory region, from the link map.
+#
+# Run by the bmp581_map_report target after the link, or by hand:
+#   cmake -DBMP581_MAP=build/Release/BMP581_SPI_I2C.map -P cmake/map_report.cmake
+#
+# BMP581_MAP      the map written by the link (-Wl,-Map)
+# BMP581_MAP_CSV  the summary to write, <map>.csv by default
+# BMP581_MAP_BUDGETS
+#                 comma separated budgets in bytes, checked after the report:
+#                 REGION=bytes for the bytes used in a region, and
+#                 name:REGION=bytes for a group or a module in a region,
+#                 e.g. "RAM=65536,DTCMRAM=0,app:RAM=16384,hal_drivers:FLASH=49152"
+#
+# Regions are the MEMORY entries of the linker script: FLASH, DTCMRAM,
+# ITCMRAM, RAM (AXI SRAM), RAM_D2 and RAM_D3. A module is an object file, or
+# a library for archive members. Modules fall into the groups app (app_*),
+# hal (hal_*), hal_drivers (STM32H7xx_HAL_Driver), system (startup, system
+# and interrupt files, heap and stack), libraries and other (padding,
+# linker stubs). Initialised data counts in its RAM region and again in
+# FLASH for its load image. With BMP581_LTO the objects are merged, so only
+# the region totals stay meaningful.
+#
+# The summary has one "kind,name,region,bytes,limit" line per region, group
+# and module, limit being the region length or the budget when one is set.
+
+cmake_minimum_required(VERSION 3.22)
+
+if(NOT DEFINED BMP581_MAP OR NOT EXISTS ${BMP581_MAP})
+    message(FATAL_ERROR "BMP581_MAP must name an existing link map")
+endif()
+if(NOT DEFINED BMP581_MAP_CSV)
+    set(BMP581_MAP_CSV ${BMP581_MAP}.csv)
+endif()
+
+set(l_groups app hal hal_drivers system libraries other)
+
+# Brackets and semicolons would break the CMake list of lines
+file(READ ${BMP581_MAP} l_map)
+string(REGEX REPLACE "[][;]" "_" l_map "${l_map}")
+string(REPLACE "\n" ";" l_lines "${l_map}")
+
+set(l_regions "")
+set(l_modules "")
+set(l_step none)
+set(l_pending none)
+
+# Adds bytes to a module, its group and a region
+macro(m_map_add p_module p_group p_region p_bytes)
+    if(NOT "${p_module}" IN_LIST l_modules)
+        list(APPEND l_modules ${p_module})
+        set(l_group_of_${p_module} ${p_group})
+    endif()
+    math(EXPR l_used_${p_region} "${l_used_${p_region}} + ${p_bytes}")
+    foreach(l_key ${p_group}_${p_region} ${p_module}_${p_region})
+        if(NOT DEFINED l_bytes_${l_key})
+            set(l_bytes_${l_key} 0)
+        endif()
+        math(EXPR l_bytes_${l_key} "${l_bytes_${l_key}} + ${p_bytes}")
+    endforeach()
+endmacro()
+
+# Gives the region holding an address, empty if none
+macro(m_map_region p_address p_result)
+    set(${p_result} "")
+    foreach(l_candidate ${l_regions})
+        math(EXPR l_end "${l_origin_${l_candidate}} + ${l_length_${l_candidate}}")
+        if(${p_address} GREATER_EQUAL ${l_origin_${l_candidate}} AND ${p_address} LESS ${l_end})
+            set(${p_result} ${l_candidate})
+            break()
+        endif()
+    endforeach()
+endmacro()
+
+# Accounts an input section, or padding when p_file is empty
+macro(m_map_input p_name p_address p_size p_file)
+    math(EXPR l_address "${p_address}")
+    math(EXPR l_size "${p_size}")
+    m_map_region(${l_address} l_region)
+    if(l_size GREATER 0 AND NOT l_region STREQUAL "" AND NOT l_skip)
+        if("${p_file}" STREQUAL "")
+            if(l_output MATCHES "heap_stack")
+                set(l_module heap_stack)
+                set(l_group system)
+            else()
+                set(l_module padding)
+                set(l_group other)
+            endif()
+        else()
+            set(l_path "${p_file}")
+            if(l_path MATCHES "^(.*\\.a)\\(")
+                get_filename_component(l_module "${CMAKE_MATCH_1}" NAME)
+                set(l_group libraries)
+            else()
+                get_filename_component(l_module "${l_path}" NAME)
+                string(REGEX REPLACE "\\.(c|cpp|s|S)\\.obj$|\\.o$" "" l_module "${l_module}")
+                if(l_path MATCHES "STM32H7xx_HAL_Driver")
+                    set(l_group hal_drivers)
+                elseif(l_module MATCHES "^app_")
+                    set(l_group app)
+                elseif(l_module MATCHES "^hal_")
+                    set(l_group hal)
+                elseif(l_module MATCHES "^(startup_|system_|stm32h7xx_it|stm32h7xx_hal_msp|syscalls|sysmem)")
+                    set(l_group system)
+                else()
+                    set(l_group other)
+                endif()
+            endif()
+        endif()
+        string(REGEX REPLACE "[^A-Za-z0-9_.+-]" "_" l_module "${l_module}")
+
+        m_map_add(${l_module} ${l_group} ${l_region} ${l_size})
+        # The load image of initialised data, zeroed sections have none
+        if(NOT l_load_region STREQUAL "" AND NOT "${p_name}" MATCHES "^(\\.bss|COMMON|\\.noinit|\\.tbss)" AND NOT l_output MATCHES "^(\\.bss|\\._user_heap_stack)")
+            m_map_add(${l_module} ${l_group} ${l_load_region} ${l_size})
+        endif()
+    endif()
+endmacro()
+
+# Enters an output section
+macro(m_map_output p_name p_address p_rest)
+    set(l_output "${p_name}")
+    set(l_load_region "")
+    set(l_skip FALSE)
+    if(l_output MATCHES "^\\.(debug|comment|stab|ARM\\.attributes)")
+        set(l_skip TRUE)
+    endif()
+    if("${p_rest}" MATCHES "load address (0x[0-9a-fA-F]+)")
+        math(EXPR l_lma "${CMAKE_MATCH_1}")
+        math(EXPR l_vma "${p_address}")
+        if(NOT l_lma EQUAL l_vma)
+            m_map_region(${l_lma} l_load_region)
+        endif()
+    endif()
+endmacro()
+
+foreach(l_line IN LISTS l_lines)
+    if(l_line MATCHES "^Memory Configuration")
+        set(l_step memory)
+    elseif(l_line MATCHES "^Linker script and memory map")
+        set(l_step map)
+        set(l_output "")
+        set(l_load_region "")
+        set(l_skip TRUE)
+    elseif(l_step STREQUAL memory)
+        if(l_line MATCHES "^([A-Za-z_][A-Za-z0-9_]*) +(0x[0-9a-fA-F]+) +(0x[0-9a-fA-F]+)")
+            list(APPEND l_regions ${CMAKE_MATCH_1})
+            math(EXPR l_origin_${CMAKE_MATCH_1} "${CMAKE_MATCH_2}")
+            math(EXPR l_length_${CMAKE_MATCH_1} "${CMAKE_MATCH_3}")
+            set(l_used_${CMAKE_MATCH_1} 0)
+        endif()
+    elseif(l_step STREQUAL map)
+        # Non allocated sections follow the output file
+        if(l_line MATCHES "^OUTPUT\\(")
+            break()
+        endif()
+
+        # Long section names put the address and size on the next line
+        if(l_pending STREQUAL output AND l_line MATCHES "^ +(0x[0-9a-fA-F]+) +(0x[0-9a-fA-F]+)(.*)$")
+            m_map_output("${l_pending_name}" ${CMAKE_MATCH_1} "${CMAKE_MATCH_3}")
+        elseif(l_pending STREQUAL input AND l_line MATCHES "^ +(0x[0-9a-fA-F]+) +(0x[0-9a-fA-F]+) +([^ ].*)$")
+            m_map_input("${l_pending_name}" ${CMAKE_MATCH_1} ${CMAKE_MATCH_2} "${CMAKE_MATCH_3}")
+        elseif(l_line MATCHES "^([._A-Za-z][^ ]*) +(0x[0-9a-fA-F]+) +(0x[0-9a-fA-F]+)(.*)$")
+            m_map_output("${CMAKE_MATCH_1}" ${CMAKE_MATCH_2} "${CMAKE_MATCH_4}")
+        elseif(l_line MATCHES "^ ([._A-Za-z][^ ]*) +(0x[0-9a-fA-F]+) +(0x[0-9a-fA-F]+) +([^ ].*)$")
+            m_map_input("${CMAKE_MATCH_1}" ${CMAKE_MATCH_2} ${CMAKE_MATCH_3} "${CMAKE_MATCH_4}")
+        elseif(l_line MATCHES "^ \\*fill\\* +(0x[0-9a-fA-F]+) +(0x[0-9a-fA-F]+)")
+            m_map_input("*fill*" ${CMAKE_MATCH_1} ${CMAKE_MATCH_2} "")
+        endif()
+
+        if(l_line MATCHES "^([._A-Za-z][^ ]*)$")
+            set(l_pending output)
+            set(l_pending_name "${CMAKE_MATCH_1}")
+            m_map_output("${l_pending_name}" 0 "")
+        elseif(l_line MATCHES "^ ([._A-Za-z][^ ]*)$")
+            set(l_pending input)
+            set(l_pending_name "${CMAKE_MATCH_1}")
+        else()
+            set(l_pending none)
+        endif()
+    endif()
+endforeach()
+
+if(l_regions STREQUAL "")
+    message(FATAL_ERROR "${BMP581_MAP}: no memory configuration found")
+endif()
+
+# Budgets, keyed like the summary lines: <region> or <name>_<region>
+set(l_budget_keys "")
+if(DEFINED BMP581_MAP_BUDGETS AND NOT BMP581_MAP_BUDGETS STREQUAL "")
+    string(REPLACE "," ";" l_budgets "${BMP581_MAP_BUDGETS}")
+    foreach(l_budget ${l_budgets})
+        if(l_budget MATCHES "^([A-Za-z0-9_.+-]+):([A-Za-z0-9_]+)=([0-9]+)$")
+            set(l_key ${CMAKE_MATCH_1}_${CMAKE_MATCH_2})
+            set(l_budget_${l_key} ${CMAKE_MATCH_3})
+        elseif(l_budget MATCHES "^([A-Za-z0-9_]+)=([0-9]+)$")
+            set(l_key ${CMAKE_MATCH_1})
+            set(l_budget_${l_key} ${CMAKE_MATCH_2})
+        else()
+            message(FATAL_ERROR "Bad budget \"${l_budget}\", expected REGION=bytes or name:REGION=bytes")
+        endif()
+        list(APPEND l_budget_keys ${l_key})
+    endforeach()
+endif()
+
+set(l_csv "kind,name,region,bytes,limit\n")
+set(l_exceeded "")
+
+# Regions
+set(l_report "Region        used      size  use\n")
+foreach(l_region ${l_regions})
+    set(l_limit ${l_length_${l_region}})
+    if(DEFINED l_budget_${l_region})
+        set(l_limit ${l_budget_${l_region}})
+    endif()
+    string(APPEND l_csv "region,${l_region},${l_region},${l_used_${l_region}},${l_limit}\n")
+
+    math(EXPR l_permille "${l_used_${l_region}} * 1000 / ${l_length_${l_region}}")
+    math(EXPR l_percent "${l_permille} / 10")
+    math(EXPR l_tenth "${l_permille} % 10")
+    string(APPEND l_report "${l_region}\t${l_used_${l_region}}\t${l_length_${l_region}}\t${l_percent}.${l_tenth}%\n")
+endforeach()
+
+# Groups, one column per region
+string(APPEND l_report "\nGroup")
+foreach(l_region ${l_regions})
+    string(APPEND l_report "\t${l_region}")
+endforeach()
+string(APPEND l_report "\n")
+foreach(l_group ${l_groups})
+    string(APPEND l_report "${l_group}")
+    foreach(l_region ${l_regions})
+        set(l_bytes 0)
+        if(DEFINED l_bytes_${l_group}_${l_region})
+            set(l_bytes ${l_bytes_${l_group}_${l_region}})
+            set(l_limit "")
+            if(DEFINED l_budget_${l_group}_${l_region})
+                set(l_limit ${l_budget_${l_group}_${l_region}})
+            endif()
+            string(APPEND l_csv "group,${l_group},${l_region},${l_bytes},${l_limit}\n")
+        endif()
+        string(APPEND l_report "\t${l_bytes}")
+    endforeach()
+    string(APPEND l_report "\n")
+endforeach()
+
+# Modules, largest first
+set(l_sorted "")
+foreach(l_module ${l_modules})
+    set(l_total 0)
+    foreach(l_region ${l_regions})
+        if(DEFINED l_bytes_${l_module}_${l_region})
+            math(EXPR l_total "${l_total} + ${l_bytes_${l_module}_${l_region}}")
+            set(l_limit "")
+            if(DEFINED l_budget_${l_module}_${l_region})
+                set(l_limit ${l_budget_${l_module}_${l_region}})
+            endif()
+            string(APPEND l_csv "module,${l_module},${l_region},${l_bytes_${l_module}_${l_region}},${l_limit}\n")
+        endif()
+    endforeach()
+    string(LENGTH "${l_total}" l_digits)
+    math(EXPR l_pad_count "12 - ${l_digits}")
+    string(REPEAT "0" ${l_pad_count} l_padding)
+    list(APPEND l_sorted "${l_padding}${l_total}:${l_module}")
+endforeach()
+list(SORT l_sorted ORDER DESCENDING)
+
+string(APPEND l_report "\nModule\tgroup")
+foreach(l_region ${l_regions})
+    string(APPEND l_report "\t${l_region}")
+endforeach()
+string(APPEND l_report "\n")
+foreach(l_entry ${l_sorted})
+    string(REGEX REPLACE "^[0-9]+:" "" l_module "${l_entry}")
+    string(APPEND l_report "${l_module}\t${l_group_of_${l_module}}")
+    foreach(l_region ${l_regions})
+        set(l_bytes 0)
+        if(DEFINED l_bytes_${l_module}_${l_region})
+            set(l_bytes ${l_bytes_${l_module}_${l_region}})
+        endif()
+        string(APPEND l_report "\t${l_bytes}")
+    endforeach()
+    string(APPEND l_report "\n")
+endforeach()
+
+file(WRITE ${BMP581_MAP_CSV} "${l_csv}")
+message("${l_report}\nSummary written to ${BMP581_MAP_CSV}")
+
+# Budgets are checked last so the report is there to explain a failure
+foreach(l_key ${l_budget_keys})
+    if(DEFINED l_used_${l_key})
+        set(l_bytes ${l_used_${l_key}})
+    elseif(DEFINED l_bytes_${l_key})
+        set(l_bytes ${l_bytes_${l_key}})
+    else()
+        set(l_bytes 0)
+    endif()
+    if(l_bytes GREATER l_budget_${l_key})
+        string(APPEND l_exceeded "  ${l_key}: ${l_bytes} bytes, budget ${l_budget_${l_key}}\n")
+    endif()
+endforeach()
+if(NOT l_exceeded STREQUAL "")
+    message(FATAL_ERROR "Budgets exceeded:\n${l_exceeded}")
+endif()
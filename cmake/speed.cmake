@@ -0,0 +1,158 @@
+# Speed of the decode, solver and queue suites for each optimisation level.
+#
+# Run from the source directory:
+#   cmake -P cmake/speed.cmake
+#   cmake -DBMP581_SPEED_ITERATIONS=20000 -P cmake/speed.cmake
+#
+# Each level is configured and built on the host in build/speed/host-<name>
+# and bmp581_suites is run there. When the ARM toolchain is in the path the
+# firmware is built too in build/speed/target-<name> and its flash and RAM
+# are reported, so speed can be weighed against size. The table is printed
+# and written to build/speed/speed.csv.
+#
+# Target cycle counts need a board: configure a firmware preset with
+# -DBMP581_BENCH_SUITES=ON, run it and read s_asResults (app_bench.c) with
+# the debugger once main has started the event loop.
+
+cmake_minimum_required(VERSION 3.22)
+
+if(NOT DEFINED BMP581_SPEED_ITERATIONS)
+    set(BMP581_SPEED_ITERATIONS 100000)
+endif()
+
+set(l_source_dir ${CMAKE_CURRENT_LIST_DIR}/..)
+set(l_binary_root ${l_source_dir}/build/speed)
+set(l_suites decode solver queue)
+
+# Level name, optimisation level and link time optimisation
+set(l_levels
+    "Os:Os:OFF"
+    "O2:O2:OFF"
+    "O3:O3:OFF"
+    "O2-lto:O2:ON"
+    "O3-lto:O3:ON"
+)
+
+find_program(l_size arm-none-eabi-size)
+
+set(l_csv "level")
+set(l_header "level")
+foreach(l_suite ${l_suites})
+    string(APPEND l_csv ",${l_suite}_ns,${l_suite}_cycles")
+    string(APPEND l_header "\t${l_suite} ns")
+endforeach()
+string(APPEND l_csv ",flash,ram\n")
+string(APPEND l_header "\tflash\tram\n")
+set(l_table "${l_header}")
+set(l_reference_checksums "")
+
+foreach(l_level ${l_levels})
+    string(REPLACE ":" ";" l_parts "${l_level}")
+    list(GET l_parts 0 l_name)
+    list(GET l_parts 1 l_optimization)
+    list(GET l_parts 2 l_lto)
+    set(l_options -DCMAKE_BUILD_TYPE=Release -DBMP581_OPTIMIZATION=${l_optimization} -DBMP581_LTO=${l_lto})
+
+    set(l_binary_dir ${l_binary_root}/host-${l_name})
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} -S ${l_source_dir} -B ${l_binary_dir} -DBMP581_HOST=ON ${l_options}
+        OUTPUT_QUIET
+        RESULT_VARIABLE l_result
+    )
+    if(NOT l_result EQUAL 0)
+        message(FATAL_ERROR "${l_name}: host configuration failed")
+    endif()
+
+    execute_process(
+        COMMAND ${CMAKE_COMMAND} --build ${l_binary_dir} --target bmp581_suites
+        OUTPUT_QUIET
+        RESULT_VARIABLE l_result
+    )
+    if(NOT l_result EQUAL 0)
+        message(FATAL_ERROR "${l_name}: host build failed")
+    endif()
+
+    # One "suite,ns,cycles,checksum" line per suite
+    execute_process(
+        COMMAND ${l_binary_dir}/cmake/host/bmp581_suites --iterations ${BMP581_SPEED_ITERATIONS} --csv
+        OUTPUT_VARIABLE l_suites_output
+        RESULT_VARIABLE l_result
+    )
+    if(NOT l_result EQUAL 0)
+        message(FATAL_ERROR "${l_name}: bmp581_suites failed")
+    endif()
+    string(REPLACE "\n" ";" l_lines "${l_suites_output}")
+
+    set(l_csv_line "${l_name}")
+    set(l_table_line "${l_name}")
+    set(l_checksums "")
+    foreach(l_line ${l_lines})
+        string(REPLACE "," ";" l_values "${l_line}")
+        list(GET l_values 1 l_ns)
+        list(GET l_values 2 l_cycles)
+        list(GET l_values 3 l_checksum)
+        list(APPEND l_checksums ${l_checksum})
+        string(APPEND l_csv_line ",${l_ns},${l_cycles}")
+        string(APPEND l_table_line "\t${l_ns}")
+    endforeach()
+
+    # Every level must compute the same results
+    if(l_reference_checksums STREQUAL "")
+        set(l_reference_checksums "${l_checksums}")
+    elseif(NOT l_checksums STREQUAL l_reference_checksums)
+        message(FATAL_ERROR "${l_name}: checksums ${l_checksums} differ from ${l_reference_checksums}")
+    endif()
+
+    set(l_flash "")
+    set(l_ram "")
+    if(l_size)
+        set(l_binary_dir ${l_binary_root}/target-${l_name})
+        execute_process(
+            COMMAND ${CMAKE_COMMAND} -S ${l_source_dir} -B ${l_binary_dir} -G Ninja
+                -DCMAKE_TOOLCHAIN_FILE=${l_source_dir}/cmake/gcc-arm-none-eabi.cmake
+                ${l_options}
+            OUTPUT_QUIET
+            RESULT_VARIABLE l_result
+        )
+        if(NOT l_result EQUAL 0)
+            message(FATAL_ERROR "${l_name}: target configuration failed")
+        endif()
+
+        execute_process(
+            COMMAND ${CMAKE_COMMAND} --build ${l_binary_dir}
+            OUTPUT_QUIET
+            RESULT_VARIABLE l_result
+        )
+        if(NOT l_result EQUAL 0)
+            message(FATAL_ERROR "${l_name}: target build failed")
+        endif()
+
+        # Berkeley format, the second line holds text, data, bss
+        execute_process(
+            COMMAND ${l_size} ${l_binary_dir}/BMP581_SPI_I2C.elf
+            OUTPUT_VARIABLE l_size_output
+            RESULT_VARIABLE l_result
+        )
+        if(NOT l_result EQUAL 0)
+            message(FATAL_ERROR "${l_name}: size failed")
+        endif()
+        string(REPLACE "\n" ";" l_size_lines "${l_size_output}")
+        list(GET l_size_lines 1 l_size_line)
+        string(REGEX MATCHALL "[0-9]+" l_values "${l_size_line}")
+        list(GET l_values 0 l_text)
+        list(GET l_values 1 l_data)
+        list(GET l_values 2 l_bss)
+        math(EXPR l_flash "${l_text} + ${l_data}")
+        math(EXPR l_ram "${l_data} + ${l_bss}")
+    endif()
+
+    string(APPEND l_csv "${l_csv_line},${l_flash},${l_ram}\n")
+    string(APPEND l_table "${l_table_line}\t${l_flash}\t${l_ram}\n")
+endforeach()
+
+if(NOT l_size)
+    message("arm-none-eabi-size not found, flash and RAM are left empty")
+endif()
+
+file(WRITE ${l_binary_root}/speed.csv "${l_csv}")
+message("Suites over ${BMP581_SPEED_ITERATIONS} iterations, host ns per iteration:\n${l_table}")